@@ -39,6 +39,10 @@ QT_FORWARD_DECLARE_CLASS(Resource)
  * @brief The ENMLConverter class encapsulates a set of methods
  * and helper data structures for performing the conversions between ENML
  * and other note content formats, namely HTML
+ *
+ * The methods of ENMLConverter are reentrant: the same instance can be used
+ * from several threads simultaneously as long as the passed in
+ * DecryptedTextManager instances are not shared between these threads.
  */
 class QUENTIER_EXPORT ENMLConverter
 {
@@ -149,14 +153,38 @@ public:
     bool validateAndFixupEnml(
         QString & enml, ErrorString & errorDescription) const;
 
+    /**
+     * Batch versions of validateAndFixupEnml, noteContentToPlainText and
+     * noteContentToListOfWords: the contents of the passed in notes are
+     * processed in parallel by the threads of the global thread pool and
+     * the calling thread. The call blocks until all notes are processed.
+     *
+     * The output vectors are index aligned with the passed in notes. Notes
+     * without content yield empty results; error descriptions are empty for
+     * successfully processed notes.
+     *
+     * @return      True if contents of all notes were processed successfully,
+     *              false otherwise
+     */
+    bool validateAndFixupEnml(
+        QVector<Note> & notes, QVector<ErrorString> & errorDescriptions) const;
+
     static bool noteContentToPlainText(
         const QString & noteContent, QString & plainText,
         ErrorString & errorMessage);
 
+    static bool noteContentToPlainText(
+        const QVector<Note> & notes, QStringList & plainTexts,
+        QVector<ErrorString> & errorDescriptions);
+
     static bool noteContentToListOfWords(
         const QString & noteContent, QStringList & listOfWords,
         ErrorString & errorMessage, QString * plainText = nullptr);
 
+    static bool noteContentToListOfWords(
+        const QVector<Note> & notes, QVector<QStringList> & listsOfWords,
+        QVector<ErrorString> & errorDescriptions);
+
     static QStringList plainTextToListOfWords(const QString & plainText);
 
     static QString toDoCheckboxHtml(const bool checked, const quint64 idNumber);
@@ -106,7 +106,10 @@ public:
     virtual bool removeLocalStorageBackup(ErrorString & errorDescription) = 0;
 
     /**
-     * Apply the patch to local storage
+     * Apply the patch to local storage. Patches processing the content of
+     * local storage in batches record the progress of their application within
+     * the local storage so if the application of such patch was interrupted,
+     * the next call to this method resumes it from the last processed batch.
      *
      * @param errorDescription      The textual description of the error in case
      *                              of patch application failure
@@ -125,6 +128,17 @@ Q_SIGNALS:
      */
     void progress(double progress);
 
+    /**
+     * Patch application progress signal in terms of items processed by
+     * the patch; emitted only by patches processing items in batches
+     *
+     * @param processedItems    The number of items processed so far, including
+     *                          the ones processed before the interruption of
+     *                          the previous attempt to apply the patch, if any
+     * @param totalItems        The total number of items to be processed
+     */
+    void processedItemsProgress(qint64 processedItems, qint64 totalItems);
+
     /**
      * Local storage backup preparation progress
      *
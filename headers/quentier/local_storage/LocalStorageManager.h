@@ -278,6 +278,60 @@ public:
      */
     qint32 highestSupportedLocalStorageVersion() const;
 
+    /**
+     * databaseFragmentationStatistics method fetches the information about
+     * the free pages within the local storage database file which can be
+     * reclaimed via incrementalVacuum method
+     *
+     * @param pageSize              The size of a database page in bytes
+     * @param pageCount             The total number of pages within
+     *                              the database file
+     * @param freePageCount         The number of unused pages within
+     *                              the database file
+     * @param errorDescription      Textual description of the error if
+     *                              the statistics could not be fetched
+     * @return                      True if the statistics were fetched
+     *                              successfully, false otherwise
+     */
+    bool databaseFragmentationStatistics(
+        qint64 & pageSize, qint64 & pageCount, qint64 & freePageCount,
+        ErrorString & errorDescription) const;
+
+    /**
+     * @return                      The size of the write-ahead log file of
+     *                              the local storage database in bytes, zero
+     *                              if there's no such file
+     */
+    qint64 writeAheadLogFileSize() const;
+
+    /**
+     * incrementalVacuum method reclaims up to the specified number of free
+     * pages from the local storage database file. Unlike the full compaction
+     * of the database it doesn't rewrite the entire database file so it can
+     * be performed in small steps interleaved with other requests. It only has
+     * effect if incremental auto vacuum is enabled for the database which is
+     * the case for local storage of version 3 and above.
+     *
+     * @param maxPages              The max number of pages to reclaim
+     * @param errorDescription      Textual description of the error if
+     *                              the pages could not be reclaimed
+     * @return                      The number of reclaimed pages or -1 in case
+     *                              of error
+     */
+    int incrementalVacuum(const int maxPages, ErrorString & errorDescription);
+
+    /**
+     * checkpointWriteAheadLog method transfers the content of the write-ahead
+     * log into the local storage database file and truncates the write-ahead
+     * log file
+     *
+     * @param errorDescription      Textual description of the error if
+     *                              the checkpoint could not be made
+     * @return                      True if the checkpoint was made
+     *                              successfully, false otherwise
+     */
+    bool checkpointWriteAheadLog(ErrorString & errorDescription);
+
     /**
      * @brief userCount returns the number of non-deleted users currently stored
      * in the local storage database
@@ -1454,6 +1508,35 @@ public:
      */
     bool findTag(Tag & tag, ErrorString & errorDescription) const;
 
+    /**
+     * @brief findOrAddTags looks for the local counterparts of several tags
+     * and adds the tags having none to the local storage database, all within
+     * a single transaction.
+     *
+     * The local counterpart of a tag is the local tag with the same guid or,
+     * if there's no such tag, the local tag with the same name within the same
+     * linked notebook or within the user's own account, see findTag for
+     * the details.
+     *
+     * @param tags                  Tags to be found or added; each one must
+     *                              have guid set
+     * @param addedTags             Output parameter, tags which had no local
+     *                              counterparts and were added to the local
+     *                              storage database, with local uids filled
+     * @param localConflictsByGuid  Output parameter, local counterparts
+     *                              of the rest of passed in tags keyed by
+     *                              guids of passed in tags
+     * @param errorDescription      Error description if tags could not be
+     *                              found or added
+     * @return                      True if all tags were either found or added
+     *                              successfully, false otherwise; in the latter
+     *                              case none of tags is added
+     */
+    bool findOrAddTags(
+        const QList<Tag> & tags, QList<Tag> & addedTags,
+        QHash<QString, Tag> & localConflictsByGuid,
+        ErrorString & errorDescription);
+
     /**
      * @brief The ListTagsOrder enum allows to specify the results ordering for
      * methods listing tags from the local storage database
@@ -1978,6 +2061,46 @@ public:
     qint32 accountHighUsn(
         const QString & linkedNotebookGuid, ErrorString & errorDescription);
 
+    /**
+     * @brief The GuidIndexEntry struct contains the minimal information about
+     * the data item stored in the local storage database which allows to tell
+     * whether the item with some guid exists locally without fetching its full
+     * data
+     */
+    struct GuidIndexEntry
+    {
+        QString m_localUid;
+        qint32 m_updateSequenceNumber = -1;
+        bool m_isDirty = false;
+    };
+
+    /**
+     * @brief The GuidIndex struct contains guid index entries for notebooks,
+     * tags, saved searches and notes from both user's own account and linked
+     * notebooks, keyed by guids
+     */
+    struct GuidIndex
+    {
+        QHash<QString, GuidIndexEntry> m_notebooks;
+        QHash<QString, GuidIndexEntry> m_tags;
+        QHash<QString, GuidIndexEntry> m_savedSearches;
+        QHash<QString, GuidIndexEntry> m_notes;
+    };
+
+    /**
+     * @brief guidIndex collects guid index entries for all notebooks, tags,
+     * saved searches and notes having guids within the local storage database;
+     * only the few columns required for the index are read from the database
+     *
+     * @param index                     Output parameter, the collected guid
+     *                                  index
+     * @param errorDescription          Error description if guid index could
+     *                                  not be collected
+     * @return                          True if guid index was collected
+     *                                  successfully, false otherwise
+     */
+    bool guidIndex(GuidIndex & index, ErrorString & errorDescription);
+
 private:
     Q_DISABLE_COPY(LocalStorageManager)
 
@@ -1992,4 +2115,6 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(LocalStorageManager::UpdateNoteOptions)
 
 } // namespace quentier
 
+Q_DECLARE_METATYPE(quentier::LocalStorageManager::GuidIndex)
+
 #endif // LIB_QUENTIER_LOCAL_STORAGE_LOCAL_STORAGE_MANAGER_H
@@ -22,6 +22,7 @@
 #include <quentier/local_storage/ILocalStorageCacheExpiryChecker.h>
 #include <quentier/local_storage/LocalStorageCacheManager.h>
 #include <quentier/local_storage/LocalStorageManager.h>
+#include <quentier/local_storage/LocalStorageRequestTraceSnapshot.h>
 #include <quentier/types/ErrorString.h>
 #include <quentier/types/LinkedNotebook.h>
 #include <quentier/types/Note.h>
@@ -65,10 +66,57 @@ public:
     const LocalStorageManager * localStorageManager() const;
     LocalStorageManager * localStorageManager();
 
+    /**
+     * Background compaction of the local storage database reclaims
+     * a limited number of free pages of the database file per time slice
+     * in between the requests processed by LocalStorageManagerAsync and
+     * checkpoints the write-ahead log once it grows beyond the threshold.
+     * It is disabled by default, the application can enable it when it deems
+     * appropriate i.e. when no sync is running. These methods should be
+     * called either before init or from the thread in which
+     * LocalStorageManagerAsync lives.
+     */
+    void setBackgroundCompactionEnabled(const bool enabled);
+    void setBackgroundCompactionIntervalMsec(const int intervalMsec);
+    void setBackgroundCompactionPagesPerSlice(const int pagesPerSlice);
+
+    void setWriteAheadLogCheckpointThreshold(
+        const qint64 walFileSizeThreshold);
+
+    /**
+     * Request tracing is disabled by default. When enabled,
+     * LocalStorageManagerAsync measures how long requests of each type wait
+     * in the queue and how long they take to process and logs the SQL
+     * statements executed during the processing which take longer than
+     * the slow query threshold along with their query plans.
+     *
+     * Queue wait is measured starting from the second request sent by each
+     * signal connected to LocalStorageManagerAsync's slots across threads:
+     * the first one is only used to start stamping the requests sent by
+     * the signal so its queue wait is counted as unmeasured.
+     *
+     * These setters should be called either before init or from the thread
+     * in which LocalStorageManagerAsync lives; requestTraceSnapshot and
+     * clearRequestTrace can be called from any thread.
+     */
+    void setRequestTracingEnabled(const bool enabled);
+    void setSlowQueryThresholdMsec(const int thresholdMsec);
+
+    LocalStorageRequestTraceSnapshot requestTraceSnapshot() const;
+    void clearRequestTrace();
+
 Q_SIGNALS:
     // Sent when the initialization is complete
     void initialized();
 
+    // Local storage database statistics signals, sent after each slice of
+    // background compaction:
+    void databaseFragmentationStatisticsUpdated(
+        qint64 pageSize, qint64 pageCount, qint64 freePageCount);
+
+    void writeAheadLogStatisticsUpdated(
+        qint64 walFileSize, quint64 numCheckpoints);
+
     // User-related signals:
     void getUserCountComplete(int userCount, QUuid requestId);
     void getUserCountFailed(ErrorString errorDescription, QUuid requestId);
@@ -420,6 +468,13 @@ Q_SIGNALS:
     void findTagComplete(Tag tag, QUuid requestId);
     void findTagFailed(Tag tag, ErrorString errorDescription, QUuid requestId);
 
+    void findOrAddTagsComplete(
+        QList<Tag> addedTags, QHash<QString, Tag> localConflictsByGuid,
+        QUuid requestId);
+
+    void findOrAddTagsFailed(
+        QList<Tag> tags, ErrorString errorDescription, QUuid requestId);
+
     void listAllTagsPerNoteComplete(
         QList<Tag> foundTags, Note note,
         LocalStorageManager::ListObjectsOptions flag, size_t limit,
@@ -565,6 +620,11 @@ Q_SIGNALS:
         QString linkedNotebookGuid, ErrorString errorDescription,
         QUuid requestId);
 
+    void guidIndexComplete(
+        LocalStorageManager::GuidIndex index, QUuid requestId);
+
+    void guidIndexFailed(ErrorString errorDescription, QUuid requestId);
+
 public Q_SLOTS:
     void init();
 
@@ -707,6 +767,7 @@ public Q_SLOTS:
     void onAddTagRequest(Tag tag, QUuid requestId);
     void onUpdateTagRequest(Tag tag, QUuid requestId);
     void onFindTagRequest(Tag tag, QUuid requestId);
+    void onFindOrAddTagsRequest(QList<Tag> tags, QUuid requestId);
 
     void onListAllTagsPerNoteRequest(
         Note note, LocalStorageManager::ListObjectsOptions flag, size_t limit,
@@ -764,10 +825,18 @@ public Q_SLOTS:
 
     void onAccountHighUsnRequest(QString linkedNotebookGuid, QUuid requestId);
 
+    void onGuidIndexRequest(QUuid requestId);
+
+protected:
+    virtual void timerEvent(QTimerEvent * pEvent) override;
+
 private:
     LocalStorageManagerAsync() = delete;
     Q_DISABLE_COPY(LocalStorageManagerAsync)
 
+    void restartBackgroundCompactionTimer();
+    void runBackgroundCompactionSlice();
+
     LocalStorageManagerAsyncPrivate * const d_ptr;
     Q_DECLARE_PRIVATE(LocalStorageManagerAsync)
 };
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_LOCAL_STORAGE_LOCAL_STORAGE_REQUEST_TRACE_SNAPSHOT_H
+#define LIB_QUENTIER_LOCAL_STORAGE_LOCAL_STORAGE_REQUEST_TRACE_SNAPSHOT_H
+
+#include <quentier/utility/Linkage.h>
+#include <quentier/utility/Printable.h>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+namespace quentier {
+
+/**
+ * @brief The LocalStorageRequestTraceSnapshot structure contains the data
+ * collected by LocalStorageManagerAsync while request tracing is enabled:
+ * the time requests of each type spent waiting in the queue and executing and
+ * the SQL statements which took longer than the slow query threshold
+ */
+struct QUENTIER_EXPORT LocalStorageRequestTraceSnapshot : public Printable
+{
+    /**
+     * @brief The Histogram structure accumulates durations, in microseconds;
+     * the duration of t usec is counted in the first bucket whose upper bound
+     * from m_histogramBucketBoundsUsec is greater than t or in the last
+     * bucket if there's no such bound
+     */
+    struct Histogram
+    {
+        quint64 m_count = 0;
+        qint64 m_totalUsec = 0;
+        qint64 m_maxUsec = 0;
+        QVector<quint64> m_buckets;
+    };
+
+    struct RequestStats
+    {
+        // Time between the emission of the request signal and the start
+        // of its processing
+        Histogram m_queueWait;
+
+        // Time spent processing the request
+        Histogram m_execution;
+
+        // Number of requests for which queue wait could not be measured,
+        // see LocalStorageManagerAsync::setRequestTracingEnabled
+        quint64 m_unmeasuredQueueWaits = 0;
+    };
+
+    struct SlowQuery
+    {
+        QDateTime m_timestamp;
+        QString m_requestType;
+        QString m_statement;
+        QString m_queryPlan;
+        qint64 m_durationUsec = 0;
+    };
+
+    virtual QTextStream & print(QTextStream & strm) const override;
+
+    /**
+     * @return  JSON representation of the snapshot
+     */
+    QByteArray toJson() const;
+
+    /**
+     * Upper bounds of histogram buckets, in microseconds, in ascending order;
+     * histograms contain one more bucket than there are bounds
+     */
+    QVector<qint64> m_histogramBucketBoundsUsec;
+
+    /**
+     * Stats by request type, the name of LocalStorageManagerAsync's slot
+     * without "on" prefix and "Request" suffix, i.e. "addNote" or "findTag"
+     */
+    QHash<QString, RequestStats> m_requestStats;
+
+    /**
+     * The most recent slow SQL statements, the oldest ones first
+     */
+    QList<SlowQuery> m_slowQueries;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_LOCAL_STORAGE_LOCAL_STORAGE_REQUEST_TRACE_SNAPSHOT_H
@@ -144,6 +144,20 @@ public:
      */
     void setCurrentNoteLocalUid(const QString & noteLocalUid);
 
+    /**
+     * Convert the content of the given notes to HTML in background so that
+     * subsequent setting of any of these notes to the note editor doesn't
+     * need to wait for the conversion. Ink notes and notes containing
+     * decrypted text fragments are not prerendered. Does nothing if
+     * the note editor uses a custom backend set via setBackend.
+     *
+     * @param notes                     The notes which are likely to be set
+     *                                  to the note editor soon, i.e.
+     *                                  the neighbours of the current note in
+     *                                  the note list
+     */
+    void prerenderNotes(const QList<Note> & notes);
+
     /**
      * Clear the contents of the note editor
      */
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_NOTE_EDITOR_RESOURCE_THUMBNAIL_CACHE_H
+#define LIB_QUENTIER_NOTE_EDITOR_RESOURCE_THUMBNAIL_CACHE_H
+
+#include <quentier/utility/Linkage.h>
+
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QSize>
+
+namespace quentier {
+
+/**
+ * @brief The ResourceThumbnailCache class provides the process wide cache of
+ * downscaled images of image resources shared by the note editor and the
+ * widgets displaying resources.
+ *
+ * Thumbnails are keyed by the hash of resource's data and the requested size
+ * so the cached thumbnail remains valid for as long as resource's data has
+ * the same hash. All methods are thread-safe and may be called from worker
+ * threads: the cache stores QImage, not QPixmap.
+ */
+class QUENTIER_EXPORT ResourceThumbnailCache
+{
+public:
+    /**
+     * @return          The thumbnail of the image resource with the given data
+     *                  hash fitting into the given size, either found in
+     *                  the cache or generated from the given image data and
+     *                  put into the cache; null image if image data cannot be
+     *                  decoded
+     */
+    static QImage thumbnail(
+        const QByteArray & dataHash, const QByteArray & imageData,
+        const QSize & size);
+
+    /**
+     * @return          The cached thumbnail of the image resource with
+     *                  the given data hash and size or null image if it is
+     *                  not in the cache
+     */
+    static QImage cachedThumbnail(
+        const QByteArray & dataHash, const QSize & size);
+
+    /**
+     * @return          The sizes for which thumbnails of the image resource
+     *                  with the given data hash are currently cached
+     */
+    static QList<QSize> cachedThumbnailSizes(const QByteArray & dataHash);
+
+    /**
+     * Downscales the already decoded image to fit the given size and puts
+     * the result into the cache
+     */
+    static void insertThumbnail(
+        const QByteArray & dataHash, const QImage & image, const QSize & size);
+
+    static void removeThumbnails(const QByteArray & dataHash);
+
+    static void clear();
+
+    /**
+     * Sets the maximal total size of cached thumbnails in bytes; the least
+     * recently used thumbnails are evicted once the limit is exceeded
+     */
+    static void setMaxCacheSize(const int maxCacheSize);
+
+    static int maxCacheSize();
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_NOTE_EDITOR_RESOURCE_THUMBNAIL_CACHE_H
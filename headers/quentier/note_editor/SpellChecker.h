@@ -22,6 +22,8 @@
 #include <quentier/utility/Linkage.h>
 
 #include <QObject>
+#include <QStringList>
+#include <QUuid>
 #include <QVector>
 
 #include <utility>
@@ -51,6 +53,13 @@ public:
 
     bool checkSpell(const QString & word) const;
 
+    // Checks the spelling of the whole list of words (i.e. all words from
+    // a note) on a worker thread. Duplicate words are checked only once,
+    // the results are memoized until the user word list or the set of enabled
+    // dictionaries changes. The result is delivered via
+    // checkSpellBatchFinished signal with the returned request id
+    QUuid checkSpellBatch(const QStringList & words);
+
     QStringList spellCorrectionSuggestions(
         const QString & misSpelledWord) const;
 
@@ -64,6 +73,8 @@ public:
 Q_SIGNALS:
     void ready();
 
+    void checkSpellBatchFinished(QUuid requestId, QStringList misSpelledWords);
+
 private:
     SpellCheckerPrivate * const d_ptr;
     Q_DECLARE_PRIVATE(SpellChecker)
@@ -37,6 +37,9 @@ using IUserStorePtr = std::shared_ptr<IUserStore>;
 struct ISyncChunksDataCounters;
 using ISyncChunksDataCountersPtr = std::shared_ptr<ISyncChunksDataCounters>;
 
+struct ISyncMetrics;
+using ISyncMetricsPtr = std::shared_ptr<ISyncMetrics>;
+
 } // namespace quentier
 
 #endif // LIB_QUENTIER_SYNCHRONIZATION_FORWARD_DECLARATIONS_H
@@ -345,6 +345,30 @@ public:
         const QString & authToken, qevercloud::SyncState & syncState,
         ErrorString & errorDescription, qint32 & rateLimitSeconds) = 0;
 
+    /**
+     * Get linked notebook sync state asynchronously
+     *
+     * If the method returned true, the actual result of the method invokation
+     * would be returned via the emission of
+     * getLinkedNotebookSyncStateAsyncFinished signal.
+     *
+     * @param linkedNotebook    The linked notebook for which the sync state
+     *                          is being retrieved, must contain identifying
+     *                          information and permissions to access
+     *                          the notebook in question
+     * @param authToken         The authentication token to use for the data
+     *                          from the linked notebook
+     * @param errorDescription  The textual description of the error if
+     *                          the launch of async linked notebook sync state
+     *                          retrieval has failed
+     * @return                  True if the launch of async linked notebook
+     *                          sync state retrieval was successful, false
+     *                          otherwise
+     */
+    virtual bool getLinkedNotebookSyncStateAsync(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const QString & authToken, ErrorString & errorDescription) = 0;
+
     /**
      * Get linked notebook sync chunk
      *
@@ -388,6 +412,39 @@ public:
         qevercloud::SyncChunk & syncChunk, ErrorString & errorDescription,
         qint32 & rateLimitSeconds) = 0;
 
+    /**
+     * Get linked notebook sync chunk asynchronously
+     *
+     * If the method returned true, the actual result of the method invokation
+     * would be returned via the emission of
+     * getLinkedNotebookSyncChunkAsyncFinished signal.
+     *
+     * @param linkedNotebook            The linked notebook for which the sync
+     *                                  chunk is being retrieved, must contain
+     *                                  identifying information and permissions
+     *                                  to access the notebook in question
+     * @param afterUSN                  The USN after which the sync chunks are
+     *                                  being requested
+     * @param maxEntries                Max number of items within the sync
+     *                                  chunk to be returned
+     * @param linkedNotebookAuthToken   The authentication token to use for the
+     *                                  data from the linked notebook
+     * @param fullSyncOnly              If true then client only wants initial
+     *                                  data for a full sync, see
+     *                                  getLinkedNotebookSyncChunk
+     * @param errorDescription          The textual description of the error if
+     *                                  the launch of async linked notebook sync
+     *                                  chunk retrieval has failed
+     * @return                          True if the launch of async linked
+     *                                  notebook sync chunk retrieval was
+     *                                  successful, false otherwise
+     */
+    virtual bool getLinkedNotebookSyncChunkAsync(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const qint32 afterUSN, const qint32 maxEntries,
+        const QString & linkedNotebookAuthToken, const bool fullSyncOnly,
+        ErrorString & errorDescription) = 0;
+
     /**
      * Get note synchronously
      *
@@ -568,6 +625,16 @@ Q_SIGNALS:
         qint32 errorCode, qevercloud::Resource resource,
         qint32 rateLimitSeconds, ErrorString errorDescription);
 
+    void getLinkedNotebookSyncStateAsyncFinished(
+        qint32 errorCode, QString linkedNotebookGuid,
+        qevercloud::SyncState syncState, qint32 rateLimitSeconds,
+        ErrorString errorDescription);
+
+    void getLinkedNotebookSyncChunkAsyncFinished(
+        qint32 errorCode, QString linkedNotebookGuid, qint32 afterUSN,
+        qevercloud::SyncChunk syncChunk, qint32 rateLimitSeconds,
+        ErrorString errorDescription);
+
 private:
     Q_DISABLE_COPY(INoteStore)
 };
@@ -147,6 +147,14 @@ struct QUENTIER_EXPORT ISyncChunksDataCounters : public Printable
      * so far
      */
     virtual quint64 expungedNotebooks() const noexcept = 0;
+
+    // ================= Memory =================
+
+    /**
+     * Max number of bytes occupied by downloaded sync chunks kept in memory;
+     * sync chunks beyond some limit are buffered on disk instead
+     */
+    virtual quint64 peakBufferedBytes() const noexcept = 0;
 };
 
 } // namespace quentier
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_SYNCHRONIZATION_I_SYNC_METRICS_H
+#define LIB_QUENTIER_SYNCHRONIZATION_I_SYNC_METRICS_H
+
+#include <quentier/utility/Linkage.h>
+#include <quentier/utility/Printable.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+namespace quentier {
+
+/**
+ * @brief The ISyncMetrics interface provides the timings and counters
+ * collected during a single synchronization: wall times of sync phases,
+ * latencies of calls to INoteStore methods and of local storage requests,
+ * depths of queues of pending requests and the amount of transferred data
+ */
+struct QUENTIER_EXPORT ISyncMetrics : public Printable
+{
+    /**
+     * @brief The CallStats structure accumulates the latencies of calls of
+     * a single kind, either INoteStore method calls or local storage requests
+     */
+    struct CallStats
+    {
+        quint64 m_count = 0;
+        quint64 m_failures = 0;
+
+        // Number of calls which failed due to Evernote API rate limit breach
+        quint64 m_rateLimitBreaches = 0;
+
+        qint64 m_totalMsec = 0;
+        qint64 m_maxMsec = 0;
+
+        /**
+         * Number of calls per latency bucket: the call which took t msec is
+         * counted in the first bucket whose upper bound from
+         * latencyHistogramBucketBoundsMsec is greater than t or in the last
+         * bucket if there's no such bound
+         */
+        QVector<quint64> m_latencyHistogram;
+    };
+
+    /**
+     * Upper bounds of latency histogram buckets, in milliseconds, in
+     * ascending order; histograms contain one more bucket than there are
+     * bounds
+     */
+    virtual QVector<qint64> latencyHistogramBucketBoundsMsec() const = 0;
+
+    /**
+     * Wall time spent in each sync phase, in milliseconds, by phase name:
+     * "authentication", "download" (remote to local sync), "send" (sending
+     * local changes) and "total"; if a phase runs several times during
+     * the sync (for example, incremental sync repeated after sending local
+     * changes), its times are summed up.
+     *
+     * Two more phases overlap with the ones above: "rate_limit_wait" is
+     * the time during which at least one request is postponed due to
+     * the API rate limit breach and "conflict_resolution" is the time during
+     * which at least one sync conflict resolver is alive. The conversion of
+     * note contents to or from ENML is not a part of the sync so it has
+     * no phase
+     */
+    virtual QHash<QString, qint64> phaseDurationsMsec() const = 0;
+
+    /**
+     * Latencies of INoteStore method calls by method name
+     */
+    virtual QHash<QString, CallStats> noteStoreCallStats() const = 0;
+
+    /**
+     * Latencies of local storage requests by request name
+     */
+    virtual QHash<QString, CallStats> localStorageRequestStats() const = 0;
+
+    /**
+     * Max number of simultaneously pending requests by queue name
+     */
+    virtual QHash<QString, quint64> peakQueueDepths() const = 0;
+
+    /**
+     * Number of bytes downloaded from the service, estimated by the sizes of
+     * note contents and resource data bodies
+     */
+    virtual quint64 downloadedBytes() const noexcept = 0;
+
+    /**
+     * Number of bytes uploaded to the service, estimated by the sizes of
+     * note contents and resource data bodies
+     */
+    virtual quint64 uploadedBytes() const noexcept = 0;
+
+    /**
+     * @return  JSON representation of all the metrics
+     */
+    virtual QByteArray toJson() const = 0;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_SYNCHRONIZATION_I_SYNC_METRICS_H
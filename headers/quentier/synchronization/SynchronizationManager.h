@@ -21,6 +21,7 @@
 
 #include <quentier/synchronization/ForwardDeclarations.h>
 #include <quentier/synchronization/ISyncChunksDataCounters.h>
+#include <quentier/synchronization/ISyncMetrics.h>
 #include <quentier/types/Account.h>
 #include <quentier/types/ErrorString.h>
 #include <quentier/types/LinkedNotebook.h>
@@ -204,6 +205,55 @@ public Q_SLOTS:
      */
     void setInkNoteImagesStoragePath(QString path);
 
+    /**
+     * Use this slot to check whether the Evernote service has any updates
+     * which were not yet synchronized. The check only compares the update
+     * counts from the sync states of user's own account and of all linked
+     * notebooks with the update counts persisted after the last sync, without
+     * launching the synchronization itself, so it is much cheaper than
+     * the sync which has nothing to download.
+     *
+     * The result is delivered via updatesCheckFinished signal. If the client
+     * has never synchronized before, the updates are considered available.
+     * Local changes are not considered by the check, the synchronization is
+     * required to send them anyway.
+     */
+    void checkForUpdates();
+
+    /**
+     * Use this slot to start polling the Evernote service for updates
+     * periodically. Each poll either launches the synchronization, if there
+     * are local changes pending sync (see notifyLocalChanges slot), or checks
+     * for updates the same way as checkForUpdates slot and launches
+     * the synchronization if the updates are available.
+     *
+     * The polling interval adapts to the activity: each poll finding no
+     * updates doubles the interval until it reaches the maximum one; found
+     * updates or local changes reset the interval to the minimum one.
+     *
+     * @param minIntervalMsec           The minimal interval between polls
+     *                                  in milliseconds
+     * @param maxIntervalMsec           The maximal interval between polls
+     *                                  in milliseconds; if less than
+     *                                  the minimal one, the minimal one is
+     *                                  used instead
+     */
+    void startAdaptivePolling(int minIntervalMsec, int maxIntervalMsec);
+
+    /**
+     * Use this slot to stop polling the Evernote service for updates; has no
+     * effect if adaptive polling was not started
+     */
+    void stopAdaptivePolling();
+
+    /**
+     * Use this slot to notify the synchronization manager that some data items
+     * were changed locally. If adaptive polling is started, the polling
+     * interval is reset to the minimal one and the next poll would launch
+     * the synchronization to send the local changes.
+     */
+    void notifyLocalChanges();
+
 Q_SIGNALS:
     /**
      * This signal is emitted when the synchronization is started
@@ -407,6 +457,29 @@ Q_SIGNALS:
      */
     void linkedNotebooksSyncChunksDownloaded();
 
+    /**
+     * This signal is emitted during "remote to local" synchronization
+     * each time the sync state of a linked notebook is received. Sync states
+     * of linked notebooks are requested concurrently, with a limited number of
+     * simultaneous requests per shard, so that linked notebooks without
+     * changes can be skipped before any sync chunks are downloaded for them.
+     *
+     * @param linkedNotebooksChecked        The number of linked notebooks
+     *                                      which sync states were received
+     *                                      so far
+     * @param totalLinkedNotebooksToCheck   The total number of linked
+     *                                      notebooks which sync states need
+     *                                      to be received
+     * @param linkedNotebook                The linked notebook which sync
+     *                                      state was just received
+     * @param hasUpdates                    True if the linked notebook has
+     *                                      updates to be synchronized, false
+     *                                      otherwise
+     */
+    void linkedNotebookSyncStatesCheckProgress(
+        quint32 linkedNotebooksChecked, quint32 totalLinkedNotebooksToCheck,
+        LinkedNotebook linkedNotebook, bool hasUpdates);
+
     /**
      * This signal is emitted during linked notebooks' downloaded sync chunks
      * contents processing and denotes the progress on that step.
@@ -501,6 +574,29 @@ Q_SIGNALS:
      */
     void setInkNoteImagesStoragePathDone(QString path);
 
+    /**
+     * This signal is emitted in response to invoking checkForUpdates slot
+     * as well as after each check for updates done during adaptive polling
+     *
+     * @param success           True if the check was done successfully,
+     *                          false otherwise
+     * @param updatesAvailable  True if the Evernote service has updates which
+     *                          were not yet synchronized, false otherwise
+     * @param errorDescription  The textual explanation of the failure to
+     *                          check for updates
+     */
+    void updatesCheckFinished(
+        bool success, bool updatesAvailable, ErrorString errorDescription);
+
+    /**
+     * This signal is emitted when the synchronization either finishes or
+     * fails; it delivers the timings and counters collected during the sync
+     * which can be dumped as JSON via ISyncMetrics::toJson
+     *
+     * @param metrics           The metrics of the finished synchronization
+     */
+    void syncMetricsReady(ISyncMetricsPtr metrics);
+
 private:
     SynchronizationManager() = delete;
     Q_DISABLE_COPY(SynchronizationManager)
@@ -132,6 +132,41 @@ public:
     bool updateResource(const Resource & resource);
     bool removeResource(const Resource & resource);
 
+    /**
+     * Methods below provide indexed access to note's resources without
+     * building the whole list of Resource objects the way resources() does.
+     * Lookups by local uid and guid take constant time.
+     *
+     * @return              index of the resource within the note or -1 if
+     *                      no such resource was found
+     */
+    int resourceIndexByLocalUid(const QString & resourceLocalUid) const;
+    int resourceIndexByGuid(const QString & resourceGuid) const;
+    int resourceIndexByDataHash(const QByteArray & dataHash) const;
+
+    /**
+     * @param index         index of the resource within the note, must be
+     *                      within [0, numResources())
+     * @return              resource at the given index with local uid,
+     *                      note local uid, dirty flag and index in note set
+     */
+    Resource resourceAt(const int index) const;
+
+    /**
+     * @param index         index of the resource within the note, must be
+     *                      within [0, numResources())
+     * @return              const reference to the qevercloud::Resource stored
+     *                      within the note, no copying involved
+     */
+    const qevercloud::Resource & qevercloudResourceAt(const int index) const;
+
+    /**
+     * @param index         index of the resource within the note, must be
+     *                      within [0, numResources())
+     * @return              local uid of the resource at the given index
+     */
+    QString resourceLocalUidAt(const int index) const;
+
     bool hasNoteAttributes() const;
     const qevercloud::NoteAttributes & noteAttributes() const;
     qevercloud::NoteAttributes & noteAttributes();
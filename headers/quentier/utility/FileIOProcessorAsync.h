@@ -23,9 +23,11 @@
 #include <quentier/utility/Linkage.h>
 
 #include <QByteArray>
+#include <QDebug>
 #include <QIODevice>
 #include <QObject>
 #include <QString>
+#include <QTextStream>
 #include <QUuid>
 
 namespace quentier {
@@ -35,6 +37,14 @@ QT_FORWARD_DECLARE_CLASS(FileIOProcessorAsyncPrivate)
 /**
  * @brief The FileIOProcessorAsync class is a wrapper under simple file IO
  * operations, it is meant to be used for simple asynchronous IO
+ *
+ * Requests are not processed by the thread FileIOProcessorAsync lives in but
+ * are scheduled onto a small pool of workers: requests for different files are
+ * processed concurrently while requests for the same file are processed in
+ * the order of their arrival. Pending requests with higher priority are
+ * started ahead of pending requests with lower priority. Consecutive pending
+ * write requests for the same file are coalesced into a single write; each of
+ * the coalesced requests is still replied to with the outcome of that write.
  */
 class QUENTIER_EXPORT FileIOProcessorAsync : public QObject
 {
@@ -42,6 +52,57 @@ class QUENTIER_EXPORT FileIOProcessorAsync : public QObject
 public:
     explicit FileIOProcessorAsync(QObject * parent = nullptr);
 
+    /**
+     * Priorities of IO requests: requests issued by the user's actions should
+     * be processed with Interactive priority, housekeeping requests which
+     * might wait with Background priority
+     */
+    enum class Priority
+    {
+        Background = 0,
+        Normal,
+        Interactive
+    };
+
+    friend QUENTIER_EXPORT QTextStream & operator<<(
+        QTextStream & strm, const Priority priority);
+
+    friend QUENTIER_EXPORT QDebug & operator<<(
+        QDebug & dbg, const Priority priority);
+
+    /**
+     * @brief The Metrics struct contains the statistics of IO requests
+     * processing accumulated since the creation of FileIOProcessorAsync
+     */
+    struct QUENTIER_EXPORT Metrics
+    {
+        // Numbers of requests waiting for processing, by priority
+        int m_numPendingBackgroundRequests = 0;
+        int m_numPendingNormalRequests = 0;
+        int m_numPendingInteractiveRequests = 0;
+
+        int m_numRequestsInProgress = 0;
+
+        quint64 m_numProcessedRequests = 0;
+        quint64 m_numCoalescedWriteRequests = 0;
+
+        // Time from receiving the request to sending the reply to it
+        qint64 m_averageLatencyMsec = 0;
+        qint64 m_maxLatencyMsec = 0;
+    };
+
+    /**
+     * @return          The snapshot of IO requests processing statistics; this
+     *                  method can be called from any thread
+     */
+    Metrics metrics() const;
+
+    /**
+     * @brief setMaxWorkerCount sets the maximal number of IO requests for
+     * different files processed concurrently; the default is 4
+     */
+    void setMaxWorkerCount(const int maxWorkerCount);
+
     /**
      * @brief setIdleTimePeriod sets time period defining the idle state of
      * FileIOProcessorAsync: once the time measured since the last IO operation
@@ -90,6 +151,22 @@ Q_SIGNALS:
         bool success, ErrorString errorDescription, QByteArray data,
         QUuid requestId);
 
+    /**
+     * @brief readFileWithHashRequestProcessed signal is emitted when the file
+     * read request issued via onReadFileWithHashRequest is finished
+     *
+     * @param success                   True if read operation was successful,
+     *                                  false otherwise
+     * @param errorDescription          Textual description of the error
+     * @param data                      Data read from file
+     * @param dataHash                  MD5 hash of the data read from file
+     * @param requestId                 Unique identifier of the file read
+     *                                  request
+     */
+    void readFileWithHashRequestProcessed(
+        bool success, ErrorString errorDescription, QByteArray data,
+        QByteArray dataHash, QUuid requestId);
+
 public Q_SLOTS:
     /**
      * @brief onWriteFileRequest slot processes file write requests
@@ -115,6 +192,32 @@ public Q_SLOTS:
      */
     void onReadFileRequest(QString absoluteFilePath, QUuid requestId);
 
+    /**
+     * @brief onReadFileWithHashRequest slot processes file read requests
+     * which also need the MD5 hash of the read data; the hash is computed
+     * while reading the file so the data doesn't need to be traversed again
+     *
+     * @param absoluteFilePath      Absolute file path to be read
+     * @param requestId             Unique identifier of the file read request
+     */
+    void onReadFileWithHashRequest(QString absoluteFilePath, QUuid requestId);
+
+    /**
+     * Slots processing requests the same way as the ones above but with
+     * the specified priority; the above slots use Normal priority
+     */
+    void onPrioritizedWriteFileRequest(
+        QString absoluteFilePath, QByteArray data, QUuid requestId,
+        bool append, FileIOProcessorAsync::Priority priority);
+
+    void onPrioritizedReadFileRequest(
+        QString absoluteFilePath, QUuid requestId,
+        FileIOProcessorAsync::Priority priority);
+
+    void onPrioritizedReadFileWithHashRequest(
+        QString absoluteFilePath, QUuid requestId,
+        FileIOProcessorAsync::Priority priority);
+
 private:
     FileIOProcessorAsyncPrivate * const d_ptr;
     Q_DECLARE_PRIVATE(FileIOProcessorAsync)
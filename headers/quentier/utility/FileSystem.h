@@ -21,8 +21,13 @@
 
 #include <quentier/utility/Linkage.h>
 
+#include <QCryptographicHash>
 #include <QString>
 
+#include <functional>
+
+QT_FORWARD_DECLARE_CLASS(QIODevice)
+
 namespace quentier {
 
 QT_FORWARD_DECLARE_CLASS(ErrorString)
@@ -79,6 +84,91 @@ bool QUENTIER_EXPORT removeDir(const QString & dirPath);
 QByteArray QUENTIER_EXPORT
 readFileContents(const QString & filePath, ErrorString & errorDescription);
 
+/**
+ * readFileContentsWithHash reads the entire contents of a file into QByteArray
+ * in chunks and computes the hash of the contents along the way, while each
+ * chunk is still hot in CPU cache, so that the data is not traversed for
+ * the second time to compute its hash.
+ *
+ * @param filePath          The path to the file which contents are to be read
+ * @param dataHash          The hash of file's contents computed with
+ *                          the specified algorithm
+ * @param errorDescription  The textual description of the error in case of I/O
+ *                          error, empty otherwise
+ * @param algorithm         The hashing algorithm, MD5 by default as it is
+ *                          the one used for resources' data hashes
+ * @return                  QByteArray with file's contents read into memory or
+ *                          empty QByteArray in case of I/O error
+ */
+QByteArray QUENTIER_EXPORT readFileContentsWithHash(
+    const QString & filePath, QByteArray & dataHash,
+    ErrorString & errorDescription,
+    const QCryptographicHash::Algorithm algorithm = QCryptographicHash::Md5);
+
+/**
+ * writeFileContentsWithHash writes the data to a file in chunks and, if
+ * the passed in hash is empty, computes the hash of the data along the way.
+ *
+ * @param filePath          The path to the file to be written; the file is
+ *                          truncated if it exists
+ * @param data              The data to be written to the file
+ * @param dataHash          If empty on input, the hash of the data computed
+ *                          with the specified algorithm on output; if not
+ *                          empty, it is considered to be the actual hash of
+ *                          the data and no hashing is done
+ * @param errorDescription  The textual description of the error in case of I/O
+ *                          error, empty otherwise
+ * @param progressCallback  Optional callback receiving the progress of writing
+ *                          the data, from 0 to 1, after each written chunk
+ * @param algorithm         The hashing algorithm, MD5 by default
+ * @return                  True if the data was written successfully, false
+ *                          otherwise
+ */
+bool QUENTIER_EXPORT writeFileContentsWithHash(
+    const QString & filePath, const QByteArray & data, QByteArray & dataHash,
+    ErrorString & errorDescription,
+    const std::function<void(double)> & progressCallback = {},
+    const QCryptographicHash::Algorithm algorithm = QCryptographicHash::Md5);
+
+/**
+ * copyDataWithHash copies all the data available from the source device to
+ * the destination device in fixed size chunks and computes the hash of
+ * the copied data along the way; the data is never fully resident in memory.
+ *
+ * @param source            The device to read the data from, must be open for
+ *                          reading
+ * @param destination       The device to write the data to, must be open for
+ *                          writing
+ * @param dataHash          The hash of the copied data computed with
+ *                          the specified algorithm
+ * @param errorDescription  The textual description of the error in case of I/O
+ *                          error, empty otherwise
+ * @param algorithm         The hashing algorithm, MD5 by default
+ * @return                  True if all the data was copied successfully, false
+ *                          otherwise
+ */
+bool QUENTIER_EXPORT copyDataWithHash(
+    QIODevice & source, QIODevice & destination, QByteArray & dataHash,
+    ErrorString & errorDescription,
+    const QCryptographicHash::Algorithm algorithm = QCryptographicHash::Md5);
+
+/**
+ * calculateFileHash computes the hash of the file's contents reading the file
+ * in fixed size chunks so that the file is never fully resident in memory
+ *
+ * @param filePath          The path to the file which hash is to be computed
+ * @param dataHash          The hash of file's contents
+ * @param errorDescription  The textual description of the error in case of I/O
+ *                          error, empty otherwise
+ * @param algorithm         The hashing algorithm, MD5 by default
+ * @return                  True if the hash was computed successfully, false
+ *                          otherwise
+ */
+bool QUENTIER_EXPORT calculateFileHash(
+    const QString & filePath, QByteArray & dataHash,
+    ErrorString & errorDescription,
+    const QCryptographicHash::Algorithm algorithm = QCryptographicHash::Md5);
+
 /**
  * renameFile renames file with absolute path "from" to file with absolute
  * path "to". This function handles the case when file "to" already exists. On
@@ -83,6 +83,13 @@ bool ENMLConverter::validateAndFixupEnml(
     return d->validateAndFixupEnml(enml, errorDescription);
 }
 
+bool ENMLConverter::validateAndFixupEnml(
+    QVector<Note> & notes, QVector<ErrorString> & errorDescriptions) const
+{
+    Q_D(const ENMLConverter);
+    return d->validateAndFixupEnml(notes, errorDescriptions);
+}
+
 bool ENMLConverter::noteContentToPlainText(
     const QString & noteContent, QString & plainText,
     ErrorString & errorMessage)
@@ -91,6 +98,14 @@ bool ENMLConverter::noteContentToPlainText(
         noteContent, plainText, errorMessage);
 }
 
+bool ENMLConverter::noteContentToPlainText(
+    const QVector<Note> & notes, QStringList & plainTexts,
+    QVector<ErrorString> & errorDescriptions)
+{
+    return ENMLConverterPrivate::noteContentToPlainText(
+        notes, plainTexts, errorDescriptions);
+}
+
 bool ENMLConverter::noteContentToListOfWords(
     const QString & noteContent, QStringList & listOfWords,
     ErrorString & errorMessage, QString * plainText)
@@ -99,6 +114,14 @@ bool ENMLConverter::noteContentToListOfWords(
         noteContent, listOfWords, errorMessage, plainText);
 }
 
+bool ENMLConverter::noteContentToListOfWords(
+    const QVector<Note> & notes, QVector<QStringList> & listsOfWords,
+    QVector<ErrorString> & errorDescriptions)
+{
+    return ENMLConverterPrivate::noteContentToListOfWords(
+        notes, listsOfWords, errorDescriptions);
+}
+
 QStringList ENMLConverter::plainTextToListOfWords(const QString & plainText)
 {
     return ENMLConverterPrivate::plainTextToListOfWords(plainText);
@@ -17,6 +17,7 @@
  */
 
 #include "ENMLConverter_p.h"
+#include "StaticStringSet.h"
 
 #include <quentier/enml/DecryptedTextManager.h>
 #include <quentier/enml/HTMLCleaner.h>
@@ -35,17 +36,25 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QImage>
+#include <QMutex>
 #include <QPainter>
 #include <QPen>
 #include <QPixmap>
 #include <QRegExp>
 #include <QString>
 #include <QThread>
+#include <QThreadPool>
+#include <QThreadStorage>
+#include <QWaitCondition>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
 #include <libxml/xmlreader.h>
 
+#include <algorithm>
+#include <functional>
+#include <memory>
+
 // 25 Mb in bytes
 #define ENEX_MAX_RESOURCE_DATA_SIZE (26214400)
 
@@ -54,29 +63,191 @@
 
 namespace quentier {
 
-#define WRAP(x) << QStringLiteral(x)
+#define WRAP(x) x,
 
-ENMLConverterPrivate::ENMLConverterPrivate(QObject * parent) :
-    QObject(parent), m_forbiddenXhtmlTags(QSet<QString>()
+namespace {
+
+// Perfect hash tables of tags and attributes are built at compile time from
+// the lists in .inl files
+
+constexpr const char * forbiddenXhtmlTagsKeys[] = {
 #include "forbiddenXhtmlTags.inl"
-                                              ),
-    m_forbiddenXhtmlAttributes(QSet<QString>()
+};
+
+constexpr const char * forbiddenXhtmlAttributesKeys[] = {
 #include "forbiddenXhtmlAttributes.inl"
-                                   ),
-    m_evernoteSpecificXhtmlTags(QSet<QString>()
+};
+
+constexpr const char * evernoteSpecificXhtmlTagsKeys[] = {
 #include "evernoteSpecificXhtmlTags.inl"
-                                    ),
-    m_allowedXhtmlTags(QSet<QString>()
+};
+
+constexpr const char * allowedXhtmlTagsKeys[] = {
 #include "allowedXhtmlTags.inl"
-                           ),
-    m_allowedEnMediaAttributes(QSet<QString>()
+};
+
+constexpr const char * allowedEnMediaAttributesKeys[] = {
 #include "allowedEnMediaAttributes.inl"
-                                   ),
-    m_pHtmlCleaner(nullptr), m_cachedConvertedXml()
-{}
+};
 
 #undef WRAP
 
+constexpr auto forbiddenXhtmlTags =
+    makeStaticStringSet<256>(forbiddenXhtmlTagsKeys);
+
+constexpr auto forbiddenXhtmlAttributes =
+    makeStaticStringSet<128>(forbiddenXhtmlAttributesKeys);
+
+constexpr auto evernoteSpecificXhtmlTags =
+    makeStaticStringSet<64>(evernoteSpecificXhtmlTagsKeys);
+
+constexpr auto allowedXhtmlTags =
+    makeStaticStringSet<1024>(allowedXhtmlTagsKeys);
+
+constexpr auto allowedEnMediaAttributes =
+    makeStaticStringSet<128>(allowedEnMediaAttributesKeys);
+
+static_assert(
+    (forbiddenXhtmlTags.m_seed != staticStringSetMaxSeed) &&
+        (forbiddenXhtmlAttributes.m_seed != staticStringSetMaxSeed) &&
+        (evernoteSpecificXhtmlTags.m_seed != staticStringSetMaxSeed) &&
+        (allowedXhtmlTags.m_seed != staticStringSetMaxSeed) &&
+        (allowedEnMediaAttributes.m_seed != staticStringSetMaxSeed),
+    "Failed to build perfect hash tables of XHTML tags and attributes, "
+    "increase the number of slots");
+
+// HTMLCleaner wraps tidy document which must not be used from several threads
+// simultaneously so each thread gets its own lazily created instance
+HTMLCleaner & threadLocalHtmlCleaner()
+{
+    static QThreadStorage<HTMLCleaner *> htmlCleaners;
+    if (!htmlCleaners.hasLocalData()) {
+        htmlCleaners.setLocalData(new HTMLCleaner);
+    }
+
+    return *htmlCleaners.localData();
+}
+
+// DTD files are read from resources once and shared between threads
+QByteArray dtdRawData(const QString & dtdFilePath)
+{
+    static QMutex mutex;
+    static QHash<QString, QByteArray> dtdRawDataByFilePath;
+
+    QMutexLocker locker(&mutex);
+
+    auto it = dtdRawDataByFilePath.constFind(dtdFilePath);
+    if (it != dtdRawDataByFilePath.constEnd()) {
+        return it.value();
+    }
+
+    QFile dtdFile(dtdFilePath);
+    if (!dtdFile.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    QByteArray rawData = dtdFile.readAll();
+    dtdRawDataByFilePath[dtdFilePath] = rawData;
+    return rawData;
+}
+
+/**
+ * @brief The ParallelProcessingState struct is shared between the thread
+ * calling processInParallel and the runnables started by it: each of them
+ * picks the next unprocessed item until there are none left. The calling
+ * thread takes part in the processing too so that the processing finishes
+ * even if no thread pool's thread is available.
+ */
+struct ParallelProcessingState
+{
+    ParallelProcessingState(
+        const int numItems, std::function<void(const int)> processItem) :
+        m_numItems(numItems),
+        m_processItem(std::move(processItem))
+    {}
+
+    void processItems()
+    {
+        while (true) {
+            const int index = m_nextItemIndex.fetchAndAddOrdered(1);
+            if (index >= m_numItems) {
+                return;
+            }
+
+            m_processItem(index);
+
+            QMutexLocker locker(&m_mutex);
+            ++m_numProcessedItems;
+            if (m_numProcessedItems == m_numItems) {
+                m_allItemsProcessed.wakeAll();
+            }
+        }
+    }
+
+    void waitForAllItemsProcessed()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_numProcessedItems < m_numItems) {
+            m_allItemsProcessed.wait(&m_mutex);
+        }
+    }
+
+    const int m_numItems;
+    const std::function<void(const int)> m_processItem;
+
+    QAtomicInt m_nextItemIndex = 0;
+
+    QMutex m_mutex;
+    QWaitCondition m_allItemsProcessed;
+    int m_numProcessedItems = 0;
+};
+
+class ParallelProcessingRunnable final : public QRunnable
+{
+public:
+    explicit ParallelProcessingRunnable(
+        std::shared_ptr<ParallelProcessingState> pState) :
+        m_pState(std::move(pState))
+    {}
+
+    virtual void run() override
+    {
+        m_pState->processItems();
+    }
+
+private:
+    std::shared_ptr<ParallelProcessingState> m_pState;
+};
+
+void processInParallel(
+    const int numItems, std::function<void(const int)> processItem)
+{
+    if (numItems <= 0) {
+        return;
+    }
+
+    auto pState = std::make_shared<ParallelProcessingState>(
+        numItems, std::move(processItem));
+
+    auto * pThreadPool = QThreadPool::globalInstance();
+
+    const int numRunnables =
+        std::min(pThreadPool->maxThreadCount(), numItems) - 1;
+
+    for (int i = 0; i < numRunnables; ++i) {
+        pThreadPool->start(new ParallelProcessingRunnable(pState));
+    }
+
+    pState->processItems();
+    pState->waitForAllItemsProcessed();
+}
+
+} // namespace
+
+ENMLConverterPrivate::ENMLConverterPrivate(QObject * parent) :
+    QObject(parent)
+{}
+
 void xmlValidationErrorFunc(void * ctx, const char * msg, va_list args)
 {
     QNDEBUG("enml", "xmlValidationErrorFunc");
@@ -88,10 +259,7 @@ void xmlValidationErrorFunc(void * ctx, const char * msg, va_list args)
     QNDEBUG("enml", "Error string: " << *pErrorString);
 }
 
-ENMLConverterPrivate::~ENMLConverterPrivate()
-{
-    delete m_pHtmlCleaner;
-}
+ENMLConverterPrivate::~ENMLConverterPrivate() = default;
 
 bool ENMLConverterPrivate::htmlToNoteContent(
     const QString & html, const QVector<SkipHtmlElementRule> & skipRules,
@@ -103,13 +271,9 @@ bool ENMLConverterPrivate::htmlToNoteContent(
         "ENMLConverterPrivate::htmlToNoteContent: "
             << html << "\nskip element rules: " << skipRules);
 
-    if (!m_pHtmlCleaner) {
-        m_pHtmlCleaner = new HTMLCleaner;
-    }
-
     QString error;
-    m_cachedConvertedXml.resize(0);
-    bool res = m_pHtmlCleaner->htmlToXml(html, m_cachedConvertedXml, error);
+    QString convertedXml;
+    bool res = threadLocalHtmlCleaner().htmlToXml(html, convertedXml, error);
     if (!res) {
         errorDescription.setBase(
             QT_TR_NOOP("Failed to clean up the note's html"));
@@ -117,9 +281,9 @@ bool ENMLConverterPrivate::htmlToNoteContent(
         return false;
     }
 
-    QNTRACE("enml", "HTML converted to XML by tidy: " << m_cachedConvertedXml);
+    QNTRACE("enml", "HTML converted to XML by tidy: " << convertedXml);
 
-    QXmlStreamReader reader(m_cachedConvertedXml);
+    QXmlStreamReader reader(convertedXml);
 
     noteContent.resize(0);
     QBuffer noteContentBuffer;
@@ -231,7 +395,7 @@ bool ENMLConverterPrivate::htmlToNoteContent(
         QNWARNING(
             "enml",
             "Error reading html: " << errorDescription << ", HTML: " << html
-                                   << "\nXML: " << m_cachedConvertedXml);
+                                   << "\nXML: " << convertedXml);
         return false;
     }
 
@@ -258,13 +422,9 @@ bool ENMLConverterPrivate::htmlToQTextDocument(
 {
     QNDEBUG("enml", "ENMLConverterPrivate::htmlToQTextDocument: " << html);
 
-    if (!m_pHtmlCleaner) {
-        m_pHtmlCleaner = new HTMLCleaner;
-    }
-
     QString error;
-    m_cachedConvertedXml.resize(0);
-    bool res = m_pHtmlCleaner->htmlToXml(html, m_cachedConvertedXml, error);
+    QString convertedXml;
+    bool res = threadLocalHtmlCleaner().htmlToXml(html, convertedXml, error);
     if (!res) {
         errorDescription.setBase(
             QT_TR_NOOP("Failed to clean up the note's html"));
@@ -272,9 +432,9 @@ bool ENMLConverterPrivate::htmlToQTextDocument(
         return false;
     }
 
-    QNTRACE("enml", "HTML converted to XML by tidy: " << m_cachedConvertedXml);
+    QNTRACE("enml", "HTML converted to XML by tidy: " << convertedXml);
 
-    QXmlStreamReader reader(m_cachedConvertedXml);
+    QXmlStreamReader reader(convertedXml);
 
     QBuffer simplifiedHtmlBuffer;
     res = simplifiedHtmlBuffer.open(QIODevice::WriteOnly);
@@ -729,7 +889,7 @@ bool ENMLConverterPrivate::htmlToQTextDocument(
         QNWARNING(
             "enml",
             "Error reading html: " << errorDescription << ", HTML: " << html
-                                   << "\nXML: " << m_cachedConvertedXml);
+                                   << "\nXML: " << convertedXml);
         return false;
     }
 
@@ -759,19 +919,15 @@ bool ENMLConverterPrivate::cleanupExternalHtml(
         "ENMLConverterPrivate::cleanupExternalHtml: input HTML = "
             << inputHtml);
 
-    if (!m_pHtmlCleaner) {
-        m_pHtmlCleaner = new HTMLCleaner;
-    }
-
     QString supplementedHtml = QStringLiteral("<html><body>");
     supplementedHtml += inputHtml;
     supplementedHtml += QStringLiteral("</body></html>");
 
     QString error;
-    m_cachedConvertedXml.resize(0);
+    QString convertedXml;
 
-    bool res = m_pHtmlCleaner->htmlToXml(
-        supplementedHtml, m_cachedConvertedXml, error);
+    bool res = threadLocalHtmlCleaner().htmlToXml(
+        supplementedHtml, convertedXml, error);
 
     if (!res) {
         errorDescription.setBase(
@@ -780,9 +936,9 @@ bool ENMLConverterPrivate::cleanupExternalHtml(
         return false;
     }
 
-    QNTRACE("enml", "HTML converted to XML: " << m_cachedConvertedXml);
+    QNTRACE("enml", "HTML converted to XML: " << convertedXml);
 
-    QXmlStreamReader reader(m_cachedConvertedXml);
+    QXmlStreamReader reader(convertedXml);
 
     QBuffer outputSupplementedHtmlBuffer;
     res = outputSupplementedHtmlBuffer.open(QIODevice::WriteOnly);
@@ -818,25 +974,25 @@ bool ENMLConverterPrivate::cleanupExternalHtml(
         }
 
         if (reader.isStartElement()) {
-            lastElementName = reader.name().toString();
+            const QStringRef elementName = reader.name();
 
-            auto tagIt = m_forbiddenXhtmlTags.constFind(lastElementName);
-            if (tagIt != m_forbiddenXhtmlTags.constEnd()) {
-                QNTRACE("enml", "Skipping forbidden tag: " << lastElementName);
+            if (isForbiddenXhtmlTag(elementName)) {
+                QNTRACE("enml", "Skipping forbidden tag: " << elementName);
                 continue;
             }
 
-            tagIt = m_allowedXhtmlTags.constFind(lastElementName);
-            if (tagIt == m_allowedXhtmlTags.end()) {
+            if (!isAllowedXhtmlTag(elementName)) {
                 QNTRACE(
                     "enml",
                     "Haven't found tag "
-                        << lastElementName
+                        << elementName
                         << " within the list of allowed XHTML tags, skipping "
                         << "it");
                 continue;
             }
 
+            lastElementName = elementName.toString();
+
             lastElementAttributes = reader.attributes();
 
             // Erasing forbidden attributes
@@ -844,7 +1000,7 @@ bool ENMLConverterPrivate::cleanupExternalHtml(
                  it != lastElementAttributes.end();)
             {
                 QStringRef attributeName = it->name();
-                if (isForbiddenXhtmlAttribute(attributeName.toString())) {
+                if (isForbiddenXhtmlAttribute(attributeName)) {
                     QNTRACE(
                         "enml",
                         "Erasing forbidden attribute " << attributeName);
@@ -898,7 +1054,7 @@ bool ENMLConverterPrivate::cleanupExternalHtml(
             "Error reading the input HTML: "
                 << errorDescription << ", input HTML: " << inputHtml
                 << "\n\nSupplemented input HTML: " << supplementedHtml
-                << "\n\nHTML converted to XML: " << m_cachedConvertedXml);
+                << "\n\nHTML converted to XML: " << convertedXml);
         return false;
     }
 
@@ -1277,6 +1433,59 @@ bool ENMLConverterPrivate::validateAndFixupEnml(
     return validateEnml(enml, errorDescription);
 }
 
+bool ENMLConverterPrivate::validateAndFixupEnml(
+    QVector<Note> & notes, QVector<ErrorString> & errorDescriptions) const
+{
+    QNDEBUG(
+        "enml",
+        "ENMLConverterPrivate::validateAndFixupEnml: " << notes.size()
+                                                       << " notes");
+
+    const int numNotes = notes.size();
+
+    QVector<QString> contents;
+    contents.reserve(numNotes);
+    for (const auto & note: qAsConst(notes)) {
+        contents << (note.hasContent() ? note.content() : QString());
+    }
+
+    errorDescriptions.clear();
+    errorDescriptions.resize(numNotes);
+
+    // Pointers to the data of unshared vectors are used from multiple threads
+    // to avoid detaching the vectors in the non-const operator[]
+    QString * pContents = contents.data();
+    ErrorString * pErrorDescriptions = errorDescriptions.data();
+
+    // libxml2 needs to be initialized in the calling thread before it is used
+    // from multiple threads
+    xmlInitParser();
+
+    processInParallel(numNotes, [&](const int index) {
+        QString & content = pContents[index];
+        if (content.isEmpty()) {
+            return;
+        }
+
+        Q_UNUSED(validateAndFixupEnml(content, pErrorDescriptions[index]))
+    });
+
+    bool res = true;
+    for (int i = 0; i < numNotes; ++i) {
+        if (!errorDescriptions.at(i).isEmpty()) {
+            res = false;
+            continue;
+        }
+
+        auto & note = notes[i];
+        if (note.hasContent() && (note.content() != contents.at(i))) {
+            note.setContent(contents.at(i));
+        }
+    }
+
+    return res;
+}
+
 bool ENMLConverterPrivate::noteContentToPlainText(
     const QString & noteContent, QString & plainText,
     ErrorString & errorMessage)
@@ -1367,6 +1576,79 @@ bool ENMLConverterPrivate::noteContentToListOfWords(
     return true;
 }
 
+bool ENMLConverterPrivate::noteContentToPlainText(
+    const QVector<Note> & notes, QStringList & plainTexts,
+    QVector<ErrorString> & errorDescriptions)
+{
+    QNDEBUG(
+        "enml",
+        "ENMLConverterPrivate::noteContentToPlainText: " << notes.size()
+                                                         << " notes");
+
+    const int numNotes = notes.size();
+
+    QVector<QString> results(numNotes);
+    errorDescriptions.clear();
+    errorDescriptions.resize(numNotes);
+
+    QString * pResults = results.data();
+    ErrorString * pErrorDescriptions = errorDescriptions.data();
+
+    processInParallel(numNotes, [&](const int index) {
+        const auto & note = notes.at(index);
+        if (!note.hasContent()) {
+            return;
+        }
+
+        Q_UNUSED(noteContentToPlainText(
+            note.content(), pResults[index], pErrorDescriptions[index]))
+    });
+
+    plainTexts.clear();
+    plainTexts.reserve(numNotes);
+    for (const auto & plainText: qAsConst(results)) {
+        plainTexts << plainText;
+    }
+
+    return std::all_of(
+        errorDescriptions.constBegin(), errorDescriptions.constEnd(),
+        [](const ErrorString & error) { return error.isEmpty(); });
+}
+
+bool ENMLConverterPrivate::noteContentToListOfWords(
+    const QVector<Note> & notes, QVector<QStringList> & listsOfWords,
+    QVector<ErrorString> & errorDescriptions)
+{
+    QNDEBUG(
+        "enml",
+        "ENMLConverterPrivate::noteContentToListOfWords: " << notes.size()
+                                                           << " notes");
+
+    const int numNotes = notes.size();
+
+    listsOfWords.clear();
+    listsOfWords.resize(numNotes);
+    errorDescriptions.clear();
+    errorDescriptions.resize(numNotes);
+
+    QStringList * pListsOfWords = listsOfWords.data();
+    ErrorString * pErrorDescriptions = errorDescriptions.data();
+
+    processInParallel(numNotes, [&](const int index) {
+        const auto & note = notes.at(index);
+        if (!note.hasContent()) {
+            return;
+        }
+
+        Q_UNUSED(noteContentToListOfWords(
+            note.content(), pListsOfWords[index], pErrorDescriptions[index]))
+    });
+
+    return std::all_of(
+        errorDescriptions.constBegin(), errorDescriptions.constEnd(),
+        [](const ErrorString & error) { return error.isEmpty(); });
+}
+
 QStringList ENMLConverterPrivate::plainTextToListOfWords(
     const QString & plainText)
 {
@@ -3272,22 +3554,16 @@ bool ENMLConverterPrivate::importEnex(
     return true;
 }
 
-bool ENMLConverterPrivate::isForbiddenXhtmlTag(const QString & tagName) const
+bool ENMLConverterPrivate::isForbiddenXhtmlTag(
+    const QStringRef & tagName) const
 {
-    auto it = m_forbiddenXhtmlTags.find(tagName);
-    if (it == m_forbiddenXhtmlTags.end()) {
-        return false;
-    }
-    else {
-        return true;
-    }
+    return forbiddenXhtmlTags.contains(tagName);
 }
 
 bool ENMLConverterPrivate::isForbiddenXhtmlAttribute(
-    const QString & attributeName) const
+    const QStringRef & attributeName) const
 {
-    auto it = m_forbiddenXhtmlAttributes.find(attributeName);
-    if (it != m_forbiddenXhtmlAttributes.end()) {
+    if (forbiddenXhtmlAttributes.contains(attributeName)) {
         return true;
     }
 
@@ -3295,26 +3571,20 @@ bool ENMLConverterPrivate::isForbiddenXhtmlAttribute(
 }
 
 bool ENMLConverterPrivate::isEvernoteSpecificXhtmlTag(
-    const QString & tagName) const
+    const QStringRef & tagName) const
 {
-    auto it = m_evernoteSpecificXhtmlTags.find(tagName);
-    if (it == m_evernoteSpecificXhtmlTags.end()) {
-        return false;
-    }
-    else {
-        return true;
-    }
+    return evernoteSpecificXhtmlTags.contains(tagName);
 }
 
-bool ENMLConverterPrivate::isAllowedXhtmlTag(const QString & tagName) const
+bool ENMLConverterPrivate::isAllowedXhtmlTag(const QStringRef & tagName) const
 {
-    auto it = m_allowedXhtmlTags.find(tagName);
-    if (it == m_allowedXhtmlTags.end()) {
-        return false;
-    }
-    else {
-        return true;
-    }
+    return allowedXhtmlTags.contains(tagName);
+}
+
+bool ENMLConverterPrivate::isAllowedEnMediaAttribute(
+    const QStringRef & attributeName) const
+{
+    return allowedEnMediaAttributes.contains(attributeName);
 }
 
 void ENMLConverterPrivate::toDoTagsToHtml(
@@ -3835,8 +4105,8 @@ bool ENMLConverterPrivate::validateAgainstDtd(
         return false;
     }
 
-    QFile dtdFile(dtdFilePath);
-    if (!dtdFile.open(QIODevice::ReadOnly)) {
+    QByteArray dtdData = dtdRawData(dtdFilePath);
+    if (dtdData.isEmpty()) {
         errorDescription.setBase(
             QT_TR_NOOP("Could not validate document, can't "
                        "open the resource file with DTD"));
@@ -3848,10 +4118,8 @@ bool ENMLConverterPrivate::validateAgainstDtd(
         return false;
     }
 
-    QByteArray dtdRawData = dtdFile.readAll();
-
     xmlParserInputBufferPtr pBuf = xmlParserInputBufferCreateMem(
-        dtdRawData.constData(), dtdRawData.size(), XML_CHAR_ENCODING_UTF8);
+        dtdData.constData(), dtdData.size(), XML_CHAR_ENCODING_UTF8);
 
     if (!pBuf) {
         errorDescription.setBase(
@@ -4115,52 +4383,53 @@ ENMLConverterPrivate::processElementForHtmlToNoteContentConversion(
         return ProcessElementStatus::ProcessedFully;
     }
 
-    state.m_lastElementName = reader.name().toString();
-    if (state.m_lastElementName == QStringLiteral("form")) {
+    // Element names are matched against the tag tables through the reader's
+    // own buffer; the name is copied into the state only for elements which
+    // actually survive the filtering
+    QStringRef elementName = reader.name();
+    if (elementName == QStringLiteral("form")) {
         QNTRACE("enml", "Skipping <form> tag");
         return ProcessElementStatus::ProcessedFully;
     }
 
-    if (state.m_lastElementName == QStringLiteral("html")) {
+    if (elementName == QStringLiteral("html")) {
         QNTRACE("enml", "Skipping <html> tag");
         return ProcessElementStatus::ProcessedFully;
     }
 
-    if (state.m_lastElementName == QStringLiteral("title")) {
+    if (elementName == QStringLiteral("title")) {
         QNTRACE("enml", "Skipping <title> tag");
         return ProcessElementStatus::ProcessedFully;
     }
 
-    if (state.m_lastElementName == QStringLiteral("body")) {
+    if (elementName == QStringLiteral("body")) {
         state.m_lastElementName = QStringLiteral("en-note");
         QNTRACE(
             "enml",
             "Found \"body\" HTML tag, will replace it "
                 << "with \"en-note\" tag for written ENML");
     }
+    else {
+        if (isForbiddenXhtmlTag(elementName) &&
+            (elementName != QStringLiteral("object")))
+        {
+            QNTRACE("enml", "Skipping forbidden XHTML tag: " << elementName);
+            return ProcessElementStatus::ProcessedFully;
+        }
 
-    auto tagIt = m_forbiddenXhtmlTags.find(state.m_lastElementName);
-    if ((tagIt != m_forbiddenXhtmlTags.constEnd()) &&
-        (state.m_lastElementName != QStringLiteral("object")))
-    {
-        QNTRACE(
-            "enml",
-            "Skipping forbidden XHTML tag: " << state.m_lastElementName);
-        return ProcessElementStatus::ProcessedFully;
-    }
-
-    tagIt = m_allowedXhtmlTags.find(state.m_lastElementName);
-    if (tagIt == m_allowedXhtmlTags.end()) {
-        tagIt = m_evernoteSpecificXhtmlTags.find(state.m_lastElementName);
-        if (tagIt == m_evernoteSpecificXhtmlTags.end()) {
+        if (!isAllowedXhtmlTag(elementName) &&
+            !isEvernoteSpecificXhtmlTag(elementName))
+        {
             QNTRACE(
                 "enml",
                 "Haven't found tag "
-                    << state.m_lastElementName
+                    << elementName
                     << " within the list of allowed XHTML tags or within "
                     << "Evernote-specific tags, skipping it");
             return ProcessElementStatus::ProcessedFully;
         }
+
+        state.m_lastElementName = elementName.toString();
     }
 
     state.m_lastElementAttributes = reader.attributes();
@@ -4193,9 +4462,8 @@ ENMLConverterPrivate::processElementForHtmlToNoteContentConversion(
          (state.m_lastElementName == QStringLiteral("div"))) &&
         state.m_lastElementAttributes.hasAttribute(QStringLiteral("en-tag")))
     {
-        const QString enTag =
-            state.m_lastElementAttributes.value(QStringLiteral("en-tag"))
-                .toString();
+        const QStringRef enTag =
+            state.m_lastElementAttributes.value(QStringLiteral("en-tag"));
 
         if (enTag == QStringLiteral("en-decrypted")) {
             QNTRACE(
@@ -4293,34 +4561,30 @@ ENMLConverterPrivate::processElementForHtmlToNoteContentConversion(
             for (int i = 0; i < numAttributes; ++i) {
                 const auto & attribute = state.m_lastElementAttributes[i];
 
-                const QString attributeQualifiedName =
-                    attribute.qualifiedName().toString();
-
-                const QString attributeValue = attribute.value().toString();
+                const QStringRef attributeQualifiedName =
+                    attribute.qualifiedName();
 
                 if (!isImage) {
                     if (attributeQualifiedName ==
                         QStringLiteral("resource-mime-type")) {
                         state.m_enMediaAttributes.append(
-                            QStringLiteral("type"), attributeValue);
+                            QStringLiteral("type"),
+                            attribute.value().toString());
                     }
-                    else {
-                        bool contains = m_allowedEnMediaAttributes.contains(
-                            attributeQualifiedName);
-
-                        if (contains &&
-                            (attributeQualifiedName != QStringLiteral("type")))
-                        {
-                            state.m_enMediaAttributes.append(
-                                attributeQualifiedName, attributeValue);
-                        }
+                    else if (
+                        isAllowedEnMediaAttribute(attributeQualifiedName) &&
+                        (attributeQualifiedName != QStringLiteral("type")))
+                    {
+                        state.m_enMediaAttributes.append(
+                            attributeQualifiedName.toString(),
+                            attribute.value().toString());
                     }
                 }
-                else if (m_allowedEnMediaAttributes.contains(
-                             attributeQualifiedName)) {
+                else if (isAllowedEnMediaAttribute(attributeQualifiedName)) {
                     // img
                     state.m_enMediaAttributes.append(
-                        attributeQualifiedName, attributeValue);
+                        attributeQualifiedName.toString(),
+                        attribute.value().toString());
                 }
             }
 
@@ -4337,7 +4601,7 @@ ENMLConverterPrivate::processElementForHtmlToNoteContentConversion(
          it != state.m_lastElementAttributes.end();)
     {
         QStringRef attributeName = it->name();
-        if (isForbiddenXhtmlAttribute(attributeName.toString())) {
+        if (isForbiddenXhtmlAttribute(attributeName)) {
             QNTRACE("enml", "Erasing forbidden attribute " << attributeName);
             it = state.m_lastElementAttributes.erase(it);
             continue;
@@ -34,7 +34,6 @@ QT_FORWARD_DECLARE_CLASS(QXmlStreamWriter)
 namespace quentier {
 
 QT_FORWARD_DECLARE_CLASS(DecryptedTextManager)
-QT_FORWARD_DECLARE_CLASS(HTMLCleaner)
 QT_FORWARD_DECLARE_CLASS(Resource)
 
 enum class SkipElementOption
@@ -87,14 +86,25 @@ public:
     bool validateAndFixupEnml(
         QString & enml, ErrorString & errorDescription) const;
 
+    bool validateAndFixupEnml(
+        QVector<Note> & notes, QVector<ErrorString> & errorDescriptions) const;
+
     static bool noteContentToPlainText(
         const QString & noteContent, QString & plainText,
         ErrorString & errorMessage);
 
+    static bool noteContentToPlainText(
+        const QVector<Note> & notes, QStringList & plainTexts,
+        QVector<ErrorString> & errorDescriptions);
+
     static bool noteContentToListOfWords(
         const QString & noteContent, QStringList & listOfWords,
         ErrorString & errorMessage, QString * plainText = nullptr);
 
+    static bool noteContentToListOfWords(
+        const QVector<Note> & notes, QVector<QStringList> & listsOfWords,
+        QVector<ErrorString> & errorDescriptions);
+
     static QStringList plainTextToListOfWords(const QString & plainText);
 
     static QString toDoCheckboxHtml(const bool checked, const quint64 idNumber);
@@ -126,10 +136,11 @@ public:
         ErrorString & errorDescription) const;
 
 private:
-    bool isForbiddenXhtmlTag(const QString & tagName) const;
-    bool isForbiddenXhtmlAttribute(const QString & attributeName) const;
-    bool isEvernoteSpecificXhtmlTag(const QString & tagName) const;
-    bool isAllowedXhtmlTag(const QString & tagName) const;
+    bool isForbiddenXhtmlTag(const QStringRef & tagName) const;
+    bool isForbiddenXhtmlAttribute(const QStringRef & attributeName) const;
+    bool isEvernoteSpecificXhtmlTag(const QStringRef & tagName) const;
+    bool isAllowedXhtmlTag(const QStringRef & tagName) const;
+    bool isAllowedEnMediaAttribute(const QStringRef & attributeName) const;
 
     // convert <div> element with decrypted text to ENML <en-crypt> tag
     bool decryptedTextToEnml(
@@ -203,18 +214,6 @@ private:
 
 private:
     Q_DISABLE_COPY(ENMLConverterPrivate)
-
-private:
-    const QSet<QString> m_forbiddenXhtmlTags;
-    const QSet<QString> m_forbiddenXhtmlAttributes;
-    const QSet<QString> m_evernoteSpecificXhtmlTags;
-    const QSet<QString> m_allowedXhtmlTags;
-    const QSet<QString> m_allowedEnMediaAttributes;
-
-    mutable HTMLCleaner * m_pHtmlCleaner;
-
-    // Cached memory for the html converted to valid xml
-    mutable QString m_cachedConvertedXml;
 };
 
 } // namespace quentier
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_ENML_STATIC_STRING_SET_H
+#define LIB_QUENTIER_ENML_STATIC_STRING_SET_H
+
+#include <QString>
+#include <QStringRef>
+#include <QtGlobal>
+
+#include <cstddef>
+
+namespace quentier {
+
+constexpr quint32 staticStringHashOffsetBasis = 2166136261u;
+constexpr quint32 staticStringHashPrime = 16777619u;
+
+// The seed search is bounded to keep the compile time evaluation cheap
+constexpr quint32 staticStringSetMaxSeed = 1024u;
+
+constexpr std::size_t staticStringLength(const char * str)
+{
+    std::size_t size = 0;
+    while (str[size] != '\0') {
+        ++size;
+    }
+
+    return size;
+}
+
+/**
+ * Seeded FNV-1a hash of ASCII string; the runtime counterpart working on
+ * UTF-16 data is StaticStringSet::contains
+ */
+constexpr quint32 staticStringHash(
+    const quint32 seed, const char * str, const std::size_t size)
+{
+    quint32 hash = staticStringHashOffsetBasis ^ seed;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(str[i]);
+        hash *= staticStringHashPrime;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief The StaticStringSet struct is a set of ASCII strings known at compile
+ * time organized as a perfect hash table: each key occupies its own slot so
+ * the lookup computes a single hash and compares at most one key. The lookup
+ * works directly on UTF-16 data of QStringRef and doesn't allocate.
+ *
+ * The instances are meant to be created via makeStaticStringSet function
+ * in constant expressions.
+ */
+template <std::size_t NumKeys, std::size_t NumSlots>
+struct Q_DECL_HIDDEN StaticStringSet
+{
+    static_assert(
+        (NumSlots != 0) && ((NumSlots & (NumSlots - 1)) == 0),
+        "The number of slots must be a power of two");
+
+    static_assert(NumKeys < 255, "Too many keys for the slot index type");
+
+    static_assert(NumKeys <= NumSlots, "Too few slots for the keys");
+
+    bool contains(const QStringRef & str) const
+    {
+        const int size = str.size();
+        const QChar * data = str.unicode();
+
+        quint32 hash = staticStringHashOffsetBasis ^ m_seed;
+        for (int i = 0; i < size; ++i) {
+            const ushort c = data[i].unicode();
+            if (c > 127) {
+                return false;
+            }
+
+            hash ^= c;
+            hash *= staticStringHashPrime;
+        }
+
+        const quint8 slot = m_slots[hash & (NumSlots - 1)];
+        if (slot == 0) {
+            return false;
+        }
+
+        const std::size_t index = slot - 1;
+        if (m_keySizes[index] != static_cast<std::size_t>(size)) {
+            return false;
+        }
+
+        const char * key = m_keys[index];
+        for (int i = 0; i < size; ++i) {
+            if (data[i].unicode() != static_cast<unsigned char>(key[i])) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool contains(const QString & str) const
+    {
+        return contains(QStringRef(&str));
+    }
+
+    const char * m_keys[NumKeys];
+    std::size_t m_keySizes[NumKeys];
+
+    // Index of the key plus one, zero for empty slots
+    quint8 m_slots[NumSlots];
+
+    // Equals staticStringSetMaxSeed if no perfect seed was found
+    quint32 m_seed;
+};
+
+template <std::size_t NumKeys, std::size_t NumSlots>
+constexpr bool isPerfectStaticStringSetSeed(
+    const StaticStringSet<NumKeys, NumSlots> & set, const quint32 seed)
+{
+    bool occupiedSlots[NumSlots] = {};
+    for (std::size_t i = 0; i < NumKeys; ++i) {
+        const std::size_t slot =
+            staticStringHash(seed, set.m_keys[i], set.m_keySizes[i]) &
+            (NumSlots - 1);
+
+        if (occupiedSlots[slot]) {
+            return false;
+        }
+
+        occupiedSlots[slot] = true;
+    }
+
+    return true;
+}
+
+/**
+ * Builds the perfect hash table for the passed in keys; check the seed of
+ * the result against staticStringSetMaxSeed to ensure the table was built:
+ * if it wasn't, increase the number of slots
+ */
+template <std::size_t NumSlots, std::size_t NumKeys>
+constexpr StaticStringSet<NumKeys, NumSlots> makeStaticStringSet(
+    const char * const (&keys)[NumKeys])
+{
+    StaticStringSet<NumKeys, NumSlots> set{};
+    for (std::size_t i = 0; i < NumKeys; ++i) {
+        set.m_keys[i] = keys[i];
+        set.m_keySizes[i] = staticStringLength(keys[i]);
+    }
+
+    quint32 seed = 0;
+    while ((seed < staticStringSetMaxSeed) &&
+           !isPerfectStaticStringSetSeed(set, seed))
+    {
+        ++seed;
+    }
+
+    set.m_seed = seed;
+    if (seed == staticStringSetMaxSeed) {
+        return set;
+    }
+
+    for (std::size_t i = 0; i < NumKeys; ++i) {
+        const std::size_t slot =
+            staticStringHash(seed, set.m_keys[i], set.m_keySizes[i]) &
+            (NumSlots - 1);
+
+        set.m_slots[slot] = static_cast<quint8>(i + 1);
+    }
+
+    return set;
+}
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_ENML_STATIC_STRING_SET_H
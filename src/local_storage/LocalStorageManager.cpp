@@ -121,6 +121,35 @@ qint32 LocalStorageManager::highestSupportedLocalStorageVersion() const
     return d->highestSupportedLocalStorageVersion();
 }
 
+bool LocalStorageManager::databaseFragmentationStatistics(
+    qint64 & pageSize, qint64 & pageCount, qint64 & freePageCount,
+    ErrorString & errorDescription) const
+{
+    Q_D(const LocalStorageManager);
+    return d->databaseFragmentationStatistics(
+        pageSize, pageCount, freePageCount, errorDescription);
+}
+
+qint64 LocalStorageManager::writeAheadLogFileSize() const
+{
+    Q_D(const LocalStorageManager);
+    return d->writeAheadLogFileSize();
+}
+
+int LocalStorageManager::incrementalVacuum(
+    const int maxPages, ErrorString & errorDescription)
+{
+    Q_D(LocalStorageManager);
+    return d->incrementalVacuum(maxPages, errorDescription);
+}
+
+bool LocalStorageManager::checkpointWriteAheadLog(
+    ErrorString & errorDescription)
+{
+    Q_D(LocalStorageManager);
+    return d->checkpointWriteAheadLog(errorDescription);
+}
+
 int LocalStorageManager::userCount(ErrorString & errorDescription) const
 {
     Q_D(const LocalStorageManager);
@@ -449,6 +478,16 @@ bool LocalStorageManager::findTag(
     return d->findTag(tag, errorDescription);
 }
 
+bool LocalStorageManager::findOrAddTags(
+    const QList<Tag> & tags, QList<Tag> & addedTags,
+    QHash<QString, Tag> & localConflictsByGuid, ErrorString & errorDescription)
+{
+    Q_D(LocalStorageManager);
+
+    return d->findOrAddTags(
+        tags, addedTags, localConflictsByGuid, errorDescription);
+}
+
 QList<Tag> LocalStorageManager::listAllTagsPerNote(
     const Note & note, ErrorString & errorDescription,
     const ListObjectsOptions & flag, const size_t limit, const size_t offset,
@@ -606,6 +645,13 @@ qint32 LocalStorageManager::accountHighUsn(
     return d->accountHighUsn(linkedNotebookGuid, errorDescription);
 }
 
+bool LocalStorageManager::guidIndex(
+    GuidIndex & index, ErrorString & errorDescription)
+{
+    Q_D(LocalStorageManager);
+    return d->guidIndex(index, errorDescription);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace {
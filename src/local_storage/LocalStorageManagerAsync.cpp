@@ -16,6 +16,8 @@
  * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "LocalStorageRequestTracer.h"
+
 #include <quentier/local_storage/LocalStorageManagerAsync.h>
 #include <quentier/local_storage/NoteSearchQuery.h>
 #include <quentier/logging/QuentierLogger.h>
@@ -24,6 +26,23 @@
 #include <quentier/utility/SysInfo.h>
 
 #include <QMetaMethod>
+#include <QTimerEvent>
+
+#include <algorithm>
+
+#define BACKGROUND_COMPACTION_DEFAULT_INTERVAL_MSEC (5000)
+#define BACKGROUND_COMPACTION_DEFAULT_PAGES_PER_SLICE (256)
+#define WAL_CHECKPOINT_DEFAULT_THRESHOLD (16 * 1024 * 1024)
+
+// Measures the processing of the request within the slot; is a no-op unless
+// request tracing is enabled
+#define TRACE_LOCAL_STORAGE_REQUEST()                                          \
+    LocalStorageRequestTracer::RequestScope requestTraceScope(                 \
+        d->m_requestTracer, __func__, requestId);                              \
+    if (requestTraceScope.isActive()) {                                        \
+        requestTraceScope.measureQueueWait(                                    \
+            sender(), senderSignalIndex(), thread());                          \
+    }
 
 namespace quentier {
 
@@ -85,6 +104,21 @@ public:
 
     LocalStorageManager * m_pLocalStorageManager = nullptr;
     LocalStorageCacheManager * m_pLocalStorageCacheManager = nullptr;
+
+    bool m_backgroundCompactionEnabled = false;
+
+    int m_backgroundCompactionIntervalMsec =
+        BACKGROUND_COMPACTION_DEFAULT_INTERVAL_MSEC;
+
+    int m_backgroundCompactionPagesPerSlice =
+        BACKGROUND_COMPACTION_DEFAULT_PAGES_PER_SLICE;
+
+    qint64 m_walCheckpointThreshold = WAL_CHECKPOINT_DEFAULT_THRESHOLD;
+
+    int m_backgroundCompactionTimerId = 0;
+    quint64 m_numWalCheckpoints = 0;
+
+    LocalStorageRequestTracer m_requestTracer;
 };
 
 namespace {
@@ -167,6 +201,170 @@ LocalStorageManager * LocalStorageManagerAsync::localStorageManager()
     return d->m_pLocalStorageManager;
 }
 
+void LocalStorageManagerAsync::setBackgroundCompactionEnabled(
+    const bool enabled)
+{
+    Q_D(LocalStorageManagerAsync);
+    d->m_backgroundCompactionEnabled = enabled;
+    restartBackgroundCompactionTimer();
+}
+
+void LocalStorageManagerAsync::setBackgroundCompactionIntervalMsec(
+    const int intervalMsec)
+{
+    Q_D(LocalStorageManagerAsync);
+    d->m_backgroundCompactionIntervalMsec = std::max(intervalMsec, 1);
+    restartBackgroundCompactionTimer();
+}
+
+void LocalStorageManagerAsync::setBackgroundCompactionPagesPerSlice(
+    const int pagesPerSlice)
+{
+    Q_D(LocalStorageManagerAsync);
+    d->m_backgroundCompactionPagesPerSlice = std::max(pagesPerSlice, 1);
+}
+
+void LocalStorageManagerAsync::setWriteAheadLogCheckpointThreshold(
+    const qint64 walFileSizeThreshold)
+{
+    Q_D(LocalStorageManagerAsync);
+    d->m_walCheckpointThreshold = walFileSizeThreshold;
+}
+
+void LocalStorageManagerAsync::setRequestTracingEnabled(const bool enabled)
+{
+    Q_D(LocalStorageManagerAsync);
+    d->m_requestTracer.setEnabled(enabled);
+}
+
+void LocalStorageManagerAsync::setSlowQueryThresholdMsec(
+    const int thresholdMsec)
+{
+    Q_D(LocalStorageManagerAsync);
+    d->m_requestTracer.setSlowQueryThresholdMsec(thresholdMsec);
+}
+
+LocalStorageRequestTraceSnapshot
+LocalStorageManagerAsync::requestTraceSnapshot() const
+{
+    Q_D(const LocalStorageManagerAsync);
+    return d->m_requestTracer.snapshot();
+}
+
+void LocalStorageManagerAsync::clearRequestTrace()
+{
+    Q_D(LocalStorageManagerAsync);
+    d->m_requestTracer.clear();
+}
+
+void LocalStorageManagerAsync::timerEvent(QTimerEvent * pEvent)
+{
+    Q_D(LocalStorageManagerAsync);
+
+    if (Q_UNLIKELY(!pEvent)) {
+        return;
+    }
+
+    if (pEvent->timerId() != d->m_backgroundCompactionTimerId) {
+        QObject::timerEvent(pEvent);
+        return;
+    }
+
+    try {
+        runBackgroundCompactionSlice();
+    }
+    catch (const std::exception & e) {
+        QNWARNING(
+            "local_storage",
+            "Caught exception during background compaction of the local "
+                << "storage: " << e.what());
+    }
+}
+
+void LocalStorageManagerAsync::restartBackgroundCompactionTimer()
+{
+    Q_D(LocalStorageManagerAsync);
+
+    if (d->m_backgroundCompactionTimerId != 0) {
+        killTimer(d->m_backgroundCompactionTimerId);
+        d->m_backgroundCompactionTimerId = 0;
+    }
+
+    if (!d->m_backgroundCompactionEnabled || !d->m_pLocalStorageManager) {
+        return;
+    }
+
+    // The timer events are processed in between the requests to
+    // LocalStorageManagerAsync so each slice of compaction only delays
+    // the processing of subsequent requests for as long as it takes to
+    // reclaim the limited number of pages
+    d->m_backgroundCompactionTimerId = startTimer(
+        d->m_backgroundCompactionIntervalMsec, Qt::VeryCoarseTimer);
+}
+
+void LocalStorageManagerAsync::runBackgroundCompactionSlice()
+{
+    Q_D(LocalStorageManagerAsync);
+
+    if (Q_UNLIKELY(!d->m_pLocalStorageManager)) {
+        return;
+    }
+
+    ErrorString errorDescription;
+    qint64 pageSize = 0;
+    qint64 pageCount = 0;
+    qint64 freePageCount = 0;
+
+    if (!d->m_pLocalStorageManager->databaseFragmentationStatistics(
+            pageSize, pageCount, freePageCount, errorDescription))
+    {
+        QNWARNING("local_storage", errorDescription);
+        return;
+    }
+
+    if (freePageCount > 0) {
+        int maxPages = static_cast<int>(std::min(
+            freePageCount,
+            static_cast<qint64>(d->m_backgroundCompactionPagesPerSlice)));
+
+        int numReclaimedPages = d->m_pLocalStorageManager->incrementalVacuum(
+            maxPages, errorDescription);
+
+        if (numReclaimedPages < 0) {
+            QNWARNING("local_storage", errorDescription);
+        }
+        else if (numReclaimedPages > 0) {
+            pageCount -= numReclaimedPages;
+            freePageCount -= numReclaimedPages;
+        }
+    }
+
+    Q_EMIT databaseFragmentationStatisticsUpdated(
+        pageSize, pageCount, freePageCount);
+
+    qint64 walFileSize = d->m_pLocalStorageManager->writeAheadLogFileSize();
+    if (walFileSize > d->m_walCheckpointThreshold) {
+        QNDEBUG(
+            "local_storage",
+            "Write-ahead log file size " << walFileSize
+                << " exceeds the threshold, checkpointing");
+
+        errorDescription.clear();
+        if (d->m_pLocalStorageManager->checkpointWriteAheadLog(
+                errorDescription))
+        {
+            ++d->m_numWalCheckpoints;
+            walFileSize = d->m_pLocalStorageManager->writeAheadLogFileSize();
+        }
+        else {
+            QNWARNING("local_storage", errorDescription);
+        }
+    }
+
+    Q_EMIT writeAheadLogStatisticsUpdated(
+        walFileSize, d->m_numWalCheckpoints);
+}
+
 void LocalStorageManagerAsync::init()
 {
     Q_D(LocalStorageManagerAsync);
@@ -184,12 +382,15 @@ void LocalStorageManagerAsync::init()
 
     d->m_pLocalStorageCacheManager = new LocalStorageCacheManager();
 
+    restartBackgroundCompactionTimer();
+
     Q_EMIT initialized();
 }
 
 void LocalStorageManagerAsync::onGetUserCountRequest(QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -221,6 +422,7 @@ void LocalStorageManagerAsync::onSwitchUserRequest(
     QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         d->m_pLocalStorageManager->switchUser(account, startupOptions);
@@ -250,6 +452,7 @@ void LocalStorageManagerAsync::onSwitchUserRequest(
 void LocalStorageManagerAsync::onAddUserRequest(User user, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -280,6 +483,7 @@ void LocalStorageManagerAsync::onAddUserRequest(User user, QUuid requestId)
 void LocalStorageManagerAsync::onUpdateUserRequest(User user, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -312,6 +516,7 @@ void LocalStorageManagerAsync::onUpdateUserRequest(User user, QUuid requestId)
 void LocalStorageManagerAsync::onFindUserRequest(User user, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -342,6 +547,7 @@ void LocalStorageManagerAsync::onFindUserRequest(User user, QUuid requestId)
 void LocalStorageManagerAsync::onDeleteUserRequest(User user, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -373,6 +579,7 @@ void LocalStorageManagerAsync::onDeleteUserRequest(User user, QUuid requestId)
 void LocalStorageManagerAsync::onExpungeUserRequest(User user, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -405,6 +612,7 @@ void LocalStorageManagerAsync::onExpungeUserRequest(User user, QUuid requestId)
 void LocalStorageManagerAsync::onGetNotebookCountRequest(QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -435,6 +643,7 @@ void LocalStorageManagerAsync::onAddNotebookRequest(
     Notebook notebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -472,6 +681,7 @@ void LocalStorageManagerAsync::onUpdateNotebookRequest(
     Notebook notebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -509,6 +719,7 @@ void LocalStorageManagerAsync::onFindNotebookRequest(
     Notebook notebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -578,6 +789,7 @@ void LocalStorageManagerAsync::onFindDefaultNotebookRequest(
     Notebook notebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -612,6 +824,7 @@ void LocalStorageManagerAsync::onFindLastUsedNotebookRequest(
     Notebook notebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -646,6 +859,7 @@ void LocalStorageManagerAsync::onFindDefaultOrLastUsedNotebookRequest(
     Notebook notebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -682,6 +896,7 @@ void LocalStorageManagerAsync::onListAllNotebooksRequest(
     QString linkedNotebookGuid, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -726,6 +941,7 @@ void LocalStorageManagerAsync::onListAllNotebooksRequest(
 void LocalStorageManagerAsync::onListAllSharedNotebooksRequest(QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -760,6 +976,7 @@ void LocalStorageManagerAsync::onListNotebooksRequest(
     QString linkedNotebookGuid, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -805,6 +1022,7 @@ void LocalStorageManagerAsync::onListSharedNotebooksPerNotebookGuidRequest(
     QString notebookGuid, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -841,6 +1059,7 @@ void LocalStorageManagerAsync::onExpungeNotebookRequest(
     Notebook notebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -877,6 +1096,7 @@ void LocalStorageManagerAsync::onExpungeNotebookRequest(
 void LocalStorageManagerAsync::onGetLinkedNotebookCountRequest(QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -908,6 +1128,7 @@ void LocalStorageManagerAsync::onAddLinkedNotebookRequest(
     LinkedNotebook linkedNotebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -946,6 +1167,7 @@ void LocalStorageManagerAsync::onUpdateLinkedNotebookRequest(
     LinkedNotebook linkedNotebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -984,6 +1206,7 @@ void LocalStorageManagerAsync::onFindLinkedNotebookRequest(
     LinkedNotebook linkedNotebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1033,6 +1256,7 @@ void LocalStorageManagerAsync::onListAllLinkedNotebooksRequest(
     LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1079,6 +1303,7 @@ void LocalStorageManagerAsync::onListLinkedNotebooksRequest(
     LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1124,6 +1349,7 @@ void LocalStorageManagerAsync::onExpungeLinkedNotebookRequest(
     LinkedNotebook linkedNotebook, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1163,6 +1389,7 @@ void LocalStorageManagerAsync::onGetNoteCountRequest(
     LocalStorageManager::NoteCountOptions options, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1196,6 +1423,7 @@ void LocalStorageManagerAsync::onGetNoteCountPerNotebookRequest(
     QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1231,6 +1459,7 @@ void LocalStorageManagerAsync::onGetNoteCountPerTagRequest(
     Tag tag, LocalStorageManager::NoteCountOptions options, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1264,6 +1493,7 @@ void LocalStorageManagerAsync::onGetNoteCountsPerAllTagsRequest(
     LocalStorageManager::NoteCountOptions options, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1300,6 +1530,7 @@ void LocalStorageManagerAsync::onGetNoteCountPerNotebooksAndTagsRequest(
     LocalStorageManager::NoteCountOptions options, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1335,6 +1566,7 @@ void LocalStorageManagerAsync::onGetNoteCountPerNotebooksAndTagsRequest(
 void LocalStorageManagerAsync::onAddNoteRequest(Note note, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1380,6 +1612,7 @@ void LocalStorageManagerAsync::onUpdateNoteRequest(
     QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         bool shouldCheckForNotebookChange = false;
@@ -1590,6 +1823,7 @@ void LocalStorageManagerAsync::onFindNoteRequest(
     Note note, LocalStorageManager::GetNoteOptions options, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1710,6 +1944,7 @@ void LocalStorageManagerAsync::onListNotesPerNotebookRequest(
     LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1755,6 +1990,7 @@ void LocalStorageManagerAsync::onListNotesPerTagRequest(
     LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1800,6 +2036,7 @@ void LocalStorageManagerAsync::onListNotesPerNotebooksAndTagsRequest(
     LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1844,6 +2081,7 @@ void LocalStorageManagerAsync::onListNotesByLocalUidsRequest(
     LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1888,6 +2126,7 @@ void LocalStorageManagerAsync::onListNotesRequest(
     QString linkedNotebookGuid, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1929,6 +2168,7 @@ void LocalStorageManagerAsync::onFindNoteLocalUidsWithSearchQuery(
     NoteSearchQuery noteSearchQuery, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -1964,6 +2204,7 @@ void LocalStorageManagerAsync::onFindNoteLocalUidsWithSearchQuery(
 void LocalStorageManagerAsync::onExpungeNoteRequest(Note note, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2005,6 +2246,7 @@ void LocalStorageManagerAsync::onExpungeNoteRequest(Note note, QUuid requestId)
 void LocalStorageManagerAsync::onGetTagCountRequest(QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2034,6 +2276,7 @@ void LocalStorageManagerAsync::onGetTagCountRequest(QUuid requestId)
 void LocalStorageManagerAsync::onAddTagRequest(Tag tag, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2068,6 +2311,7 @@ void LocalStorageManagerAsync::onAddTagRequest(Tag tag, QUuid requestId)
 void LocalStorageManagerAsync::onUpdateTagRequest(Tag tag, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2102,6 +2346,7 @@ void LocalStorageManagerAsync::onUpdateTagRequest(Tag tag, QUuid requestId)
 void LocalStorageManagerAsync::onFindTagRequest(Tag tag, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2161,12 +2406,59 @@ void LocalStorageManagerAsync::onFindTagRequest(Tag tag, QUuid requestId)
     }
 }
 
+void LocalStorageManagerAsync::onFindOrAddTagsRequest(
+    QList<Tag> tags, QUuid requestId)
+{
+    Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
+
+    try {
+        ErrorString errorDescription;
+        QList<Tag> addedTags;
+        QHash<QString, Tag> localConflictsByGuid;
+
+        bool res = d->m_pLocalStorageManager->findOrAddTags(
+            tags, addedTags, localConflictsByGuid, errorDescription);
+
+        if (!res) {
+            Q_EMIT findOrAddTagsFailed(tags, errorDescription, requestId);
+            return;
+        }
+
+        for (const auto & tag: qAsConst(addedTags)) {
+            if (d->m_useCache) {
+                d->m_pLocalStorageCacheManager->cacheTag(tag);
+            }
+
+            // Listeners tracking the added tags need to know about each one
+            Q_EMIT addTagComplete(tag, requestId);
+        }
+
+        Q_EMIT findOrAddTagsComplete(
+            addedTags, localConflictsByGuid, requestId);
+    }
+    catch (const std::exception & e) {
+        ErrorString error(
+            QT_TR_NOOP("Can't find or add tags in the local storage: "
+                       "caught exception"));
+
+        error.details() = QString::fromUtf8(e.what());
+
+        SysInfo sysInfo;
+        QNERROR(
+            "local_storage", error << "; backtrace: " << sysInfo.stackTrace());
+
+        Q_EMIT findOrAddTagsFailed(tags, error, requestId);
+    }
+}
+
 void LocalStorageManagerAsync::onListAllTagsPerNoteRequest(
     Note note, LocalStorageManager::ListObjectsOptions flag, size_t limit,
     size_t offset, LocalStorageManager::ListTagsOrder order,
     LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2212,6 +2504,7 @@ void LocalStorageManagerAsync::onListAllTagsRequest(
     QString linkedNotebookGuid, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2261,6 +2554,7 @@ void LocalStorageManagerAsync::onListTagsRequest(
     QString linkedNotebookGuid, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2308,6 +2602,7 @@ void LocalStorageManagerAsync::onListTagsWithNoteLocalUidsRequest(
     QString linkedNotebookGuid, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2355,6 +2650,7 @@ void LocalStorageManagerAsync::onListTagsWithNoteLocalUidsRequest(
 void LocalStorageManagerAsync::onExpungeTagRequest(Tag tag, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2399,6 +2695,7 @@ void LocalStorageManagerAsync::onExpungeNotelessTagsFromLinkedNotebooksRequest(
     QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2437,6 +2734,7 @@ void LocalStorageManagerAsync::onExpungeNotelessTagsFromLinkedNotebooksRequest(
 void LocalStorageManagerAsync::onGetResourceCountRequest(QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2468,6 +2766,7 @@ void LocalStorageManagerAsync::onAddResourceRequest(
     Resource resource, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2505,6 +2804,7 @@ void LocalStorageManagerAsync::onUpdateResourceRequest(
     Resource resource, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2543,6 +2843,7 @@ void LocalStorageManagerAsync::onFindResourceRequest(
     QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2608,6 +2909,7 @@ void LocalStorageManagerAsync::onExpungeResourceRequest(
     Resource resource, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2644,6 +2946,7 @@ void LocalStorageManagerAsync::onExpungeResourceRequest(
 void LocalStorageManagerAsync::onGetSavedSearchCountRequest(QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2675,6 +2978,7 @@ void LocalStorageManagerAsync::onAddSavedSearchRequest(
     SavedSearch search, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2712,6 +3016,7 @@ void LocalStorageManagerAsync::onUpdateSavedSearchRequest(
     SavedSearch search, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2749,6 +3054,7 @@ void LocalStorageManagerAsync::onFindSavedSearchRequest(
     SavedSearch search, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2816,6 +3122,7 @@ void LocalStorageManagerAsync::onListAllSavedSearchesRequest(
     LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2861,6 +3168,7 @@ void LocalStorageManagerAsync::onListSavedSearchesRequest(
     LocalStorageManager::OrderDirection orderDirection, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2906,6 +3214,7 @@ void LocalStorageManagerAsync::onExpungeSavedSearchRequest(
     SavedSearch search, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2944,6 +3253,7 @@ void LocalStorageManagerAsync::onAccountHighUsnRequest(
     QString linkedNotebookGuid, QUuid requestId)
 {
     Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
 
     try {
         ErrorString errorDescription;
@@ -2975,4 +3285,38 @@ void LocalStorageManagerAsync::onAccountHighUsnRequest(
     }
 }
 
+void LocalStorageManagerAsync::onGuidIndexRequest(QUuid requestId)
+{
+    Q_D(LocalStorageManagerAsync);
+    TRACE_LOCAL_STORAGE_REQUEST()
+
+    try {
+        ErrorString errorDescription;
+        LocalStorageManager::GuidIndex index;
+
+        bool res =
+            d->m_pLocalStorageManager->guidIndex(index, errorDescription);
+
+        if (!res) {
+            Q_EMIT guidIndexFailed(errorDescription, requestId);
+            return;
+        }
+
+        Q_EMIT guidIndexComplete(index, requestId);
+    }
+    catch (const std::exception & e) {
+        ErrorString error(
+            QT_TR_NOOP("Can't collect the guid index from "
+                       "the local storage: caught exception"));
+
+        error.details() = QString::fromUtf8(e.what());
+
+        SysInfo sysInfo;
+        QNERROR(
+            "local_storage", error << "; backtrace: " << sysInfo.stackTrace());
+
+        Q_EMIT guidIndexFailed(error, requestId);
+    }
+}
+
 } // namespace quentier
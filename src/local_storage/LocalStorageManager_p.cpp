@@ -53,6 +53,15 @@ namespace quentier {
 
 #define QUENTIER_DATABASE_NAME "qn.storage.sqlite"
 
+/**
+ * Fingerprint of the database schema produced by createTables method; it is
+ * stored in user_version pragma of the database file once all the tables,
+ * indices and triggers are created. If the fingerprint within the database file
+ * matches this value, the creation of tables is skipped on switching to the
+ * account. The value must be increased whenever createTables changes
+ */
+#define QUENTIER_DATABASE_SCHEMA_FINGERPRINT 4
+
 ////////////////////////////////////////////////////////////////////////////////
 
 using GetNoteOption = LocalStorageManager::GetNoteOption;
@@ -236,7 +245,7 @@ bool LocalStorageManagerPrivate::findUser(
 
     query.bindValue(QStringLiteral(":id"), userId);
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     size_t counter = 0;
@@ -289,7 +298,7 @@ bool LocalStorageManagerPrivate::deleteUser(
     query.bindValue(QStringLiteral(":userIsLocal"), (user.isLocal() ? 1 : 0));
     query.bindValue(QStringLiteral(":id"), user.id());
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -317,7 +326,7 @@ bool LocalStorageManagerPrivate::expungeUser(
     QString userId = QString::number(id);
     query.bindValue(QStringLiteral(":id"), userId);
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -357,7 +366,7 @@ int LocalStorageManagerPrivate::notebookCount(
         return -1;
     }
 
-    res = query.exec();
+    res = execQuery(query);
     if (!res) {
         SET_ERROR();
         return -1;
@@ -574,7 +583,7 @@ void LocalStorageManagerPrivate::switchUser(
     }
 
     QSqlQuery query(m_sqlDatabase);
-    if (!query.exec(QStringLiteral("PRAGMA foreign_keys = ON"))) {
+    if (!execQuery(query, QStringLiteral("PRAGMA foreign_keys = ON"))) {
         QString lastErrorText = m_sqlDatabase.lastError().text();
         ErrorString error(
             QT_TR_NOOP("Can't set foreign_keys = ON pragma for "
@@ -583,13 +592,44 @@ void LocalStorageManagerPrivate::switchUser(
         throw DatabaseRequestException(error);
     }
 
+    ErrorString errorDescription;
+    qint32 schemaFingerprint = databaseSchemaFingerprint(errorDescription);
+    if (Q_UNLIKELY(schemaFingerprint < 0)) {
+        ErrorString error(
+            QT_TR_NOOP("Can't read the schema fingerprint of the local storage "
+                       "database"));
+        error.appendBase(errorDescription.base());
+        error.appendBase(errorDescription.additionalBases());
+        error.details() = errorDescription.details();
+        throw DatabaseRequestException(error);
+    }
+
+    if (schemaFingerprint == QUENTIER_DATABASE_SCHEMA_FINGERPRINT) {
+        // page_size and journal_mode pragmas are persisted within the database
+        // file and the tables have already been created so there's no need to
+        // do any of it again
+        QNDEBUG(
+            "local_storage",
+            "Database schema fingerprint matches the expected one, skipping "
+                << "the initialization of tables");
+        clearCachedQueries();
+        return;
+    }
+
+    QNDEBUG(
+        "local_storage",
+        "Database schema fingerprint " << schemaFingerprint
+            << " doesn't match the expected one: "
+            << QUENTIER_DATABASE_SCHEMA_FINGERPRINT
+            << ", initializing tables");
+
     SysInfo sysInfo;
     qint64 pageSize = sysInfo.pageSize();
 
     QString pageSizeQuery = QString::fromUtf8("PRAGMA page_size = %1")
                                 .arg(QString::number(pageSize));
 
-    if (!query.exec(pageSizeQuery)) {
+    if (!execQuery(query, pageSizeQuery)) {
         QString lastErrorText = m_sqlDatabase.lastError().text();
         ErrorString error(
             QT_TR_NOOP("Can't set page_size pragma for the local storage "
@@ -598,8 +638,20 @@ void LocalStorageManagerPrivate::switchUser(
         throw DatabaseRequestException(error);
     }
 
+    // Incremental auto vacuum can only be enabled for the database before
+    // the first table is created within it; for existing databases it is
+    // enabled by local storage patch from version 2 to version 3
+    if (!execQuery(query, QStringLiteral("PRAGMA auto_vacuum = INCREMENTAL"))) {
+        QString lastErrorText = m_sqlDatabase.lastError().text();
+        ErrorString error(
+            QT_TR_NOOP("Can't set auto_vacuum pragma for the local storage "
+                       "database"));
+        error.details() = lastErrorText;
+        throw DatabaseRequestException(error);
+    }
+
     QString writeAheadLoggingQuery = QStringLiteral("PRAGMA journal_mode=WAL");
-    if (!query.exec(writeAheadLoggingQuery)) {
+    if (!execQuery(query, writeAheadLoggingQuery)) {
         QString lastErrorText = m_sqlDatabase.lastError().text();
         ErrorString error(
             QT_TR_NOOP("Can't set journal_mode pragma to WAL for the local "
@@ -608,7 +660,6 @@ void LocalStorageManagerPrivate::switchUser(
         throw DatabaseRequestException(error);
     }
 
-    ErrorString errorDescription;
     if (!createTables(errorDescription)) {
         ErrorString error(
             QT_TR_NOOP("Can't init tables in the local storage database"));
@@ -618,6 +669,18 @@ void LocalStorageManagerPrivate::switchUser(
         throw DatabaseRequestException(error);
     }
 
+    if (!setDatabaseSchemaFingerprint(
+            QUENTIER_DATABASE_SCHEMA_FINGERPRINT, errorDescription))
+    {
+        ErrorString error(
+            QT_TR_NOOP("Can't save the schema fingerprint of the local storage "
+                       "database"));
+        error.appendBase(errorDescription.base());
+        error.appendBase(errorDescription.additionalBases());
+        error.details() = errorDescription.details();
+        throw DatabaseRequestException(error);
+    }
+
     clearCachedQueries();
 }
 
@@ -665,7 +728,7 @@ qint32 LocalStorageManagerPrivate::localStorageVersion(
         QStringLiteral("SELECT version FROM Auxiliary LIMIT 1");
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     if (Q_UNLIKELY(!res)) {
         errorDescription.setBase(
             QT_TR_NOOP("failed to execute SQL query checking whether "
@@ -700,7 +763,111 @@ qint32 LocalStorageManagerPrivate::localStorageVersion(
 
 qint32 LocalStorageManagerPrivate::highestSupportedLocalStorageVersion() const
 {
-    return 2;
+    return 5;
+}
+
+bool LocalStorageManagerPrivate::databaseFragmentationStatistics(
+    qint64 & pageSize, qint64 & pageCount, qint64 & freePageCount,
+    ErrorString & errorDescription) const
+{
+    ErrorString errorPrefix(
+        QT_TR_NOOP("Can't get the fragmentation statistics of the local "
+                   "storage database"));
+
+    const QString pragmas[] = {
+        QStringLiteral("PRAGMA page_size"), QStringLiteral("PRAGMA page_count"),
+        QStringLiteral("PRAGMA freelist_count")};
+
+    qint64 * values[] = {&pageSize, &pageCount, &freePageCount};
+
+    QSqlQuery query(m_sqlDatabase);
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        bool res = execQuery(query, pragmas[i]);
+        DATABASE_CHECK_AND_SET_ERROR()
+
+        if (!query.next()) {
+            errorDescription.base() = errorPrefix.base();
+            errorDescription.details() = pragmas[i];
+            QNWARNING("local_storage", errorDescription);
+            return false;
+        }
+
+        *values[i] = query.value(0).toLongLong();
+    }
+
+    return true;
+}
+
+qint64 LocalStorageManagerPrivate::writeAheadLogFileSize() const
+{
+    QFileInfo walFileInfo(m_databaseFilePath + QStringLiteral("-wal"));
+    if (!walFileInfo.exists()) {
+        return 0;
+    }
+
+    return walFileInfo.size();
+}
+
+int LocalStorageManagerPrivate::incrementalVacuum(
+    const int maxPages, ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "local_storage",
+        "LocalStorageManagerPrivate::incrementalVacuum: max pages = "
+            << maxPages);
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("Can't reclaim free pages of the local storage database"));
+
+    QSqlQuery query(m_sqlDatabase);
+    query.setForwardOnly(true);
+
+    bool res = execQuery(
+        query,
+        QString::fromUtf8("PRAGMA incremental_vacuum(%1)")
+            .arg(QString::number(std::max(maxPages, 1))));
+    if (!res) {
+        errorDescription.base() = errorPrefix.base();
+        errorDescription.details() = query.lastError().text();
+        QNWARNING("local_storage", errorDescription);
+        return -1;
+    }
+
+    // SQLite reclaims one page per step of the pragma statement so it needs
+    // to be stepped through until completion
+    int numReclaimedPages = 0;
+    while (query.next()) {
+        ++numReclaimedPages;
+    }
+
+    if (Q_UNLIKELY(query.lastError().isValid())) {
+        errorDescription.base() = errorPrefix.base();
+        errorDescription.details() = query.lastError().text();
+        QNWARNING("local_storage", errorDescription);
+        return -1;
+    }
+
+    QNDEBUG(
+        "local_storage", "Reclaimed " << numReclaimedPages << " free pages");
+    return numReclaimedPages;
+}
+
+bool LocalStorageManagerPrivate::checkpointWriteAheadLog(
+    ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "local_storage", "LocalStorageManagerPrivate::checkpointWriteAheadLog");
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("Can't checkpoint the write-ahead log of the local storage "
+                   "database"));
+
+    QSqlQuery query(m_sqlDatabase);
+    bool res = execQuery(
+        query, QStringLiteral("PRAGMA wal_checkpoint(TRUNCATE)"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    return true;
 }
 
 int LocalStorageManagerPrivate::userCount(ErrorString & errorDescription) const
@@ -716,7 +883,7 @@ int LocalStorageManagerPrivate::userCount(ErrorString & errorDescription) const
         return -1;
     }
 
-    res = query.exec();
+    res = execQuery(query);
     if (!res) {
         SET_ERROR();
         return -1;
@@ -1022,7 +1189,7 @@ bool LocalStorageManagerPrivate::findNotebook(
     Notebook result;
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     size_t counter = 0;
@@ -1058,7 +1225,7 @@ bool LocalStorageManagerPrivate::findDefaultNotebook(
         "Can't find default notebook in the local storage database"));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(QStringLiteral(
+    const QString queryString = QStringLiteral(
         "SELECT * FROM Notebooks "
         "LEFT OUTER JOIN NotebookRestrictions ON "
         "Notebooks.localUid = NotebookRestrictions.localUid "
@@ -1078,7 +1245,8 @@ bool LocalStorageManagerPrivate::findDefaultNotebook(
         "Notebooks.contactId = AccountLimits.id "
         "LEFT OUTER JOIN BusinessUserInfo ON "
         "Notebooks.contactId = BusinessUserInfo.id "
-        "WHERE isDefault = 1 LIMIT 1"));
+        "WHERE isDefault = 1 LIMIT 1");
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (!query.next()) {
@@ -1115,7 +1283,7 @@ bool LocalStorageManagerPrivate::findLastUsedNotebook(
                    "database"));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(QStringLiteral(
+    const QString queryString = QStringLiteral(
         "SELECT * FROM Notebooks "
         "LEFT OUTER JOIN NotebookRestrictions ON "
         "Notebooks.localUid = NotebookRestrictions.localUid "
@@ -1135,7 +1303,8 @@ bool LocalStorageManagerPrivate::findLastUsedNotebook(
         "Notebooks.contactId = AccountLimits.id "
         "LEFT OUTER JOIN BusinessUserInfo ON "
         "Notebooks.contactId = BusinessUserInfo.id "
-        "WHERE isLastUsed = 1 LIMIT 1"));
+        "WHERE isLastUsed = 1 LIMIT 1");
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (!query.next()) {
@@ -1225,7 +1394,8 @@ QList<SharedNotebook> LocalStorageManagerPrivate::listAllSharedNotebooks(
     ErrorString errorPrefix(QT_TR_NOOP("Can't list all shared notebooks"));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(QStringLiteral("SELECT * FROM SharedNotebooks"));
+    bool res =
+        execQuery(query, QStringLiteral("SELECT * FROM SharedNotebooks"));
     if (!res) {
         errorDescription.base() = errorPrefix.base();
         QNERROR(
@@ -1323,7 +1493,7 @@ LocalStorageManagerPrivate::listEnSharedNotebooksPerNotebookGuid(
 
     query.addBindValue(notebookGuid);
 
-    bool res = query.exec();
+    bool res = execQuery(query);
     if (!res) {
         SET_ERROR();
         return qecSharedNotebooks;
@@ -1449,7 +1619,7 @@ bool LocalStorageManagerPrivate::expungeNotebook(
             .arg(column, uid);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     error.clear();
@@ -1474,7 +1644,7 @@ int LocalStorageManagerPrivate::linkedNotebookCount(
         return -1;
     }
 
-    res = query.exec();
+    res = execQuery(query);
     if (!res) {
         SET_ERROR();
         return -1;
@@ -1633,7 +1803,7 @@ bool LocalStorageManagerPrivate::findLinkedNotebook(
 
     query.addBindValue(notebookGuid);
 
-    bool res = query.exec();
+    bool res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (!query.next()) {
@@ -1743,7 +1913,7 @@ bool LocalStorageManagerPrivate::expungeLinkedNotebook(
             .arg(linkedNotebookGuid);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     error.clear();
@@ -1769,7 +1939,7 @@ int LocalStorageManagerPrivate::noteCount(
     }
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     if (!res) {
         SET_ERROR();
         return -1;
@@ -1812,29 +1982,26 @@ int LocalStorageManagerPrivate::noteCountPerNotebook(
         return -1;
     }
 
-    QString column, value;
+    QString localUidCondition;
     if (notebook.hasGuid()) {
-        column = QStringLiteral("notebookGuid");
-        value = notebook.guid();
+        localUidCondition =
+            QString::fromUtf8(
+                "(SELECT localUid FROM Notebooks WHERE guid = '%1')")
+                .arg(sqlEscapeString(notebook.guid()));
     }
     else {
-        column = QStringLiteral("notebookLocalUid");
-        value = notebook.localUid();
+        localUidCondition = QStringLiteral("'") +
+            sqlEscapeString(notebook.localUid()) + QStringLiteral("'");
     }
 
-    value = sqlEscapeString(value);
-
     QString queryString =
-        QString::fromUtf8("SELECT COUNT(*) FROM Notes WHERE %1 = '%2'")
-            .arg(column, value);
-    QString condition = noteCountOptionsToSqlQueryPart(options);
-    if (!condition.isEmpty()) {
-        queryString += QStringLiteral(" AND ");
-        queryString += condition;
-    }
+        QString::fromUtf8(
+            "SELECT %1 FROM NotebookNoteCounts WHERE notebookLocalUid = %2")
+            .arg(noteCountOptionsToNoteCounterColumns(options),
+                 localUidCondition);
 
     QSqlQuery query(m_sqlDatabase);
-    res = query.exec(queryString);
+    res = execQuery(query, queryString);
 
     if (!res) {
         SET_ERROR();
@@ -1880,32 +2047,25 @@ int LocalStorageManagerPrivate::noteCountPerTag(
         return -1;
     }
 
-    QString column, value;
+    QString localUidCondition;
     if (tag.hasGuid()) {
-        column = QStringLiteral("tag");
-        value = tag.guid();
+        localUidCondition =
+            QString::fromUtf8("(SELECT localUid FROM Tags WHERE guid = '%1')")
+                .arg(sqlEscapeString(tag.guid()));
     }
     else {
-        column = QStringLiteral("localTag");
-        value = tag.localUid();
+        localUidCondition = QStringLiteral("'") +
+            sqlEscapeString(tag.localUid()) + QStringLiteral("'");
     }
 
-    value = sqlEscapeString(value);
-
     QString queryString =
         QString::fromUtf8(
-            "SELECT COUNT(*) FROM Notes WHERE (localUid IN (SELECT DISTINCT "
-            "localNote FROM NoteTags WHERE %1 = '%2'))")
-            .arg(column, value);
-
-    QString condition = noteCountOptionsToSqlQueryPart(options);
-    if (!condition.isEmpty()) {
-        queryString += QStringLiteral(" AND ");
-        queryString += condition;
-    }
+            "SELECT %1 FROM TagNoteCounts WHERE tagLocalUid = %2")
+            .arg(noteCountOptionsToNoteCounterColumns(options),
+                 localUidCondition);
 
     QSqlQuery query(m_sqlDatabase);
-    res = query.exec(queryString);
+    res = execQuery(query, queryString);
     if (!res) {
         SET_ERROR();
         return -1;
@@ -1939,21 +2099,16 @@ bool LocalStorageManagerPrivate::noteCountsPerAllTags(
 
     noteCountsPerTagLocalUid.clear();
 
-    QString queryString = QStringLiteral(
-        "SELECT localTag, COUNT(localTag) AS noteCount FROM "
-        "NoteTags LEFT OUTER JOIN Notes "
-        "ON NoteTags.localNote = Notes.localUid ");
+    QString columns = noteCountOptionsToNoteCounterColumns(options);
 
-    QString condition = noteCountOptionsToSqlQueryPart(options);
-    if (!condition.isEmpty()) {
-        queryString += QStringLiteral("WHERE ");
-        queryString += condition;
-        queryString += QStringLiteral(" ");
-    }
-    queryString += QStringLiteral("GROUP BY localTag");
+    QString queryString =
+        QString::fromUtf8(
+            "SELECT tagLocalUid AS localTag, %1 AS noteCount "
+            "FROM TagNoteCounts WHERE %1 > 0")
+            .arg(columns);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     if (!res) {
         SET_ERROR();
         return false;
@@ -2074,7 +2229,7 @@ int LocalStorageManagerPrivate::noteCountPerNotebooksAndTags(
     }
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     if (!res) {
         SET_ERROR();
         return -1;
@@ -2116,6 +2271,22 @@ QString LocalStorageManagerPrivate::noteCountOptionsToSqlQueryPart(
     return queryPart;
 }
 
+QString LocalStorageManagerPrivate::noteCountOptionsToNoteCounterColumns(
+    const NoteCountOptions options) const
+{
+    // Mirrors noteCountOptionsToSqlQueryPart: without either option only
+    // deleted notes are counted
+    if (!(options & NoteCountOption::IncludeNonDeletedNotes)) {
+        return QStringLiteral("deletedNoteCount");
+    }
+
+    if (!(options & NoteCountOption::IncludeDeletedNotes)) {
+        return QStringLiteral("activeNoteCount");
+    }
+
+    return QStringLiteral("(activeNoteCount + deletedNoteCount)");
+}
+
 bool LocalStorageManagerPrivate::addNote(
     Note & note, ErrorString & errorDescription)
 {
@@ -2500,7 +2671,7 @@ bool LocalStorageManagerPrivate::findNote(
 
     queryString += QString::fromUtf8("WHERE %1 = '%2'").arg(column, uid);
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     Note result;
@@ -3120,7 +3291,7 @@ bool LocalStorageManagerPrivate::expungeNote(
         QString::fromUtf8("DELETE FROM Notes WHERE %1 = '%2'").arg(column, uid);
 
     QSqlQuery query(m_sqlDatabase);
-    res = query.exec(queryString);
+    res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     error.clear();
@@ -3169,7 +3340,7 @@ QStringList LocalStorageManagerPrivate::findNoteLocalUidsWithSearchQuery(
     }
 
     QSqlQuery query(m_sqlDatabase);
-    res = query.exec(queryString);
+    res = execQuery(query, queryString);
     if (!res) {
         SET_ERROR();
         QNWARNING("local_storage", "Full executed SQL query: " << queryString);
@@ -3241,7 +3412,7 @@ NoteList LocalStorageManagerPrivate::findNotesWithSearchQuery(
             .arg(joinedLocalUids);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     if (Q_UNLIKELY(!res)) {
         SET_ERROR();
         return NoteList();
@@ -3341,7 +3512,7 @@ int LocalStorageManagerPrivate::tagCount(ErrorString & errorDescription) const
         return -1;
     }
 
-    res = query.exec();
+    res = execQuery(query);
     if (!res) {
         SET_ERROR();
         return -1;
@@ -3623,7 +3794,7 @@ bool LocalStorageManagerPrivate::findTag(
     }
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     bool foundTag = false;
@@ -3657,6 +3828,89 @@ bool LocalStorageManagerPrivate::findTag(
     return foundTag;
 }
 
+bool LocalStorageManagerPrivate::findOrAddTags(
+    const QList<Tag> & tags, QList<Tag> & addedTags,
+    QHash<QString, Tag> & localConflictsByGuid, ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "local_storage",
+        "LocalStorageManagerPrivate::findOrAddTags: " << tags.size()
+                                                      << " tags");
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("Can't find or add tags in the local storage database"));
+
+    addedTags.clear();
+    localConflictsByGuid.clear();
+
+    /**
+     * Will run all the queries from this method and its sub-methods within
+     * a single transaction so that either all tags without local counterparts
+     * are added or none of them
+     */
+    Transaction transaction(m_sqlDatabase, *this, Transaction::Type::Exclusive);
+
+    for (const auto & tag: qAsConst(tags)) {
+        if (Q_UNLIKELY(!tag.hasGuid())) {
+            errorDescription.base() = errorPrefix.base();
+            errorDescription.appendBase(QT_TR_NOOP("tag has no guid"));
+            QNWARNING("local_storage", errorDescription << ", tag: " << tag);
+            addedTags.clear();
+            localConflictsByGuid.clear();
+            return false;
+        }
+
+        Tag localConflict;
+        localConflict.unsetLocalUid();
+        localConflict.setGuid(tag.guid());
+
+        ErrorString error;
+        bool res = findTag(localConflict, error);
+        if (!res && tag.hasName() && error.isEmpty()) {
+            localConflict = Tag();
+            localConflict.unsetLocalUid();
+            localConflict.setName(tag.name());
+
+            if (tag.hasLinkedNotebookGuid()) {
+                localConflict.setLinkedNotebookGuid(tag.linkedNotebookGuid());
+            }
+
+            res = findTag(localConflict, error);
+        }
+
+        if (res) {
+            localConflictsByGuid[tag.guid()] = localConflict;
+            continue;
+        }
+
+        if (error.isEmpty()) {
+            Tag addedTag(tag);
+            res = addTag(addedTag, error);
+            if (res) {
+                addedTags << addedTag;
+                continue;
+            }
+        }
+
+        errorDescription.base() = errorPrefix.base();
+        errorDescription.appendBase(error.base());
+        errorDescription.appendBase(error.additionalBases());
+        errorDescription.details() = error.details();
+        QNWARNING("local_storage", errorDescription << ", tag: " << tag);
+        addedTags.clear();
+        localConflictsByGuid.clear();
+        return false;
+    }
+
+    if (!transaction.commit(errorDescription)) {
+        addedTags.clear();
+        localConflictsByGuid.clear();
+        return false;
+    }
+
+    return true;
+}
+
 QList<Tag> LocalStorageManagerPrivate::listAllTagsPerNote(
     const Note & note, ErrorString & errorDescription,
     const ListObjectsOptions & flag, const size_t limit, const size_t offset,
@@ -3703,7 +3957,7 @@ QList<Tag> LocalStorageManagerPrivate::listAllTagsPerNote(
             .arg(column, uid);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     if (!res) {
         SET_ERROR();
         return tags;
@@ -3898,7 +4152,7 @@ bool LocalStorageManagerPrivate::expungeTag(
         QString::fromUtf8("SELECT localUid FROM Tags WHERE %1='%2'")
             .arg(parentColumn, uid);
 
-    bool res = query.exec(findChildTagsQueryString);
+    bool res = execQuery(query, findChildTagsQueryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     while (query.next()) {
@@ -3935,13 +4189,13 @@ bool LocalStorageManagerPrivate::expungeTag(
     QString queryString = QString::fromUtf8("DELETE FROM Tags WHERE %1='%2'")
                               .arg(parentColumn, uid);
 
-    res = query.exec(queryString);
+    res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     queryString =
         QString::fromUtf8("DELETE FROM Tags WHERE %1='%2'").arg(column, uid);
 
-    res = query.exec(queryString);
+    res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -3959,7 +4213,7 @@ bool LocalStorageManagerPrivate::expungeNotelessTagsFromLinkedNotebooks(
         "AND (localUid NOT IN (SELECT localTag FROM NoteTags)))");
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -3979,7 +4233,7 @@ int LocalStorageManagerPrivate::enResourceCount(
         return -1;
     }
 
-    res = query.exec();
+    res = execQuery(query);
     if (!res) {
         SET_ERROR();
         return -1;
@@ -4064,7 +4318,7 @@ bool LocalStorageManagerPrivate::findEnResource(
             .arg(column, uid);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     Resource foundResource(resource);
@@ -4196,7 +4450,7 @@ bool LocalStorageManagerPrivate::expungeEnResource(
             .arg(column, uid);
 
     QSqlQuery query(m_sqlDatabase);
-    res = query.exec(queryString);
+    res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     error.clear();
@@ -4222,7 +4476,7 @@ int LocalStorageManagerPrivate::savedSearchCount(
         return -1;
     }
 
-    res = query.exec();
+    res = execQuery(query);
     if (!res) {
         SET_ERROR();
         return -1;
@@ -4475,7 +4729,7 @@ bool LocalStorageManagerPrivate::findSavedSearch(
             .arg(column, value);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (!query.next()) {
@@ -4608,7 +4862,7 @@ bool LocalStorageManagerPrivate::expungeSavedSearch(
             .arg(column, uid);
 
     QSqlQuery query(m_sqlDatabase);
-    res = query.exec(queryString);
+    res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -4751,7 +5005,7 @@ bool LocalStorageManagerPrivate::updateSequenceNumberFromTable(
     }
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (!query.next()) {
@@ -4777,6 +5031,92 @@ bool LocalStorageManagerPrivate::updateSequenceNumberFromTable(
     return true;
 }
 
+bool LocalStorageManagerPrivate::guidIndex(
+    LocalStorageManager::GuidIndex & index, ErrorString & errorDescription)
+{
+    QNDEBUG("local_storage", "LocalStorageManagerPrivate::guidIndex");
+
+    index = LocalStorageManager::GuidIndex();
+
+    if (!guidIndexEntriesFromTable(
+            QStringLiteral("Notebooks"), index.m_notebooks, errorDescription))
+    {
+        return false;
+    }
+
+    if (!guidIndexEntriesFromTable(
+            QStringLiteral("Tags"), index.m_tags, errorDescription))
+    {
+        return false;
+    }
+
+    if (!guidIndexEntriesFromTable(
+            QStringLiteral("SavedSearches"), index.m_savedSearches,
+            errorDescription))
+    {
+        return false;
+    }
+
+    if (!guidIndexEntriesFromTable(
+            QStringLiteral("Notes"), index.m_notes, errorDescription))
+    {
+        return false;
+    }
+
+    QNDEBUG(
+        "local_storage",
+        "Collected guid index: " << index.m_notebooks.size() << " notebooks, "
+                                 << index.m_tags.size() << " tags, "
+                                 << index.m_savedSearches.size()
+                                 << " saved searches, " << index.m_notes.size()
+                                 << " notes");
+    return true;
+}
+
+bool LocalStorageManagerPrivate::guidIndexEntriesFromTable(
+    const QString & tableName,
+    QHash<QString, LocalStorageManager::GuidIndexEntry> & entries,
+    ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "local_storage",
+        "LocalStorageManagerPrivate::guidIndexEntriesFromTable: "
+            << tableName);
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("failed to collect the guid index from one of local "
+                   "storage database tables"));
+
+    QString queryString = QStringLiteral(
+                              "SELECT guid, localUid, updateSequenceNumber, "
+                              "isDirty FROM ") +
+        tableName + QStringLiteral(" WHERE guid IS NOT NULL");
+
+    QSqlQuery query(m_sqlDatabase);
+    query.setForwardOnly(true);
+    bool res = execQuery(query, queryString);
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    while (query.next()) {
+        LocalStorageManager::GuidIndexEntry entry;
+        entry.m_localUid = query.value(1).toString();
+
+        QVariant usnValue = query.value(2);
+        if (!usnValue.isNull()) {
+            bool conversionResult = false;
+            qint32 usn = usnValue.toInt(&conversionResult);
+            if (conversionResult) {
+                entry.m_updateSequenceNumber = usn;
+            }
+        }
+
+        entry.m_isDirty = (query.value(3).toInt() != 0);
+        entries[query.value(0).toString()] = entry;
+    }
+
+    return true;
+}
+
 bool LocalStorageManagerPrivate::compactLocalStorage(
     ErrorString & errorDescription)
 {
@@ -4787,7 +5127,7 @@ bool LocalStorageManagerPrivate::compactLocalStorage(
     ErrorString errorPrefix(QT_TR_NOOP("Can't compact local storage database"));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(QStringLiteral("VACUUM"));
+    bool res = execQuery(query, QStringLiteral("VACUUM"));
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -4855,7 +5195,7 @@ bool LocalStorageManagerPrivate::addEnResource(
             .arg(noteLocalUid);
 
     QSqlQuery query(m_sqlDatabase);
-    res = query.exec(queryString);
+    res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (query.next()) {
@@ -5088,10 +5428,12 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
 {
     QSqlQuery query(m_sqlDatabase);
     bool res;
+    QString queryString;
 
     // Checking whether auxiliary table exists
-    res = query.exec(QStringLiteral(
-        "SELECT name FROM sqlite_master WHERE name='Auxiliary'"));
+    queryString = QStringLiteral(
+        "SELECT name FROM sqlite_master WHERE name='Auxiliary'");
+    res = execQuery(query, queryString);
 
     ErrorString errorPrefix(
         QT_TR_NOOP("Can't check whether Auxiliary table exists"));
@@ -5105,22 +5447,23 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
             << (auxiliaryTableExists ? "already exists" : "doesn't exist yet"));
 
     if (!auxiliaryTableExists) {
-        res = query.exec(
+        res = execQuery(
+            query,
             QStringLiteral("CREATE TABLE Auxiliary("
                            "  lock    CHAR(1) PRIMARY KEY  NOT NULL DEFAULT "
                            "'X' CHECK (lock='X'), "
-                           "  version INTEGER              NOT NULL DEFAULT 2"
+                           "  version INTEGER              NOT NULL DEFAULT 5"
                            ")"));
         errorPrefix.setBase(QT_TR_NOOP("Can't create Auxiliary table"));
         DATABASE_CHECK_AND_SET_ERROR()
 
-        res = query.exec(
-            QStringLiteral("INSERT INTO Auxiliary (version) VALUES(2)"));
+        res = execQuery(
+            query, QStringLiteral("INSERT INTO Auxiliary (version) VALUES(5)"));
         errorPrefix.setBase(QT_TR_NOOP("Can't set version to Auxiliary table"));
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS Users("
         "  id                           INTEGER PRIMARY KEY NOT NULL UNIQUE, "
         "  username                     TEXT                DEFAULT NULL, "
@@ -5138,11 +5481,12 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  userShardId                  TEXT                DEFAULT NULL, "
         "  userPhotoUrl                 TEXT                DEFAULT NULL, "
         "  userPhotoLastUpdateTimestamp INTEGER             DEFAULT NULL"
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create Users table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS UserAttributes("
         "  id REFERENCES Users(id) ON UPDATE CASCADE, "
         "  defaultLocationName        TEXT                  DEFAULT NULL, "
@@ -5176,27 +5520,30 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  emailAddressLastConfirmed  INTEGER               DEFAULT NULL, "
         "  passwordUpdated            INTEGER               DEFAULT NULL, "
         "  salesforcePushEnabled      INTEGER               DEFAULT NULL, "
-        "  shouldLogClientEvent       INTEGER               DEFAULT NULL)"));
+        "  shouldLogClientEvent       INTEGER               DEFAULT NULL)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create UserAttributes table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS UserAttributesViewedPromotions("
         "  id REFERENCES Users(id) ON UPDATE CASCADE, "
-        "  promotion               TEXT                    DEFAULT NULL)"));
+        "  promotion               TEXT                    DEFAULT NULL)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create UserAttributesViewedPromotions table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS UserAttributesRecentMailedAddresses("
         "  id REFERENCES Users(id) ON UPDATE CASCADE, "
-        "  address                 TEXT                    DEFAULT NULL)"));
+        "  address                 TEXT                    DEFAULT NULL)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create UserAttributesRecentMailedAddresses table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS Accounting("
         "  id REFERENCES Users(id) ON UPDATE CASCADE, "
         "  uploadLimitEnd              INTEGER             DEFAULT NULL, "
@@ -5218,11 +5565,12 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  unitPrice                   INTEGER             DEFAULT NULL, "
         "  unitDiscount                INTEGER             DEFAULT NULL, "
         "  nextChargeDate              INTEGER             DEFAULT NULL, "
-        "  availablePoints             INTEGER             DEFAULT NULL)"));
+        "  availablePoints             INTEGER             DEFAULT NULL)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create Accounting table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS AccountLimits("
         "  id REFERENCES Users(id) ON UPDATE CASCADE, "
         "  userMailLimitDaily          INTEGER             DEFAULT NULL, "
@@ -5235,21 +5583,23 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  userTagCountMax             INTEGER             DEFAULT NULL, "
         "  noteTagCountMax             INTEGER             DEFAULT NULL, "
         "  userSavedSearchesMax        INTEGER             DEFAULT NULL, "
-        "  noteResourceCountMax        INTEGER             DEFAULT NULL)"));
+        "  noteResourceCountMax        INTEGER             DEFAULT NULL)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create AccountLimits table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS BusinessUserInfo("
         "  id REFERENCES Users(id) ON UPDATE CASCADE, "
         "  businessId              INTEGER                 DEFAULT NULL, "
         "  businessName            TEXT                    DEFAULT NULL, "
         "  role                    INTEGER                 DEFAULT NULL, "
-        "  businessInfoEmail       TEXT                    DEFAULT NULL)"));
+        "  businessInfoEmail       TEXT                    DEFAULT NULL)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create BusinessUserInfo table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TRIGGER IF NOT EXISTS on_user_delete_trigger "
         "BEFORE DELETE ON Users "
         "BEGIN "
@@ -5259,12 +5609,13 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "DELETE FROM Accounting WHERE id=OLD.id; "
         "DELETE FROM AccountLimits WHERE id=OLD.id; "
         "DELETE FROM BusinessUserInfo WHERE id=OLD.id; "
-        "END"));
+        "END");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP(
         "Can't create trigger to fire on deletion from users table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS LinkedNotebooks("
         "  guid                            TEXT PRIMARY KEY  NOT NULL UNIQUE, "
         "  updateSequenceNumber            INTEGER           DEFAULT NULL, "
@@ -5278,11 +5629,12 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  webApiUrlPrefix                 TEXT              DEFAULT NULL, "
         "  stack                           TEXT              DEFAULT NULL, "
         "  businessId                      INTEGER           DEFAULT NULL"
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create LinkedNotebooks table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS Notebooks("
         "  localUid                        TEXT PRIMARY KEY  NOT NULL UNIQUE, "
         "  guid                            TEXT              DEFAULT NULL "
@@ -5317,19 +5669,21 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  recipientStack                  TEXT              DEFAULT NULL, "
         "  UNIQUE(localUid, guid), "
         "  UNIQUE(notebookNameUpper, linkedNotebookGuid) "
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create Notebooks table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
-        QStringLiteral("CREATE VIRTUAL TABLE IF NOT EXISTS NotebookFTS "
-                       "USING FTS4(content=\"Notebooks\", "
-                       "localUid, guid, notebookName)"));
+    res = execQuery(
+        query, QStringLiteral("CREATE VIRTUAL TABLE IF NOT EXISTS NotebookFTS "
+                              "USING FTS4(content=\"Notebooks\", "
+                              "localUid, guid, notebookName)"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create virtual FTS4 NotebookFTS table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
                        "NotebookFTS_BeforeDeleteTrigger "
                        "BEFORE DELETE ON Notebooks "
@@ -5340,18 +5694,19 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         QT_TR_NOOP("Can't create NotebookFTS_BeforeDeleteTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TRIGGER IF NOT EXISTS "
         "NotebookFTS_AfterInsertTrigger "
         "AFTER INSERT ON Notebooks "
         "BEGIN "
         "INSERT INTO NotebookFTS(NotebookFTS) VALUES('rebuild'); "
-        "END"));
+        "END");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create NotebookFTS_AfterInsertTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS NotebookRestrictions("
         "  localUid REFERENCES Notebooks(localUid) ON UPDATE CASCADE, "
         "  noReadNotes                 INTEGER      DEFAULT NULL, "
@@ -5376,11 +5731,12 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  noRenameNotebook            INTEGER      DEFAULT NULL, "
         "  updateWhichSharedNotebookRestrictions    INTEGER     DEFAULT NULL, "
         "  expungeWhichSharedNotebookRestrictions   INTEGER     DEFAULT NULL "
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create NotebookRestrictions table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS SharedNotebooks("
         "  sharedNotebookShareId                      INTEGER PRIMARY KEY   "
         "NOT NULL UNIQUE, "
@@ -5403,11 +5759,12 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  sharedNotebookAssignmentTimestamp          INTEGER    DEFAULT NULL, "
         "  indexInNotebook                            INTEGER    DEFAULT NULL, "
         "  UNIQUE(sharedNotebookShareId, sharedNotebookNotebookGuid) ON "
-        "CONFLICT REPLACE)"));
+        "CONFLICT REPLACE)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create SharedNotebooks table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS Notes("
         "  localUid                        TEXT PRIMARY KEY     NOT NULL "
         "UNIQUE, "
@@ -5461,11 +5818,12 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  classificationKeys              TEXT                 DEFAULT NULL, "
         "  classificationValues            TEXT                 DEFAULT NULL, "
         "  UNIQUE(localUid, guid)"
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create Notes table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS SharedNotes("
         "  sharedNoteNoteGuid REFERENCES Notes(guid) ON UPDATE CASCADE, "
         "  sharedNoteSharerUserId                           INTEGER DEFAULT "
@@ -5509,11 +5867,12 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  indexInNote                                      INTEGER DEFAULT "
         "NULL, "
         "  UNIQUE(sharedNoteNoteGuid, sharedNoteRecipientIdentityId) ON "
-        "CONFLICT REPLACE)"));
+        "CONFLICT REPLACE)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create SharedNotes table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS NoteRestrictions("
         "  noteLocalUid REFERENCES Notes(localUid) ON UPDATE CASCADE, "
         "  noUpdateNoteTitle                INTEGER             DEFAULT NULL, "
@@ -5521,19 +5880,21 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  noEmailNote                      INTEGER             DEFAULT NULL, "
         "  noShareNote                      INTEGER             DEFAULT NULL, "
         "  noShareNotePublicly              INTEGER             DEFAULT "
-        "NULL)"));
+        "NULL)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create NoteRestrictions table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res =
-        query.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS "
-                                  "NoteRestrictionsByNoteLocalUid ON "
-                                  "NoteRestrictions(noteLocalUid)"));
+    res = execQuery(
+        query,
+        QStringLiteral("CREATE INDEX IF NOT EXISTS "
+                       "NoteRestrictionsByNoteLocalUid ON "
+                       "NoteRestrictions(noteLocalUid)"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create index NoteRestrictionsByNoteLocalUid"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS NoteLimits("
         "  noteLocalUid REFERENCES Notes(localUid) ON UPDATE CASCADE, "
         "  noteResourceCountMax             INTEGER             DEFAULT NULL, "
@@ -5541,17 +5902,13 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  resourceSizeMax                  INTEGER             DEFAULT NULL, "
         "  noteSizeMax                      INTEGER             DEFAULT NULL, "
         "  uploaded                         INTEGER             DEFAULT "
-        "NULL)"));
+        "NULL)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create NoteLimits table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res =
-        query.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS NotesNotebooks "
-                                  "ON Notes(notebookLocalUid)"));
-    errorPrefix.setBase(QT_TR_NOOP("Can't create index NotesNotebooks"));
-    DATABASE_CHECK_AND_SET_ERROR()
-
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE VIRTUAL TABLE IF NOT EXISTS NoteFTS "
                        "USING FTS4(content=\"Notes\", localUid, "
                        "titleNormalized, contentListOfWords, "
@@ -5568,7 +5925,8 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
     errorPrefix.setBase(QT_TR_NOOP("Can't create virtual FTS4 table NoteFTS"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
                        "NoteFTS_BeforeDeleteTrigger "
                        "BEFORE DELETE ON Notes "
@@ -5579,18 +5937,19 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         QT_TR_NOOP("Can't create trigger NoteFTS_BeforeDeleteTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
-        QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
-                       "NoteFTS_AfterInsertTrigger "
-                       "AFTER INSERT ON Notes "
-                       "BEGIN "
-                       "INSERT INTO NoteFTS(NoteFTS) VALUES('rebuild'); "
-                       "END"));
+    res = execQuery(
+        query, QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
+                              "NoteFTS_AfterInsertTrigger "
+                              "AFTER INSERT ON Notes "
+                              "BEGIN "
+                              "INSERT INTO NoteFTS(NoteFTS) VALUES('rebuild'); "
+                              "END"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create trigger NoteFTS_AfterInsertTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
                        "on_notebook_delete_trigger "
                        "BEFORE DELETE ON Notebooks "
@@ -5606,7 +5965,7 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         QT_TR_NOOP("Can't create trigger to fire on notebook deletion"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS Resources("
         "  resourceLocalUid                TEXT PRIMARY KEY     NOT NULL "
         "UNIQUE, "
@@ -5628,16 +5987,19 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  alternateDataHash               TEXT                 DEFAULT NULL, "
         "  resourceIndexInNote             INTEGER              DEFAULT NULL, "
         "  UNIQUE(resourceLocalUid, resourceGuid)"
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create Resources table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
-        "CREATE INDEX IF NOT EXISTS ResourceMimeIndex ON Resources(mime)"));
+    queryString = QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS ResourceMimeIndex ON Resources(mime)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create ResourceMimeIndex index"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE TABLE IF NOT EXISTS ResourceRecognitionData("
                        "  resourceLocalUid REFERENCES "
                        "Resources(resourceLocalUid) ON UPDATE CASCADE, "
@@ -5649,15 +6011,16 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         QT_TR_NOOP("Can't create ResourceRecognitionData table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
-        QStringLiteral("CREATE INDEX IF NOT EXISTS "
-                       "ResourceRecognitionDataIndex "
-                       "ON ResourceRecognitionData(recognitionData)"));
+    res = execQuery(
+        query, QStringLiteral("CREATE INDEX IF NOT EXISTS "
+                              "ResourceRecognitionDataIndex "
+                              "ON ResourceRecognitionData(recognitionData)"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create ResourceRecognitionDataIndex index"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE VIRTUAL TABLE IF NOT EXISTS "
                        "ResourceRecognitionDataFTS USING FTS4"
                        "(content=\"ResourceRecognitionData\", "
@@ -5666,33 +6029,34 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "Can't create virtual FTS4 ResourceRecognitionDataFTS table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
-        QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
-                       "ResourceRecognitionDataFTS_BeforeDeleteTrigger "
-                       "BEFORE DELETE ON ResourceRecognitionData "
-                       "BEGIN "
-                       "DELETE FROM ResourceRecognitionDataFTS "
-                       "WHERE recognitionData=old.recognitionData; "
-                       "END"));
+    res = execQuery(
+        query, QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
+                              "ResourceRecognitionDataFTS_BeforeDeleteTrigger "
+                              "BEFORE DELETE ON ResourceRecognitionData "
+                              "BEGIN "
+                              "DELETE FROM ResourceRecognitionDataFTS "
+                              "WHERE recognitionData=old.recognitionData; "
+                              "END"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create trigger "
                    "ResourceRecognitionDataFTS_BeforeDeleteTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
-        QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
-                       "ResourceRecognitionDataFTS_AfterInsertTrigger "
-                       "AFTER INSERT ON ResourceRecognitionData "
-                       "BEGIN "
-                       "INSERT INTO ResourceRecognitionDataFTS("
-                       "ResourceRecognitionDataFTS) VALUES('rebuild'); "
-                       "END"));
+    res = execQuery(
+        query, QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
+                              "ResourceRecognitionDataFTS_AfterInsertTrigger "
+                              "AFTER INSERT ON ResourceRecognitionData "
+                              "BEGIN "
+                              "INSERT INTO ResourceRecognitionDataFTS("
+                              "ResourceRecognitionDataFTS) VALUES('rebuild'); "
+                              "END"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create trigger "
                    "ResourceRecognitionDataFTS_AfterInsertTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE VIRTUAL TABLE IF NOT EXISTS "
                        "ResourceMimeFTS USING FTS4(content=\"Resources\", "
                        "resourceLocalUid, mime)"));
@@ -5700,7 +6064,8 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         QT_TR_NOOP("Can't create virtual FTS4 ResourceMimeFTS table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
                        "ResourceMimeFTS_BeforeDeleteTrigger "
                        "BEFORE DELETE ON Resources "
@@ -5712,24 +6077,25 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
                    "ResourceMimeFTS_BeforeDeleteTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
-        QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
-                       "ResourceMimeFTS_AfterInsertTrigger "
-                       "AFTER INSERT ON Resources "
-                       "BEGIN "
-                       "INSERT INTO ResourceMimeFTS(ResourceMimeFTS) "
-                       "VALUES('rebuild'); "
-                       "END"));
+    res = execQuery(
+        query, QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
+                              "ResourceMimeFTS_AfterInsertTrigger "
+                              "AFTER INSERT ON Resources "
+                              "BEGIN "
+                              "INSERT INTO ResourceMimeFTS(ResourceMimeFTS) "
+                              "VALUES('rebuild'); "
+                              "END"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create trigger ResourceMimeFTS_AfterInsertTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
-        "CREATE INDEX IF NOT EXISTS ResourceNote ON Resources(noteLocalUid)"));
+    queryString = QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS ResourceNote ON Resources(noteLocalUid)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create ResourceNote index"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS ResourceAttributes("
         "  resourceLocalUid REFERENCES Resources(resourceLocalUid) ON UPDATE "
         "CASCADE, "
@@ -5744,34 +6110,37 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  fileName                TEXT                DEFAULT NULL, "
         "  attachment              INTEGER             DEFAULT NULL, "
         "  UNIQUE(resourceLocalUid) "
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create ResourceAttributes table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS ResourceAttributesApplicationDataKeysOnly("
         "  resourceLocalUid REFERENCES Resources(resourceLocalUid) ON UPDATE "
         "CASCADE, "
         "  resourceKey             TEXT                DEFAULT NULL, "
         "  UNIQUE(resourceLocalUid, resourceKey)"
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP(
         "Can't create ResourceAttributesApplicationDataKeysOnly table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS ResourceAttributesApplicationDataFullMap("
         "  resourceLocalUid REFERENCES Resources(resourceLocalUid) ON UPDATE "
         "CASCADE, "
         "  resourceMapKey          TEXT                DEFAULT NULL, "
         "  resourceValue           TEXT                DEFAULT NULL, "
         "  UNIQUE(resourceLocalUid, resourceMapKey) ON CONFLICT REPLACE"
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP(
         "Can't create ResourceAttributesApplicationDataFullMap table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS Tags("
         "  localUid              TEXT PRIMARY KEY     NOT NULL UNIQUE, "
         "  guid                  TEXT                 DEFAULT NULL UNIQUE, "
@@ -5789,49 +6158,53 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  isFavorited           INTEGER              NOT NULL, "
         "  UNIQUE(localUid, guid), "
         "  UNIQUE(nameLower, linkedNotebookGuid) "
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create Tags table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
-        "CREATE INDEX IF NOT EXISTS TagNameUpperIndex ON Tags(nameLower)"));
+    queryString = QStringLiteral(
+        "CREATE INDEX IF NOT EXISTS TagNameUpperIndex ON Tags(nameLower)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create TagNameUpperIndex index"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE VIRTUAL TABLE IF NOT EXISTS TagFTS "
-        "USING FTS4(content=\"Tags\", localUid, guid, nameLower)"));
+        "USING FTS4(content=\"Tags\", localUid, guid, nameLower)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create virtual FTS4 table TagFTS"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
-        QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
-                       "TagFTS_BeforeDeleteTrigger "
-                       "BEFORE DELETE ON Tags "
-                       "BEGIN "
-                       "DELETE FROM TagFTS WHERE localUid=old.localUid; "
-                       "END"));
+    res = execQuery(
+        query, QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
+                              "TagFTS_BeforeDeleteTrigger "
+                              "BEFORE DELETE ON Tags "
+                              "BEGIN "
+                              "DELETE FROM TagFTS WHERE localUid=old.localUid; "
+                              "END"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create trigger TagFTS_BeforeDeleteTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
-        QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
-                       "TagFTS_AfterInsertTrigger AFTER INSERT ON Tags "
-                       "BEGIN "
-                       "INSERT INTO TagFTS(TagFTS) VALUES('rebuild'); "
-                       "END"));
+    res = execQuery(
+        query, QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
+                              "TagFTS_AfterInsertTrigger AFTER INSERT ON Tags "
+                              "BEGIN "
+                              "INSERT INTO TagFTS(TagFTS) VALUES('rebuild'); "
+                              "END"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create trigger TagFTS_AfterInsertTrigger"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res =
-        query.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS TagsSearchName "
-                                  "ON Tags(nameLower)"));
+    res = execQuery(
+        query,
+        QStringLiteral("CREATE INDEX IF NOT EXISTS TagsSearchName "
+                       "ON Tags(nameLower)"));
     errorPrefix.setBase(QT_TR_NOOP("Can't create TagsSearchName index"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS NoteTags("
         "  localNote REFERENCES Notes(localUid) ON UPDATE CASCADE, "
         "  note REFERENCES Notes(guid)          ON UPDATE CASCADE, "
@@ -5839,17 +6212,19 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  tag  REFERENCES Tags(guid)           ON UPDATE CASCADE, "
         "  tagIndexInNote        INTEGER        DEFAULT NULL, "
         "  UNIQUE(localNote, localTag) ON CONFLICT REPLACE"
-        ")"));
+        ")");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create NoteTags table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res =
-        query.exec(QStringLiteral("CREATE INDEX IF NOT EXISTS NoteTagsNote "
-                                  "ON NoteTags(localNote)"));
+    res = execQuery(
+        query,
+        QStringLiteral("CREATE INDEX IF NOT EXISTS NoteTagsNote "
+                       "ON NoteTags(localNote)"));
     errorPrefix.setBase(QT_TR_NOOP("Can't create NoteTagsNote index"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS NoteResources("
         "  localNote     REFERENCES Notes(localUid)             ON UPDATE "
         "CASCADE, "
@@ -5859,13 +6234,14 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "CASCADE, "
         "  resource      REFERENCES Resources(resourceGuid)     ON UPDATE "
         "CASCADE, "
-        "  UNIQUE(localNote, localResource) ON CONFLICT REPLACE)"));
+        "  UNIQUE(localNote, localResource) ON CONFLICT REPLACE)");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create NoteResources table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
-        QStringLiteral("CREATE INDEX IF NOT EXISTS NoteResourcesNote ON "
-                       "NoteResources(localNote)"));
+    res = execQuery(
+        query, QStringLiteral("CREATE INDEX IF NOT EXISTS NoteResourcesNote ON "
+                              "NoteResources(localNote)"));
     errorPrefix.setBase(QT_TR_NOOP("Can't create NoteResourcesNote index"));
     DATABASE_CHECK_AND_SET_ERROR()
 
@@ -5873,21 +6249,23 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
     // citing Evernote API reference: "The account may only contain one search
     // with a given name (case-insensitive compare)"
 
-    res =
-        query.exec(QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
-                                  "on_linked_notebook_delete_trigger "
-                                  "BEFORE DELETE ON LinkedNotebooks "
-                                  "BEGIN "
-                                  "DELETE FROM Notebooks WHERE "
-                                  "Notebooks.linkedNotebookGuid=OLD.guid; "
-                                  "DELETE FROM Tags WHERE "
-                                  "Tags.linkedNotebookGuid=OLD.guid; "
-                                  "END"));
+    res = execQuery(
+        query,
+        QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
+                       "on_linked_notebook_delete_trigger "
+                       "BEFORE DELETE ON LinkedNotebooks "
+                       "BEGIN "
+                       "DELETE FROM Notebooks WHERE "
+                       "Notebooks.linkedNotebookGuid=OLD.guid; "
+                       "DELETE FROM Tags WHERE "
+                       "Tags.linkedNotebookGuid=OLD.guid; "
+                       "END"));
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create trigger to fire on linked notebook deletion"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE TRIGGER IF NOT EXISTS "
                        "on_note_delete_trigger "
                        "BEFORE DELETE ON Notes "
@@ -5911,7 +6289,7 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         QT_TR_NOOP("Can't create trigger to fire on note deletion"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TRIGGER IF NOT EXISTS "
         "on_resource_delete_trigger "
         "BEFORE DELETE ON Resources "
@@ -5929,12 +6307,14 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "OLD.resourceLocalUid; "
         "DELETE FROM NoteResources WHERE "
         "NoteResources.localResource=OLD.resourceLocalUid; "
-        "END"));
+        "END");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(
         QT_TR_NOOP("Can't create trigger to fire on resource deletion"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(
+    res = execQuery(
+        query,
         QStringLiteral("CREATE TRIGGER IF NOT EXISTS on_tag_delete_trigger "
                        "BEFORE DELETE ON Tags "
                        "BEGIN "
@@ -5945,7 +6325,7 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         QT_TR_NOOP("Can't create trigger to fire on tag deletion"));
     DATABASE_CHECK_AND_SET_ERROR()
 
-    res = query.exec(QStringLiteral(
+    queryString = QStringLiteral(
         "CREATE TABLE IF NOT EXISTS SavedSearches("
         "  localUid                        TEXT PRIMARY KEY    NOT NULL "
         "UNIQUE, "
@@ -5963,10 +6343,455 @@ bool LocalStorageManagerPrivate::createTables(ErrorString & errorDescription)
         "  includePersonalLinkedNotebooks  INTEGER             DEFAULT NULL, "
         "  includeBusinessLinkedNotebooks  INTEGER             DEFAULT NULL, "
         "  isFavorited                     INTEGER             NOT NULL, "
-        "  UNIQUE(localUid, guid))"));
+        "  UNIQUE(localUid, guid))");
+    res = execQuery(query, queryString);
     errorPrefix.setBase(QT_TR_NOOP("Can't create SavedSearches table"));
     DATABASE_CHECK_AND_SET_ERROR()
 
+    // Existing databases of earlier versions get the indexes and the note
+    // counters from local storage patches from version 3 to version 4 and
+    // from version 4 to version 5 which do the work in batches with progress
+    // reported instead of blocking the switch of the user
+    qint32 version = localStorageVersion(errorDescription);
+    if (version < 0) {
+        return false;
+    }
+
+    if ((version >= 4) && !createListingIndexes(errorDescription)) {
+        return false;
+    }
+
+    if ((version >= 5) && !createNoteCounters(errorDescription)) {
+        return false;
+    }
+
+    return true;
+}
+
+QStringList LocalStorageManagerPrivate::listingIndexStatements() const
+{
+    return QStringList{
+        // Listing notes ordered by title or timestamps
+        QStringLiteral("CREATE INDEX IF NOT EXISTS NotesByTitle "
+                       "ON Notes(title)"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS NotesByCreationTimestamp "
+                       "ON Notes(creationTimestamp)"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS "
+                       "NotesByModificationTimestamp "
+                       "ON Notes(modificationTimestamp)"),
+        // Counting notes per notebook, with or without deleted notes, from
+        // the index alone; it supersedes the index on notebookLocalUid only
+        QStringLiteral("CREATE INDEX IF NOT EXISTS "
+                       "NotesByNotebookLocalUidAndDeletionTimestamp "
+                       "ON Notes(notebookLocalUid, deletionTimestamp)"),
+        QStringLiteral("DROP INDEX IF EXISTS NotesNotebooks"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS "
+                       "NotesByNotebookGuidAndDeletionTimestamp "
+                       "ON Notes(notebookGuid, deletionTimestamp)"),
+        // Counting notes per tag
+        QStringLiteral("CREATE INDEX IF NOT EXISTS NoteTagsByLocalTag "
+                       "ON NoteTags(localTag, localNote)"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS NoteTagsByTag "
+                       "ON NoteTags(tag, localNote)"),
+        // Partial indexes for dirty objects: they only contain the objects
+        // which are yet to be sent to the service so they stay small
+        QStringLiteral("CREATE INDEX IF NOT EXISTS DirtyNotes "
+                       "ON Notes(localUid) WHERE isDirty=1"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS DirtyNotebooks "
+                       "ON Notebooks(localUid) WHERE isDirty=1"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS DirtyTags "
+                       "ON Tags(localUid) WHERE isDirty=1"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS DirtySavedSearches "
+                       "ON SavedSearches(localUid) WHERE isDirty=1"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS DirtyLinkedNotebooks "
+                       "ON LinkedNotebooks(guid) WHERE isDirty=1"),
+        // Tables joined when listing notes and notebooks which otherwise
+        // SQLite builds automatic indexes for on each query
+        QStringLiteral("CREATE INDEX IF NOT EXISTS NoteLimitsByNoteLocalUid "
+                       "ON NoteLimits(noteLocalUid)"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS "
+                       "NotebookRestrictionsByLocalUid "
+                       "ON NotebookRestrictions(localUid)"),
+        QStringLiteral("CREATE INDEX IF NOT EXISTS "
+                       "SharedNotebooksByNotebookGuid "
+                       "ON SharedNotebooks(sharedNotebookNotebookGuid)")};
+}
+
+bool LocalStorageManagerPrivate::createListingIndexes(
+    ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "local_storage", "LocalStorageManagerPrivate::createListingIndexes");
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("Can't create indexes in the local storage database"));
+
+    const QStringList statements = listingIndexStatements();
+
+    QSqlQuery query(m_sqlDatabase);
+    for (const auto & statement: statements) {
+        bool res = execQuery(query, statement);
+        if (!res) {
+            errorDescription.base() = errorPrefix.base();
+            errorDescription.details() = query.lastError().text();
+            QNWARNING(
+                "local_storage",
+                errorDescription << ", statement: " << statement);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LocalStorageManagerPrivate::createNoteCounterTables(
+    ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "local_storage",
+        "LocalStorageManagerPrivate::createNoteCounterTables");
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("Can't create note counter tables in the local storage "
+                   "database"));
+
+    const QString statements[] = {
+        QStringLiteral("CREATE TABLE IF NOT EXISTS NotebookNoteCounts("
+                       "  notebookLocalUid TEXT PRIMARY KEY NOT NULL, "
+                       "  activeNoteCount  INTEGER NOT NULL DEFAULT 0, "
+                       "  deletedNoteCount INTEGER NOT NULL DEFAULT 0)"),
+        QStringLiteral("CREATE TABLE IF NOT EXISTS TagNoteCounts("
+                       "  tagLocalUid      TEXT PRIMARY KEY NOT NULL, "
+                       "  activeNoteCount  INTEGER NOT NULL DEFAULT 0, "
+                       "  deletedNoteCount INTEGER NOT NULL DEFAULT 0)")};
+
+    QSqlQuery query(m_sqlDatabase);
+    for (const auto & statement: statements) {
+        bool res = execQuery(query, statement);
+        if (!res) {
+            errorDescription.base() = errorPrefix.base();
+            errorDescription.details() = query.lastError().text();
+            QNWARNING(
+                "local_storage",
+                errorDescription << ", statement: " << statement);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool LocalStorageManagerPrivate::createNoteCounters(
+    ErrorString & errorDescription)
+{
+    QNDEBUG("local_storage", "LocalStorageManagerPrivate::createNoteCounters");
+
+    if (!createNoteCounterTables(errorDescription)) {
+        return false;
+    }
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("Can't create note counters in the local storage "
+                   "database"));
+
+    // NOTE: notes and note tags are written via INSERT OR REPLACE and
+    // recursive triggers are off so delete triggers don't fire for replaced
+    // rows; for that reason BEFORE INSERT triggers subtract the contribution
+    // of the rows which are about to be replaced. Also, the conflict clause
+    // of the outer statement overrides the one of statements within
+    // triggers so missing counter rows are inserted via NOT EXISTS checks
+    // rather than via INSERT OR IGNORE
+    const QString statements[] = {
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNoteReplace "
+            "BEFORE INSERT ON Notes "
+            "BEGIN "
+            "UPDATE NotebookNoteCounts SET "
+            "activeNoteCount = activeNoteCount - "
+            "(SELECT COUNT(*) FROM Notes WHERE "
+            "Notes.notebookLocalUid = NotebookNoteCounts.notebookLocalUid "
+            "AND Notes.deletionTimestamp IS NULL "
+            "AND (Notes.localUid = NEW.localUid OR "
+            "(NEW.guid IS NOT NULL AND Notes.guid = NEW.guid))), "
+            "deletedNoteCount = deletedNoteCount - "
+            "(SELECT COUNT(*) FROM Notes WHERE "
+            "Notes.notebookLocalUid = NotebookNoteCounts.notebookLocalUid "
+            "AND Notes.deletionTimestamp IS NOT NULL "
+            "AND (Notes.localUid = NEW.localUid OR "
+            "(NEW.guid IS NOT NULL AND Notes.guid = NEW.guid))) "
+            "WHERE notebookLocalUid IN "
+            "(SELECT notebookLocalUid FROM Notes WHERE "
+            "localUid = NEW.localUid OR "
+            "(NEW.guid IS NOT NULL AND guid = NEW.guid)); "
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount - "
+            "(SELECT COUNT(*) FROM NoteTags INNER JOIN Notes "
+            "ON NoteTags.localNote = Notes.localUid WHERE "
+            "NoteTags.localTag = TagNoteCounts.tagLocalUid "
+            "AND Notes.deletionTimestamp IS NULL "
+            "AND (Notes.localUid = NEW.localUid OR "
+            "(NEW.guid IS NOT NULL AND Notes.guid = NEW.guid))), "
+            "deletedNoteCount = deletedNoteCount - "
+            "(SELECT COUNT(*) FROM NoteTags INNER JOIN Notes "
+            "ON NoteTags.localNote = Notes.localUid WHERE "
+            "NoteTags.localTag = TagNoteCounts.tagLocalUid "
+            "AND Notes.deletionTimestamp IS NOT NULL "
+            "AND (Notes.localUid = NEW.localUid OR "
+            "(NEW.guid IS NOT NULL AND Notes.guid = NEW.guid))) "
+            "WHERE tagLocalUid IN "
+            "(SELECT localTag FROM NoteTags WHERE localNote IN "
+            "(SELECT localUid FROM Notes WHERE localUid = NEW.localUid OR "
+            "(NEW.guid IS NOT NULL AND guid = NEW.guid))); "
+            "END"),
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNoteInsert "
+            "AFTER INSERT ON Notes "
+            "BEGIN "
+            "INSERT INTO NotebookNoteCounts(notebookLocalUid) "
+            "SELECT NEW.notebookLocalUid WHERE "
+            "NEW.notebookLocalUid IS NOT NULL AND NOT EXISTS "
+            "(SELECT 1 FROM NotebookNoteCounts WHERE "
+            "notebookLocalUid = NEW.notebookLocalUid); "
+            "UPDATE NotebookNoteCounts SET "
+            "activeNoteCount = activeNoteCount + "
+            "(NEW.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount + "
+            "(NEW.deletionTimestamp IS NOT NULL) "
+            "WHERE notebookLocalUid = NEW.notebookLocalUid; "
+            "INSERT INTO TagNoteCounts(tagLocalUid) "
+            "SELECT DISTINCT localTag FROM NoteTags WHERE "
+            "localNote = NEW.localUid AND localTag IS NOT NULL AND "
+            "localTag NOT IN (SELECT tagLocalUid FROM TagNoteCounts); "
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount + "
+            "(NEW.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount + "
+            "(NEW.deletionTimestamp IS NOT NULL) "
+            "WHERE tagLocalUid IN "
+            "(SELECT localTag FROM NoteTags WHERE localNote = NEW.localUid); "
+            "END"),
+        // Tag counters are updated by the triggers on NoteTags since note
+        // tags are removed by a trigger before the removal of the note
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNoteDelete "
+            "AFTER DELETE ON Notes "
+            "BEGIN "
+            "UPDATE NotebookNoteCounts SET "
+            "activeNoteCount = activeNoteCount - "
+            "(OLD.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount - "
+            "(OLD.deletionTimestamp IS NOT NULL) "
+            "WHERE notebookLocalUid = OLD.notebookLocalUid; "
+            "END"),
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNoteUpdate "
+            "AFTER UPDATE OF notebookLocalUid, deletionTimestamp ON Notes "
+            "BEGIN "
+            "UPDATE NotebookNoteCounts SET "
+            "activeNoteCount = activeNoteCount - "
+            "(OLD.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount - "
+            "(OLD.deletionTimestamp IS NOT NULL) "
+            "WHERE notebookLocalUid = OLD.notebookLocalUid; "
+            "INSERT INTO NotebookNoteCounts(notebookLocalUid) "
+            "SELECT NEW.notebookLocalUid WHERE "
+            "NEW.notebookLocalUid IS NOT NULL AND NOT EXISTS "
+            "(SELECT 1 FROM NotebookNoteCounts WHERE "
+            "notebookLocalUid = NEW.notebookLocalUid); "
+            "UPDATE NotebookNoteCounts SET "
+            "activeNoteCount = activeNoteCount + "
+            "(NEW.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount + "
+            "(NEW.deletionTimestamp IS NOT NULL) "
+            "WHERE notebookLocalUid = NEW.notebookLocalUid; "
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount - "
+            "(OLD.deletionTimestamp IS NULL) + "
+            "(NEW.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount - "
+            "(OLD.deletionTimestamp IS NOT NULL) + "
+            "(NEW.deletionTimestamp IS NOT NULL) "
+            "WHERE tagLocalUid IN "
+            "(SELECT localTag FROM NoteTags WHERE localNote = NEW.localUid); "
+            "END"),
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNoteTagReplace "
+            "BEFORE INSERT ON NoteTags "
+            "BEGIN "
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount - "
+            "(SELECT COUNT(*) FROM NoteTags INNER JOIN Notes "
+            "ON NoteTags.localNote = Notes.localUid WHERE "
+            "NoteTags.localNote = NEW.localNote AND "
+            "NoteTags.localTag = NEW.localTag AND "
+            "Notes.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount - "
+            "(SELECT COUNT(*) FROM NoteTags INNER JOIN Notes "
+            "ON NoteTags.localNote = Notes.localUid WHERE "
+            "NoteTags.localNote = NEW.localNote AND "
+            "NoteTags.localTag = NEW.localTag AND "
+            "Notes.deletionTimestamp IS NOT NULL) "
+            "WHERE tagLocalUid = NEW.localTag; "
+            "END"),
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNoteTagInsert "
+            "AFTER INSERT ON NoteTags "
+            "BEGIN "
+            "INSERT INTO TagNoteCounts(tagLocalUid) "
+            "SELECT NEW.localTag WHERE NEW.localTag IS NOT NULL AND "
+            "NOT EXISTS (SELECT 1 FROM TagNoteCounts WHERE "
+            "tagLocalUid = NEW.localTag); "
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount + "
+            "(SELECT COUNT(*) FROM Notes WHERE localUid = NEW.localNote "
+            "AND deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount + "
+            "(SELECT COUNT(*) FROM Notes WHERE localUid = NEW.localNote "
+            "AND deletionTimestamp IS NOT NULL) "
+            "WHERE tagLocalUid = NEW.localTag; "
+            "END"),
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNoteTagDelete "
+            "AFTER DELETE ON NoteTags "
+            "BEGIN "
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount - "
+            "(SELECT COUNT(*) FROM Notes WHERE localUid = OLD.localNote "
+            "AND deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount - "
+            "(SELECT COUNT(*) FROM Notes WHERE localUid = OLD.localNote "
+            "AND deletionTimestamp IS NOT NULL) "
+            "WHERE tagLocalUid = OLD.localTag; "
+            "END"),
+        // Changing the tag of note tag row may replace another row with
+        // the same note and tag which is also not reported to delete
+        // triggers
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNoteTagReplaceTag "
+            "BEFORE UPDATE OF localTag ON NoteTags "
+            "WHEN NEW.localTag IS NOT OLD.localTag "
+            "BEGIN "
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount - "
+            "(SELECT COUNT(*) FROM NoteTags INNER JOIN Notes "
+            "ON NoteTags.localNote = Notes.localUid WHERE "
+            "NoteTags.localNote = NEW.localNote AND "
+            "NoteTags.localTag = NEW.localTag AND "
+            "Notes.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount - "
+            "(SELECT COUNT(*) FROM NoteTags INNER JOIN Notes "
+            "ON NoteTags.localNote = Notes.localUid WHERE "
+            "NoteTags.localNote = NEW.localNote AND "
+            "NoteTags.localTag = NEW.localTag AND "
+            "Notes.deletionTimestamp IS NOT NULL) "
+            "WHERE tagLocalUid = NEW.localTag; "
+            "END"),
+        // The change of localNote is not tracked: it only happens as
+        // a cascade of the change of note's local uid which doesn't affect
+        // the counts
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNoteTagUpdate "
+            "AFTER UPDATE OF localTag ON NoteTags "
+            "BEGIN "
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount - "
+            "(SELECT COUNT(*) FROM Notes WHERE localUid = OLD.localNote "
+            "AND deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount - "
+            "(SELECT COUNT(*) FROM Notes WHERE localUid = OLD.localNote "
+            "AND deletionTimestamp IS NOT NULL) "
+            "WHERE tagLocalUid = OLD.localTag; "
+            "INSERT INTO TagNoteCounts(tagLocalUid) "
+            "SELECT NEW.localTag WHERE NEW.localTag IS NOT NULL AND "
+            "NOT EXISTS (SELECT 1 FROM TagNoteCounts WHERE "
+            "tagLocalUid = NEW.localTag); "
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount + "
+            "(SELECT COUNT(*) FROM Notes WHERE localUid = NEW.localNote "
+            "AND deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount + "
+            "(SELECT COUNT(*) FROM Notes WHERE localUid = NEW.localNote "
+            "AND deletionTimestamp IS NOT NULL) "
+            "WHERE tagLocalUid = NEW.localTag; "
+            "END"),
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnNotebookDelete "
+            "AFTER DELETE ON Notebooks "
+            "BEGIN "
+            "DELETE FROM NotebookNoteCounts WHERE "
+            "notebookLocalUid = OLD.localUid; "
+            "END"),
+        QStringLiteral(
+            "CREATE TRIGGER IF NOT EXISTS NoteCountersOnTagDelete "
+            "AFTER DELETE ON Tags "
+            "BEGIN "
+            "DELETE FROM TagNoteCounts WHERE tagLocalUid = OLD.localUid; "
+            "END")};
+
+    QSqlQuery query(m_sqlDatabase);
+    for (const auto & statement: statements) {
+        bool res = execQuery(query, statement);
+        if (!res) {
+            errorDescription.base() = errorPrefix.base();
+            errorDescription.details() = query.lastError().text();
+            QNWARNING(
+                "local_storage",
+                errorDescription << ", statement: " << statement);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+qint32 LocalStorageManagerPrivate::databaseSchemaFingerprint(
+    ErrorString & errorDescription)
+{
+    QSqlQuery query(m_sqlDatabase);
+    bool res = execQuery(query, QStringLiteral("PRAGMA user_version"));
+    if (Q_UNLIKELY(!res)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("failed to execute SQL query reading user_version "
+                       "pragma"));
+        errorDescription.details() = query.lastError().text();
+        QNWARNING("local_storage", errorDescription);
+        return -1;
+    }
+
+    if (!query.next()) {
+        return 0;
+    }
+
+    QVariant value = query.value(0);
+    bool conversionResult = false;
+    qint32 fingerprint = value.toInt(&conversionResult);
+    if (Q_UNLIKELY(!conversionResult)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("failed to decode the database schema fingerprint"));
+        QNWARNING("local_storage", errorDescription << ", value = " << value);
+        return -1;
+    }
+
+    return fingerprint;
+}
+
+bool LocalStorageManagerPrivate::setDatabaseSchemaFingerprint(
+    const qint32 fingerprint, ErrorString & errorDescription)
+{
+    QSqlQuery query(m_sqlDatabase);
+    bool res = execQuery(
+        query,
+        QString::fromUtf8("PRAGMA user_version = %1")
+            .arg(QString::number(fingerprint)));
+    if (Q_UNLIKELY(!res)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("failed to execute SQL query setting user_version "
+                       "pragma"));
+        errorDescription.details() = query.lastError().text();
+        QNWARNING("local_storage", errorDescription);
+        return false;
+    }
+
     return true;
 }
 
@@ -5989,7 +6814,7 @@ bool LocalStorageManagerPrivate::listNoteLocalUidsPerNotebook(
 
     query.bindValue(QStringLiteral(":notebookLocalUid"), notebookLocalUid);
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     noteLocalUids.reserve(std::max(query.size(), 0));
@@ -6020,7 +6845,7 @@ bool LocalStorageManagerPrivate::listNoteLocalUidsPerLinkedNotebook(
 
     query.bindValue(QStringLiteral(":linkedNotebookGuid"), linkedNotebookGuid);
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     noteLocalUids.reserve(std::max(query.size(), 0));
@@ -6092,7 +6917,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNotebookRestrictions(
                       .ref())
             : nullValue);
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -6201,7 +7026,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceSharedNotebook(
              ? sharedNotebook.indexInNotebook()
              : nullValue));
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -6218,7 +7043,7 @@ bool LocalStorageManagerPrivate::rowExists(
             .arg(tableName, uniqueKeyName, key);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     if (!res) {
         QNWARNING(
             "local_storage",
@@ -6331,7 +7156,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUser(
                  ? user.photoLastUpdateTimestamp()
                  : nullValue));
 
-        res = query.exec();
+        res = execQuery(query);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -6357,7 +7182,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUser(
                     .arg(userId);
 
             QSqlQuery query(m_sqlDatabase);
-            bool res = query.exec(queryString);
+            bool res = execQuery(query, queryString);
             DATABASE_CHECK_AND_SET_ERROR()
         }
 
@@ -6370,7 +7195,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUser(
                     .arg(userId);
 
             QSqlQuery query(m_sqlDatabase);
-            bool res = query.exec(queryString);
+            bool res = execQuery(query, queryString);
             DATABASE_CHECK_AND_SET_ERROR()
         }
 
@@ -6381,7 +7206,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUser(
                     .arg(userId);
 
             QSqlQuery query(m_sqlDatabase);
-            bool res = query.exec(queryString);
+            bool res = execQuery(query, queryString);
             DATABASE_CHECK_AND_SET_ERROR()
         }
     }
@@ -6403,7 +7228,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUser(
             QString::fromUtf8("DELETE FROM Accounting WHERE id=%1").arg(userId);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -6425,7 +7250,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUser(
                 .arg(userId);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -6447,7 +7272,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUser(
                 .arg(userId);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -6485,7 +7310,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceBusinessUserInfo(
         QStringLiteral(":businessInfoEmail"),
         (info.email.isSet() ? info.email.ref() : nullValue));
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -6534,7 +7359,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceAccounting(
 
 #undef CHECK_AND_BIND_VALUE
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -6575,7 +7400,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceAccountLimits(
 
 #undef CHECK_AND_BIND_VALUE
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -6648,7 +7473,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUserAttributes(
 
 #undef CHECK_AND_BIND_BOOLEAN_VALUE
 
-        res = query.exec();
+        res = execQuery(query);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -6660,7 +7485,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUserAttributes(
                 .arg(id);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -6676,7 +7501,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUserAttributes(
         const auto & viewedPromotions = attributes.viewedPromotions.ref();
         for (const auto & viewedPromotion: viewedPromotions) {
             query.bindValue(QStringLiteral(":promotion"), viewedPromotion);
-            res = query.exec();
+            res = execQuery(query);
             DATABASE_CHECK_AND_SET_ERROR()
         }
     }
@@ -6689,7 +7514,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUserAttributes(
                 .arg(id);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -6709,7 +7534,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceUserAttributes(
 
         for (const auto & recentMailedAddress: recentMailedAddresses) {
             query.bindValue(QStringLiteral(":address"), recentMailedAddress);
-            res = query.exec();
+            res = execQuery(query);
             DATABASE_CHECK_AND_SET_ERROR()
         }
     }
@@ -7160,7 +7985,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNotebook(
             (notebook.hasRecipientStack() ? notebook.recipientStack()
                                           : nullValue));
 
-        res = query.exec();
+        res = execQuery(query);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -7184,7 +8009,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNotebook(
                 .arg(localUid);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -7196,7 +8021,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNotebook(
                                   .arg(guid);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
 
         auto sharedNotebooks = notebook.sharedNotebooks();
@@ -7459,7 +8284,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceLinkedNotebook(
     query.bindValue(
         QStringLiteral(":isDirty"), (linkedNotebook.isDirty() ? 1 : 0));
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -7580,7 +8405,7 @@ bool LocalStorageManagerPrivate::getNoteLocalUidFromResource(
             .arg(column, uid);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     res = query.next();
@@ -7629,7 +8454,7 @@ bool LocalStorageManagerPrivate::getNotebookLocalUidFromNote(
                 .arg(notebookGuid);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
 
         res = query.next();
@@ -7665,7 +8490,7 @@ bool LocalStorageManagerPrivate::getNotebookLocalUidFromNote(
                 .arg(column, uid);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
 
         res = query.next();
@@ -7734,7 +8559,7 @@ bool LocalStorageManagerPrivate::getNotebookGuidForNote(
             .arg(notebookLocalUid);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     res = query.next();
@@ -7769,7 +8594,7 @@ bool LocalStorageManagerPrivate::getNotebookLocalUidForGuid(
             .arg(sqlEscapeString(notebookGuid));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (query.next()) {
@@ -7806,7 +8631,7 @@ bool LocalStorageManagerPrivate::getNoteLocalUidForGuid(
             .arg(sqlEscapeString(noteGuid));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (query.next()) {
@@ -7843,7 +8668,7 @@ bool LocalStorageManagerPrivate::getNoteGuidForLocalUid(
             .arg(sqlEscapeString(noteLocalUid));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (query.next()) {
@@ -7869,7 +8694,7 @@ bool LocalStorageManagerPrivate::getTagLocalUidForGuid(
             .arg(sqlEscapeString(tagGuid));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (query.next()) {
@@ -7908,7 +8733,7 @@ bool LocalStorageManagerPrivate::getResourceLocalUidForGuid(
             .arg(sqlEscapeString(resourceGuid));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (query.next()) {
@@ -7947,7 +8772,7 @@ bool LocalStorageManagerPrivate::getSavedSearchLocalUidForGuid(
             .arg(sqlEscapeString(savedSearchGuid));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     if (query.next()) {
@@ -8068,7 +8893,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNote(
                 .arg(localUid);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -8383,7 +9208,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNote(
 #undef BIND_NULL_ATTRIBUTE
         }
 
-        res = query.exec();
+        res = execQuery(query);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -8403,7 +9228,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNote(
                 .arg(localUid);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -8422,7 +9247,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNote(
                 .arg(localUid);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -8437,7 +9262,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNote(
                     .arg(noteGuid);
 
             QSqlQuery query(m_sqlDatabase);
-            bool res = query.exec(queryString);
+            bool res = execQuery(query, queryString);
             DATABASE_CHECK_AND_SET_ERROR()
         }
 
@@ -8462,7 +9287,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNote(
                     .arg(localUid);
 
             QSqlQuery query(m_sqlDatabase);
-            bool res = query.exec(queryString);
+            bool res = execQuery(query, queryString);
             DATABASE_CHECK_AND_SET_ERROR()
         }
 
@@ -8543,7 +9368,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNote(
                 query.bindValue(
                     QStringLiteral(":tagIndexInNote"), tagIndexInNote);
 
-                res = query.exec();
+                res = execQuery(query);
                 DATABASE_CHECK_AND_SET_ERROR()
 
                 ++tagIndexInNote;
@@ -8576,7 +9401,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNote(
                     .arg(localUid);
 
             QSqlQuery query(m_sqlDatabase);
-            bool res = query.exec(queryString);
+            bool res = execQuery(query, queryString);
             DATABASE_CHECK_AND_SET_ERROR()
         }
         else {
@@ -8758,7 +9583,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceSharedNote(
         ((sharedNote.indexInNote() >= 0) ? sharedNote.indexInNote()
                                          : nullValue));
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -8794,7 +9619,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNoteRestrictions(
 
 #undef BIND_RESTRICTION
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -8827,7 +9652,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceNoteLimits(
 
 #undef BIND_LIMIT
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -9185,7 +10010,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceTag(
     query.bindValue(
         QStringLiteral(":isFavorited"), (tag.isFavorited() ? 1 : 0));
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -9275,7 +10100,7 @@ bool LocalStorageManagerPrivate::complementTagParentInfo(
     QNDEBUG("local_storage", "Query string = " << queryString);
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     res = query.next();
@@ -9347,7 +10172,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceResource(
 
         query.bindValue(QStringLiteral(":resourceLocalUid"), resourceLocalUid);
 
-        res = query.exec();
+        res = execQuery(query);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -9389,7 +10214,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceResource(
                 query.bindValue(
                     QStringLiteral(":recognitionData"), recognitionData);
 
-                res = query.exec();
+                res = execQuery(query);
                 DATABASE_CHECK_AND_SET_ERROR()
             }
         }
@@ -9403,7 +10228,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceResource(
 
         query.bindValue(QStringLiteral(":resourceLocalUid"), resourceLocalUid);
 
-        res = query.exec();
+        res = execQuery(query);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -9419,7 +10244,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceResource(
 
         query.bindValue(QStringLiteral(":resourceLocalUid"), resourceLocalUid);
 
-        res = query.exec();
+        res = execQuery(query);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -9435,7 +10260,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceResource(
 
         query.bindValue(QStringLiteral(":resourceLocalUid"), resourceLocalUid);
 
-        res = query.exec();
+        res = execQuery(query);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -9835,7 +10660,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceResourceAttributes(
                  ? (attributes.attachment.ref() ? 1 : 0)
                  : nullValue));
 
-        res = query.exec();
+        res = execQuery(query);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -9857,7 +10682,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceResourceAttributes(
             const auto & keysOnly = attributes.applicationData->keysOnly.ref();
             for (const auto & key: keysOnly) {
                 query.bindValue(QStringLiteral(":resourceKey"), key);
-                res = query.exec();
+                res = execQuery(query);
                 DATABASE_CHECK_AND_SET_ERROR()
             }
         }
@@ -9877,7 +10702,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceResourceAttributes(
             for (const auto it: qevercloud::toRange(fullMap)) {
                 query.bindValue(QStringLiteral(":resourceMapKey"), it.key());
                 query.bindValue(QStringLiteral(":resourceValue"), it.value());
-                res = query.exec();
+                res = execQuery(query);
                 DATABASE_CHECK_AND_SET_ERROR()
             }
         }
@@ -9980,7 +10805,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceResourceMetadata(
                                              : nullValue));
     }
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -10012,7 +10837,7 @@ bool LocalStorageManagerPrivate::updateNoteResources(
         QStringLiteral(":resource"),
         (resource.hasGuid() ? resource.guid() : nullValue));
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     return true;
@@ -10641,7 +11466,7 @@ bool LocalStorageManagerPrivate::insertOrReplaceSavedSearch(
     query.bindValue(
         QStringLiteral(":isFavorited"), (search.isFavorited() ? 1 : 0));
 
-    res = query.exec();
+    res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
     return true;
 }
@@ -10730,7 +11555,7 @@ bool LocalStorageManagerPrivate::complementTagsWithNoteLocalUids(
     queryString += QStringLiteral(")");
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     QMap<QString, QSet<QString>> noteLocalUidsByTagLocalUid;
@@ -12734,7 +13559,7 @@ bool LocalStorageManagerPrivate::findAndSetTagIdsPerNote(
                        "NoteTags WHERE localNote = ?"));
     query.addBindValue(noteLocalUid);
 
-    bool res = query.exec();
+    bool res = execQuery(query);
     DATABASE_CHECK_AND_SET_ERROR()
 
     QMultiHash<int, QString> tagGuidsAndIndices;
@@ -12880,7 +13705,7 @@ bool LocalStorageManagerPrivate::findAndSetResourcesPerNote(
             .arg(sqlEscapeString(noteLocalUid));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     QStringList resourceLocalUids;
@@ -13002,7 +13827,7 @@ bool LocalStorageManagerPrivate::noteSearchQueryToSQL(
                 "notebookName MATCH '%1' LIMIT 1")
                 .arg(sqlEscapeString(notebookName));
 
-        bool res = query.exec(notebookQueryString);
+        bool res = execQuery(query, notebookQueryString);
         DATABASE_CHECK_AND_SET_ERROR()
 
         if (Q_UNLIKELY(!query.next())) {
@@ -13938,10 +14763,10 @@ bool LocalStorageManagerPrivate::tagNamesToTagLocalUids(
 
     bool res = false;
     if (queryString.isEmpty()) {
-        res = query.exec();
+        res = execQuery(query);
     }
     else {
-        res = query.exec(queryString);
+        res = execQuery(query, queryString);
     }
     DATABASE_CHECK_AND_SET_ERROR()
 
@@ -14034,10 +14859,10 @@ bool LocalStorageManagerPrivate::resourceMimeTypesToResourceLocalUids(
 
     bool res = false;
     if (queryString.isEmpty()) {
-        res = query.exec();
+        res = execQuery(query);
     }
     else {
-        res = query.exec(queryString);
+        res = execQuery(query, queryString);
     }
     DATABASE_CHECK_AND_SET_ERROR()
 
@@ -14071,7 +14896,7 @@ bool LocalStorageManagerPrivate::complementResourceNoteIds(
                 .arg(noteLocalUid);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
 
         if (query.next()) {
@@ -14086,7 +14911,7 @@ bool LocalStorageManagerPrivate::complementResourceNoteIds(
                 .arg(noteGuid);
 
         QSqlQuery query(m_sqlDatabase);
-        bool res = query.exec(queryString);
+        bool res = execQuery(query, queryString);
         DATABASE_CHECK_AND_SET_ERROR()
 
         if (query.next()) {
@@ -14137,7 +14962,7 @@ bool LocalStorageManagerPrivate::partialUpdateNoteResources(
             .arg(sqlEscapeString(noteLocalUid));
 
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(listNoteResourcesQueryString);
+    bool res = execQuery(query, listNoteResourcesQueryString);
     DATABASE_CHECK_AND_SET_ERROR()
 
     QList<Resource> previousNoteResources;
@@ -14268,7 +15093,7 @@ bool LocalStorageManagerPrivate::partialUpdateNoteResources(
             QString::fromUtf8(
                 "DELETE FROM Resources WHERE resourceLocalUid IN ('%1')")
                 .arg(localUidsOfExpungedResources.join(QStringLiteral(",")));
-        res = query.exec(removeResourcesQueryString);
+        res = execQuery(query, removeResourcesQueryString);
         DATABASE_CHECK_AND_SET_ERROR()
     }
 
@@ -15121,7 +15946,7 @@ QList<T> LocalStorageManagerPrivate::listObjects(
         "can't list objects from the local "
         "storage database by filter"));
     QSqlQuery query(m_sqlDatabase);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     if (!res) {
         errorDescription.base() = errorPrefix.base();
         QNERROR(
@@ -79,6 +79,14 @@ public:
     qint32 localStorageVersion(ErrorString & errorDescription);
     qint32 highestSupportedLocalStorageVersion() const;
 
+    bool databaseFragmentationStatistics(
+        qint64 & pageSize, qint64 & pageCount, qint64 & freePageCount,
+        ErrorString & errorDescription) const;
+
+    qint64 writeAheadLogFileSize() const;
+    int incrementalVacuum(const int maxPages, ErrorString & errorDescription);
+    bool checkpointWriteAheadLog(ErrorString & errorDescription);
+
     int userCount(ErrorString & errorDescription) const;
     bool addUser(const User & user, ErrorString & errorDescription);
     bool updateUser(const User & user, ErrorString & errorDescription);
@@ -173,6 +181,9 @@ public:
     QString noteCountOptionsToSqlQueryPart(
         const LocalStorageManager::NoteCountOptions options) const;
 
+    QString noteCountOptionsToNoteCounterColumns(
+        const LocalStorageManager::NoteCountOptions options) const;
+
     bool addNote(Note & note, ErrorString & errorDescription);
 
     bool updateNote(
@@ -250,6 +261,11 @@ public:
     bool updateTag(Tag & tag, ErrorString & errorDescription);
     bool findTag(Tag & tag, ErrorString & errorDescription) const;
 
+    bool findOrAddTags(
+        const QList<Tag> & tags, QList<Tag> & addedTags,
+        QHash<QString, Tag> & localConflictsByGuid,
+        ErrorString & errorDescription);
+
     QList<Tag> listAllTagsPerNote(
         const Note & note, ErrorString & errorDescription,
         const LocalStorageManager::ListObjectsOptions & flag,
@@ -325,8 +341,47 @@ public:
         const QString & queryCondition, qint32 & usn,
         ErrorString & errorDescription);
 
+    bool guidIndex(
+        LocalStorageManager::GuidIndex & index,
+        ErrorString & errorDescription);
+
+    bool guidIndexEntriesFromTable(
+        const QString & tableName,
+        QHash<QString, LocalStorageManager::GuidIndexEntry> & entries,
+        ErrorString & errorDescription);
+
     bool compactLocalStorage(ErrorString & errorDescription);
 
+    /**
+     * @return          SQL statements creating indexes serving the most
+     *                  frequent list and count queries and scans for dirty
+     *                  objects made before sending local changes; local
+     *                  storage patch from version 3 to version 4 executes
+     *                  them one by one
+     */
+    QStringList listingIndexStatements() const;
+
+    /**
+     * Executes all listing index statements at once; used when creating
+     * the tables of the database which is already of version 4 or later
+     */
+    bool createListingIndexes(ErrorString & errorDescription);
+
+    /**
+     * Creates empty tables holding the numbers of notes per notebook and per
+     * tag; local storage patch from version 4 to version 5 fills them in
+     * batches before the triggers keeping them up to date are created
+     */
+    bool createNoteCounterTables(ErrorString & errorDescription);
+
+    /**
+     * Creates note counter tables along with triggers keeping them up to date
+     * as notes and their tags change; used both when creating the tables of
+     * the database which is already of version 5 and by local storage patch
+     * from version 4 to version 5
+     */
+    bool createNoteCounters(ErrorString & errorDescription);
+
 public Q_SLOTS:
     void processPostTransactionException(ErrorString message, QSqlError error);
 
@@ -338,6 +393,11 @@ private:
 
     bool createTables(ErrorString & errorDescription);
 
+    qint32 databaseSchemaFingerprint(ErrorString & errorDescription);
+
+    bool setDatabaseSchemaFingerprint(
+        const qint32 fingerprint, ErrorString & errorDescription);
+
     bool listNoteLocalUidsPerNotebook(
         const QString & notebookLocalUid, QStringList & noteLocalUids,
         ErrorString & errorDescription) const;
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <quentier/local_storage/LocalStorageRequestTraceSnapshot.h>
+#include <quentier/utility/Compat.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace quentier {
+
+namespace {
+
+QJsonObject histogramToJson(
+    const LocalStorageRequestTraceSnapshot::Histogram & histogram)
+{
+    QJsonArray buckets;
+    for (const auto count: qAsConst(histogram.m_buckets)) {
+        buckets.append(static_cast<double>(count));
+    }
+
+    QJsonObject object;
+    object[QStringLiteral("count")] = static_cast<double>(histogram.m_count);
+
+    object[QStringLiteral("totalUsec")] =
+        static_cast<double>(histogram.m_totalUsec);
+
+    object[QStringLiteral("maxUsec")] =
+        static_cast<double>(histogram.m_maxUsec);
+
+    object[QStringLiteral("buckets")] = buckets;
+    return object;
+}
+
+void printHistogram(
+    QTextStream & strm,
+    const LocalStorageRequestTraceSnapshot::Histogram & histogram)
+{
+    strm << "count = " << histogram.m_count
+         << ", total usec = " << histogram.m_totalUsec
+         << ", max usec = " << histogram.m_maxUsec;
+}
+
+} // namespace
+
+QTextStream & LocalStorageRequestTraceSnapshot::print(
+    QTextStream & strm) const
+{
+    strm << "LocalStorageRequestTraceSnapshot: {\n  requests:\n";
+    for (auto it = m_requestStats.constBegin(), end = m_requestStats.constEnd();
+         it != end; ++it)
+    {
+        const auto & stats = it.value();
+
+        strm << "    " << it.key() << ":\n      queue wait: ";
+        printHistogram(strm, stats.m_queueWait);
+
+        strm << ", unmeasured = " << stats.m_unmeasuredQueueWaits
+             << "\n      execution: ";
+
+        printHistogram(strm, stats.m_execution);
+        strm << "\n";
+    }
+
+    strm << "  slow queries:\n";
+    for (const auto & slowQuery: qAsConst(m_slowQueries)) {
+        strm << "    [" << slowQuery.m_timestamp.toString(Qt::ISODate)
+             << "] " << slowQuery.m_requestType << ", "
+             << slowQuery.m_durationUsec << " usec: " << slowQuery.m_statement
+             << "\n      query plan: " << slowQuery.m_queryPlan << "\n";
+    }
+
+    strm << "}\n";
+    return strm;
+}
+
+QByteArray LocalStorageRequestTraceSnapshot::toJson() const
+{
+    QJsonArray bounds;
+    for (const auto bound: qAsConst(m_histogramBucketBoundsUsec)) {
+        bounds.append(static_cast<double>(bound));
+    }
+
+    QJsonObject requests;
+    for (auto it = m_requestStats.constBegin(), end = m_requestStats.constEnd();
+         it != end; ++it)
+    {
+        const auto & stats = it.value();
+
+        QJsonObject statsObject;
+        statsObject[QStringLiteral("queueWait")] =
+            histogramToJson(stats.m_queueWait);
+
+        statsObject[QStringLiteral("execution")] =
+            histogramToJson(stats.m_execution);
+
+        statsObject[QStringLiteral("unmeasuredQueueWaits")] =
+            static_cast<double>(stats.m_unmeasuredQueueWaits);
+
+        requests[it.key()] = statsObject;
+    }
+
+    QJsonArray slowQueries;
+    for (const auto & slowQuery: qAsConst(m_slowQueries)) {
+        QJsonObject slowQueryObject;
+        slowQueryObject[QStringLiteral("timestamp")] =
+            slowQuery.m_timestamp.toString(Qt::ISODate);
+
+        slowQueryObject[QStringLiteral("requestType")] =
+            slowQuery.m_requestType;
+
+        slowQueryObject[QStringLiteral("statement")] = slowQuery.m_statement;
+        slowQueryObject[QStringLiteral("queryPlan")] = slowQuery.m_queryPlan;
+
+        slowQueryObject[QStringLiteral("durationUsec")] =
+            static_cast<double>(slowQuery.m_durationUsec);
+
+        slowQueries.append(slowQueryObject);
+    }
+
+    QJsonObject object;
+    object[QStringLiteral("histogramBucketBoundsUsec")] = bounds;
+    object[QStringLiteral("requests")] = requests;
+    object[QStringLiteral("slowQueries")] = slowQueries;
+
+    return QJsonDocument(object).toJson(QJsonDocument::Indented);
+}
+
+} // namespace quentier
@@ -0,0 +1,476 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStorageRequestTracer.h"
+
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QMetaMethod>
+#include <QMutexLocker>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSqlResult>
+#include <QStringList>
+
+#include <algorithm>
+
+// Stamps which are never taken, for example the ones left by the requests
+// sent before their signals were hooked, are dropped once there are this many
+// of them
+#define MAX_PENDING_STAMPS (10000)
+
+#define MAX_SLOW_QUERIES (100)
+
+#define SLOW_QUERY_DEFAULT_THRESHOLD_MSEC (50)
+
+namespace quentier {
+
+namespace {
+
+const qint64 gHistogramBucketBoundsUsec[] = {
+    100,    250,    500,    1000,   2500,   5000,   10000,
+    25000,  50000,  100000, 250000, 500000, 1000000};
+
+const int gHistogramBucketCount =
+    static_cast<int>(
+        sizeof(gHistogramBucketBoundsUsec) /
+        sizeof(gHistogramBucketBoundsUsec[0])) +
+    1;
+
+thread_local LocalStorageRequestTracer::RequestScope * tCurrentScope =
+    nullptr;
+
+QString queryPlan(const QSqlQuery & query)
+{
+    const QSqlDriver * pDriver = query.driver();
+    if (Q_UNLIKELY(!pDriver)) {
+        return {};
+    }
+
+    // The query plan is obtained via the same database connection as
+    // the one on which the query itself was executed
+    QSqlQuery explainQuery(pDriver->createResult());
+
+    bool res = explainQuery.prepare(
+        QStringLiteral("EXPLAIN QUERY PLAN ") + query.lastQuery());
+
+    if (res) {
+        const int numBoundValues = query.boundValues().size();
+        for (int i = 0; i < numBoundValues; ++i) {
+            explainQuery.bindValue(i, query.boundValue(i));
+        }
+
+        res = explainQuery.exec();
+    }
+
+    if (!res) {
+        return QStringLiteral("Failed to explain query plan: ") +
+            explainQuery.lastError().text();
+    }
+
+    // The detail is in the last column regardless of SQLite version
+    QStringList details;
+    while (explainQuery.next()) {
+        const auto record = explainQuery.record();
+        details << record.value(record.count() - 1).toString();
+    }
+
+    return details.join(QStringLiteral("\n"));
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @brief The SignalHook class is directly connected to a single signal sending
+ * requests to LocalStorageManagerAsync and stamps the request ids with
+ * emission times. It is not a Q_OBJECT: like QSignalSpy it handles the call of
+ * the method beyond QObject's ones in its own qt_metacall
+ */
+class LocalStorageRequestTracer::SignalHook final : public QObject
+{
+public:
+    SignalHook(
+        LocalStorageRequestTracer & tracer, const int requestIdArgIndex) :
+        m_tracer(tracer),
+        m_requestIdArgIndex(requestIdArgIndex)
+    {}
+
+    bool connectToSignal(QObject * pSender, const int signalIndex)
+    {
+        return static_cast<bool>(QMetaObject::connect(
+            pSender, signalIndex, this,
+            QObject::staticMetaObject.methodCount(), Qt::DirectConnection,
+            nullptr));
+    }
+
+    int qt_metacall(
+        QMetaObject::Call call, int methodId, void ** args) override
+    {
+        methodId = QObject::qt_metacall(call, methodId, args);
+        if (methodId < 0) {
+            return methodId;
+        }
+
+        if (call == QMetaObject::InvokeMetaMethod) {
+            if ((methodId == 0) && m_tracer.isEnabled()) {
+                // args[0] is the return value
+                const auto * pRequestId = reinterpret_cast<const QUuid *>(
+                    args[m_requestIdArgIndex + 1]);
+
+                m_tracer.stamp(*pRequestId);
+            }
+
+            --methodId;
+        }
+
+        return methodId;
+    }
+
+private:
+    LocalStorageRequestTracer & m_tracer;
+    const int m_requestIdArgIndex;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+LocalStorageRequestTracer::LocalStorageRequestTracer() :
+    m_enabled(0), m_slowQueryThresholdMsec(SLOW_QUERY_DEFAULT_THRESHOLD_MSEC)
+{
+    m_clock.start();
+}
+
+LocalStorageRequestTracer::~LocalStorageRequestTracer() = default;
+
+bool LocalStorageRequestTracer::isEnabled() const
+{
+    return m_enabled.loadAcquire() != 0;
+}
+
+void LocalStorageRequestTracer::setEnabled(const bool enabled)
+{
+    m_enabled.storeRelease(enabled ? 1 : 0);
+}
+
+void LocalStorageRequestTracer::setSlowQueryThresholdMsec(
+    const int thresholdMsec)
+{
+    m_slowQueryThresholdMsec.storeRelease(std::max(thresholdMsec, 0));
+}
+
+LocalStorageRequestTraceSnapshot LocalStorageRequestTracer::snapshot() const
+{
+    LocalStorageRequestTraceSnapshot snapshot;
+
+    snapshot.m_histogramBucketBoundsUsec.reserve(gHistogramBucketCount - 1);
+    for (const auto bound: gHistogramBucketBoundsUsec) {
+        snapshot.m_histogramBucketBoundsUsec << bound;
+    }
+
+    QMutexLocker lock(&m_mutex);
+    snapshot.m_requestStats = m_requestStats;
+    snapshot.m_slowQueries = m_slowQueries;
+    return snapshot;
+}
+
+void LocalStorageRequestTracer::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_stamps.clear();
+    m_requestStats.clear();
+    m_slowQueries.clear();
+}
+
+bool LocalStorageRequestTracer::isTracingCurrentThread()
+{
+    return tCurrentScope != nullptr;
+}
+
+void LocalStorageRequestTracer::traceQuery(
+    const QSqlQuery & query, const qint64 elapsedNsec)
+{
+    auto * pScope = tCurrentScope;
+    if (!pScope) {
+        return;
+    }
+
+    const qint64 thresholdNsec =
+        static_cast<qint64>(
+            pScope->m_tracer.m_slowQueryThresholdMsec.loadAcquire()) *
+        1000000;
+
+    if (elapsedNsec < thresholdNsec) {
+        return;
+    }
+
+    pScope->m_tracer.addSlowQuery(pScope->m_slotName, query, elapsedNsec);
+}
+
+void LocalStorageRequestTracer::stamp(const QUuid & requestId)
+{
+    const qint64 nsec = m_clock.nsecsElapsed();
+
+    QMutexLocker lock(&m_mutex);
+
+    auto it = m_stamps.find(requestId);
+    if ((it != m_stamps.end()) && it.value().m_processedBySlot) {
+        // The request has been processed before it was stamped: it didn't
+        // have to wait in the queue
+        auto & stats =
+            m_requestStats[requestType(it.value().m_processedBySlot)];
+
+        if (stats.m_unmeasuredQueueWaits > 0) {
+            --stats.m_unmeasuredQueueWaits;
+        }
+
+        addToHistogram(stats.m_queueWait, 0);
+        m_stamps.erase(it);
+        return;
+    }
+
+    if (m_stamps.size() >= MAX_PENDING_STAMPS) {
+        m_stamps.clear();
+    }
+
+    m_stamps[requestId].m_emissionNsec = nsec;
+}
+
+qint64 LocalStorageRequestTracer::takeStamp(const QUuid & requestId)
+{
+    QMutexLocker lock(&m_mutex);
+    auto it = m_stamps.find(requestId);
+    if (it == m_stamps.end()) {
+        return -1;
+    }
+
+    qint64 nsec = it.value().m_emissionNsec;
+    m_stamps.erase(it);
+    return nsec;
+}
+
+bool LocalStorageRequestTracer::hookSignal(
+    QObject * pSender, const int signalIndex)
+{
+    auto & hookedSender = m_hookedSenders[pSender];
+    if (hookedSender.m_pSender.isNull()) {
+        // Either the sender is seen for the first time or the previous sender
+        // at the same address was destroyed, along with its connections
+        hookedSender.m_pSender = pSender;
+        hookedSender.m_signalHooks.clear();
+    }
+
+    auto it = hookedSender.m_signalHooks.constFind(signalIndex);
+    if (it != hookedSender.m_signalHooks.constEnd()) {
+        return static_cast<bool>(it.value());
+    }
+
+    auto & signalHook = hookedSender.m_signalHooks[signalIndex];
+
+    const QMetaMethod signal = pSender->metaObject()->method(signalIndex);
+    const int uuidTypeId = qMetaTypeId<QUuid>();
+
+    int requestIdArgIndex = -1;
+    for (int i = signal.parameterCount() - 1; i >= 0; --i) {
+        if (signal.parameterType(i) == uuidTypeId) {
+            requestIdArgIndex = i;
+            break;
+        }
+    }
+
+    if (requestIdArgIndex < 0) {
+        QNDEBUG(
+            "local_storage",
+            "Signal " << signal.methodSignature()
+                      << " has no request id parameter, won't trace "
+                      << "the queue wait of requests sent with it");
+        return false;
+    }
+
+    signalHook = std::make_shared<SignalHook>(*this, requestIdArgIndex);
+    if (!signalHook->connectToSignal(pSender, signalIndex)) {
+        QNWARNING(
+            "local_storage",
+            "Failed to connect to signal " << signal.methodSignature()
+                                           << " to trace requests");
+        signalHook.reset();
+    }
+
+    // The request being processed now was sent before the signal was hooked
+    return false;
+}
+
+void LocalStorageRequestTracer::addRequest(
+    const char * slotName, const QUuid & requestId,
+    const qint64 queueWaitNsec, const bool awaitingStamp,
+    const qint64 executionNsec)
+{
+    const QString type = requestType(slotName);
+
+    QMutexLocker lock(&m_mutex);
+    auto & stats = m_requestStats[type];
+
+    if (queueWaitNsec >= 0) {
+        addToHistogram(stats.m_queueWait, queueWaitNsec);
+    }
+    else if (awaitingStamp && m_stamps.contains(requestId)) {
+        // The stamp was put while the request was being processed
+        m_stamps.remove(requestId);
+        addToHistogram(stats.m_queueWait, 0);
+    }
+    else {
+        ++stats.m_unmeasuredQueueWaits;
+
+        if (awaitingStamp) {
+            if (m_stamps.size() >= MAX_PENDING_STAMPS) {
+                m_stamps.clear();
+            }
+
+            m_stamps[requestId].m_processedBySlot = slotName;
+        }
+    }
+
+    addToHistogram(stats.m_execution, executionNsec);
+}
+
+void LocalStorageRequestTracer::addSlowQuery(
+    const char * slotName, const QSqlQuery & query, const qint64 elapsedNsec)
+{
+    LocalStorageRequestTraceSnapshot::SlowQuery slowQuery;
+    slowQuery.m_timestamp = QDateTime::currentDateTime();
+    slowQuery.m_requestType = requestType(slotName);
+    slowQuery.m_statement = query.lastQuery();
+    slowQuery.m_queryPlan = queryPlan(query);
+    slowQuery.m_durationUsec = elapsedNsec / 1000;
+
+    QNDEBUG(
+        "local_storage",
+        "Slow query took " << slowQuery.m_durationUsec << " usec within "
+                           << slowQuery.m_requestType << " request: "
+                           << slowQuery.m_statement << "\nQuery plan:\n"
+                           << slowQuery.m_queryPlan);
+
+    QMutexLocker lock(&m_mutex);
+    if (m_slowQueries.size() >= MAX_SLOW_QUERIES) {
+        m_slowQueries.removeFirst();
+    }
+
+    m_slowQueries << slowQuery;
+}
+
+QString LocalStorageRequestTracer::requestType(const char * slotName)
+{
+    // Slot names look like "onAddNoteRequest" which becomes "addNote"
+    QString type = QString::fromUtf8(slotName);
+
+    if (type.startsWith(QStringLiteral("on"))) {
+        type.remove(0, 2);
+        if (!type.isEmpty()) {
+            type[0] = type.at(0).toLower();
+        }
+    }
+
+    if (type.endsWith(QStringLiteral("Request"))) {
+        type.chop(7);
+    }
+
+    return type;
+}
+
+void LocalStorageRequestTracer::addToHistogram(
+    LocalStorageRequestTraceSnapshot::Histogram & histogram,
+    const qint64 nsec)
+{
+    const qint64 usec = nsec / 1000;
+
+    ++histogram.m_count;
+    histogram.m_totalUsec += usec;
+    histogram.m_maxUsec = std::max(histogram.m_maxUsec, usec);
+
+    if (histogram.m_buckets.isEmpty()) {
+        histogram.m_buckets.resize(gHistogramBucketCount);
+    }
+
+    const auto * boundsEnd =
+        gHistogramBucketBoundsUsec + gHistogramBucketCount - 1;
+
+    const auto * bound =
+        std::upper_bound(gHistogramBucketBoundsUsec, boundsEnd, usec);
+
+    ++histogram.m_buckets[static_cast<int>(
+        bound - gHistogramBucketBoundsUsec)];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+LocalStorageRequestTracer::RequestScope::RequestScope(
+    LocalStorageRequestTracer & tracer, const char * slotName,
+    const QUuid & requestId) :
+    m_tracer(tracer),
+    m_slotName(slotName), m_requestId(requestId),
+    m_active(tracer.isEnabled())
+{
+    if (!m_active) {
+        return;
+    }
+
+    m_startNsec = m_tracer.m_clock.nsecsElapsed();
+    m_pPreviousScope = tCurrentScope;
+    tCurrentScope = this;
+}
+
+LocalStorageRequestTracer::RequestScope::~RequestScope()
+{
+    if (!m_active) {
+        return;
+    }
+
+    tCurrentScope = m_pPreviousScope;
+
+    m_tracer.addRequest(
+        m_slotName, m_requestId, m_queueWaitNsec, m_awaitingStamp,
+        m_tracer.m_clock.nsecsElapsed() - m_startNsec);
+}
+
+void LocalStorageRequestTracer::RequestScope::measureQueueWait(
+    QObject * pSender, const int signalIndex, const QThread * pReceiverThread)
+{
+    if (!m_active || !pSender || (signalIndex < 0)) {
+        return;
+    }
+
+    if (pSender->thread() == pReceiverThread) {
+        // The request was most likely delivered via direct connection so it
+        // didn't wait in the queue at all; stamping such requests would only
+        // leave stale stamps as the hook would be called after the slot
+        m_queueWaitNsec = 0;
+        return;
+    }
+
+    const qint64 stampNsec = m_tracer.takeStamp(m_requestId);
+    if (stampNsec >= 0) {
+        m_queueWaitNsec = std::max<qint64>(m_startNsec - stampNsec, 0);
+        return;
+    }
+
+    m_awaitingStamp = m_tracer.hookSignal(pSender, signalIndex);
+}
+
+} // namespace quentier
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_LOCAL_STORAGE_LOCAL_STORAGE_REQUEST_TRACER_H
+#define LIB_QUENTIER_LOCAL_STORAGE_LOCAL_STORAGE_REQUEST_TRACER_H
+
+#include <quentier/local_storage/LocalStorageRequestTraceSnapshot.h>
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QPointer>
+#include <QUuid>
+
+#include <memory>
+
+QT_FORWARD_DECLARE_CLASS(QSqlQuery)
+QT_FORWARD_DECLARE_CLASS(QThread)
+
+namespace quentier {
+
+/**
+ * @brief The LocalStorageRequestTracer class collects queue wait and execution
+ * times of requests processed by LocalStorageManagerAsync and the log of slow
+ * SQL statements executed while processing them.
+ *
+ * Queue wait is measured by stamping the request id with the emission time:
+ * the first time a request arrives from some signal of some sender, the tracer
+ * connects to that signal directly so that all subsequent emissions of it are
+ * stamped in the emitting thread, before the request reaches the queue.
+ *
+ * All methods except for RequestScope ones are thread-safe.
+ */
+class Q_DECL_HIDDEN LocalStorageRequestTracer
+{
+public:
+    LocalStorageRequestTracer();
+    ~LocalStorageRequestTracer();
+
+    bool isEnabled() const;
+    void setEnabled(const bool enabled);
+
+    void setSlowQueryThresholdMsec(const int thresholdMsec);
+
+    LocalStorageRequestTraceSnapshot snapshot() const;
+    void clear();
+
+    /**
+     * @return          True if a request is being traced in the current thread,
+     *                  false otherwise
+     */
+    static bool isTracingCurrentThread();
+
+    /**
+     * Adds the just executed query to the slow query log if a request is
+     * being traced in the current thread and the query took longer than
+     * the slow query threshold
+     */
+    static void traceQuery(const QSqlQuery & query, const qint64 elapsedNsec);
+
+    /**
+     * @brief The RequestScope class measures the processing of a single
+     * request; it should be created on the stack at the beginning of
+     * LocalStorageManagerAsync's slot processing the request
+     */
+    class RequestScope
+    {
+    public:
+        RequestScope(
+            LocalStorageRequestTracer & tracer, const char * slotName,
+            const QUuid & requestId);
+
+        ~RequestScope();
+
+        bool isActive() const
+        {
+            return m_active;
+        }
+
+        /**
+         * Finds out how long the request waited in the queue and ensures
+         * the subsequent requests sent via the same signal of the same sender
+         * would be stamped
+         *
+         * @param pSender           The sender of the request, as returned by
+         *                          QObject::sender
+         * @param signalIndex       The index of the signal which sent
+         *                          the request, as returned by
+         *                          QObject::senderSignalIndex
+         * @param pReceiverThread   The thread of LocalStorageManagerAsync
+         */
+        void measureQueueWait(
+            QObject * pSender, const int signalIndex,
+            const QThread * pReceiverThread);
+
+    private:
+        Q_DISABLE_COPY(RequestScope)
+
+        friend class LocalStorageRequestTracer;
+
+    private:
+        LocalStorageRequestTracer & m_tracer;
+        const char * m_slotName;
+        QUuid m_requestId;
+        bool m_active;
+        bool m_awaitingStamp = false;
+        qint64 m_startNsec = 0;
+        qint64 m_queueWaitNsec = -1;
+        RequestScope * m_pPreviousScope = nullptr;
+    };
+
+private:
+    class SignalHook;
+
+    struct HookedSender
+    {
+        QPointer<QObject> m_pSender;
+
+        // Hooks by signal index; null hook means the signal has no request
+        // id parameter and cannot be stamped
+        QHash<int, std::shared_ptr<SignalHook>> m_signalHooks;
+    };
+
+    /**
+     * The hook is called after the request has already been posted to
+     * the queue so the request might get processed before it is stamped;
+     * in this case the request's stamp is left for the hook to find,
+     * with the processing slot's name instead of emission time
+     */
+    struct Stamp
+    {
+        qint64 m_emissionNsec = 0;
+        const char * m_processedBySlot = nullptr;
+    };
+
+    void stamp(const QUuid & requestId);
+    qint64 takeStamp(const QUuid & requestId);
+
+    /**
+     * @return          True if the signal had been hooked before this call,
+     *                  false otherwise
+     */
+    bool hookSignal(QObject * pSender, const int signalIndex);
+
+    void addRequest(
+        const char * slotName, const QUuid & requestId,
+        const qint64 queueWaitNsec, const bool awaitingStamp,
+        const qint64 executionNsec);
+
+    void addSlowQuery(
+        const char * slotName, const QSqlQuery & query,
+        const qint64 elapsedNsec);
+
+    static QString requestType(const char * slotName);
+
+    static void addToHistogram(
+        LocalStorageRequestTraceSnapshot::Histogram & histogram,
+        const qint64 nsec);
+
+private:
+    Q_DISABLE_COPY(LocalStorageRequestTracer)
+
+private:
+    QElapsedTimer m_clock;
+    QAtomicInt m_enabled;
+    QAtomicInt m_slowQueryThresholdMsec;
+
+    mutable QMutex m_mutex;
+
+    // Guarded by m_mutex
+    QHash<QUuid, Stamp> m_stamps;
+    QHash<QString, LocalStorageRequestTraceSnapshot::RequestStats>
+        m_requestStats;
+    QList<LocalStorageRequestTraceSnapshot::SlowQuery> m_slowQueries;
+
+    // Accessed only from the thread of LocalStorageManagerAsync
+    QHash<const QObject *, HookedSender> m_hookedSenders;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_LOCAL_STORAGE_LOCAL_STORAGE_REQUEST_TRACER_H
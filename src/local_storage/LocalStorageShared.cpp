@@ -17,7 +17,9 @@
  */
 
 #include "LocalStorageShared.h"
+#include "LocalStorageRequestTracer.h"
 
+#include <QElapsedTimer>
 #include <QMap>
 #include <QVariant>
 
@@ -37,6 +39,32 @@ QString lastExecutedQuery(const QSqlQuery & query)
     return str;
 }
 
+bool execQuery(QSqlQuery & query)
+{
+    if (!LocalStorageRequestTracer::isTracingCurrentThread()) {
+        return query.exec();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    bool res = query.exec();
+    LocalStorageRequestTracer::traceQuery(query, timer.nsecsElapsed());
+    return res;
+}
+
+bool execQuery(QSqlQuery & query, const QString & queryString)
+{
+    if (!LocalStorageRequestTracer::isTracingCurrentThread()) {
+        return query.exec(queryString);
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    bool res = query.exec(queryString);
+    LocalStorageRequestTracer::traceQuery(query, timer.nsecsElapsed());
+    return res;
+}
+
 QString sqlEscapeString(const QString & str)
 {
     QString res = str;
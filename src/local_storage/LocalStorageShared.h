@@ -36,6 +36,14 @@ namespace quentier {
 
 QString lastExecutedQuery(const QSqlQuery & query);
 
+/**
+ * Executes the query, the same as QSqlQuery::exec; if a request to
+ * LocalStorageManagerAsync is being traced in the current thread, the query
+ * is timed and logged if it turns out to be slow
+ */
+bool execQuery(QSqlQuery & query);
+bool execQuery(QSqlQuery & query, const QString & queryString);
+
 QString sqlEscapeString(const QString & str);
 
 } // namespace quentier
@@ -19,6 +19,7 @@
 #include "Transaction.h"
 
 #include "LocalStorageManager_p.h"
+#include "LocalStorageShared.h"
 
 #include <quentier/exception/DatabaseRequestException.h>
 #include <quentier/logging/QuentierLogger.h>
@@ -42,7 +43,7 @@ Transaction::~Transaction()
 {
     if ((m_type != Type::Selection) && !m_committed && !m_rolledBack) {
         QSqlQuery query(m_db);
-        bool res = query.exec(QStringLiteral("ROLLBACK"));
+        bool res = execQuery(query, QStringLiteral("ROLLBACK"));
         if (!res) {
             ErrorString errorMessage(QT_TRANSLATE_NOOP(
                 "Transaction", "Can't rollback the SQL transaction"));
@@ -56,7 +57,7 @@ Transaction::~Transaction()
     }
     else if ((m_type == Type::Selection) && !m_ended) {
         QSqlQuery query(m_db);
-        bool res = query.exec(QStringLiteral("END"));
+        bool res = execQuery(query, QStringLiteral("END"));
         if (!res) {
             ErrorString errorMessage(QT_TRANSLATE_NOOP(
                 "Transaction", "Can't end the SQL transaction"));
@@ -79,7 +80,7 @@ bool Transaction::commit(ErrorString & errorDescription)
     }
 
     QSqlQuery query(m_db);
-    bool res = query.exec(QStringLiteral("COMMIT"));
+    bool res = execQuery(query, QStringLiteral("COMMIT"));
     if (!res) {
         errorDescription.setBase(QT_TRANSLATE_NOOP(
             "Transaction", "Can't commit the SQL transaction"));
@@ -104,7 +105,7 @@ bool Transaction::rollback(ErrorString & errorDescription)
     }
 
     QSqlQuery query(m_db);
-    bool res = query.exec(QStringLiteral("ROLLBACK"));
+    bool res = execQuery(query, QStringLiteral("ROLLBACK"));
     if (!res) {
         errorDescription.setBase(QT_TRANSLATE_NOOP(
             "Transaction", "Can't rollback the SQL transaction"));
@@ -131,7 +132,7 @@ bool Transaction::end(ErrorString & errorDescription)
     }
 
     QSqlQuery query(m_db);
-    bool res = query.exec(QStringLiteral("END"));
+    bool res = execQuery(query, QStringLiteral("END"));
     if (!res) {
         errorDescription.setBase(
             QT_TRANSLATE_NOOP("Transaction", "Can't end the SQL transaction"));
@@ -158,7 +159,7 @@ void Transaction::init()
     }
 
     QSqlQuery query(m_db);
-    bool res = query.exec(queryString);
+    bool res = execQuery(query, queryString);
     if (!res) {
         QNERROR(
             "local_storage",
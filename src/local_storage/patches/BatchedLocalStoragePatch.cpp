@@ -0,0 +1,507 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BatchedLocalStoragePatch.h"
+
+#include "../LocalStorageManager_p.h"
+#include "../LocalStorageShared.h"
+#include "../Transaction.h"
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/types/ErrorString.h>
+#include <quentier/utility/EventLoopWithExitStatus.h>
+#include <quentier/utility/FileCopier.h>
+#include <quentier/utility/FileSystem.h>
+#include <quentier/utility/StandardPaths.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPointer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+
+#define LOCAL_STORAGE_PATCH_DEFAULT_BATCH_SIZE (100)
+
+namespace quentier {
+
+BatchedLocalStoragePatch::BatchedLocalStoragePatch(
+    const Account & account, LocalStorageManagerPrivate & localStorageManager,
+    QSqlDatabase & database, QObject * parent) :
+    ILocalStoragePatch(parent),
+    m_account(account), m_localStorageManager(localStorageManager),
+    m_sqlDatabase(database)
+{}
+
+BatchedLocalStoragePatch::~BatchedLocalStoragePatch() {}
+
+bool BatchedLocalStoragePatch::backupLocalStorage(
+    ErrorString & errorDescription)
+{
+    QNINFO(
+        "local_storage:patches",
+        "BatchedLocalStoragePatch::backupLocalStorage: from version "
+            << fromVersion() << " to version " << toVersion());
+
+    QString storagePath = accountPersistentStoragePath(m_account);
+
+    m_backupDirPath = storagePath +
+        QString::fromUtf8("/backup_upgrade_%1_to_%2_")
+            .arg(fromVersion())
+            .arg(toVersion()) +
+        QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    QDir backupDir(m_backupDirPath);
+    if (!backupDir.exists()) {
+        bool res = backupDir.mkpath(m_backupDirPath);
+        if (!res) {
+            errorDescription.setBase(
+                QT_TR_NOOP("Can't backup local storage: failed to create "
+                           "folder for backup files"));
+
+            errorDescription.details() =
+                QDir::toNativeSeparators(m_backupDirPath);
+
+            QNWARNING("local_storage:patches", errorDescription);
+            return false;
+        }
+    }
+
+    QString backupFilePath = backupDbFilePath();
+    QFileInfo backupFileInfo(backupFilePath);
+    if (backupFileInfo.exists() && !removeFile(backupFilePath)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't backup local storage: failed to remove "
+                       "pre-existing backup file"));
+
+        errorDescription.details() = QDir::toNativeSeparators(backupFilePath);
+        QNWARNING("local_storage:patches", errorDescription);
+        return false;
+    }
+
+    Q_EMIT backupProgress(0.0);
+
+    // VACUUM INTO makes a consistent copy of the database including the
+    // content of not yet checkpointed WAL so there's no need to copy SQLite's
+    // wal and shm files
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.exec(QString::fromUtf8("VACUUM INTO '%1'")
+                              .arg(sqlEscapeString(backupFilePath)));
+
+    if (!res) {
+        // VACUUM INTO is not supported by SQLite versions prior to 3.27,
+        // falling back to copying the checkpointed database file
+        QNINFO(
+            "local_storage:patches",
+            "Failed to backup local storage via VACUUM INTO: "
+                << query.lastError().text()
+                << "; falling back to copying the database file");
+
+        res = query.exec(QStringLiteral("PRAGMA wal_checkpoint(TRUNCATE)"));
+        if (!res) {
+            errorDescription.setBase(
+                QT_TR_NOOP("Can't backup local storage: failed to checkpoint "
+                           "SQLite wal file"));
+
+            errorDescription.details() = query.lastError().text();
+            QNWARNING("local_storage:patches", errorDescription);
+            return false;
+        }
+
+        QString dbFilePath =
+            storagePath + QStringLiteral("/qn.storage.sqlite");
+
+        if (!QFile::copy(dbFilePath, backupFilePath)) {
+            errorDescription.setBase(
+                QT_TR_NOOP("Can't backup local storage: failed to copy "
+                           "the database file"));
+
+            errorDescription.details() = QDir::toNativeSeparators(dbFilePath);
+            QNWARNING("local_storage:patches", errorDescription);
+            return false;
+        }
+    }
+
+    Q_EMIT backupProgress(1.0);
+    return true;
+}
+
+bool BatchedLocalStoragePatch::restoreLocalStorageFromBackup(
+    ErrorString & errorDescription)
+{
+    QNINFO(
+        "local_storage:patches",
+        "BatchedLocalStoragePatch::restoreLocalStorageFromBackup");
+
+    QFileInfo backupFileInfo(backupDbFilePath());
+    if (Q_UNLIKELY(!backupFileInfo.exists())) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't restore the local storage from backup: backup "
+                       "file doesn't exist"));
+
+        errorDescription.details() =
+            QDir::toNativeSeparators(backupFileInfo.absoluteFilePath());
+
+        QNWARNING("local_storage:patches", errorDescription);
+        return false;
+    }
+
+    // The backup is a self-contained database file so the content of the
+    // current WAL must not be applied on top of it once restored
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.exec(QStringLiteral("PRAGMA wal_checkpoint(TRUNCATE)"));
+    if (!res) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't restore the local storage from backup: failed "
+                       "to checkpoint SQLite wal file"));
+
+        errorDescription.details() = query.lastError().text();
+        QNWARNING("local_storage:patches", errorDescription);
+        return false;
+    }
+
+    EventLoopWithExitStatus restoreFromBackupEventLoop;
+
+    auto * pMainDbFileCopierThread = new QThread;
+
+    QObject::connect(
+        pMainDbFileCopierThread, &QThread::finished, pMainDbFileCopierThread,
+        &QThread::deleteLater);
+
+    pMainDbFileCopierThread->start();
+
+    auto * pMainDbFileCopier = new FileCopier;
+    QPointer<FileCopier> pFileCopierQPtr = pMainDbFileCopier;
+
+    QObject::connect(
+        pMainDbFileCopier, &FileCopier::progressUpdate, this,
+        &BatchedLocalStoragePatch::restoreBackupProgress);
+
+    QObject::connect(
+        pMainDbFileCopier, &FileCopier::notifyError,
+        &restoreFromBackupEventLoop,
+        &EventLoopWithExitStatus::exitAsFailureWithErrorString);
+
+    QObject::connect(
+        pMainDbFileCopier, &FileCopier::finished, &restoreFromBackupEventLoop,
+        &EventLoopWithExitStatus::exitAsSuccess);
+
+    QObject::connect(
+        pMainDbFileCopier, &FileCopier::finished, pMainDbFileCopier,
+        &FileCopier::deleteLater);
+
+    QObject::connect(
+        pMainDbFileCopier, &FileCopier::finished, pMainDbFileCopierThread,
+        &QThread::quit);
+
+    QObject::connect(
+        this, &BatchedLocalStoragePatch::copyDbFile, pMainDbFileCopier,
+        &FileCopier::copyFile);
+
+    pMainDbFileCopier->moveToThread(pMainDbFileCopierThread);
+
+    QTimer::singleShot(0, this, SLOT(startLocalStorageRestorationFromBackup()));
+
+    Q_UNUSED(restoreFromBackupEventLoop.exec())
+    auto status = restoreFromBackupEventLoop.exitStatus();
+
+    if (!pFileCopierQPtr.isNull()) {
+        QObject::disconnect(
+            this, &BatchedLocalStoragePatch::copyDbFile, pMainDbFileCopier,
+            &FileCopier::copyFile);
+    }
+
+    if (status == EventLoopWithExitStatus::ExitStatus::Failure) {
+        errorDescription = restoreFromBackupEventLoop.errorDescription();
+        return false;
+    }
+
+    return true;
+}
+
+bool BatchedLocalStoragePatch::removeLocalStorageBackup(
+    ErrorString & errorDescription)
+{
+    QNINFO(
+        "local_storage:patches",
+        "BatchedLocalStoragePatch::removeLocalStorageBackup");
+
+    bool removedDbBackup = true;
+
+    QFileInfo dbBackupFileInfo(backupDbFilePath());
+    if (dbBackupFileInfo.exists() &&
+        !removeFile(dbBackupFileInfo.absoluteFilePath()))
+    {
+        QNWARNING(
+            "local_storage:patches",
+            "Failed to remove the SQLite "
+                << "database's backup: "
+                << dbBackupFileInfo.absoluteFilePath());
+
+        removedDbBackup = false;
+    }
+
+    bool removedBackupDir = true;
+    QDir backupDir(m_backupDirPath);
+    if (!backupDir.rmdir(m_backupDirPath)) {
+        QNWARNING(
+            "local_storage:patches",
+            "Failed to remove the SQLite "
+                << "database's backup folder: " << m_backupDirPath);
+
+        removedBackupDir = false;
+    }
+
+    if (!removedDbBackup || !removedBackupDir) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to remove some of SQLite database's backups"));
+        return false;
+    }
+
+    return true;
+}
+
+bool BatchedLocalStoragePatch::apply(ErrorString & errorDescription)
+{
+    QNINFO(
+        "local_storage:patches",
+        "BatchedLocalStoragePatch::apply: from version "
+            << fromVersion() << " to version " << toVersion());
+
+    errorDescription.clear();
+
+    if (!ensureCheckpointsTableExists(errorDescription)) {
+        return false;
+    }
+
+    qint64 lastProcessedKey = 0;
+    qint64 numProcessedItems = 0;
+    if (!readCheckpoint(lastProcessedKey, numProcessedItems, errorDescription))
+    {
+        return false;
+    }
+
+    if (numProcessedItems > 0) {
+        QNINFO(
+            "local_storage:patches",
+            "Resuming the application of the patch after "
+                << numProcessedItems << " processed items, last processed "
+                << "key = " << lastProcessedKey);
+    }
+
+    qint64 totalItems = itemCount(errorDescription);
+    if (totalItems < 0) {
+        return false;
+    }
+
+    double batchesFraction = batchesProgressFraction();
+    int maxItems = batchSize();
+
+    while (true) {
+        Transaction transaction(
+            m_sqlDatabase, m_localStorageManager, Transaction::Type::Immediate);
+
+        qint64 newLastProcessedKey = lastProcessedKey;
+        int numBatchItems = 0;
+
+        if (!processBatch(
+                lastProcessedKey, maxItems, newLastProcessedKey,
+                numBatchItems, errorDescription))
+        {
+            return false;
+        }
+
+        if (numBatchItems == 0) {
+            if (!transaction.commit(errorDescription)) {
+                return false;
+            }
+
+            break;
+        }
+
+        lastProcessedKey = newLastProcessedKey;
+        numProcessedItems += numBatchItems;
+
+        if (!writeCheckpoint(
+                lastProcessedKey, numProcessedItems, errorDescription))
+        {
+            return false;
+        }
+
+        if (!transaction.commit(errorDescription)) {
+            return false;
+        }
+
+        QNDEBUG(
+            "local_storage:patches",
+            "Processed batch of " << numBatchItems << " items, "
+                << numProcessedItems << " out of " << totalItems
+                << " items processed so far");
+
+        Q_EMIT processedItemsProgress(numProcessedItems, totalItems);
+
+        double batchesProgress = static_cast<double>(numProcessedItems) /
+            std::max(1.0, static_cast<double>(totalItems));
+
+        Q_EMIT progress(batchesFraction * std::min(1.0, batchesProgress));
+    }
+
+    Q_EMIT progress(batchesFraction);
+
+    if (!finalize(errorDescription)) {
+        return false;
+    }
+
+    if (!removeCheckpoint(errorDescription)) {
+        return false;
+    }
+
+    Q_EMIT progress(1.0);
+    return true;
+}
+
+int BatchedLocalStoragePatch::batchSize() const
+{
+    return LOCAL_STORAGE_PATCH_DEFAULT_BATCH_SIZE;
+}
+
+double BatchedLocalStoragePatch::batchesProgressFraction() const
+{
+    return 0.9;
+}
+
+void BatchedLocalStoragePatch::startLocalStorageRestorationFromBackup()
+{
+    QNDEBUG(
+        "local_storage:patches",
+        "BatchedLocalStoragePatch::startLocalStorageRestorationFromBackup");
+
+    QString storagePath = accountPersistentStoragePath(m_account);
+    QString dbFilePath = storagePath + QStringLiteral("/qn.storage.sqlite");
+    Q_EMIT copyDbFile(backupDbFilePath(), dbFilePath);
+}
+
+bool BatchedLocalStoragePatch::ensureCheckpointsTableExists(
+    ErrorString & errorDescription)
+{
+    ErrorString errorPrefix(
+        QT_TR_NOOP("can't create the table for local storage patch "
+                   "checkpoints"));
+
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.exec(QStringLiteral(
+        "CREATE TABLE IF NOT EXISTS AuxiliaryPatchCheckpoints("
+        "  fromVersion       INTEGER     NOT NULL, "
+        "  toVersion         INTEGER     NOT NULL, "
+        "  lastProcessedKey  INTEGER     NOT NULL, "
+        "  processedItems    INTEGER     NOT NULL, "
+        "  PRIMARY KEY(fromVersion, toVersion))"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    return true;
+}
+
+bool BatchedLocalStoragePatch::readCheckpoint(
+    qint64 & lastProcessedKey, qint64 & numProcessedItems,
+    ErrorString & errorDescription)
+{
+    ErrorString errorPrefix(
+        QT_TR_NOOP("can't read the checkpoint of local storage patch"));
+
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.prepare(QStringLiteral(
+        "SELECT lastProcessedKey, processedItems "
+        "FROM AuxiliaryPatchCheckpoints "
+        "WHERE fromVersion = :fromVersion AND toVersion = :toVersion"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    query.bindValue(QStringLiteral(":fromVersion"), fromVersion());
+    query.bindValue(QStringLiteral(":toVersion"), toVersion());
+
+    res = query.exec();
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    if (!query.next()) {
+        lastProcessedKey = 0;
+        numProcessedItems = 0;
+        return true;
+    }
+
+    lastProcessedKey = query.value(0).toLongLong();
+    numProcessedItems = query.value(1).toLongLong();
+    return true;
+}
+
+bool BatchedLocalStoragePatch::writeCheckpoint(
+    const qint64 lastProcessedKey, const qint64 numProcessedItems,
+    ErrorString & errorDescription)
+{
+    ErrorString errorPrefix(
+        QT_TR_NOOP("can't write the checkpoint of local storage patch"));
+
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.prepare(QStringLiteral(
+        "INSERT OR REPLACE INTO AuxiliaryPatchCheckpoints"
+        "(fromVersion, toVersion, lastProcessedKey, processedItems) "
+        "VALUES(:fromVersion, :toVersion, :lastProcessedKey, "
+        ":processedItems)"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    query.bindValue(QStringLiteral(":fromVersion"), fromVersion());
+    query.bindValue(QStringLiteral(":toVersion"), toVersion());
+    query.bindValue(QStringLiteral(":lastProcessedKey"), lastProcessedKey);
+    query.bindValue(QStringLiteral(":processedItems"), numProcessedItems);
+
+    res = query.exec();
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    return true;
+}
+
+bool BatchedLocalStoragePatch::removeCheckpoint(ErrorString & errorDescription)
+{
+    ErrorString errorPrefix(
+        QT_TR_NOOP("can't remove the checkpoint of local storage patch"));
+
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.prepare(QStringLiteral(
+        "DELETE FROM AuxiliaryPatchCheckpoints "
+        "WHERE fromVersion = :fromVersion AND toVersion = :toVersion"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    query.bindValue(QStringLiteral(":fromVersion"), fromVersion());
+    query.bindValue(QStringLiteral(":toVersion"), toVersion());
+
+    res = query.exec();
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    return true;
+}
+
+QString BatchedLocalStoragePatch::backupDbFilePath() const
+{
+    return m_backupDirPath + QStringLiteral("/qn.storage.sqlite");
+}
+
+} // namespace quentier
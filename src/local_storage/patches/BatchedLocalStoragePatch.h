@@ -0,0 +1,149 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_LOCAL_STORAGE_PATCHES_BATCHED_LOCAL_STORAGE_PATCH_H
+#define LIB_QUENTIER_LOCAL_STORAGE_PATCHES_BATCHED_LOCAL_STORAGE_PATCH_H
+
+#include <quentier/local_storage/ILocalStoragePatch.h>
+#include <quentier/types/Account.h>
+
+QT_FORWARD_DECLARE_CLASS(QSqlDatabase)
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageManagerPrivate)
+
+/**
+ * @brief The BatchedLocalStoragePatch class is the base class for local
+ * storage patches which process the items within the local storage database
+ * in batches. Each batch is committed in its own transaction along with
+ * the checkpoint recorded in AuxiliaryPatchCheckpoints table so that
+ * the application of the patch interrupted for whatever reason would resume
+ * from the last committed batch instead of starting over.
+ *
+ * The backup of the local storage is made via VACUUM INTO statement which
+ * creates a consistent copy of the database through the open connection
+ * without copying the database files around.
+ */
+class Q_DECL_HIDDEN BatchedLocalStoragePatch : public ILocalStoragePatch
+{
+    Q_OBJECT
+protected:
+    explicit BatchedLocalStoragePatch(
+        const Account & account,
+        LocalStorageManagerPrivate & localStorageManager,
+        QSqlDatabase & database, QObject * parent = nullptr);
+
+public:
+    virtual ~BatchedLocalStoragePatch() override;
+
+    virtual bool backupLocalStorage(ErrorString & errorDescription) override;
+
+    virtual bool restoreLocalStorageFromBackup(
+        ErrorString & errorDescription) override;
+
+    virtual bool removeLocalStorageBackup(
+        ErrorString & errorDescription) override;
+
+    virtual bool apply(ErrorString & errorDescription) override;
+
+    // private
+Q_SIGNALS:
+    void copyDbFile(QString sourcePath, QString destPath);
+
+private Q_SLOTS:
+    void startLocalStorageRestorationFromBackup();
+
+protected:
+    /**
+     * @return          The total number of items the patch needs to process
+     *                  or negative value in case of error
+     */
+    virtual qint64 itemCount(ErrorString & errorDescription) = 0;
+
+    /**
+     * Process the next batch of items following the one with the passed in
+     * key. Called within a transaction which is committed along with
+     * the updated checkpoint after the method returns successfully.
+     *
+     * @param lastProcessedKey          The key of the last processed item, 0
+     *                                  if no items have been processed yet
+     * @param maxItems                  The max number of items to process
+     * @param newLastProcessedKey       The key of the last item processed
+     *                                  within this batch
+     * @param numProcessedItems         The number of items processed within
+     *                                  this batch; zero means there are no
+     *                                  more items to process
+     * @param errorDescription          The textual description of the error
+     *                                  in case of failure to process the batch
+     * @return                          True in case of success, false otherwise
+     */
+    virtual bool processBatch(
+        const qint64 lastProcessedKey, const int maxItems,
+        qint64 & newLastProcessedKey, int & numProcessedItems,
+        ErrorString & errorDescription) = 0;
+
+    /**
+     * Finish the application of the patch after all the batches have been
+     * processed, i.e. compact the database and update the version of
+     * the local storage
+     */
+    virtual bool finalize(ErrorString & errorDescription) = 0;
+
+    /**
+     * @return          The max number of items processed within a single
+     *                  batch
+     */
+    virtual int batchSize() const;
+
+    /**
+     * @return          Fraction of the patch application progress which
+     *                  the processing of batches accounts for; the rest is
+     *                  left for finalize method
+     */
+    virtual double batchesProgressFraction() const;
+
+private:
+    bool ensureCheckpointsTableExists(ErrorString & errorDescription);
+
+    bool readCheckpoint(
+        qint64 & lastProcessedKey, qint64 & numProcessedItems,
+        ErrorString & errorDescription);
+
+    bool writeCheckpoint(
+        const qint64 lastProcessedKey, const qint64 numProcessedItems,
+        ErrorString & errorDescription);
+
+    bool removeCheckpoint(ErrorString & errorDescription);
+
+    QString backupDbFilePath() const;
+
+private:
+    Q_DISABLE_COPY(BatchedLocalStoragePatch)
+
+protected:
+    Account m_account;
+    LocalStorageManagerPrivate & m_localStorageManager;
+    QSqlDatabase & m_sqlDatabase;
+
+    QString m_backupDirPath;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_LOCAL_STORAGE_PATCHES_BATCHED_LOCAL_STORAGE_PATCH_H
@@ -19,16 +19,12 @@
 #ifndef LIB_QUENTIER_LOCAL_STORAGE_PATCHES_LOCAL_STORAGE_PATCH_1_TO_2_H
 #define LIB_QUENTIER_LOCAL_STORAGE_PATCHES_LOCAL_STORAGE_PATCH_1_TO_2_H
 
-#include <quentier/local_storage/ILocalStoragePatch.h>
-#include <quentier/types/Account.h>
-
-QT_FORWARD_DECLARE_CLASS(QSqlDatabase)
+#include "BatchedLocalStoragePatch.h"
 
 namespace quentier {
 
-QT_FORWARD_DECLARE_CLASS(LocalStorageManagerPrivate)
-
-class Q_DECL_HIDDEN LocalStoragePatch1To2 final : public ILocalStoragePatch
+class Q_DECL_HIDDEN LocalStoragePatch1To2 final :
+    public BatchedLocalStoragePatch
 {
     Q_OBJECT
 public:
@@ -49,44 +45,29 @@ public:
     virtual QString patchShortDescription() const override;
     virtual QString patchLongDescription() const override;
 
-    virtual bool backupLocalStorage(ErrorString & errorDescription) override;
-
-    virtual bool restoreLocalStorageFromBackup(
-        ErrorString & errorDescription) override;
+private:
+    virtual qint64 itemCount(ErrorString & errorDescription) override;
 
-    virtual bool removeLocalStorageBackup(
+    virtual bool processBatch(
+        const qint64 lastProcessedKey, const int maxItems,
+        qint64 & newLastProcessedKey, int & numProcessedItems,
         ErrorString & errorDescription) override;
 
-    virtual bool apply(ErrorString & errorDescription) override;
-
-    // private
-Q_SIGNALS:
-    void copyDbFile(QString sourcePath, QString destPath);
-
-private Q_SLOTS:
-    void startLocalStorageBackup();
-    void startLocalStorageRestorationFromBackup();
-
-private:
-    QStringList listResourceLocalUidsForDatabaseUpgradeFromVersion1ToVersion2(
-        ErrorString & errorDescription);
-
-    void filterResourceLocalUidsForDatabaseUpgradeFromVersion1ToVersion2(
-        QStringList & resourceLocalUids);
+    virtual bool finalize(ErrorString & errorDescription) override;
 
     bool
     ensureExistenceOfResouceDataDirsForDatabaseUpgradeFromVersion1ToVersion2(
         ErrorString & errorDescription);
 
+    bool writeResourceDataBodyToFile(
+        const QString & dirPath, const QString & resourceLocalUid,
+        const QByteArray & dataBody, ErrorString & errorDescription);
+
 private:
     Q_DISABLE_COPY(LocalStoragePatch1To2)
 
 private:
-    Account m_account;
-    LocalStorageManagerPrivate & m_localStorageManager;
-    QSqlDatabase & m_sqlDatabase;
-
-    QString m_backupDirPath;
+    bool m_resourceDataDirsChecked = false;
 };
 
 } // namespace quentier
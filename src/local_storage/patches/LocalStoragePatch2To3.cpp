@@ -0,0 +1,142 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStoragePatch2To3.h"
+
+#include "../LocalStorageManager_p.h"
+#include "../LocalStorageShared.h"
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
+namespace quentier {
+
+LocalStoragePatch2To3::LocalStoragePatch2To3(
+    const Account & account, LocalStorageManagerPrivate & localStorageManager,
+    QSqlDatabase & database, QObject * parent) :
+    BatchedLocalStoragePatch(account, localStorageManager, database, parent)
+{}
+
+QString LocalStoragePatch2To3::patchShortDescription() const
+{
+    return tr("Enable incremental compaction of SQLite database");
+}
+
+QString LocalStoragePatch2To3::patchLongDescription() const
+{
+    QString result;
+
+    result +=
+        tr("This patch will enable incremental auto vacuum for Quentier's "
+           "primary SQLite database. With it the space freed within "
+           "the database file after the removal of data can be reclaimed in "
+           "small steps in background instead of rewriting the entire "
+           "database file at once.");
+
+    result += QStringLiteral("\n\n");
+
+    result +=
+        tr("The patch rewrites the database file once so the time required "
+           "to apply it would depend on the size of the database and on "
+           "the general performance of disk I/O on your system.");
+
+    result += QStringLiteral("\n\n");
+
+    result +=
+        tr("Note that after the upgrade previous versions of Quentier would "
+           "no longer be able to use this account's local storage");
+
+    result += QStringLiteral(".");
+    return result;
+}
+
+qint64 LocalStoragePatch2To3::itemCount(ErrorString & errorDescription)
+{
+    Q_UNUSED(errorDescription)
+    return 0;
+}
+
+bool LocalStoragePatch2To3::processBatch(
+    const qint64 lastProcessedKey, const int maxItems,
+    qint64 & newLastProcessedKey, int & numProcessedItems,
+    ErrorString & errorDescription)
+{
+    Q_UNUSED(maxItems)
+    Q_UNUSED(errorDescription)
+
+    // There are no items to process, the whole job is done in finalize method
+    newLastProcessedKey = lastProcessedKey;
+    numProcessedItems = 0;
+    return true;
+}
+
+bool LocalStoragePatch2To3::finalize(ErrorString & errorDescription)
+{
+    QNDEBUG("local_storage:patches", "LocalStoragePatch2To3::finalize");
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("failed to upgrade local storage "
+                   "from version 2 to version 3"));
+
+    // auto_vacuum setting of the existing database can only be changed by
+    // VACUUM and not while in WAL journal mode
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.exec(QStringLiteral("PRAGMA journal_mode=DELETE"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    res = query.exec(QStringLiteral("PRAGMA auto_vacuum = INCREMENTAL"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    Q_EMIT progress(0.1);
+
+    ErrorString compactionError;
+    if (!m_localStorageManager.compactLocalStorage(compactionError)) {
+        errorDescription = errorPrefix;
+        errorDescription.appendBase(compactionError.base());
+        errorDescription.appendBase(compactionError.additionalBases());
+        errorDescription.details() = compactionError.details();
+        QNWARNING("local_storage:patches", errorDescription);
+        return false;
+    }
+
+    Q_EMIT progress(0.9);
+
+    res = query.exec(QStringLiteral("PRAGMA journal_mode=WAL"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    res = query.exec(
+        QStringLiteral("INSERT OR REPLACE INTO Auxiliary (version) VALUES(3)"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    QNDEBUG(
+        "local_storage:patches",
+        "Finished upgrading the local storage "
+            << "from version 2 to version 3");
+    return true;
+}
+
+double LocalStoragePatch2To3::batchesProgressFraction() const
+{
+    return 0.0;
+}
+
+} // namespace quentier
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStoragePatch3To4.h"
+
+#include "../LocalStorageManager_p.h"
+#include "../LocalStorageShared.h"
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+
+#include <algorithm>
+
+namespace quentier {
+
+LocalStoragePatch3To4::LocalStoragePatch3To4(
+    const Account & account, LocalStorageManagerPrivate & localStorageManager,
+    QSqlDatabase & database, QObject * parent) :
+    BatchedLocalStoragePatch(account, localStorageManager, database, parent)
+{}
+
+QString LocalStoragePatch3To4::patchShortDescription() const
+{
+    return tr("Create indexes speeding up listing and counting of notes");
+}
+
+QString LocalStoragePatch3To4::patchLongDescription() const
+{
+    QString result;
+
+    result +=
+        tr("This patch will create indexes within Quentier's primary SQLite "
+           "database which speed up listing notes sorted by title, creation "
+           "or modification time, counting notes per notebook and per tag and "
+           "looking for changes which need to be sent to Evernote.");
+
+    result += QStringLiteral("\n\n");
+
+    result +=
+        tr("The time required to apply the patch would depend on the number "
+           "of notes in the database and on the general performance of disk "
+           "I/O on your system.");
+
+    result += QStringLiteral("\n\n");
+
+    result +=
+        tr("Note that after the upgrade previous versions of Quentier would "
+           "no longer be able to use this account's local storage");
+
+    result += QStringLiteral(".");
+    return result;
+}
+
+qint64 LocalStoragePatch3To4::itemCount(ErrorString & errorDescription)
+{
+    Q_UNUSED(errorDescription)
+    return m_localStorageManager.listingIndexStatements().size();
+}
+
+bool LocalStoragePatch3To4::processBatch(
+    const qint64 lastProcessedKey, const int maxItems,
+    qint64 & newLastProcessedKey, int & numProcessedItems,
+    ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "local_storage:patches",
+        "LocalStoragePatch3To4::processBatch: last processed key = "
+            << lastProcessedKey << ", max items = " << maxItems);
+
+    numProcessedItems = 0;
+    newLastProcessedKey = lastProcessedKey;
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("failed to upgrade local storage "
+                   "from version 3 to version 4"));
+
+    // The key of the item is the number of index statements executed
+    // before it so the statements are processed in order
+    const QStringList statements =
+        m_localStorageManager.listingIndexStatements();
+
+    const qint64 endKey =
+        std::min<qint64>(lastProcessedKey + maxItems, statements.size());
+
+    QSqlQuery query(m_sqlDatabase);
+    for (qint64 key = lastProcessedKey; key < endKey; ++key) {
+        bool res = query.exec(statements[static_cast<int>(key)]);
+        DATABASE_CHECK_AND_SET_ERROR()
+
+        newLastProcessedKey = key + 1;
+        ++numProcessedItems;
+    }
+
+    return true;
+}
+
+bool LocalStoragePatch3To4::finalize(ErrorString & errorDescription)
+{
+    QNDEBUG("local_storage:patches", "LocalStoragePatch3To4::finalize");
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("failed to upgrade local storage "
+                   "from version 3 to version 4"));
+
+    // Collect the statistics of the new indexes so that the query planner
+    // could choose between them based on the actual data
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.exec(QStringLiteral("ANALYZE"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    res = query.exec(
+        QStringLiteral("INSERT OR REPLACE INTO Auxiliary (version) VALUES(4)"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    QNDEBUG(
+        "local_storage:patches",
+        "Finished upgrading the local storage "
+            << "from version 3 to version 4");
+    return true;
+}
+
+int LocalStoragePatch3To4::batchSize() const
+{
+    // Each index is built by a full scan of its table so a single one
+    // makes a batch
+    return 1;
+}
+
+} // namespace quentier
@@ -0,0 +1,71 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_LOCAL_STORAGE_PATCHES_LOCAL_STORAGE_PATCH_3_TO_4_H
+#define LIB_QUENTIER_LOCAL_STORAGE_PATCHES_LOCAL_STORAGE_PATCH_3_TO_4_H
+
+#include "BatchedLocalStoragePatch.h"
+
+namespace quentier {
+
+/**
+ * @brief The LocalStoragePatch3To4 class creates indexes serving the most
+ * frequent list and count queries against the local storage database and
+ * the scans for dirty objects performed before sending local changes
+ */
+class Q_DECL_HIDDEN LocalStoragePatch3To4 final :
+    public BatchedLocalStoragePatch
+{
+    Q_OBJECT
+public:
+    explicit LocalStoragePatch3To4(
+        const Account & account,
+        LocalStorageManagerPrivate & localStorageManager,
+        QSqlDatabase & database, QObject * parent = nullptr);
+
+    virtual int fromVersion() const override
+    {
+        return 3;
+    }
+    virtual int toVersion() const override
+    {
+        return 4;
+    }
+
+    virtual QString patchShortDescription() const override;
+    virtual QString patchLongDescription() const override;
+
+private:
+    virtual qint64 itemCount(ErrorString & errorDescription) override;
+
+    virtual bool processBatch(
+        const qint64 lastProcessedKey, const int maxItems,
+        qint64 & newLastProcessedKey, int & numProcessedItems,
+        ErrorString & errorDescription) override;
+
+    virtual bool finalize(ErrorString & errorDescription) override;
+
+    virtual int batchSize() const override;
+
+private:
+    Q_DISABLE_COPY(LocalStoragePatch3To4)
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_LOCAL_STORAGE_PATCHES_LOCAL_STORAGE_PATCH_3_TO_4_H
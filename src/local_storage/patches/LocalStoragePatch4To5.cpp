@@ -0,0 +1,237 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStoragePatch4To5.h"
+
+#include "../LocalStorageManager_p.h"
+#include "../LocalStorageShared.h"
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+
+namespace quentier {
+
+LocalStoragePatch4To5::LocalStoragePatch4To5(
+    const Account & account, LocalStorageManagerPrivate & localStorageManager,
+    QSqlDatabase & database, QObject * parent) :
+    BatchedLocalStoragePatch(account, localStorageManager, database, parent)
+{}
+
+QString LocalStoragePatch4To5::patchShortDescription() const
+{
+    return tr("Create counters of notes per notebook and per tag");
+}
+
+QString LocalStoragePatch4To5::patchLongDescription() const
+{
+    QString result;
+
+    result +=
+        tr("This patch will create tables within Quentier's primary SQLite "
+           "database which hold the numbers of notes per notebook and per "
+           "tag so that these numbers don't need to be computed from "
+           "scratch each time they are displayed.");
+
+    result += QStringLiteral("\n\n");
+
+    result +=
+        tr("The time required to apply the patch would depend on the number "
+           "of notes in the database and on the general performance of disk "
+           "I/O on your system.");
+
+    result += QStringLiteral("\n\n");
+
+    result +=
+        tr("Note that after the upgrade previous versions of Quentier would "
+           "no longer be able to use this account's local storage");
+
+    result += QStringLiteral(".");
+    return result;
+}
+
+qint64 LocalStoragePatch4To5::itemCount(ErrorString & errorDescription)
+{
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.exec(QStringLiteral("SELECT COUNT(*) FROM Notes"));
+    if (Q_UNLIKELY(!res || !query.next())) {
+        errorDescription.setBase(
+            QT_TR_NOOP("failed to count the notes which need to be "
+                       "processed as a part of database upgrade"));
+
+        errorDescription.details() = query.lastError().text();
+        QNWARNING("local_storage:patches", errorDescription);
+        return -1;
+    }
+
+    return query.value(0).toLongLong();
+}
+
+bool LocalStoragePatch4To5::processBatch(
+    const qint64 lastProcessedKey, const int maxItems,
+    qint64 & newLastProcessedKey, int & numProcessedItems,
+    ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "local_storage:patches",
+        "LocalStoragePatch4To5::processBatch: last processed key = "
+            << lastProcessedKey << ", max items = " << maxItems);
+
+    numProcessedItems = 0;
+    newLastProcessedKey = lastProcessedKey;
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("failed to upgrade local storage "
+                   "from version 4 to version 5"));
+
+    QSqlQuery query(m_sqlDatabase);
+    bool res = false;
+
+    if (lastProcessedKey == 0) {
+        // The counters are accumulated batch by batch so they need to start
+        // from zero; the triggers are only created once all the notes have
+        // been counted
+        ErrorString countersError;
+        if (!m_localStorageManager.createNoteCounterTables(countersError)) {
+            errorDescription = errorPrefix;
+            errorDescription.appendBase(countersError.base());
+            errorDescription.appendBase(countersError.additionalBases());
+            errorDescription.details() = countersError.details();
+            QNWARNING("local_storage:patches", errorDescription);
+            return false;
+        }
+
+        res = query.exec(QStringLiteral("DELETE FROM NotebookNoteCounts"));
+        DATABASE_CHECK_AND_SET_ERROR()
+
+        res = query.exec(QStringLiteral("DELETE FROM TagNoteCounts"));
+        DATABASE_CHECK_AND_SET_ERROR()
+    }
+
+    res = query.prepare(
+        QStringLiteral("SELECT rowid FROM Notes "
+                       "WHERE rowid > :lastProcessedKey "
+                       "ORDER BY rowid LIMIT :maxItems"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    query.bindValue(QStringLiteral(":lastProcessedKey"), lastProcessedKey);
+    query.bindValue(QStringLiteral(":maxItems"), maxItems);
+
+    res = query.exec();
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    while (query.next()) {
+        newLastProcessedKey = query.value(0).toLongLong();
+        ++numProcessedItems;
+    }
+
+    if (numProcessedItems == 0) {
+        QNDEBUG("local_storage:patches", "No more notes to count");
+        return true;
+    }
+
+    const QString batchCondition =
+        QString::fromUtf8("Notes.rowid > %1 AND Notes.rowid <= %2")
+            .arg(lastProcessedKey)
+            .arg(newLastProcessedKey);
+
+    const QString noteTagsOfBatch = QStringLiteral(
+        "Notes INNER JOIN NoteTags ON NoteTags.localNote = Notes.localUid");
+
+    const QString statements[] = {
+        QString::fromUtf8(
+            "INSERT OR IGNORE INTO NotebookNoteCounts(notebookLocalUid) "
+            "SELECT DISTINCT notebookLocalUid FROM Notes "
+            "WHERE %1 AND notebookLocalUid IS NOT NULL")
+            .arg(batchCondition),
+        QString::fromUtf8(
+            "UPDATE NotebookNoteCounts SET "
+            "activeNoteCount = activeNoteCount + "
+            "(SELECT COUNT(*) FROM Notes WHERE %1 AND "
+            "Notes.notebookLocalUid = NotebookNoteCounts.notebookLocalUid "
+            "AND Notes.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount + "
+            "(SELECT COUNT(*) FROM Notes WHERE %1 AND "
+            "Notes.notebookLocalUid = NotebookNoteCounts.notebookLocalUid "
+            "AND Notes.deletionTimestamp IS NOT NULL) "
+            "WHERE notebookLocalUid IN "
+            "(SELECT notebookLocalUid FROM Notes WHERE %1)")
+            .arg(batchCondition),
+        QString::fromUtf8(
+            "INSERT OR IGNORE INTO TagNoteCounts(tagLocalUid) "
+            "SELECT DISTINCT NoteTags.localTag FROM %2 "
+            "WHERE %1 AND NoteTags.localTag IS NOT NULL")
+            .arg(batchCondition, noteTagsOfBatch),
+        QString::fromUtf8(
+            "UPDATE TagNoteCounts SET "
+            "activeNoteCount = activeNoteCount + "
+            "(SELECT COUNT(*) FROM %2 WHERE %1 AND "
+            "NoteTags.localTag = TagNoteCounts.tagLocalUid "
+            "AND Notes.deletionTimestamp IS NULL), "
+            "deletedNoteCount = deletedNoteCount + "
+            "(SELECT COUNT(*) FROM %2 WHERE %1 AND "
+            "NoteTags.localTag = TagNoteCounts.tagLocalUid "
+            "AND Notes.deletionTimestamp IS NOT NULL) "
+            "WHERE tagLocalUid IN "
+            "(SELECT NoteTags.localTag FROM %2 WHERE %1)")
+            .arg(batchCondition, noteTagsOfBatch)};
+
+    for (const auto & statement: statements) {
+        res = query.exec(statement);
+        DATABASE_CHECK_AND_SET_ERROR()
+    }
+
+    return true;
+}
+
+bool LocalStoragePatch4To5::finalize(ErrorString & errorDescription)
+{
+    QNDEBUG("local_storage:patches", "LocalStoragePatch4To5::finalize");
+
+    ErrorString errorPrefix(
+        QT_TR_NOOP("failed to upgrade local storage "
+                   "from version 4 to version 5"));
+
+    // All the notes have been counted by now so from this point on
+    // the triggers keep the counters up to date
+    ErrorString countersError;
+    if (!m_localStorageManager.createNoteCounters(countersError)) {
+        errorDescription = errorPrefix;
+        errorDescription.appendBase(countersError.base());
+        errorDescription.appendBase(countersError.additionalBases());
+        errorDescription.details() = countersError.details();
+        QNWARNING("local_storage:patches", errorDescription);
+        return false;
+    }
+
+    QSqlQuery query(m_sqlDatabase);
+    bool res = query.exec(
+        QStringLiteral("INSERT OR REPLACE INTO Auxiliary (version) VALUES(5)"));
+    DATABASE_CHECK_AND_SET_ERROR()
+
+    QNDEBUG(
+        "local_storage:patches",
+        "Finished upgrading the local storage "
+            << "from version 4 to version 5");
+    return true;
+}
+
+} // namespace quentier
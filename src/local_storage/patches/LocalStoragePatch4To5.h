@@ -0,0 +1,69 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_LOCAL_STORAGE_PATCHES_LOCAL_STORAGE_PATCH_4_TO_5_H
+#define LIB_QUENTIER_LOCAL_STORAGE_PATCHES_LOCAL_STORAGE_PATCH_4_TO_5_H
+
+#include "BatchedLocalStoragePatch.h"
+
+namespace quentier {
+
+/**
+ * @brief The LocalStoragePatch4To5 class creates tables holding the numbers
+ * of notes per notebook and per tag, fills them from existing notes in
+ * batches ordered by rowid and then sets up triggers keeping them up to date
+ */
+class Q_DECL_HIDDEN LocalStoragePatch4To5 final :
+    public BatchedLocalStoragePatch
+{
+    Q_OBJECT
+public:
+    explicit LocalStoragePatch4To5(
+        const Account & account,
+        LocalStorageManagerPrivate & localStorageManager,
+        QSqlDatabase & database, QObject * parent = nullptr);
+
+    virtual int fromVersion() const override
+    {
+        return 4;
+    }
+    virtual int toVersion() const override
+    {
+        return 5;
+    }
+
+    virtual QString patchShortDescription() const override;
+    virtual QString patchLongDescription() const override;
+
+private:
+    virtual qint64 itemCount(ErrorString & errorDescription) override;
+
+    virtual bool processBatch(
+        const qint64 lastProcessedKey, const int maxItems,
+        qint64 & newLastProcessedKey, int & numProcessedItems,
+        ErrorString & errorDescription) override;
+
+    virtual bool finalize(ErrorString & errorDescription) override;
+
+private:
+    Q_DISABLE_COPY(LocalStoragePatch4To5)
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_LOCAL_STORAGE_PATCHES_LOCAL_STORAGE_PATCH_4_TO_5_H
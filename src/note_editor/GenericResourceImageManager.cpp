@@ -19,6 +19,7 @@
 #include "GenericResourceImageManager.h"
 
 #include <quentier/logging/QuentierLogger.h>
+#include <quentier/note_editor/ResourceThumbnailCache.h>
 #include <quentier/types/Resource.h>
 #include <quentier/utility/FileSystem.h>
 
@@ -102,6 +103,7 @@ void GenericResourceImageManager::onGenericResourceImageWriteRequest(
         nameFilter, QDir::Files | QDir::Readable | QDir::NoDotAndDotDot);
 
     bool resourceHashChanged = true;
+    QByteArray previousResourceHash;
     QFileInfo resourceHashFileInfo(
         storageDir.absolutePath() + QStringLiteral("/") + resourceLocalUid +
         QStringLiteral(".hash"));
@@ -114,7 +116,7 @@ void GenericResourceImageManager::onGenericResourceImageWriteRequest(
         if (resourceHashFileInfo.isReadable()) {
             QFile resourceHashFile(resourceHashFileInfo.absoluteFilePath());
             Q_UNUSED(resourceHashFile.open(QIODevice::ReadOnly));
-            QByteArray previousResourceHash = resourceHashFile.readAll();
+            previousResourceHash = resourceHashFile.readAll();
 
             if (resourceActualHash == previousResourceHash) {
                 QNTRACE("note_editor", "Resource hash hasn't changed");
@@ -176,6 +178,12 @@ void GenericResourceImageManager::onGenericResourceImageWriteRequest(
         return;
     }
 
+    if (resourceHashChanged && !previousResourceHash.isEmpty()) {
+        // The resource no longer has the data with the previous hash so
+        // the thumbnails of that data are no longer needed
+        ResourceThumbnailCache::removeThumbnails(previousResourceHash);
+    }
+
     QNTRACE(
         "note_editor",
         "Writing resource image file and helper files with "
@@ -367,6 +375,8 @@ void GenericResourceImageManager::
                                 << "stored = " << storedHash.toHex()
                                 << ", actual = "
                                 << resource.dataHash().toHex());
+
+                        ResourceThumbnailCache::removeThumbnails(storedHash);
                     }
                 }
                 else {
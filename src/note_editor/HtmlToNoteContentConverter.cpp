@@ -0,0 +1,90 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HtmlToNoteContentConverter.h"
+
+#include <quentier/enml/DecryptedTextManager.h>
+#include <quentier/logging/QuentierLogger.h>
+
+namespace quentier {
+
+HtmlToNoteContentConverter::HtmlToNoteContentConverter(
+    QString noteLocalUid, QString html,
+    QVector<ENMLConverter::SkipHtmlElementRule> skipRules,
+    std::shared_ptr<QAtomicInt> pStopFlag, const QUuid & requestId,
+    QObject * parent) :
+    QObject(parent),
+    m_noteLocalUid(std::move(noteLocalUid)), m_html(std::move(html)),
+    m_skipRules(std::move(skipRules)), m_pStopFlag(std::move(pStopFlag)),
+    m_requestId(requestId)
+{}
+
+void HtmlToNoteContentConverter::run()
+{
+    QNDEBUG(
+        "note_editor",
+        "HtmlToNoteContentConverter::run: request id = "
+            << m_requestId << ", note local uid = " << m_noteLocalUid);
+
+    if (isCancelled()) {
+        QNDEBUG(
+            "note_editor",
+            "Conversion to ENML was cancelled before it started");
+        Q_EMIT finished(
+            m_requestId, m_noteLocalUid, /* cancelled = */ true, QString(),
+            ErrorString());
+        return;
+    }
+
+    // HTML passed to the converter has no decrypted fragments so the empty
+    // decrypted text manager is sufficient for the conversion
+    ENMLConverter converter;
+    DecryptedTextManager decryptedTextManager;
+
+    QString noteContent;
+    ErrorString errorDescription;
+    bool res = converter.htmlToNoteContent(
+        m_html, noteContent, decryptedTextManager, errorDescription,
+        m_skipRules);
+
+    if (isCancelled()) {
+        QNDEBUG(
+            "note_editor",
+            "Conversion to ENML was cancelled while in progress");
+        Q_EMIT finished(
+            m_requestId, m_noteLocalUid, /* cancelled = */ true, QString(),
+            ErrorString());
+        return;
+    }
+
+    if (!res && errorDescription.isEmpty()) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't convert note editor page's content to ENML"));
+    }
+
+    Q_EMIT finished(
+        m_requestId, m_noteLocalUid, /* cancelled = */ false,
+        (res ? noteContent : QString()), errorDescription);
+}
+
+bool HtmlToNoteContentConverter::isCancelled() const
+{
+    return m_pStopFlag && (m_pStopFlag->loadAcquire() != 0);
+}
+
+} // namespace quentier
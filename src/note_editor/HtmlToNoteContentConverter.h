@@ -0,0 +1,77 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_NOTE_EDITOR_HTML_TO_NOTE_CONTENT_CONVERTER_H
+#define LIB_QUENTIER_NOTE_EDITOR_HTML_TO_NOTE_CONTENT_CONVERTER_H
+
+#include <quentier/enml/ENMLConverter.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QRunnable>
+#include <QUuid>
+#include <QVector>
+
+#include <memory>
+
+namespace quentier {
+
+/**
+ * @brief The HtmlToNoteContentConverter class converts the HTML of note editor
+ * page to ENML on a thread pool's thread.
+ *
+ * The conversion can be cancelled via the stop flag: if it is set by the time
+ * the runnable starts or finishes the conversion, the empty result is
+ * reported. Only HTML without decrypted text fragments is meant to be
+ * converted by HtmlToNoteContentConverter as the conversion of such fragments
+ * modifies the decrypted text manager owned by the note editor.
+ */
+class Q_DECL_HIDDEN HtmlToNoteContentConverter final :
+    public QObject,
+    public QRunnable
+{
+    Q_OBJECT
+public:
+    HtmlToNoteContentConverter(
+        QString noteLocalUid, QString html,
+        QVector<ENMLConverter::SkipHtmlElementRule> skipRules,
+        std::shared_ptr<QAtomicInt> pStopFlag, const QUuid & requestId,
+        QObject * parent = nullptr);
+
+    virtual void run() override;
+
+Q_SIGNALS:
+    void finished(
+        QUuid requestId, QString noteLocalUid, bool cancelled,
+        QString noteContent, ErrorString errorDescription);
+
+private:
+    bool isCancelled() const;
+
+private:
+    QString m_noteLocalUid;
+    QString m_html;
+    QVector<ENMLConverter::SkipHtmlElementRule> m_skipRules;
+    std::shared_ptr<QAtomicInt> m_pStopFlag;
+    QUuid m_requestId;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_NOTE_EDITOR_HTML_TO_NOTE_CONTENT_CONVERTER_H
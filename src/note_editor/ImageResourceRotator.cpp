@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ImageResourceRotator.h"
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/note_editor/ResourceThumbnailCache.h>
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QImage>
+#include <QTransform>
+
+namespace quentier {
+
+ImageResourceRotator::ImageResourceRotator(
+    QByteArray imageData, QByteArray imageDataHash,
+    const INoteEditorBackend::Rotation rotationDirection,
+    std::shared_ptr<QAtomicInt> pStopFlag, const QUuid & requestId,
+    QObject * parent) :
+    QObject(parent),
+    m_imageData(std::move(imageData)),
+    m_imageDataHash(std::move(imageDataHash)),
+    m_rotationDirection(rotationDirection),
+    m_pStopFlag(std::move(pStopFlag)), m_requestId(requestId)
+{}
+
+void ImageResourceRotator::run()
+{
+    QNDEBUG(
+        "note_editor",
+        "ImageResourceRotator::run: request id = "
+            << m_requestId << ", rotation direction = "
+            << m_rotationDirection);
+
+    if (isCancelled()) {
+        finishCancelled();
+        return;
+    }
+
+    QImage image;
+    if (Q_UNLIKELY(!image.loadFromData(m_imageData))) {
+        finishWithError(ErrorString(
+            QT_TR_NOOP("Can't load the resource data as an image")));
+        return;
+    }
+
+    // The original data is no longer needed, release the memory early as it
+    // may be large
+    m_imageData.clear();
+
+    const QSize imageSizeBefore = image.size();
+    Q_EMIT progress(m_requestId, 0.4);
+
+    if (isCancelled()) {
+        finishCancelled();
+        return;
+    }
+
+    QTransform transform;
+    transform.rotate(
+        (m_rotationDirection == INoteEditorBackend::Rotation::Clockwise)
+            ? 90.0
+            : -90.0);
+
+    image = image.transformed(transform, Qt::SmoothTransformation);
+
+    // Rotation by 90 degrees is supposed to just swap the width and
+    // the height; rescale only if it somehow didn't
+    const QSize expectedSize = imageSizeBefore.transposed();
+    if (Q_UNLIKELY(image.size() != expectedSize)) {
+        image = image.scaled(
+            expectedSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    Q_EMIT progress(m_requestId, 0.6);
+
+    if (isCancelled()) {
+        finishCancelled();
+        return;
+    }
+
+    QByteArray rotatedImageData;
+    QBuffer rotatedImageDataBuffer(&rotatedImageData);
+    Q_UNUSED(rotatedImageDataBuffer.open(QIODevice::WriteOnly))
+
+    if (Q_UNLIKELY(!image.save(&rotatedImageDataBuffer, "PNG"))) {
+        finishWithError(ErrorString(
+            QT_TR_NOOP("Can't encode the rotated image as PNG")));
+        return;
+    }
+
+    QByteArray rotatedImageDataHash =
+        QCryptographicHash::hash(rotatedImageData, QCryptographicHash::Md5);
+
+    cacheThumbnails(image, rotatedImageDataHash);
+
+    Q_EMIT progress(m_requestId, 1.0);
+
+    QNDEBUG(
+        "note_editor",
+        "Finished rotating image resource: request id = "
+            << m_requestId << ", rotated image data hash = "
+            << rotatedImageDataHash.toHex());
+
+    Q_EMIT finished(
+        m_requestId, /* cancelled = */ false, rotatedImageData,
+        rotatedImageDataHash, imageSizeBefore, image.size(), ErrorString());
+}
+
+bool ImageResourceRotator::isCancelled() const
+{
+    return m_pStopFlag && (m_pStopFlag->loadAcquire() != 0);
+}
+
+void ImageResourceRotator::cacheThumbnails(
+    const QImage & rotatedImage, const QByteArray & rotatedImageDataHash)
+{
+    if (m_imageDataHash.isEmpty()) {
+        return;
+    }
+
+    const auto sizes =
+        ResourceThumbnailCache::cachedThumbnailSizes(m_imageDataHash);
+
+    for (const auto & size: sizes) {
+        ResourceThumbnailCache::insertThumbnail(
+            rotatedImageDataHash, rotatedImage, size);
+    }
+
+    QNTRACE(
+        "note_editor",
+        "Cached " << sizes.size() << " thumbnails of the rotated image: "
+                  << "request id = " << m_requestId);
+}
+
+void ImageResourceRotator::finishWithError(ErrorString errorDescription)
+{
+    QNWARNING(
+        "note_editor",
+        "Failed to rotate image resource: " << errorDescription
+                                            << ", request id = "
+                                            << m_requestId);
+
+    Q_EMIT finished(
+        m_requestId, /* cancelled = */ false, QByteArray(), QByteArray(),
+        QSize(), QSize(), errorDescription);
+}
+
+void ImageResourceRotator::finishCancelled()
+{
+    QNDEBUG(
+        "note_editor",
+        "Image resource rotation was cancelled: request id = "
+            << m_requestId);
+
+    Q_EMIT finished(
+        m_requestId, /* cancelled = */ true, QByteArray(), QByteArray(),
+        QSize(), QSize(), ErrorString());
+}
+
+} // namespace quentier
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_NOTE_EDITOR_IMAGE_RESOURCE_ROTATOR_H
+#define LIB_QUENTIER_NOTE_EDITOR_IMAGE_RESOURCE_ROTATOR_H
+
+#include <quentier/note_editor/INoteEditorBackend.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QImage>
+#include <QObject>
+#include <QRunnable>
+#include <QSize>
+#include <QUuid>
+
+#include <memory>
+
+namespace quentier {
+
+/**
+ * @brief The ImageResourceRotator class decodes the image resource's data,
+ * rotates the image by 90 degrees and encodes the result as PNG on a thread
+ * pool's thread.
+ *
+ * The progress of the rotation is reported after each of these steps.
+ * The rotation can be cancelled via the stop flag which is checked between
+ * the steps; the empty result is reported in this case.
+ *
+ * If ResourceThumbnailCache holds thumbnails of the original image, thumbnails
+ * of the same sizes are put into the cache for the rotated image as well: it
+ * is already decoded at this point so this is much cheaper than decoding
+ * the rotated image again later.
+ */
+class Q_DECL_HIDDEN ImageResourceRotator final :
+    public QObject,
+    public QRunnable
+{
+    Q_OBJECT
+public:
+    ImageResourceRotator(
+        QByteArray imageData, QByteArray imageDataHash,
+        const INoteEditorBackend::Rotation rotationDirection,
+        std::shared_ptr<QAtomicInt> pStopFlag, const QUuid & requestId,
+        QObject * parent = nullptr);
+
+    virtual void run() override;
+
+Q_SIGNALS:
+    void progress(QUuid requestId, double progress);
+
+    void finished(
+        QUuid requestId, bool cancelled, QByteArray rotatedImageData,
+        QByteArray rotatedImageDataHash, QSize imageSizeBefore,
+        QSize imageSizeAfter, ErrorString errorDescription);
+
+private:
+    bool isCancelled() const;
+
+    void cacheThumbnails(
+        const QImage & rotatedImage, const QByteArray & rotatedImageDataHash);
+
+    void finishWithError(ErrorString errorDescription);
+    void finishCancelled();
+
+private:
+    QByteArray m_imageData;
+    QByteArray m_imageDataHash;
+    INoteEditorBackend::Rotation m_rotationDirection;
+    std::shared_ptr<QAtomicInt> m_pStopFlag;
+    QUuid m_requestId;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_NOTE_EDITOR_IMAGE_RESOURCE_ROTATOR_H
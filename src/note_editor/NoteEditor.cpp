@@ -107,6 +107,18 @@ void NoteEditor::setCurrentNoteLocalUid(const QString & noteLocalUid)
     m_backend->setCurrentNoteLocalUid(noteLocalUid);
 }
 
+void NoteEditor::prerenderNotes(const QList<Note> & notes)
+{
+    // Prerendering is not a part of INoteEditorBackend interface so that
+    // custom backends don't need to implement it
+    auto * pNoteEditorPrivate =
+        qobject_cast<NoteEditorPrivate *>(m_backend->widget());
+
+    if (pNoteEditorPrivate) {
+        pNoteEditorPrivate->prerenderNotes(notes);
+    }
+}
+
 void NoteEditor::clear()
 {
     m_backend->clear();
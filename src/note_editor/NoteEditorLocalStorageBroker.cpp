@@ -1282,27 +1282,30 @@ void NoteEditorLocalStorageBroker::saveNoteToLocalStorageImpl(
                                   << "\nUpdated note version: "
                                   << updatedNoteVersion);
 
-    auto previousNoteResources = previousNoteVersion.resources();
-
     QList<Resource> newResources;
     QList<Resource> updatedResources;
 
-    auto resources = updatedNoteVersion.resources();
-    for (const auto & resource: qAsConst(resources)) {
-        if (!resource.hasDataBody()) {
+    const int numResources = updatedNoteVersion.numResources();
+    for (int i = 0; i < numResources; ++i) {
+        const auto & qecResource = updatedNoteVersion.qevercloudResourceAt(i);
+        if (!qecResource.data.isSet() || !qecResource.data->body.isSet()) {
             continue;
         }
 
+        const Resource resource = updatedNoteVersion.resourceAt(i);
         const QString resourceLocalUid = resource.localUid();
-        bool foundResourceInPreviousNoteVersion = false;
-        bool resourceDataSizeOrHashChanged = false;
 
-        for (const auto & prevResource: qAsConst(previousNoteResources)) {
-            if (prevResource.localUid() != resourceLocalUid) {
-                continue;
-            }
+        const int previousResourceIndex =
+            previousNoteVersion.resourceIndexByLocalUid(resourceLocalUid);
 
-            foundResourceInPreviousNoteVersion = true;
+        const bool foundResourceInPreviousNoteVersion =
+            (previousResourceIndex >= 0);
+
+        bool resourceDataSizeOrHashChanged = false;
+
+        if (foundResourceInPreviousNoteVersion) {
+            const Resource prevResource =
+                previousNoteVersion.resourceAt(previousResourceIndex);
 
             bool dataSizeEqual = true;
             if ((prevResource.hasDataSize() != resource.hasDataSize()) ||
@@ -1350,8 +1353,6 @@ void NoteEditorLocalStorageBroker::saveNoteToLocalStorageImpl(
             {
                 resourceDataSizeOrHashChanged = true;
             }
-
-            break;
         }
 
         if (foundResourceInPreviousNoteVersion) {
@@ -1382,19 +1383,14 @@ void NoteEditorLocalStorageBroker::saveNoteToLocalStorageImpl(
     }
 
     QStringList expungedResourcesLocalUids;
-    for (const auto & previousNoteResource: qAsConst(previousNoteResources)) {
+    const int numPreviousNoteResources = previousNoteVersion.numResources();
+    for (int i = 0; i < numPreviousNoteResources; ++i) {
         const QString previousNoteResourceLocalUid =
-            previousNoteResource.localUid();
-
-        bool foundResource = false;
-        for (const auto & resource: qAsConst(resources)) {
-            if (previousNoteResourceLocalUid == resource.localUid()) {
-                foundResource = true;
-                break;
-            }
-        }
+            previousNoteVersion.resourceLocalUidAt(i);
 
-        if (!foundResource) {
+        if (updatedNoteVersion.resourceIndexByLocalUid(
+                previousNoteResourceLocalUid) < 0)
+        {
             QNTRACE(
                 "note_editor",
                 "Resource with local uid "
@@ -19,7 +19,9 @@
 #include "NoteEditor_p.h"
 
 #include "GenericResourceImageManager.h"
+#include "HtmlToNoteContentConverter.h"
 #include "NoteEditorLocalStorageBroker.h"
+#include "NoteHtmlRenderer.h"
 #include "NoteEditorPrivateMacros.h"
 #include "NoteEditorSettingsNames.h"
 #include "ResourceDataInTemporaryFileStorageManager.h"
@@ -68,6 +70,7 @@
 #include "undo_stack/TableActionUndoCommand.h"
 #include "undo_stack/ToDoCheckboxAutomaticInsertionUndoCommand.h"
 #include "undo_stack/ToDoCheckboxUndoCommand.h"
+#include "undo_stack/UndoStackDataStorage.h"
 
 #include <quentier/local_storage/LocalStorageManager.h>
 #include <quentier/note_editor/SpellChecker.h>
@@ -145,13 +148,38 @@ typedef QWebEngineSettings WebSettings;
 #include <QMenu>
 #include <QMimeDatabase>
 #include <QPixmap>
+#include <QRegularExpression>
 #include <QThread>
+#include <QThreadPool>
 #include <QTimer>
 #include <QTransform>
 
 #include <algorithm>
 #include <cmath>
 
+#define NOTE_EDITOR_RENDERED_NOTE_HTML_CACHE_SIZE (20)
+
+#define NOTE_EDITOR_RENDERED_NOTE_HTML_CACHE_DIR                               \
+    QStringLiteral("NoteEditorRenderedHtml")
+
+// Bounds of the disk cache of rendered note HTML
+#define NOTE_EDITOR_RENDERED_NOTE_HTML_DISK_CACHE_MAX_SIZE (64 * 1024 * 1024)
+#define NOTE_EDITOR_RENDERED_NOTE_HTML_DISK_CACHE_MAX_AGE_SEC                  \
+    (30 * 24 * 60 * 60)
+
+// The disk cache is pruned once per this number of started renderings
+#define NOTE_EDITOR_RENDERED_NOTE_HTML_DISK_CACHE_PRUNING_PERIOD (50)
+
+// Limits the memory consumed by resource data referenced by undo commands,
+// the excess is moved to temporary files
+#define NOTE_EDITOR_UNDO_STACK_MEMORY_LIMIT (64 * 1024 * 1024)
+
+// Limits the size of resource data referenced by undo commands which was moved
+// to temporary files; once it is exceeded, the undo stack is cleared
+#define NOTE_EDITOR_UNDO_STACK_FILE_LIMIT (512 * 1024 * 1024)
+
+#define NOTE_EDITOR_UNDO_STACK_DATA_DIR QStringLiteral("NoteEditorUndoData")
+
 #define NOTE_EDITOR_PAGE_HEADER                                                \
     QStringLiteral(                                                            \
         "<!DOCTYPE HTML PUBLIC \"-//W3C//DTD HTML 4.01//EN\" "                 \
@@ -232,6 +260,12 @@ NoteEditorPrivate::NoteEditorPrivate(NoteEditor & noteEditor) :
     m_encryptionManager(new EncryptionManager),
     m_decryptedTextManager(new DecryptedTextManager),
     m_pFileIOProcessorAsync(new FileIOProcessorAsync),
+    m_renderedNoteHtmlCache(NOTE_EDITOR_RENDERED_NOTE_HTML_CACHE_SIZE),
+    m_pUndoStackDataStorage(std::make_shared<UndoStackDataStorage>(
+        applicationTemporaryStoragePath() + QStringLiteral("/") +
+            NOTE_EDITOR_UNDO_STACK_DATA_DIR + QStringLiteral("/") +
+            UidGenerator::Generate(),
+        NOTE_EDITOR_UNDO_STACK_MEMORY_LIMIT)),
     m_pResourceInfoJavaScriptHandler(
         new ResourceInfoJavaScriptHandler(m_resourceInfo, this)),
 #ifdef QUENTIER_USE_QT_WEB_ENGINE
@@ -619,16 +653,8 @@ void NoteEditorPrivate::onResourceFileChanged(
         return;
     }
 
-    QList<Resource> resources = m_pNote->resources();
-    const int numResources = resources.size();
-    int targetResourceIndex = -1;
-    for (int i = 0; i < numResources; ++i) {
-        const Resource & resource = qAsConst(resources)[i];
-        if (resource.localUid() == resourceLocalUid) {
-            targetResourceIndex = i;
-            break;
-        }
-    }
+    const int targetResourceIndex =
+        m_pNote->resourceIndexByLocalUid(resourceLocalUid);
 
     if (Q_UNLIKELY(targetResourceIndex < 0)) {
         QNDEBUG(
@@ -638,7 +664,7 @@ void NoteEditorPrivate::onResourceFileChanged(
         return;
     }
 
-    Resource resource = qAsConst(resources)[targetResourceIndex];
+    Resource resource = m_pNote->resourceAt(targetResourceIndex);
 
     QByteArray previousResourceHash =
         (resource.hasDataHash() ? resource.dataHash() : QByteArray());
@@ -1054,8 +1080,7 @@ void NoteEditorPrivate::onOpenResourceRequest(const QByteArray & resourceHash)
 
     CHECK_NOTE_EDITABLE(QT_TR_NOOP("Can't open attachment"))
 
-    QList<Resource> resources = m_pNote->resources();
-    int resourceIndex = resourceIndexByHash(resources, resourceHash);
+    const int resourceIndex = m_pNote->resourceIndexByDataHash(resourceHash);
     if (Q_UNLIKELY(resourceIndex < 0)) {
         ErrorString error(
             QT_TR_NOOP("The resource to be opened was not found "
@@ -1065,8 +1090,8 @@ void NoteEditorPrivate::onOpenResourceRequest(const QByteArray & resourceHash)
         return;
     }
 
-    const Resource & resource = resources[resourceIndex];
-    const QString resourceLocalUid = resource.localUid();
+    const QString resourceLocalUid =
+        m_pNote->resourceLocalUidAt(resourceIndex);
 
     auto it = std::find_if(
         m_prepareResourceForOpeningProgressDialogs.begin(),
@@ -1113,8 +1138,7 @@ void NoteEditorPrivate::onSaveResourceRequest(const QByteArray & resourceHash)
         return;
     }
 
-    QList<Resource> resources = m_pNote->resources();
-    int resourceIndex = resourceIndexByHash(resources, resourceHash);
+    const int resourceIndex = m_pNote->resourceIndexByDataHash(resourceHash);
     if (Q_UNLIKELY(resourceIndex < 0)) {
         ErrorString error(
             QT_TR_NOOP("The resource to be saved was not found "
@@ -1125,7 +1149,7 @@ void NoteEditorPrivate::onSaveResourceRequest(const QByteArray & resourceHash)
         return;
     }
 
-    const Resource & resource = qAsConst(resources)[resourceIndex];
+    const Resource resource = m_pNote->resourceAt(resourceIndex);
 
     if (!resource.hasDataBody() && !resource.hasAlternateDataBody()) {
         QNTRACE(
@@ -2018,6 +2042,19 @@ void NoteEditorPrivate::onImageResourceRotationDelegateError(ErrorString error)
     }
 }
 
+void NoteEditorPrivate::onImageResourceRotationDelegateCancelled()
+{
+    QNDEBUG(
+        "note_editor",
+        "NoteEditorPrivate"
+            << "::onImageResourceRotationDelegateCancelled");
+
+    auto * delegate = qobject_cast<ImageResourceRotationDelegate *>(sender());
+    if (Q_LIKELY(delegate)) {
+        delegate->deleteLater();
+    }
+}
+
 void NoteEditorPrivate::onHideDecryptedTextFinished(
     const QVariant & data,
     const QVector<std::pair<QString, QString>> & extraData)
@@ -2832,6 +2869,31 @@ void NoteEditorPrivate::onUndoCommandError(ErrorString error)
     Q_EMIT notifyError(error);
 }
 
+void NoteEditorPrivate::onUndoStackIndexChanged(int index)
+{
+    Q_UNUSED(index)
+
+    if (Q_UNLIKELY(!m_pUndoStack)) {
+        return;
+    }
+
+    const qint64 fileUsage = m_pUndoStackDataStorage->fileUsage();
+    if (fileUsage <= NOTE_EDITOR_UNDO_STACK_FILE_LIMIT) {
+        return;
+    }
+
+    // QUndoStack's undo limit drops the oldest commands on its own but it
+    // can only be set while the stack is empty and it counts commands rather
+    // than bytes so the stack is cleared instead; that releases all the data
+    // referenced by its commands
+    QNINFO(
+        "note_editor:undo",
+        "Undo stack data moved to files exceeds the limit, clearing "
+            << "the undo stack: file usage = " << fileUsage);
+
+    m_pUndoStack->clear();
+}
+
 void NoteEditorPrivate::onSpellCheckerDictionaryEnabledOrDisabled(bool checked)
 {
     QNDEBUG(
@@ -2880,7 +2942,6 @@ void NoteEditorPrivate::onSpellCheckerDictionaryEnabledOrDisabled(bool checked)
     }
 
     refreshMisSpelledWordsList();
-    applySpellCheck();
 }
 
 #ifdef QUENTIER_USE_QT_WEB_ENGINE
@@ -2916,6 +2977,7 @@ void NoteEditorPrivate::clearCurrentNoteInfo()
     m_resourceFileStoragePathsByResourceLocalUid.clear();
     m_genericResourceImageFilePathsByResourceHash.clear();
     m_saveGenericResourceImageToFileRequestIds.clear();
+    m_renderNoteHtmlRequestId = QUuid();
     m_recognitionIndicesByResourceHash.clear();
     m_decryptedTextManager->clearNonRememberedForSessionEntries();
 
@@ -2930,6 +2992,7 @@ void NoteEditorPrivate::clearCurrentNoteInfo()
 
     m_pendingConversionToNote = false;
     m_pendingConversionToNoteForSavingInLocalStorage = false;
+    cancelHtmlToNoteContentConversion();
 
     m_pendingNoteSavingInLocalStorage = false;
     m_shouldRepeatSavingNoteInLocalStorage = false;
@@ -3118,15 +3181,8 @@ void NoteEditorPrivate::onFoundResourceData(Resource resource)
             return;
         }
 
-        auto resources = m_pNote->resources();
-        int resourceIndex = -1;
-        for (int i = 0, size = resources.size(); i < size; ++i) {
-            const Resource & currentResource = qAsConst(resources)[i];
-            if (currentResource.localUid() == resourceLocalUid) {
-                resourceIndex = i;
-                break;
-            }
-        }
+        const int resourceIndex =
+            m_pNote->resourceIndexByLocalUid(resourceLocalUid);
 
         if (Q_UNLIKELY(resourceIndex < 0)) {
             ErrorString errorDescription(
@@ -3142,8 +3198,7 @@ void NoteEditorPrivate::onFoundResourceData(Resource resource)
         }
 
         QNTRACE("note_editor", "Updating the resource within the note");
-        resources[resourceIndex] = resource;
-        m_pNote->setResources(resources);
+        Q_UNUSED(m_pNote->updateResource(resource))
         Q_EMIT currentNoteChanged(*m_pNote);
 
         manualSaveResourceToFile(resource);
@@ -3179,15 +3234,8 @@ void NoteEditorPrivate::onFoundResourceData(Resource resource)
             return;
         }
 
-        auto resources = m_pNote->resources();
-        int resourceIndex = -1;
-        for (int i = 0, size = resources.size(); i < size; ++i) {
-            const auto & currentResource = qAsConst(resources)[i];
-            if (currentResource.localUid() == resourceLocalUid) {
-                resourceIndex = i;
-                break;
-            }
-        }
+        const int resourceIndex =
+            m_pNote->resourceIndexByLocalUid(resourceLocalUid);
 
         if (Q_UNLIKELY(resourceIndex < 0)) {
             ErrorString errorDescription(
@@ -3201,8 +3249,7 @@ void NoteEditorPrivate::onFoundResourceData(Resource resource)
             return;
         }
 
-        resources[resourceIndex] = resource;
-        m_pNote->setResources(resources);
+        Q_UNUSED(m_pNote->updateResource(resource))
 
         QByteArray dataHash =
             (resource.hasDataHash()
@@ -3850,6 +3897,9 @@ void NoteEditorPrivate::onNotebookUpdated(Notebook notebook)
 
 void NoteEditorPrivate::onNoteDeleted(QString noteLocalUid)
 {
+    // The note was expunged so its rendered HTML would never be used again
+    removeRenderedNoteHtmlFromCaches(noteLocalUid);
+
     if (m_noteLocalUid != noteLocalUid) {
         return;
     }
@@ -4512,13 +4562,44 @@ void NoteEditorPrivate::noteToEditorContent()
         noteContent = QStringLiteral("<en-note><div></div></en-note>");
     }
 
-    m_htmlCachedMemory.resize(0);
+    QByteArray decryptedState = decryptedTextState(noteContent);
+
+    QString cacheKey = NoteHtmlRenderer::cacheKey(
+        m_pNote->localUid(), noteContent, decryptedState);
+
+    const auto * pCachedHtml = m_renderedNoteHtmlCache.get(cacheKey);
+    if (pCachedHtml) {
+        QNDEBUG(
+            "note_editor",
+            "Found rendered note HTML in the cache: " << cacheKey);
+        m_renderNoteHtmlRequestId = QUuid();
+        applyRenderedNoteHtml(*pCachedHtml);
+        return;
+    }
+
+    if (decryptedState.isEmpty()) {
+        m_renderNoteHtmlRequestId = QUuid::createUuid();
 
+        QNDEBUG(
+            "note_editor",
+            "Starting to render note HTML in background: request id = "
+                << m_renderNoteHtmlRequestId << ", cache key = " << cacheKey);
+
+        startNoteHtmlRenderer(
+            m_pNote->localUid(), noteContent, cacheKey,
+            m_renderNoteHtmlRequestId);
+        return;
+    }
+
+    // Decrypted text fragments must not leave the GUI thread, rendering
+    // the note right here
+    m_renderNoteHtmlRequestId = QUuid();
+
+    RenderedNoteHtml renderedHtml;
     ErrorString error;
-    ENMLConverter::NoteContentToHtmlExtraData extraData;
     bool res = m_enmlConverter.noteContentToHtml(
-        noteContent, m_htmlCachedMemory, error, *m_decryptedTextManager,
-        extraData);
+        noteContent, renderedHtml.m_html, error, *m_decryptedTextManager,
+        renderedHtml.m_extraData);
 
     if (!res) {
         ErrorString error(QT_TR_NOOP("Can't convert note's content to HTML"));
@@ -4529,6 +4610,18 @@ void NoteEditorPrivate::noteToEditorContent()
         return;
     }
 
+    m_renderedNoteHtmlCache.put(cacheKey, renderedHtml);
+    applyRenderedNoteHtml(renderedHtml);
+}
+
+void NoteEditorPrivate::applyRenderedNoteHtml(
+    const RenderedNoteHtml & renderedHtml)
+{
+    QNDEBUG("note_editor", "NoteEditorPrivate::applyRenderedNoteHtml");
+
+    m_htmlCachedMemory = renderedHtml.m_html;
+
+    const auto & extraData = renderedHtml.m_extraData;
     m_lastFreeEnToDoIdNumber = extraData.m_numEnToDoNodes + 1;
     m_lastFreeHyperlinkIdNumber = extraData.m_numHyperlinkNodes + 1;
     m_lastFreeEnCryptIdNumber = extraData.m_numEnCryptNodes + 1;
@@ -4554,7 +4647,7 @@ void NoteEditorPrivate::noteToEditorContent()
     int bodyClosingTagIndex =
         m_htmlCachedMemory.indexOf(QStringLiteral("</body>"));
     if (bodyClosingTagIndex < 0) {
-        error.setBase(
+        ErrorString error(
             QT_TR_NOOP("Can't find </body> tag in the result of note "
                        "to HTML conversion"));
         QNWARNING(
@@ -4577,6 +4670,151 @@ void NoteEditorPrivate::noteToEditorContent()
     writeNotePageFile(m_htmlCachedMemory);
 }
 
+void NoteEditorPrivate::startNoteHtmlRenderer(
+    const QString & noteLocalUid, const QString & noteContent,
+    const QString & cacheKey, const QUuid & requestId)
+{
+    auto * pRenderer = new NoteHtmlRenderer(
+        noteLocalUid, noteContent, cacheKey,
+        renderedNoteHtmlDiskCacheDirPath(), requestId);
+
+    pRenderer->setAutoDelete(false);
+
+    QObject::connect(
+        pRenderer, &NoteHtmlRenderer::finished, this,
+        &NoteEditorPrivate::onNoteHtmlRendered, Qt::QueuedConnection);
+
+    QObject::connect(
+        pRenderer, &NoteHtmlRenderer::finished, pRenderer,
+        &NoteHtmlRenderer::deleteLater, Qt::QueuedConnection);
+
+    QThreadPool::globalInstance()->start(pRenderer);
+
+    ++m_numStartedNoteHtmlRenderers;
+    if (m_numStartedNoteHtmlRenderers %
+            NOTE_EDITOR_RENDERED_NOTE_HTML_DISK_CACHE_PRUNING_PERIOD ==
+        0)
+    {
+        pruneRenderedNoteHtmlDiskCache();
+    }
+}
+
+QString NoteEditorPrivate::renderedNoteHtmlDiskCacheDirPath() const
+{
+    if (!m_pAccount) {
+        return {};
+    }
+
+    return accountPersistentStoragePath(*m_pAccount) + QStringLiteral("/") +
+        NOTE_EDITOR_RENDERED_NOTE_HTML_CACHE_DIR;
+}
+
+void NoteEditorPrivate::removeRenderedNoteHtmlFromCaches(
+    const QString & noteLocalUid)
+{
+    QNDEBUG(
+        "note_editor",
+        "NoteEditorPrivate::removeRenderedNoteHtmlFromCaches: "
+            << noteLocalUid);
+
+    const QString keyPrefix = noteLocalUid + QStringLiteral("_");
+
+    QStringList keysToRemove;
+    for (const auto & pair: m_renderedNoteHtmlCache) {
+        if (pair.first.startsWith(keyPrefix)) {
+            keysToRemove << pair.first;
+        }
+    }
+
+    for (const auto & key: qAsConst(keysToRemove)) {
+        Q_UNUSED(m_renderedNoteHtmlCache.remove(key))
+    }
+
+    QString diskCacheDirPath = renderedNoteHtmlDiskCacheDirPath();
+    if (!diskCacheDirPath.isEmpty()) {
+        Q_UNUSED(NoteHtmlRenderer::removeFromDiskCache(
+            diskCacheDirPath, noteLocalUid))
+    }
+}
+
+void NoteEditorPrivate::pruneRenderedNoteHtmlDiskCache()
+{
+    QString diskCacheDirPath = renderedNoteHtmlDiskCacheDirPath();
+    if (diskCacheDirPath.isEmpty()) {
+        return;
+    }
+
+    QNDEBUG(
+        "note_editor",
+        "NoteEditorPrivate::pruneRenderedNoteHtmlDiskCache: "
+            << diskCacheDirPath);
+
+    QThreadPool::globalInstance()->start(new NoteHtmlDiskCachePruner(
+        diskCacheDirPath, NOTE_EDITOR_RENDERED_NOTE_HTML_DISK_CACHE_MAX_SIZE,
+        NOTE_EDITOR_RENDERED_NOTE_HTML_DISK_CACHE_MAX_AGE_SEC));
+}
+
+QByteArray NoteEditorPrivate::decryptedTextState(
+    const QString & noteContent) const
+{
+    if (!noteContent.contains(QStringLiteral("<en-crypt"))) {
+        return {};
+    }
+
+    static const QRegularExpression enCryptRegex(
+        QStringLiteral("<en-crypt[^>]*>([^<]*)</en-crypt>"));
+
+    QByteArray state;
+    auto it = enCryptRegex.globalMatch(noteContent);
+    while (it.hasNext()) {
+        auto match = it.next();
+        QString encryptedText = match.captured(1).trimmed();
+
+        QString decryptedText;
+        bool rememberForSession = false;
+        if (!m_decryptedTextManager->findDecryptedTextByEncryptedText(
+                encryptedText, decryptedText, rememberForSession))
+        {
+            continue;
+        }
+
+        state += encryptedText.toUtf8();
+        state += decryptedText.toUtf8();
+    }
+
+    return state;
+}
+
+void NoteEditorPrivate::prerenderNotes(const QList<Note> & notes)
+{
+    QNDEBUG(
+        "note_editor",
+        "NoteEditorPrivate::prerenderNotes: " << notes.size() << " notes");
+
+    for (const auto & note: qAsConst(notes)) {
+        if (note.isInkNote() || !note.hasContent()) {
+            continue;
+        }
+
+        const QString & noteContent = note.content();
+        if (!decryptedTextState(noteContent).isEmpty()) {
+            continue;
+        }
+
+        QString cacheKey =
+            NoteHtmlRenderer::cacheKey(note.localUid(), noteContent);
+
+        if (m_renderedNoteHtmlCache.exists(cacheKey)) {
+            continue;
+        }
+
+        // Prerendered HTML only goes to the cache, the request id doesn't
+        // match the one of the current note's rendering
+        startNoteHtmlRenderer(
+            note.localUid(), noteContent, cacheKey, QUuid::createUuid());
+    }
+}
+
 void NoteEditorPrivate::updateColResizableTableBindings()
 {
     QNDEBUG(
@@ -5003,7 +5241,7 @@ void NoteEditorPrivate::manualSaveResourceToFile(const Resource & resource)
 
     Q_EMIT saveResourceToFile(
         absoluteFilePath, data, saveResourceToFileRequestId,
-        /* append = */ false);
+        /* append = */ false, FileIOProcessorAsync::Priority::Interactive);
 
     QNDEBUG(
         "note_editor",
@@ -6002,11 +6240,11 @@ void NoteEditorPrivate::setupFileIO()
 
     QObject::connect(
         this, &NoteEditorPrivate::writeNoteHtmlToFile, m_pFileIOProcessorAsync,
-        &FileIOProcessorAsync::onWriteFileRequest);
+        &FileIOProcessorAsync::onPrioritizedWriteFileRequest);
 
     QObject::connect(
         this, &NoteEditorPrivate::saveResourceToFile, m_pFileIOProcessorAsync,
-        &FileIOProcessorAsync::onWriteFileRequest);
+        &FileIOProcessorAsync::onPrioritizedWriteFileRequest);
 
     QObject::connect(
         m_pFileIOProcessorAsync,
@@ -7190,36 +7428,141 @@ void NoteEditorPrivate::onPageHtmlReceived(
 
     m_lastSelectedHtml.resize(0);
     m_htmlCachedMemory = html;
-    m_enmlCachedMemory.resize(0);
-    ErrorString error;
 
-    bool res = m_enmlConverter.htmlToNoteContent(
-        m_htmlCachedMemory, m_enmlCachedMemory, *m_decryptedTextManager, error,
-        m_skipRulesForHtmlToEnmlConversion);
+    // Decrypted text fragments are converted back to encrypted ones using
+    // the decrypted text manager which must not be shared with other
+    // threads, hence such pages are converted right here
+    if (m_htmlCachedMemory.contains(QStringLiteral("en-decrypted"))) {
+        cancelHtmlToNoteContentConversion();
 
-    if (!res) {
-        ErrorString errorDescription(
-            QT_TR_NOOP("Can't convert note editor page's content to ENML"));
-        errorDescription.appendBase(error.base());
-        errorDescription.appendBase(error.additionalBases());
-        errorDescription.details() = error.details();
-        Q_EMIT notifyError(errorDescription);
+        m_enmlCachedMemory.resize(0);
+        ErrorString error;
 
-        m_pendingConversionToNote = false;
-        Q_EMIT cantConvertToNote(errorDescription);
+        bool res = m_enmlConverter.htmlToNoteContent(
+            m_htmlCachedMemory, m_enmlCachedMemory, *m_decryptedTextManager,
+            error, m_skipRulesForHtmlToEnmlConversion);
 
-        if (m_pendingConversionToNoteForSavingInLocalStorage) {
-            m_pendingConversionToNoteForSavingInLocalStorage = false;
+        if (!res) {
+            failConversionToNote(error);
+            return;
+        }
 
-            Q_EMIT failedToSaveNoteToLocalStorage(
-                errorDescription, m_noteLocalUid);
+        finishConversionToNote(m_enmlCachedMemory);
+        return;
+    }
+
+    if (!m_htmlToNoteContentRequestId.isNull()) {
+        QNDEBUG(
+            "note_editor",
+            "Conversion of page's HTML to ENML is already in progress, "
+                << "cancelling it in favour of the latest HTML");
+
+        m_pendingHtmlForConversionToNote = m_htmlCachedMemory;
+        m_hasPendingHtmlForConversionToNote = true;
+
+        if (m_pHtmlToNoteContentStopFlag) {
+            m_pHtmlToNoteContentStopFlag->storeRelease(1);
         }
 
         return;
     }
 
+    startHtmlToNoteContentConversion(m_htmlCachedMemory);
+}
+
+void NoteEditorPrivate::startHtmlToNoteContentConversion(const QString & html)
+{
+    m_htmlToNoteContentRequestId = QUuid::createUuid();
+    m_pHtmlToNoteContentStopFlag = std::make_shared<QAtomicInt>(0);
+
+    QNDEBUG(
+        "note_editor",
+        "NoteEditorPrivate::startHtmlToNoteContentConversion: request id = "
+            << m_htmlToNoteContentRequestId);
+
+    auto * pConverter = new HtmlToNoteContentConverter(
+        m_pNote->localUid(), html, m_skipRulesForHtmlToEnmlConversion,
+        m_pHtmlToNoteContentStopFlag, m_htmlToNoteContentRequestId);
+
+    pConverter->setAutoDelete(false);
+
+    QObject::connect(
+        pConverter, &HtmlToNoteContentConverter::finished, this,
+        &NoteEditorPrivate::onHtmlConvertedToNoteContent,
+        Qt::QueuedConnection);
+
+    QObject::connect(
+        pConverter, &HtmlToNoteContentConverter::finished, pConverter,
+        &HtmlToNoteContentConverter::deleteLater, Qt::QueuedConnection);
+
+    QThreadPool::globalInstance()->start(pConverter);
+}
+
+void NoteEditorPrivate::cancelHtmlToNoteContentConversion()
+{
+    if (m_pHtmlToNoteContentStopFlag) {
+        m_pHtmlToNoteContentStopFlag->storeRelease(1);
+        m_pHtmlToNoteContentStopFlag.reset();
+    }
+
+    m_htmlToNoteContentRequestId = QUuid();
+    m_pendingHtmlForConversionToNote.resize(0);
+    m_hasPendingHtmlForConversionToNote = false;
+}
+
+void NoteEditorPrivate::onHtmlConvertedToNoteContent(
+    QUuid requestId, QString noteLocalUid, bool cancelled,
+    QString noteContent, ErrorString errorDescription)
+{
+    if (requestId != m_htmlToNoteContentRequestId) {
+        return;
+    }
+
+    QNDEBUG(
+        "note_editor",
+        "NoteEditorPrivate::onHtmlConvertedToNoteContent: request id = "
+            << requestId << ", note local uid = " << noteLocalUid
+            << ", cancelled = " << (cancelled ? "true" : "false")
+            << ", error: " << errorDescription);
+
+    m_htmlToNoteContentRequestId = QUuid();
+    m_pHtmlToNoteContentStopFlag.reset();
+
+    if (Q_UNLIKELY(!m_pNote || (m_pNote->localUid() != noteLocalUid))) {
+        QNDEBUG("note_editor", "The converted note is not the current one");
+        m_pendingHtmlForConversionToNote.resize(0);
+        m_hasPendingHtmlForConversionToNote = false;
+        return;
+    }
+
+    // The result of conversion of outdated HTML is dropped in favour of
+    // the latest HTML received while the conversion was in progress
+    if (m_hasPendingHtmlForConversionToNote) {
+        QString html = m_pendingHtmlForConversionToNote;
+        m_pendingHtmlForConversionToNote.resize(0);
+        m_hasPendingHtmlForConversionToNote = false;
+        startHtmlToNoteContentConversion(html);
+        return;
+    }
+
+    if (cancelled) {
+        return;
+    }
+
+    if (!errorDescription.isEmpty()) {
+        failConversionToNote(errorDescription);
+        return;
+    }
+
+    finishConversionToNote(noteContent);
+}
+
+void NoteEditorPrivate::finishConversionToNote(const QString & noteContent)
+{
+    QNDEBUG("note_editor", "NoteEditorPrivate::finishConversionToNote");
+
     ErrorString errorDescription;
-    if (!checkNoteSize(m_enmlCachedMemory, errorDescription)) {
+    if (!checkNoteSize(noteContent, errorDescription)) {
         m_pendingConversionToNote = false;
         Q_EMIT cantConvertToNote(errorDescription);
 
@@ -7233,7 +7576,7 @@ void NoteEditorPrivate::onPageHtmlReceived(
         return;
     }
 
-    m_pNote->setContent(m_enmlCachedMemory);
+    m_pNote->setContent(noteContent);
 
     if (m_pendingConversionToNoteForSavingInLocalStorage) {
         m_pendingConversionToNoteForSavingInLocalStorage = false;
@@ -7249,6 +7592,27 @@ void NoteEditorPrivate::onPageHtmlReceived(
     Q_EMIT convertedToNote(*m_pNote);
 }
 
+void NoteEditorPrivate::failConversionToNote(const ErrorString & error)
+{
+    ErrorString errorDescription(
+        QT_TR_NOOP("Can't convert note editor page's content to ENML"));
+    errorDescription.appendBase(error.base());
+    errorDescription.appendBase(error.additionalBases());
+    errorDescription.details() = error.details();
+    QNWARNING("note_editor", errorDescription);
+    Q_EMIT notifyError(errorDescription);
+
+    m_pendingConversionToNote = false;
+    Q_EMIT cantConvertToNote(errorDescription);
+
+    if (m_pendingConversionToNoteForSavingInLocalStorage) {
+        m_pendingConversionToNoteForSavingInLocalStorage = false;
+
+        Q_EMIT failedToSaveNoteToLocalStorage(
+            errorDescription, m_noteLocalUid);
+    }
+}
+
 void NoteEditorPrivate::onSelectedTextEncryptionDone(
     const QVariant & dummy,
     const QVector<std::pair<QString, QString>> & extraData)
@@ -7284,25 +7648,6 @@ void NoteEditorPrivate::onTableActionDone(
     convertToNote();
 }
 
-int NoteEditorPrivate::resourceIndexByHash(
-    const QList<Resource> & resources, const QByteArray & resourceHash) const
-{
-    QNDEBUG(
-        "note_editor",
-        "NoteEditorPrivate::resourceIndexByHash: hash = "
-            << resourceHash.toHex());
-
-    const int numResources = resources.size();
-    for (int i = 0; i < numResources; ++i) {
-        const Resource & resource = resources[i];
-        if (resource.hasDataHash() && (resource.dataHash() == resourceHash)) {
-            return i;
-        }
-    }
-
-    return -1;
-}
-
 void NoteEditorPrivate::writeNotePageFile(const QString & html)
 {
     m_writeNoteHtmlToFileRequestId = QUuid::createUuid();
@@ -7316,7 +7661,7 @@ void NoteEditorPrivate::writeNotePageFile(const QString & html)
 
     Q_EMIT writeNoteHtmlToFile(
         pagePath, html.toUtf8(), m_writeNoteHtmlToFileRequestId,
-        /* append = */ false);
+        /* append = */ false, FileIOProcessorAsync::Priority::Interactive);
 }
 
 bool NoteEditorPrivate::parseEncryptedTextContextMenuExtraData(
@@ -7632,8 +7977,9 @@ void NoteEditorPrivate::enableSpellCheck()
         return;
     }
 
+    // NOTE: the spell check would be applied once the list of misspelled
+    // words is refreshed
     refreshMisSpelledWordsList();
-    applySpellCheck();
     enableDynamicSpellCheck();
 }
 
@@ -7641,6 +7987,7 @@ void NoteEditorPrivate::disableSpellCheck()
 {
     QNDEBUG("note_editor", "NoteEditorPrivate::disableSpellCheck");
 
+    m_refreshMisSpelledWordsRequestId = QUuid();
     m_currentNoteMisSpelledWords.clear();
     removeSpellCheck();
     disableDynamicSpellCheck();
@@ -7670,9 +8017,10 @@ void NoteEditorPrivate::refreshMisSpelledWordsList()
         return;
     }
 
-    for (const auto & originalWord: qAsConst(words)) {
-        QNTRACE("note_editor", "Checking word \"" << originalWord << "\"");
+    QStringList wordsToCheck;
+    wordsToCheck.reserve(words.size());
 
+    for (const auto & originalWord: qAsConst(words)) {
         QString word = originalWord;
 
         bool conversionResult = false;
@@ -7702,21 +8050,18 @@ void NoteEditorPrivate::refreshMisSpelledWordsList()
             continue;
         }
 
-        word = word.trimmed();
+        wordsToCheck << word.trimmed();
+    }
 
-        QNTRACE(
-            "note_editor",
-            "Checking the spelling of \"adjusted\" word " << word);
+    // Words are deduplicated and checked on a worker thread, the result
+    // would come in onSpellCheckBatchFinished
+    m_refreshMisSpelledWordsRequestId =
+        m_pSpellChecker->checkSpellBatch(wordsToCheck);
 
-        if (!m_pSpellChecker->checkSpell(word)) {
-            QNTRACE("note_editor", "Misspelled word: \"" << word << "\"");
-            word = originalWord;
-            m_stringUtils.removePunctuation(word);
-            word = word.trimmed();
-            Q_UNUSED(m_currentNoteMisSpelledWords.insert(word))
-            QNTRACE("note_editor", "Word added to the list: " << word);
-        }
-    }
+    QNDEBUG(
+        "note_editor",
+        "Sent " << wordsToCheck.size() << " words for spell checking, "
+                << "request id = " << m_refreshMisSpelledWordsRequestId);
 }
 
 void NoteEditorPrivate::applySpellCheck(const bool applyToSelection)
@@ -8189,6 +8534,10 @@ void NoteEditorPrivate::initialize(
 
     m_pSpellChecker = &spellChecker;
 
+    QObject::connect(
+        m_pSpellChecker, &SpellChecker::checkSpellBatchFinished, this,
+        &NoteEditorPrivate::onSpellCheckBatchFinished, Qt::UniqueConnection);
+
     if (pBackgroundJobsThread) {
         m_pFileIOProcessorAsync->moveToThread(pBackgroundJobsThread);
     }
@@ -8223,6 +8572,7 @@ void NoteEditorPrivate::setAccount(const Account & account)
     }
 
     init();
+    pruneRenderedNoteHtmlDiskCache();
 }
 
 void NoteEditorPrivate::setUndoStack(QUndoStack * pUndoStack)
@@ -8233,7 +8583,19 @@ void NoteEditorPrivate::setUndoStack(QUndoStack * pUndoStack)
         "note_editor", pUndoStack,
         QStringLiteral("null undo stack passed to note editor"));
 
+    if (m_pUndoStack) {
+        QObject::disconnect(
+            m_pUndoStack, &QUndoStack::indexChanged, this,
+            &NoteEditorPrivate::onUndoStackIndexChanged);
+    }
+
     m_pUndoStack = pUndoStack;
+
+    // Queued connection so that the stack is not cleared from within
+    // the push of a command
+    QObject::connect(
+        m_pUndoStack, &QUndoStack::indexChanged, this,
+        &NoteEditorPrivate::onUndoStackIndexChanged, Qt::QueuedConnection);
 }
 
 bool NoteEditorPrivate::print(
@@ -9114,16 +9476,8 @@ void NoteEditorPrivate::replaceResourceInNote(const Resource & resource)
         return;
     }
 
-    auto resources = m_pNote->resources();
-    int resourceIndex = -1;
-    const int numResources = resources.size();
-    for (int i = 0; i < numResources; ++i) {
-        const auto & currentResource = qAsConst(resources).at(i);
-        if (currentResource.localUid() == resource.localUid()) {
-            resourceIndex = i;
-            break;
-        }
-    }
+    const int resourceIndex =
+        m_pNote->resourceIndexByLocalUid(resource.localUid());
 
     if (Q_UNLIKELY(resourceIndex < 0)) {
         ErrorString error(
@@ -9135,13 +9489,13 @@ void NoteEditorPrivate::replaceResourceInNote(const Resource & resource)
         return;
     }
 
-    const auto & targetResource = qAsConst(resources).at(resourceIndex);
+    const auto & targetResource = m_pNote->qevercloudResourceAt(resourceIndex);
     QByteArray previousResourceHash;
-    if (targetResource.hasDataHash()) {
-        previousResourceHash = targetResource.dataHash();
+    if (targetResource.data.isSet() && targetResource.data->bodyHash.isSet()) {
+        previousResourceHash = targetResource.data->bodyHash.ref();
     }
 
-    updateResource(targetResource.localUid(), previousResourceHash, resource);
+    updateResource(resource.localUid(), previousResourceHash, resource);
 }
 
 void NoteEditorPrivate::setNoteResources(const QList<Resource> & resources)
@@ -9613,22 +9967,25 @@ qint64 NoteEditorPrivate::noteResourcesSize() const
     }
 
     qint64 size = 0;
-    QList<Resource> resources = m_pNote->resources();
-    for (const auto & resource: qAsConst(resources)) {
+    const int numResources = m_pNote->numResources();
+    for (int i = 0; i < numResources; ++i) {
+        const auto & resource = m_pNote->qevercloudResourceAt(i);
         QNTRACE(
             "note_editor",
-            "Computing size contributions for resource: " << resource);
+            "Computing size contributions for resource #" << i);
 
-        if (resource.hasDataSize()) {
-            size += resource.dataSize();
+        if (resource.data.isSet() && resource.data->size.isSet()) {
+            size += resource.data->size.ref();
         }
 
-        if (resource.hasAlternateDataSize()) {
-            size += resource.alternateDataSize();
+        if (resource.alternateData.isSet() &&
+            resource.alternateData->size.isSet()) {
+            size += resource.alternateData->size.ref();
         }
 
-        if (resource.hasRecognitionDataSize()) {
-            size += resource.recognitionDataSize();
+        if (resource.recognition.isSet() && resource.recognition->size.isSet())
+        {
+            size += resource.recognition->size.ref();
         }
     }
 
@@ -9890,6 +10247,94 @@ void NoteEditorPrivate::onSpellCheckerDynamicHelperUpdate(QStringList words)
     applySpellCheck(/* apply to selection = */ true);
 }
 
+void NoteEditorPrivate::onSpellCheckBatchFinished(
+    QUuid requestId, QStringList misSpelledWords)
+{
+    if (requestId != m_refreshMisSpelledWordsRequestId) {
+        return;
+    }
+
+    QNDEBUG(
+        "note_editor",
+        "NoteEditorPrivate::onSpellCheckBatchFinished: request id = "
+            << requestId << ", " << misSpelledWords.size()
+            << " misspelled words");
+
+    m_refreshMisSpelledWordsRequestId = QUuid();
+
+    if (!m_spellCheckerEnabled) {
+        QNTRACE("note_editor", "No spell checking is enabled, nothing to do");
+        return;
+    }
+
+    m_currentNoteMisSpelledWords.clear();
+    m_currentNoteMisSpelledWords.reserve(misSpelledWords.size());
+    for (const auto & word: qAsConst(misSpelledWords)) {
+        Q_UNUSED(m_currentNoteMisSpelledWords.insert(word))
+    }
+
+    applySpellCheck();
+}
+
+void NoteEditorPrivate::onNoteHtmlRendered(
+    QUuid requestId, QString noteLocalUid, QString cacheKey, QString html,
+    quint64 numEnToDoNodes, quint64 numHyperlinkNodes,
+    quint64 numEnCryptNodes, quint64 numEnDecryptedNodes,
+    ErrorString errorDescription)
+{
+    QNDEBUG(
+        "note_editor",
+        "NoteEditorPrivate::onNoteHtmlRendered: request id = "
+            << requestId << ", note local uid = " << noteLocalUid
+            << ", error: " << errorDescription);
+
+    bool currentRequest = (requestId == m_renderNoteHtmlRequestId);
+
+    if (!errorDescription.isEmpty()) {
+        if (!currentRequest) {
+            return;
+        }
+
+        m_renderNoteHtmlRequestId = QUuid();
+
+        ErrorString error(QT_TR_NOOP("Can't convert note's content to HTML"));
+        error.appendBase(errorDescription.base());
+        error.appendBase(errorDescription.additionalBases());
+        error.details() = errorDescription.details();
+        QNWARNING("note_editor", error);
+        clearEditorContent(BlankPageKind::InternalError, error);
+        Q_EMIT notifyError(error);
+        return;
+    }
+
+    RenderedNoteHtml renderedHtml;
+    renderedHtml.m_html = html;
+    renderedHtml.m_extraData.m_numEnToDoNodes = numEnToDoNodes;
+    renderedHtml.m_extraData.m_numHyperlinkNodes = numHyperlinkNodes;
+    renderedHtml.m_extraData.m_numEnCryptNodes = numEnCryptNodes;
+    renderedHtml.m_extraData.m_numEnDecryptedNodes = numEnDecryptedNodes;
+
+    m_renderedNoteHtmlCache.put(cacheKey, renderedHtml);
+
+    if (!currentRequest) {
+        QNTRACE(
+            "note_editor",
+            "Not the current note's rendering, only caching the result");
+        return;
+    }
+
+    m_renderNoteHtmlRequestId = QUuid();
+
+    if (!m_pNote || (m_pNote->localUid() != noteLocalUid)) {
+        QNDEBUG(
+            "note_editor",
+            "The rendered note is no longer the current one");
+        return;
+    }
+
+    applyRenderedNoteHtml(renderedHtml);
+}
+
 void NoteEditorPrivate::onSpellCheckerReady()
 {
     QNDEBUG("note_editor", "NoteEditorPrivate::onSpellCheckerReady");
@@ -11052,8 +11497,7 @@ void NoteEditorPrivate::copyAttachment(const QByteArray & resourceHash)
         return;
     }
 
-    QList<Resource> resources = m_pNote->resources();
-    int resourceIndex = resourceIndexByHash(resources, resourceHash);
+    const int resourceIndex = m_pNote->resourceIndexByDataHash(resourceHash);
     if (Q_UNLIKELY(resourceIndex < 0)) {
         ErrorString error(
             QT_TR_NOOP("The attachment to be copied was not found "
@@ -11065,7 +11509,7 @@ void NoteEditorPrivate::copyAttachment(const QByteArray & resourceHash)
         return;
     }
 
-    const Resource & resource = qAsConst(resources).at(resourceIndex);
+    const Resource resource = m_pNote->resourceAt(resourceIndex);
 
     if (Q_UNLIKELY(!resource.hasDataBody() && !resource.hasAlternateDataBody()))
     {
@@ -11265,18 +11709,8 @@ void NoteEditorPrivate::renameAttachment(const QByteArray & resourceHash)
         return;
     }
 
-    int targetResourceIndex = -1;
-    auto resources = m_pNote->resources();
-    const int numResources = resources.size();
-    for (int i = 0; i < numResources; ++i) {
-        const auto & resource = qAsConst(resources).at(i);
-        if (!resource.hasDataHash() || (resource.dataHash() != resourceHash)) {
-            continue;
-        }
-
-        targetResourceIndex = i;
-        break;
-    }
+    const int targetResourceIndex =
+        m_pNote->resourceIndexByDataHash(resourceHash);
 
     if (Q_UNLIKELY(targetResourceIndex < 0)) {
         ErrorString error = errorPrefix;
@@ -11287,7 +11721,7 @@ void NoteEditorPrivate::renameAttachment(const QByteArray & resourceHash)
         return;
     }
 
-    auto & resource = resources[targetResourceIndex];
+    const Resource resource = m_pNote->resourceAt(targetResourceIndex);
     if (Q_UNLIKELY(!resource.hasDataBody())) {
         ErrorString error = errorPrefix;
         error.appendBase(
@@ -11416,6 +11850,10 @@ void NoteEditorPrivate::rotateImageAttachment(
         delegate, &ImageResourceRotationDelegate::notifyError, this,
         &NoteEditorPrivate::onImageResourceRotationDelegateError);
 
+    QObject::connect(
+        delegate, &ImageResourceRotationDelegate::cancelled, this,
+        &NoteEditorPrivate::onImageResourceRotationDelegateCancelled);
+
     delegate->start();
 }
 
@@ -20,6 +20,7 @@
 #define LIB_QUENTIER_NOTE_EDITOR_NOTE_EDITOR_P_H
 
 #include "NoteEditorPage.h"
+#include "NoteHtmlRenderer.h"
 #include "ResourceInfo.h"
 
 #include <quentier/enml/DecryptedTextManager.h>
@@ -31,8 +32,11 @@
 #include <quentier/types/Resource.h>
 #include <quentier/types/ResourceRecognitionIndices.h>
 #include <quentier/utility/EncryptionManager.h>
+#include <quentier/utility/FileIOProcessorAsync.h>
+#include <quentier/utility/LRUCache.hpp>
 #include <quentier/utility/StringUtils.h>
 
+#include <QAtomicInt>
 #include <QColor>
 #include <QFont>
 #include <QImage>
@@ -72,7 +76,6 @@ QT_FORWARD_DECLARE_CLASS(WebSocketClientWrapper)
 
 namespace quentier {
 
-QT_FORWARD_DECLARE_CLASS(FileIOProcessorAsync)
 QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
 QT_FORWARD_DECLARE_CLASS(ResourceDataInTemporaryFileStorageManager)
 QT_FORWARD_DECLARE_CLASS(ResourceInfoJavaScriptHandler)
@@ -89,6 +92,7 @@ QT_FORWARD_DECLARE_CLASS(TableResizeJavaScriptHandler)
 QT_FORWARD_DECLARE_CLASS(TextCursorPositionJavaScriptHandler)
 QT_FORWARD_DECLARE_CLASS(ToDoCheckboxOnClickHandler)
 QT_FORWARD_DECLARE_CLASS(ToDoCheckboxAutomaticInsertionHandler)
+QT_FORWARD_DECLARE_CLASS(UndoStackDataStorage)
 
 #ifdef QUENTIER_USE_QT_WEB_ENGINE
 QT_FORWARD_DECLARE_CLASS(EnCryptElementOnClickHandler)
@@ -199,6 +203,12 @@ public:
     {
         return m_pNote.get();
     }
+
+    const std::shared_ptr<UndoStackDataStorage> & undoStackDataStorage() const
+    {
+        return m_pUndoStackDataStorage;
+    }
+
     void setModified();
 
     bool isPageEditable() const
@@ -435,6 +445,8 @@ public Q_SLOTS:
 public:
     virtual QString currentNoteLocalUid() const override;
 
+    void prerenderNotes(const QList<Note> & notes);
+
     // private signals:
 Q_SIGNALS:
     // Signals for communicating with ResourceDataInTemporaryFileStorageManager
@@ -454,7 +466,7 @@ Q_SIGNALS:
      */
     void writeNoteHtmlToFile(
         QString absoluteFilePath, QByteArray html, QUuid requestId,
-        bool append);
+        bool append, FileIOProcessorAsync::Priority priority);
 
     /**
      * The signal used to save the resource binary data to some file selected by
@@ -463,7 +475,7 @@ Q_SIGNALS:
      */
     void saveResourceToFile(
         QString absoluteFilePath, QByteArray resourceData, QUuid requestId,
-        bool append);
+        bool append, FileIOProcessorAsync::Priority priority);
 
 #ifdef QUENTIER_USE_QT_WEB_ENGINE
     /**
@@ -595,6 +607,19 @@ private Q_SLOTS:
 
     void onSpellCheckerReady();
 
+    void onSpellCheckBatchFinished(
+        QUuid requestId, QStringList misSpelledWords);
+
+    void onHtmlConvertedToNoteContent(
+        QUuid requestId, QString noteLocalUid, bool cancelled,
+        QString noteContent, ErrorString errorDescription);
+
+    void onNoteHtmlRendered(
+        QUuid requestId, QString noteLocalUid, QString cacheKey, QString html,
+        quint64 numEnToDoNodes, quint64 numHyperlinkNodes,
+        quint64 numEnCryptNodes, quint64 numEnDecryptedNodes,
+        ErrorString errorDescription);
+
     void onImageResourceResized(bool pushUndoCommand);
 
     void onSelectionFormattedAsSourceCode(
@@ -636,6 +661,7 @@ private Q_SLOTS:
         INoteEditorBackend::Rotation rotationDirection);
 
     void onImageResourceRotationDelegateError(ErrorString error);
+    void onImageResourceRotationDelegateCancelled();
 
     void onHideDecryptedTextFinished(
         const QVariant & data,
@@ -704,6 +730,8 @@ private Q_SLOTS:
     // Slots for undo command signals
     void onUndoCommandError(ErrorString error);
 
+    void onUndoStackIndexChanged(int index);
+
     void onSpellCheckerDictionaryEnabledOrDisabled(bool checked);
 
 #ifdef QUENTIER_USE_QT_WEB_ENGINE
@@ -847,11 +875,33 @@ private:
         const ErrorString & errorDescription = ErrorString());
 
     void noteToEditorContent();
+    void applyRenderedNoteHtml(const RenderedNoteHtml & renderedHtml);
+
+    void startNoteHtmlRenderer(
+        const QString & noteLocalUid, const QString & noteContent,
+        const QString & cacheKey, const QUuid & requestId);
+
+    QString renderedNoteHtmlDiskCacheDirPath() const;
+    void removeRenderedNoteHtmlFromCaches(const QString & noteLocalUid);
+    void pruneRenderedNoteHtmlDiskCache();
+
+    /**
+     * @return      Byte array identifying the decrypted text fragments of
+     *              the note content known to the decrypted text manager or
+     *              empty byte array if the content has no decrypted fragments
+     */
+    QByteArray decryptedTextState(const QString & noteContent) const;
+
     void updateColResizableTableBindings();
     void inkNoteToEditorContent();
 
     bool htmlToNoteContent(ErrorString & errorDescription);
 
+    void startHtmlToNoteContentConversion(const QString & html);
+    void cancelHtmlToNoteContentConversion();
+    void finishConversionToNote(const QString & noteContent);
+    void failConversionToNote(const ErrorString & error);
+
     void updateHashForResourceTag(
         const QByteArray & oldResourceHash, const QByteArray & newResourceHash);
 
@@ -927,10 +977,6 @@ private:
         const QVariant & dummy,
         const QVector<std::pair<QString, QString>> & extraData);
 
-    int resourceIndexByHash(
-        const QList<Resource> & resources,
-        const QByteArray & resourceHash) const;
-
     void writeNotePageFile(const QString & html);
 
     bool parseEncryptedTextContextMenuExtraData(
@@ -1357,6 +1403,7 @@ private:
     SpellChecker * m_pSpellChecker = nullptr;
     bool m_spellCheckerEnabled = false;
     QSet<QString> m_currentNoteMisSpelledWords;
+    QUuid m_refreshMisSpelledWordsRequestId;
     StringUtils m_stringUtils;
 
     QString m_lastSelectedHtml;
@@ -1373,6 +1420,14 @@ private:
                                  // conversions
     QString m_errorCachedMemory; // Cached memory for various errors
 
+    // Conversion of page's HTML to ENML running on a thread pool's thread;
+    // HTML received while the conversion is in progress replaces the pending
+    // one so that only the latest HTML gets converted next
+    QUuid m_htmlToNoteContentRequestId;
+    std::shared_ptr<QAtomicInt> m_pHtmlToNoteContentStopFlag;
+    QString m_pendingHtmlForConversionToNote;
+    bool m_hasPendingHtmlForConversionToNote = false;
+
     QVector<ENMLConverter::SkipHtmlElementRule>
         m_skipRulesForHtmlToEnmlConversion;
 
@@ -1380,6 +1435,15 @@ private:
         m_pResourceDataInTemporaryFileStorageManager = nullptr;
     FileIOProcessorAsync * m_pFileIOProcessorAsync;
 
+    // Rendered HTML of recently displayed and prerendered notes keyed by
+    // NoteHtmlRenderer::cacheKey
+    LRUCache<QString, RenderedNoteHtml> m_renderedNoteHtmlCache;
+    QUuid m_renderNoteHtmlRequestId;
+    quint64 m_numStartedNoteHtmlRenderers = 0;
+
+    // Resource data referenced by undo commands, bounded in memory usage
+    std::shared_ptr<UndoStackDataStorage> m_pUndoStackDataStorage;
+
     ResourceInfo m_resourceInfo;
     ResourceInfoJavaScriptHandler * m_pResourceInfoJavaScriptHandler;
 
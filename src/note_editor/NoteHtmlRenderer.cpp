@@ -0,0 +1,313 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NoteHtmlRenderer.h"
+
+#include <quentier/enml/DecryptedTextManager.h>
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace quentier {
+
+NoteHtmlRenderer::NoteHtmlRenderer(
+    QString noteLocalUid, QString noteContent, QString cacheKey,
+    QString diskCacheDirPath, const QUuid & requestId, QObject * parent) :
+    QObject(parent),
+    m_noteLocalUid(std::move(noteLocalUid)),
+    m_noteContent(std::move(noteContent)), m_cacheKey(std::move(cacheKey)),
+    m_diskCacheDirPath(std::move(diskCacheDirPath)), m_requestId(requestId)
+{}
+
+void NoteHtmlRenderer::run()
+{
+    QNDEBUG(
+        "note_editor",
+        "NoteHtmlRenderer::run: request id = "
+            << m_requestId << ", note local uid = " << m_noteLocalUid);
+
+    RenderedNoteHtml renderedHtml;
+    ErrorString errorDescription;
+
+    bool foundInDiskCache = !m_diskCacheDirPath.isEmpty() &&
+        readFromDiskCache(
+            m_diskCacheDirPath, m_noteLocalUid, m_cacheKey, renderedHtml);
+
+    if (!foundInDiskCache) {
+        // The content passed to the renderer has no decrypted fragments so
+        // the empty decrypted text manager is sufficient for the conversion
+        ENMLConverter converter;
+        DecryptedTextManager decryptedTextManager;
+
+        bool res = converter.noteContentToHtml(
+            m_noteContent, renderedHtml.m_html, errorDescription,
+            decryptedTextManager, renderedHtml.m_extraData);
+
+        if (res && !m_diskCacheDirPath.isEmpty()) {
+            Q_UNUSED(writeToDiskCache(
+                m_diskCacheDirPath, m_noteLocalUid, m_cacheKey, renderedHtml))
+        }
+        else if (!res && errorDescription.isEmpty()) {
+            errorDescription.setBase(
+                QT_TR_NOOP("Can't convert note's content to HTML"));
+        }
+    }
+
+    QNDEBUG(
+        "note_editor",
+        "Finished rendering note " << m_noteLocalUid << ", found in disk "
+            << "cache = " << (foundInDiskCache ? "true" : "false")
+            << ", error: " << errorDescription);
+
+    const auto & extraData = renderedHtml.m_extraData;
+
+    Q_EMIT finished(
+        m_requestId, m_noteLocalUid, m_cacheKey, renderedHtml.m_html,
+        extraData.m_numEnToDoNodes, extraData.m_numHyperlinkNodes,
+        extraData.m_numEnCryptNodes, extraData.m_numEnDecryptedNodes,
+        errorDescription);
+}
+
+QString NoteHtmlRenderer::cacheKey(
+    const QString & noteLocalUid, const QString & noteContent,
+    const QByteArray & decryptedTextState)
+{
+    QString key = noteLocalUid;
+    key += QStringLiteral("_");
+
+    key += QString::fromLatin1(
+        QCryptographicHash::hash(noteContent.toUtf8(), QCryptographicHash::Md5)
+            .toHex());
+
+    if (!decryptedTextState.isEmpty()) {
+        key += QStringLiteral("_");
+
+        key += QString::fromLatin1(
+            QCryptographicHash::hash(
+                decryptedTextState, QCryptographicHash::Sha1)
+                .toHex());
+    }
+
+    return key;
+}
+
+bool NoteHtmlRenderer::readFromDiskCache(
+    const QString & diskCacheDirPath, const QString & noteLocalUid,
+    const QString & cacheKey, RenderedNoteHtml & renderedHtml)
+{
+    QFile file(
+        diskCacheDirPath + QStringLiteral("/") + noteLocalUid +
+        QStringLiteral(".html"));
+
+    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    // The first line contains the cache key and the extra data of
+    // the conversion, the rest is the rendered HTML
+    QString header = QString::fromUtf8(file.readLine()).trimmed();
+    QStringList headerParts = header.split(QChar::fromLatin1(' '));
+
+    if ((headerParts.size() != 7) ||
+        (headerParts.at(0) != QStringLiteral("<!--")) ||
+        (headerParts.at(1) != cacheKey) ||
+        (headerParts.at(6) != QStringLiteral("-->")))
+    {
+        QNTRACE(
+            "note_editor",
+            "Cached rendered HTML of note " << noteLocalUid
+                << " doesn't match the current content, removing it");
+
+        // Stale HTML must not outlive the change of note content even if
+        // the rendering of the new content fails
+        file.close();
+        Q_UNUSED(file.remove())
+        return false;
+    }
+
+    quint64 * counters[] = {
+        &renderedHtml.m_extraData.m_numEnToDoNodes,
+        &renderedHtml.m_extraData.m_numHyperlinkNodes,
+        &renderedHtml.m_extraData.m_numEnCryptNodes,
+        &renderedHtml.m_extraData.m_numEnDecryptedNodes};
+
+    for (int i = 0; i < 4; ++i) {
+        bool conversionResult = false;
+        *counters[i] = headerParts.at(i + 2).toULongLong(&conversionResult);
+        if (Q_UNLIKELY(!conversionResult)) {
+            QNWARNING(
+                "note_editor",
+                "Corrupted header of cached rendered HTML of note "
+                    << noteLocalUid << ": " << header);
+            return false;
+        }
+    }
+
+    renderedHtml.m_html = QString::fromUtf8(file.readAll());
+    return true;
+}
+
+bool NoteHtmlRenderer::writeToDiskCache(
+    const QString & diskCacheDirPath, const QString & noteLocalUid,
+    const QString & cacheKey, const RenderedNoteHtml & renderedHtml)
+{
+    QDir dir(diskCacheDirPath);
+    if (!dir.exists() && !dir.mkpath(diskCacheDirPath)) {
+        QNWARNING(
+            "note_editor",
+            "Failed to create the folder for rendered notes cache: "
+                << diskCacheDirPath);
+        return false;
+    }
+
+    const auto & extraData = renderedHtml.m_extraData;
+
+    QString header = QStringLiteral("<!-- ") + cacheKey +
+        QStringLiteral(" ") + QString::number(extraData.m_numEnToDoNodes) +
+        QStringLiteral(" ") + QString::number(extraData.m_numHyperlinkNodes) +
+        QStringLiteral(" ") + QString::number(extraData.m_numEnCryptNodes) +
+        QStringLiteral(" ") +
+        QString::number(extraData.m_numEnDecryptedNodes) +
+        QStringLiteral(" -->\n");
+
+    // QSaveFile replaces the previous cache file atomically so that
+    // the concurrent reader never encounters partially written file
+    QSaveFile file(
+        diskCacheDirPath + QStringLiteral("/") + noteLocalUid +
+        QStringLiteral(".html"));
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        QNWARNING(
+            "note_editor",
+            "Failed to open rendered notes cache file for writing: "
+                << file.fileName() << ": " << file.errorString());
+        return false;
+    }
+
+    if ((file.write(header.toUtf8()) < 0) ||
+        (file.write(renderedHtml.m_html.toUtf8()) < 0))
+    {
+        QNWARNING(
+            "note_editor",
+            "Failed to write rendered notes cache file: "
+                << file.fileName() << ": " << file.errorString());
+        file.cancelWriting();
+        return false;
+    }
+
+    if (!file.commit()) {
+        QNWARNING(
+            "note_editor",
+            "Failed to commit rendered notes cache file: "
+                << file.fileName() << ": " << file.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool NoteHtmlRenderer::removeFromDiskCache(
+    const QString & diskCacheDirPath, const QString & noteLocalUid)
+{
+    QFile file(
+        diskCacheDirPath + QStringLiteral("/") + noteLocalUid +
+        QStringLiteral(".html"));
+
+    if (!file.exists()) {
+        return true;
+    }
+
+    if (!file.remove()) {
+        QNWARNING(
+            "note_editor",
+            "Failed to remove rendered notes cache file: "
+                << file.fileName() << ": " << file.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+int NoteHtmlRenderer::pruneDiskCache(
+    const QString & diskCacheDirPath, const qint64 maxTotalSize,
+    const qint64 maxAgeSec)
+{
+    QDir dir(diskCacheDirPath);
+    if (!dir.exists()) {
+        return 0;
+    }
+
+    // Sorted by the last modification time, most recent first
+    const auto fileInfos = dir.entryInfoList(
+        QStringList() << QStringLiteral("*.html"), QDir::Files, QDir::Time);
+
+    const QDateTime oldestAllowedTime =
+        QDateTime::currentDateTime().addSecs(-maxAgeSec);
+
+    qint64 totalSize = 0;
+    int numRemovedFiles = 0;
+
+    for (const auto & fileInfo: fileInfos) {
+        totalSize += fileInfo.size();
+
+        if ((totalSize <= maxTotalSize) &&
+            (fileInfo.lastModified() >= oldestAllowedTime))
+        {
+            continue;
+        }
+
+        totalSize -= fileInfo.size();
+
+        if (QFile::remove(fileInfo.absoluteFilePath())) {
+            ++numRemovedFiles;
+        }
+        else {
+            QNDEBUG(
+                "note_editor",
+                "Failed to remove rendered notes cache file: "
+                    << fileInfo.absoluteFilePath());
+        }
+    }
+
+    QNDEBUG(
+        "note_editor",
+        "Pruned rendered notes cache: removed " << numRemovedFiles
+            << " files, " << totalSize << " bytes remain");
+
+    return numRemovedFiles;
+}
+
+NoteHtmlDiskCachePruner::NoteHtmlDiskCachePruner(
+    QString diskCacheDirPath, const qint64 maxTotalSize,
+    const qint64 maxAgeSec) :
+    m_diskCacheDirPath(std::move(diskCacheDirPath)),
+    m_maxTotalSize(maxTotalSize), m_maxAgeSec(maxAgeSec)
+{}
+
+void NoteHtmlDiskCachePruner::run()
+{
+    Q_UNUSED(NoteHtmlRenderer::pruneDiskCache(
+        m_diskCacheDirPath, m_maxTotalSize, m_maxAgeSec))
+}
+
+} // namespace quentier
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_NOTE_EDITOR_NOTE_HTML_RENDERER_H
+#define LIB_QUENTIER_NOTE_EDITOR_NOTE_HTML_RENDERER_H
+
+#include <quentier/enml/ENMLConverter.h>
+#include <quentier/types/ErrorString.h>
+
+#include <QByteArray>
+#include <QObject>
+#include <QRunnable>
+#include <QUuid>
+
+namespace quentier {
+
+/**
+ * @brief The RenderedNoteHtml struct holds the result of note content to HTML
+ * conversion along with the information about the converted content required
+ * by the note editor
+ */
+struct Q_DECL_HIDDEN RenderedNoteHtml
+{
+    QString m_html;
+    ENMLConverter::NoteContentToHtmlExtraData m_extraData;
+};
+
+/**
+ * @brief The NoteHtmlRenderer class converts note content to HTML on a thread
+ * pool's thread. The result of the conversion is persisted within the disk
+ * cache of rendered notes so that subsequent conversions of the same note
+ * content are replaced with reading the cached HTML.
+ *
+ * Only note content without decrypted fragments is meant to be rendered by
+ * NoteHtmlRenderer: decrypted text must neither leak to other threads nor
+ * to disk.
+ */
+class Q_DECL_HIDDEN NoteHtmlRenderer final : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    NoteHtmlRenderer(
+        QString noteLocalUid, QString noteContent, QString cacheKey,
+        QString diskCacheDirPath, const QUuid & requestId,
+        QObject * parent = nullptr);
+
+    virtual void run() override;
+
+    /**
+     * @return      The key identifying the rendered HTML of the note with
+     *              the given local uid and content; the state of decrypted
+     *              text fragments of the note, if any, is a part of the key
+     */
+    static QString cacheKey(
+        const QString & noteLocalUid, const QString & noteContent,
+        const QByteArray & decryptedTextState = {});
+
+    static bool readFromDiskCache(
+        const QString & diskCacheDirPath, const QString & noteLocalUid,
+        const QString & cacheKey, RenderedNoteHtml & renderedHtml);
+
+    static bool writeToDiskCache(
+        const QString & diskCacheDirPath, const QString & noteLocalUid,
+        const QString & cacheKey, const RenderedNoteHtml & renderedHtml);
+
+    static bool removeFromDiskCache(
+        const QString & diskCacheDirPath, const QString & noteLocalUid);
+
+    /**
+     * Removes cached rendered HTML files last written earlier than maxAgeSec
+     * seconds ago and then the least recently written ones until the total
+     * size of the remaining files doesn't exceed maxTotalSize bytes
+     *
+     * @return      The number of removed files
+     */
+    static int pruneDiskCache(
+        const QString & diskCacheDirPath, const qint64 maxTotalSize,
+        const qint64 maxAgeSec);
+
+Q_SIGNALS:
+    void finished(
+        QUuid requestId, QString noteLocalUid, QString cacheKey, QString html,
+        quint64 numEnToDoNodes, quint64 numHyperlinkNodes,
+        quint64 numEnCryptNodes, quint64 numEnDecryptedNodes,
+        ErrorString errorDescription);
+
+private:
+    QString m_noteLocalUid;
+    QString m_noteContent;
+    QString m_cacheKey;
+    QString m_diskCacheDirPath;
+    QUuid m_requestId;
+};
+
+/**
+ * @brief The NoteHtmlDiskCachePruner class runs
+ * NoteHtmlRenderer::pruneDiskCache on a thread pool's thread
+ */
+class Q_DECL_HIDDEN NoteHtmlDiskCachePruner final : public QRunnable
+{
+public:
+    NoteHtmlDiskCachePruner(
+        QString diskCacheDirPath, const qint64 maxTotalSize,
+        const qint64 maxAgeSec);
+
+    virtual void run() override;
+
+private:
+    QString m_diskCacheDirPath;
+    qint64 m_maxTotalSize;
+    qint64 m_maxAgeSec;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_NOTE_EDITOR_NOTE_HTML_RENDERER_H
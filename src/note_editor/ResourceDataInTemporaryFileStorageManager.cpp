@@ -41,9 +41,6 @@
 #include <fstream>
 #include <string>
 
-// 4 megabytes
-#define RESOURCE_DATA_BATCH_SIZE_IN_BYTES (4194304)
-
 namespace quentier {
 
 ResourceDataInTemporaryFileStorageManager::
@@ -84,10 +81,7 @@ void ResourceDataInTemporaryFileStorageManager::
             << ", data hash = " << dataHash.toHex()
             << ", is image = " << (isImage ? "true" : "false"));
 
-    if (dataHash.isEmpty()) {
-        dataHash = calculateHash(data);
-    }
-
+    // If the hash is not known yet, it is computed while writing the data
     ErrorString errorDescription;
     bool res = writeResourceDataToTemporaryFile(
         noteLocalUid, resourceLocalUid, data, dataHash,
@@ -292,8 +286,7 @@ void ResourceDataInTemporaryFileStorageManager::onOpenResourceRequest(
     }
 
     QByteArray dataHash =
-        (pResource->hasDataHash() ? pResource->dataHash()
-                                  : calculateHash(pResource->dataBody()));
+        (pResource->hasDataHash() ? pResource->dataHash() : QByteArray());
 
     WriteResourceDataCallback callback =
         OpenResourcePreparationProgressFunctor(resourceLocalUid, *this);
@@ -472,7 +465,11 @@ void ResourceDataInTemporaryFileStorageManager::onFileChanged(
     }
 
     ErrorString errorDescription;
-    QByteArray data = readFileContents(path, errorDescription);
+    QByteArray dataHash;
+
+    QByteArray data =
+        readFileContentsWithHash(path, dataHash, errorDescription);
+
     if (!errorDescription.isEmpty()) {
         QNWARNING("note_editor", errorDescription);
         m_fileSystemWatcher.removePath(path);
@@ -484,8 +481,6 @@ void ResourceDataInTemporaryFileStorageManager::onFileChanged(
         "Size of new resource data: " << humanReadableSize(
             static_cast<quint64>(std::max(data.size(), 0))));
 
-    QByteArray dataHash = calculateHash(data);
-
     int errorCode = 0;
     bool res = updateResourceHashHelperFile(
         it.value(), dataHash, resourceFileInfo.absolutePath(), errorCode,
@@ -548,8 +543,7 @@ void ResourceDataInTemporaryFileStorageManager::onFoundResourceData(
         QString noteLocalUid = m_pCurrentNote->localUid();
 
         QByteArray dataHash =
-            (resource.hasDataHash() ? resource.dataHash()
-                                    : calculateHash(resource.dataBody()));
+            (resource.hasDataHash() ? resource.dataHash() : QByteArray());
 
         ErrorString errorDescription;
         bool res = writeResourceDataToTemporaryFile(
@@ -611,8 +605,7 @@ void ResourceDataInTemporaryFileStorageManager::onFoundResourceData(
         QString noteLocalUid = m_pCurrentNote->localUid();
 
         QByteArray dataHash =
-            (resource.hasDataHash() ? resource.dataHash()
-                                    : calculateHash(resource.dataBody()));
+            (resource.hasDataHash() ? resource.dataHash() : QByteArray());
 
         WriteResourceDataCallback callback =
             OpenResourcePreparationProgressFunctor(resourceLocalUid, *this);
@@ -1282,8 +1275,7 @@ ResourceDataInTemporaryFileStorageManager::putResourcesDataToTemporaryFiles(
         }
 
         QByteArray dataHash =
-            (resource.hasDataHash() ? resource.dataHash()
-                                    : calculateHash(resource.dataBody()));
+            (resource.hasDataHash() ? resource.dataHash() : QByteArray());
 
         WriteResourceDataCallback callback =
             PartialUpdateResourceFilesForCurrentNoteProgressFunctor(
@@ -1349,7 +1341,7 @@ void ResourceDataInTemporaryFileStorageManager::
 bool ResourceDataInTemporaryFileStorageManager::
     writeResourceDataToTemporaryFile(
         const QString & noteLocalUid, const QString & resourceLocalUid,
-        const QByteArray & data, const QByteArray & dataHash,
+        const QByteArray & data, QByteArray & dataHash,
         const ResourceType resourceType, ErrorString & errorDescription,
         const CheckResourceFileActualityOption checkActualityOption,
         WriteResourceDataCallback callback)
@@ -1416,9 +1408,12 @@ bool ResourceDataInTemporaryFileStorageManager::
     }
 
     if (checkActualityOption == CheckResourceFileActualityOption::On) {
+        if (dataHash.isEmpty()) {
+            dataHash = calculateHash(data);
+        }
+
         bool actual = checkIfResourceFileExistsAndIsActual(
-            noteLocalUid, resourceLocalUid, fileStoragePath,
-            (dataHash.isEmpty() ? calculateHash(data) : dataHash));
+            noteLocalUid, resourceLocalUid, fileStoragePath, dataHash);
 
         if (actual) {
             QNTRACE(
@@ -1430,81 +1425,19 @@ bool ResourceDataInTemporaryFileStorageManager::
         }
     }
 
-    QFile file(fileStoragePath);
-    bool open = file.open(QIODevice::WriteOnly);
-    if (Q_UNLIKELY(!open)) {
-        errorDescription.setBase(
-            QT_TR_NOOP("Can't open resource file for writing"));
+    // The data is written in chunks and, unless already known, its hash is
+    // computed from each chunk right after writing it
+    bool written = writeFileContentsWithHash(
+        fileStoragePath, data, dataHash, errorDescription, callback);
 
-        errorDescription.details() = file.errorString();
-        int errorCode = file.error();
+    if (Q_UNLIKELY(!written)) {
         QNWARNING(
             "note_editor",
-            errorDescription << ", error code = " << errorCode
-                             << ", note local uid = " << noteLocalUid
+            errorDescription << ", note local uid = " << noteLocalUid
                              << ", resource local uid = " << resourceLocalUid);
-
         return false;
     }
 
-    if (!callback || (data.size() <= RESOURCE_DATA_BATCH_SIZE_IN_BYTES)) {
-        qint64 writeRes = file.write(data);
-        if (Q_UNLIKELY(writeRes < 0)) {
-            errorDescription.setBase(
-                QT_TR_NOOP("Can't write data to resource file"));
-
-            errorDescription.details() = file.errorString();
-            int errorCode = file.error();
-
-            QNWARNING(
-                "note_editor",
-                errorDescription
-                    << ", error code = " << errorCode
-                    << ", note local uid = " << noteLocalUid
-                    << ", resource local uid = " << resourceLocalUid);
-            return false;
-        }
-    }
-    else {
-        const char * rawData = data.constData();
-        size_t offset = 0;
-        double progress = 0;
-        while (true) {
-            qint64 writeRes =
-                file.write(rawData, RESOURCE_DATA_BATCH_SIZE_IN_BYTES);
-
-            if (Q_UNLIKELY(writeRes < 0)) {
-                errorDescription.setBase(
-                    QT_TR_NOOP("Can't write data to resource file"));
-
-                errorDescription.details() = file.errorString();
-                int errorCode = file.error();
-
-                QNWARNING(
-                    "note_editor",
-                    errorDescription
-                        << ", error code = " << errorCode
-                        << ", note local uid = " << noteLocalUid
-                        << ", resource local uid = " << resourceLocalUid);
-                return false;
-            }
-
-            offset += static_cast<size_t>(writeRes);
-            if (offset >= static_cast<size_t>(data.size())) {
-                break;
-            }
-
-            rawData += writeRes;
-
-            if (callback) {
-                progress = static_cast<double>(offset) / data.size();
-                callback(progress);
-            }
-        }
-    }
-
-    file.close();
-
     m_resourceLocalUidByFilePath[fileStoragePath] = resourceLocalUid;
 
     int errorCode = 0;
@@ -412,9 +412,13 @@ private:
 
     using WriteResourceDataCallback = std::function<void(const double)>;
 
+    /**
+     * Writes resource data to the temporary file; if dataHash is empty on
+     * input, it is computed from the data while writing it
+     */
     bool writeResourceDataToTemporaryFile(
         const QString & noteLocalUid, const QString & resourceLocalUid,
-        const QByteArray & data, const QByteArray & dataHash,
+        const QByteArray & data, QByteArray & dataHash,
         const ResourceType resourceType, ErrorString & errorDescription,
         const CheckResourceFileActualityOption checkActualityOption =
             CheckResourceFileActualityOption::On,
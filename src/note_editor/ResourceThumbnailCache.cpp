@@ -0,0 +1,222 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <quentier/note_editor/ResourceThumbnailCache.h>
+
+#include <quentier/logging/QuentierLogger.h>
+
+#include <QBuffer>
+#include <QCache>
+#include <QImageReader>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QStringList>
+
+#include <algorithm>
+
+// Enough for a few hundred of typical list view thumbnails
+#define RESOURCE_THUMBNAIL_CACHE_DEFAULT_MAX_SIZE (32 * 1024 * 1024)
+
+namespace quentier {
+
+namespace {
+
+struct ThumbnailCacheData
+{
+    ThumbnailCacheData() : m_cache(RESOURCE_THUMBNAIL_CACHE_DEFAULT_MAX_SIZE)
+    {}
+
+    QMutex m_mutex;
+
+    // The cost of each cached thumbnail is its size in bytes
+    QCache<QString, QImage> m_cache;
+};
+
+ThumbnailCacheData & thumbnailCacheData()
+{
+    static ThumbnailCacheData data;
+    return data;
+}
+
+QString thumbnailKeyPrefix(const QByteArray & dataHash)
+{
+    return QString::fromLatin1(dataHash.toHex()) + QStringLiteral("_");
+}
+
+QString thumbnailKey(const QByteArray & dataHash, const QSize & size)
+{
+    return thumbnailKeyPrefix(dataHash) + QString::number(size.width()) +
+        QStringLiteral("x") + QString::number(size.height());
+}
+
+int thumbnailCost(const QImage & image)
+{
+    return std::max(image.bytesPerLine() * image.height(), 1);
+}
+
+void putThumbnailIntoCache(const QString & key, const QImage & thumbnail)
+{
+    auto & data = thumbnailCacheData();
+    QMutexLocker locker(&data.m_mutex);
+    Q_UNUSED(data.m_cache.insert(
+        key, new QImage(thumbnail), thumbnailCost(thumbnail)))
+}
+
+} // namespace
+
+QImage ResourceThumbnailCache::thumbnail(
+    const QByteArray & dataHash, const QByteArray & imageData,
+    const QSize & size)
+{
+    QImage cached = cachedThumbnail(dataHash, size);
+    if (!cached.isNull()) {
+        return cached;
+    }
+
+    QByteArray imageDataCopy = imageData;
+    QBuffer buffer(&imageDataCopy);
+    if (!buffer.open(QIODevice::ReadOnly)) {
+        return {};
+    }
+
+    // Let the image reader downscale the image while decoding it: for some
+    // formats, i.e. JPEG, this is much cheaper than decoding the full size
+    // image and downscaling it afterwards
+    QImageReader reader(&buffer);
+    QSize imageSize = reader.size();
+    if (imageSize.isValid() &&
+        ((imageSize.width() > size.width()) ||
+         (imageSize.height() > size.height())))
+    {
+        reader.setScaledSize(imageSize.scaled(size, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        QNDEBUG(
+            "note_editor",
+            "ResourceThumbnailCache: can't decode image data: "
+                << reader.errorString() << ", data hash = "
+                << dataHash.toHex());
+        return {};
+    }
+
+    if ((image.width() > size.width()) || (image.height() > size.height())) {
+        image =
+            image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    putThumbnailIntoCache(thumbnailKey(dataHash, size), image);
+    return image;
+}
+
+QImage ResourceThumbnailCache::cachedThumbnail(
+    const QByteArray & dataHash, const QSize & size)
+{
+    auto & data = thumbnailCacheData();
+    QMutexLocker locker(&data.m_mutex);
+
+    const QImage * pImage = data.m_cache.object(thumbnailKey(dataHash, size));
+    if (!pImage) {
+        return {};
+    }
+
+    return *pImage;
+}
+
+QList<QSize> ResourceThumbnailCache::cachedThumbnailSizes(
+    const QByteArray & dataHash)
+{
+    const QString keyPrefix = thumbnailKeyPrefix(dataHash);
+
+    auto & data = thumbnailCacheData();
+    QMutexLocker locker(&data.m_mutex);
+
+    QList<QSize> sizes;
+    const auto keys = data.m_cache.keys();
+    for (const auto & key: keys) {
+        if (!key.startsWith(keyPrefix)) {
+            continue;
+        }
+
+        const QStringList dimensions =
+            key.mid(keyPrefix.size()).split(QStringLiteral("x"));
+
+        if (Q_UNLIKELY(dimensions.size() != 2)) {
+            continue;
+        }
+
+        sizes << QSize(dimensions[0].toInt(), dimensions[1].toInt());
+    }
+
+    return sizes;
+}
+
+void ResourceThumbnailCache::insertThumbnail(
+    const QByteArray & dataHash, const QImage & image, const QSize & size)
+{
+    if (image.isNull()) {
+        return;
+    }
+
+    QImage thumbnail = image;
+    if ((image.width() > size.width()) || (image.height() > size.height())) {
+        thumbnail =
+            image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    putThumbnailIntoCache(thumbnailKey(dataHash, size), thumbnail);
+}
+
+void ResourceThumbnailCache::removeThumbnails(const QByteArray & dataHash)
+{
+    const QString keyPrefix = thumbnailKeyPrefix(dataHash);
+
+    auto & data = thumbnailCacheData();
+    QMutexLocker locker(&data.m_mutex);
+
+    const auto keys = data.m_cache.keys();
+    for (const auto & key: keys) {
+        if (key.startsWith(keyPrefix)) {
+            Q_UNUSED(data.m_cache.remove(key))
+        }
+    }
+}
+
+void ResourceThumbnailCache::clear()
+{
+    auto & data = thumbnailCacheData();
+    QMutexLocker locker(&data.m_mutex);
+    data.m_cache.clear();
+}
+
+void ResourceThumbnailCache::setMaxCacheSize(const int maxCacheSize)
+{
+    auto & data = thumbnailCacheData();
+    QMutexLocker locker(&data.m_mutex);
+    data.m_cache.setMaxCost(maxCacheSize);
+}
+
+int ResourceThumbnailCache::maxCacheSize()
+{
+    auto & data = thumbnailCacheData();
+    QMutexLocker locker(&data.m_mutex);
+    return data.m_cache.maxCost();
+}
+
+} // namespace quentier
@@ -33,6 +33,10 @@ SpellChecker::SpellChecker(
 {
     QObject::connect(
         d_ptr, &SpellCheckerPrivate::ready, this, &SpellChecker::ready);
+
+    QObject::connect(
+        d_ptr, &SpellCheckerPrivate::checkSpellBatchFinished, this,
+        &SpellChecker::checkSpellBatchFinished);
 }
 
 QVector<std::pair<QString, bool>> SpellChecker::listAvailableDictionaries()
@@ -66,6 +70,12 @@ bool SpellChecker::checkSpell(const QString & word) const
     return d->checkSpell(word);
 }
 
+QUuid SpellChecker::checkSpellBatch(const QStringList & words)
+{
+    Q_D(SpellChecker);
+    return d->checkSpellBatch(words);
+}
+
 QStringList SpellChecker::spellCorrectionSuggestions(
     const QString & misSpelledWord) const
 {
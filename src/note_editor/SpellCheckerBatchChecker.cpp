@@ -0,0 +1,70 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpellCheckerBatchChecker.h"
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Compat.h>
+
+namespace quentier {
+
+SpellCheckerBatchChecker::SpellCheckerBatchChecker(
+    QStringList words, CheckFunction checkFunction,
+    std::shared_ptr<QAtomicInt> pStopFlag, const QUuid & requestId,
+    const quint64 generation, QObject * parent) :
+    QObject(parent),
+    m_words(std::move(words)), m_checkFunction(std::move(checkFunction)),
+    m_pStopFlag(std::move(pStopFlag)), m_requestId(requestId),
+    m_generation(generation)
+{}
+
+void SpellCheckerBatchChecker::run()
+{
+    QNDEBUG(
+        "note_editor",
+        "SpellCheckerBatchChecker::run: request id = "
+            << m_requestId << ", " << m_words.size() << " words");
+
+    QStringList correctWords;
+    QStringList misSpelledWords;
+
+    for (const auto & word: qAsConst(m_words)) {
+        if (m_pStopFlag && (m_pStopFlag->loadAcquire() != 0)) {
+            QNDEBUG(
+                "note_editor",
+                "Aborting the operation as stop flag is non-zero");
+            return;
+        }
+
+        if (m_checkFunction(word)) {
+            correctWords << word;
+        }
+        else {
+            misSpelledWords << word;
+        }
+    }
+
+    QNDEBUG(
+        "note_editor",
+        "Finished checking words for request " << m_requestId << ": "
+            << misSpelledWords.size() << " misspelled words");
+
+    Q_EMIT finished(m_requestId, m_generation, correctWords, misSpelledWords);
+}
+
+} // namespace quentier
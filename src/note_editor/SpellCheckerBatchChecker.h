@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_NOTE_EDITOR_SPELL_CHECKER_BATCH_CHECKER_H
+#define LIB_QUENTIER_NOTE_EDITOR_SPELL_CHECKER_BATCH_CHECKER_H
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QRunnable>
+#include <QStringList>
+#include <QUuid>
+
+#include <functional>
+#include <memory>
+
+namespace quentier {
+
+/**
+ * @brief The SpellCheckerBatchChecker class checks the spelling of a list of
+ * words on a thread pool's thread using the passed in check function
+ */
+class Q_DECL_HIDDEN SpellCheckerBatchChecker final :
+    public QObject,
+    public QRunnable
+{
+    Q_OBJECT
+public:
+    using CheckFunction = std::function<bool(const QString &)>;
+
+public:
+    SpellCheckerBatchChecker(
+        QStringList words, CheckFunction checkFunction,
+        std::shared_ptr<QAtomicInt> pStopFlag, const QUuid & requestId,
+        const quint64 generation, QObject * parent = nullptr);
+
+    virtual void run() override;
+
+Q_SIGNALS:
+    void finished(
+        QUuid requestId, quint64 generation, QStringList correctWords,
+        QStringList misSpelledWords);
+
+private:
+    QStringList m_words;
+    CheckFunction m_checkFunction;
+    std::shared_ptr<QAtomicInt> m_pStopFlag;
+    QUuid m_requestId;
+    quint64 m_generation;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_NOTE_EDITOR_SPELL_CHECKER_BATCH_CHECKER_H
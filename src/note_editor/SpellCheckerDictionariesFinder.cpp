@@ -19,134 +19,368 @@
 #include "SpellCheckerDictionariesFinder.h"
 
 #include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/ApplicationSettings.h>
+#include <quentier/utility/Compat.h>
 
-#include <QDirIterator>
+#include <QDateTime>
+#include <QDir>
 #include <QFileInfo>
-#include <QStringList>
+#include <QStandardPaths>
+
+#define SPELL_CHECKER_DICTIONARIES_INDEX_SETTINGS_NAME                         \
+    QStringLiteral("SpellCheckerDictionariesIndex")
+
+#define SPELL_CHECKER_DICTIONARIES_INDEX_DIRS_ARRAY                            \
+    QStringLiteral("Directories")
+
+#define SPELL_CHECKER_DICTIONARIES_INDEX_DIR_PATH_KEY QStringLiteral("Path")
+
+#define SPELL_CHECKER_DICTIONARIES_INDEX_DIR_LAST_MODIFIED_KEY                 \
+    QStringLiteral("LastModified")
+
+#define SPELL_CHECKER_DICTIONARIES_INDEX_DIR_DIC_FILES_KEY                     \
+    QStringLiteral("DicFiles")
+
+#define SPELL_CHECKER_DICTIONARIES_INDEX_DIR_AFF_FILES_KEY                     \
+    QStringLiteral("AffFiles")
+
+#define SPELL_CHECKER_DICTIONARIES_INDEX_DIR_SUBDIRS_KEY                       \
+    QStringLiteral("Subdirs")
+
+#define SPELL_CHECKER_SETTINGS_GROUP QStringLiteral("SpellCheck")
+
+#define SPELL_CHECKER_EXTRA_DICTIONARY_PATHS_KEY                               \
+    QStringLiteral("ExtraDictionaryPaths")
+
+// Dictionaries are sometimes put into subdirectories of well-known locations
+// (i.e. /usr/share/myspell/dicts) but never too deep
+#define SPELL_CHECKER_DICTIONARIES_MAX_SCAN_DEPTH (3)
 
 namespace quentier {
 
 #define WRAP(x) << QStringLiteral(x).toUpper()
 
 SpellCheckerDictionariesFinder::SpellCheckerDictionariesFinder(
-    std::shared_ptr<QAtomicInt> pStopFlag, QObject * parent) :
+    std::shared_ptr<QAtomicInt> pStopFlag, QStringList dictionaryDirPaths,
+    QObject * parent) :
     QObject(parent),
-    m_pStopFlag(std::move(pStopFlag)), m_files(), m_localeList(QSet<QString>()
+    m_pStopFlag(std::move(pStopFlag)),
+    m_dictionaryDirPaths(std::move(dictionaryDirPaths)), m_files(),
+    m_localeList(QSet<QString>()
 #include "localeList.inl"
-                                                  )
+    )
 {}
 
 #undef WRAP
 
+#define CHECK_AND_STOP(...)                                                    \
+    if (m_pStopFlag && (m_pStopFlag->loadAcquire() != 0)) {                    \
+        QNDEBUG(                                                               \
+            "note_editor",                                                     \
+            "Aborting the operation as stop flag is "                          \
+                << "non-zero");                                                \
+        return __VA_ARGS__;                                                    \
+    }
+
 void SpellCheckerDictionariesFinder::run()
 {
     QNDEBUG("note_editor", "SpellCheckerDictionariesFinder::run");
 
     m_files.clear();
-    QStringList fileFilters;
-    fileFilters << QStringLiteral("*.dic") << QStringLiteral("*.aff");
+    m_numListedDirs = 0;
+    m_numIndexedDirs = 0;
 
-#define CHECK_AND_STOP()                                                       \
-    if (m_pStopFlag && (m_pStopFlag->loadAcquire() != 0)) {                    \
-        QNDEBUG(                                                               \
-            "note_editor",                                                     \
-            "Aborting the operation as stop flag is "                          \
-                << "non-zero");                                                \
-        return;                                                                \
+    if (m_dictionaryDirPaths.isEmpty()) {
+        m_dictionaryDirPaths = defaultDictionaryDirPaths();
     }
 
-    QFileInfoList rootDirs = QDir::drives();
-    const int numRootDirs = rootDirs.size();
-    for (int i = 0; i < numRootDirs; ++i) {
+    DirEntries oldIndex;
+    readIndex(oldIndex);
+
+    DirEntries newIndex;
+    newIndex.reserve(oldIndex.size());
+
+    for (const auto & dictionaryDirPath: qAsConst(m_dictionaryDirPaths)) {
         CHECK_AND_STOP()
 
-        const QFileInfo & rootDirInfo = rootDirs[i];
+        QString dirPath =
+            QDir::cleanPath(QDir(dictionaryDirPath).absolutePath());
+
+        if (!scanDir(dirPath, 0, oldIndex, newIndex)) {
+            return;
+        }
+    }
+
+    CHECK_AND_STOP()
+    writeIndex(newIndex);
+
+    QNDEBUG(
+        "note_editor",
+        "Found " << m_files.size() << " valid dictionaries; listed "
+                 << m_numListedDirs << " directories, took "
+                 << m_numIndexedDirs << " directories from the index");
+
+    Q_EMIT foundDictionaries(m_files);
+}
+
+QStringList SpellCheckerDictionariesFinder::defaultDictionaryDirPaths()
+{
+    QStringList paths;
+
+    // Paths explicitly configured by the user go first so that dictionaries
+    // from them take precedence over the ones found in standard locations
+    ApplicationSettings settings;
+    settings.beginGroup(SPELL_CHECKER_SETTINGS_GROUP);
+
+    QStringList extraPaths =
+        settings.value(SPELL_CHECKER_EXTRA_DICTIONARY_PATHS_KEY).toStringList();
+
+    settings.endGroup();
+
+    for (const auto & extraPath: qAsConst(extraPaths)) {
+        paths << QDir::fromNativeSeparators(extraPath);
+    }
+
+#ifdef Q_OS_MAC
+    paths << QStringLiteral("/Library/Spelling")
+          << (QDir::homePath() + QStringLiteral("/Library/Spelling"));
+#endif
+
+#ifndef Q_OS_WIN
+    paths << QStringLiteral("/usr/share/hunspell")
+          << QStringLiteral("/usr/share/myspell")
+          << QStringLiteral("/usr/local/share/hunspell")
+          << QStringLiteral("/usr/local/share/myspell");
+#endif
+
+    QStringList dataLocations =
+        QStandardPaths::standardLocations(QStandardPaths::GenericDataLocation);
+
+    for (const auto & dataLocation: qAsConst(dataLocations)) {
+        paths << (dataLocation + QStringLiteral("/hunspell"));
+    }
+
+    QStringList result;
+    result.reserve(paths.size());
+    for (const auto & path: qAsConst(paths)) {
+        QString cleanPath = QDir::cleanPath(path);
+        if (!result.contains(cleanPath)) {
+            result << cleanPath;
+        }
+    }
+
+    return result;
+}
+
+void SpellCheckerDictionariesFinder::clearDictionariesIndex()
+{
+    QNDEBUG(
+        "note_editor",
+        "SpellCheckerDictionariesFinder::clearDictionariesIndex");
+
+    ApplicationSettings settings(
+        SPELL_CHECKER_DICTIONARIES_INDEX_SETTINGS_NAME);
+
+    settings.clear();
+    settings.sync();
+}
+
+void SpellCheckerDictionariesFinder::readIndex(DirEntries & index) const
+{
+    ApplicationSettings settings(
+        SPELL_CHECKER_DICTIONARIES_INDEX_SETTINGS_NAME);
+
+    int size =
+        settings.beginReadArray(SPELL_CHECKER_DICTIONARIES_INDEX_DIRS_ARRAY);
+
+    index.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        settings.setArrayIndex(i);
 
-        if (Q_UNLIKELY(!rootDirInfo.isDir())) {
+        QString path =
+            settings.value(SPELL_CHECKER_DICTIONARIES_INDEX_DIR_PATH_KEY)
+                .toString();
+
+        if (path.isEmpty()) {
+            continue;
+        }
+
+        DirEntry & entry = index[path];
+
+        entry.m_lastModified =
+            settings
+                .value(SPELL_CHECKER_DICTIONARIES_INDEX_DIR_LAST_MODIFIED_KEY)
+                .toLongLong();
+
+        entry.m_dicFiles =
+            settings.value(SPELL_CHECKER_DICTIONARIES_INDEX_DIR_DIC_FILES_KEY)
+                .toStringList();
+
+        entry.m_affFiles =
+            settings.value(SPELL_CHECKER_DICTIONARIES_INDEX_DIR_AFF_FILES_KEY)
+                .toStringList();
+
+        entry.m_subdirs =
+            settings.value(SPELL_CHECKER_DICTIONARIES_INDEX_DIR_SUBDIRS_KEY)
+                .toStringList();
+    }
+
+    settings.endArray();
+
+    QNTRACE(
+        "note_editor",
+        "Read " << index.size() << " entries from dictionaries index");
+}
+
+void SpellCheckerDictionariesFinder::writeIndex(const DirEntries & index) const
+{
+    ApplicationSettings settings(
+        SPELL_CHECKER_DICTIONARIES_INDEX_SETTINGS_NAME);
+
+    settings.remove(SPELL_CHECKER_DICTIONARIES_INDEX_DIRS_ARRAY);
+    settings.beginWriteArray(SPELL_CHECKER_DICTIONARIES_INDEX_DIRS_ARRAY);
+
+    int arrayIndex = 0;
+    for (auto it = index.constBegin(), end = index.constEnd(); it != end; ++it)
+    {
+        settings.setArrayIndex(arrayIndex);
+
+        const DirEntry & entry = it.value();
+
+        settings.setValue(
+            SPELL_CHECKER_DICTIONARIES_INDEX_DIR_PATH_KEY, it.key());
+
+        settings.setValue(
+            SPELL_CHECKER_DICTIONARIES_INDEX_DIR_LAST_MODIFIED_KEY,
+            entry.m_lastModified);
+
+        settings.setValue(
+            SPELL_CHECKER_DICTIONARIES_INDEX_DIR_DIC_FILES_KEY,
+            entry.m_dicFiles);
+
+        settings.setValue(
+            SPELL_CHECKER_DICTIONARIES_INDEX_DIR_AFF_FILES_KEY,
+            entry.m_affFiles);
+
+        settings.setValue(
+            SPELL_CHECKER_DICTIONARIES_INDEX_DIR_SUBDIRS_KEY, entry.m_subdirs);
+
+        ++arrayIndex;
+    }
+
+    settings.endArray();
+    settings.sync();
+}
+
+bool SpellCheckerDictionariesFinder::scanDir(
+    const QString & dirPath, const int depth, const DirEntries & oldIndex,
+    DirEntries & newIndex)
+{
+    CHECK_AND_STOP(false)
+
+    if (newIndex.contains(dirPath)) {
+        QNTRACE("note_editor", "Already scanned dir " << dirPath);
+        return true;
+    }
+
+    QFileInfo dirInfo(dirPath);
+    if (!dirInfo.exists() || !dirInfo.isDir() || !dirInfo.isReadable()) {
+        QNTRACE(
+            "note_editor",
+            "Skipping non-existing or unreadable dir " << dirPath);
+        return true;
+    }
+
+    const qint64 lastModified = dirInfo.lastModified().toMSecsSinceEpoch();
+
+    DirEntry entry;
+    auto oldIt = oldIndex.constFind(dirPath);
+    if ((oldIt != oldIndex.constEnd()) &&
+        (oldIt.value().m_lastModified == lastModified))
+    {
+        QNTRACE("note_editor", "Dir " << dirPath << " is unchanged");
+        entry = oldIt.value();
+        ++m_numIndexedDirs;
+    }
+    else {
+        QNTRACE("note_editor", "Listing dir " << dirPath);
+
+        QDir dir(dirPath);
+        entry.m_lastModified = lastModified;
+
+        entry.m_dicFiles = dir.entryList(
+            QStringList() << QStringLiteral("*.dic"),
+            QDir::Files | QDir::Readable, QDir::Name);
+
+        entry.m_affFiles = dir.entryList(
+            QStringList() << QStringLiteral("*.aff"),
+            QDir::Files | QDir::Readable, QDir::Name);
+
+        entry.m_subdirs = dir.entryList(
+            QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable, QDir::Name);
+
+        ++m_numListedDirs;
+    }
+
+    newIndex[dirPath] = entry;
+
+    for (const auto & dicFile: qAsConst(entry.m_dicFiles)) {
+        QString dictionaryName = QFileInfo(dicFile).baseName();
+
+        if (m_files.contains(dictionaryName)) {
             QNTRACE(
                 "note_editor",
-                "Skipping non-dir " << rootDirInfo.absoluteDir());
+                "Dictionary " << dictionaryName << " was already found "
+                              << "in another location, skipping "
+                              << dirPath);
             continue;
         }
 
-        QDirIterator it(
-            rootDirInfo.absolutePath(), fileFilters, QDir::Files,
-            QDirIterator::Subdirectories);
-
-        while (it.hasNext()) {
-            CHECK_AND_STOP()
-
-            QString nextDirName = it.next();
-            QNTRACE("note_editor", "Next dir name = " << nextDirName);
-
-            QFileInfo fileInfo = it.fileInfo();
-            if (!fileInfo.isReadable()) {
-                QNTRACE(
-                    "note_editor",
-                    "Skipping non-readable file "
-                        << fileInfo.absoluteFilePath());
-                continue;
-            }
-
-            QString fileNameSuffix = fileInfo.completeSuffix();
-            bool isDicFile = false;
-            if (fileNameSuffix == QStringLiteral("dic")) {
-                isDicFile = true;
-            }
-            else if (fileNameSuffix != QStringLiteral("aff")) {
-                QNTRACE(
-                    "note_editor",
-                    "Skipping file not actually matching "
-                        << "the filter: " << fileInfo.absoluteFilePath());
-                continue;
-            }
-
-            QString dictionaryName = fileInfo.baseName();
-            if (!m_localeList.contains(dictionaryName.toUpper())) {
-                QNTRACE(
-                    "note_editor",
-                    "Skipping dictionary which doesn't "
-                        << "appear to correspond to any locale: "
-                        << dictionaryName);
-                continue;
-            }
-
-            auto & pair = m_files[dictionaryName];
-            if (isDicFile) {
-                QNTRACE(
-                    "note_editor",
-                    "Adding dic file " << fileInfo.absoluteFilePath());
-                pair.first = fileInfo.absoluteFilePath();
-            }
-            else {
-                QNTRACE(
-                    "note_editor",
-                    "Adding aff file " << fileInfo.absoluteFilePath());
-                pair.second = fileInfo.absoluteFilePath();
-            }
+        if (!m_localeList.contains(dictionaryName.toUpper())) {
+            QNTRACE(
+                "note_editor",
+                "Skipping dictionary which doesn't "
+                    << "appear to correspond to any locale: "
+                    << dictionaryName);
+            continue;
         }
-    }
 
-    // Filter out any incomplete pair of dic & aff files
-    for (auto it = m_files.begin(); it != m_files.end();) {
-        CHECK_AND_STOP()
-
-        const auto & pair = it.value();
-        if (pair.first.isEmpty() || pair.second.isEmpty()) {
+        QString affFile = dictionaryName + QStringLiteral(".aff");
+        if (!entry.m_affFiles.contains(affFile)) {
             QNTRACE(
                 "note_editor",
-                "Skipping the incomplete pair of dic/aff "
-                    << "files: dic file path = " << pair.first
-                    << "; aff file path = " << pair.second);
-            it = m_files.erase(it);
+                "Skipping the incomplete pair of dic/aff files: dic file "
+                    << dicFile << " has no matching aff file in "
+                    << dirPath);
             continue;
         }
 
-        ++it;
+        auto & pair = m_files[dictionaryName];
+        pair.first = dirPath + QStringLiteral("/") + dicFile;
+        pair.second = dirPath + QStringLiteral("/") + affFile;
+
+        QNTRACE(
+            "note_editor",
+            "Adding dic file " << pair.first << " and aff file "
+                               << pair.second);
     }
 
-    QNDEBUG("note_editor", "Found " << m_files.size() << " valid dictionaries");
-    Q_EMIT foundDictionaries(m_files);
+    if (depth >= SPELL_CHECKER_DICTIONARIES_MAX_SCAN_DEPTH) {
+        return true;
+    }
+
+    for (const auto & subdir: qAsConst(entry.m_subdirs)) {
+        if (!scanDir(
+                dirPath + QStringLiteral("/") + subdir, depth + 1, oldIndex,
+                newIndex))
+        {
+            return false;
+        }
+    }
+
+    return true;
 }
 
+#undef CHECK_AND_STOP
+
 } // namespace quentier
@@ -25,11 +25,24 @@
 #include <QRunnable>
 #include <QSet>
 #include <QString>
+#include <QStringList>
 
 #include <memory>
 
 namespace quentier {
 
+/**
+ * @brief The SpellCheckerDictionariesFinder class looks for pairs of hunspell
+ * dic and aff files within a limited set of directories: the well-known
+ * hunspell/myspell locations plus extra paths which can be configured via
+ * application settings.
+ *
+ * The results of the scan are persisted in a dictionaries index along with
+ * the last modification time of each scanned directory. On subsequent runs
+ * only the directories which modification time has changed since the previous
+ * scan are listed again, the contents of all the other ones are taken from
+ * the index.
+ */
 class Q_DECL_HIDDEN SpellCheckerDictionariesFinder final :
     public QObject,
     public QRunnable
@@ -40,19 +53,64 @@ public:
         QHash<QString, std::pair<QString, QString>>;
 
 public:
+    /**
+     * @param pStopFlag             Shared flag which, once set to non-zero,
+     *                              tells the finder to abort the scan
+     * @param dictionaryDirPaths    Directories to look for dictionaries in;
+     *                              if empty, the list returned by
+     *                              defaultDictionaryDirPaths is used
+     * @param parent                Parent QObject
+     */
     SpellCheckerDictionariesFinder(
-        std::shared_ptr<QAtomicInt> pStopFlag, QObject * parent = nullptr);
+        std::shared_ptr<QAtomicInt> pStopFlag,
+        QStringList dictionaryDirPaths = {}, QObject * parent = nullptr);
 
     virtual void run() override;
 
+    /**
+     * @return      The list of well-known hunspell dictionaries locations
+     *              for the current platform followed by extra paths specified
+     *              under ExtraDictionaryPaths key within SpellCheck group of
+     *              application settings
+     */
+    static QStringList defaultDictionaryDirPaths();
+
+    /**
+     * Removes the persistent dictionaries index so that the next run of any
+     * finder would list all the directories it inspects
+     */
+    static void clearDictionariesIndex();
+
 Q_SIGNALS:
     void foundDictionaries(
         DicAndAffFilesByDictionaryName docAndAffFilesByDictionaryName);
 
+private:
+    struct DirEntry
+    {
+        qint64 m_lastModified = 0;
+        QStringList m_dicFiles;
+        QStringList m_affFiles;
+        QStringList m_subdirs;
+    };
+
+    using DirEntries = QHash<QString, DirEntry>;
+
+    void readIndex(DirEntries & index) const;
+    void writeIndex(const DirEntries & index) const;
+
+    bool scanDir(
+        const QString & dirPath, const int depth, const DirEntries & oldIndex,
+        DirEntries & newIndex);
+
 private:
     std::shared_ptr<QAtomicInt> m_pStopFlag;
+    QStringList m_dictionaryDirPaths;
     DicAndAffFilesByDictionaryName m_files;
     const QSet<QString> m_localeList;
+
+    int m_numListedDirs = 0;
+    int m_numIndexedDirs = 0;
 };
 
 } // namespace quentier
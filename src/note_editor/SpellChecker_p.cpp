@@ -17,6 +17,7 @@
  */
 
 #include "SpellChecker_p.h"
+#include "SpellCheckerBatchChecker.h"
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/ApplicationSettings.h>
@@ -31,6 +32,8 @@
 #include <QDirIterator>
 #include <QFileInfo>
 #include <QLocale>
+#include <QMutexLocker>
+#include <QSet>
 #include <QThreadPool>
 
 #include <hunspell/hunspell.hxx>
@@ -52,6 +55,8 @@
 #define SPELL_CHECKER_ENABLED_SYSTEM_DICTIONARIES_KEY                          \
     QStringLiteral("EnabledSystemDictionaries")
 
+#define SPELL_CHECKER_CHECKED_WORDS_CACHE_SIZE (20000)
+
 namespace quentier {
 
 SpellCheckerPrivate::SpellCheckerPrivate(
@@ -59,7 +64,9 @@ SpellCheckerPrivate::SpellCheckerPrivate(
     QObject * parent, const QString & userDictionaryPath) :
     QObject(parent),
     m_pFileIOProcessorAsync(pFileIOProcessorAsync), m_currentAccount(account),
-    m_pDictionariesFinderStopFlag(new QAtomicInt)
+    m_pDictionariesFinderStopFlag(new QAtomicInt),
+    m_pHunspellMutex(std::make_shared<QMutex>()),
+    m_checkedWordsCache(SPELL_CHECKER_CHECKED_WORDS_CACHE_SIZE)
 {
     initializeUserDictionary(userDictionaryPath);
     checkAndScanSystemDictionaries();
@@ -93,6 +100,7 @@ void SpellCheckerPrivate::setAccount(const Account & account)
 
     m_currentAccount = account;
     restoreSystemDictionatiesEnabledDisabledSettings();
+    invalidateCheckedWordsCache();
 }
 
 void SpellCheckerPrivate::enableDictionary(const QString & language)
@@ -112,6 +120,7 @@ void SpellCheckerPrivate::enableDictionary(const QString & language)
 
     it.value().m_enabled = true;
     persistEnabledSystemDictionaries();
+    invalidateCheckedWordsCache();
 }
 
 void SpellCheckerPrivate::disableDictionary(const QString & language)
@@ -131,12 +140,61 @@ void SpellCheckerPrivate::disableDictionary(const QString & language)
 
     it.value().m_enabled = false;
     persistEnabledSystemDictionaries();
+    invalidateCheckedWordsCache();
 }
 
 bool SpellCheckerPrivate::checkSpell(const QString & word) const
 {
     QNDEBUG("note_editor", "SpellCheckerPrivate::checkSpell: " << word);
 
+    const bool * pCachedResult = m_checkedWordsCache.get(word);
+    if (pCachedResult) {
+        QNTRACE(
+            "note_editor",
+            "Found cached result for word " << word << ": "
+                                            << (*pCachedResult ? "correct"
+                                                               : "misspelled"));
+        return *pCachedResult;
+    }
+
+    bool res = checkSpellImpl(word);
+    m_checkedWordsCache.put(word, res);
+    return res;
+}
+
+QUuid SpellCheckerPrivate::checkSpellBatch(const QStringList & words)
+{
+    QNDEBUG(
+        "note_editor",
+        "SpellCheckerPrivate::checkSpellBatch: " << words.size() << " words");
+
+    QUuid requestId = QUuid::createUuid();
+    auto & batchWords = m_checkSpellBatchWordsByRequestId[requestId];
+
+    QSet<QString> uniqueWords;
+    uniqueWords.reserve(words.size());
+    batchWords.reserve(words.size());
+
+    for (const auto & word: qAsConst(words)) {
+        if (word.isEmpty() || uniqueWords.contains(word)) {
+            continue;
+        }
+
+        Q_UNUSED(uniqueWords.insert(word))
+        batchWords << word;
+    }
+
+    QNTRACE(
+        "note_editor",
+        "Request id = " << requestId << ", " << batchWords.size()
+                        << " unique words");
+
+    startCheckSpellBatch(requestId);
+    return requestId;
+}
+
+bool SpellCheckerPrivate::checkSpellImpl(const QString & word) const
+{
     if (m_userDictionary.contains(word, Qt::CaseInsensitive)) {
         return true;
     }
@@ -144,6 +202,8 @@ bool SpellCheckerPrivate::checkSpell(const QString & word) const
     QByteArray wordData = word.toUtf8();
     QByteArray lowerWordData = word.toLower().toUtf8();
 
+    QMutexLocker locker(m_pHunspellMutex.get());
+
     for (const auto it: qevercloud::toRange(m_systemDictionaries)) {
         const Dictionary & dictionary = it.value();
 
@@ -185,6 +245,8 @@ QStringList SpellCheckerPrivate::spellCorrectionSuggestions(
 
     QByteArray wordData = misSpelledWord.toUtf8();
 
+    QMutexLocker locker(m_pHunspellMutex.get());
+
     QStringList result;
     for (const auto it: qevercloud::toRange(m_systemDictionaries)) {
         const Dictionary & dictionary = it.value();
@@ -229,7 +291,7 @@ void SpellCheckerPrivate::removeFromUserWordList(const QString & word)
 
     QObject::connect(
         this, &SpellCheckerPrivate::writeFile, m_pFileIOProcessorAsync,
-        &FileIOProcessorAsync::onWriteFileRequest);
+        &FileIOProcessorAsync::onPrioritizedWriteFileRequest);
 
     QObject::connect(
         m_pFileIOProcessorAsync,
@@ -240,7 +302,7 @@ void SpellCheckerPrivate::removeFromUserWordList(const QString & word)
 
     Q_EMIT writeFile(
         m_userDictionaryPath, dataToWrite, m_updateUserDictionaryFileRequestId,
-        /* append = */ false);
+        /* append = */ false, FileIOProcessorAsync::Priority::Background);
 
     QNTRACE(
         "note_editor",
@@ -252,7 +314,10 @@ void SpellCheckerPrivate::ignoreWord(const QString & word)
 {
     QNDEBUG("note_editor", "SpellCheckerPrivate::ignoreWord: " << word);
 
+    invalidateCheckedWordsCache();
+
     QByteArray wordData = word.toUtf8();
+    QMutexLocker locker(m_pHunspellMutex.get());
 
     for (const auto it: qevercloud::toRange(m_systemDictionaries)) {
         Dictionary & dictionary = it.value();
@@ -269,7 +334,10 @@ void SpellCheckerPrivate::removeWord(const QString & word)
 {
     QNDEBUG("note_editor", "SpellCheckerPrivate::removeWord: " << word);
 
+    invalidateCheckedWordsCache();
+
     QByteArray wordData = word.toUtf8();
+    QMutexLocker locker(m_pHunspellMutex.get());
 
     for (const auto it: qevercloud::toRange(m_systemDictionaries)) {
         Dictionary & dictionary = it.value();
@@ -312,6 +380,7 @@ void SpellCheckerPrivate::onDictionariesFound(
     }
 
     restoreSystemDictionatiesEnabledDisabledSettings();
+    invalidateCheckedWordsCache();
 
     ApplicationSettings settings;
     settings.beginGroup(SPELL_CHECKER_FOUND_DICTIONARIES_GROUP);
@@ -698,9 +767,8 @@ void SpellCheckerPrivate::scanSystemDictionaries()
     QNDEBUG(
         "note_editor",
         "Still can't find any valid hunspell dictionaries, "
-            << "trying the full recursive search across the entire system, "
-               "just to "
-            << "find something");
+            << "trying the indexed search across well-known dictionaries "
+            << "locations and extra paths from the application settings");
 
     auto * pFinder =
         new SpellCheckerDictionariesFinder(m_pDictionariesFinderStopFlag);
@@ -770,6 +838,7 @@ void SpellCheckerPrivate::addSystemDictionary(
     dictionary.m_hunspellWrapper.initialize(affixFilePath, dictionaryFilePath);
     dictionary.m_dictionaryPath = dictionaryFilePath;
     dictionary.m_enabled = true;
+    invalidateCheckedWordsCache();
     QNTRACE(
         "note_editor",
         "Added dictionary for language " << name << "; dictionary file "
@@ -873,7 +942,7 @@ void SpellCheckerPrivate::initializeUserDictionary(
 
         QObject::connect(
             this, &SpellCheckerPrivate::readFile, m_pFileIOProcessorAsync,
-            &FileIOProcessorAsync::onReadFileRequest);
+            &FileIOProcessorAsync::onPrioritizedReadFileRequest);
 
         QObject::connect(
             m_pFileIOProcessorAsync,
@@ -881,7 +950,9 @@ void SpellCheckerPrivate::initializeUserDictionary(
             &SpellCheckerPrivate::onReadFileRequestProcessed);
 
         m_readUserDictionaryRequestId = QUuid::createUuid();
-        Q_EMIT readFile(m_userDictionaryPath, m_readUserDictionaryRequestId);
+        Q_EMIT readFile(
+            m_userDictionaryPath, m_readUserDictionaryRequestId,
+            FileIOProcessorAsync::Priority::Background);
         QNTRACE(
             "note_editor",
             "Sent the request to read the user dictionary "
@@ -964,7 +1035,7 @@ void SpellCheckerPrivate::checkUserDictionaryDataPendingWriting()
     if (!dataToWrite.isEmpty()) {
         QObject::connect(
             this, &SpellCheckerPrivate::writeFile, m_pFileIOProcessorAsync,
-            &FileIOProcessorAsync::onWriteFileRequest);
+            &FileIOProcessorAsync::onPrioritizedWriteFileRequest);
 
         QObject::connect(
             m_pFileIOProcessorAsync,
@@ -976,7 +1047,7 @@ void SpellCheckerPrivate::checkUserDictionaryDataPendingWriting()
         Q_EMIT writeFile(
             m_userDictionaryPath, dataToWrite,
             m_appendUserDictionaryPartToFileRequestId,
-            /* append = */ true);
+            /* append = */ true, FileIOProcessorAsync::Priority::Background);
 
         QNTRACE(
             "note_editor",
@@ -1102,7 +1173,7 @@ void SpellCheckerPrivate::onReadFileRequestProcessed(
 
     QObject::disconnect(
         this, &SpellCheckerPrivate::readFile, m_pFileIOProcessorAsync,
-        &FileIOProcessorAsync::onReadFileRequest);
+        &FileIOProcessorAsync::onPrioritizedReadFileRequest);
 
     QObject::disconnect(
         m_pFileIOProcessorAsync,
@@ -1135,6 +1206,8 @@ void SpellCheckerPrivate::onReadFileRequestProcessed(
         QNWARNING("note_editor", "Can't read the data from user's dictionary");
     }
 
+    invalidateCheckedWordsCache();
+
     m_userDictionaryReady = true;
     if (isReady()) {
         Q_EMIT ready();
@@ -1159,7 +1232,7 @@ void SpellCheckerPrivate::onWriteFileRequestProcessed(
     {
         QObject::disconnect(
             this, &SpellCheckerPrivate::writeFile, m_pFileIOProcessorAsync,
-            &FileIOProcessorAsync::onWriteFileRequest);
+            &FileIOProcessorAsync::onPrioritizedWriteFileRequest);
 
         QObject::disconnect(
             m_pFileIOProcessorAsync,
@@ -1168,6 +1241,164 @@ void SpellCheckerPrivate::onWriteFileRequestProcessed(
     }
 }
 
+void SpellCheckerPrivate::onCheckSpellBatchFinished(
+    QUuid requestId, quint64 generation, QStringList correctWords,
+    QStringList misSpelledWords)
+{
+    auto it = m_checkSpellBatchWordsByRequestId.find(requestId);
+    if (it == m_checkSpellBatchWordsByRequestId.end()) {
+        return;
+    }
+
+    QNDEBUG(
+        "note_editor",
+        "SpellCheckerPrivate::onCheckSpellBatchFinished: request id = "
+            << requestId << ", generation = " << generation
+            << ", checked " << (correctWords.size() + misSpelledWords.size())
+            << " words");
+
+    if (generation != m_checkedWordsCacheGeneration) {
+        QNDEBUG(
+            "note_editor",
+            "Words cache was invalidated while the batch was being "
+                << "checked, checking it again");
+        startCheckSpellBatch(requestId);
+        return;
+    }
+
+    for (const auto & word: qAsConst(correctWords)) {
+        m_checkedWordsCache.put(word, true);
+    }
+
+    for (const auto & word: qAsConst(misSpelledWords)) {
+        m_checkedWordsCache.put(word, false);
+    }
+
+    QSet<QString> checkedWords;
+    checkedWords.reserve(correctWords.size() + misSpelledWords.size());
+    for (const auto & word: qAsConst(correctWords)) {
+        Q_UNUSED(checkedWords.insert(word))
+    }
+
+    // Collect the full list of misspelled words of the batch including
+    // the ones which results were taken from the cache
+    QStringList batchMisSpelledWords = misSpelledWords;
+    for (const auto & word: qAsConst(misSpelledWords)) {
+        Q_UNUSED(checkedWords.insert(word))
+    }
+
+    for (const auto & word: qAsConst(it.value())) {
+        if (checkedWords.contains(word)) {
+            continue;
+        }
+
+        // NOTE: checkSpell would check the word once again if it has been
+        // evicted from the cache in the meantime
+        if (!checkSpell(word)) {
+            batchMisSpelledWords << word;
+        }
+    }
+
+    Q_UNUSED(m_checkSpellBatchWordsByRequestId.erase(it))
+    Q_EMIT checkSpellBatchFinished(requestId, batchMisSpelledWords);
+}
+
+void SpellCheckerPrivate::startCheckSpellBatch(const QUuid & requestId)
+{
+    QNDEBUG(
+        "note_editor",
+        "SpellCheckerPrivate::startCheckSpellBatch: request id = "
+            << requestId);
+
+    auto batchIt = m_checkSpellBatchWordsByRequestId.constFind(requestId);
+    if (Q_UNLIKELY(batchIt == m_checkSpellBatchWordsByRequestId.constEnd())) {
+        QNWARNING(
+            "note_editor",
+            "Can't find words for spell check batch with id " << requestId);
+        return;
+    }
+
+    QStringList wordsToCheck;
+    for (const auto & word: qAsConst(batchIt.value())) {
+        if (!m_checkedWordsCache.get(word)) {
+            wordsToCheck << word;
+        }
+    }
+
+    QNTRACE(
+        "note_editor",
+        wordsToCheck.size() << " words are not cached and need checking");
+
+    if (wordsToCheck.isEmpty()) {
+        // Everything is cached, still deliver the result asynchronously
+        // so that the caller is able to record the request id first
+        QMetaObject::invokeMethod(
+            this, "onCheckSpellBatchFinished", Qt::QueuedConnection,
+            Q_ARG(QUuid, requestId),
+            Q_ARG(quint64, m_checkedWordsCacheGeneration),
+            Q_ARG(QStringList, QStringList()),
+            Q_ARG(QStringList, QStringList()));
+        return;
+    }
+
+    QVector<HunspellWrapper> hunspellWrappers;
+    hunspellWrappers.reserve(m_systemDictionaries.size());
+    for (const auto it: qevercloud::toRange(m_systemDictionaries)) {
+        const Dictionary & dictionary = it.value();
+        if (!dictionary.isEmpty() && dictionary.m_enabled) {
+            hunspellWrappers << dictionary.m_hunspellWrapper;
+        }
+    }
+
+    QSet<QString> userWords;
+    userWords.reserve(m_userDictionary.size());
+    for (const auto & userWord: qAsConst(m_userDictionary)) {
+        Q_UNUSED(userWords.insert(userWord.toLower()))
+    }
+
+    auto pHunspellMutex = m_pHunspellMutex;
+
+    auto checkFunction = [hunspellWrappers, userWords, pHunspellMutex](
+                             const QString & word) -> bool {
+        QString lowerWord = word.toLower();
+        if (userWords.contains(lowerWord)) {
+            return true;
+        }
+
+        QByteArray wordData = word.toUtf8();
+        QByteArray lowerWordData = lowerWord.toUtf8();
+
+        QMutexLocker locker(pHunspellMutex.get());
+        for (const auto & hunspellWrapper: qAsConst(hunspellWrappers)) {
+            if (hunspellWrapper.spell(wordData) ||
+                hunspellWrapper.spell(lowerWordData))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    auto * pChecker = new SpellCheckerBatchChecker(
+        wordsToCheck, checkFunction, m_pDictionariesFinderStopFlag, requestId,
+        m_checkedWordsCacheGeneration);
+
+    QObject::connect(
+        pChecker, &SpellCheckerBatchChecker::finished, this,
+        &SpellCheckerPrivate::onCheckSpellBatchFinished, Qt::QueuedConnection);
+
+    QThreadPool::globalInstance()->start(pChecker);
+}
+
+void SpellCheckerPrivate::invalidateCheckedWordsCache()
+{
+    QNTRACE("note_editor", "SpellCheckerPrivate::invalidateCheckedWordsCache");
+
+    m_checkedWordsCache.clear();
+    ++m_checkedWordsCacheGeneration;
+}
+
 void SpellCheckerPrivate::onAppendUserDictionaryPartDone(
     bool success, ErrorString errorDescription)
 {
@@ -23,9 +23,12 @@
 
 #include <quentier/types/Account.h>
 #include <quentier/types/ErrorString.h>
+#include <quentier/utility/FileIOProcessorAsync.h>
+#include <quentier/utility/LRUCache.hpp>
 
 #include <QAtomicInt>
 #include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QStringList>
 #include <QUuid>
@@ -38,8 +41,6 @@ QT_FORWARD_DECLARE_CLASS(Hunspell)
 
 namespace quentier {
 
-QT_FORWARD_DECLARE_CLASS(FileIOProcessorAsync)
-
 class Q_DECL_HIDDEN SpellCheckerPrivate final : public QObject
 {
     Q_OBJECT
@@ -61,6 +62,8 @@ public:
 
     bool checkSpell(const QString & word) const;
 
+    QUuid checkSpellBatch(const QStringList & words);
+
     QStringList spellCorrectionSuggestions(
         const QString & misSpelledWord) const;
 
@@ -74,12 +77,16 @@ public:
 Q_SIGNALS:
     void ready();
 
+    void checkSpellBatchFinished(QUuid requestId, QStringList misSpelledWords);
+
     // private signals
-    void readFile(QString absoluteFilePath, QUuid requestId);
+    void readFile(
+        QString absoluteFilePath, QUuid requestId,
+        FileIOProcessorAsync::Priority priority);
 
     void writeFile(
         QString absoluteFilePath, QByteArray data, QUuid requestId,
-        bool append);
+        bool append, FileIOProcessorAsync::Priority priority);
 
 private Q_SLOTS:
     void onDictionariesFound(
@@ -111,6 +118,16 @@ private Q_SLOTS:
     void onWriteFileRequestProcessed(
         bool success, ErrorString errorDescription, QUuid requestId);
 
+    void onCheckSpellBatchFinished(
+        QUuid requestId, quint64 generation, QStringList correctWords,
+        QStringList misSpelledWords);
+
+private:
+    bool checkSpellImpl(const QString & word) const;
+
+    void startCheckSpellBatch(const QUuid & requestId);
+    void invalidateCheckedWordsCache();
+
 private:
     class Q_DECL_HIDDEN HunspellWrapper
     {
@@ -169,6 +186,19 @@ private:
     QUuid m_appendUserDictionaryPartToFileRequestId;
 
     QUuid m_updateUserDictionaryFileRequestId;
+
+    // Guards all Hunspell instances as words from batches are checked
+    // on thread pool's threads
+    std::shared_ptr<QMutex> m_pHunspellMutex;
+
+    // Memoized results of words spelling checks; the generation is bumped
+    // each time the cache is invalidated so that results of batches which
+    // were started before the invalidation are not memoized
+    mutable LRUCache<QString, bool> m_checkedWordsCache;
+    quint64 m_checkedWordsCacheGeneration = 0;
+
+    // Deduplicated words of pending batches
+    QHash<QUuid, QStringList> m_checkSpellBatchWordsByRequestId;
 };
 
 } // namespace quentier
@@ -272,19 +272,21 @@ void AddResourceDelegate::doStartUsingFile()
 
     QObject::connect(
         this, &AddResourceDelegate::readFileData, m_pFileIOProcessorAsync,
-        &FileIOProcessorAsync::onReadFileRequest);
+        &FileIOProcessorAsync::onPrioritizedReadFileWithHashRequest);
 
     QObject::connect(
         m_pFileIOProcessorAsync,
-        &FileIOProcessorAsync::readFileRequestProcessed, this,
+        &FileIOProcessorAsync::readFileWithHashRequestProcessed, this,
         &AddResourceDelegate::onResourceFileRead);
 
-    Q_EMIT readFileData(m_filePath, m_readResourceFileRequestId);
+    Q_EMIT readFileData(
+        m_filePath, m_readResourceFileRequestId,
+        FileIOProcessorAsync::Priority::Interactive);
 }
 
 void AddResourceDelegate::onResourceFileRead(
     bool success, ErrorString errorDescription, QByteArray data,
-    QUuid requestId)
+    QByteArray dataHash, QUuid requestId)
 {
     if (requestId != m_readResourceFileRequestId) {
         return;
@@ -297,11 +299,11 @@ void AddResourceDelegate::onResourceFileRead(
 
     QObject::disconnect(
         this, &AddResourceDelegate::readFileData, m_pFileIOProcessorAsync,
-        &FileIOProcessorAsync::onReadFileRequest);
+        &FileIOProcessorAsync::onPrioritizedReadFileWithHashRequest);
 
     QObject::disconnect(
         m_pFileIOProcessorAsync,
-        &FileIOProcessorAsync::readFileRequestProcessed, this,
+        &FileIOProcessorAsync::readFileWithHashRequestProcessed, this,
         &AddResourceDelegate::onResourceFileRead);
 
     if (Q_UNLIKELY(!success)) {
@@ -317,10 +319,11 @@ void AddResourceDelegate::onResourceFileRead(
     QFileInfo fileInfo(m_filePath);
 
     if (m_resourceMimeType.name().startsWith(QStringLiteral("image/"))) {
-        doSaveResourceDataToTemporaryFile(data, fileInfo.fileName());
+        doSaveResourceDataToTemporaryFile(
+            data, dataHash, fileInfo.fileName());
     }
     else {
-        doGenerateGenericResourceImage(data, fileInfo.fileName());
+        doGenerateGenericResourceImage(data, dataHash, fileInfo.fileName());
     }
 }
 
@@ -359,15 +362,15 @@ void AddResourceDelegate::doStartUsingData()
     }
 
     if (m_resourceMimeType.name().startsWith(QStringLiteral("image/"))) {
-        doSaveResourceDataToTemporaryFile(m_data, QString());
+        doSaveResourceDataToTemporaryFile(m_data, QByteArray(), QString());
     }
     else {
-        doGenerateGenericResourceImage(m_data, QString());
+        doGenerateGenericResourceImage(m_data, QByteArray(), QString());
     }
 }
 
 void AddResourceDelegate::doSaveResourceDataToTemporaryFile(
-    const QByteArray & data, QString resourceName)
+    const QByteArray & data, QByteArray dataHash, QString resourceName)
 {
     QNDEBUG(
         "note_editor:delegate",
@@ -389,8 +392,9 @@ void AddResourceDelegate::doSaveResourceDataToTemporaryFile(
         resourceName = tr("Attachment");
     }
 
-    QByteArray dataHash =
-        QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    if (dataHash.isEmpty()) {
+        dataHash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    }
 
     m_resource = m_noteEditor.attachResourceToNote(
         data, dataHash, m_resourceMimeType, resourceName);
@@ -553,7 +557,7 @@ void AddResourceDelegate::onGenericResourceImageSaved(
 }
 
 void AddResourceDelegate::doGenerateGenericResourceImage(
-    const QByteArray & data, QString resourceName)
+    const QByteArray & data, QByteArray dataHash, QString resourceName)
 {
     QNDEBUG(
         "note_editor:delegate",
@@ -580,8 +584,9 @@ void AddResourceDelegate::doGenerateGenericResourceImage(
         resourceName = tr("Attachment");
     }
 
-    QByteArray dataHash =
-        QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    if (dataHash.isEmpty()) {
+        dataHash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    }
 
     m_resource = m_noteEditor.attachResourceToNote(
         data, dataHash, m_resourceMimeType, resourceName);
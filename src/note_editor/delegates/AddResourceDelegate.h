@@ -24,6 +24,7 @@
 #include <quentier/types/ErrorString.h>
 #include <quentier/types/Note.h>
 #include <quentier/types/Resource.h>
+#include <quentier/utility/FileIOProcessorAsync.h>
 
 #include <QByteArray>
 #include <QHash>
@@ -34,7 +35,6 @@
 namespace quentier {
 
 QT_FORWARD_DECLARE_CLASS(Account)
-QT_FORWARD_DECLARE_CLASS(FileIOProcessorAsync)
 QT_FORWARD_DECLARE_CLASS(GenericResourceImageManager)
 QT_FORWARD_DECLARE_CLASS(NoteEditorPrivate)
 QT_FORWARD_DECLARE_CLASS(ResourceDataInTemporaryFileStorageManager)
@@ -128,7 +128,9 @@ Q_SIGNALS:
     void notifyError(ErrorString error);
 
     // private signals
-    void readFileData(QString filePath, QUuid requestId);
+    void readFileData(
+        QString filePath, QUuid requestId,
+        FileIOProcessorAsync::Priority priority);
 
     void saveResourceDataToTemporaryFile(
         QString noteLocalUid, QString resourceLocalUid, QByteArray data,
@@ -146,7 +148,7 @@ private Q_SLOTS:
 
     void onResourceFileRead(
         bool success, ErrorString errorDescription, QByteArray data,
-        QUuid requestId);
+        QByteArray dataHash, QUuid requestId);
 
     void onResourceDataSavedToTemporaryFile(
         QUuid requestId, QByteArray dataHash, ErrorString errorDescription);
@@ -162,11 +164,12 @@ private:
     void doStartUsingFile();
     void doStartUsingData();
 
+    // If the data hash is empty, it is computed from the data
     void doSaveResourceDataToTemporaryFile(
-        const QByteArray & data, QString resourceName);
+        const QByteArray & data, QByteArray dataHash, QString resourceName);
 
     void doGenerateGenericResourceImage(
-        const QByteArray & data, QString resourceName);
+        const QByteArray & data, QByteArray dataHash, QString resourceName);
 
     void insertNewResourceHtml();
 
@@ -18,6 +18,7 @@
 
 #include "ImageResourceRotationDelegate.h"
 
+#include "../ImageResourceRotator.h"
 #include "../ResourceDataInTemporaryFileStorageManager.h"
 
 #include <quentier/logging/QuentierLogger.h>
@@ -26,10 +27,13 @@
 #include <quentier/utility/Compat.h>
 #include <quentier/utility/Size.h>
 
-#include <QBuffer>
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
+#include <QProgressDialog>
+#include <QThreadPool>
+
+#include <cmath>
 
 #include <limits>
 
@@ -63,6 +67,15 @@ ImageResourceRotationDelegate::ImageResourceRotationDelegate(
     m_resourceHashBefore(resourceHashBefore)
 {}
 
+ImageResourceRotationDelegate::~ImageResourceRotationDelegate()
+{
+    if (m_pRotationStopFlag) {
+        m_pRotationStopFlag->storeRelease(1);
+    }
+
+    clearRotationProgressDialog();
+}
+
 void ImageResourceRotationDelegate::start()
 {
     QNDEBUG("note_editor:delegate", "ImageResourceRotationDelegate::start");
@@ -172,43 +185,131 @@ void ImageResourceRotationDelegate::rotateImageResource()
             m_rotatedResource.recognitionDataHash();
     }
 
-    QImage resourceImage;
-    bool loaded = resourceImage.loadFromData(m_rotatedResource.dataBody());
-    if (Q_UNLIKELY(!loaded)) {
-        error.appendBase(
-            QT_TR_NOOP("Can't load the resource data as an image"));
-        QNWARNING("note_editor:delegate", error);
-        Q_EMIT notifyError(error);
+    // Decoding, rotating and encoding large images takes a while so it is
+    // done on a worker thread
+    m_pRotationStopFlag = std::make_shared<QAtomicInt>(0);
+    m_rotationRequestId = QUuid::createUuid();
+
+    auto * pRotator = new ImageResourceRotator(
+        m_rotatedResource.dataBody(),
+        (m_rotatedResource.hasDataHash() ? m_rotatedResource.dataHash()
+                                         : QByteArray()),
+        m_rotationDirection, m_pRotationStopFlag, m_rotationRequestId);
+
+    pRotator->setAutoDelete(false);
+
+    QObject::connect(
+        pRotator, &ImageResourceRotator::progress, this,
+        &ImageResourceRotationDelegate::onImageRotationProgress,
+        Qt::QueuedConnection);
+
+    QObject::connect(
+        pRotator, &ImageResourceRotator::finished, this,
+        &ImageResourceRotationDelegate::onImageRotated, Qt::QueuedConnection);
+
+    QObject::connect(
+        pRotator, &ImageResourceRotator::finished, pRotator,
+        &ImageResourceRotator::deleteLater, Qt::QueuedConnection);
+
+    m_pRotationProgressDialog = new QProgressDialog(
+        tr("Rotating image") + QStringLiteral("..."), tr("Cancel"),
+        /* min = */ 0,
+        /* max = */ 100, &m_noteEditor, Qt::Dialog);
+
+    m_pRotationProgressDialog->setWindowModality(Qt::WindowModal);
+    m_pRotationProgressDialog->setMinimumDuration(2000);
+
+    QObject::connect(
+        m_pRotationProgressDialog, &QProgressDialog::canceled, this,
+        &ImageResourceRotationDelegate::onRotationProgressDialogCanceled);
+
+    QThreadPool::globalInstance()->start(pRotator);
+}
+
+void ImageResourceRotationDelegate::onImageRotationProgress(
+    QUuid requestId, double progress)
+{
+    if ((requestId != m_rotationRequestId) || !m_pRotationProgressDialog) {
+        return;
+    }
+
+    QNTRACE(
+        "note_editor:delegate",
+        "ImageResourceRotationDelegate::onImageRotationProgress: "
+            << progress);
+
+    int normalizedProgress =
+        static_cast<int>(std::floor(progress * 100.0 + 0.5));
+
+    if (normalizedProgress > 100) {
+        normalizedProgress = 100;
+    }
+
+    m_pRotationProgressDialog->setValue(normalizedProgress);
+}
+
+void ImageResourceRotationDelegate::onRotationProgressDialogCanceled()
+{
+    QNDEBUG(
+        "note_editor:delegate",
+        "ImageResourceRotationDelegate::onRotationProgressDialogCanceled");
+
+    if (m_pRotationStopFlag) {
+        m_pRotationStopFlag->storeRelease(1);
+    }
+}
+
+void ImageResourceRotationDelegate::onImageRotated(
+    QUuid requestId, bool cancelled, QByteArray rotatedImageData,
+    QByteArray rotatedImageDataHash, QSize imageSizeBefore,
+    QSize imageSizeAfter, ErrorString errorDescription)
+{
+    if (requestId != m_rotationRequestId) {
         return;
     }
 
-    m_resourceImageSizeBefore.setHeight(resourceImage.height());
-    m_resourceImageSizeBefore.setWidth(resourceImage.width());
+    QNDEBUG(
+        "note_editor:delegate",
+        "ImageResourceRotationDelegate::onImageRotated: cancelled = "
+            << (cancelled ? "true" : "false")
+            << ", error description = " << errorDescription);
 
-    qreal angle =
-        ((m_rotationDirection == INoteEditorBackend::Rotation::Clockwise)
-             ? 90.0
-             : -90.0);
+    clearRotationProgressDialog();
+    m_pRotationStopFlag.reset();
 
-    QTransform transform;
-    transform.rotate(angle);
-    resourceImage = resourceImage.transformed(transform);
+    if (cancelled) {
+        Q_EMIT this->cancelled();
+        return;
+    }
 
-    resourceImage = resourceImage.scaled(
-        m_resourceImageSizeBefore.height(), m_resourceImageSizeBefore.width(),
-        Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    if (Q_UNLIKELY(!errorDescription.isEmpty())) {
+        ErrorString error(QT_TR_NOOP("Can't rotate the image attachment"));
+        error.appendBase(errorDescription.base());
+        error.appendBase(errorDescription.additionalBases());
+        error.details() = errorDescription.details();
+        QNWARNING("note_editor:delegate", error);
+        Q_EMIT notifyError(error);
+        return;
+    }
+
+    if (Q_UNLIKELY(m_noteEditor.notePtr() != m_pNote)) {
+        ErrorString error(
+            QT_TR_NOOP("Can't rotate the image attachment: "
+                       "note was changed during the processing "
+                       "of image rotation"));
+        QNWARNING("note_editor:delegate", error);
+        Q_EMIT notifyError(error);
+        return;
+    }
 
-    QByteArray rotatedResourceData;
-    QBuffer rotatedResourceDataBuffer(&rotatedResourceData);
-    rotatedResourceDataBuffer.open(QIODevice::WriteOnly);
-    resourceImage.save(&rotatedResourceDataBuffer, "PNG");
+    m_resourceImageSizeBefore = imageSizeBefore;
 
-    m_rotatedResource.setDataBody(rotatedResourceData);
-    m_rotatedResource.setDataSize(rotatedResourceData.size());
+    m_rotatedResource.setDataBody(rotatedImageData);
+    m_rotatedResource.setDataSize(rotatedImageData.size());
     m_rotatedResource.setDataHash(QByteArray());
 
-    int height = resourceImage.height();
-    int width = resourceImage.width();
+    int height = imageSizeAfter.height();
+    int width = imageSizeAfter.width();
     QNTRACE(
         "note_editor:delegate",
         "Rotated resource's height = " << height << ", width = " << width);
@@ -247,7 +348,7 @@ void ImageResourceRotationDelegate::rotateImageResource()
 
     Q_EMIT saveResourceDataToTemporaryFile(
         m_rotatedResource.noteLocalUid(), m_rotatedResource.localUid(),
-        m_rotatedResource.dataBody(), QByteArray(),
+        m_rotatedResource.dataBody(), rotatedImageDataHash,
         m_saveResourceDataToTemporaryFileRequestId,
         /* is image = */ true);
 }
@@ -435,6 +536,21 @@ void ImageResourceRotationDelegate::onResourceTagHashUpdated(
             *this, &ImageResourceRotationDelegate::onResourceTagSrcUpdated));
 }
 
+void ImageResourceRotationDelegate::clearRotationProgressDialog()
+{
+    if (!m_pRotationProgressDialog) {
+        return;
+    }
+
+    QObject::disconnect(
+        m_pRotationProgressDialog, &QProgressDialog::canceled, this,
+        &ImageResourceRotationDelegate::onRotationProgressDialogCanceled);
+
+    m_pRotationProgressDialog->accept();
+    m_pRotationProgressDialog->deleteLater();
+    m_pRotationProgressDialog = nullptr;
+}
+
 void ImageResourceRotationDelegate::onResourceTagSrcUpdated(
     const QVariant & data)
 {
@@ -25,8 +25,13 @@
 
 #include <quentier/types/Resource.h>
 
+#include <QAtomicInt>
 #include <QSize>
 
+#include <memory>
+
+QT_FORWARD_DECLARE_CLASS(QProgressDialog)
+
 namespace quentier {
 
 class Q_DECL_HIDDEN ImageResourceRotationDelegate final : public QObject
@@ -41,6 +46,8 @@ public:
             resourceDataInTemporaryFileStorageManager,
         QHash<QString, QString> & resourceFileStoragePathsByLocalUid);
 
+    virtual ~ImageResourceRotationDelegate() override;
+
     void start();
 
 Q_SIGNALS:
@@ -53,6 +60,12 @@ Q_SIGNALS:
 
     void notifyError(ErrorString error);
 
+    /**
+     * Emitted if the user cancels the rotation while the image is being
+     * rotated; nothing is changed within the note in this case
+     */
+    void cancelled();
+
     // private signals
     void saveResourceDataToTemporaryFile(
         QString noteLocalUid, QString resourceLocalUid, QByteArray data,
@@ -61,6 +74,15 @@ Q_SIGNALS:
 private Q_SLOTS:
     void onOriginalPageConvertedToNote(Note note);
 
+    void onImageRotationProgress(QUuid requestId, double progress);
+
+    void onImageRotated(
+        QUuid requestId, bool cancelled, QByteArray rotatedImageData,
+        QByteArray rotatedImageDataHash, QSize imageSizeBefore,
+        QSize imageSizeAfter, ErrorString errorDescription);
+
+    void onRotationProgressDialogCanceled();
+
     void onResourceDataSavedToTemporaryFile(
         QUuid requestId, QByteArray dataHash, ErrorString errorDescription);
 
@@ -69,6 +91,7 @@ private Q_SLOTS:
 
 private:
     void rotateImageResource();
+    void clearRotationProgressDialog();
 
 private:
     using JsCallback = JsResultCallbackFunctor<ImageResourceRotationDelegate>;
@@ -95,6 +118,11 @@ private:
     QString m_resourceFileStoragePathAfter;
 
     Resource m_rotatedResource;
+
+    std::shared_ptr<QAtomicInt> m_pRotationStopFlag;
+    QUuid m_rotationRequestId;
+    QProgressDialog * m_pRotationProgressDialog = nullptr;
+
     QUuid m_saveResourceDataToTemporaryFileRequestId;
 };
 
@@ -17,9 +17,12 @@
  */
 
 #include "ImageResourceRotationUndoCommand.h"
+#include "UndoStackDataStorage.h"
 
 #include <quentier/logging/QuentierLogger.h>
 
+#include <QCryptographicHash>
+
 #include <limits>
 
 namespace quentier {
@@ -33,13 +36,14 @@ ImageResourceRotationUndoCommand::ImageResourceRotationUndoCommand(
     const INoteEditorBackend::Rotation rotationDirection,
     NoteEditorPrivate & noteEditor, QUndoCommand * parent) :
     INoteEditorUndoCommand(noteEditor, parent),
-    m_resourceDataBefore(resourceDataBefore),
     m_resourceHashBefore(resourceHashBefore),
-    m_resourceRecognitionDataBefore(resourceRecognitionDataBefore),
     m_resourceRecognitionDataHashBefore(resourceRecognitionDataHashBefore),
     m_resourceImageSizeBefore(resourceImageSizeBefore),
-    m_resourceAfter(resourceAfter), m_rotationDirection(rotationDirection)
+    m_resourceAfter(resourceAfter), m_rotationDirection(rotationDirection),
+    m_pDataStorage(noteEditor.undoStackDataStorage())
 {
+    init(resourceDataBefore, resourceRecognitionDataBefore);
+
     setText(
         QObject::tr("Image resource rotation") + QStringLiteral(" ") +
         ((m_rotationDirection == INoteEditorBackend::Rotation::Clockwise)
@@ -57,15 +61,21 @@ ImageResourceRotationUndoCommand::ImageResourceRotationUndoCommand(
     NoteEditorPrivate & noteEditor, const QString & text,
     QUndoCommand * parent) :
     INoteEditorUndoCommand(noteEditor, text, parent),
-    m_resourceDataBefore(resourceDataBefore),
     m_resourceHashBefore(resourceHashBefore),
-    m_resourceRecognitionDataBefore(resourceRecognitionDataBefore),
     m_resourceRecognitionDataHashBefore(resourceRecognitionDataHashBefore),
     m_resourceImageSizeBefore(resourceImageSizeBefore),
-    m_resourceAfter(resourceAfter), m_rotationDirection(rotationDirection)
-{}
+    m_resourceAfter(resourceAfter), m_rotationDirection(rotationDirection),
+    m_pDataStorage(noteEditor.undoStackDataStorage())
+{
+    init(resourceDataBefore, resourceRecognitionDataBefore);
+}
 
-ImageResourceRotationUndoCommand::~ImageResourceRotationUndoCommand() {}
+ImageResourceRotationUndoCommand::~ImageResourceRotationUndoCommand()
+{
+    for (const auto & dataHash: qAsConst(m_dataHashes)) {
+        m_pDataStorage->releaseData(dataHash);
+    }
+}
 
 void ImageResourceRotationUndoCommand::redoImpl()
 {
@@ -80,8 +90,19 @@ void ImageResourceRotationUndoCommand::redoImpl()
         return;
     }
 
+    Resource resource(m_resourceAfter);
+
+    ErrorString errorDescription;
+    if (!m_pDataStorage->restoreResourceData(resource, errorDescription)) {
+        QNWARNING(
+            "note_editor:undo",
+            "Can't redo image resource rotation: " << errorDescription);
+        Q_EMIT notifyError(errorDescription);
+        return;
+    }
+
     m_noteEditorPrivate.updateResource(
-        m_resourceAfter.localUid(), m_resourceHashBefore, m_resourceAfter);
+        resource.localUid(), m_resourceHashBefore, resource);
 }
 
 void ImageResourceRotationUndoCommand::undoImpl()
@@ -97,11 +118,32 @@ void ImageResourceRotationUndoCommand::undoImpl()
         return;
     }
 
+    QByteArray resourceDataBefore;
+    QByteArray resourceRecognitionDataBefore;
+
+    ErrorString errorDescription;
+    bool res = m_pDataStorage->findData(
+        m_resourceDataKeyBefore, resourceDataBefore, errorDescription);
+
+    if (res && !m_resourceRecognitionDataKeyBefore.isEmpty()) {
+        res = m_pDataStorage->findData(
+            m_resourceRecognitionDataKeyBefore, resourceRecognitionDataBefore,
+            errorDescription);
+    }
+
+    if (!res) {
+        QNWARNING(
+            "note_editor:undo",
+            "Can't undo image resource rotation: " << errorDescription);
+        Q_EMIT notifyError(errorDescription);
+        return;
+    }
+
     Resource resource(m_resourceAfter);
-    resource.setDataBody(m_resourceDataBefore);
-    resource.setDataSize(m_resourceDataBefore.size());
+    resource.setDataBody(resourceDataBefore);
+    resource.setDataSize(resourceDataBefore.size());
     resource.setDataHash(m_resourceHashBefore);
-    resource.setRecognitionDataBody(m_resourceRecognitionDataBefore);
+    resource.setRecognitionDataBody(resourceRecognitionDataBefore);
     resource.setRecognitionDataHash(m_resourceRecognitionDataHashBefore);
 
     if (m_resourceImageSizeBefore.isValid()) {
@@ -115,12 +157,41 @@ void ImageResourceRotationUndoCommand::undoImpl()
         }
     }
 
-    if (!m_resourceRecognitionDataBefore.isEmpty()) {
-        resource.setRecognitionDataSize(m_resourceRecognitionDataBefore.size());
+    if (!resourceRecognitionDataBefore.isEmpty()) {
+        resource.setRecognitionDataSize(resourceRecognitionDataBefore.size());
     }
 
     m_noteEditorPrivate.updateResource(
         resource.localUid(), m_resourceAfter.dataHash(), resource);
 }
 
+void ImageResourceRotationUndoCommand::init(
+    const QByteArray & resourceDataBefore,
+    const QByteArray & resourceRecognitionDataBefore)
+{
+    m_resourceDataKeyBefore =
+        (m_resourceHashBefore.isEmpty()
+             ? QCryptographicHash::hash(
+                   resourceDataBefore, QCryptographicHash::Md5)
+             : m_resourceHashBefore);
+
+    m_pDataStorage->addData(m_resourceDataKeyBefore, resourceDataBefore);
+    m_dataHashes << m_resourceDataKeyBefore;
+
+    if (!resourceRecognitionDataBefore.isEmpty()) {
+        m_resourceRecognitionDataKeyBefore =
+            (m_resourceRecognitionDataHashBefore.isEmpty()
+                 ? QCryptographicHash::hash(
+                       resourceRecognitionDataBefore, QCryptographicHash::Md5)
+                 : m_resourceRecognitionDataHashBefore);
+
+        m_pDataStorage->addData(
+            m_resourceRecognitionDataKeyBefore, resourceRecognitionDataBefore);
+
+        m_dataHashes << m_resourceRecognitionDataKeyBefore;
+    }
+
+    m_pDataStorage->stripResourceData(m_resourceAfter, m_dataHashes);
+}
+
 } // namespace quentier
@@ -27,8 +27,12 @@
 
 #include <QSize>
 
+#include <memory>
+
 namespace quentier {
 
+QT_FORWARD_DECLARE_CLASS(UndoStackDataStorage)
+
 class Q_DECL_HIDDEN ImageResourceRotationUndoCommand final :
     public INoteEditorUndoCommand
 {
@@ -59,13 +63,24 @@ public:
     virtual void undoImpl() override;
 
 private:
-    const QByteArray m_resourceDataBefore;
+    void init(
+        const QByteArray & resourceDataBefore,
+        const QByteArray & resourceRecognitionDataBefore);
+
+private:
+    // Image data and recognition data from before the rotation as well as
+    // data bodies of the rotated resource are kept in the undo stack data
+    // storage rather than within the command
     const QByteArray m_resourceHashBefore;
-    const QByteArray m_resourceRecognitionDataBefore;
     const QByteArray m_resourceRecognitionDataHashBefore;
     const QSize m_resourceImageSizeBefore;
-    const Resource m_resourceAfter;
+    Resource m_resourceAfter;
     const INoteEditorBackend::Rotation m_rotationDirection;
+
+    std::shared_ptr<UndoStackDataStorage> m_pDataStorage;
+    QByteArray m_resourceDataKeyBefore;
+    QByteArray m_resourceRecognitionDataKeyBefore;
+    QList<QByteArray> m_dataHashes;
 };
 
 } // namespace quentier
@@ -17,6 +17,7 @@
  */
 
 #include "InsertHtmlUndoCommand.h"
+#include "UndoStackDataStorage.h"
 
 #include "../NoteEditor_p.h"
 
@@ -51,9 +52,11 @@ InsertHtmlUndoCommand::InsertHtmlUndoCommand(
     m_resourceFileStoragePaths(resourceFileStoragePaths), m_callback(callback),
     m_resourceFileStoragePathsByResourceLocalUid(
         resourceFileStoragePathsByResourceLocalUid),
-    m_resourceInfo(resourceInfo)
+    m_resourceInfo(resourceInfo),
+    m_pDataStorage(noteEditor.undoStackDataStorage())
 {
     setText(tr("Insert HTML"));
+    stripAddedResourcesData();
 }
 
 InsertHtmlUndoCommand::InsertHtmlUndoCommand(
@@ -67,10 +70,16 @@ InsertHtmlUndoCommand::InsertHtmlUndoCommand(
     m_resourceFileStoragePaths(resourceFileStoragePaths), m_callback(callback),
     m_resourceFileStoragePathsByResourceLocalUid(
         resourceFileStoragePathsByResourceLocalUid),
-    m_resourceInfo(resourceInfo)
-{}
+    m_resourceInfo(resourceInfo),
+    m_pDataStorage(noteEditor.undoStackDataStorage())
+{
+    stripAddedResourcesData();
+}
 
-InsertHtmlUndoCommand::~InsertHtmlUndoCommand() {}
+InsertHtmlUndoCommand::~InsertHtmlUndoCommand()
+{
+    releaseAddedResourcesData();
+}
 
 void InsertHtmlUndoCommand::undoImpl()
 {
@@ -127,6 +136,19 @@ void InsertHtmlUndoCommand::redoImpl()
 {
     QNDEBUG("note_editor:undo", "InsertHtmlUndoCommand::redoImpl");
 
+    for (auto & resource: m_addedResources) {
+        ErrorString errorDescription;
+        if (!m_pDataStorage->restoreResourceData(resource, errorDescription))
+        {
+            QNWARNING(
+                "note_editor:undo",
+                "Can't redo the html insertion: " << errorDescription);
+            Q_EMIT notifyError(errorDescription);
+            stripAddedResourcesData();
+            return;
+        }
+    }
+
     const QList<Resource> & addedResources = m_addedResources;
     int numResources = addedResources.size();
 
@@ -259,9 +281,35 @@ void InsertHtmlUndoCommand::redoImpl()
         }
     }
 
+    // Resources were added to the note, their data doesn't need to be kept
+    // within the command
+    const QList<QByteArray> previousDataHashes = m_dataHashes;
+    m_dataHashes.clear();
+    stripAddedResourcesData();
+
+    for (const auto & dataHash: previousDataHashes) {
+        m_pDataStorage->releaseData(dataHash);
+    }
+
     GET_PAGE()
     page->executeJavaScript(
         QStringLiteral("htmlInsertionManager.redo();"), m_callback);
 }
 
+void InsertHtmlUndoCommand::stripAddedResourcesData()
+{
+    for (auto & resource: m_addedResources) {
+        m_pDataStorage->stripResourceData(resource, m_dataHashes);
+    }
+}
+
+void InsertHtmlUndoCommand::releaseAddedResourcesData()
+{
+    for (const auto & dataHash: qAsConst(m_dataHashes)) {
+        m_pDataStorage->releaseData(dataHash);
+    }
+
+    m_dataHashes.clear();
+}
+
 } // namespace quentier
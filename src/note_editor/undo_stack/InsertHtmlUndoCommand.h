@@ -26,10 +26,13 @@
 #include <QHash>
 #include <QStringList>
 
+#include <memory>
+
 namespace quentier {
 
 QT_FORWARD_DECLARE_CLASS(Resource)
 QT_FORWARD_DECLARE_CLASS(ResourceInfo)
+QT_FORWARD_DECLARE_CLASS(UndoStackDataStorage)
 
 class Q_DECL_HIDDEN InsertHtmlUndoCommand final : public INoteEditorUndoCommand
 {
@@ -60,12 +63,20 @@ public:
     virtual void redoImpl() override;
 
 private:
+    void stripAddedResourcesData();
+    void releaseAddedResourcesData();
+
+private:
+    // Data bodies of added resources are kept in the undo stack data storage
     QList<Resource> m_addedResources;
     QStringList m_resourceFileStoragePaths;
     Callback m_callback;
 
     QHash<QString, QString> & m_resourceFileStoragePathsByResourceLocalUid;
     ResourceInfo & m_resourceInfo;
+
+    std::shared_ptr<UndoStackDataStorage> m_pDataStorage;
+    QList<QByteArray> m_dataHashes;
 };
 
 } // namespace quentier
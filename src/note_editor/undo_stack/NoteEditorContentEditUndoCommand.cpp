@@ -17,6 +17,7 @@
  */
 
 #include "NoteEditorContentEditUndoCommand.h"
+#include "UndoStackDataStorage.h"
 
 #include "../NoteEditor_p.h"
 
@@ -28,7 +29,8 @@ NoteEditorContentEditUndoCommand::NoteEditorContentEditUndoCommand(
     NoteEditorPrivate & noteEditorPrivate, const QList<Resource> & resources,
     QUndoCommand * parent) :
     INoteEditorUndoCommand(noteEditorPrivate, parent),
-    m_resources(resources)
+    m_resources(resources),
+    m_pDataStorage(noteEditorPrivate.undoStackDataStorage())
 {
     init();
 }
@@ -37,12 +39,18 @@ NoteEditorContentEditUndoCommand::NoteEditorContentEditUndoCommand(
     NoteEditorPrivate & noteEditorPrivate, const QList<Resource> & resources,
     const QString & text, QUndoCommand * parent) :
     INoteEditorUndoCommand(noteEditorPrivate, text, parent),
-    m_resources(resources)
+    m_resources(resources),
+    m_pDataStorage(noteEditorPrivate.undoStackDataStorage())
 {
     init();
 }
 
-NoteEditorContentEditUndoCommand::~NoteEditorContentEditUndoCommand() {}
+NoteEditorContentEditUndoCommand::~NoteEditorContentEditUndoCommand()
+{
+    for (const auto & dataHash: qAsConst(m_dataHashes)) {
+        m_pDataStorage->releaseData(dataHash);
+    }
+}
 
 void NoteEditorContentEditUndoCommand::redoImpl()
 {
@@ -50,7 +58,21 @@ void NoteEditorContentEditUndoCommand::redoImpl()
         "note_editor:undo",
         "NoteEditorContentEditUndoCommand::redoImpl (" << text() << ")");
 
+    if (!m_resourcesAfterEditCaptured) {
+        m_noteEditorPrivate.redoPageAction();
+        return;
+    }
+
+    // All the data must be restored before the page is touched: otherwise
+    // a failure to restore the data would leave the page and note's resources
+    // inconsistent with each other
+    QList<Resource> resources = m_resourcesAfterEdit;
+    if (!restoreResourcesData(resources)) {
+        return;
+    }
+
     m_noteEditorPrivate.redoPageAction();
+    m_noteEditorPrivate.setNoteResources(resources);
 }
 
 void NoteEditorContentEditUndoCommand::undoImpl()
@@ -59,13 +81,52 @@ void NoteEditorContentEditUndoCommand::undoImpl()
         "note_editor:undo",
         "NoteEditorContentEditUndoCommand::undoImpl (" << text() << ")");
 
+    QList<Resource> resources = m_resources;
+    if (!restoreResourcesData(resources)) {
+        return;
+    }
+
+    if (!m_resourcesAfterEditCaptured) {
+        const Note * pNote = m_noteEditorPrivate.notePtr();
+        if (pNote) {
+            m_resourcesAfterEdit = pNote->resources();
+            for (auto & resource: m_resourcesAfterEdit) {
+                m_pDataStorage->stripResourceData(resource, m_dataHashes);
+            }
+
+            m_resourcesAfterEditCaptured = true;
+        }
+    }
+
     m_noteEditorPrivate.undoPageAction();
-    m_noteEditorPrivate.setNoteResources(m_resources);
+    m_noteEditorPrivate.setNoteResources(resources);
+}
+
+bool NoteEditorContentEditUndoCommand::restoreResourcesData(
+    QList<Resource> & resources)
+{
+    for (auto & resource: resources) {
+        ErrorString errorDescription;
+        if (!m_pDataStorage->restoreResourceData(resource, errorDescription))
+        {
+            QNWARNING(
+                "note_editor:undo",
+                errorDescription << ", resource: " << resource);
+            Q_EMIT notifyError(errorDescription);
+            return false;
+        }
+    }
+
+    return true;
 }
 
 void NoteEditorContentEditUndoCommand::init()
 {
     setText(tr("Note text edit"));
+
+    for (auto & resource: m_resources) {
+        m_pDataStorage->stripResourceData(resource, m_dataHashes);
+    }
 }
 
 } // namespace quentier
@@ -25,8 +25,12 @@
 
 #include <QList>
 
+#include <memory>
+
 namespace quentier {
 
+QT_FORWARD_DECLARE_CLASS(UndoStackDataStorage)
+
 class Q_DECL_HIDDEN NoteEditorContentEditUndoCommand final :
     public INoteEditorUndoCommand
 {
@@ -48,6 +52,7 @@ public:
 
 private:
     void init();
+    bool restoreResourcesData(QList<Resource> & resources);
 
 private:
     /**
@@ -66,13 +71,24 @@ private:
      * facilities, the storage and copying of a list with resources for this use
      * case is actually very cheap
      *
-     * Note that there's no need to worry about doing anything with note's
-     * resources on redoing the edit. It is not possible to add a resource
-     * through editing of note's content. If the edit action was actually
-     * removing the resource from the note's content via backspace, that fact
-     * would be figured out elsewhere
+     * On the first undo the resources the note has after the edit are
+     * remembered as well so that redoing the edit after the undo restores
+     * exactly them; on the initial execution of the edit there's nothing to
+     * do with note's resources: if the edit action was actually removing
+     * the resource from the note's content via backspace, that fact would be
+     * figured out elsewhere
+     *
+     * Data bodies of the resources are kept in the undo stack data storage
+     * which holds a single copy of each piece of data and moves the excess over
+     * its memory limit to temporary files
      */
     QList<Resource> m_resources;
+
+    QList<Resource> m_resourcesAfterEdit;
+    bool m_resourcesAfterEditCaptured = false;
+
+    std::shared_ptr<UndoStackDataStorage> m_pDataStorage;
+    QList<QByteArray> m_dataHashes;
 };
 
 } // namespace quentier
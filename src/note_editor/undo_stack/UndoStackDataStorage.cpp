@@ -0,0 +1,270 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UndoStackDataStorage.h"
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/types/Resource.h>
+
+#include <QDir>
+#include <QFile>
+
+namespace quentier {
+
+UndoStackDataStorage::UndoStackDataStorage(
+    QString storageDirPath, const qint64 memoryLimit) :
+    m_storageDirPath(std::move(storageDirPath)),
+    m_memoryLimit(memoryLimit)
+{}
+
+UndoStackDataStorage::~UndoStackDataStorage()
+{
+    if (!m_storageDirCreated) {
+        return;
+    }
+
+    QDir storageDir(m_storageDirPath);
+    if (!storageDir.removeRecursively()) {
+        QNWARNING(
+            "note_editor:undo",
+            "Failed to remove undo stack data storage dir: "
+                << m_storageDirPath);
+    }
+}
+
+void UndoStackDataStorage::addData(
+    const QByteArray & dataHash, const QByteArray & data)
+{
+    auto it = m_entries.find(dataHash);
+    if (it != m_entries.end()) {
+        ++it.value().m_refCount;
+        return;
+    }
+
+    Entry entry;
+    entry.m_data = data;
+    entry.m_size = data.size();
+    entry.m_sequenceNumber = ++m_lastSequenceNumber;
+    entry.m_refCount = 1;
+    m_entries[dataHash] = entry;
+
+    m_inMemoryDataHashesBySequenceNumber[entry.m_sequenceNumber] = dataHash;
+    m_memoryUsage += data.size();
+
+    enforceMemoryLimit();
+}
+
+void UndoStackDataStorage::releaseData(const QByteArray & dataHash)
+{
+    auto it = m_entries.find(dataHash);
+    if (Q_UNLIKELY(it == m_entries.end())) {
+        QNWARNING(
+            "note_editor:undo",
+            "Attempt to release unknown undo stack data: hash = "
+                << dataHash.toHex());
+        return;
+    }
+
+    Entry & entry = it.value();
+    --entry.m_refCount;
+    if (entry.m_refCount > 0) {
+        return;
+    }
+
+    if (entry.m_storedInFile) {
+        if (!QFile::remove(dataFilePath(dataHash))) {
+            QNWARNING(
+                "note_editor:undo",
+                "Failed to remove undo stack data file: hash = "
+                    << dataHash.toHex());
+        }
+
+        m_fileUsage -= entry.m_size;
+    }
+    else {
+        m_memoryUsage -= entry.m_data.size();
+        Q_UNUSED(
+            m_inMemoryDataHashesBySequenceNumber.erase(entry.m_sequenceNumber))
+    }
+
+    Q_UNUSED(m_entries.erase(it))
+}
+
+bool UndoStackDataStorage::hasData(const QByteArray & dataHash) const
+{
+    return m_entries.contains(dataHash);
+}
+
+bool UndoStackDataStorage::findData(
+    const QByteArray & dataHash, QByteArray & data,
+    ErrorString & errorDescription) const
+{
+    auto it = m_entries.constFind(dataHash);
+    if (it == m_entries.constEnd()) {
+        errorDescription.setBase(QT_TRANSLATE_NOOP(
+            "UndoStackDataStorage", "Can't find the data for undo/redo"));
+        errorDescription.details() = QString::fromUtf8(dataHash.toHex());
+        return false;
+    }
+
+    const Entry & entry = it.value();
+    if (!entry.m_storedInFile) {
+        data = entry.m_data;
+        return true;
+    }
+
+    QFile file(dataFilePath(dataHash));
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorDescription.setBase(QT_TRANSLATE_NOOP(
+            "UndoStackDataStorage",
+            "Can't open the file with the data for undo/redo"));
+        errorDescription.details() = file.errorString();
+        return false;
+    }
+
+    data = file.readAll();
+    return true;
+}
+
+void UndoStackDataStorage::stripResourceData(
+    Resource & resource, QList<QByteArray> & dataHashes)
+{
+    if (resource.hasDataBody() && resource.hasDataHash()) {
+        addData(resource.dataHash(), resource.dataBody());
+        dataHashes << resource.dataHash();
+        resource.setDataBody(QByteArray());
+    }
+
+    if (resource.hasAlternateDataBody() && resource.hasAlternateDataHash()) {
+        addData(resource.alternateDataHash(), resource.alternateDataBody());
+        dataHashes << resource.alternateDataHash();
+        resource.setAlternateDataBody(QByteArray());
+    }
+
+    if (resource.hasRecognitionDataBody() && resource.hasRecognitionDataHash())
+    {
+        addData(resource.recognitionDataHash(), resource.recognitionDataBody());
+        dataHashes << resource.recognitionDataHash();
+        resource.setRecognitionDataBody(QByteArray());
+    }
+}
+
+bool UndoStackDataStorage::restoreResourceData(
+    Resource & resource, ErrorString & errorDescription) const
+{
+    QByteArray data;
+
+    if (!resource.hasDataBody() && resource.hasDataHash() &&
+        hasData(resource.dataHash()))
+    {
+        if (!findData(resource.dataHash(), data, errorDescription)) {
+            return false;
+        }
+
+        resource.setDataBody(data);
+    }
+
+    if (!resource.hasAlternateDataBody() && resource.hasAlternateDataHash() &&
+        hasData(resource.alternateDataHash()))
+    {
+        if (!findData(resource.alternateDataHash(), data, errorDescription)) {
+            return false;
+        }
+
+        resource.setAlternateDataBody(data);
+    }
+
+    if (!resource.hasRecognitionDataBody() &&
+        resource.hasRecognitionDataHash() &&
+        hasData(resource.recognitionDataHash()))
+    {
+        if (!findData(resource.recognitionDataHash(), data, errorDescription))
+        {
+            return false;
+        }
+
+        resource.setRecognitionDataBody(data);
+    }
+
+    return true;
+}
+
+void UndoStackDataStorage::enforceMemoryLimit()
+{
+    while ((m_memoryUsage > m_memoryLimit) &&
+           !m_inMemoryDataHashesBySequenceNumber.empty())
+    {
+        auto oldestIt = m_inMemoryDataHashesBySequenceNumber.begin();
+        const QByteArray dataHash = oldestIt->second;
+        Q_UNUSED(m_inMemoryDataHashesBySequenceNumber.erase(oldestIt))
+
+        auto it = m_entries.find(dataHash);
+        if (Q_UNLIKELY(it == m_entries.end())) {
+            continue;
+        }
+
+        Entry & entry = it.value();
+
+        if (!m_storageDirCreated) {
+            QDir storageDir(m_storageDirPath);
+            if (!storageDir.exists() && !storageDir.mkpath(m_storageDirPath)) {
+                QNWARNING(
+                    "note_editor:undo",
+                    "Failed to create undo stack data storage dir: "
+                        << m_storageDirPath);
+                return;
+            }
+
+            m_storageDirCreated = true;
+        }
+
+        // The data which can't be written to file stays in memory, it just
+        // no longer takes part in the eviction
+        QFile file(dataFilePath(dataHash));
+        if (!file.open(QIODevice::WriteOnly) ||
+            (file.write(entry.m_data) != entry.m_data.size()))
+        {
+            QNWARNING(
+                "note_editor:undo",
+                "Failed to write undo stack data to file: "
+                    << file.errorString());
+            Q_UNUSED(file.remove())
+            continue;
+        }
+
+        file.close();
+
+        QNTRACE(
+            "note_editor:undo",
+            "Moved " << entry.m_data.size() << " bytes of undo stack data "
+                     << "to file: hash = " << dataHash.toHex());
+
+        m_memoryUsage -= entry.m_data.size();
+        m_fileUsage += entry.m_size;
+        entry.m_data = QByteArray();
+        entry.m_storedInFile = true;
+    }
+}
+
+QString UndoStackDataStorage::dataFilePath(const QByteArray & dataHash) const
+{
+    return m_storageDirPath + QStringLiteral("/") +
+        QString::fromUtf8(dataHash.toHex()) + QStringLiteral(".dat");
+}
+
+} // namespace quentier
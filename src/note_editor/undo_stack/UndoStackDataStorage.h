@@ -0,0 +1,129 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_NOTE_EDITOR_UNDO_STACK_UNDO_STACK_DATA_STORAGE_H
+#define LIB_QUENTIER_NOTE_EDITOR_UNDO_STACK_UNDO_STACK_DATA_STORAGE_H
+
+#include <quentier/types/ErrorString.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <map>
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(Resource)
+
+/**
+ * @brief The UndoStackDataStorage class holds binary data, such as resource
+ * data bodies, referenced by note editor's undo commands.
+ *
+ * The data is keyed by its hash so each distinct piece of data is stored only
+ * once regardless of the number of undo commands referencing it. The total
+ * size of data kept in memory is bounded: once the limit is exceeded, the data
+ * added earliest is moved to files within the storage dir and is read back from
+ * there when some undo command requires it.
+ */
+class Q_DECL_HIDDEN UndoStackDataStorage
+{
+public:
+    UndoStackDataStorage(QString storageDirPath, const qint64 memoryLimit);
+    ~UndoStackDataStorage();
+
+    /**
+     * Adds the reference to the data identified by the hash; each call of this
+     * method must be paired with a call of releaseData with the same hash
+     */
+    void addData(const QByteArray & dataHash, const QByteArray & data);
+
+    void releaseData(const QByteArray & dataHash);
+
+    bool hasData(const QByteArray & dataHash) const;
+
+    bool findData(
+        const QByteArray & dataHash, QByteArray & data,
+        ErrorString & errorDescription) const;
+
+    /**
+     * Moves resource's data, alternate data and recognition data bodies which
+     * have hashes into the storage and clears them within the resource
+     *
+     * @param resource          The resource which data bodies are moved into
+     *                          the storage
+     * @param dataHashes        Hashes of data added to the storage are appended
+     *                          to this list; the caller is responsible for
+     *                          releasing them
+     */
+    void stripResourceData(Resource & resource, QList<QByteArray> & dataHashes);
+
+    /**
+     * Sets previously stripped data bodies back to the resource
+     */
+    bool restoreResourceData(
+        Resource & resource, ErrorString & errorDescription) const;
+
+    qint64 memoryUsage() const
+    {
+        return m_memoryUsage;
+    }
+
+    /**
+     * @return The total size of data moved from memory to files
+     */
+    qint64 fileUsage() const
+    {
+        return m_fileUsage;
+    }
+
+private:
+    void enforceMemoryLimit();
+    QString dataFilePath(const QByteArray & dataHash) const;
+
+private:
+    Q_DISABLE_COPY(UndoStackDataStorage)
+
+private:
+    struct Entry
+    {
+        QByteArray m_data;
+        qint64 m_size = 0;
+        quint64 m_sequenceNumber = 0;
+        int m_refCount = 0;
+        bool m_storedInFile = false;
+    };
+
+    const QString m_storageDirPath;
+    const qint64 m_memoryLimit;
+
+    QHash<QByteArray, Entry> m_entries;
+
+    // Hashes of data kept in memory ordered from the earliest added one
+    std::map<quint64, QByteArray> m_inMemoryDataHashesBySequenceNumber;
+
+    quint64 m_lastSequenceNumber = 0;
+    qint64 m_memoryUsage = 0;
+    qint64 m_fileUsage = 0;
+    bool m_storageDirCreated = false;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_NOTE_EDITOR_UNDO_STACK_UNDO_STACK_DATA_STORAGE_H
@@ -0,0 +1,522 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MeteredNoteStore.h"
+#include "SyncMetrics.h"
+
+#include <quentier/types/Resource.h>
+
+namespace quentier {
+
+namespace {
+
+template <class Func>
+qint32 callAndMeter(
+    SyncMetrics & syncMetrics, const QString & methodName, Func func)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    qint32 errorCode = func();
+    syncMetrics.addNoteStoreCall(methodName, timer.elapsed(), errorCode);
+    return errorCode;
+}
+
+quint64 dataBodySize(const qevercloud::Optional<qevercloud::Data> & data)
+{
+    if (!data.isSet() || !data->body.isSet()) {
+        return 0;
+    }
+
+    return static_cast<quint64>(data->body->size());
+}
+
+quint64 resourceBytes(const qevercloud::Resource & resource)
+{
+    return dataBodySize(resource.data) + dataBodySize(resource.recognition) +
+        dataBodySize(resource.alternateData);
+}
+
+quint64 noteBytes(const qevercloud::Note & note)
+{
+    quint64 bytes = 0;
+    if (note.content.isSet()) {
+        bytes += static_cast<quint64>(note.content->size());
+    }
+
+    if (note.resources.isSet()) {
+        for (const auto & resource: qAsConst(note.resources.ref())) {
+            bytes += resourceBytes(resource);
+        }
+    }
+
+    return bytes;
+}
+
+} // namespace
+
+MeteredNoteStore::MeteredNoteStore(
+    INoteStorePtr pNoteStore, std::shared_ptr<SyncMetrics> pSyncMetrics,
+    QObject * parent) :
+    INoteStore(parent),
+    m_pNoteStore(std::move(pNoteStore)),
+    m_pSyncMetrics(std::move(pSyncMetrics))
+{
+    createConnections();
+}
+
+MeteredNoteStore::~MeteredNoteStore() = default;
+
+INoteStore * MeteredNoteStore::create() const
+{
+    return new MeteredNoteStore(
+        INoteStorePtr(m_pNoteStore->create()), m_pSyncMetrics);
+}
+
+QString MeteredNoteStore::noteStoreUrl() const
+{
+    return m_pNoteStore->noteStoreUrl();
+}
+
+void MeteredNoteStore::setNoteStoreUrl(QString noteStoreUrl)
+{
+    m_pNoteStore->setNoteStoreUrl(std::move(noteStoreUrl));
+}
+
+void MeteredNoteStore::setAuthData(
+    QString authenticationToken, QList<QNetworkCookie> cookies)
+{
+    m_pNoteStore->setAuthData(
+        std::move(authenticationToken), std::move(cookies));
+}
+
+void MeteredNoteStore::stop()
+{
+    m_pNoteStore->stop();
+
+    m_getNoteAsyncTimersByGuid.clear();
+    m_getResourceAsyncTimersByGuid.clear();
+    m_getLinkedNotebookSyncStateAsyncTimersByGuid.clear();
+    m_getLinkedNotebookSyncChunkAsyncTimersByGuid.clear();
+}
+
+qint32 MeteredNoteStore::createNotebook(
+    Notebook & notebook, ErrorString & errorDescription,
+    qint32 & rateLimitSeconds, QString linkedNotebookAuthToken)
+{
+    return callAndMeter(
+        *m_pSyncMetrics, QStringLiteral("createNotebook"), [&] {
+            return m_pNoteStore->createNotebook(
+                notebook, errorDescription, rateLimitSeconds,
+                std::move(linkedNotebookAuthToken));
+        });
+}
+
+qint32 MeteredNoteStore::updateNotebook(
+    Notebook & notebook, ErrorString & errorDescription,
+    qint32 & rateLimitSeconds, QString linkedNotebookAuthToken)
+{
+    return callAndMeter(
+        *m_pSyncMetrics, QStringLiteral("updateNotebook"), [&] {
+            return m_pNoteStore->updateNotebook(
+                notebook, errorDescription, rateLimitSeconds,
+                std::move(linkedNotebookAuthToken));
+        });
+}
+
+qint32 MeteredNoteStore::createNote(
+    Note & note, ErrorString & errorDescription, qint32 & rateLimitSeconds,
+    QString linkedNotebookAuthToken)
+{
+    m_pSyncMetrics->addUploadedBytes(noteBytes(note.qevercloudNote()));
+
+    return callAndMeter(*m_pSyncMetrics, QStringLiteral("createNote"), [&] {
+        return m_pNoteStore->createNote(
+            note, errorDescription, rateLimitSeconds,
+            std::move(linkedNotebookAuthToken));
+    });
+}
+
+qint32 MeteredNoteStore::updateNote(
+    Note & note, ErrorString & errorDescription, qint32 & rateLimitSeconds,
+    QString linkedNotebookAuthToken)
+{
+    m_pSyncMetrics->addUploadedBytes(noteBytes(note.qevercloudNote()));
+
+    return callAndMeter(*m_pSyncMetrics, QStringLiteral("updateNote"), [&] {
+        return m_pNoteStore->updateNote(
+            note, errorDescription, rateLimitSeconds,
+            std::move(linkedNotebookAuthToken));
+    });
+}
+
+qint32 MeteredNoteStore::createTag(
+    Tag & tag, ErrorString & errorDescription, qint32 & rateLimitSeconds,
+    QString linkedNotebookAuthToken)
+{
+    return callAndMeter(*m_pSyncMetrics, QStringLiteral("createTag"), [&] {
+        return m_pNoteStore->createTag(
+            tag, errorDescription, rateLimitSeconds,
+            std::move(linkedNotebookAuthToken));
+    });
+}
+
+qint32 MeteredNoteStore::updateTag(
+    Tag & tag, ErrorString & errorDescription, qint32 & rateLimitSeconds,
+    QString linkedNotebookAuthToken)
+{
+    return callAndMeter(*m_pSyncMetrics, QStringLiteral("updateTag"), [&] {
+        return m_pNoteStore->updateTag(
+            tag, errorDescription, rateLimitSeconds,
+            std::move(linkedNotebookAuthToken));
+    });
+}
+
+qint32 MeteredNoteStore::createSavedSearch(
+    SavedSearch & savedSearch, ErrorString & errorDescription,
+    qint32 & rateLimitSeconds)
+{
+    return callAndMeter(
+        *m_pSyncMetrics, QStringLiteral("createSavedSearch"), [&] {
+            return m_pNoteStore->createSavedSearch(
+                savedSearch, errorDescription, rateLimitSeconds);
+        });
+}
+
+qint32 MeteredNoteStore::updateSavedSearch(
+    SavedSearch & savedSearch, ErrorString & errorDescription,
+    qint32 & rateLimitSeconds)
+{
+    return callAndMeter(
+        *m_pSyncMetrics, QStringLiteral("updateSavedSearch"), [&] {
+            return m_pNoteStore->updateSavedSearch(
+                savedSearch, errorDescription, rateLimitSeconds);
+        });
+}
+
+qint32 MeteredNoteStore::getSyncState(
+    qevercloud::SyncState & syncState, ErrorString & errorDescription,
+    qint32 & rateLimitSeconds)
+{
+    return callAndMeter(*m_pSyncMetrics, QStringLiteral("getSyncState"), [&] {
+        return m_pNoteStore->getSyncState(
+            syncState, errorDescription, rateLimitSeconds);
+    });
+}
+
+qint32 MeteredNoteStore::getSyncChunk(
+    const qint32 afterUSN, const qint32 maxEntries,
+    const qevercloud::SyncChunkFilter & filter,
+    qevercloud::SyncChunk & syncChunk, ErrorString & errorDescription,
+    qint32 & rateLimitSeconds)
+{
+    return callAndMeter(*m_pSyncMetrics, QStringLiteral("getSyncChunk"), [&] {
+        return m_pNoteStore->getSyncChunk(
+            afterUSN, maxEntries, filter, syncChunk, errorDescription,
+            rateLimitSeconds);
+    });
+}
+
+qint32 MeteredNoteStore::getLinkedNotebookSyncState(
+    const qevercloud::LinkedNotebook & linkedNotebook,
+    const QString & authToken, qevercloud::SyncState & syncState,
+    ErrorString & errorDescription, qint32 & rateLimitSeconds)
+{
+    return callAndMeter(
+        *m_pSyncMetrics, QStringLiteral("getLinkedNotebookSyncState"), [&] {
+            return m_pNoteStore->getLinkedNotebookSyncState(
+                linkedNotebook, authToken, syncState, errorDescription,
+                rateLimitSeconds);
+        });
+}
+
+bool MeteredNoteStore::getLinkedNotebookSyncStateAsync(
+    const qevercloud::LinkedNotebook & linkedNotebook,
+    const QString & authToken, ErrorString & errorDescription)
+{
+    QString linkedNotebookGuid =
+        (linkedNotebook.guid.isSet() ? linkedNotebook.guid.ref() : QString());
+
+    startAsyncCall(
+        m_getLinkedNotebookSyncStateAsyncTimersByGuid, linkedNotebookGuid);
+
+    bool res = m_pNoteStore->getLinkedNotebookSyncStateAsync(
+        linkedNotebook, authToken, errorDescription);
+
+    if (!res) {
+        Q_UNUSED(m_getLinkedNotebookSyncStateAsyncTimersByGuid.remove(
+            linkedNotebookGuid))
+        updatePendingAsyncCallsCount();
+    }
+
+    return res;
+}
+
+qint32 MeteredNoteStore::getLinkedNotebookSyncChunk(
+    const qevercloud::LinkedNotebook & linkedNotebook, const qint32 afterUSN,
+    const qint32 maxEntries, const QString & linkedNotebookAuthToken,
+    const bool fullSyncOnly, qevercloud::SyncChunk & syncChunk,
+    ErrorString & errorDescription, qint32 & rateLimitSeconds)
+{
+    return callAndMeter(
+        *m_pSyncMetrics, QStringLiteral("getLinkedNotebookSyncChunk"), [&] {
+            return m_pNoteStore->getLinkedNotebookSyncChunk(
+                linkedNotebook, afterUSN, maxEntries, linkedNotebookAuthToken,
+                fullSyncOnly, syncChunk, errorDescription, rateLimitSeconds);
+        });
+}
+
+bool MeteredNoteStore::getLinkedNotebookSyncChunkAsync(
+    const qevercloud::LinkedNotebook & linkedNotebook, const qint32 afterUSN,
+    const qint32 maxEntries, const QString & linkedNotebookAuthToken,
+    const bool fullSyncOnly, ErrorString & errorDescription)
+{
+    QString linkedNotebookGuid =
+        (linkedNotebook.guid.isSet() ? linkedNotebook.guid.ref() : QString());
+
+    startAsyncCall(
+        m_getLinkedNotebookSyncChunkAsyncTimersByGuid, linkedNotebookGuid);
+
+    bool res = m_pNoteStore->getLinkedNotebookSyncChunkAsync(
+        linkedNotebook, afterUSN, maxEntries, linkedNotebookAuthToken,
+        fullSyncOnly, errorDescription);
+
+    if (!res) {
+        Q_UNUSED(m_getLinkedNotebookSyncChunkAsyncTimersByGuid.remove(
+            linkedNotebookGuid))
+        updatePendingAsyncCallsCount();
+    }
+
+    return res;
+}
+
+qint32 MeteredNoteStore::getNote(
+    const bool withContent, const bool withResourcesData,
+    const bool withResourcesRecognition, const bool withResourceAlternateData,
+    Note & note, ErrorString & errorDescription, qint32 & rateLimitSeconds)
+{
+    qint32 errorCode =
+        callAndMeter(*m_pSyncMetrics, QStringLiteral("getNote"), [&] {
+            return m_pNoteStore->getNote(
+                withContent, withResourcesData, withResourcesRecognition,
+                withResourceAlternateData, note, errorDescription,
+                rateLimitSeconds);
+        });
+
+    if (errorCode == 0) {
+        m_pSyncMetrics->addDownloadedBytes(noteBytes(note.qevercloudNote()));
+    }
+
+    return errorCode;
+}
+
+bool MeteredNoteStore::getNoteAsync(
+    const bool withContent, const bool withResourceData,
+    const bool withResourcesRecognition, const bool withResourceAlternateData,
+    const bool withSharedNotes, const bool withNoteAppDataValues,
+    const bool withResourceAppDataValues, const bool withNoteLimits,
+    const QString & noteGuid, const QString & authToken,
+    ErrorString & errorDescription)
+{
+    // The timer is started before the call because the decorated note store
+    // might report the result of the call before returning from it
+    startAsyncCall(m_getNoteAsyncTimersByGuid, noteGuid);
+
+    bool res = m_pNoteStore->getNoteAsync(
+        withContent, withResourceData, withResourcesRecognition,
+        withResourceAlternateData, withSharedNotes, withNoteAppDataValues,
+        withResourceAppDataValues, withNoteLimits, noteGuid, authToken,
+        errorDescription);
+
+    if (!res) {
+        Q_UNUSED(m_getNoteAsyncTimersByGuid.remove(noteGuid))
+        updatePendingAsyncCallsCount();
+    }
+
+    return res;
+}
+
+qint32 MeteredNoteStore::getResource(
+    const bool withDataBody, const bool withRecognitionDataBody,
+    const bool withAlternateDataBody, const bool withAttributes,
+    const QString & authToken, Resource & resource,
+    ErrorString & errorDescription, qint32 & rateLimitSeconds)
+{
+    qint32 errorCode =
+        callAndMeter(*m_pSyncMetrics, QStringLiteral("getResource"), [&] {
+            return m_pNoteStore->getResource(
+                withDataBody, withRecognitionDataBody, withAlternateDataBody,
+                withAttributes, authToken, resource, errorDescription,
+                rateLimitSeconds);
+        });
+
+    if (errorCode == 0) {
+        m_pSyncMetrics->addDownloadedBytes(
+            resourceBytes(resource.qevercloudResource()));
+    }
+
+    return errorCode;
+}
+
+bool MeteredNoteStore::getResourceAsync(
+    const bool withDataBody, const bool withRecognitionDataBody,
+    const bool withAlternateDataBody, const bool withAttributes,
+    const QString & resourceGuid, const QString & authToken,
+    ErrorString & errorDescription)
+{
+    startAsyncCall(m_getResourceAsyncTimersByGuid, resourceGuid);
+
+    bool res = m_pNoteStore->getResourceAsync(
+        withDataBody, withRecognitionDataBody, withAlternateDataBody,
+        withAttributes, resourceGuid, authToken, errorDescription);
+
+    if (!res) {
+        Q_UNUSED(m_getResourceAsyncTimersByGuid.remove(resourceGuid))
+        updatePendingAsyncCallsCount();
+    }
+
+    return res;
+}
+
+qint32 MeteredNoteStore::authenticateToSharedNotebook(
+    const QString & shareKey, qevercloud::AuthenticationResult & authResult,
+    ErrorString & errorDescription, qint32 & rateLimitSeconds)
+{
+    return callAndMeter(
+        *m_pSyncMetrics, QStringLiteral("authenticateToSharedNotebook"), [&] {
+            return m_pNoteStore->authenticateToSharedNotebook(
+                shareKey, authResult, errorDescription, rateLimitSeconds);
+        });
+}
+
+void MeteredNoteStore::onGetNoteAsyncFinished(
+    qint32 errorCode, qevercloud::Note note, qint32 rateLimitSeconds,
+    ErrorString errorDescription)
+{
+    finishAsyncCall(
+        m_getNoteAsyncTimersByGuid,
+        note.guid.isSet() ? note.guid.ref() : QString(),
+        QStringLiteral("getNoteAsync"), errorCode);
+
+    if (errorCode == 0) {
+        m_pSyncMetrics->addDownloadedBytes(noteBytes(note));
+    }
+
+    Q_EMIT getNoteAsyncFinished(
+        errorCode, note, rateLimitSeconds, errorDescription);
+}
+
+void MeteredNoteStore::onGetResourceAsyncFinished(
+    qint32 errorCode, qevercloud::Resource resource, qint32 rateLimitSeconds,
+    ErrorString errorDescription)
+{
+    finishAsyncCall(
+        m_getResourceAsyncTimersByGuid,
+        resource.guid.isSet() ? resource.guid.ref() : QString(),
+        QStringLiteral("getResourceAsync"), errorCode);
+
+    if (errorCode == 0) {
+        m_pSyncMetrics->addDownloadedBytes(resourceBytes(resource));
+    }
+
+    Q_EMIT getResourceAsyncFinished(
+        errorCode, resource, rateLimitSeconds, errorDescription);
+}
+
+void MeteredNoteStore::onGetLinkedNotebookSyncStateAsyncFinished(
+    qint32 errorCode, QString linkedNotebookGuid,
+    qevercloud::SyncState syncState, qint32 rateLimitSeconds,
+    ErrorString errorDescription)
+{
+    finishAsyncCall(
+        m_getLinkedNotebookSyncStateAsyncTimersByGuid, linkedNotebookGuid,
+        QStringLiteral("getLinkedNotebookSyncStateAsync"), errorCode);
+
+    Q_EMIT getLinkedNotebookSyncStateAsyncFinished(
+        errorCode, linkedNotebookGuid, syncState, rateLimitSeconds,
+        errorDescription);
+}
+
+void MeteredNoteStore::onGetLinkedNotebookSyncChunkAsyncFinished(
+    qint32 errorCode, QString linkedNotebookGuid, qint32 afterUSN,
+    qevercloud::SyncChunk syncChunk, qint32 rateLimitSeconds,
+    ErrorString errorDescription)
+{
+    finishAsyncCall(
+        m_getLinkedNotebookSyncChunkAsyncTimersByGuid, linkedNotebookGuid,
+        QStringLiteral("getLinkedNotebookSyncChunkAsync"), errorCode);
+
+    Q_EMIT getLinkedNotebookSyncChunkAsyncFinished(
+        errorCode, linkedNotebookGuid, afterUSN, syncChunk, rateLimitSeconds,
+        errorDescription);
+}
+
+void MeteredNoteStore::createConnections()
+{
+    QObject::connect(
+        m_pNoteStore.get(), &INoteStore::getNoteAsyncFinished, this,
+        &MeteredNoteStore::onGetNoteAsyncFinished);
+
+    QObject::connect(
+        m_pNoteStore.get(), &INoteStore::getResourceAsyncFinished, this,
+        &MeteredNoteStore::onGetResourceAsyncFinished);
+
+    QObject::connect(
+        m_pNoteStore.get(),
+        &INoteStore::getLinkedNotebookSyncStateAsyncFinished, this,
+        &MeteredNoteStore::onGetLinkedNotebookSyncStateAsyncFinished);
+
+    QObject::connect(
+        m_pNoteStore.get(),
+        &INoteStore::getLinkedNotebookSyncChunkAsyncFinished, this,
+        &MeteredNoteStore::onGetLinkedNotebookSyncChunkAsyncFinished);
+}
+
+void MeteredNoteStore::startAsyncCall(
+    QHash<QString, QElapsedTimer> & timersByGuid, const QString & guid)
+{
+    timersByGuid[guid].start();
+    updatePendingAsyncCallsCount();
+}
+
+void MeteredNoteStore::finishAsyncCall(
+    QHash<QString, QElapsedTimer> & timersByGuid, const QString & guid,
+    const QString & methodName, const qint32 errorCode)
+{
+    auto it = timersByGuid.find(guid);
+    if (it == timersByGuid.end()) {
+        return;
+    }
+
+    m_pSyncMetrics->addNoteStoreCall(
+        methodName, it.value().elapsed(), errorCode);
+    timersByGuid.erase(it);
+}
+
+void MeteredNoteStore::updatePendingAsyncCallsCount()
+{
+    int count = m_getNoteAsyncTimersByGuid.size() +
+        m_getResourceAsyncTimersByGuid.size() +
+        m_getLinkedNotebookSyncStateAsyncTimersByGuid.size() +
+        m_getLinkedNotebookSyncChunkAsyncTimersByGuid.size();
+
+    m_pSyncMetrics->setQueueDepth(
+        QStringLiteral("noteStoreAsyncCalls"), static_cast<quint64>(count));
+}
+
+} // namespace quentier
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_SYNCHRONIZATION_METERED_NOTE_STORE_H
+#define LIB_QUENTIER_SYNCHRONIZATION_METERED_NOTE_STORE_H
+
+#include <quentier/synchronization/INoteStore.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+
+#include <memory>
+
+namespace quentier {
+
+class SyncMetrics;
+
+/**
+ * @brief The MeteredNoteStore class is a decorator over another INoteStore
+ * implementation: it forwards all calls to the decorated note store and
+ * records their latencies, the amount of transferred data and the number of
+ * pending asynchronous calls into SyncMetrics
+ */
+class Q_DECL_HIDDEN MeteredNoteStore final : public INoteStore
+{
+    Q_OBJECT
+public:
+    explicit MeteredNoteStore(
+        INoteStorePtr pNoteStore, std::shared_ptr<SyncMetrics> pSyncMetrics,
+        QObject * parent = nullptr);
+
+    virtual ~MeteredNoteStore() override;
+
+    virtual INoteStore * create() const override;
+
+    virtual QString noteStoreUrl() const override;
+
+    virtual void setNoteStoreUrl(QString noteStoreUrl) override;
+
+    virtual void setAuthData(
+        QString authenticationToken, QList<QNetworkCookie> cookies) override;
+
+    virtual void stop() override;
+
+    virtual qint32 createNotebook(
+        Notebook & notebook, ErrorString & errorDescription,
+        qint32 & rateLimitSeconds,
+        QString linkedNotebookAuthToken = {}) override;
+
+    virtual qint32 updateNotebook(
+        Notebook & notebook, ErrorString & errorDescription,
+        qint32 & rateLimitSeconds,
+        QString linkedNotebookAuthToken = {}) override;
+
+    virtual qint32 createNote(
+        Note & note, ErrorString & errorDescription, qint32 & rateLimitSeconds,
+        QString linkedNotebookAuthToken = {}) override;
+
+    virtual qint32 updateNote(
+        Note & note, ErrorString & errorDescription, qint32 & rateLimitSeconds,
+        QString linkedNotebookAuthToken = {}) override;
+
+    virtual qint32 createTag(
+        Tag & tag, ErrorString & errorDescription, qint32 & rateLimitSeconds,
+        QString linkedNotebookAuthToken = {}) override;
+
+    virtual qint32 updateTag(
+        Tag & tag, ErrorString & errorDescription, qint32 & rateLimitSeconds,
+        QString linkedNotebookAuthToken = {}) override;
+
+    virtual qint32 createSavedSearch(
+        SavedSearch & savedSearch, ErrorString & errorDescription,
+        qint32 & rateLimitSeconds) override;
+
+    virtual qint32 updateSavedSearch(
+        SavedSearch & savedSearch, ErrorString & errorDescription,
+        qint32 & rateLimitSeconds) override;
+
+    virtual qint32 getSyncState(
+        qevercloud::SyncState & syncState, ErrorString & errorDescription,
+        qint32 & rateLimitSeconds) override;
+
+    virtual qint32 getSyncChunk(
+        const qint32 afterUSN, const qint32 maxEntries,
+        const qevercloud::SyncChunkFilter & filter,
+        qevercloud::SyncChunk & syncChunk, ErrorString & errorDescription,
+        qint32 & rateLimitSeconds) override;
+
+    virtual qint32 getLinkedNotebookSyncState(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const QString & authToken, qevercloud::SyncState & syncState,
+        ErrorString & errorDescription, qint32 & rateLimitSeconds) override;
+
+    virtual bool getLinkedNotebookSyncStateAsync(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const QString & authToken, ErrorString & errorDescription) override;
+
+    virtual qint32 getLinkedNotebookSyncChunk(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const qint32 afterUSN, const qint32 maxEntries,
+        const QString & linkedNotebookAuthToken, const bool fullSyncOnly,
+        qevercloud::SyncChunk & syncChunk, ErrorString & errorDescription,
+        qint32 & rateLimitSeconds) override;
+
+    virtual bool getLinkedNotebookSyncChunkAsync(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const qint32 afterUSN, const qint32 maxEntries,
+        const QString & linkedNotebookAuthToken, const bool fullSyncOnly,
+        ErrorString & errorDescription) override;
+
+    virtual qint32 getNote(
+        const bool withContent, const bool withResourcesData,
+        const bool withResourcesRecognition,
+        const bool withResourceAlternateData, Note & note,
+        ErrorString & errorDescription, qint32 & rateLimitSeconds) override;
+
+    virtual bool getNoteAsync(
+        const bool withContent, const bool withResourceData,
+        const bool withResourcesRecognition,
+        const bool withResourceAlternateData, const bool withSharedNotes,
+        const bool withNoteAppDataValues, const bool withResourceAppDataValues,
+        const bool withNoteLimits, const QString & noteGuid,
+        const QString & authToken, ErrorString & errorDescription) override;
+
+    virtual qint32 getResource(
+        const bool withDataBody, const bool withRecognitionDataBody,
+        const bool withAlternateDataBody, const bool withAttributes,
+        const QString & authToken, Resource & resource,
+        ErrorString & errorDescription, qint32 & rateLimitSeconds) override;
+
+    virtual bool getResourceAsync(
+        const bool withDataBody, const bool withRecognitionDataBody,
+        const bool withAlternateDataBody, const bool withAttributes,
+        const QString & resourceGuid, const QString & authToken,
+        ErrorString & errorDescription) override;
+
+    virtual qint32 authenticateToSharedNotebook(
+        const QString & shareKey, qevercloud::AuthenticationResult & authResult,
+        ErrorString & errorDescription, qint32 & rateLimitSeconds) override;
+
+private Q_SLOTS:
+    void onGetNoteAsyncFinished(
+        qint32 errorCode, qevercloud::Note note, qint32 rateLimitSeconds,
+        ErrorString errorDescription);
+
+    void onGetResourceAsyncFinished(
+        qint32 errorCode, qevercloud::Resource resource,
+        qint32 rateLimitSeconds, ErrorString errorDescription);
+
+    void onGetLinkedNotebookSyncStateAsyncFinished(
+        qint32 errorCode, QString linkedNotebookGuid,
+        qevercloud::SyncState syncState, qint32 rateLimitSeconds,
+        ErrorString errorDescription);
+
+    void onGetLinkedNotebookSyncChunkAsyncFinished(
+        qint32 errorCode, QString linkedNotebookGuid, qint32 afterUSN,
+        qevercloud::SyncChunk syncChunk, qint32 rateLimitSeconds,
+        ErrorString errorDescription);
+
+private:
+    void createConnections();
+
+    void startAsyncCall(
+        QHash<QString, QElapsedTimer> & timersByGuid, const QString & guid);
+
+    void finishAsyncCall(
+        QHash<QString, QElapsedTimer> & timersByGuid, const QString & guid,
+        const QString & methodName, const qint32 errorCode);
+
+    void updatePendingAsyncCallsCount();
+
+private:
+    Q_DISABLE_COPY(MeteredNoteStore)
+
+private:
+    INoteStorePtr m_pNoteStore;
+    std::shared_ptr<SyncMetrics> m_pSyncMetrics;
+
+    QHash<QString, QElapsedTimer> m_getNoteAsyncTimersByGuid;
+    QHash<QString, QElapsedTimer> m_getResourceAsyncTimersByGuid;
+
+    QHash<QString, QElapsedTimer>
+        m_getLinkedNotebookSyncStateAsyncTimersByGuid;
+
+    QHash<QString, QElapsedTimer>
+        m_getLinkedNotebookSyncChunkAsyncTimersByGuid;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_SYNCHRONIZATION_METERED_NOTE_STORE_H
@@ -100,6 +100,34 @@ void NoteStore::stop()
     }
 
     m_resourceRequestDataById.clear();
+
+    for (const auto it:
+         qevercloud::toRange(m_linkedNotebookSyncStateRequestDataById))
+    {
+        const auto & requestData = it.value();
+        if (!requestData.m_asyncResult.isNull()) {
+            QObject::disconnect(
+                requestData.m_asyncResult.data(),
+                &qevercloud::AsyncResult::finished, this,
+                &NoteStore::onGetLinkedNotebookSyncStateAsyncFinished);
+        }
+    }
+
+    m_linkedNotebookSyncStateRequestDataById.clear();
+
+    for (const auto it:
+         qevercloud::toRange(m_linkedNotebookSyncChunkRequestDataById))
+    {
+        const auto & requestData = it.value();
+        if (!requestData.m_asyncResult.isNull()) {
+            QObject::disconnect(
+                requestData.m_asyncResult.data(),
+                &qevercloud::AsyncResult::finished, this,
+                &NoteStore::onGetLinkedNotebookSyncChunkAsyncFinished);
+        }
+    }
+
+    m_linkedNotebookSyncChunkRequestDataById.clear();
 }
 
 qint32 NoteStore::createNotebook(
@@ -474,6 +502,49 @@ qint32 NoteStore::getLinkedNotebookSyncState(
     return static_cast<qint32>(qevercloud::EDAMErrorCode::UNKNOWN);
 }
 
+bool NoteStore::getLinkedNotebookSyncStateAsync(
+    const qevercloud::LinkedNotebook & linkedNotebook,
+    const QString & authToken, ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "synchronization:note_store",
+        "NoteStore::getLinkedNotebookSyncStateAsync: linked notebook guid = "
+            << (linkedNotebook.guid.isSet() ? linkedNotebook.guid.ref()
+                                            : QStringLiteral("<not set>")));
+
+    if (Q_UNLIKELY(!linkedNotebook.guid.isSet())) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Detected the attempt to get the sync state "
+                       "for linked notebook without guid"));
+        return false;
+    }
+
+    auto ctx = qevercloud::newRequestContext(
+        authToken, NOTE_STORE_REQUEST_TIMEOUT_MSEC);
+
+    qevercloud::AsyncResult * pAsyncResult =
+        m_pNoteStore->getLinkedNotebookSyncStateAsync(linkedNotebook, ctx);
+    if (Q_UNLIKELY(!pAsyncResult)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't get linked notebook sync state: internal "
+                       "error, QEverCloud library returned "
+                       "null pointer to asynchronous result object"));
+        return false;
+    }
+
+    auto & requestData =
+        m_linkedNotebookSyncStateRequestDataById[ctx->requestId()];
+    requestData.m_guid = linkedNotebook.guid.ref();
+    requestData.m_asyncResult = pAsyncResult;
+
+    QObject::connect(
+        pAsyncResult, &qevercloud::AsyncResult::finished, this,
+        &NoteStore::onGetLinkedNotebookSyncStateAsyncFinished,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::DirectConnection));
+
+    return true;
+}
+
 qint32 NoteStore::getLinkedNotebookSyncChunk(
     const qevercloud::LinkedNotebook & linkedNotebook, const qint32 afterUSN,
     const qint32 maxEntries, const QString & linkedNotebookAuthToken,
@@ -501,33 +572,8 @@ qint32 NoteStore::getLinkedNotebookSyncChunk(
             userException, afterUSN, maxEntries, errorDescription);
     }
     catch (const qevercloud::EDAMNotFoundException & notFoundException) {
-        errorDescription.setBase(
-            QT_TR_NOOP("caught EDAM not found exception while "
-                       "attempting to download the sync chunk "
-                       "for linked notebook"));
-        if (notFoundException.exceptionData()) {
-            const QString & errorMessage =
-                notFoundException.exceptionData()->errorMessage;
-            if (errorMessage == QStringLiteral("LinkedNotebook")) {
-                errorDescription.appendBase(
-                    QT_TR_NOOP("the provided information "
-                               "doesn't match any valid notebook"));
-            }
-            else if (errorMessage == QStringLiteral("LinkedNotebook.uri")) {
-                errorDescription.appendBase(
-                    QT_TR_NOOP("the provided public URI "
-                               "doesn't match any valid notebook"));
-            }
-            else if (errorMessage == QStringLiteral("SharedNotebook.id")) {
-                errorDescription.appendBase(
-                    QT_TR_NOOP("the provided information indicates the shared "
-                               "notebook no longer exists"));
-            }
-            else {
-                errorDescription.appendBase(QT_TR_NOOP("unknown error"));
-                errorDescription.details() = errorMessage;
-            }
-        }
+        processEdamNotFoundExceptionForGetLinkedNotebookSyncChunk(
+            notFoundException, errorDescription);
 
         // FIXME: should actually return properly typed
         // qevercloud::EDAMErrorCode
@@ -543,6 +589,55 @@ qint32 NoteStore::getLinkedNotebookSyncChunk(
     return static_cast<qint32>(qevercloud::EDAMErrorCode::UNKNOWN);
 }
 
+bool NoteStore::getLinkedNotebookSyncChunkAsync(
+    const qevercloud::LinkedNotebook & linkedNotebook, const qint32 afterUSN,
+    const qint32 maxEntries, const QString & linkedNotebookAuthToken,
+    const bool fullSyncOnly, ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "synchronization:note_store",
+        "NoteStore::getLinkedNotebookSyncChunkAsync: linked notebook guid = "
+            << (linkedNotebook.guid.isSet() ? linkedNotebook.guid.ref()
+                                            : QStringLiteral("<not set>"))
+            << ", after USN = " << afterUSN << ", max entries = " << maxEntries
+            << ", full sync only = " << (fullSyncOnly ? "true" : "false"));
+
+    if (Q_UNLIKELY(!linkedNotebook.guid.isSet())) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Detected the attempt to get the sync chunk "
+                       "for linked notebook without guid"));
+        return false;
+    }
+
+    auto ctx = qevercloud::newRequestContext(
+        linkedNotebookAuthToken, NOTE_STORE_REQUEST_TIMEOUT_MSEC);
+
+    qevercloud::AsyncResult * pAsyncResult =
+        m_pNoteStore->getLinkedNotebookSyncChunkAsync(
+            linkedNotebook, afterUSN, maxEntries, fullSyncOnly, ctx);
+    if (Q_UNLIKELY(!pAsyncResult)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Can't get linked notebook sync chunk: internal "
+                       "error, QEverCloud library returned "
+                       "null pointer to asynchronous result object"));
+        return false;
+    }
+
+    auto & requestData =
+        m_linkedNotebookSyncChunkRequestDataById[ctx->requestId()];
+    requestData.m_guid = linkedNotebook.guid.ref();
+    requestData.m_afterUsn = afterUSN;
+    requestData.m_maxEntries = maxEntries;
+    requestData.m_asyncResult = pAsyncResult;
+
+    QObject::connect(
+        pAsyncResult, &qevercloud::AsyncResult::finished, this,
+        &NoteStore::onGetLinkedNotebookSyncChunkAsyncFinished,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::DirectConnection));
+
+    return true;
+}
+
 qint32 NoteStore::getNote(
     const bool withContent, const bool withResourcesData,
     const bool withResourcesRecognition, const bool withResourceAlternateData,
@@ -1033,6 +1128,149 @@ void NoteStore::onGetResourceAsyncFinished(
         errorCode, resource, rateLimitSeconds, errorDescription);
 }
 
+void NoteStore::onGetLinkedNotebookSyncStateAsyncFinished(
+    QVariant result, EverCloudExceptionDataPtr exceptionData,
+    IRequestContextPtr ctx)
+{
+    QNDEBUG(
+        "synchronization:note_store",
+        "NoteStore"
+            << "::onGetLinkedNotebookSyncStateAsyncFinished");
+
+    auto it = m_linkedNotebookSyncStateRequestDataById.find(ctx->requestId());
+    if (Q_UNLIKELY(it == m_linkedNotebookSyncStateRequestDataById.end())) {
+        QNWARNING(
+            "synchronization:note_store",
+            "Received "
+                << "getLinkedNotebookSyncStateAsyncFinished event for "
+                << "unidentified request id: " << ctx->requestId());
+        return;
+    }
+
+    const auto & requestData = it.value();
+    QString linkedNotebookGuid = requestData.m_guid;
+    if (!requestData.m_asyncResult.isNull()) {
+        requestData.m_asyncResult.data()->disconnect(this);
+    }
+
+    m_linkedNotebookSyncStateRequestDataById.erase(it);
+
+    ErrorString errorDescription;
+    qint32 errorCode = 0;
+    qint32 rateLimitSeconds = -1;
+    qevercloud::SyncState syncState;
+
+    if (exceptionData) {
+        QNDEBUG(
+            "synchronization:note_store",
+            "Error: " << exceptionData->errorMessage);
+
+        try {
+            exceptionData->throwException();
+        }
+        catch (const qevercloud::EDAMUserException & userException) {
+            SET_EDAM_USER_EXCEPTION_ERROR(userException)
+            // FIXME: should actually return properly typed
+            // qevercloud::EDAMErrorCode
+            errorCode = static_cast<int>(userException.errorCode);
+        }
+        catch (const qevercloud::EDAMNotFoundException & notFoundException) {
+            processEdamNotFoundException(notFoundException, errorDescription);
+            // FIXME: should actually return properly typed
+            // qevercloud::EDAMErrorCode
+            errorCode = static_cast<int>(qevercloud::EDAMErrorCode::UNKNOWN);
+        }
+        catch (const qevercloud::EDAMSystemException & systemException) {
+            errorCode = processEdamSystemException(
+                systemException, errorDescription, rateLimitSeconds);
+        }
+        CATCH_GENERIC_EXCEPTIONS_IMPL(
+            errorCode = static_cast<int>(qevercloud::EDAMErrorCode::UNKNOWN))
+
+        Q_EMIT getLinkedNotebookSyncStateAsyncFinished(
+            errorCode, linkedNotebookGuid, syncState, rateLimitSeconds,
+            errorDescription);
+        return;
+    }
+
+    syncState = result.value<qevercloud::SyncState>();
+    Q_EMIT getLinkedNotebookSyncStateAsyncFinished(
+        errorCode, linkedNotebookGuid, syncState, rateLimitSeconds,
+        errorDescription);
+}
+
+void NoteStore::onGetLinkedNotebookSyncChunkAsyncFinished(
+    QVariant result, EverCloudExceptionDataPtr exceptionData,
+    IRequestContextPtr ctx)
+{
+    QNDEBUG(
+        "synchronization:note_store",
+        "NoteStore"
+            << "::onGetLinkedNotebookSyncChunkAsyncFinished");
+
+    auto it = m_linkedNotebookSyncChunkRequestDataById.find(ctx->requestId());
+    if (Q_UNLIKELY(it == m_linkedNotebookSyncChunkRequestDataById.end())) {
+        QNWARNING(
+            "synchronization:note_store",
+            "Received "
+                << "getLinkedNotebookSyncChunkAsyncFinished event for "
+                << "unidentified request id: " << ctx->requestId());
+        return;
+    }
+
+    const auto & requestData = it.value();
+    QString linkedNotebookGuid = requestData.m_guid;
+    qint32 afterUsn = requestData.m_afterUsn;
+    qint32 maxEntries = requestData.m_maxEntries;
+    if (!requestData.m_asyncResult.isNull()) {
+        requestData.m_asyncResult.data()->disconnect(this);
+    }
+
+    m_linkedNotebookSyncChunkRequestDataById.erase(it);
+
+    ErrorString errorDescription;
+    qint32 errorCode = 0;
+    qint32 rateLimitSeconds = -1;
+    qevercloud::SyncChunk syncChunk;
+
+    if (exceptionData) {
+        QNDEBUG(
+            "synchronization:note_store",
+            "Error: " << exceptionData->errorMessage);
+
+        try {
+            exceptionData->throwException();
+        }
+        catch (const qevercloud::EDAMUserException & userException) {
+            errorCode = processEdamUserExceptionForGetSyncChunk(
+                userException, afterUsn, maxEntries, errorDescription);
+        }
+        catch (const qevercloud::EDAMNotFoundException & notFoundException) {
+            processEdamNotFoundExceptionForGetLinkedNotebookSyncChunk(
+                notFoundException, errorDescription);
+            // FIXME: should actually return properly typed
+            // qevercloud::EDAMErrorCode
+            errorCode = static_cast<int>(qevercloud::EDAMErrorCode::UNKNOWN);
+        }
+        catch (const qevercloud::EDAMSystemException & systemException) {
+            errorCode = processEdamSystemException(
+                systemException, errorDescription, rateLimitSeconds);
+        }
+        CATCH_GENERIC_EXCEPTIONS_IMPL(
+            errorCode = static_cast<int>(qevercloud::EDAMErrorCode::UNKNOWN))
+
+        Q_EMIT getLinkedNotebookSyncChunkAsyncFinished(
+            errorCode, linkedNotebookGuid, afterUsn, syncChunk,
+            rateLimitSeconds, errorDescription);
+        return;
+    }
+
+    syncChunk = result.value<qevercloud::SyncChunk>();
+    Q_EMIT getLinkedNotebookSyncChunkAsyncFinished(
+        errorCode, linkedNotebookGuid, afterUsn, syncChunk, rateLimitSeconds,
+        errorDescription);
+}
+
 qint32 NoteStore::processEdamUserExceptionForTag(
     const Tag & tag, const qevercloud::EDAMUserException & userException,
     const NoteStore::UserExceptionSource & source,
@@ -2227,6 +2465,42 @@ void NoteStore::processEdamNotFoundException(
     }
 }
 
+void NoteStore::processEdamNotFoundExceptionForGetLinkedNotebookSyncChunk(
+    const qevercloud::EDAMNotFoundException & notFoundException,
+    ErrorString & errorDescription) const
+{
+    errorDescription.setBase(
+        QT_TR_NOOP("caught EDAM not found exception while "
+                   "attempting to download the sync chunk "
+                   "for linked notebook"));
+
+    if (!notFoundException.exceptionData()) {
+        return;
+    }
+
+    const QString & errorMessage =
+        notFoundException.exceptionData()->errorMessage;
+    if (errorMessage == QStringLiteral("LinkedNotebook")) {
+        errorDescription.appendBase(
+            QT_TR_NOOP("the provided information "
+                       "doesn't match any valid notebook"));
+    }
+    else if (errorMessage == QStringLiteral("LinkedNotebook.uri")) {
+        errorDescription.appendBase(
+            QT_TR_NOOP("the provided public URI "
+                       "doesn't match any valid notebook"));
+    }
+    else if (errorMessage == QStringLiteral("SharedNotebook.id")) {
+        errorDescription.appendBase(
+            QT_TR_NOOP("the provided information indicates the shared "
+                       "notebook no longer exists"));
+    }
+    else {
+        errorDescription.appendBase(QT_TR_NOOP("unknown error"));
+        errorDescription.details() = errorMessage;
+    }
+}
+
 void NoteStore::processNextPendingGetNoteAsyncRequest()
 {
     QNDEBUG(
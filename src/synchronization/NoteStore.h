@@ -123,6 +123,10 @@ public:
         const QString & authToken, qevercloud::SyncState & syncState,
         ErrorString & errorDescription, qint32 & rateLimitSeconds) override;
 
+    virtual bool getLinkedNotebookSyncStateAsync(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const QString & authToken, ErrorString & errorDescription) override;
+
     virtual qint32 getLinkedNotebookSyncChunk(
         const qevercloud::LinkedNotebook & linkedNotebook,
         const qint32 afterUSN, const qint32 maxEntries,
@@ -130,6 +134,12 @@ public:
         qevercloud::SyncChunk & syncChunk, ErrorString & errorDescription,
         qint32 & rateLimitSeconds) override;
 
+    virtual bool getLinkedNotebookSyncChunkAsync(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const qint32 afterUSN, const qint32 maxEntries,
+        const QString & linkedNotebookAuthToken, const bool fullSyncOnly,
+        ErrorString & errorDescription) override;
+
     virtual qint32 getNote(
         const bool withContent, const bool withResourcesData,
         const bool withResourcesRecognition,
@@ -173,6 +183,14 @@ private Q_SLOTS:
         QVariant result, EverCloudExceptionDataPtr exceptionData,
         IRequestContextPtr ctx);
 
+    void onGetLinkedNotebookSyncStateAsyncFinished(
+        QVariant result, EverCloudExceptionDataPtr exceptionData,
+        IRequestContextPtr ctx);
+
+    void onGetLinkedNotebookSyncChunkAsyncFinished(
+        QVariant result, EverCloudExceptionDataPtr exceptionData,
+        IRequestContextPtr ctx);
+
 private:
     enum class UserExceptionSource
     {
@@ -231,6 +249,10 @@ private:
         const qevercloud::EDAMNotFoundException & notFoundException,
         ErrorString & errorDescription) const;
 
+    void processEdamNotFoundExceptionForGetLinkedNotebookSyncChunk(
+        const qevercloud::EDAMNotFoundException & notFoundException,
+        ErrorString & errorDescription) const;
+
     void processNextPendingGetNoteAsyncRequest();
 
 private:
@@ -246,6 +268,14 @@ private:
         QPointer<qevercloud::AsyncResult> m_asyncResult;
     };
 
+    struct LinkedNotebookSyncChunkRequestData
+    {
+        QString m_guid;
+        qint32 m_afterUsn = 0;
+        qint32 m_maxEntries = 0;
+        QPointer<qevercloud::AsyncResult> m_asyncResult;
+    };
+
     struct GetNoteRequest
     {
         QString m_guid;
@@ -268,6 +298,9 @@ private:
 
     QHash<QUuid, RequestData> m_noteRequestDataById;
     QHash<QUuid, RequestData> m_resourceRequestDataById;
+    QHash<QUuid, RequestData> m_linkedNotebookSyncStateRequestDataById;
+    QHash<QUuid, LinkedNotebookSyncChunkRequestData>
+        m_linkedNotebookSyncChunkRequestDataById;
 };
 
 } // namespace quentier
@@ -76,7 +76,8 @@
 #define ACCOUNT_LIMITS_NOTE_RESOURCE_COUNT_MAX_KEY                             \
     QStringLiteral("note_resource_count_max")
 
-#define SYNC_SETTINGS_KEY_GROUP QStringLiteral("SynchronizationSettings")
+// Downloaded sync chunks beyond this number are buffered on disk
+#define SYNC_CHUNKS_IN_MEMORY_MAX (20)
 
 #define SHOULD_DOWNLOAD_NOTE_THUMBNAILS QStringLiteral("DownloadNoteThumbnails")
 #define SHOULD_DOWNLOAD_INK_NOTE_IMAGES QStringLiteral("DownloadInkNoteImages")
@@ -165,6 +166,45 @@ QString dumpLinkedNotebookGuidsByTagGuids(
     return info;
 }
 
+template <class ElementType>
+SyncChunksBuffer::DataElement syncChunksBufferDataElement();
+
+template <>
+SyncChunksBuffer::DataElement syncChunksBufferDataElement<SavedSearch>()
+{
+    return SyncChunksBuffer::DataElement::SavedSearches;
+}
+
+template <>
+SyncChunksBuffer::DataElement syncChunksBufferDataElement<LinkedNotebook>()
+{
+    return SyncChunksBuffer::DataElement::LinkedNotebooks;
+}
+
+template <>
+SyncChunksBuffer::DataElement syncChunksBufferDataElement<Tag>()
+{
+    return SyncChunksBuffer::DataElement::Tags;
+}
+
+template <>
+SyncChunksBuffer::DataElement syncChunksBufferDataElement<Notebook>()
+{
+    return SyncChunksBuffer::DataElement::Notebooks;
+}
+
+template <>
+SyncChunksBuffer::DataElement syncChunksBufferDataElement<Note>()
+{
+    return SyncChunksBuffer::DataElement::Notes;
+}
+
+template <>
+SyncChunksBuffer::DataElement syncChunksBufferDataElement<Resource>()
+{
+    return SyncChunksBuffer::DataElement::Resources;
+}
+
 } // namespace
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -192,6 +232,9 @@ RemoteToLocalSynchronizationManager::RemoteToLocalSynchronizationManager(
     IManager & manager, const QString & host, QObject * parent) :
     QObject(parent),
     m_manager(manager), m_host(host),
+    m_syncChunks(SYNC_CHUNKS_IN_MEMORY_MAX),
+    m_linkedNotebookSyncChunks(SYNC_CHUNKS_IN_MEMORY_MAX),
+    m_guidIndex(m_manager.localStorageManagerAsync()),
     m_syncChunksDataCounters(std::make_shared<SyncChunksDataCounters>()),
     m_linkedNotebookSyncChunksDataCounters(
         std::make_shared<SyncChunksDataCounters>()),
@@ -424,6 +467,7 @@ void RemoteToLocalSynchronizationManager::start(qint32 afterUsn)
     clear();
 
     connectToLocalStorage();
+    m_guidIndex.fill();
     m_lastUsnOnStart = afterUsn;
     m_active = true;
 
@@ -546,6 +590,9 @@ void RemoteToLocalSynchronizationManager::emitAddRequest<Tag>(const Tag & tag)
             << "tag to local storage: request id = " << addTagRequestId
             << ", tag: " << tag);
 
+    m_manager.syncMetrics().startLocalStorageRequest(
+        addTagRequestId, QStringLiteral("addTag"));
+
     Q_EMIT addTag(tag, addTagRequestId);
 }
 
@@ -568,6 +615,9 @@ void RemoteToLocalSynchronizationManager::emitAddRequest<SavedSearch>(
             << "saved search to local storage: request id = "
             << addSavedSearchRequestId << ", saved search: " << search);
 
+    m_manager.syncMetrics().startLocalStorageRequest(
+        addSavedSearchRequestId, QStringLiteral("addSavedSearch"));
+
     Q_EMIT addSavedSearch(search, addSavedSearchRequestId);
 }
 
@@ -613,6 +663,9 @@ void RemoteToLocalSynchronizationManager::emitAddRequest<Notebook>(
             << "notebook to local storage: request id = "
             << addNotebookRequestId << ", notebook: " << notebook);
 
+    m_manager.syncMetrics().startLocalStorageRequest(
+        addNotebookRequestId, QStringLiteral("addNotebook"));
+
     Q_EMIT addNotebook(notebook, addNotebookRequestId);
 }
 
@@ -634,6 +687,9 @@ void RemoteToLocalSynchronizationManager::emitAddRequest<Note>(
             << "note to the local storage: request id = " << addNoteRequestId
             << ", note: " << note);
 
+    m_manager.syncMetrics().startLocalStorageRequest(
+        addNoteRequestId, QStringLiteral("addNote"));
+
     Q_EMIT addNote(note, addNoteRequestId);
 }
 
@@ -1032,6 +1088,7 @@ void RemoteToLocalSynchronizationManager::onFindNoteCompleted(
         // NOTE: erase is required for proper work of the macro; the request
         // would be re-inserted below if macro doesn't return from the method
         Q_UNUSED(m_findNoteByGuidRequestIds.erase(it));
+        m_manager.syncMetrics().finishLocalStorageRequest(requestId);
 
         // Need to find Notebook corresponding to the note in order to proceed
         if (Q_UNLIKELY(!note.hasNotebookGuid())) {
@@ -1235,6 +1292,7 @@ void RemoteToLocalSynchronizationManager::onFindNoteFailed(
                 << note << ", requestId = " << requestId);
 
         Q_UNUSED(m_findNoteByGuidRequestIds.erase(it));
+        m_manager.syncMetrics().finishLocalStorageRequest(requestId);
 
         auto it = findItemByGuid(m_notes, note, QStringLiteral("Note"));
         if (it == m_notes.end()) {
@@ -1312,6 +1370,111 @@ void RemoteToLocalSynchronizationManager::onFindTagFailed(
         m_findTagByNameRequestIds))
 }
 
+void RemoteToLocalSynchronizationManager::onFindOrAddTagsCompleted(
+    QList<Tag> addedTags, QHash<QString, Tag> localConflictsByGuid,
+    QUuid requestId)
+{
+    if (requestId != m_findOrAddTagsRequestId) {
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "RemoteToLocalSynchronizationManager::onFindOrAddTagsCompleted: "
+            << "added " << addedTags.size() << " tags, found "
+            << localConflictsByGuid.size()
+            << " local conflicts, request id = " << requestId);
+
+    m_findOrAddTagsRequestId = QUuid();
+    m_manager.syncMetrics().finishLocalStorageRequest(requestId);
+
+    quint64 & addedTagsCounter =
+        (syncingLinkedNotebooksContent()
+             ? m_linkedNotebookSyncChunksDataCounters->m_addedTags
+             : m_syncChunksDataCounters->m_addedTags);
+
+    quint64 & updatedTagsCounter =
+        (syncingLinkedNotebooksContent()
+             ? m_linkedNotebookSyncChunksDataCounters->m_updatedTags
+             : m_syncChunksDataCounters->m_updatedTags);
+
+    for (const auto & tag: qAsConst(addedTags)) {
+        auto it = findItemByGuid(m_tags, tag, QStringLiteral("Tag"));
+        if (it == m_tags.end()) {
+            return;
+        }
+
+        Q_UNUSED(m_tags.erase(it))
+        Q_UNUSED(m_guidsOfTagsLevelInProcessing.remove(tag.guid()))
+        ++addedTagsCounter;
+    }
+
+    // Tags which have local counterparts go through the regular sync
+    // conflicts resolution
+    for (const auto it: qevercloud::toRange(qAsConst(localConflictsByGuid))) {
+        Tag tag;
+        tag.setGuid(it.key());
+
+        auto tagIt = findItemByGuid(m_tags, tag, QStringLiteral("Tag"));
+        if (tagIt == m_tags.end()) {
+            return;
+        }
+
+        const qevercloud::Tag remoteTag = *tagIt;
+        Q_UNUSED(m_tags.erase(tagIt))
+
+        const auto status = resolveSyncConflict(remoteTag, it.value());
+        if (status == ResolveSyncConflictStatus::Pending) {
+            auto pendingTagIt = std::find_if(
+                m_tagsPendingAddOrUpdate.begin(),
+                m_tagsPendingAddOrUpdate.end(),
+                CompareItemByGuid<qevercloud::Tag>(it.key()));
+
+            if (pendingTagIt == m_tagsPendingAddOrUpdate.end()) {
+                m_tagsPendingAddOrUpdate << remoteTag;
+            }
+
+            continue;
+        }
+
+        Q_UNUSED(m_guidsOfTagsLevelInProcessing.remove(it.key()))
+        ++updatedTagsCounter;
+    }
+
+    emitSyncChunkDataCountersUpdate();
+
+    syncNextTagsLevelPendingProcessing();
+    checkNotebooksAndTagsSyncCompletionAndLaunchNotesAndResourcesSync();
+    checkServerDataMergeCompletion();
+}
+
+void RemoteToLocalSynchronizationManager::onFindOrAddTagsFailed(
+    QList<Tag> tags, ErrorString errorDescription, QUuid requestId)
+{
+    if (requestId != m_findOrAddTagsRequestId) {
+        return;
+    }
+
+    QNWARNING(
+        "synchronization:remote_to_local",
+        "RemoteToLocalSynchronizationManager::onFindOrAddTagsFailed: "
+            << tags.size() << " tags, error description = "
+            << errorDescription << ", request id = " << requestId);
+
+    m_findOrAddTagsRequestId = QUuid();
+
+    m_manager.syncMetrics().finishLocalStorageRequest(
+        requestId, /* success = */ false);
+
+    ErrorString error(
+        QT_TR_NOOP("Failed to add the tags fetched from the remote database "
+                   "to the local storage"));
+    error.additionalBases().append(errorDescription.base());
+    error.additionalBases().append(errorDescription.additionalBases());
+    error.details() = errorDescription.details();
+    Q_EMIT failure(error);
+}
+
 void RemoteToLocalSynchronizationManager::onFindResourceCompleted(
     Resource resource, LocalStorageManager::GetResourceOptions options,
     QUuid requestId)
@@ -1530,6 +1693,7 @@ void RemoteToLocalSynchronizationManager::onAddDataElementCompleted(
                 << " = " << element << ", requestId = " << requestId);
 
         Q_UNUSED(addElementRequestIds.erase(it));
+        m_manager.syncMetrics().finishLocalStorageRequest(requestId);
 
         if (pSyncChunkDataCounter) {
             ++(*pSyncChunkDataCounter);
@@ -1617,6 +1781,8 @@ void RemoteToLocalSynchronizationManager::onAddDataElementFailed(
                 << ", requestId = " << requestId);
 
         Q_UNUSED(addElementRequestIds.erase(it));
+        m_manager.syncMetrics().finishLocalStorageRequest(
+            requestId, /* success = */ false);
 
         ErrorString error(QT_TRANSLATE_NOOP(
             "RemoteToLocalSynchronizationManager",
@@ -1885,7 +2051,12 @@ void RemoteToLocalSynchronizationManager::performPostAddOrUpdateChecks<Tag>(
             << "<Tag>: " << tag);
 
     unregisterTagPendingAddOrUpdate(tag);
-    syncNextTagPendingProcessing();
+
+    if (tag.hasGuid()) {
+        Q_UNUSED(m_guidsOfTagsLevelInProcessing.remove(tag.guid()))
+    }
+
+    syncNextTagsLevelPendingProcessing();
     checkNotebooksAndTagsSyncCompletionAndLaunchNotesAndResourcesSync();
     checkServerDataMergeCompletion();
 }
@@ -1988,6 +2159,7 @@ void RemoteToLocalSynchronizationManager::onExpungeDataElementCompleted(
         "Expunged " << typeName << " from local storage: " << element);
 
     Q_UNUSED(expungeElementRequestIds.erase(it))
+    m_manager.syncMetrics().finishLocalStorageRequest(requestId);
 
     if (pSyncChunkDataCounter) {
         ++(*pSyncChunkDataCounter);
@@ -2020,6 +2192,8 @@ void RemoteToLocalSynchronizationManager::onExpungeDataElementFailed(
             << "existed in the local storage in the first place. "
             << "Error description: " << errorDescription);
     Q_UNUSED(expungeElementRequestIds.erase(it))
+    m_manager.syncMetrics().finishLocalStorageRequest(
+        requestId, /* success = */ false);
 
     if (pSyncChunkDataCounter) {
         ++(*pSyncChunkDataCounter);
@@ -2057,6 +2231,10 @@ void RemoteToLocalSynchronizationManager::expungeTags()
             "Emitting the request to "
                 << "expunge tag: guid = " << expungedTagGuid
                 << ", request id = " << expungeTagRequestId);
+
+        m_manager.syncMetrics().startLocalStorageRequest(
+            expungeTagRequestId, QStringLiteral("expungeTag"));
+
         Q_EMIT expungeTag(tagToExpunge, expungeTagRequestId);
     }
 
@@ -2092,6 +2270,9 @@ void RemoteToLocalSynchronizationManager::expungeSavedSearches()
                 << "expunge saved search: guid = " << expungedSavedSerchGuid
                 << ", request id = " << expungeSavedSearchRequestId);
 
+        m_manager.syncMetrics().startLocalStorageRequest(
+            expungeSavedSearchRequestId, QStringLiteral("expungeSavedSearch"));
+
         Q_EMIT expungeSavedSearch(searchToExpunge, expungeSavedSearchRequestId);
     }
 
@@ -2163,6 +2344,9 @@ void RemoteToLocalSynchronizationManager::expungeNotebooks()
                 << "expunge notebook: notebook guid = " << expungedNotebookGuid
                 << ", request id = " << expungeNotebookRequestId);
 
+        m_manager.syncMetrics().startLocalStorageRequest(
+            expungeNotebookRequestId, QStringLiteral("expungeNotebook"));
+
         Q_EMIT expungeNotebook(notebookToExpunge, expungeNotebookRequestId);
     }
 
@@ -2197,6 +2381,9 @@ void RemoteToLocalSynchronizationManager::expungeNotes()
                 << "expunge note: guid = " << expungedNoteGuid
                 << ", request id = " << expungeNoteRequestId);
 
+        m_manager.syncMetrics().startLocalStorageRequest(
+            expungeNoteRequestId, QStringLiteral("expungeNote"));
+
         Q_EMIT expungeNote(noteToExpunge, expungeNoteRequestId);
     }
 
@@ -2426,12 +2613,28 @@ void RemoteToLocalSynchronizationManager::emitFindByGuidRequest<
     QUuid requestId = QUuid::createUuid();
     Q_UNUSED(m_findTagByGuidRequestIds.insert(requestId))
 
+    if (m_guidIndex.isFilled() && !m_guidIndex.findTag(tag.guid())) {
+        QNTRACE(
+            "synchronization:remote_to_local",
+            "No tag with such guid in the local storage according to "
+                << "the guid index, request id = " << requestId);
+
+        // Simulating the failed find, asynchronously just like the real one
+        QMetaObject::invokeMethod(
+            this, "onFindTagFailed", Qt::QueuedConnection, Q_ARG(Tag, tag),
+            Q_ARG(ErrorString, ErrorString()), Q_ARG(QUuid, requestId));
+        return;
+    }
+
     QNTRACE(
         "synchronization:remote_to_local",
         "Emitting the request to find "
             << "tag in the local storage: "
             << "request id = " << requestId << ", tag: " << tag);
 
+    m_manager.syncMetrics().startLocalStorageRequest(
+        requestId, QStringLiteral("findTagByGuid"));
+
     Q_EMIT findTag(tag, requestId);
 }
 
@@ -2464,11 +2667,29 @@ void RemoteToLocalSynchronizationManager::emitFindByGuidRequest<
     QUuid requestId = QUuid::createUuid();
     Q_UNUSED(m_findSavedSearchByGuidRequestIds.insert(requestId));
 
+    if (m_guidIndex.isFilled() && !m_guidIndex.findSavedSearch(search.guid()))
+    {
+        QNTRACE(
+            "synchronization:remote_to_local",
+            "No saved search with such guid in the local storage according "
+                << "to the guid index, request id = " << requestId);
+
+        QMetaObject::invokeMethod(
+            this, "onFindSavedSearchFailed", Qt::QueuedConnection,
+            Q_ARG(SavedSearch, search), Q_ARG(ErrorString, ErrorString()),
+            Q_ARG(QUuid, requestId));
+        return;
+    }
+
     QNTRACE(
         "synchronization:remote_to_local",
         "Emitting the request to find "
             << "saved search in the local storage: request id = " << requestId
             << ", saved search: " << search);
+
+    m_manager.syncMetrics().startLocalStorageRequest(
+        requestId, QStringLiteral("findSavedSearchByGuid"));
+
     Q_EMIT findSavedSearch(search, requestId);
 }
 
@@ -2500,11 +2721,29 @@ void RemoteToLocalSynchronizationManager::emitFindByGuidRequest<
 
     QUuid requestId = QUuid::createUuid();
     Q_UNUSED(m_findNotebookByGuidRequestIds.insert(requestId));
+
+    if (m_guidIndex.isFilled() && !m_guidIndex.findNotebook(notebook.guid())) {
+        QNTRACE(
+            "synchronization:remote_to_local",
+            "No notebook with such guid in the local storage according to "
+                << "the guid index, request id = " << requestId);
+
+        QMetaObject::invokeMethod(
+            this, "onFindNotebookFailed", Qt::QueuedConnection,
+            Q_ARG(Notebook, notebook), Q_ARG(ErrorString, ErrorString()),
+            Q_ARG(QUuid, requestId));
+        return;
+    }
+
     QNTRACE(
         "synchronization:remote_to_local",
         "Emitting the request to find "
             << "notebook in the local storage: request id = " << requestId
             << ", notebook: " << notebook);
+
+    m_manager.syncMetrics().startLocalStorageRequest(
+        requestId, QStringLiteral("findNotebookByGuid"));
+
     Q_EMIT findNotebook(notebook, requestId);
 }
 
@@ -2585,14 +2824,30 @@ void RemoteToLocalSynchronizationManager::emitFindByGuidRequest<
     QUuid requestId = QUuid::createUuid();
     Q_UNUSED(m_findNoteByGuidRequestIds.insert(requestId))
 
+    LocalStorageManager::GetNoteOptions options =
+        LocalStorageManager::GetNoteOption::WithResourceMetadata;
+
+    if (m_guidIndex.isFilled() && !m_guidIndex.findNote(note.guid())) {
+        QNTRACE(
+            "synchronization:remote_to_local",
+            "No note with such guid in the local storage according to "
+                << "the guid index, request id = " << requestId);
+
+        QMetaObject::invokeMethod(
+            this, "onFindNoteFailed", Qt::QueuedConnection, Q_ARG(Note, note),
+            Q_ARG(LocalStorageManager::GetNoteOptions, options),
+            Q_ARG(ErrorString, ErrorString()), Q_ARG(QUuid, requestId));
+        return;
+    }
+
     QNTRACE(
         "synchronization:remote_to_local",
         "Emitting the request to find "
             << "note in the local storage: request id = " << requestId
             << ", note: " << note);
 
-    LocalStorageManager::GetNoteOptions options =
-        LocalStorageManager::GetNoteOption::WithResourceMetadata;
+    m_manager.syncMetrics().startLocalStorageRequest(
+        requestId, QStringLiteral("findNoteByGuid"));
 
     Q_EMIT findNote(note, options, requestId);
 }
@@ -2958,6 +3213,7 @@ void RemoteToLocalSynchronizationManager::onUpdateNoteCompleted(
                 << "note = " << note << "\nRequestId = " << requestId);
 
         Q_UNUSED(m_updateNoteRequestIds.erase(it));
+        m_manager.syncMetrics().finishLocalStorageRequest(requestId);
 
         performPostAddOrUpdateChecks(note);
         checkServerDataMergeCompletion();
@@ -3015,6 +3271,8 @@ void RemoteToLocalSynchronizationManager::onUpdateNoteFailed(
                 << "\nRequestId = " << requestId);
 
         Q_UNUSED(m_updateNoteRequestIds.erase(it))
+        m_manager.syncMetrics().finishLocalStorageRequest(
+            requestId, /* success = */ false);
 
         ErrorString error(
             QT_TR_NOOP("Failed to update note in the local storage"));
@@ -3455,11 +3713,339 @@ void RemoteToLocalSynchronizationManager::collectNonProcessedItemsSmallestUsns(
                         << "guid " << linkedNotebook.guid() << ": "
                         << smallestUsn);
 
-                usnByLinkedNotebookGuid[linkedNotebook.guid()] =
-                    (smallestUsn - 1);
-                continue;
-            }
-        }
+                usnByLinkedNotebookGuid[linkedNotebook.guid()] =
+                    (smallestUsn - 1);
+                continue;
+            }
+        }
+    }
+}
+
+bool RemoteToLocalSynchronizationManager::canCheckpointSyncProgress() const
+{
+    // The full sync following some previous sync needs to finish in order to
+    // find out which local items are no longer present on the server; if it
+    // was resumed as an incremental sync, stale items would stay forever
+    if (m_onceSyncDone && (m_lastSyncMode == SyncMode::FullSync)) {
+        return false;
+    }
+
+    // Expunged items are processed after all new and updated items and sync
+    // chunks after the checkpoint USN won't list the items expunged before it
+    if (!m_expungedFromServerToClient && m_syncChunks.containsExpungedItems())
+    {
+        return false;
+    }
+
+    return !m_linkedNotebookSyncChunks.containsExpungedItems();
+}
+
+void RemoteToLocalSynchronizationManager::
+    onGetLinkedNotebookSyncStateAsyncFinished(
+        qint32 errorCode, QString linkedNotebookGuid,
+        qevercloud::SyncState syncState, qint32 rateLimitSeconds,
+        ErrorString errorDescription)
+{
+    auto it =
+        m_linkedNotebooksWithSyncStateRequestInFlight.find(linkedNotebookGuid);
+
+    if (it == m_linkedNotebooksWithSyncStateRequestInFlight.end()) {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Ignoring unexpected sync state for linked notebook with guid "
+                << linkedNotebookGuid);
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "RemoteToLocalSynchronizationManager"
+            << "::onGetLinkedNotebookSyncStateAsyncFinished: error code = "
+            << errorCode << ", linked notebook guid = " << linkedNotebookGuid
+            << ", rate limit seconds = " << rateLimitSeconds
+            << ", error description: " << errorDescription);
+
+    LinkedNotebook linkedNotebook = it.value();
+    m_linkedNotebooksWithSyncStateRequestInFlight.erase(it);
+
+    if (errorCode ==
+        static_cast<qint32>(qevercloud::EDAMErrorCode::RATE_LIMIT_REACHED))
+    {
+        if (rateLimitSeconds < 0) {
+            errorDescription.setBase(
+                QT_TR_NOOP("Rate limit reached but the number "
+                           "of seconds to wait is incorrect"));
+            errorDescription.details() = QString::number(rateLimitSeconds);
+            Q_EMIT failure(errorDescription);
+            return;
+        }
+
+        // The sync states which were not requested yet or which requests hit
+        // the rate limit would be requested once the rate limit is over;
+        // the responses to requests already in flight are still accepted
+        m_linkedNotebooksPendingSyncStateRequestByShardId.clear();
+
+        if (m_getLinkedNotebookSyncStateBeforeStartAPICallPostponeTimerId != 0)
+        {
+            return;
+        }
+
+        int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
+        if (Q_UNLIKELY(timerId == 0)) {
+            ErrorString errorMessage(
+                QT_TR_NOOP("Failed to start a timer to postpone the Evernote "
+                           "API call due to rate limit exceeding"));
+            errorMessage.additionalBases().append(errorDescription.base());
+            errorMessage.additionalBases().append(
+                errorDescription.additionalBases());
+            errorMessage.details() = errorDescription.details();
+            Q_EMIT failure(errorMessage);
+            return;
+        }
+
+        m_getLinkedNotebookSyncStateBeforeStartAPICallPostponeTimerId = timerId;
+
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Rate limit exceeded, need "
+                << "to wait for " << rateLimitSeconds << " seconds");
+        Q_EMIT rateLimitExceeded(rateLimitSeconds);
+        return;
+    }
+    else if (
+        errorCode ==
+        static_cast<qint32>(qevercloud::EDAMErrorCode::AUTH_EXPIRED))
+    {
+        ErrorString errorMessage(
+            QT_TR_NOOP("Unexpected AUTH_EXPIRED error when trying to get "
+                       "the linked notebook sync state"));
+        errorMessage.additionalBases().append(errorDescription.base());
+        errorMessage.additionalBases().append(
+            errorDescription.additionalBases());
+        errorMessage.details() = errorDescription.details();
+        Q_EMIT failure(errorMessage);
+        return;
+    }
+    else if (errorCode != 0) {
+        ErrorString errorMessage(
+            QT_TR_NOOP("Failed to get linked notebook sync state"));
+        errorMessage.additionalBases().append(errorDescription.base());
+        errorMessage.additionalBases().append(
+            errorDescription.additionalBases());
+        errorMessage.details() = errorDescription.details();
+        Q_EMIT failure(errorMessage);
+        return;
+    }
+
+    m_syncStatesByLinkedNotebookGuid[linkedNotebookGuid] = syncState;
+    ++m_linkedNotebookSyncStatesCheckedCount;
+
+    qint32 lastUpdateCount =
+        m_lastUpdateCountByLinkedNotebookGuid.value(linkedNotebookGuid, 0);
+
+    qevercloud::Timestamp lastSyncTime =
+        m_lastSyncTimeByLinkedNotebookGuid.value(linkedNotebookGuid, 0);
+
+    bool hasUpdates = (syncState.fullSyncBefore > lastSyncTime) ||
+        (syncState.updateCount != lastUpdateCount);
+
+    Q_EMIT linkedNotebookSyncStatesCheckProgress(
+        m_linkedNotebookSyncStatesCheckedCount,
+        m_linkedNotebookSyncStatesToCheckCount, linkedNotebook, hasUpdates);
+
+    if (!sendNextLinkedNotebookSyncStateRequest(
+            linkedNotebookShardId(linkedNotebook)))
+    {
+        return;
+    }
+
+    if (!m_linkedNotebooksWithSyncStateRequestInFlight.isEmpty()) {
+        return;
+    }
+
+    if (m_getLinkedNotebookSyncStateBeforeStartAPICallPostponeTimerId != 0) {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Received sync states for all requests in flight, waiting "
+                << "for the rate limit to be over to request the rest");
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "Received sync states for all linked notebooks");
+    startLinkedNotebooksSync();
+}
+
+void RemoteToLocalSynchronizationManager::
+    onGetLinkedNotebookSyncChunkAsyncFinished(
+        qint32 errorCode, QString linkedNotebookGuid, qint32 afterUsn,
+        qevercloud::SyncChunk syncChunk, qint32 rateLimitSeconds,
+        ErrorString errorDescription)
+{
+    auto it =
+        m_linkedNotebookSyncChunksDownloadsInProgressByGuid.find(
+            linkedNotebookGuid);
+
+    if ((it == m_linkedNotebookSyncChunksDownloadsInProgressByGuid.end()) ||
+        !it.value().m_requestInFlight || (it.value().m_afterUsn != afterUsn))
+    {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Ignoring unexpected sync chunk for linked notebook with guid "
+                << linkedNotebookGuid << ", after USN = " << afterUsn);
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "RemoteToLocalSynchronizationManager"
+            << "::onGetLinkedNotebookSyncChunkAsyncFinished: error code = "
+            << errorCode << ", linked notebook guid = " << linkedNotebookGuid
+            << ", after USN = " << afterUsn
+            << ", rate limit seconds = " << rateLimitSeconds
+            << ", error description: " << errorDescription);
+
+    auto & download = it.value();
+    download.m_requestInFlight = false;
+
+    if (errorCode ==
+        static_cast<qint32>(qevercloud::EDAMErrorCode::RATE_LIMIT_REACHED))
+    {
+        if (rateLimitSeconds < 0) {
+            errorDescription.setBase(
+                QT_TR_NOOP("Rate limit reached but the number "
+                           "of seconds to wait is incorrect"));
+            errorDescription.details() = QString::number(rateLimitSeconds);
+            Q_EMIT failure(errorDescription);
+            return;
+        }
+
+        // The sync chunk would be requested again once the rate limit is
+        // over; the responses to requests already in flight are still
+        // accepted
+        if (m_downloadLinkedNotebookSyncChunkAPICallPostponeTimerId != 0) {
+            return;
+        }
+
+        int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
+        if (Q_UNLIKELY(timerId == 0)) {
+            ErrorString errorMessage(
+                QT_TR_NOOP("Failed to start a timer to postpone the Evernote "
+                           "API call due to rate limit exceeding"));
+            errorMessage.additionalBases().append(errorDescription.base());
+            errorMessage.additionalBases().append(
+                errorDescription.additionalBases());
+            errorMessage.details() = errorDescription.details();
+            Q_EMIT failure(errorMessage);
+            return;
+        }
+
+        m_downloadLinkedNotebookSyncChunkAPICallPostponeTimerId = timerId;
+
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Rate limit exceeded, need "
+                << "to wait for " << rateLimitSeconds << " seconds");
+        Q_EMIT rateLimitExceeded(rateLimitSeconds);
+        return;
+    }
+    else if (
+        errorCode ==
+        static_cast<qint32>(qevercloud::EDAMErrorCode::AUTH_EXPIRED))
+    {
+        ErrorString errorMessage(
+            QT_TR_NOOP("Unexpected AUTH_EXPIRED error when trying to "
+                       "download the linked notebook sync chunks"));
+        errorMessage.additionalBases().append(errorDescription.base());
+        errorMessage.additionalBases().append(
+            errorDescription.additionalBases());
+        errorMessage.details() = errorDescription.details();
+        QNDEBUG("synchronization:remote_to_local", errorMessage);
+        Q_EMIT failure(errorMessage);
+        return;
+    }
+    else if (errorCode != 0) {
+        ErrorString errorMessage(
+            QT_TR_NOOP("Failed to download the sync chunks for linked "
+                       "notebooks content"));
+        errorMessage.additionalBases().append(errorDescription.base());
+        errorMessage.additionalBases().append(
+            errorDescription.additionalBases());
+        errorMessage.details() = errorDescription.details();
+        QNDEBUG("synchronization:remote_to_local", errorMessage);
+        Q_EMIT failure(errorMessage);
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "Received sync chunk: " << syncChunk);
+
+    download.m_lastSyncTime =
+        std::max(syncChunk.currentTime, download.m_lastSyncTime);
+
+    download.m_lastUpdateCount =
+        std::max(syncChunk.updateCount, download.m_lastUpdateCount);
+
+    QNTRACE(
+        "synchronization:remote_to_local",
+        "Linked notebook's sync "
+            << "chunk current time: "
+            << printableDateTimeFromTimestamp(syncChunk.currentTime)
+            << ", last sync time = "
+            << printableDateTimeFromTimestamp(download.m_lastSyncTime)
+            << ", sync chunk update count = " << syncChunk.updateCount
+            << ", last update count = " << download.m_lastUpdateCount);
+
+    const LinkedNotebook linkedNotebook = download.m_linkedNotebook;
+    const qint32 lastPreviousUsn = download.m_lastPreviousUsn;
+
+    if (syncChunk.chunkHighUSN < syncChunk.updateCount) {
+        download.m_afterUsn = syncChunk.chunkHighUSN;
+        QNTRACE(
+            "synchronization:remote_to_local",
+            "Updated afterUSN "
+                << "for linked notebook to sync chunk's high USN: "
+                << download.m_afterUsn);
+    }
+    else {
+        m_lastSyncTimeByLinkedNotebookGuid[linkedNotebookGuid] =
+            download.m_lastSyncTime;
+
+        m_lastUpdateCountByLinkedNotebookGuid[linkedNotebookGuid] =
+            download.m_lastUpdateCount;
+
+        Q_UNUSED(m_linkedNotebookGuidsForWhichSyncChunksWereDownloaded.insert(
+            linkedNotebookGuid));
+
+        if (download.m_fullSyncOnly) {
+            Q_UNUSED(m_linkedNotebookGuidsForWhichFullSyncWasPerformed.insert(
+                linkedNotebookGuid))
+        }
+
+        m_linkedNotebookSyncChunksDownloadsInProgressByGuid.erase(it);
+    }
+
+    Q_EMIT linkedNotebookSyncChunksDownloadProgress(
+        syncChunk.chunkHighUSN, syncChunk.updateCount, lastPreviousUsn,
+        linkedNotebook);
+
+    if (!processLinkedNotebookSyncChunk(linkedNotebookGuid, syncChunk)) {
+        return;
+    }
+
+    if (!sendLinkedNotebookSyncChunkRequests()) {
+        return;
+    }
+
+    if (m_linkedNotebookSyncChunksDownloadsInProgressByGuid.isEmpty() &&
+        m_linkedNotebookSyncChunksDownloadsPendingByShardId.isEmpty())
+    {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Downloaded sync chunks for all linked notebooks");
+        startLinkedNotebooksSync();
     }
 }
 
@@ -3535,7 +4121,7 @@ void RemoteToLocalSynchronizationManager::onGetNoteAsyncFinished(
             return;
         }
 
-        int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+        int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
         if (Q_UNLIKELY(timerId == 0)) {
             errorDescription.setBase(
                 QT_TR_NOOP("Failed to start a timer to postpone the Evernote "
@@ -3682,6 +4268,10 @@ void RemoteToLocalSynchronizationManager::onGetNoteAsyncFinished(
         "Emitting the request to update "
             << "note in local storage: request id = " << updateNoteRequestId
             << ", note; " << note);
+
+    m_manager.syncMetrics().startLocalStorageRequest(
+        updateNoteRequestId, QStringLiteral("updateNote"));
+
     Q_EMIT updateNote(note, options, updateNoteRequestId);
 }
 
@@ -3775,7 +4365,7 @@ void RemoteToLocalSynchronizationManager::onGetResourceAsyncFinished(
             return;
         }
 
-        int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+        int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
         if (Q_UNLIKELY(timerId == 0)) {
             errorDescription.setBase(
                 QT_TR_NOOP("Failed to start a timer to postpone the Evernote "
@@ -3903,7 +4493,7 @@ void RemoteToLocalSynchronizationManager::onTagSyncCacheFilled()
             "synchronization:remote_to_local",
             "No more linked notebook "
                 << "guids pending tag sync caches fill");
-        startFeedingDownloadedTagsToLocalStorageOneByOne(m_tags);
+        startFeedingDownloadedTagsToLocalStorage(m_tags);
     }
     else {
         QNDEBUG(
@@ -3996,7 +4586,12 @@ void RemoteToLocalSynchronizationManager::onTagSyncConflictResolverFinished(
     emitSyncChunkDataCountersUpdate();
 
     unregisterTagPendingAddOrUpdate(Tag(remoteTag));
-    syncNextTagPendingProcessing();
+
+    if (remoteTag.guid.isSet()) {
+        Q_UNUSED(m_guidsOfTagsLevelInProcessing.remove(remoteTag.guid.ref()))
+    }
+
+    syncNextTagsLevelPendingProcessing();
     checkNotebooksAndTagsSyncCompletionAndLaunchNotesAndResourcesSync();
     checkServerDataMergeCompletion();
 }
@@ -4357,6 +4952,12 @@ void RemoteToLocalSynchronizationManager::connectToLocalStorage()
         &localStorageManagerAsync, &LocalStorageManagerAsync::onFindTagRequest,
         Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
 
+    QObject::connect(
+        this, &RemoteToLocalSynchronizationManager::findOrAddTags,
+        &localStorageManagerAsync,
+        &LocalStorageManagerAsync::onFindOrAddTagsRequest,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
     QObject::connect(
         this, &RemoteToLocalSynchronizationManager::expungeTag,
         &localStorageManagerAsync,
@@ -4487,6 +5088,18 @@ void RemoteToLocalSynchronizationManager::connectToLocalStorage()
         this, &RemoteToLocalSynchronizationManager::onFindTagFailed,
         Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
 
+    QObject::connect(
+        &localStorageManagerAsync,
+        &LocalStorageManagerAsync::findOrAddTagsComplete, this,
+        &RemoteToLocalSynchronizationManager::onFindOrAddTagsCompleted,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &localStorageManagerAsync,
+        &LocalStorageManagerAsync::findOrAddTagsFailed, this,
+        &RemoteToLocalSynchronizationManager::onFindOrAddTagsFailed,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
     QObject::connect(
         &localStorageManagerAsync,
         &LocalStorageManagerAsync::findLinkedNotebookComplete, this,
@@ -4852,6 +5465,11 @@ void RemoteToLocalSynchronizationManager::disconnectFromLocalStorage()
         this, &RemoteToLocalSynchronizationManager::findTag,
         &localStorageManagerAsync, &LocalStorageManagerAsync::onFindTagRequest);
 
+    QObject::disconnect(
+        this, &RemoteToLocalSynchronizationManager::findOrAddTags,
+        &localStorageManagerAsync,
+        &LocalStorageManagerAsync::onFindOrAddTagsRequest);
+
     QObject::disconnect(
         this, &RemoteToLocalSynchronizationManager::expungeTag,
         &localStorageManagerAsync,
@@ -4967,6 +5585,16 @@ void RemoteToLocalSynchronizationManager::disconnectFromLocalStorage()
         &localStorageManagerAsync, &LocalStorageManagerAsync::findTagFailed,
         this, &RemoteToLocalSynchronizationManager::onFindTagFailed);
 
+    QObject::disconnect(
+        &localStorageManagerAsync,
+        &LocalStorageManagerAsync::findOrAddTagsComplete, this,
+        &RemoteToLocalSynchronizationManager::onFindOrAddTagsCompleted);
+
+    QObject::disconnect(
+        &localStorageManagerAsync,
+        &LocalStorageManagerAsync::findOrAddTagsFailed, this,
+        &RemoteToLocalSynchronizationManager::onFindOrAddTagsFailed);
+
     QObject::disconnect(
         &localStorageManagerAsync,
         &LocalStorageManagerAsync::findLinkedNotebookComplete, this,
@@ -5409,7 +6037,7 @@ bool RemoteToLocalSynchronizationManager::syncUserImpl(
             "Rate limit exceeded, need "
                 << "to wait for " << rateLimitSeconds << " seconds");
         if (waitIfRateLimitReached) {
-            int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+            int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
             if (Q_UNLIKELY(timerId == 0)) {
                 ErrorString errorMessage(QT_TR_NOOP(
                     "Failed to start a timer to postpone the "
@@ -5599,7 +6227,7 @@ bool RemoteToLocalSynchronizationManager::syncAccountLimits(
                 << "to wait for " << rateLimitSeconds << " seconds");
 
         if (waitIfRateLimitReached) {
-            int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+            int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
             if (Q_UNLIKELY(timerId == 0)) {
                 ErrorString errorMessage(QT_TR_NOOP(
                     "Failed to start a timer to postpone the "
@@ -6021,7 +6649,7 @@ void RemoteToLocalSynchronizationManager::writeAccountLimitsToAppSettings()
 }
 
 template <class ContainerType, class ElementType>
-void RemoteToLocalSynchronizationManager::launchDataElementSyncCommon(
+bool RemoteToLocalSynchronizationManager::launchDataElementSyncCommon(
     const ContentSource contentSource, ContainerType & container,
     QList<QString> & expungedElements)
 {
@@ -6032,7 +6660,7 @@ void RemoteToLocalSynchronizationManager::launchDataElementSyncCommon(
         "syncingUserAccountData = "
             << (syncingUserAccountData ? "true" : "false"));
 
-    const auto & syncChunks =
+    auto & syncChunks =
         (syncingUserAccountData ? m_syncChunks : m_linkedNotebookSyncChunks);
 
     container.clear();
@@ -6043,7 +6671,15 @@ void RemoteToLocalSynchronizationManager::launchDataElementSyncCommon(
         "Num sync chunks = " << numSyncChunks);
 
     for (int i = 0; i < numSyncChunks; ++i) {
-        const auto & syncChunk = syncChunks[i];
+        qevercloud::SyncChunk syncChunk;
+        ErrorString errorDescription;
+        if (Q_UNLIKELY(!syncChunks.syncChunk(i, syncChunk, errorDescription)))
+        {
+            QNWARNING("synchronization:remote_to_local", errorDescription);
+            container.clear();
+            Q_EMIT failure(errorDescription);
+            return false;
+        }
 
         appendDataElementsFromSyncChunkToContainer<ContainerType>(
             syncChunk, container);
@@ -6051,6 +6687,44 @@ void RemoteToLocalSynchronizationManager::launchDataElementSyncCommon(
         extractExpungedElementsFromSyncChunk<ElementType>(
             syncChunk, expungedElements);
     }
+
+    // The data elements are processed from the container from now on, no need
+    // to keep their copies within the sync chunks as well
+    syncChunks.releaseDataElements(
+        syncChunksBufferDataElement<ElementType>());
+
+    removeUpToDateDataElements<ContainerType, ElementType>(container);
+    return true;
+}
+
+template <class ContainerType, class ElementType>
+void RemoteToLocalSynchronizationManager::removeUpToDateDataElements(
+    ContainerType & container)
+{
+    int numUpToDateElements = 0;
+    for (auto it = container.begin(); it != container.end();) {
+        if (!m_guidIndex.isUpToDate(*it)) {
+            ++it;
+            continue;
+        }
+
+        QNTRACE(
+            "synchronization:remote_to_local",
+            "Local counterpart of the remote item is up to date according "
+                << "to the guid index, skipping it: " << *it);
+
+        it = container.erase(it);
+        ++numUpToDateElements;
+    }
+
+    if (numUpToDateElements == 0) {
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "Skipped " << numUpToDateElements << " items which are already up "
+                   << "to date within the local storage");
 }
 
 template <class ContainerType, class ElementType>
@@ -6063,8 +6737,11 @@ void RemoteToLocalSynchronizationManager::launchDataElementSync(
         "RemoteToLocalSynchronizationManager::launchDataElementSync: "
             << typeName);
 
-    launchDataElementSyncCommon<ContainerType, ElementType>(
-        contentSource, container, expungedElements);
+    if (!launchDataElementSyncCommon<ContainerType, ElementType>(
+            contentSource, container, expungedElements))
+    {
+        return;
+    }
 
     if (container.isEmpty()) {
         QNDEBUG(
@@ -6110,8 +6787,11 @@ void RemoteToLocalSynchronizationManager::launchDataElementSync<
         "RemoteToLocalSynchronizationManager::launchDataElementSync: "
             << typeName);
 
-    launchDataElementSyncCommon<TagsContainer, Tag>(
-        contentSource, container, expungedElements);
+    if (!launchDataElementSyncCommon<TagsContainer, Tag>(
+            contentSource, container, expungedElements))
+    {
+        return;
+    }
 
     if (container.empty()) {
         QNDEBUG(
@@ -6252,7 +6932,7 @@ void RemoteToLocalSynchronizationManager::launchDataElementSync<
         }
     }
 
-    startFeedingDownloadedTagsToLocalStorageOneByOne(container);
+    startFeedingDownloadedTagsToLocalStorage(container);
 }
 
 void RemoteToLocalSynchronizationManager::launchTagsSync()
@@ -6759,6 +7439,7 @@ bool RemoteToLocalSynchronizationManager::tagsSyncInProgress() const
          !m_tagsPendingAddOrUpdate.isEmpty() ||
          !m_findTagByGuidRequestIds.isEmpty() ||
          !m_findTagByNameRequestIds.isEmpty() ||
+         !m_findOrAddTagsRequestId.isNull() ||
          !m_addTagRequestIds.isEmpty() || !m_updateTagRequestIds.isEmpty() ||
          !m_expungeTagRequestIds.isEmpty()))
     {
@@ -7235,6 +7916,10 @@ void RemoteToLocalSynchronizationManager::startLinkedNotebooksSync()
         return;
     }
 
+    if (!requestLinkedNotebooksSyncStates()) {
+        return;
+    }
+
     if (!downloadLinkedNotebooksSyncChunks()) {
         return;
     }
@@ -7508,7 +8193,7 @@ void RemoteToLocalSynchronizationManager::getLinkedNotebookSyncState(
             return;
         }
 
-        int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+        int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
         if (Q_UNLIKELY(timerId == 0)) {
             ErrorString errorMessage(
                 QT_TR_NOOP("Failed to start a timer to postpone the Evernote "
@@ -7560,6 +8245,171 @@ void RemoteToLocalSynchronizationManager::getLinkedNotebookSyncState(
     }
 }
 
+bool RemoteToLocalSynchronizationManager::requestLinkedNotebooksSyncStates()
+{
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "RemoteToLocalSynchronizationManager"
+            << "::requestLinkedNotebooksSyncStates");
+
+    if (!m_linkedNotebooksWithSyncStateRequestInFlight.isEmpty()) {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Still waiting for "
+                << m_linkedNotebooksWithSyncStateRequestInFlight.size()
+                << " linked notebook sync states");
+        return false;
+    }
+
+    m_linkedNotebooksPendingSyncStateRequestByShardId.clear();
+
+    // Sync states already received before the rate limit breach stay cached
+    // and checked, only the rest of them needs to be requested
+    m_linkedNotebookSyncStatesToCheckCount =
+        m_linkedNotebookSyncStatesCheckedCount;
+
+    quint32 linkedNotebooksToRequestCount = 0;
+    for (const auto & linkedNotebook: ::qAsConst(m_allLinkedNotebooks)) {
+        if (Q_UNLIKELY(!linkedNotebook.hasGuid())) {
+            // Would be reported when trying to download the sync chunks
+            continue;
+        }
+
+        const QString & linkedNotebookGuid = linkedNotebook.guid();
+        if (m_linkedNotebookGuidsForWhichSyncChunksWereDownloaded.contains(
+                linkedNotebookGuid) ||
+            m_syncStatesByLinkedNotebookGuid.contains(linkedNotebookGuid))
+        {
+            continue;
+        }
+
+        qint32 lastUpdateCount =
+            m_lastUpdateCountByLinkedNotebookGuid.value(linkedNotebookGuid, 0);
+
+        if (!m_onceSyncDone && (lastUpdateCount == 0)) {
+            // Linked notebook's sync state is not needed, its sync chunks
+            // would be downloaded from the very beginning anyway
+            continue;
+        }
+
+        m_linkedNotebooksPendingSyncStateRequestByShardId
+            [linkedNotebookShardId(linkedNotebook)]
+                .enqueue(linkedNotebook);
+
+        ++linkedNotebooksToRequestCount;
+    }
+
+    m_linkedNotebookSyncStatesToCheckCount += linkedNotebooksToRequestCount;
+
+    if (linkedNotebooksToRequestCount == 0) {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "No linked notebook sync states need to be requested");
+        return true;
+    }
+
+    const auto shardIds =
+        m_linkedNotebooksPendingSyncStateRequestByShardId.keys();
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "Requesting sync states for "
+            << linkedNotebooksToRequestCount << " linked notebooks from "
+            << shardIds.size() << " shards");
+
+    for (const auto & shardId: qAsConst(shardIds)) {
+        for (int i = 0; i < LINKED_NOTEBOOK_SYNC_STATE_REQUESTS_PER_SHARD_MAX;
+             ++i)
+        {
+            if (!sendNextLinkedNotebookSyncStateRequest(shardId)) {
+                return false;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool RemoteToLocalSynchronizationManager::
+    sendNextLinkedNotebookSyncStateRequest(const QString & shardId)
+{
+    auto it = m_linkedNotebooksPendingSyncStateRequestByShardId.find(shardId);
+    if ((it == m_linkedNotebooksPendingSyncStateRequestByShardId.end()) ||
+        it.value().isEmpty())
+    {
+        return true;
+    }
+
+    LinkedNotebook linkedNotebook = it.value().dequeue();
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "RemoteToLocalSynchronizationManager"
+            << "::sendNextLinkedNotebookSyncStateRequest: shard id = "
+            << shardId << ", linked notebook guid = " << linkedNotebook.guid());
+
+    auto * pNoteStore = m_manager.noteStoreForLinkedNotebook(linkedNotebook);
+    if (Q_UNLIKELY(!pNoteStore)) {
+        ErrorString errorDescription(
+            QT_TR_NOOP("Can't find or create note store "
+                       "for the linked notebook"));
+        Q_EMIT failure(errorDescription);
+        return false;
+    }
+
+    if (Q_UNLIKELY(pNoteStore->noteStoreUrl().isEmpty())) {
+        ErrorString errorDescription(
+            QT_TR_NOOP("Internal error: empty note store url "
+                       "for the linked notebook's note store"));
+        Q_EMIT failure(errorDescription);
+        return false;
+    }
+
+    QObject::connect(
+        pNoteStore, &INoteStore::getLinkedNotebookSyncStateAsyncFinished, this,
+        &RemoteToLocalSynchronizationManager::
+            onGetLinkedNotebookSyncStateAsyncFinished,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    ErrorString errorDescription;
+    bool res = pNoteStore->getLinkedNotebookSyncStateAsync(
+        linkedNotebook.qevercloudLinkedNotebook(), m_authenticationToken,
+        errorDescription);
+
+    if (Q_UNLIKELY(!res)) {
+        ErrorString errorMessage(
+            QT_TR_NOOP("Failed to request linked notebook sync state"));
+        errorMessage.additionalBases().append(errorDescription.base());
+        errorMessage.additionalBases().append(
+            errorDescription.additionalBases());
+        errorMessage.details() = errorDescription.details();
+        Q_EMIT failure(errorMessage);
+        return false;
+    }
+
+    m_linkedNotebooksWithSyncStateRequestInFlight[linkedNotebook.guid()] =
+        linkedNotebook;
+
+    return true;
+}
+
+QString RemoteToLocalSynchronizationManager::linkedNotebookShardId(
+    const LinkedNotebook & linkedNotebook) const
+{
+    if (linkedNotebook.hasShardId()) {
+        return linkedNotebook.shardId();
+    }
+
+    auto it = m_authenticationTokensAndShardIdsByLinkedNotebookGuid.find(
+        linkedNotebook.guid());
+
+    if (it != m_authenticationTokensAndShardIdsByLinkedNotebookGuid.end()) {
+        return it.value().second;
+    }
+
+    return {};
+}
+
 bool RemoteToLocalSynchronizationManager::downloadLinkedNotebooksSyncChunks()
 {
     QNDEBUG(
@@ -7567,7 +8417,21 @@ bool RemoteToLocalSynchronizationManager::downloadLinkedNotebooksSyncChunks()
         "RemoteToLocalSynchronizationManager"
             << "::downloadLinkedNotebooksSyncChunks");
 
-    qevercloud::SyncChunk * pSyncChunk = nullptr;
+    if (!m_linkedNotebookSyncChunksDownloadsInProgressByGuid.isEmpty() ||
+        !m_linkedNotebookSyncChunksDownloadsPendingByShardId.isEmpty())
+    {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Sync chunks download is still in progress for "
+                << m_linkedNotebookSyncChunksDownloadsInProgressByGuid.size()
+                << " linked notebooks");
+
+        // Resumes the downloads stopped by the rate limit breach, if any
+        Q_UNUSED(sendLinkedNotebookSyncChunkRequests())
+        return false;
+    }
+
+    int numLinkedNotebooksToDownload = 0;
 
     const int numAllLinkedNotebooks = m_allLinkedNotebooks.size();
     for (int i = 0; i < numAllLinkedNotebooks; ++i) {
@@ -7589,34 +8453,8 @@ bool RemoteToLocalSynchronizationManager::downloadLinkedNotebooksSyncChunks()
         }
 
         const QString & linkedNotebookGuid = linkedNotebook.guid();
-        bool fullSyncOnly = false;
-
-        auto lastSyncTimeIt =
-            m_lastSyncTimeByLinkedNotebookGuid.find(linkedNotebookGuid);
-
-        if (lastSyncTimeIt == m_lastSyncTimeByLinkedNotebookGuid.end()) {
-            lastSyncTimeIt = m_lastSyncTimeByLinkedNotebookGuid.insert(
-                linkedNotebookGuid, 0);
-        }
-
-        qevercloud::Timestamp lastSyncTime = lastSyncTimeIt.value();
-
-        auto lastUpdateCountIt =
-            m_lastUpdateCountByLinkedNotebookGuid.find(linkedNotebookGuid);
-
-        if (lastUpdateCountIt == m_lastUpdateCountByLinkedNotebookGuid.end()) {
-            lastUpdateCountIt = m_lastUpdateCountByLinkedNotebookGuid.insert(
-                linkedNotebookGuid, 0);
-        }
-
-        qint32 lastUpdateCount = lastUpdateCountIt.value();
-
-        auto syncChunksDownloadedFlagIt =
-            m_linkedNotebookGuidsForWhichSyncChunksWereDownloaded.find(
-                linkedNotebookGuid);
-
-        if (syncChunksDownloadedFlagIt !=
-            m_linkedNotebookGuidsForWhichSyncChunksWereDownloaded.end())
+        if (m_linkedNotebookGuidsForWhichSyncChunksWereDownloaded.contains(
+                linkedNotebookGuid))
         {
             QNDEBUG(
                 "synchronization:remote_to_local",
@@ -7626,285 +8464,303 @@ bool RemoteToLocalSynchronizationManager::downloadLinkedNotebooksSyncChunks()
             continue;
         }
 
-        qint32 afterUsn = lastUpdateCount;
-        qint32 lastPreviousUsn = std::max(lastUpdateCount, 0);
+        LinkedNotebookSyncChunksDownload download;
+        download.m_linkedNotebook = linkedNotebook;
+
+        download.m_lastSyncTime =
+            m_lastSyncTimeByLinkedNotebookGuid.value(linkedNotebookGuid, 0);
+
+        download.m_lastUpdateCount =
+            m_lastUpdateCountByLinkedNotebookGuid.value(linkedNotebookGuid, 0);
+
+        download.m_afterUsn = download.m_lastUpdateCount;
+        download.m_lastPreviousUsn = std::max(download.m_lastUpdateCount, 0);
 
         QNDEBUG(
             "synchronization:remote_to_local",
             "Last previous USN for "
-                << "current linked notebook = " << lastPreviousUsn
+                << "current linked notebook = " << download.m_lastPreviousUsn
                 << " (linked notebook guid = " << linkedNotebookGuid << ")");
 
-        if (m_onceSyncDone || (afterUsn != 0)) {
+        if (m_onceSyncDone || (download.m_afterUsn != 0)) {
+            // Sync states for all such linked notebooks were received
+            // by requestLinkedNotebooksSyncStates before getting here
             auto syncStateIter =
                 m_syncStatesByLinkedNotebookGuid.find(linkedNotebookGuid);
 
-            if (syncStateIter == m_syncStatesByLinkedNotebookGuid.end()) {
-                QNTRACE(
-                    "synchronization:remote_to_local",
-                    "Found no cached "
-                        << "sync state for linked notebook guid "
-                        << linkedNotebookGuid
-                        << ", will try to receive it from "
-                        << "the remote service");
-
-                qevercloud::SyncState syncState;
-                bool error = false;
-                bool asyncWait = false;
-
-                getLinkedNotebookSyncState(
-                    linkedNotebook, m_authenticationToken, syncState, asyncWait,
-                    error);
-
-                if (asyncWait || error) {
-                    QNTRACE(
-                        "synchronization:remote_to_local",
-                        "Async wait = " << (asyncWait ? "true" : "false")
-                                        << ", error = "
-                                        << (error ? "true" : "false"));
-                    return false;
+            if (Q_UNLIKELY(
+                    syncStateIter == m_syncStatesByLinkedNotebookGuid.end()))
+            {
+                ErrorString error(
+                    QT_TR_NOOP("Internal error: found no sync state for "
+                               "linked notebook when trying to download "
+                               "the linked notebook sync chunks"));
+                if (linkedNotebook.hasUsername()) {
+                    error.details() = linkedNotebook.username();
                 }
 
-                syncStateIter = m_syncStatesByLinkedNotebookGuid.insert(
-                    linkedNotebookGuid, syncState);
+                QNWARNING(
+                    "synchronization:remote_to_local",
+                    error << ": " << linkedNotebook);
+                Q_EMIT failure(error);
+                return false;
             }
 
             const auto & syncState = syncStateIter.value();
 
-            QNDEBUG(
-                "synchronization:remote_to_local",
-                "Sync state: " << syncState << "\nLast sync time = "
-                               << printableDateTimeFromTimestamp(lastSyncTime)
-                               << ", last update count = " << lastUpdateCount);
+            QNDEBUG(
+                "synchronization:remote_to_local",
+                "Sync state: "
+                    << syncState << "\nLast sync time = "
+                    << printableDateTimeFromTimestamp(download.m_lastSyncTime)
+                    << ", last update count = " << download.m_lastUpdateCount);
+
+            if (syncState.fullSyncBefore > download.m_lastSyncTime) {
+                QNDEBUG(
+                    "synchronization:remote_to_local",
+                    "Linked notebook "
+                        << "sync state says the time has come to do the full "
+                           "sync");
+                download.m_afterUsn = 0;
+                download.m_fullSyncOnly = true;
+            }
+            else if (syncState.updateCount == download.m_lastUpdateCount) {
+                QNDEBUG(
+                    "synchronization:remote_to_local",
+                    "Server has no "
+                        << "updates for data in this linked notebook, "
+                           "continuing "
+                        << "with the next one");
+
+                Q_UNUSED(m_linkedNotebookGuidsForWhichSyncChunksWereDownloaded
+                             .insert(linkedNotebookGuid));
+                continue;
+            }
+        }
+
+        m_linkedNotebookSyncChunksDownloadsPendingByShardId
+            [linkedNotebookShardId(linkedNotebook)]
+                .enqueue(download);
+
+        ++numLinkedNotebooksToDownload;
+    }
+
+    if (numLinkedNotebooksToDownload == 0) {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Done. Processing content "
+                << "pointed to by linked notebooks from buffered sync chunks");
+
+        // don't need this anymore, it only served the purpose of preventing
+        // multiple get sync state calls for the same linked notebook
+        m_syncStatesByLinkedNotebookGuid.clear();
+
+        m_linkedNotebooksSyncChunksDownloaded = true;
+        Q_EMIT linkedNotebooksSyncChunksDownloaded();
+        return true;
+    }
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "Downloading sync chunks for "
+            << numLinkedNotebooksToDownload << " linked notebooks from "
+            << m_linkedNotebookSyncChunksDownloadsPendingByShardId.size()
+            << " shards");
+
+    Q_UNUSED(sendLinkedNotebookSyncChunkRequests())
+    return false;
+}
+
+bool RemoteToLocalSynchronizationManager::sendLinkedNotebookSyncChunkRequests()
+{
+    if (m_downloadLinkedNotebookSyncChunkAPICallPostponeTimerId != 0) {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Linked notebook sync chunk requests are postponed until "
+                << "the rate limit is over");
+        return true;
+    }
+
+    QHash<QString, int> numDownloadsInProgressByShardId;
+    QStringList linkedNotebookGuidsToRequest;
 
-            if (syncState.fullSyncBefore > lastSyncTime) {
-                QNDEBUG(
-                    "synchronization:remote_to_local",
-                    "Linked notebook "
-                        << "sync state says the time has come to do the full "
-                           "sync");
-                afterUsn = 0;
-                fullSyncOnly = true;
-            }
-            else if (syncState.updateCount == lastUpdateCount) {
-                QNDEBUG(
-                    "synchronization:remote_to_local",
-                    "Server has no "
-                        << "updates for data in this linked notebook, "
-                           "continuing "
-                        << "with the next one");
+    const auto & downloadsInProgress =
+        m_linkedNotebookSyncChunksDownloadsInProgressByGuid;
 
-                Q_UNUSED(m_linkedNotebookGuidsForWhichSyncChunksWereDownloaded
-                             .insert(linkedNotebookGuid));
-                continue;
-            }
-        }
+    for (auto it = downloadsInProgress.constBegin(),
+              end = downloadsInProgress.constEnd();
+         it != end; ++it)
+    {
+        const auto & download = it.value();
+        ++numDownloadsInProgressByShardId[linkedNotebookShardId(
+            download.m_linkedNotebook)];
 
-        auto * pNoteStore =
-            m_manager.noteStoreForLinkedNotebook(linkedNotebook);
-        if (Q_UNLIKELY(!pNoteStore)) {
-            ErrorString error(
-                QT_TR_NOOP("Can't find or create note store for "
-                           "the linked notebook"));
-            Q_EMIT failure(error);
-            return false;
+        if (!download.m_requestInFlight) {
+            linkedNotebookGuidsToRequest << it.key();
         }
+    }
 
-        if (Q_UNLIKELY(pNoteStore->noteStoreUrl().isEmpty())) {
-            ErrorString errorDescription(
-                QT_TR_NOOP("Internal error: empty note store url for "
-                           "the linked notebook's note store"));
-            Q_EMIT failure(errorDescription);
-            return false;
-        }
+    auto & downloadsPending =
+        m_linkedNotebookSyncChunksDownloadsPendingByShardId;
 
-        while (!pSyncChunk ||
-               (pSyncChunk->chunkHighUSN < pSyncChunk->updateCount)) {
-            if (pSyncChunk) {
-                afterUsn = pSyncChunk->chunkHighUSN;
-                QNTRACE(
-                    "synchronization:remote_to_local",
-                    "Updated afterUSN "
-                        << "for linked notebook to sync chunk's high USN: "
-                        << pSyncChunk->chunkHighUSN);
-            }
+    auto pendingIt = downloadsPending.begin();
+    while (pendingIt != downloadsPending.end()) {
+        auto & pendingDownloads = pendingIt.value();
+        int & numDownloadsInProgress =
+            numDownloadsInProgressByShardId[pendingIt.key()];
 
-            m_linkedNotebookSyncChunks.push_back(qevercloud::SyncChunk());
-            pSyncChunk = &(m_linkedNotebookSyncChunks.back());
+        while ((numDownloadsInProgress <
+                LINKED_NOTEBOOK_SYNC_CHUNKS_DOWNLOADS_PER_SHARD_MAX) &&
+               !pendingDownloads.isEmpty())
+        {
+            auto download = pendingDownloads.dequeue();
+            const QString linkedNotebookGuid = download.m_linkedNotebook.guid();
 
-            ErrorString errorDescription;
-            qint32 rateLimitSeconds = 0;
+            m_linkedNotebookSyncChunksDownloadsInProgressByGuid
+                [linkedNotebookGuid] = download;
 
-            qint32 errorCode = pNoteStore->getLinkedNotebookSyncChunk(
-                linkedNotebook.qevercloudLinkedNotebook(), afterUsn,
-                m_maxSyncChunksPerOneDownload, m_authenticationToken,
-                fullSyncOnly, *pSyncChunk, errorDescription, rateLimitSeconds);
+            linkedNotebookGuidsToRequest << linkedNotebookGuid;
+            ++numDownloadsInProgress;
+        }
 
-            if (errorCode ==
-                static_cast<qint32>(
-                    qevercloud::EDAMErrorCode::RATE_LIMIT_REACHED))
-            {
-                if (rateLimitSeconds < 0) {
-                    errorDescription.setBase(
-                        QT_TR_NOOP("Rate limit reached but the number of "
-                                   "seconds to wait is incorrect"));
-                    errorDescription.details() =
-                        QString::number(rateLimitSeconds);
-                    Q_EMIT failure(errorDescription);
-                    return false;
-                }
+        if (pendingDownloads.isEmpty()) {
+            pendingIt = downloadsPending.erase(pendingIt);
+        }
+        else {
+            ++pendingIt;
+        }
+    }
 
-                m_linkedNotebookSyncChunks.pop_back();
-
-                int timerId =
-                    startTimer(secondsToMilliseconds(rateLimitSeconds));
-                if (Q_UNLIKELY(timerId == 0)) {
-                    ErrorString errorMessage(
-                        QT_TR_NOOP("Failed to start a timer to postpone "
-                                   "the Evernote API call due to rate limit "
-                                   "exceeding"));
-                    errorMessage.additionalBases().append(
-                        errorDescription.base());
-                    errorMessage.additionalBases().append(
-                        errorDescription.additionalBases());
-                    errorMessage.details() = errorDescription.details();
-                    Q_EMIT failure(errorMessage);
-                    return false;
-                }
+    for (const auto & linkedNotebookGuid:
+         qAsConst(linkedNotebookGuidsToRequest))
+    {
+        if (!sendLinkedNotebookSyncChunkRequest(linkedNotebookGuid)) {
+            return false;
+        }
+    }
 
-                m_downloadLinkedNotebookSyncChunkAPICallPostponeTimerId =
-                    timerId;
+    return true;
+}
 
-                QNDEBUG(
-                    "synchronization:remote_to_local",
-                    "Rate limit "
-                        << "exceeded, need to wait for " << rateLimitSeconds
-                        << " seconds");
-                Q_EMIT rateLimitExceeded(rateLimitSeconds);
-                return false;
-            }
-            else if (
-                errorCode ==
-                static_cast<qint32>(qevercloud::EDAMErrorCode::AUTH_EXPIRED))
-            {
-                ErrorString errorMessage(
-                    QT_TR_NOOP("Unexpected AUTH_EXPIRED error when trying to "
-                               "download the linked notebook sync chunks"));
-                errorMessage.additionalBases().append(errorDescription.base());
-                errorMessage.additionalBases().append(
-                    errorDescription.additionalBases());
-                errorMessage.details() = errorDescription.details();
-                QNDEBUG("synchronization:remote_to_local", errorMessage);
-                Q_EMIT failure(errorMessage);
-                return false;
-            }
-            else if (errorCode != 0) {
-                ErrorString errorMessage(
-                    QT_TR_NOOP("Failed to download the sync chunks for linked "
-                               "notebooks content"));
-                errorMessage.additionalBases().append(errorDescription.base());
-                errorMessage.additionalBases().append(
-                    errorDescription.additionalBases());
-                errorMessage.details() = errorDescription.details();
-                QNDEBUG("synchronization:remote_to_local", errorMessage);
-                Q_EMIT failure(errorMessage);
-                return false;
-            }
+bool RemoteToLocalSynchronizationManager::sendLinkedNotebookSyncChunkRequest(
+    const QString & linkedNotebookGuid)
+{
+    auto it =
+        m_linkedNotebookSyncChunksDownloadsInProgressByGuid.find(
+            linkedNotebookGuid);
 
-            QNDEBUG(
-                "synchronization:remote_to_local",
-                "Received sync chunk: " << *pSyncChunk);
+    if (Q_UNLIKELY(
+            it == m_linkedNotebookSyncChunksDownloadsInProgressByGuid.end()))
+    {
+        ErrorString errorDescription(
+            QT_TR_NOOP("Internal error: can't find the linked notebook "
+                       "to request the sync chunk for"));
+        errorDescription.details() = linkedNotebookGuid;
+        Q_EMIT failure(errorDescription);
+        return false;
+    }
 
-            lastSyncTime = std::max(pSyncChunk->currentTime, lastSyncTime);
-            lastUpdateCount =
-                std::max(pSyncChunk->updateCount, lastUpdateCount);
+    auto & download = it.value();
 
-            QNTRACE(
-                "synchronization:remote_to_local",
-                "Linked notebook's sync "
-                    << "chunk current time: "
-                    << printableDateTimeFromTimestamp(pSyncChunk->currentTime)
-                    << ", last sync time = "
-                    << printableDateTimeFromTimestamp(lastSyncTime)
-                    << ", sync chunk update count = " << pSyncChunk->updateCount
-                    << ", last update count = " << lastUpdateCount);
-
-            Q_EMIT linkedNotebookSyncChunksDownloadProgress(
-                pSyncChunk->chunkHighUSN, pSyncChunk->updateCount,
-                lastPreviousUsn, linkedNotebook);
-
-            if (pSyncChunk->tags.isSet()) {
-                bool res = mapContainerElementsWithLinkedNotebookGuid<TagsList>(
-                    linkedNotebookGuid, pSyncChunk->tags.ref());
-                if (!res) {
-                    return false;
-                }
-            }
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "RemoteToLocalSynchronizationManager"
+            << "::sendLinkedNotebookSyncChunkRequest: linked notebook guid = "
+            << linkedNotebookGuid << ", after USN = " << download.m_afterUsn
+            << ", full sync only = "
+            << (download.m_fullSyncOnly ? "true" : "false"));
 
-            if (pSyncChunk->notebooks.isSet()) {
-                bool res =
-                    mapContainerElementsWithLinkedNotebookGuid<NotebooksList>(
-                        linkedNotebookGuid, pSyncChunk->notebooks.ref());
-                if (!res) {
-                    return false;
-                }
-            }
+    auto * pNoteStore =
+        m_manager.noteStoreForLinkedNotebook(download.m_linkedNotebook);
+    if (Q_UNLIKELY(!pNoteStore)) {
+        ErrorString errorDescription(
+            QT_TR_NOOP("Can't find or create note store for "
+                       "the linked notebook"));
+        Q_EMIT failure(errorDescription);
+        return false;
+    }
 
-            if (pSyncChunk->notes.isSet()) {
-                bool res =
-                    mapContainerElementsWithLinkedNotebookGuid<NotesList>(
-                        linkedNotebookGuid, pSyncChunk->notes.ref());
-                if (!res) {
-                    return false;
-                }
-            }
+    if (Q_UNLIKELY(pNoteStore->noteStoreUrl().isEmpty())) {
+        ErrorString errorDescription(
+            QT_TR_NOOP("Internal error: empty note store url for "
+                       "the linked notebook's note store"));
+        Q_EMIT failure(errorDescription);
+        return false;
+    }
 
-            if (pSyncChunk->resources.isSet()) {
-                bool res =
-                    mapContainerElementsWithLinkedNotebookGuid<ResourcesList>(
-                        linkedNotebookGuid, pSyncChunk->resources.ref());
-                if (!res) {
-                    return false;
-                }
-            }
+    QObject::connect(
+        pNoteStore, &INoteStore::getLinkedNotebookSyncChunkAsyncFinished, this,
+        &RemoteToLocalSynchronizationManager::
+            onGetLinkedNotebookSyncChunkAsyncFinished,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
 
-            if (pSyncChunk->expungedTags.isSet()) {
-                unmapContainerElementsFromLinkedNotebookGuid<qevercloud::Tag>(
-                    pSyncChunk->expungedTags.ref());
-            }
+    ErrorString errorDescription;
+    bool res = pNoteStore->getLinkedNotebookSyncChunkAsync(
+        download.m_linkedNotebook.qevercloudLinkedNotebook(),
+        download.m_afterUsn, m_maxSyncChunksPerOneDownload,
+        m_authenticationToken, download.m_fullSyncOnly, errorDescription);
 
-            if (pSyncChunk->expungedNotebooks.isSet()) {
-                unmapContainerElementsFromLinkedNotebookGuid<
-                    qevercloud::Notebook>(pSyncChunk->expungedNotebooks.ref());
-            }
-        }
+    if (Q_UNLIKELY(!res)) {
+        ErrorString errorMessage(
+            QT_TR_NOOP("Failed to request linked notebook sync chunk"));
+        errorMessage.additionalBases().append(errorDescription.base());
+        errorMessage.additionalBases().append(
+            errorDescription.additionalBases());
+        errorMessage.details() = errorDescription.details();
+        Q_EMIT failure(errorMessage);
+        return false;
+    }
 
-        lastSyncTimeIt.value() = lastSyncTime;
-        lastUpdateCountIt.value() = lastUpdateCount;
+    download.m_requestInFlight = true;
+    return true;
+}
 
-        Q_UNUSED(m_linkedNotebookGuidsForWhichSyncChunksWereDownloaded.insert(
-            linkedNotebook.guid()));
+bool RemoteToLocalSynchronizationManager::processLinkedNotebookSyncChunk(
+    const QString & linkedNotebookGuid, qevercloud::SyncChunk & syncChunk)
+{
+    if (syncChunk.tags.isSet()) {
+        bool res = mapContainerElementsWithLinkedNotebookGuid<TagsList>(
+            linkedNotebookGuid, syncChunk.tags.ref());
+        if (!res) {
+            return false;
+        }
+    }
 
-        if (fullSyncOnly) {
-            Q_UNUSED(m_linkedNotebookGuidsForWhichFullSyncWasPerformed.insert(
-                linkedNotebook.guid()))
+    if (syncChunk.notebooks.isSet()) {
+        bool res = mapContainerElementsWithLinkedNotebookGuid<NotebooksList>(
+            linkedNotebookGuid, syncChunk.notebooks.ref());
+        if (!res) {
+            return false;
         }
+    }
 
-        pSyncChunk = nullptr;
+    if (syncChunk.notes.isSet()) {
+        bool res = mapContainerElementsWithLinkedNotebookGuid<NotesList>(
+            linkedNotebookGuid, syncChunk.notes.ref());
+        if (!res) {
+            return false;
+        }
     }
 
-    QNDEBUG(
-        "synchronization:remote_to_local",
-        "Done. Processing content "
-            << "pointed to by linked notebooks from buffered sync chunks");
+    if (syncChunk.resources.isSet()) {
+        bool res = mapContainerElementsWithLinkedNotebookGuid<ResourcesList>(
+            linkedNotebookGuid, syncChunk.resources.ref());
+        if (!res) {
+            return false;
+        }
+    }
 
-    // don't need this anymore, it only served the purpose of preventing
-    // multiple get sync state calls for the same linked notebook
-    m_syncStatesByLinkedNotebookGuid.clear();
+    if (syncChunk.expungedTags.isSet()) {
+        unmapContainerElementsFromLinkedNotebookGuid<qevercloud::Tag>(
+            syncChunk.expungedTags.ref());
+    }
 
-    m_linkedNotebooksSyncChunksDownloaded = true;
-    Q_EMIT linkedNotebooksSyncChunksDownloaded();
+    if (syncChunk.expungedNotebooks.isSet()) {
+        unmapContainerElementsFromLinkedNotebookGuid<qevercloud::Notebook>(
+            syncChunk.expungedNotebooks.ref());
+    }
 
+    m_linkedNotebookSyncChunks.append(syncChunk, linkedNotebookGuid);
     return true;
 }
 
@@ -7950,7 +8806,8 @@ void RemoteToLocalSynchronizationManager::checkServerDataMergeCompletion()
         m_tagsPendingAddOrUpdate.isEmpty() &&
         m_findTagByGuidRequestIds.isEmpty() &&
         m_findTagByNameRequestIds.isEmpty() &&
-        m_updateTagRequestIds.isEmpty() && m_addTagRequestIds.isEmpty();
+        m_findOrAddTagsRequestId.isNull() && m_updateTagRequestIds.isEmpty() &&
+        m_addTagRequestIds.isEmpty();
 
     if (!tagsReady) {
         QNDEBUG(
@@ -8293,7 +9150,18 @@ void RemoteToLocalSynchronizationManager::initSyncChunkDataCounters()
         return static_cast<quint64>(std::max(size, 0));
     };
 
-    for (const auto & syncChunk: ::qAsConst(m_syncChunks)) {
+    m_syncChunksDataCounters->m_peakBufferedBytes =
+        m_syncChunks.peakBufferedBytes();
+
+    for (int i = 0, size = m_syncChunks.size(); i < size; ++i) {
+        qevercloud::SyncChunk syncChunk;
+        ErrorString errorDescription;
+        if (Q_UNLIKELY(!m_syncChunks.syncChunk(i, syncChunk, errorDescription)))
+        {
+            QNWARNING("synchronization:remote_to_local", errorDescription);
+            continue;
+        }
+
         if (syncChunk.searches.isSet()) {
             m_syncChunksDataCounters->m_totalSavedSearches +=
                 convert(syncChunk.searches.ref().size());
@@ -8345,7 +9213,19 @@ void RemoteToLocalSynchronizationManager::
         return static_cast<quint64>(std::max(size, 0));
     };
 
-    for (const auto & syncChunk: ::qAsConst(m_linkedNotebookSyncChunks)) {
+    m_linkedNotebookSyncChunksDataCounters->m_peakBufferedBytes =
+        m_linkedNotebookSyncChunks.peakBufferedBytes();
+
+    for (int i = 0, size = m_linkedNotebookSyncChunks.size(); i < size; ++i) {
+        qevercloud::SyncChunk syncChunk;
+        ErrorString errorDescription;
+        if (Q_UNLIKELY(!m_linkedNotebookSyncChunks.syncChunk(
+                i, syncChunk, errorDescription)))
+        {
+            QNWARNING("synchronization:remote_to_local", errorDescription);
+            continue;
+        }
+
         if (syncChunk.tags.isSet()) {
             m_linkedNotebookSyncChunksDataCounters->m_totalTags +=
                 convert(syncChunk.tags.ref().size());
@@ -8464,6 +9344,8 @@ void RemoteToLocalSynchronizationManager::clear()
 
     m_tags.clear();
     m_tagsPendingProcessing.clear();
+    m_guidsOfTagsLevelInProcessing.clear();
+    m_findOrAddTagsRequestId = QUuid();
     m_tagsPendingAddOrUpdate.clear();
     m_expungedTags.clear();
     m_findTagByNameRequestIds.clear();
@@ -8559,6 +9441,14 @@ void RemoteToLocalSynchronizationManager::clear()
 
     m_syncStatesByLinkedNotebookGuid.clear();
 
+    m_linkedNotebooksPendingSyncStateRequestByShardId.clear();
+    m_linkedNotebooksWithSyncStateRequestInFlight.clear();
+    m_linkedNotebookSyncStatesToCheckCount = 0;
+    m_linkedNotebookSyncStatesCheckedCount = 0;
+
+    m_linkedNotebookSyncChunksDownloadsPendingByShardId.clear();
+    m_linkedNotebookSyncChunksDownloadsInProgressByGuid.clear();
+
     // NOTE: not clearing last synchronized USNs, sync times and update counts
     // by linked notebook guid: this information can be reused in subsequent
     // syncs
@@ -8588,6 +9478,7 @@ void RemoteToLocalSynchronizationManager::clear()
     }
 
     m_notebookSyncCache.clear();
+    m_guidIndex.clear();
 
     for (auto * pCache: ::qAsConst(m_notebookSyncCachesByLinkedNotebookGuids)) {
         if (Q_UNLIKELY(!pCache)) {
@@ -8741,6 +9632,13 @@ void RemoteToLocalSynchronizationManager::clear()
         m_syncAccountLimitsPostponeTimerId = 0;
     }
 
+    for (const int timerId: qAsConst(m_rateLimitPostponeTimerIds)) {
+        Q_UNUSED(timerId)
+        m_manager.syncMetrics().finishPhaseInstance(
+            QStringLiteral("rate_limit_wait"));
+    }
+    m_rateLimitPostponeTimerIds.clear();
+
     // NOTE: not clearing m_gotLastSyncParameters: this information can be
     // reused in subsequent syncs
 
@@ -8904,6 +9802,8 @@ void RemoteToLocalSynchronizationManager::timerEvent(QTimerEvent * pEvent)
     QNDEBUG(
         "synchronization:remote_to_local", "Killed timer with id " << timerId);
 
+    finishRateLimitPostponeTimer(timerId);
+
     auto noteToAddIt = m_notesToAddPerAPICallPostponeTimerId.find(timerId);
     if (noteToAddIt != m_notesToAddPerAPICallPostponeTimerId.end()) {
         Note note = noteToAddIt.value();
@@ -9006,6 +9906,28 @@ void RemoteToLocalSynchronizationManager::timerEvent(QTimerEvent * pEvent)
     }
 }
 
+int RemoteToLocalSynchronizationManager::startRateLimitPostponeTimer(
+    const qint32 rateLimitSeconds)
+{
+    int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+    if (timerId != 0) {
+        Q_UNUSED(m_rateLimitPostponeTimerIds.insert(timerId))
+        m_manager.syncMetrics().startPhaseInstance(
+            QStringLiteral("rate_limit_wait"));
+    }
+
+    return timerId;
+}
+
+void RemoteToLocalSynchronizationManager::finishRateLimitPostponeTimer(
+    const int timerId)
+{
+    if (m_rateLimitPostponeTimerIds.remove(timerId)) {
+        m_manager.syncMetrics().finishPhaseInstance(
+            QStringLiteral("rate_limit_wait"));
+    }
+}
+
 void RemoteToLocalSynchronizationManager::getFullNoteDataAsync(
     const Note & note)
 {
@@ -9452,6 +10374,7 @@ void RemoteToLocalSynchronizationManager::downloadSyncChunksAndLaunchSync(
             << "after USN = " << afterUsn);
 
     auto & noteStore = m_manager.noteStore();
+    qevercloud::SyncChunk syncChunk;
     qevercloud::SyncChunk * pSyncChunk = nullptr;
 
     qint32 lastPreviousUsn = std::max(m_lastUpdateCount, 0);
@@ -9469,8 +10392,8 @@ void RemoteToLocalSynchronizationManager::downloadSyncChunksAndLaunchSync(
                     << pSyncChunk->chunkHighUSN);
         }
 
-        m_syncChunks.push_back(qevercloud::SyncChunk());
-        pSyncChunk = &(m_syncChunks.back());
+        syncChunk = qevercloud::SyncChunk();
+        pSyncChunk = &syncChunk;
 
         qevercloud::SyncChunkFilter filter;
         filter.includeNotebooks = true;
@@ -9508,9 +10431,7 @@ void RemoteToLocalSynchronizationManager::downloadSyncChunksAndLaunchSync(
                 return;
             }
 
-            m_syncChunks.pop_back();
-
-            int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+            int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
             if (Q_UNLIKELY(timerId == 0)) {
                 ErrorString errorDescription(QT_TR_NOOP(
                     "Failed to start a timer to postpone the Evernote "
@@ -9563,6 +10484,8 @@ void RemoteToLocalSynchronizationManager::downloadSyncChunksAndLaunchSync(
                 << ", sync chunk update count = " << pSyncChunk->updateCount
                 << ", last update count = " << m_lastUpdateCount);
 
+        m_syncChunks.append(*pSyncChunk);
+
         Q_EMIT syncChunksDownloadProgress(
             pSyncChunk->chunkHighUSN, pSyncChunk->updateCount, lastPreviousUsn);
     }
@@ -9662,7 +10585,7 @@ bool RemoteToLocalSynchronizationManager::checkUserAccountSyncState(
         }
 
         m_getSyncStateBeforeStartAPICallPostponeTimerId =
-            startTimer(secondsToMilliseconds(rateLimitSeconds));
+            startRateLimitPostponeTimer(rateLimitSeconds);
         if (Q_UNLIKELY(m_getSyncStateBeforeStartAPICallPostponeTimerId == 0)) {
             errorDescription.setBase(
                 QT_TR_NOOP("Failed to start a timer to postpone the Evernote "
@@ -9923,18 +10846,16 @@ bool RemoteToLocalSynchronizationManager::
      * the container right here in order to prevent multiple ink note image
      * downloads for the same note during the sync process
      */
-    const auto resources = note.resources();
-    for (auto it = resources.constBegin(), end = resources.constEnd();
-         it != end; ++it)
-    {
-        const auto & resource = *it;
+    const int numResources = note.numResources();
+    for (int i = 0; i < numResources; ++i) {
+        const auto & resource = note.qevercloudResourceAt(i);
 
-        if (resource.hasGuid() && resource.hasMime() && resource.hasWidth() &&
-            resource.hasHeight() &&
-            (resource.mime() == QStringLiteral("vnd.evernote.ink")))
+        if (resource.guid.isSet() && resource.mime.isSet() &&
+            resource.width.isSet() && resource.height.isSet() &&
+            (resource.mime.ref() == QStringLiteral("vnd.evernote.ink")))
         {
             const QString & noteGuid = note.guid();
-            const QString & resGuid = resource.guid();
+            const QString & resGuid = resource.guid.ref();
 
             bool res =
                 m_resourceGuidsPendingInkNoteImageDownloadPerNoteGuid.contains(
@@ -10198,6 +11119,8 @@ void RemoteToLocalSynchronizationManager::launchNoteSyncConflictResolver(
     auto * pResolver = new NoteSyncConflictResolver(
         *m_pNoteSyncConflictResolverManager, remoteNote, localConflict, this);
 
+    meterSyncConflictResolver(*pResolver);
+
     QObject::connect(
         pResolver, &NoteSyncConflictResolver::finished, this,
         &RemoteToLocalSynchronizationManager::
@@ -10224,6 +11147,19 @@ void RemoteToLocalSynchronizationManager::launchNoteSyncConflictResolver(
     pResolver->start();
 }
 
+void RemoteToLocalSynchronizationManager::meterSyncConflictResolver(
+    QObject & resolver)
+{
+    m_manager.syncMetrics().startPhaseInstance(
+        QStringLiteral("conflict_resolution"));
+
+    // Resolvers are deleted right after they finish or on sync's clearing
+    QObject::connect(&resolver, &QObject::destroyed, this, [this] {
+        m_manager.syncMetrics().finishPhaseInstance(
+            QStringLiteral("conflict_resolution"));
+    });
+}
+
 QString RemoteToLocalSynchronizationManager::clientNameForProtocolVersionCheck()
     const
 {
@@ -10590,17 +11526,15 @@ qint32 RemoteToLocalSynchronizationManager::findSmallestUsnOfNonSyncedItems(
             "The sync of notes hasn't "
                 << "started yet, checking notes from sync chunks");
 
-        const QVector<qevercloud::SyncChunk> & syncChunks =
+        const auto & syncChunks =
             (linkedNotebookGuid.isEmpty() ? m_syncChunks
                                           : m_linkedNotebookSyncChunks);
 
-        for (const auto & syncChunk: ::qAsConst(syncChunks)) {
-            if (!syncChunk.notes.isSet()) {
-                continue;
-            }
-
-            checkNonSyncedItemsContainerForSmallestUsn(
-                syncChunk.notes.ref(), linkedNotebookGuid, smallestUsn);
+        qint32 smallestNoteUsn = syncChunks.smallestNoteUsn(linkedNotebookGuid);
+        if ((smallestNoteUsn >= 0) &&
+            ((smallestUsn < 0) || (smallestNoteUsn < smallestUsn)))
+        {
+            smallestUsn = smallestNoteUsn;
         }
     }
     else {
@@ -10775,17 +11709,17 @@ qint32 RemoteToLocalSynchronizationManager::findSmallestUsnOfNonSyncedItems(
             "The sync of resources "
                 << "hasn't started yet, checking resources from sync chunks");
 
-        const QVector<qevercloud::SyncChunk> & syncChunks =
+        const auto & syncChunks =
             (linkedNotebookGuid.isEmpty() ? m_syncChunks
                                           : m_linkedNotebookSyncChunks);
 
-        for (const auto & syncChunk: ::qAsConst(syncChunks)) {
-            if (!syncChunk.resources.isSet()) {
-                continue;
-            }
+        qint32 smallestResourceUsn =
+            syncChunks.smallestResourceUsn(linkedNotebookGuid);
 
-            checkNonSyncedItemsContainerForSmallestUsn(
-                syncChunk.resources.ref(), linkedNotebookGuid, smallestUsn);
+        if ((smallestResourceUsn >= 0) &&
+            ((smallestUsn < 0) || (smallestResourceUsn < smallestUsn)))
+        {
+            smallestUsn = smallestResourceUsn;
         }
     }
     else {
@@ -11240,7 +12174,7 @@ void RemoteToLocalSynchronizationManager::processResourceConflictAsNoteConflict(
             return;
         }
 
-        int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+        int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
         if (Q_UNLIKELY(timerId == 0)) {
             errorDescription.setBase(
                 QT_TR_NOOP("Failed to start a timer to postpone "
@@ -11321,17 +12255,29 @@ void RemoteToLocalSynchronizationManager::processResourceConflictAsNoteConflict(
             << "the remote note in the local storage: request id = "
             << updateNoteRequestId << ", note; " << remoteNote);
 
+    m_manager.syncMetrics().startLocalStorageRequest(
+        updateNoteRequestId, QStringLiteral("updateNote"));
+
     Q_EMIT updateNote(remoteNote, options, updateNoteRequestId);
 
     // Add local conflicting note
     emitAddRequest(localConflictingNote);
 }
 
-void RemoteToLocalSynchronizationManager::syncNextTagPendingProcessing()
+void RemoteToLocalSynchronizationManager::syncNextTagsLevelPendingProcessing()
 {
     QNDEBUG(
         "synchronization:remote_to_local",
-        "RemoteToLocalSynchronizationManager::syncNextTagPendingProcessing");
+        "RemoteToLocalSynchronizationManager"
+            << "::syncNextTagsLevelPendingProcessing");
+
+    if (!m_guidsOfTagsLevelInProcessing.isEmpty()) {
+        QNDEBUG(
+            "synchronization:remote_to_local",
+            "Still have " << m_guidsOfTagsLevelInProcessing.size()
+                          << " tags of the current level in processing");
+        return;
+    }
 
     if (m_tagsPendingProcessing.isEmpty()) {
         QNDEBUG(
@@ -11341,8 +12287,82 @@ void RemoteToLocalSynchronizationManager::syncNextTagPendingProcessing()
         return;
     }
 
-    qevercloud::Tag frontTag = m_tagsPendingProcessing.takeFirst();
-    emitFindByGuidRequest(frontTag);
+    QSet<QString> guidsOfTagsPendingProcessing;
+    guidsOfTagsPendingProcessing.reserve(m_tagsPendingProcessing.size());
+    for (const auto & tag: qAsConst(m_tagsPendingProcessing)) {
+        if (tag.guid.isSet()) {
+            Q_UNUSED(guidsOfTagsPendingProcessing.insert(tag.guid.ref()))
+        }
+    }
+
+    /**
+     * The next level consists of tags which parents are either not within
+     * the pending list at all or have already been processed; tags are sorted
+     * by parent-child relations so the relative order within the level is
+     * preserved
+     */
+    TagsList tagsLevel;
+    for (auto it = m_tagsPendingProcessing.begin();
+         it != m_tagsPendingProcessing.end();)
+    {
+        if (it->parentGuid.isSet() &&
+            guidsOfTagsPendingProcessing.contains(it->parentGuid.ref()))
+        {
+            ++it;
+            continue;
+        }
+
+        tagsLevel << *it;
+        it = m_tagsPendingProcessing.erase(it);
+    }
+
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "Processing the next level of " << tagsLevel.size() << " tags, "
+                                        << m_tagsPendingProcessing.size()
+                                        << " tags remain pending processing");
+
+    QList<Tag> tags;
+    tags.reserve(tagsLevel.size());
+
+    for (const auto & qecTag: qAsConst(tagsLevel)) {
+        if (Q_UNLIKELY(!qecTag.guid.isSet())) {
+            ErrorString errorDescription(QT_TRANSLATE_NOOP(
+                "RemoteToLocalSynchronizationManager",
+                "Internal error: detected tag pending processing "
+                "which doesn't have a guid"));
+            QNWARNING(
+                "synchronization:remote_to_local",
+                errorDescription << ": " << qecTag);
+            Q_EMIT failure(errorDescription);
+            return;
+        }
+
+        Tag tag(qecTag);
+        setNonLocalAndNonDirty(tag);
+        checkAndAddLinkedNotebookBinding(tag);
+        tags << tag;
+
+        Q_UNUSED(m_guidsOfTagsLevelInProcessing.insert(qecTag.guid.ref()))
+    }
+
+    /**
+     * The whole level is looked up and the tags having no local counterparts
+     * are added within a single local storage transaction; tags which do have
+     * local counterparts are then handled by the sync conflict resolvers
+     */
+    m_findOrAddTagsRequestId = QUuid::createUuid();
+
+    QNTRACE(
+        "synchronization:remote_to_local",
+        "Emitting the request to find or add "
+            << tags.size() << " tags in the local storage: request id = "
+            << m_findOrAddTagsRequestId);
+
+    m_manager.syncMetrics().startLocalStorageRequest(
+        m_findOrAddTagsRequestId, QStringLiteral("findOrAddTags"));
+
+    Q_EMIT findOrAddTags(tags, m_findOrAddTagsRequestId);
 }
 
 void RemoteToLocalSynchronizationManager::removeNoteResourcesFromSyncChunks(
@@ -11370,7 +12390,7 @@ void RemoteToLocalSynchronizationManager::removeNoteResourcesFromSyncChunks(
 }
 
 void RemoteToLocalSynchronizationManager::removeResourceFromSyncChunks(
-    const Resource & resource, QVector<qevercloud::SyncChunk> & syncChunks)
+    const Resource & resource, SyncChunksBuffer & syncChunks)
 {
     if (Q_UNLIKELY(!resource.hasGuid())) {
         QNWARNING(
@@ -11380,26 +12400,13 @@ void RemoteToLocalSynchronizationManager::removeResourceFromSyncChunks(
         return;
     }
 
-    for (auto & syncChunk: syncChunks) {
-        if (!syncChunk.resources.isSet()) {
-            continue;
-        }
+    syncChunks.removeResource(resource.guid());
 
-        for (auto rit = syncChunk.resources->begin(),
-                  rend = syncChunk.resources->end();
-             rit != rend; ++rit)
-        {
-            if (rit->guid.isSet() && (rit->guid.ref() == resource.guid())) {
-                Q_UNUSED(syncChunk.resources->erase(rit))
-                QNDEBUG(
-                    "synchronization:remote_to_local",
-                    "Note: removed "
-                        << "resource from sync chunk because it was downloaded "
-                        << "along with the note containing it: " << resource);
-                break;
-            }
-        }
-    }
+    QNDEBUG(
+        "synchronization:remote_to_local",
+        "Note: removed resource "
+            << "from sync chunks because it was downloaded along with "
+            << "the note containing it: " << resource);
 }
 
 void RemoteToLocalSynchronizationManager::junkFullSyncStaleDataItemsExpunger(
@@ -11642,13 +12649,12 @@ void RemoteToLocalSynchronizationManager::
 }
 
 void RemoteToLocalSynchronizationManager::
-    startFeedingDownloadedTagsToLocalStorageOneByOne(
-        const TagsContainer & container)
+    startFeedingDownloadedTagsToLocalStorage(const TagsContainer & container)
 {
     QNDEBUG(
         "synchronization:remote_to_local",
         "RemoteToLocalSynchronizationManager"
-            << "::startFeedingDownloadedTagsToLocalStorageOneByOne");
+            << "::startFeedingDownloadedTagsToLocalStorage");
 
     m_tagsPendingProcessing.reserve(static_cast<int>(container.size()));
     const auto & tagIndexByGuid = container.get<ByGuid>();
@@ -11663,11 +12669,13 @@ void RemoteToLocalSynchronizationManager::
     /**
      * NOTE: parent tags need to be added to the local storage before their
      * children, otherwise the local storage database would have a constraint
-     * failure; by now the tags are already sorted by parent-child relations
-     * but they need to be processed one by one
+     * failure; by now the tags are already sorted by parent-child relations;
+     * they are processed level by level: all tags of the same depth are sent
+     * to the local storage at once and the next level is started only after
+     * the previous one has been fully processed
      */
 
-    syncNextTagPendingProcessing();
+    syncNextTagsLevelPendingProcessing();
 }
 
 #define PRINT_SYNC_MODE(StreamType)                                            \
@@ -12605,6 +13613,9 @@ void RemoteToLocalSynchronizationManager::emitFindByNameRequest<Tag>(
             << "tag in the local storage: request id = " << findElementRequestId
             << ", tag: " << tag);
 
+    m_manager.syncMetrics().startLocalStorageRequest(
+        findElementRequestId, QStringLiteral("findTagByName"));
+
     Q_EMIT findTag(tag, findElementRequestId);
 }
 
@@ -12639,6 +13650,9 @@ void RemoteToLocalSynchronizationManager::emitFindByNameRequest<SavedSearch>(
             << "saved search in the local storage: request id = "
             << findElementRequestId << ", saved search: " << search);
 
+    m_manager.syncMetrics().startLocalStorageRequest(
+        findElementRequestId, QStringLiteral("findSavedSearchByName"));
+
     Q_EMIT findSavedSearch(search, findElementRequestId);
 }
 
@@ -12676,6 +13690,9 @@ void RemoteToLocalSynchronizationManager::emitFindByNameRequest<Notebook>(
             << "notebook in the local storage by name: request id = "
             << findElementRequestId << ", notebook: " << notebook);
 
+    m_manager.syncMetrics().startLocalStorageRequest(
+        findElementRequestId, QStringLiteral("findNotebookByName"));
+
     Q_EMIT findNotebook(notebook, findElementRequestId);
 }
 
@@ -12697,6 +13714,7 @@ bool RemoteToLocalSynchronizationManager::onFoundDuplicateByName(
             << ", requestId  = " << requestId);
 
     Q_UNUSED(findElementRequestIds.erase(rit));
+    m_manager.syncMetrics().finishLocalStorageRequest(requestId);
 
     QString targetLinkedNotebookGuid;
     if (typeName == QStringLiteral("Tag")) {
@@ -12797,6 +13815,7 @@ bool RemoteToLocalSynchronizationManager::onFoundDuplicateByGuid(
             << ", requestId = " << requestId);
 
     Q_UNUSED(findByGuidRequestIds.erase(rit));
+    m_manager.syncMetrics().finishLocalStorageRequest(requestId);
 
     auto it = findItemByGuid(container, element, typeName);
     if (it == container.end()) {
@@ -12870,6 +13889,7 @@ bool RemoteToLocalSynchronizationManager::onNoDuplicateByGuid(
             << errorDescription << ", requestId = " << requestId);
 
     Q_UNUSED(findElementRequestIds.erase(rit));
+    m_manager.syncMetrics().finishLocalStorageRequest(requestId);
 
     auto it = findItemByGuid(container, element, typeName);
     if (it == container.end()) {
@@ -12908,6 +13928,7 @@ bool RemoteToLocalSynchronizationManager::onNoDuplicateByName(
             << errorDescription << ", requestId = " << requestId);
 
     Q_UNUSED(findElementRequestIds.erase(rit));
+    m_manager.syncMetrics().finishLocalStorageRequest(requestId);
 
     QString targetLinkedNotebookGuid;
     if (typeName == QStringLiteral("Tag")) {
@@ -13069,6 +14090,8 @@ RemoteToLocalSynchronizationManager::resolveSyncConflict(
         remoteNotebook, remoteNotebookLinkedNotebookGuid, localConflict,
         *pCache, m_manager.localStorageManagerAsync(), this);
 
+    meterSyncConflictResolver(*pResolver);
+
     QObject::connect(
         pResolver, &NotebookSyncConflictResolver::finished, this,
         &RemoteToLocalSynchronizationManager::
@@ -13184,6 +14207,8 @@ RemoteToLocalSynchronizationManager::resolveSyncConflict(
         remoteTag, remoteTagLinkedNotebookGuid, localConflict, *pCache,
         m_manager.localStorageManagerAsync(), this);
 
+    meterSyncConflictResolver(*pResolver);
+
     QObject::connect(
         pResolver, &TagSyncConflictResolver::finished, this,
         &RemoteToLocalSynchronizationManager::onTagSyncConflictResolverFinished,
@@ -13280,6 +14305,8 @@ RemoteToLocalSynchronizationManager::resolveSyncConflict(
         remoteSavedSearch, localConflict, m_savedSearchSyncCache,
         m_manager.localStorageManagerAsync(), this);
 
+    meterSyncConflictResolver(*pResolver);
+
     QObject::connect(
         pResolver, &SavedSearchSyncConflictResolver::finished, this,
         &RemoteToLocalSynchronizationManager::
@@ -24,7 +24,10 @@
 #include "NotebookSyncConflictResolver.h"
 #include "SavedSearchSyncCache.h"
 #include "SavedSearchSyncConflictResolver.h"
+#include "SyncChunksBuffer.h"
 #include "SyncChunksDataCounters.h"
+#include "SyncGuidIndex.h"
+#include "SyncMetrics.h"
 #include "SynchronizationShared.h"
 #include "TagSyncCache.h"
 #include "TagSyncConflictResolver.h"
@@ -46,6 +49,7 @@
 
 #include <QMap>
 #include <QMultiHash>
+#include <QQueue>
 
 #include <utility>
 
@@ -68,6 +72,8 @@ public:
         virtual INoteStore * noteStoreForLinkedNotebook(
             const LinkedNotebook & linkedNotebook) = 0;
 
+        virtual SyncMetrics & syncMetrics() = 0;
+
         virtual ~IManager() = default;
     };
 
@@ -97,6 +103,14 @@ public:
         return m_linkedNotebooksSyncChunksDownloaded;
     }
 
+    /**
+     * @return  True if update sequence numbers collected by
+     *          collectNonProcessedItemsSmallestUsns in the middle of the sync
+     *          can be persisted so that the next sync would start after them,
+     *          false otherwise
+     */
+    bool canCheckpointSyncProgress() const;
+
     bool shouldDownloadThumbnailsForNotes() const;
     bool shouldDownloadInkNoteImages() const;
     QString inkNoteImagesStoragePath() const;
@@ -141,6 +155,10 @@ Q_SIGNALS:
 
     void linkedNotebooksSyncChunksDownloaded();
 
+    void linkedNotebookSyncStatesCheckProgress(
+        quint32 linkedNotebooksChecked, quint32 totalLinkedNotebooksToCheck,
+        LinkedNotebook linkedNotebook, bool hasUpdates);
+
     void linkedNotebookSyncChunksDataProcessingProgress(
         ISyncChunksDataCountersPtr counters);
 
@@ -214,6 +232,7 @@ Q_SIGNALS:
     void addTag(Tag tag, QUuid requestId);
     void updateTag(Tag tag, QUuid requestId);
     void findTag(Tag tag, QUuid requestId);
+    void findOrAddTags(QList<Tag> tags, QUuid requestId);
     void expungeTag(Tag tag, QUuid requestId);
 
     void expungeNotelessTagsFromLinkedNotebooks(QUuid requestId);
@@ -274,6 +293,13 @@ private Q_SLOTS:
     void onFindTagFailed(
         Tag tag, ErrorString errorDescription, QUuid requestId);
 
+    void onFindOrAddTagsCompleted(
+        QList<Tag> addedTags, QHash<QString, Tag> localConflictsByGuid,
+        QUuid requestId);
+
+    void onFindOrAddTagsFailed(
+        QList<Tag> tags, ErrorString errorDescription, QUuid requestId);
+
     void onFindResourceCompleted(
         Resource resource, LocalStorageManager::GetResourceOptions options,
         QUuid requestId);
@@ -429,6 +455,16 @@ private Q_SLOTS:
         qint32 errorCode, qevercloud::Resource qecResource,
         qint32 rateLimitSeconds, ErrorString errorDescription);
 
+    void onGetLinkedNotebookSyncStateAsyncFinished(
+        qint32 errorCode, QString linkedNotebookGuid,
+        qevercloud::SyncState syncState, qint32 rateLimitSeconds,
+        ErrorString errorDescription);
+
+    void onGetLinkedNotebookSyncChunkAsyncFinished(
+        qint32 errorCode, QString linkedNotebookGuid, qint32 afterUsn,
+        qevercloud::SyncChunk syncChunk, qint32 rateLimitSeconds,
+        ErrorString errorDescription);
+
     // Slots for TagSyncCache
     void onTagSyncCacheFilled();
     void onTagSyncCacheFailure(ErrorString errorDescription);
@@ -538,10 +574,16 @@ private:
         ContainerType & container, QList<QString> & expungedElements);
 
     template <class ContainerType, class LocalType>
-    void launchDataElementSyncCommon(
+    bool launchDataElementSyncCommon(
         const ContentSource contentSource, ContainerType & container,
         QList<QString> & expungedElements);
 
+    // Removes the items which local counterparts are up to date according to
+    // the guid index so that they don't need to be found in the local storage;
+    // the removed items are not counted in sync chunks data counters
+    template <class ContainerType, class LocalType>
+    void removeUpToDateDataElements(ContainerType & container);
+
     template <class ElementType>
     void extractExpungedElementsFromSyncChunk(
         const qevercloud::SyncChunk & syncChunk,
@@ -719,8 +761,40 @@ private:
         const LinkedNotebook & linkedNotebook, const QString & authToken,
         qevercloud::SyncState & syncState, bool & asyncWait, bool & error);
 
+    /**
+     * Requests sync states for all linked notebooks which need them and
+     * don't have them cached yet; requests to the same shard are limited
+     * in number and sent concurrently
+     *
+     * @return          True if all required sync states are already cached,
+     *                  false if the method is waiting for async results or
+     *                  if it has failed
+     */
+    bool requestLinkedNotebooksSyncStates();
+
+    bool sendNextLinkedNotebookSyncStateRequest(const QString & shardId);
+
+    QString linkedNotebookShardId(const LinkedNotebook & linkedNotebook) const;
+
+    /**
+     * Downloads sync chunks for all linked notebooks which have updates
+     * according to their cached sync states; sync chunks of different linked
+     * notebooks are downloaded concurrently, the number of linked notebooks
+     * downloaded from the same shard at once is limited
+     *
+     * @return          True if sync chunks for all linked notebooks were
+     *                  downloaded already, false if the method is waiting for
+     *                  async results or if it has failed
+     */
     bool downloadLinkedNotebooksSyncChunks();
 
+    bool sendLinkedNotebookSyncChunkRequests();
+
+    bool sendLinkedNotebookSyncChunkRequest(const QString & linkedNotebookGuid);
+
+    bool processLinkedNotebookSyncChunk(
+        const QString & linkedNotebookGuid, qevercloud::SyncChunk & syncChunk);
+
     void launchLinkedNotebooksTagsSync();
     void launchLinkedNotebooksNotebooksSync();
 
@@ -739,6 +813,9 @@ private:
 
     virtual void timerEvent(QTimerEvent * pEvent) override;
 
+    int startRateLimitPostponeTimer(const qint32 rateLimitSeconds);
+    void finishRateLimitPostponeTimer(const int timerId);
+
     void getFullNoteDataAsync(const Note & note);
     void getFullNoteDataAsyncAndAddToLocalStorage(const Note & note);
     void getFullNoteDataAsyncAndUpdateInLocalStorage(const Note & note);
@@ -785,6 +862,10 @@ private:
     void launchNoteSyncConflictResolver(
         const Note & localConflict, const qevercloud::Note & remoteNote);
 
+    // Counts the lifetime of the resolver towards the conflict resolution
+    // sync phase
+    void meterSyncConflictResolver(QObject & resolver);
+
     QString clientNameForProtocolVersionCheck() const;
 
     // Infrastructure for persisting the sync state corresponding to data synced
@@ -853,15 +934,15 @@ private:
     void checkAndRemoveInaccessibleParentTagGuidsForTagsFromLinkedNotebook(
         const QString & linkedNotebookGuid, const TagSyncCache & tagSyncCache);
 
-    void startFeedingDownloadedTagsToLocalStorageOneByOne(
+    void startFeedingDownloadedTagsToLocalStorage(
         const TagsContainer & container);
 
-    void syncNextTagPendingProcessing();
+    void syncNextTagsLevelPendingProcessing();
 
     void removeNoteResourcesFromSyncChunks(const Note & note);
 
     void removeResourceFromSyncChunks(
-        const Resource & resource, QVector<qevercloud::SyncChunk> & syncChunks);
+        const Resource & resource, SyncChunksBuffer & syncChunks);
 
 private:
     template <class T>
@@ -978,8 +1059,12 @@ private:
 
     bool m_edamProtocolVersionChecked = false;
 
-    QVector<qevercloud::SyncChunk> m_syncChunks;
-    QVector<qevercloud::SyncChunk> m_linkedNotebookSyncChunks;
+    SyncChunksBuffer m_syncChunks;
+    SyncChunksBuffer m_linkedNotebookSyncChunks;
+
+    // Index of guids of items already present in the local storage, allows
+    // to avoid find by guid requests for items which are new to this client
+    SyncGuidIndex m_guidIndex;
     QSet<QString> m_linkedNotebookGuidsForWhichSyncChunksWereDownloaded;
     std::shared_ptr<SyncChunksDataCounters> m_syncChunksDataCounters;
     std::shared_ptr<SyncChunksDataCounters>
@@ -989,6 +1074,8 @@ private:
 
     TagsContainer m_tags;
     TagsList m_tagsPendingProcessing;
+    QSet<QString> m_guidsOfTagsLevelInProcessing;
+    QUuid m_findOrAddTagsRequestId;
     TagsList m_tagsPendingAddOrUpdate;
     QList<QString> m_expungedTags;
     QSet<QUuid> m_findTagByNameRequestIds;
@@ -1048,6 +1135,30 @@ private:
 
     QHash<QString, qevercloud::SyncState> m_syncStatesByLinkedNotebookGuid;
 
+    QHash<QString, QQueue<LinkedNotebook>>
+        m_linkedNotebooksPendingSyncStateRequestByShardId;
+    QHash<QString, LinkedNotebook>
+        m_linkedNotebooksWithSyncStateRequestInFlight;
+    quint32 m_linkedNotebookSyncStatesToCheckCount = 0;
+    quint32 m_linkedNotebookSyncStatesCheckedCount = 0;
+
+    // Sync chunks download state of a single linked notebook
+    struct LinkedNotebookSyncChunksDownload
+    {
+        LinkedNotebook m_linkedNotebook;
+        qint32 m_afterUsn = 0;
+        qint32 m_lastPreviousUsn = 0;
+        qint32 m_lastUpdateCount = 0;
+        qevercloud::Timestamp m_lastSyncTime = 0;
+        bool m_fullSyncOnly = false;
+        bool m_requestInFlight = false;
+    };
+
+    QHash<QString, QQueue<LinkedNotebookSyncChunksDownload>>
+        m_linkedNotebookSyncChunksDownloadsPendingByShardId;
+    QHash<QString, LinkedNotebookSyncChunksDownload>
+        m_linkedNotebookSyncChunksDownloadsInProgressByGuid;
+
     QHash<QString, qint32> m_lastUpdateCountByLinkedNotebookGuid;
     QHash<QString, qevercloud::Timestamp> m_lastSyncTimeByLinkedNotebookGuid;
     QSet<QString> m_linkedNotebookGuidsForWhichFullSyncWasPerformed;
@@ -1173,6 +1284,9 @@ private:
     int m_syncUserPostponeTimerId = 0;
     int m_syncAccountLimitsPostponeTimerId = 0;
 
+    // Ids of all the timers above, for metering the rate limit waits
+    QSet<int> m_rateLimitPostponeTimerIds;
+
     bool m_gotLastSyncParameters = false;
 };
 
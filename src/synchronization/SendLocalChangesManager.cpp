@@ -800,6 +800,8 @@ void SendLocalChangesManager::timerEvent(QTimerEvent * pEvent)
     killTimer(timerId);
     QNDEBUG("synchronization:send_changes", "Killed timer with id " << timerId);
 
+    finishRateLimitPostponeTimer(timerId);
+
     if (timerId == m_sendTagsPostponeTimerId) {
         m_sendTagsPostponeTimerId = 0;
         sendTags();
@@ -818,6 +820,27 @@ void SendLocalChangesManager::timerEvent(QTimerEvent * pEvent)
     }
 }
 
+int SendLocalChangesManager::startRateLimitPostponeTimer(
+    const qint32 rateLimitSeconds)
+{
+    int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+    if (timerId != 0) {
+        Q_UNUSED(m_rateLimitPostponeTimerIds.insert(timerId))
+        m_manager.syncMetrics().startPhaseInstance(
+            QStringLiteral("rate_limit_wait"));
+    }
+
+    return timerId;
+}
+
+void SendLocalChangesManager::finishRateLimitPostponeTimer(const int timerId)
+{
+    if (m_rateLimitPostponeTimerIds.remove(timerId)) {
+        m_manager.syncMetrics().finishPhaseInstance(
+            QStringLiteral("rate_limit_wait"));
+    }
+}
+
 void SendLocalChangesManager::connectToLocalStorage()
 {
     QNDEBUG(
@@ -1679,7 +1702,7 @@ void SendLocalChangesManager::sendTags()
                 return;
             }
 
-            int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+            int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
             if (Q_UNLIKELY(timerId == 0)) {
                 errorDescription.setBase(
                     QT_TR_NOOP("Failed to start a timer to postpone "
@@ -1998,7 +2021,7 @@ void SendLocalChangesManager::sendSavedSearches()
                 return;
             }
 
-            int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+            int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
             if (Q_UNLIKELY(timerId == 0)) {
                 errorDescription.setBase(
                     QT_TR_NOOP("Failed to start a timer to postpone "
@@ -2319,7 +2342,7 @@ void SendLocalChangesManager::sendNotebooks()
                 return;
             }
 
-            int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+            int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
             if (Q_UNLIKELY(timerId == 0)) {
                 errorDescription.setBase(QT_TR_NOOP(
                     "Failed to start a timer to postpone the "
@@ -2830,7 +2853,7 @@ void SendLocalChangesManager::sendNotes()
                 return;
             }
 
-            int timerId = startTimer(secondsToMilliseconds(rateLimitSeconds));
+            int timerId = startRateLimitPostponeTimer(rateLimitSeconds);
             if (timerId == 0) {
                 errorDescription.setBase(QT_TR_NOOP(
                     "Failed to start a timer to postpone the "
@@ -3245,6 +3268,13 @@ void SendLocalChangesManager::killAllTimers()
         killTimer(m_sendNotesPostponeTimerId);
     }
     m_sendNotesPostponeTimerId = 0;
+
+    for (const int timerId: qAsConst(m_rateLimitPostponeTimerIds)) {
+        Q_UNUSED(timerId)
+        m_manager.syncMetrics().finishPhaseInstance(
+            QStringLiteral("rate_limit_wait"));
+    }
+    m_rateLimitPostponeTimerIds.clear();
 }
 
 bool SendLocalChangesManager::
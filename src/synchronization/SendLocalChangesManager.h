@@ -19,6 +19,7 @@
 #ifndef LIB_QUENTIER_SYNCHRONIZATION_SEND_LOCAL_CHANGES_MANAGER_H
 #define LIB_QUENTIER_SYNCHRONIZATION_SEND_LOCAL_CHANGES_MANAGER_H
 
+#include "SyncMetrics.h"
 #include "SynchronizationShared.h"
 
 #include <quentier/local_storage/LocalStorageManager.h>
@@ -51,6 +52,8 @@ public:
         virtual INoteStore * noteStoreForLinkedNotebook(
             const LinkedNotebook & linkedNotebook) = 0;
 
+        virtual SyncMetrics & syncMetrics() = 0;
+
         virtual ~IManager() {}
     };
 
@@ -234,6 +237,9 @@ private Q_SLOTS:
 private:
     virtual void timerEvent(QTimerEvent * pEvent) override;
 
+    int startRateLimitPostponeTimer(const qint32 rateLimitSeconds);
+    void finishRateLimitPostponeTimer(const int timerId);
+
 private:
     void connectToLocalStorage();
     void disconnectFromLocalStorage();
@@ -357,6 +363,9 @@ private:
     int m_sendSavedSearchesPostponeTimerId = 0;
     int m_sendNotebooksPostponeTimerId = 0;
     int m_sendNotesPostponeTimerId = 0;
+
+    // Ids of all the timers above, for metering the rate limit waits
+    QSet<int> m_rateLimitPostponeTimerIds;
 };
 
 } // namespace quentier
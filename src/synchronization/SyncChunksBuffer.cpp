@@ -0,0 +1,1221 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyncChunksBuffer.h"
+
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Compat.h>
+
+#include <QDataStream>
+#include <QDir>
+#include <QIODevice>
+#include <QTemporaryFile>
+
+#include <algorithm>
+#include <type_traits>
+
+namespace quentier {
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Sync chunks are serialized by listing the fields of each qevercloud type
+ * once, in serialize function templates which are instantiated both with
+ * SyncChunkWriter and SyncChunkReader archives. The listed fields are those
+ * which the local storage persists; other fields are not preserved.
+ */
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SyncChunk & syncChunk);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Data & data);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::LazyMap & lazyMap);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Note & note);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NoteAttributes & attributes);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NoteRestrictions & restrictions);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NoteLimits & limits);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SharedNote & sharedNote);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Identity & identity);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Contact & contact);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Resource & resource);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::ResourceAttributes & attributes);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Notebook & notebook);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Publishing & publishing);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SharedNotebook & sharedNotebook);
+
+template <class Archive>
+void serialize(
+    Archive & ar, qevercloud::SharedNotebookRecipientSettings & settings);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::BusinessNotebook & businessNotebook);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NotebookRestrictions & restrictions);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NotebookRecipientSettings & settings);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::User & user);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::UserAttributes & attributes);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Accounting & accounting);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::BusinessUserInfo & info);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::AccountLimits & accountLimits);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Tag & tag);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SavedSearch & search);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SavedSearchScope & scope);
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::LinkedNotebook & linkedNotebook);
+
+////////////////////////////////////////////////////////////////////////////////
+
+class SyncChunkWriter
+{
+public:
+    explicit SyncChunkWriter(QDataStream & stream) : m_stream(stream) {}
+
+    void operator()(QString & value)
+    {
+        m_stream << value;
+    }
+
+    void operator()(QStringList & value)
+    {
+        m_stream << value;
+    }
+
+    void operator()(QByteArray & value)
+    {
+        m_stream << value;
+    }
+
+    void operator()(QSet<QString> & value)
+    {
+        m_stream << value;
+    }
+
+    void operator()(QMap<QString, QString> & value)
+    {
+        m_stream << value;
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_arithmetic<T>::value>::type operator()(
+        T & value)
+    {
+        m_stream << value;
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_enum<T>::value>::type operator()(
+        T & value)
+    {
+        m_stream << static_cast<qint32>(value);
+    }
+
+    template <class T>
+    void operator()(qevercloud::Optional<T> & value)
+    {
+        m_stream << value.isSet();
+        if (value.isSet()) {
+            (*this)(value.ref());
+        }
+    }
+
+    template <class T>
+    void operator()(QList<T> & values)
+    {
+        m_stream << static_cast<qint32>(values.size());
+        for (auto & value: values) {
+            (*this)(value);
+        }
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_class<T>::value>::type operator()(
+        T & value)
+    {
+        serialize(*this, value);
+    }
+
+private:
+    QDataStream & m_stream;
+};
+
+class SyncChunkReader
+{
+public:
+    explicit SyncChunkReader(QDataStream & stream) : m_stream(stream) {}
+
+    void operator()(QString & value)
+    {
+        m_stream >> value;
+    }
+
+    void operator()(QStringList & value)
+    {
+        m_stream >> value;
+    }
+
+    void operator()(QByteArray & value)
+    {
+        m_stream >> value;
+    }
+
+    void operator()(QSet<QString> & value)
+    {
+        m_stream >> value;
+    }
+
+    void operator()(QMap<QString, QString> & value)
+    {
+        m_stream >> value;
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_arithmetic<T>::value>::type operator()(
+        T & value)
+    {
+        m_stream >> value;
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_enum<T>::value>::type operator()(
+        T & value)
+    {
+        qint32 rawValue = 0;
+        m_stream >> rawValue;
+        value = static_cast<T>(rawValue);
+    }
+
+    template <class T>
+    void operator()(qevercloud::Optional<T> & value)
+    {
+        bool isSet = false;
+        m_stream >> isSet;
+        if (!isSet) {
+            value.clear();
+            return;
+        }
+
+        T item = T();
+        (*this)(item);
+        value = item;
+    }
+
+    template <class T>
+    void operator()(QList<T> & values)
+    {
+        values.clear();
+
+        qint32 size = 0;
+        m_stream >> size;
+        if ((size <= 0) || (m_stream.status() != QDataStream::Ok)) {
+            return;
+        }
+
+        values.reserve(size);
+        for (qint32 i = 0; i < size; ++i) {
+            T value = T();
+            (*this)(value);
+            if (m_stream.status() != QDataStream::Ok) {
+                return;
+            }
+
+            values << value;
+        }
+    }
+
+    template <class T>
+    typename std::enable_if<std::is_class<T>::value>::type operator()(
+        T & value)
+    {
+        serialize(*this, value);
+    }
+
+private:
+    QDataStream & m_stream;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SyncChunk & syncChunk)
+{
+    ar(syncChunk.currentTime);
+    ar(syncChunk.chunkHighUSN);
+    ar(syncChunk.updateCount);
+    ar(syncChunk.notes);
+    ar(syncChunk.notebooks);
+    ar(syncChunk.tags);
+    ar(syncChunk.searches);
+    ar(syncChunk.resources);
+    ar(syncChunk.expungedNotes);
+    ar(syncChunk.expungedNotebooks);
+    ar(syncChunk.expungedTags);
+    ar(syncChunk.expungedSearches);
+    ar(syncChunk.linkedNotebooks);
+    ar(syncChunk.expungedLinkedNotebooks);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Data & data)
+{
+    ar(data.bodyHash);
+    ar(data.size);
+    ar(data.body);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::LazyMap & lazyMap)
+{
+    ar(lazyMap.keysOnly);
+    ar(lazyMap.fullMap);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Note & note)
+{
+    ar(note.guid);
+    ar(note.title);
+    ar(note.content);
+    ar(note.contentHash);
+    ar(note.contentLength);
+    ar(note.created);
+    ar(note.updated);
+    ar(note.deleted);
+    ar(note.active);
+    ar(note.updateSequenceNum);
+    ar(note.notebookGuid);
+    ar(note.tagGuids);
+    ar(note.resources);
+    ar(note.attributes);
+    ar(note.sharedNotes);
+    ar(note.restrictions);
+    ar(note.limits);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NoteAttributes & attributes)
+{
+    ar(attributes.subjectDate);
+    ar(attributes.latitude);
+    ar(attributes.longitude);
+    ar(attributes.altitude);
+    ar(attributes.author);
+    ar(attributes.source);
+    ar(attributes.sourceURL);
+    ar(attributes.sourceApplication);
+    ar(attributes.shareDate);
+    ar(attributes.reminderOrder);
+    ar(attributes.reminderDoneTime);
+    ar(attributes.reminderTime);
+    ar(attributes.placeName);
+    ar(attributes.contentClass);
+    ar(attributes.applicationData);
+    ar(attributes.lastEditedBy);
+    ar(attributes.classifications);
+    ar(attributes.creatorId);
+    ar(attributes.lastEditorId);
+    ar(attributes.sharedWithBusiness);
+    ar(attributes.conflictSourceNoteGuid);
+    ar(attributes.noteTitleQuality);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NoteRestrictions & restrictions)
+{
+    ar(restrictions.noUpdateTitle);
+    ar(restrictions.noUpdateContent);
+    ar(restrictions.noEmail);
+    ar(restrictions.noShare);
+    ar(restrictions.noSharePublicly);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NoteLimits & limits)
+{
+    ar(limits.noteResourceCountMax);
+    ar(limits.uploadLimit);
+    ar(limits.resourceSizeMax);
+    ar(limits.noteSizeMax);
+    ar(limits.uploaded);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SharedNote & sharedNote)
+{
+    ar(sharedNote.sharerUserID);
+    ar(sharedNote.recipientIdentity);
+    ar(sharedNote.privilege);
+    ar(sharedNote.serviceCreated);
+    ar(sharedNote.serviceUpdated);
+    ar(sharedNote.serviceAssigned);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Identity & identity)
+{
+    ar(identity.id);
+    ar(identity.contact);
+    ar(identity.userId);
+    ar(identity.deactivated);
+    ar(identity.sameBusiness);
+    ar(identity.blocked);
+    ar(identity.userConnected);
+    ar(identity.eventId);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Contact & contact)
+{
+    ar(contact.name);
+    ar(contact.id);
+    ar(contact.type);
+    ar(contact.photoUrl);
+    ar(contact.photoLastUpdated);
+    ar(contact.messagingPermit);
+    ar(contact.messagingPermitExpires);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Resource & resource)
+{
+    ar(resource.guid);
+    ar(resource.noteGuid);
+    ar(resource.data);
+    ar(resource.mime);
+    ar(resource.width);
+    ar(resource.height);
+    ar(resource.recognition);
+    ar(resource.attributes);
+    ar(resource.updateSequenceNum);
+    ar(resource.alternateData);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::ResourceAttributes & attributes)
+{
+    ar(attributes.sourceURL);
+    ar(attributes.timestamp);
+    ar(attributes.latitude);
+    ar(attributes.longitude);
+    ar(attributes.altitude);
+    ar(attributes.cameraMake);
+    ar(attributes.cameraModel);
+    ar(attributes.clientWillIndex);
+    ar(attributes.fileName);
+    ar(attributes.attachment);
+    ar(attributes.applicationData);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Notebook & notebook)
+{
+    ar(notebook.guid);
+    ar(notebook.name);
+    ar(notebook.updateSequenceNum);
+    ar(notebook.defaultNotebook);
+    ar(notebook.serviceCreated);
+    ar(notebook.serviceUpdated);
+    ar(notebook.publishing);
+    ar(notebook.published);
+    ar(notebook.stack);
+    ar(notebook.sharedNotebooks);
+    ar(notebook.businessNotebook);
+    ar(notebook.contact);
+    ar(notebook.restrictions);
+    ar(notebook.recipientSettings);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Publishing & publishing)
+{
+    ar(publishing.uri);
+    ar(publishing.order);
+    ar(publishing.ascending);
+    ar(publishing.publicDescription);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SharedNotebook & sharedNotebook)
+{
+    ar(sharedNotebook.id);
+    ar(sharedNotebook.userId);
+    ar(sharedNotebook.notebookGuid);
+    ar(sharedNotebook.email);
+    ar(sharedNotebook.recipientIdentityId);
+    ar(sharedNotebook.serviceCreated);
+    ar(sharedNotebook.serviceUpdated);
+    ar(sharedNotebook.globalId);
+    ar(sharedNotebook.username);
+    ar(sharedNotebook.privilege);
+    ar(sharedNotebook.recipientSettings);
+    ar(sharedNotebook.sharerUserId);
+    ar(sharedNotebook.recipientUsername);
+    ar(sharedNotebook.recipientUserId);
+    ar(sharedNotebook.serviceAssigned);
+}
+
+template <class Archive>
+void serialize(
+    Archive & ar, qevercloud::SharedNotebookRecipientSettings & settings)
+{
+    ar(settings.reminderNotifyEmail);
+    ar(settings.reminderNotifyInApp);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::BusinessNotebook & businessNotebook)
+{
+    ar(businessNotebook.notebookDescription);
+    ar(businessNotebook.privilege);
+    ar(businessNotebook.recommended);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NotebookRestrictions & restrictions)
+{
+    ar(restrictions.noReadNotes);
+    ar(restrictions.noCreateNotes);
+    ar(restrictions.noUpdateNotes);
+    ar(restrictions.noExpungeNotes);
+    ar(restrictions.noShareNotes);
+    ar(restrictions.noEmailNotes);
+    ar(restrictions.noSendMessageToRecipients);
+    ar(restrictions.noUpdateNotebook);
+    ar(restrictions.noExpungeNotebook);
+    ar(restrictions.noSetDefaultNotebook);
+    ar(restrictions.noSetNotebookStack);
+    ar(restrictions.noPublishToPublic);
+    ar(restrictions.noPublishToBusinessLibrary);
+    ar(restrictions.noCreateTags);
+    ar(restrictions.noUpdateTags);
+    ar(restrictions.noExpungeTags);
+    ar(restrictions.noSetParentTag);
+    ar(restrictions.noCreateSharedNotebooks);
+    ar(restrictions.updateWhichSharedNotebookRestrictions);
+    ar(restrictions.expungeWhichSharedNotebookRestrictions);
+    ar(restrictions.noShareNotesWithBusiness);
+    ar(restrictions.noRenameNotebook);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::NotebookRecipientSettings & settings)
+{
+    ar(settings.reminderNotifyEmail);
+    ar(settings.reminderNotifyInApp);
+    ar(settings.inMyList);
+    ar(settings.stack);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::User & user)
+{
+    ar(user.id);
+    ar(user.username);
+    ar(user.email);
+    ar(user.name);
+    ar(user.timezone);
+    ar(user.privilege);
+    ar(user.serviceLevel);
+    ar(user.created);
+    ar(user.updated);
+    ar(user.deleted);
+    ar(user.active);
+    ar(user.shardId);
+    ar(user.attributes);
+    ar(user.accounting);
+    ar(user.businessUserInfo);
+    ar(user.photoUrl);
+    ar(user.photoLastUpdated);
+    ar(user.accountLimits);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::UserAttributes & attributes)
+{
+    ar(attributes.defaultLocationName);
+    ar(attributes.defaultLatitude);
+    ar(attributes.defaultLongitude);
+    ar(attributes.preactivation);
+    ar(attributes.viewedPromotions);
+    ar(attributes.incomingEmailAddress);
+    ar(attributes.recentMailedAddresses);
+    ar(attributes.comments);
+    ar(attributes.dateAgreedToTermsOfService);
+    ar(attributes.maxReferrals);
+    ar(attributes.referralCount);
+    ar(attributes.refererCode);
+    ar(attributes.sentEmailDate);
+    ar(attributes.sentEmailCount);
+    ar(attributes.dailyEmailLimit);
+    ar(attributes.emailOptOutDate);
+    ar(attributes.partnerEmailOptInDate);
+    ar(attributes.preferredLanguage);
+    ar(attributes.preferredCountry);
+    ar(attributes.clipFullPage);
+    ar(attributes.twitterUserName);
+    ar(attributes.twitterId);
+    ar(attributes.groupName);
+    ar(attributes.recognitionLanguage);
+    ar(attributes.referralProof);
+    ar(attributes.educationalDiscount);
+    ar(attributes.businessAddress);
+    ar(attributes.hideSponsorBilling);
+    ar(attributes.useEmailAutoFiling);
+    ar(attributes.reminderEmailConfig);
+    ar(attributes.emailAddressLastConfirmed);
+    ar(attributes.passwordUpdated);
+    ar(attributes.salesforcePushEnabled);
+    ar(attributes.shouldLogClientEvent);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Accounting & accounting)
+{
+    ar(accounting.uploadLimitEnd);
+    ar(accounting.uploadLimitNextMonth);
+    ar(accounting.premiumServiceStatus);
+    ar(accounting.premiumOrderNumber);
+    ar(accounting.premiumCommerceService);
+    ar(accounting.premiumServiceStart);
+    ar(accounting.premiumServiceSKU);
+    ar(accounting.lastSuccessfulCharge);
+    ar(accounting.lastFailedCharge);
+    ar(accounting.lastFailedChargeReason);
+    ar(accounting.nextPaymentDue);
+    ar(accounting.premiumLockUntil);
+    ar(accounting.updated);
+    ar(accounting.premiumSubscriptionNumber);
+    ar(accounting.lastRequestedCharge);
+    ar(accounting.currency);
+    ar(accounting.unitPrice);
+    ar(accounting.unitDiscount);
+    ar(accounting.nextChargeDate);
+    ar(accounting.availablePoints);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::BusinessUserInfo & info)
+{
+    ar(info.businessId);
+    ar(info.businessName);
+    ar(info.role);
+    ar(info.email);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::AccountLimits & accountLimits)
+{
+    ar(accountLimits.userMailLimitDaily);
+    ar(accountLimits.noteSizeMax);
+    ar(accountLimits.resourceSizeMax);
+    ar(accountLimits.userLinkedNotebookMax);
+    ar(accountLimits.uploadLimit);
+    ar(accountLimits.userNoteCountMax);
+    ar(accountLimits.userNotebookCountMax);
+    ar(accountLimits.userTagCountMax);
+    ar(accountLimits.noteTagCountMax);
+    ar(accountLimits.userSavedSearchesMax);
+    ar(accountLimits.noteResourceCountMax);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::Tag & tag)
+{
+    ar(tag.guid);
+    ar(tag.name);
+    ar(tag.parentGuid);
+    ar(tag.updateSequenceNum);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SavedSearch & search)
+{
+    ar(search.guid);
+    ar(search.name);
+    ar(search.query);
+    ar(search.format);
+    ar(search.updateSequenceNum);
+    ar(search.scope);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::SavedSearchScope & scope)
+{
+    ar(scope.includeAccount);
+    ar(scope.includePersonalLinkedNotebooks);
+    ar(scope.includeBusinessLinkedNotebooks);
+}
+
+template <class Archive>
+void serialize(Archive & ar, qevercloud::LinkedNotebook & linkedNotebook)
+{
+    ar(linkedNotebook.shareName);
+    ar(linkedNotebook.username);
+    ar(linkedNotebook.shardId);
+    ar(linkedNotebook.sharedNotebookGlobalId);
+    ar(linkedNotebook.uri);
+    ar(linkedNotebook.guid);
+    ar(linkedNotebook.updateSequenceNum);
+    ar(linkedNotebook.noteStoreUrl);
+    ar(linkedNotebook.webApiUrlPrefix);
+    ar(linkedNotebook.stack);
+    ar(linkedNotebook.businessId);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+QByteArray serializeSyncChunk(qevercloud::SyncChunk syncChunk)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_5);
+
+    SyncChunkWriter writer(stream);
+    writer(syncChunk);
+
+    return data;
+}
+
+bool deserializeSyncChunk(
+    const QByteArray & data, qevercloud::SyncChunk & syncChunk)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_5);
+
+    SyncChunkReader reader(stream);
+    reader(syncChunk);
+
+    return (stream.status() == QDataStream::Ok);
+}
+
+/**
+ * QIODevice which only counts the bytes written to it, used to find out
+ * the size of the serialized form of data without actually keeping it
+ */
+class ByteCounter final : public QIODevice
+{
+public:
+    ByteCounter()
+    {
+        Q_UNUSED(open(QIODevice::WriteOnly | QIODevice::Unbuffered))
+    }
+
+    quint64 count() const
+    {
+        return m_count;
+    }
+
+protected:
+    virtual qint64 readData(char * data, qint64 maxSize) override
+    {
+        Q_UNUSED(data)
+        Q_UNUSED(maxSize)
+        return -1;
+    }
+
+    virtual qint64 writeData(const char * data, qint64 maxSize) override
+    {
+        Q_UNUSED(data)
+        m_count += static_cast<quint64>(std::max(maxSize, qint64(0)));
+        return maxSize;
+    }
+
+private:
+    quint64 m_count = 0;
+};
+
+template <class T>
+quint64 serializedSize(T value)
+{
+    ByteCounter counter;
+    QDataStream stream(&counter);
+    stream.setVersion(QDataStream::Qt_5_5);
+
+    SyncChunkWriter writer(stream);
+    writer(value);
+
+    return counter.count();
+}
+
+const SyncChunksBuffer::DataElement allDataElements[] = {
+    SyncChunksBuffer::DataElement::SavedSearches,
+    SyncChunksBuffer::DataElement::LinkedNotebooks,
+    SyncChunksBuffer::DataElement::Tags,
+    SyncChunksBuffer::DataElement::Notebooks,
+    SyncChunksBuffer::DataElement::Notes,
+    SyncChunksBuffer::DataElement::Resources};
+
+/**
+ * Calls the function with the field of the sync chunk which holds the data
+ * elements of the given kind
+ */
+template <class Function>
+void processSyncChunkDataElements(
+    const SyncChunksBuffer::DataElement dataElement,
+    qevercloud::SyncChunk & syncChunk, Function && function)
+{
+    switch (dataElement) {
+    case SyncChunksBuffer::DataElement::SavedSearches:
+        function(syncChunk.searches);
+        break;
+    case SyncChunksBuffer::DataElement::LinkedNotebooks:
+        function(syncChunk.linkedNotebooks);
+        break;
+    case SyncChunksBuffer::DataElement::Tags:
+        function(syncChunk.tags);
+        break;
+    case SyncChunksBuffer::DataElement::Notebooks:
+        function(syncChunk.notebooks);
+        break;
+    case SyncChunksBuffer::DataElement::Notes:
+        function(syncChunk.notes);
+        break;
+    case SyncChunksBuffer::DataElement::Resources:
+        function(syncChunk.resources);
+        break;
+    }
+}
+
+void releaseDataElementsFromSyncChunk(
+    const SyncChunksBuffer::DataElements dataElements,
+    qevercloud::SyncChunk & syncChunk)
+{
+    for (const auto dataElement: allDataElements) {
+        if (!dataElements.testFlag(dataElement)) {
+            continue;
+        }
+
+        processSyncChunkDataElements(
+            dataElement, syncChunk, [](auto & elements) { elements.clear(); });
+    }
+}
+
+template <class T>
+bool listIsNonEmpty(const qevercloud::Optional<QList<T>> & list)
+{
+    return list.isSet() && !list.ref().isEmpty();
+}
+
+bool syncChunkContainsExpungedItems(const qevercloud::SyncChunk & syncChunk)
+{
+    return listIsNonEmpty(syncChunk.expungedNotes) ||
+        listIsNonEmpty(syncChunk.expungedNotebooks) ||
+        listIsNonEmpty(syncChunk.expungedTags) ||
+        listIsNonEmpty(syncChunk.expungedSearches) ||
+        listIsNonEmpty(syncChunk.expungedLinkedNotebooks);
+}
+
+qint32 smallestNoteUsn(const qevercloud::SyncChunk & syncChunk)
+{
+    qint32 smallestUsn = -1;
+    if (!syncChunk.notes.isSet()) {
+        return smallestUsn;
+    }
+
+    for (const auto & note: qAsConst(syncChunk.notes.ref())) {
+        if (!note.guid.isSet() || !note.updateSequenceNum.isSet()) {
+            continue;
+        }
+
+        const qint32 usn = note.updateSequenceNum.ref();
+        if ((smallestUsn < 0) || (usn < smallestUsn)) {
+            smallestUsn = usn;
+        }
+    }
+
+    return smallestUsn;
+}
+
+QHash<QString, qint32> resourceUsnsByGuid(
+    const qevercloud::SyncChunk & syncChunk)
+{
+    QHash<QString, qint32> usnsByGuid;
+    if (!syncChunk.resources.isSet()) {
+        return usnsByGuid;
+    }
+
+    for (const auto & resource: qAsConst(syncChunk.resources.ref())) {
+        if (resource.guid.isSet()) {
+            usnsByGuid[resource.guid.ref()] =
+                (resource.updateSequenceNum.isSet()
+                     ? resource.updateSequenceNum.ref()
+                     : -1);
+        }
+    }
+
+    return usnsByGuid;
+}
+
+void removeResourcesFromSyncChunk(
+    const QSet<QString> & resourceGuids, qevercloud::SyncChunk & syncChunk)
+{
+    if (resourceGuids.isEmpty() || !syncChunk.resources.isSet()) {
+        return;
+    }
+
+    auto & resources = syncChunk.resources.ref();
+    for (auto it = resources.begin(); it != resources.end();) {
+        if (it->guid.isSet() && resourceGuids.contains(it->guid.ref())) {
+            it = resources.erase(it);
+            continue;
+        }
+
+        ++it;
+    }
+}
+
+/**
+ * @return  The size of the serialized form of the removed resource, zero if
+ *          the sync chunk contained no resource with the given guid
+ */
+quint64 removeResourceFromSyncChunk(
+    const QString & resourceGuid, qevercloud::SyncChunk & syncChunk)
+{
+    if (!syncChunk.resources.isSet()) {
+        return 0;
+    }
+
+    auto & resources = syncChunk.resources.ref();
+    for (auto it = resources.begin(); it != resources.end(); ++it) {
+        if (it->guid.isSet() && (it->guid.ref() == resourceGuid)) {
+            quint64 size = serializedSize(*it);
+            Q_UNUSED(resources.erase(it))
+            return size;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+SyncChunksBuffer::SyncChunksBuffer(const int maxSyncChunksInMemory) :
+    m_maxSyncChunksInMemory(std::max(maxSyncChunksInMemory, 0))
+{}
+
+SyncChunksBuffer::~SyncChunksBuffer() = default;
+
+int SyncChunksBuffer::size() const
+{
+    return m_entries.size();
+}
+
+bool SyncChunksBuffer::isEmpty() const
+{
+    return m_entries.isEmpty();
+}
+
+void SyncChunksBuffer::clear()
+{
+    m_entries.clear();
+    m_pFile.reset();
+
+    m_syncChunksInMemory = 0;
+    m_bufferedBytes = 0;
+    m_peakBufferedBytes = 0;
+}
+
+void SyncChunksBuffer::append(
+    const qevercloud::SyncChunk & syncChunk, const QString & linkedNotebookGuid)
+{
+    Entry entry;
+    entry.m_linkedNotebookGuid = linkedNotebookGuid;
+    entry.m_containsExpungedItems = syncChunkContainsExpungedItems(syncChunk);
+    entry.m_smallestNoteUsn = smallestNoteUsn(syncChunk);
+    entry.m_resourceUsnsByGuid = resourceUsnsByGuid(syncChunk);
+
+    QByteArray data = serializeSyncChunk(syncChunk);
+    entry.m_serializedSize = static_cast<quint64>(data.size());
+
+    if (m_syncChunksInMemory >= m_maxSyncChunksInMemory) {
+        ErrorString errorDescription;
+        if (writeToFile(data, entry, errorDescription)) {
+            m_entries << entry;
+            return;
+        }
+
+        QNWARNING(
+            "synchronization:sync_chunks_buffer",
+            "Failed to write sync chunk to the temporary file, keeping it in "
+                << "memory: " << errorDescription);
+    }
+
+    entry.m_pSyncChunk = std::make_shared<qevercloud::SyncChunk>(syncChunk);
+    m_entries << entry;
+
+    ++m_syncChunksInMemory;
+    m_bufferedBytes += entry.m_serializedSize;
+    m_peakBufferedBytes = std::max(m_peakBufferedBytes, m_bufferedBytes);
+}
+
+bool SyncChunksBuffer::syncChunk(
+    const int index, qevercloud::SyncChunk & syncChunk,
+    ErrorString & errorDescription) const
+{
+    if (Q_UNLIKELY((index < 0) || (index >= m_entries.size()))) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Internal error: sync chunk index is out of range"));
+        errorDescription.details() = QString::number(index);
+        return false;
+    }
+
+    const auto & entry = m_entries[index];
+    if (entry.m_pSyncChunk) {
+        syncChunk = *entry.m_pSyncChunk;
+        return true;
+    }
+
+    if (Q_UNLIKELY(!m_pFile)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Internal error: no temporary file with buffered sync "
+                       "chunks"));
+        return false;
+    }
+
+    if (Q_UNLIKELY(!m_pFile->seek(entry.m_fileOffset))) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to read the buffered sync chunk from "
+                       "the temporary file"));
+        errorDescription.details() = m_pFile->errorString();
+        return false;
+    }
+
+    QByteArray compressedData = m_pFile->read(entry.m_fileDataSize);
+    if (Q_UNLIKELY(compressedData.size() != entry.m_fileDataSize)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to read the buffered sync chunk from "
+                       "the temporary file"));
+        errorDescription.details() = m_pFile->errorString();
+        return false;
+    }
+
+    syncChunk = qevercloud::SyncChunk();
+    QByteArray data = qUncompress(compressedData);
+    if (Q_UNLIKELY(data.isEmpty() || !deserializeSyncChunk(data, syncChunk))) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to deserialize the buffered sync chunk"));
+        return false;
+    }
+
+    removeResourcesFromSyncChunk(entry.m_removedResourceGuids, syncChunk);
+    releaseDataElementsFromSyncChunk(entry.m_releasedDataElements, syncChunk);
+    return true;
+}
+
+void SyncChunksBuffer::removeResource(const QString & resourceGuid)
+{
+    for (auto & entry: m_entries) {
+        auto it = entry.m_resourceUsnsByGuid.find(resourceGuid);
+        if (it == entry.m_resourceUsnsByGuid.end()) {
+            continue;
+        }
+
+        Q_UNUSED(entry.m_resourceUsnsByGuid.erase(it))
+
+        if (entry.m_pSyncChunk) {
+            quint64 size = std::min(
+                removeResourceFromSyncChunk(resourceGuid, *entry.m_pSyncChunk),
+                entry.m_serializedSize);
+
+            entry.m_serializedSize -= size;
+            m_bufferedBytes -= size;
+        }
+        else {
+            Q_UNUSED(entry.m_removedResourceGuids.insert(resourceGuid))
+        }
+    }
+}
+
+void SyncChunksBuffer::releaseDataElements(const DataElement dataElement)
+{
+    for (auto & entry: m_entries) {
+        if (dataElement == DataElement::Notes) {
+            entry.m_smallestNoteUsn = -1;
+        }
+        else if (dataElement == DataElement::Resources) {
+            entry.m_resourceUsnsByGuid.clear();
+            entry.m_removedResourceGuids.clear();
+        }
+
+        if (!entry.m_pSyncChunk) {
+            entry.m_releasedDataElements |= dataElement;
+            continue;
+        }
+
+        processSyncChunkDataElements(
+            dataElement, *entry.m_pSyncChunk, [&](auto & elements) {
+                if (!elements.isSet()) {
+                    return;
+                }
+
+                quint64 size = std::min(
+                    serializedSize(elements.ref()), entry.m_serializedSize);
+
+                entry.m_serializedSize -= size;
+                m_bufferedBytes -= size;
+                elements.clear();
+            });
+    }
+}
+
+bool SyncChunksBuffer::containsExpungedItems() const
+{
+    return std::any_of(
+        m_entries.constBegin(), m_entries.constEnd(),
+        [](const Entry & entry) { return entry.m_containsExpungedItems; });
+}
+
+qint32 SyncChunksBuffer::smallestNoteUsn(
+    const QString & linkedNotebookGuid) const
+{
+    qint32 smallestUsn = -1;
+    for (const auto & entry: qAsConst(m_entries)) {
+        if ((entry.m_linkedNotebookGuid != linkedNotebookGuid) ||
+            (entry.m_smallestNoteUsn < 0))
+        {
+            continue;
+        }
+
+        if ((smallestUsn < 0) || (entry.m_smallestNoteUsn < smallestUsn)) {
+            smallestUsn = entry.m_smallestNoteUsn;
+        }
+    }
+
+    return smallestUsn;
+}
+
+qint32 SyncChunksBuffer::smallestResourceUsn(
+    const QString & linkedNotebookGuid) const
+{
+    qint32 smallestUsn = -1;
+    for (const auto & entry: qAsConst(m_entries)) {
+        if (entry.m_linkedNotebookGuid != linkedNotebookGuid) {
+            continue;
+        }
+
+        for (const qint32 usn: qAsConst(entry.m_resourceUsnsByGuid)) {
+            if ((usn >= 0) && ((smallestUsn < 0) || (usn < smallestUsn))) {
+                smallestUsn = usn;
+            }
+        }
+    }
+
+    return smallestUsn;
+}
+
+quint64 SyncChunksBuffer::bufferedBytes() const
+{
+    return m_bufferedBytes;
+}
+
+quint64 SyncChunksBuffer::peakBufferedBytes() const
+{
+    return m_peakBufferedBytes;
+}
+
+bool SyncChunksBuffer::writeToFile(
+    const QByteArray & data, Entry & entry, ErrorString & errorDescription)
+{
+    if (!m_pFile) {
+        m_pFile = std::make_unique<QTemporaryFile>(
+            QDir::tempPath() + QStringLiteral("/quentier_sync_chunks_XXXXXX"));
+
+        if (Q_UNLIKELY(!m_pFile->open())) {
+            errorDescription.setBase(
+                QT_TR_NOOP("Failed to open the temporary file for buffered "
+                           "sync chunks"));
+            errorDescription.details() = m_pFile->errorString();
+            m_pFile.reset();
+            return false;
+        }
+    }
+
+    QByteArray compressedData = qCompress(data);
+
+    qint64 fileOffset = m_pFile->size();
+    if (Q_UNLIKELY(!m_pFile->seek(fileOffset))) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to write the sync chunk to the temporary file"));
+        errorDescription.details() = m_pFile->errorString();
+        return false;
+    }
+
+    qint64 bytesWritten = m_pFile->write(compressedData);
+    if (Q_UNLIKELY(bytesWritten != compressedData.size())) {
+        errorDescription.setBase(
+            QT_TR_NOOP("Failed to write the sync chunk to the temporary file"));
+        errorDescription.details() = m_pFile->errorString();
+        return false;
+    }
+
+    entry.m_fileOffset = fileOffset;
+    entry.m_fileDataSize = bytesWritten;
+    return true;
+}
+
+} // namespace quentier
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_SYNCHRONIZATION_SYNC_CHUNKS_BUFFER_H
+#define LIB_QUENTIER_SYNCHRONIZATION_SYNC_CHUNKS_BUFFER_H
+
+#include <quentier/types/ErrorString.h>
+
+#include <qt5qevercloud/QEverCloud.h>
+
+#include <QFlags>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include <memory>
+
+QT_FORWARD_DECLARE_CLASS(QTemporaryFile)
+
+namespace quentier {
+
+/**
+ * @brief The SyncChunksBuffer class holds the sync chunks downloaded during
+ * the "remote to local" synchronization until their contents are processed.
+ *
+ * At most the specified number of sync chunks is kept in memory, the rest are
+ * serialized in compressed form into a temporary file and deserialized back
+ * when requested. Data elements of each kind can be released from the buffer
+ * once they were moved elsewhere for processing so that they are not kept
+ * in memory twice.
+ */
+class Q_DECL_HIDDEN SyncChunksBuffer
+{
+public:
+    enum class DataElement
+    {
+        SavedSearches = 0x1,
+        LinkedNotebooks = 0x2,
+        Tags = 0x4,
+        Notebooks = 0x8,
+        Notes = 0x10,
+        Resources = 0x20
+    };
+
+    Q_DECLARE_FLAGS(DataElements, DataElement)
+
+public:
+    explicit SyncChunksBuffer(const int maxSyncChunksInMemory);
+    ~SyncChunksBuffer();
+
+    int size() const;
+    bool isEmpty() const;
+
+    void clear();
+
+    /**
+     * Appends the sync chunk to the buffer; if the buffer already holds
+     * the max allowed number of sync chunks in memory, the appended one is
+     * written to the temporary file. If that fails, the sync chunk is kept
+     * in memory anyway.
+     *
+     * @param syncChunk             The sync chunk to append
+     * @param linkedNotebookGuid    The guid of the linked notebook for which
+     *                              the sync chunk was downloaded, empty for
+     *                              the sync chunks from user's own account
+     */
+    void append(
+        const qevercloud::SyncChunk & syncChunk,
+        const QString & linkedNotebookGuid = {});
+
+    /**
+     * Provides the sync chunk at the given index
+     *
+     * @param index             The index of the sync chunk within the buffer
+     * @param syncChunk         Output parameter, the sync chunk
+     * @param errorDescription  The textual description of the error in case
+     *                          the sync chunk could not be read back from
+     *                          the temporary file
+     * @return                  True in case of success, false otherwise
+     */
+    bool syncChunk(
+        const int index, qevercloud::SyncChunk & syncChunk,
+        ErrorString & errorDescription) const;
+
+    /**
+     * Removes the resource with the given guid from all buffered sync chunks
+     */
+    void removeResource(const QString & resourceGuid);
+
+    /**
+     * Releases the data elements of the given kind from all buffered sync
+     * chunks; sync chunks provided by the buffer afterwards don't contain
+     * them. Guids of expunged data elements are not released.
+     */
+    void releaseDataElements(const DataElement dataElement);
+
+    /**
+     * @return  True if any of the buffered sync chunks contains guids of
+     *          expunged data elements, false otherwise; doesn't need to read
+     *          the sync chunks back from the temporary file
+     */
+    bool containsExpungedItems() const;
+
+    /**
+     * @param linkedNotebookGuid    The guid of the linked notebook for which
+     *                              the sync chunks were downloaded, empty for
+     *                              the sync chunks from user's own account
+     * @return                      The smallest USN of notes which were not
+     *                              released from the sync chunks yet or -1 if
+     *                              there are no such notes; doesn't need to
+     *                              read the sync chunks back from
+     *                              the temporary file
+     */
+    qint32 smallestNoteUsn(const QString & linkedNotebookGuid) const;
+
+    /**
+     * @param linkedNotebookGuid    The guid of the linked notebook for which
+     *                              the sync chunks were downloaded, empty for
+     *                              the sync chunks from user's own account
+     * @return                      The smallest USN of resources which were
+     *                              neither removed nor released from the sync
+     *                              chunks yet or -1 if there are no such
+     *                              resources; doesn't need to read the sync
+     *                              chunks back from the temporary file
+     */
+    qint32 smallestResourceUsn(const QString & linkedNotebookGuid) const;
+
+    /**
+     * @return  The number of bytes occupied by the sync chunks currently kept
+     *          in memory, estimated by the size of their serialized form;
+     *          neither the sync chunks written to the temporary file nor
+     *          the removed and released data elements are counted
+     */
+    quint64 bufferedBytes() const;
+
+    /**
+     * @return  The max number of bytes occupied by the sync chunks kept in
+     *          memory since the creation or the last clear of the buffer,
+     *          counted the same way as bufferedBytes
+     */
+    quint64 peakBufferedBytes() const;
+
+private:
+    struct Entry
+    {
+        // Set only if the sync chunk is kept in memory
+        std::shared_ptr<qevercloud::SyncChunk> m_pSyncChunk;
+
+        qint64 m_fileOffset = -1;
+        qint64 m_fileDataSize = 0;
+        quint64 m_serializedSize = 0;
+
+        QString m_linkedNotebookGuid;
+        bool m_containsExpungedItems = false;
+        qint32 m_smallestNoteUsn = -1;
+
+        // USNs of resources not yet removed from the sync chunk by their guids
+        QHash<QString, qint32> m_resourceUsnsByGuid;
+
+        // Guids of resources removed from the sync chunk after it was written
+        // to the temporary file
+        QSet<QString> m_removedResourceGuids;
+
+        // Data elements released from the sync chunk after it was written
+        // to the temporary file
+        DataElements m_releasedDataElements;
+    };
+
+    bool writeToFile(
+        const QByteArray & data, Entry & entry,
+        ErrorString & errorDescription);
+
+private:
+    Q_DISABLE_COPY(SyncChunksBuffer)
+
+private:
+    const int m_maxSyncChunksInMemory;
+    int m_syncChunksInMemory = 0;
+
+    QVector<Entry> m_entries;
+    std::unique_ptr<QTemporaryFile> m_pFile;
+
+    quint64 m_bufferedBytes = 0;
+    quint64 m_peakBufferedBytes = 0;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_SYNCHRONIZATION_SYNC_CHUNKS_BUFFER_H
@@ -45,6 +45,7 @@ QTextStream & SyncChunksDataCounters::print(QTextStream & strm) const
          << "  added notebooks = " << m_addedNotebooks << "\n"
          << "  updated notebooks = " << m_updatedNotebooks << "\n"
          << "  expunged notebooks = " << m_expungedNotebooks << "\n"
+         << "  peak buffered bytes = " << m_peakBufferedBytes << "\n"
          << "}\n";
 
     return strm;
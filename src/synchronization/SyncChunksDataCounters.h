@@ -131,6 +131,11 @@ struct SyncChunksDataCounters : public ISyncChunksDataCounters
         return m_expungedNotebooks;
     }
 
+    quint64 peakBufferedBytes() const noexcept override
+    {
+        return m_peakBufferedBytes;
+    }
+
     quint64 m_totalSavedSearches = 0ul;
     quint64 m_totalExpungedSavedSearches = 0ul;
     quint64 m_addedSavedSearches = 0ul;
@@ -155,6 +160,8 @@ struct SyncChunksDataCounters : public ISyncChunksDataCounters
     quint64 m_updatedNotebooks = 0ul;
     quint64 m_expungedNotebooks = 0ul;
 
+    quint64 m_peakBufferedBytes = 0ul;
+
     QTextStream & print(QTextStream & strm) const override;
 };
 
@@ -0,0 +1,440 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyncGuidIndex.h"
+
+#include <quentier/logging/QuentierLogger.h>
+
+namespace quentier {
+
+SyncGuidIndex::SyncGuidIndex(
+    LocalStorageManagerAsync & localStorageManagerAsync, QObject * parent) :
+    QObject(parent),
+    m_localStorageManagerAsync(localStorageManagerAsync)
+{}
+
+void SyncGuidIndex::clear()
+{
+    QNDEBUG("synchronization:guid_index", "SyncGuidIndex::clear");
+
+    disconnectFromLocalStorage();
+
+    m_index = LocalStorageManager::GuidIndex();
+    m_guidIndexRequestId = QUuid();
+}
+
+bool SyncGuidIndex::isFilled() const
+{
+    if (!m_connectedToLocalStorage) {
+        return false;
+    }
+
+    if (m_guidIndexRequestId.isNull()) {
+        return true;
+    }
+
+    return false;
+}
+
+const SyncGuidIndex::Entry * SyncGuidIndex::findNotebook(
+    const QString & guid) const
+{
+    return findEntry(guid, m_index.m_notebooks);
+}
+
+const SyncGuidIndex::Entry * SyncGuidIndex::findTag(const QString & guid) const
+{
+    return findEntry(guid, m_index.m_tags);
+}
+
+const SyncGuidIndex::Entry * SyncGuidIndex::findSavedSearch(
+    const QString & guid) const
+{
+    return findEntry(guid, m_index.m_savedSearches);
+}
+
+const SyncGuidIndex::Entry * SyncGuidIndex::findNote(const QString & guid) const
+{
+    return findEntry(guid, m_index.m_notes);
+}
+
+bool SyncGuidIndex::isUpToDate(
+    const qevercloud::Notebook & remoteNotebook) const
+{
+    return isEntryUpToDate(
+        remoteNotebook.guid, remoteNotebook.updateSequenceNum,
+        m_index.m_notebooks);
+}
+
+bool SyncGuidIndex::isUpToDate(const qevercloud::Tag & remoteTag) const
+{
+    return isEntryUpToDate(
+        remoteTag.guid, remoteTag.updateSequenceNum, m_index.m_tags);
+}
+
+bool SyncGuidIndex::isUpToDate(
+    const qevercloud::SavedSearch & remoteSearch) const
+{
+    return isEntryUpToDate(
+        remoteSearch.guid, remoteSearch.updateSequenceNum,
+        m_index.m_savedSearches);
+}
+
+bool SyncGuidIndex::isUpToDate(const qevercloud::Note & remoteNote) const
+{
+    return isEntryUpToDate(
+        remoteNote.guid, remoteNote.updateSequenceNum, m_index.m_notes);
+}
+
+void SyncGuidIndex::fill()
+{
+    QNDEBUG("synchronization:guid_index", "SyncGuidIndex::fill");
+
+    if (m_connectedToLocalStorage) {
+        QNDEBUG(
+            "synchronization:guid_index",
+            "Already connected to the local storage, no need to do anything");
+        return;
+    }
+
+    // NOTE: connecting to the local storage before requesting the index
+    // so that no update would be missed; as signals are delivered in order,
+    // updates coming before the index would be superseded by it
+    connectToLocalStorage();
+
+    m_guidIndexRequestId = QUuid::createUuid();
+
+    QNTRACE(
+        "synchronization:guid_index",
+        "Emitting the request to collect the guid index: request id = "
+            << m_guidIndexRequestId);
+
+    Q_EMIT requestGuidIndex(m_guidIndexRequestId);
+}
+
+void SyncGuidIndex::onGuidIndexComplete(
+    LocalStorageManager::GuidIndex index, QUuid requestId)
+{
+    if (requestId != m_guidIndexRequestId) {
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization:guid_index",
+        "SyncGuidIndex::onGuidIndexComplete: request id = "
+            << requestId << ", notebooks: " << index.m_notebooks.size()
+            << ", tags: " << index.m_tags.size()
+            << ", saved searches: " << index.m_savedSearches.size()
+            << ", notes: " << index.m_notes.size());
+
+    m_index = index;
+    m_guidIndexRequestId = QUuid();
+
+    Q_EMIT filled();
+}
+
+void SyncGuidIndex::onGuidIndexFailed(
+    ErrorString errorDescription, QUuid requestId)
+{
+    if (requestId != m_guidIndexRequestId) {
+        return;
+    }
+
+    QNWARNING(
+        "synchronization:guid_index",
+        "SyncGuidIndex::onGuidIndexFailed: request id = "
+            << requestId << ", error description = " << errorDescription);
+
+    m_index = LocalStorageManager::GuidIndex();
+    m_guidIndexRequestId = QUuid();
+    disconnectFromLocalStorage();
+
+    Q_EMIT failure(errorDescription);
+}
+
+void SyncGuidIndex::onAddNotebookComplete(Notebook notebook, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    processItem(notebook, m_index.m_notebooks);
+}
+
+void SyncGuidIndex::onUpdateNotebookComplete(
+    Notebook notebook, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    processItem(notebook, m_index.m_notebooks);
+}
+
+void SyncGuidIndex::onExpungeNotebookComplete(
+    Notebook notebook, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    removeItem(notebook, m_index.m_notebooks);
+}
+
+void SyncGuidIndex::onAddTagComplete(Tag tag, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    processItem(tag, m_index.m_tags);
+}
+
+void SyncGuidIndex::onUpdateTagComplete(Tag tag, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    processItem(tag, m_index.m_tags);
+}
+
+void SyncGuidIndex::onExpungeTagComplete(
+    Tag tag, QStringList expungedChildTagLocalUids, QUuid requestId)
+{
+    Q_UNUSED(expungedChildTagLocalUids)
+    Q_UNUSED(requestId)
+
+    // NOTE: the entries of expunged child tags are left in the index: an entry
+    // for a non-existing item only costs a redundant find by guid request
+    removeItem(tag, m_index.m_tags);
+}
+
+void SyncGuidIndex::onAddSavedSearchComplete(
+    SavedSearch search, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    processItem(search, m_index.m_savedSearches);
+}
+
+void SyncGuidIndex::onUpdateSavedSearchComplete(
+    SavedSearch search, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    processItem(search, m_index.m_savedSearches);
+}
+
+void SyncGuidIndex::onExpungeSavedSearchComplete(
+    SavedSearch search, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    removeItem(search, m_index.m_savedSearches);
+}
+
+void SyncGuidIndex::onAddNoteComplete(Note note, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    processItem(note, m_index.m_notes);
+}
+
+void SyncGuidIndex::onUpdateNoteComplete(
+    Note note, LocalStorageManager::UpdateNoteOptions options, QUuid requestId)
+{
+    Q_UNUSED(options)
+    Q_UNUSED(requestId)
+    processItem(note, m_index.m_notes);
+}
+
+void SyncGuidIndex::onExpungeNoteComplete(Note note, QUuid requestId)
+{
+    Q_UNUSED(requestId)
+    removeItem(note, m_index.m_notes);
+}
+
+void SyncGuidIndex::connectToLocalStorage()
+{
+    QNDEBUG(
+        "synchronization:guid_index", "SyncGuidIndex::connectToLocalStorage");
+
+    if (m_connectedToLocalStorage) {
+        QNDEBUG(
+            "synchronization:guid_index",
+            "Already connected to the local storage");
+        return;
+    }
+
+    // Connect local signals to local storage manager async's slots
+    QObject::connect(
+        this, &SyncGuidIndex::requestGuidIndex, &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::onGuidIndexRequest,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    // Connect local storage manager async's signals to local slots
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::guidIndexComplete, this,
+        &SyncGuidIndex::onGuidIndexComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::guidIndexFailed,
+        this, &SyncGuidIndex::onGuidIndexFailed,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::addNotebookComplete, this,
+        &SyncGuidIndex::onAddNotebookComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::updateNotebookComplete, this,
+        &SyncGuidIndex::onUpdateNotebookComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeNotebookComplete, this,
+        &SyncGuidIndex::onExpungeNotebookComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::addTagComplete,
+        this, &SyncGuidIndex::onAddTagComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::updateTagComplete, this,
+        &SyncGuidIndex::onUpdateTagComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeTagComplete, this,
+        &SyncGuidIndex::onExpungeTagComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::addSavedSearchComplete, this,
+        &SyncGuidIndex::onAddSavedSearchComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::updateSavedSearchComplete, this,
+        &SyncGuidIndex::onUpdateSavedSearchComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeSavedSearchComplete, this,
+        &SyncGuidIndex::onExpungeSavedSearchComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync, &LocalStorageManagerAsync::addNoteComplete,
+        this, &SyncGuidIndex::onAddNoteComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::updateNoteComplete, this,
+        &SyncGuidIndex::onUpdateNoteComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &m_localStorageManagerAsync,
+        &LocalStorageManagerAsync::expungeNoteComplete, this,
+        &SyncGuidIndex::onExpungeNoteComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    m_connectedToLocalStorage = true;
+}
+
+void SyncGuidIndex::disconnectFromLocalStorage()
+{
+    QNDEBUG(
+        "synchronization:guid_index",
+        "SyncGuidIndex::disconnectFromLocalStorage");
+
+    if (!m_connectedToLocalStorage) {
+        QNDEBUG(
+            "synchronization:guid_index",
+            "Not connected to local storage at the moment");
+        return;
+    }
+
+    // Disconnect all the connections established in connectToLocalStorage
+    QObject::disconnect(this, nullptr, &m_localStorageManagerAsync, nullptr);
+    QObject::disconnect(&m_localStorageManagerAsync, nullptr, this, nullptr);
+
+    m_connectedToLocalStorage = false;
+}
+
+void SyncGuidIndex::processItem(
+    const INoteStoreDataElement & item, QHash<QString, Entry> & entries)
+{
+    if (!item.hasGuid()) {
+        return;
+    }
+
+    auto & entry = entries[item.guid()];
+    entry.m_localUid = item.localUid();
+
+    entry.m_updateSequenceNumber =
+        (item.hasUpdateSequenceNumber() ? item.updateSequenceNumber() : -1);
+
+    entry.m_isDirty = item.isDirty();
+}
+
+void SyncGuidIndex::removeItem(
+    const INoteStoreDataElement & item, QHash<QString, Entry> & entries)
+{
+    if (item.hasGuid()) {
+        Q_UNUSED(entries.remove(item.guid()))
+        return;
+    }
+
+    // The expunged item might have been passed without guid, look it up
+    // by local uid then
+    const QString localUid = item.localUid();
+    for (auto it = entries.begin(), end = entries.end(); it != end; ++it) {
+        if (it.value().m_localUid == localUid) {
+            Q_UNUSED(entries.erase(it))
+            return;
+        }
+    }
+}
+
+const SyncGuidIndex::Entry * SyncGuidIndex::findEntry(
+    const QString & guid, const QHash<QString, Entry> & entries) const
+{
+    auto it = entries.constFind(guid);
+    if (it == entries.constEnd()) {
+        return nullptr;
+    }
+
+    return &(it.value());
+}
+
+bool SyncGuidIndex::isEntryUpToDate(
+    const qevercloud::Optional<QString> & guid,
+    const qevercloud::Optional<qint32> & updateSequenceNum,
+    const QHash<QString, Entry> & entries) const
+{
+    if (!isFilled() || !guid.isSet() || !updateSequenceNum.isSet()) {
+        return false;
+    }
+
+    const auto * pEntry = findEntry(guid.ref(), entries);
+    if (!pEntry || pEntry->m_isDirty) {
+        return false;
+    }
+
+    return (pEntry->m_updateSequenceNumber >= updateSequenceNum.ref());
+}
+
+} // namespace quentier
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_SYNCHRONIZATION_SYNC_GUID_INDEX_H
+#define LIB_QUENTIER_SYNCHRONIZATION_SYNC_GUID_INDEX_H
+
+#include <quentier/local_storage/LocalStorageManagerAsync.h>
+
+#include <QHash>
+#include <QObject>
+#include <QUuid>
+
+namespace quentier {
+
+/**
+ * @brief The SyncGuidIndex class keeps the in-memory mapping from guids
+ * of notebooks, tags, saved searches and notes to their local uids, update
+ * sequence numbers and dirty flags; it is filled with a single local storage
+ * request and then kept up to date by listening to local storage's signals
+ * so that the sync can learn whether an item exists locally without issuing
+ * a find by guid request for each downloaded item
+ */
+class Q_DECL_HIDDEN SyncGuidIndex final : public QObject
+{
+    Q_OBJECT
+public:
+    using Entry = LocalStorageManager::GuidIndexEntry;
+
+    SyncGuidIndex(
+        LocalStorageManagerAsync & localStorageManagerAsync,
+        QObject * parent = nullptr);
+
+    void clear();
+
+    /**
+     * @return  True if the index is already filled with up-to-moment data,
+     *          false otherwise
+     */
+    bool isFilled() const;
+
+    /**
+     * Lookup methods return the pointer to the index entry corresponding to
+     * the passed in guid or null pointer if there's no item with such guid
+     * in the local storage; the result is only meaningful if the index is
+     * filled
+     */
+    const Entry * findNotebook(const QString & guid) const;
+    const Entry * findTag(const QString & guid) const;
+    const Entry * findSavedSearch(const QString & guid) const;
+    const Entry * findNote(const QString & guid) const;
+
+    /**
+     * Check whether the local counterpart of the remote item is up to date
+     * i.e. it exists within the local storage, is not dirty and its update
+     * sequence number is not smaller than that of the remote item so there is
+     * nothing to update it with; always false if the index is not filled
+     */
+    bool isUpToDate(const qevercloud::Notebook & remoteNotebook) const;
+    bool isUpToDate(const qevercloud::Tag & remoteTag) const;
+    bool isUpToDate(const qevercloud::SavedSearch & remoteSearch) const;
+    bool isUpToDate(const qevercloud::Note & remoteNote) const;
+
+    /**
+     * Items of other kinds are not covered by the index
+     */
+    template <class T>
+    bool isUpToDate(const T & remoteItem) const
+    {
+        Q_UNUSED(remoteItem)
+        return false;
+    }
+
+Q_SIGNALS:
+    void filled();
+    void failure(ErrorString errorDescription);
+
+    // private signals
+    void requestGuidIndex(QUuid requestId);
+
+public Q_SLOTS:
+    /**
+     * Start collecting the guid index; does nothing if the index is already
+     * collected or is being collected at the moment
+     */
+    void fill();
+
+private Q_SLOTS:
+    void onGuidIndexComplete(
+        LocalStorageManager::GuidIndex index, QUuid requestId);
+
+    void onGuidIndexFailed(ErrorString errorDescription, QUuid requestId);
+
+    void onAddNotebookComplete(Notebook notebook, QUuid requestId);
+    void onUpdateNotebookComplete(Notebook notebook, QUuid requestId);
+    void onExpungeNotebookComplete(Notebook notebook, QUuid requestId);
+
+    void onAddTagComplete(Tag tag, QUuid requestId);
+    void onUpdateTagComplete(Tag tag, QUuid requestId);
+
+    void onExpungeTagComplete(
+        Tag tag, QStringList expungedChildTagLocalUids, QUuid requestId);
+
+    void onAddSavedSearchComplete(SavedSearch search, QUuid requestId);
+    void onUpdateSavedSearchComplete(SavedSearch search, QUuid requestId);
+    void onExpungeSavedSearchComplete(SavedSearch search, QUuid requestId);
+
+    void onAddNoteComplete(Note note, QUuid requestId);
+
+    void onUpdateNoteComplete(
+        Note note, LocalStorageManager::UpdateNoteOptions options,
+        QUuid requestId);
+
+    void onExpungeNoteComplete(Note note, QUuid requestId);
+
+private:
+    void connectToLocalStorage();
+    void disconnectFromLocalStorage();
+
+    void processItem(
+        const INoteStoreDataElement & item, QHash<QString, Entry> & entries);
+
+    void removeItem(
+        const INoteStoreDataElement & item, QHash<QString, Entry> & entries);
+
+    const Entry * findEntry(
+        const QString & guid, const QHash<QString, Entry> & entries) const;
+
+    bool isEntryUpToDate(
+        const qevercloud::Optional<QString> & guid,
+        const qevercloud::Optional<qint32> & updateSequenceNum,
+        const QHash<QString, Entry> & entries) const;
+
+private:
+    LocalStorageManagerAsync & m_localStorageManagerAsync;
+    bool m_connectedToLocalStorage = false;
+
+    LocalStorageManager::GuidIndex m_index;
+
+    QUuid m_guidIndexRequestId;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_SYNCHRONIZATION_SYNC_GUID_INDEX_H
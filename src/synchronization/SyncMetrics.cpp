@@ -0,0 +1,362 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyncMetrics.h"
+
+#include <qt5qevercloud/QEverCloud.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+namespace quentier {
+
+namespace {
+
+const qint64 gLatencyHistogramBucketBoundsMsec[] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};
+
+const int gLatencyHistogramBucketCount =
+    static_cast<int>(sizeof(gLatencyHistogramBucketBoundsMsec) /
+                     sizeof(gLatencyHistogramBucketBoundsMsec[0])) +
+    1;
+
+QJsonObject callStatsToJson(
+    const QHash<QString, ISyncMetrics::CallStats> & stats)
+{
+    QJsonObject object;
+    for (auto it = stats.constBegin(), end = stats.constEnd(); it != end; ++it)
+    {
+        const auto & callStats = it.value();
+
+        QJsonArray histogram;
+        for (const auto count: qAsConst(callStats.m_latencyHistogram)) {
+            histogram.append(static_cast<double>(count));
+        }
+
+        QJsonObject callStatsObject;
+        callStatsObject[QStringLiteral("count")] =
+            static_cast<double>(callStats.m_count);
+
+        callStatsObject[QStringLiteral("failures")] =
+            static_cast<double>(callStats.m_failures);
+
+        callStatsObject[QStringLiteral("rateLimitBreaches")] =
+            static_cast<double>(callStats.m_rateLimitBreaches);
+
+        callStatsObject[QStringLiteral("totalMsec")] =
+            static_cast<double>(callStats.m_totalMsec);
+
+        callStatsObject[QStringLiteral("maxMsec")] =
+            static_cast<double>(callStats.m_maxMsec);
+
+        callStatsObject[QStringLiteral("latencyHistogram")] = histogram;
+        object[it.key()] = callStatsObject;
+    }
+
+    return object;
+}
+
+void printCallStats(
+    QTextStream & strm,
+    const QHash<QString, ISyncMetrics::CallStats> & stats)
+{
+    for (auto it = stats.constBegin(), end = stats.constEnd(); it != end; ++it)
+    {
+        const auto & callStats = it.value();
+
+        strm << "    " << it.key() << ": count = " << callStats.m_count
+             << ", failures = " << callStats.m_failures
+             << ", rate limit breaches = " << callStats.m_rateLimitBreaches
+             << ", total msec = " << callStats.m_totalMsec
+             << ", max msec = " << callStats.m_maxMsec << "\n";
+    }
+}
+
+} // namespace
+
+QVector<qint64> SyncMetrics::latencyHistogramBucketBoundsMsec() const
+{
+    QVector<qint64> bounds;
+    bounds.reserve(gLatencyHistogramBucketCount - 1);
+
+    for (const auto bound: gLatencyHistogramBucketBoundsMsec) {
+        bounds << bound;
+    }
+
+    return bounds;
+}
+
+QHash<QString, qint64> SyncMetrics::phaseDurationsMsec() const
+{
+    return m_phaseDurationsMsec;
+}
+
+QHash<QString, ISyncMetrics::CallStats> SyncMetrics::noteStoreCallStats() const
+{
+    return m_noteStoreCallStats;
+}
+
+QHash<QString, ISyncMetrics::CallStats> SyncMetrics::localStorageRequestStats()
+    const
+{
+    return m_localStorageRequestStats;
+}
+
+QHash<QString, quint64> SyncMetrics::peakQueueDepths() const
+{
+    return m_peakQueueDepths;
+}
+
+QByteArray SyncMetrics::toJson() const
+{
+    QJsonArray bounds;
+    for (const auto bound: gLatencyHistogramBucketBoundsMsec) {
+        bounds.append(static_cast<double>(bound));
+    }
+
+    QJsonObject phases;
+    for (auto it = m_phaseDurationsMsec.constBegin(),
+              end = m_phaseDurationsMsec.constEnd();
+         it != end; ++it)
+    {
+        phases[it.key()] = static_cast<double>(it.value());
+    }
+
+    QJsonObject queueDepths;
+    for (auto it = m_peakQueueDepths.constBegin(),
+              end = m_peakQueueDepths.constEnd();
+         it != end; ++it)
+    {
+        queueDepths[it.key()] = static_cast<double>(it.value());
+    }
+
+    QJsonObject object;
+    object[QStringLiteral("latencyHistogramBucketBoundsMsec")] = bounds;
+    object[QStringLiteral("phaseDurationsMsec")] = phases;
+
+    object[QStringLiteral("noteStoreCalls")] =
+        callStatsToJson(m_noteStoreCallStats);
+
+    object[QStringLiteral("localStorageRequests")] =
+        callStatsToJson(m_localStorageRequestStats);
+
+    object[QStringLiteral("peakQueueDepths")] = queueDepths;
+
+    object[QStringLiteral("downloadedBytes")] =
+        static_cast<double>(m_downloadedBytes);
+
+    object[QStringLiteral("uploadedBytes")] =
+        static_cast<double>(m_uploadedBytes);
+
+    return QJsonDocument(object).toJson(QJsonDocument::Indented);
+}
+
+QTextStream & SyncMetrics::print(QTextStream & strm) const
+{
+    strm << "SyncMetrics: {\n  phase durations (msec):\n";
+    for (auto it = m_phaseDurationsMsec.constBegin(),
+              end = m_phaseDurationsMsec.constEnd();
+         it != end; ++it)
+    {
+        strm << "    " << it.key() << ": " << it.value() << "\n";
+    }
+
+    strm << "  note store calls:\n";
+    printCallStats(strm, m_noteStoreCallStats);
+
+    strm << "  local storage requests:\n";
+    printCallStats(strm, m_localStorageRequestStats);
+
+    strm << "  peak queue depths:\n";
+    for (auto it = m_peakQueueDepths.constBegin(),
+              end = m_peakQueueDepths.constEnd();
+         it != end; ++it)
+    {
+        strm << "    " << it.key() << ": " << it.value() << "\n";
+    }
+
+    strm << "  downloaded bytes = " << m_downloadedBytes << "\n"
+         << "  uploaded bytes = " << m_uploadedBytes << "\n"
+         << "}\n";
+
+    return strm;
+}
+
+void SyncMetrics::clear()
+{
+    m_phaseDurationsMsec.clear();
+    m_runningPhaseTimers.clear();
+    m_runningPhaseInstanceCounts.clear();
+    m_noteStoreCallStats.clear();
+    m_localStorageRequestStats.clear();
+    m_pendingLocalStorageRequests.clear();
+    m_peakQueueDepths.clear();
+    m_downloadedBytes = 0;
+    m_uploadedBytes = 0;
+}
+
+void SyncMetrics::startPhase(const QString & phaseName)
+{
+    auto & timer = m_runningPhaseTimers[phaseName];
+    if (!timer.isValid()) {
+        timer.start();
+    }
+}
+
+void SyncMetrics::finishPhase(const QString & phaseName)
+{
+    auto it = m_runningPhaseTimers.find(phaseName);
+    if (it == m_runningPhaseTimers.end()) {
+        return;
+    }
+
+    m_phaseDurationsMsec[phaseName] += it.value().elapsed();
+    m_runningPhaseTimers.erase(it);
+}
+
+void SyncMetrics::finishAllPhases()
+{
+    for (auto it = m_runningPhaseTimers.constBegin(),
+              end = m_runningPhaseTimers.constEnd();
+         it != end; ++it)
+    {
+        m_phaseDurationsMsec[it.key()] += it.value().elapsed();
+    }
+
+    m_runningPhaseTimers.clear();
+    m_runningPhaseInstanceCounts.clear();
+}
+
+bool SyncMetrics::isPhaseRunning(const QString & phaseName) const
+{
+    return m_runningPhaseTimers.contains(phaseName);
+}
+
+void SyncMetrics::startPhaseInstance(const QString & phaseName)
+{
+    if (m_runningPhaseInstanceCounts[phaseName]++ == 0) {
+        startPhase(phaseName);
+    }
+}
+
+void SyncMetrics::finishPhaseInstance(const QString & phaseName)
+{
+    auto it = m_runningPhaseInstanceCounts.find(phaseName);
+    if (it == m_runningPhaseInstanceCounts.end()) {
+        return;
+    }
+
+    if (--it.value() > 0) {
+        return;
+    }
+
+    m_runningPhaseInstanceCounts.erase(it);
+    finishPhase(phaseName);
+}
+
+void SyncMetrics::addNoteStoreCall(
+    const QString & methodName, const qint64 msec, const qint32 errorCode)
+{
+    bool rateLimitBreach =
+        (errorCode ==
+         static_cast<qint32>(qevercloud::EDAMErrorCode::RATE_LIMIT_REACHED));
+
+    addCall(
+        m_noteStoreCallStats[methodName], msec, (errorCode == 0),
+        rateLimitBreach);
+}
+
+void SyncMetrics::startLocalStorageRequest(
+    const QUuid & requestId, const QString & requestName)
+{
+    auto & request = m_pendingLocalStorageRequests[requestId];
+    request.m_name = requestName;
+    request.m_timer.start();
+
+    setQueueDepth(
+        QStringLiteral("localStorageRequests"),
+        static_cast<quint64>(m_pendingLocalStorageRequests.size()));
+}
+
+void SyncMetrics::finishLocalStorageRequest(
+    const QUuid & requestId, const bool success)
+{
+    auto it = m_pendingLocalStorageRequests.find(requestId);
+    if (it == m_pendingLocalStorageRequests.end()) {
+        return;
+    }
+
+    addCall(
+        m_localStorageRequestStats[it.value().m_name],
+        it.value().m_timer.elapsed(), success,
+        /* rate limit breach = */ false);
+
+    m_pendingLocalStorageRequests.erase(it);
+}
+
+void SyncMetrics::setQueueDepth(const QString & queueName, const quint64 depth)
+{
+    auto & peakDepth = m_peakQueueDepths[queueName];
+    peakDepth = std::max(peakDepth, depth);
+}
+
+void SyncMetrics::addDownloadedBytes(const quint64 bytes)
+{
+    m_downloadedBytes += bytes;
+}
+
+void SyncMetrics::addUploadedBytes(const quint64 bytes)
+{
+    m_uploadedBytes += bytes;
+}
+
+void SyncMetrics::addCall(
+    CallStats & stats, const qint64 msec, const bool success,
+    const bool rateLimitBreach)
+{
+    ++stats.m_count;
+
+    if (!success) {
+        ++stats.m_failures;
+    }
+
+    if (rateLimitBreach) {
+        ++stats.m_rateLimitBreaches;
+    }
+
+    stats.m_totalMsec += msec;
+    stats.m_maxMsec = std::max(stats.m_maxMsec, msec);
+
+    if (stats.m_latencyHistogram.isEmpty()) {
+        stats.m_latencyHistogram.resize(gLatencyHistogramBucketCount);
+    }
+
+    const auto * boundsEnd =
+        gLatencyHistogramBucketBoundsMsec + gLatencyHistogramBucketCount - 1;
+
+    const auto * bound = std::upper_bound(
+        gLatencyHistogramBucketBoundsMsec, boundsEnd, msec);
+
+    ++stats.m_latencyHistogram[static_cast<int>(
+        bound - gLatencyHistogramBucketBoundsMsec)];
+}
+
+} // namespace quentier
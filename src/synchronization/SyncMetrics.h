@@ -0,0 +1,116 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_SYNCHRONIZATION_SYNC_METRICS_H
+#define LIB_QUENTIER_SYNCHRONIZATION_SYNC_METRICS_H
+
+#include <quentier/synchronization/ISyncMetrics.h>
+
+#include <QElapsedTimer>
+#include <QUuid>
+
+namespace quentier {
+
+/**
+ * @brief The SyncMetrics class collects the timings and counters of a single
+ * synchronization, see ISyncMetrics for the description of the collected data
+ */
+class Q_DECL_HIDDEN SyncMetrics final : public ISyncMetrics
+{
+public:
+    // ISyncMetrics
+    QVector<qint64> latencyHistogramBucketBoundsMsec() const override;
+    QHash<QString, qint64> phaseDurationsMsec() const override;
+    QHash<QString, CallStats> noteStoreCallStats() const override;
+    QHash<QString, CallStats> localStorageRequestStats() const override;
+    QHash<QString, quint64> peakQueueDepths() const override;
+
+    quint64 downloadedBytes() const noexcept override
+    {
+        return m_downloadedBytes;
+    }
+
+    quint64 uploadedBytes() const noexcept override
+    {
+        return m_uploadedBytes;
+    }
+
+    QByteArray toJson() const override;
+
+    QTextStream & print(QTextStream & strm) const override;
+
+    void clear();
+
+    // Phases
+    void startPhase(const QString & phaseName);
+    void finishPhase(const QString & phaseName);
+    void finishAllPhases();
+    bool isPhaseRunning(const QString & phaseName) const;
+
+    // Phases which can have several overlapping instances, like waits for
+    // several postpone timers; such a phase runs while any instance runs
+    void startPhaseInstance(const QString & phaseName);
+    void finishPhaseInstance(const QString & phaseName);
+
+    // INoteStore calls
+    void addNoteStoreCall(
+        const QString & methodName, const qint64 msec, const qint32 errorCode);
+
+    // Local storage requests
+    void startLocalStorageRequest(
+        const QUuid & requestId, const QString & requestName);
+
+    void finishLocalStorageRequest(
+        const QUuid & requestId, const bool success = true);
+
+    // Queues
+    void setQueueDepth(const QString & queueName, const quint64 depth);
+
+    // Transferred data
+    void addDownloadedBytes(const quint64 bytes);
+    void addUploadedBytes(const quint64 bytes);
+
+private:
+    static void addCall(
+        CallStats & stats, const qint64 msec, const bool success,
+        const bool rateLimitBreach);
+
+private:
+    struct PendingRequest
+    {
+        QString m_name;
+        QElapsedTimer m_timer;
+    };
+
+    QHash<QString, qint64> m_phaseDurationsMsec;
+    QHash<QString, QElapsedTimer> m_runningPhaseTimers;
+    QHash<QString, int> m_runningPhaseInstanceCounts;
+
+    QHash<QString, CallStats> m_noteStoreCallStats;
+    QHash<QString, CallStats> m_localStorageRequestStats;
+    QHash<QUuid, PendingRequest> m_pendingLocalStorageRequests;
+
+    QHash<QString, quint64> m_peakQueueDepths;
+
+    quint64 m_downloadedBytes = 0;
+    quint64 m_uploadedBytes = 0;
+};
+
+} // namespace quentier
+
+#endif // LIB_QUENTIER_SYNCHRONIZATION_SYNC_METRICS_H
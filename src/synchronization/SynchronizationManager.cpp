@@ -76,6 +76,11 @@ SynchronizationManager::SynchronizationManager(
         &SynchronizationManagerPrivate::linkedNotebooksSyncChunksDownloaded,
         this, &SynchronizationManager::linkedNotebooksSyncChunksDownloaded);
 
+    QObject::connect(
+        d_ptr,
+        &SynchronizationManagerPrivate::linkedNotebookSyncStatesCheckProgress,
+        this, &SynchronizationManager::linkedNotebookSyncStatesCheckProgress);
+
     QObject::connect(
         d_ptr,
         &SynchronizationManagerPrivate::
@@ -153,6 +158,14 @@ SynchronizationManager::SynchronizationManager(
     QObject::connect(
         d_ptr, &SynchronizationManagerPrivate::notifyRemoteToLocalSyncDone,
         this, &SynchronizationManager::remoteToLocalSyncDone);
+
+    QObject::connect(
+        d_ptr, &SynchronizationManagerPrivate::updatesCheckFinished, this,
+        &SynchronizationManager::updatesCheckFinished);
+
+    QObject::connect(
+        d_ptr, &SynchronizationManagerPrivate::syncMetricsReady, this,
+        &SynchronizationManager::syncMetricsReady);
 }
 
 SynchronizationManager::~SynchronizationManager() {}
@@ -232,4 +245,29 @@ void SynchronizationManager::setInkNoteImagesStoragePath(QString path)
     Q_EMIT setInkNoteImagesStoragePathDone(path);
 }
 
+void SynchronizationManager::checkForUpdates()
+{
+    Q_D(SynchronizationManager);
+    d->checkForUpdates();
+}
+
+void SynchronizationManager::startAdaptivePolling(
+    int minIntervalMsec, int maxIntervalMsec)
+{
+    Q_D(SynchronizationManager);
+    d->startAdaptivePolling(minIntervalMsec, maxIntervalMsec);
+}
+
+void SynchronizationManager::stopAdaptivePolling()
+{
+    Q_D(SynchronizationManager);
+    d->stopAdaptivePolling();
+}
+
+void SynchronizationManager::notifyLocalChanges()
+{
+    Q_D(SynchronizationManager);
+    d->notifyLocalChanges();
+}
+
 } // namespace quentier
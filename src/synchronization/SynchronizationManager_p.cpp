@@ -18,6 +18,7 @@
 
 #include "SynchronizationManager_p.h"
 
+#include "MeteredNoteStore.h"
 #include "NoteStore.h"
 #include "SyncStateStorage.h"
 #include "SynchronizationShared.h"
@@ -50,6 +51,7 @@
 #include <QDir>
 #include <QTimeZone>
 
+#include <algorithm>
 #include <limits>
 
 namespace quentier {
@@ -72,6 +74,8 @@ public:
     virtual INoteStore * noteStoreForLinkedNotebook(
         const LinkedNotebook & linkedNotebook) override;
 
+    virtual SyncMetrics & syncMetrics() override;
+
 private:
     LocalStorageManagerAsync & m_localStorageManagerAsync;
     SynchronizationManagerPrivate & m_syncManager;
@@ -93,6 +97,8 @@ public:
     virtual INoteStore * noteStoreForLinkedNotebook(
         const LinkedNotebook & linkedNotebook) override;
 
+    virtual SyncMetrics & syncMetrics() override;
+
 private:
     LocalStorageManagerAsync & m_localStorageManagerAsync;
     SynchronizationManagerPrivate & m_syncManager;
@@ -109,6 +115,7 @@ SynchronizationManagerPrivate::SynchronizationManagerPrivate(
     QObject(parent),
     m_host(std::move(host)), m_pSyncStateStorage(std::move(pSyncStateStorage)),
     m_pNoteStore(std::move(pNoteStore)), m_pUserStore(std::move(pUserStore)),
+    m_pSyncMetrics(std::make_shared<SyncMetrics>()),
     m_pRemoteToLocalSyncManagerController(
         new RemoteToLocalSynchronizationManagerController(
             localStorageManagerAsync, *this)),
@@ -129,6 +136,9 @@ SynchronizationManagerPrivate::SynchronizationManagerPrivate(
         m_pNoteStore->setParent(this);
     }
 
+    m_pMeteredNoteStore =
+        std::make_shared<MeteredNoteStore>(m_pNoteStore, m_pSyncMetrics);
+
     if (!m_pUserStore) {
         m_pUserStore = newUserStore(
             QStringLiteral("https://") + m_host + QStringLiteral("/edam/user"));
@@ -218,6 +228,12 @@ void SynchronizationManagerPrivate::synchronize()
     }
 
     clear();
+    m_localChangesPendingSync = false;
+
+    m_pSyncMetrics->clear();
+    m_pSyncMetrics->startPhase(QStringLiteral("total"));
+    m_pSyncMetrics->startPhase(QStringLiteral("authentication"));
+
     authenticateImpl(AuthContext::SyncLaunch);
 }
 
@@ -284,7 +300,7 @@ void SynchronizationManagerPrivate::stop()
 
     tryUpdateLastSyncStatus();
 
-    m_pNoteStore->stop();
+    m_pMeteredNoteStore->stop();
 
     for (auto it = m_noteStoresByLinkedNotebookGuids.begin(),
               end = m_noteStoresByLinkedNotebookGuids.end();
@@ -355,6 +371,106 @@ void SynchronizationManagerPrivate::setInkNoteImagesStoragePath(
     m_pRemoteToLocalSyncManager->setInkNoteImagesStoragePath(path);
 }
 
+void SynchronizationManagerPrivate::checkForUpdates()
+{
+    QNDEBUG(
+        "synchronization", "SynchronizationManagerPrivate::checkForUpdates");
+
+    if (active()) {
+        ErrorString error(
+            QT_TR_NOOP("Can't check for updates: the synchronization is "
+                       "in progress"));
+        QNDEBUG("synchronization", error);
+        finishUpdatesCheck(/* success = */ false, false, error);
+        return;
+    }
+
+    bool writingAuthToken = isWritingAuthToken(m_OAuthResult.m_userId);
+    bool writingShardId = isWritingShardId(m_OAuthResult.m_userId);
+
+    if (m_authenticationInProgress || writingAuthToken || writingShardId) {
+        ErrorString error(
+            QT_TR_NOOP("Authentication is not finished yet, please wait"));
+        QNDEBUG("synchronization", error);
+        finishUpdatesCheck(/* success = */ false, false, error);
+        return;
+    }
+
+    if (m_OAuthResult.m_userId < 0) {
+        ErrorString error(
+            QT_TR_NOOP("Can't check for updates: no account is set to "
+                       "the synchronization manager"));
+        QNDEBUG("synchronization", error);
+        finishUpdatesCheck(/* success = */ false, false, error);
+        return;
+    }
+
+    // Invalidate the previous check if it is still pending
+    m_listLinkedNotebooksForUpdatesCheckRequestId = QUuid();
+    clearLinkedNotebooksUpdatesCheckState();
+
+    if (!validAuthentication()) {
+        authenticateImpl(AuthContext::UpdatesCheck);
+        return;
+    }
+
+    checkUserAccountForUpdates();
+}
+
+void SynchronizationManagerPrivate::startAdaptivePolling(
+    int minIntervalMsec, int maxIntervalMsec)
+{
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::startAdaptivePolling: min interval = "
+            << minIntervalMsec << ", max interval = " << maxIntervalMsec);
+
+    if (Q_UNLIKELY(minIntervalMsec <= 0)) {
+        QNWARNING(
+            "synchronization",
+            "Can't start adaptive polling: non-positive "
+                << "minimal polling interval " << minIntervalMsec);
+        return;
+    }
+
+    m_minPollingIntervalMsec = minIntervalMsec;
+    m_maxPollingIntervalMsec = std::max(minIntervalMsec, maxIntervalMsec);
+    m_pollingIntervalMsec = m_minPollingIntervalMsec;
+    restartPollingTimer();
+}
+
+void SynchronizationManagerPrivate::stopAdaptivePolling()
+{
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::stopAdaptivePolling");
+
+    if (m_pollingTimerId > 0) {
+        killTimer(m_pollingTimerId);
+    }
+
+    m_pollingTimerId = -1;
+    m_pollingIntervalMsec = 0;
+    m_pollingUpdatesCheckInProgress = false;
+}
+
+void SynchronizationManagerPrivate::notifyLocalChanges()
+{
+    QNDEBUG(
+        "synchronization", "SynchronizationManagerPrivate::notifyLocalChanges");
+
+    m_localChangesPendingSync = true;
+
+    if (m_pollingIntervalMsec <= 0) {
+        return;
+    }
+
+    if (m_pollingIntervalMsec != m_minPollingIntervalMsec) {
+        m_pollingIntervalMsec = m_minPollingIntervalMsec;
+        restartPollingTimer();
+    }
+}
+
 void SynchronizationManagerPrivate::onOAuthResult(
     bool success, qevercloud::UserID userId, QString authToken,
     qevercloud::Timestamp authTokenExpirationTime, QString shardId,
@@ -378,6 +494,10 @@ void SynchronizationManagerPrivate::onOAuthResult(
             Q_EMIT authenticationFinished(
                 /* success = */ false, errorDescription, Account());
         }
+        else if (m_authContext == AuthContext::UpdatesCheck) {
+            m_authContext = AuthContext::Blank;
+            finishUpdatesCheck(/* success = */ false, false, errorDescription);
+        }
         else {
             Q_EMIT notifyError(errorDescription);
         }
@@ -859,6 +979,8 @@ void SynchronizationManagerPrivate::onRemoteToLocalSyncFinished(
             << "lastUpdateCount = " << lastUpdateCount << ", lastSyncTime = "
             << printableDateTimeFromTimestamp(lastSyncTime));
 
+    m_pSyncMetrics->finishPhase(QStringLiteral("download"));
+
     bool somethingDownloaded = (m_lastUpdateCount != lastUpdateCount) ||
         (m_lastUpdateCount != m_previousUpdateCount) ||
         (m_cachedLinkedNotebookLastUpdateCountByGuid !=
@@ -912,6 +1034,7 @@ void SynchronizationManagerPrivate::onRemoteToLocalSyncFailure(
         "SynchronizationManagerPrivate::onRemoteToLocalSyncFailure: "
             << errorDescription);
 
+    finishSyncMetrics();
     Q_EMIT notifyError(errorDescription);
     stop();
 }
@@ -934,6 +1057,19 @@ void SynchronizationManagerPrivate::
     updatePersistentSyncSettings();
 }
 
+void SynchronizationManagerPrivate::onRemoteToLocalSyncProgress()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if ((now - m_lastSyncProgressCheckpointTimestamp) <
+        m_syncProgressCheckpointIntervalMsec)
+    {
+        return;
+    }
+
+    m_lastSyncProgressCheckpointTimestamp = now;
+    checkpointSyncProgress();
+}
+
 void SynchronizationManagerPrivate::onShouldRepeatIncrementalSync()
 {
     QNDEBUG(
@@ -964,6 +1100,7 @@ void SynchronizationManagerPrivate::
      */
     m_shouldRepeatIncrementalSyncAfterSendingChanges = false;
 
+    m_pSyncMetrics->finishPhase(QStringLiteral("send"));
     launchIncrementalSync();
 }
 
@@ -978,6 +1115,8 @@ void SynchronizationManagerPrivate::onLocalChangesSent(
             << ", last update count per linked notebook guid: "
             << lastUpdateCountByLinkedNotebookGuid);
 
+    m_pSyncMetrics->finishPhase(QStringLiteral("send"));
+
     bool somethingSent = (m_lastUpdateCount != lastUpdateCount) ||
         (m_cachedLinkedNotebookLastUpdateCountByGuid !=
          lastUpdateCountByLinkedNotebookGuid);
@@ -1004,6 +1143,8 @@ void SynchronizationManagerPrivate::onLocalChangesSent(
     bool somethingDownloaded = m_somethingDownloaded;
     m_somethingDownloaded = false;
 
+    finishSyncMetrics();
+
     Q_EMIT notifyFinish(
         m_pRemoteToLocalSyncManager->account(), somethingDownloaded,
         somethingSent);
@@ -1030,6 +1171,7 @@ void SynchronizationManagerPrivate::onSendLocalChangesFailure(
         "SynchronizationManagerPrivate::onSendLocalChangesFailure: "
             << errorDescription);
 
+    finishSyncMetrics();
     stop();
     Q_EMIT notifyError(errorDescription);
 }
@@ -1058,6 +1200,49 @@ void SynchronizationManagerPrivate::onRateLimitExceeded(qint32 secondsToWait)
     Q_EMIT rateLimitExceeded(secondsToWait);
 }
 
+void SynchronizationManagerPrivate::onListAllLinkedNotebooksComplete(
+    size_t limit, size_t offset,
+    LocalStorageManager::ListLinkedNotebooksOrder order,
+    LocalStorageManager::OrderDirection orderDirection,
+    QList<LinkedNotebook> foundLinkedNotebooks, QUuid requestId)
+{
+    if (requestId != m_listLinkedNotebooksForUpdatesCheckRequestId) {
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::onListAllLinkedNotebooksComplete: "
+            << "limit = " << limit << ", offset = " << offset
+            << ", order = " << order << ", order direction = " << orderDirection
+            << ", request id = " << requestId);
+
+    m_listLinkedNotebooksForUpdatesCheckRequestId = QUuid();
+    checkLinkedNotebooksForUpdates(foundLinkedNotebooks);
+}
+
+void SynchronizationManagerPrivate::onListAllLinkedNotebooksFailed(
+    size_t limit, size_t offset,
+    LocalStorageManager::ListLinkedNotebooksOrder order,
+    LocalStorageManager::OrderDirection orderDirection,
+    ErrorString errorDescription, QUuid requestId)
+{
+    if (requestId != m_listLinkedNotebooksForUpdatesCheckRequestId) {
+        return;
+    }
+
+    QNWARNING(
+        "synchronization",
+        "SynchronizationManagerPrivate::onListAllLinkedNotebooksFailed: "
+            << "limit = " << limit << ", offset = " << offset
+            << ", order = " << order << ", order direction = " << orderDirection
+            << ", error description = " << errorDescription
+            << ", request id = " << requestId);
+
+    m_listLinkedNotebooksForUpdatesCheckRequestId = QUuid();
+    finishUpdatesCheck(/* success = */ false, false, errorDescription);
+}
+
 void SynchronizationManagerPrivate::createConnections(
     IAuthenticationManager & authenticationManager)
 {
@@ -1186,6 +1371,14 @@ void SynchronizationManagerPrivate::createConnections(
         &SynchronizationManagerPrivate::linkedNotebooksSyncChunksDownloaded,
         Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
 
+    QObject::connect(
+        m_pRemoteToLocalSyncManager,
+        &RemoteToLocalSynchronizationManager::
+            linkedNotebookSyncStatesCheckProgress,
+        this,
+        &SynchronizationManagerPrivate::linkedNotebookSyncStatesCheckProgress,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
     QObject::connect(
         m_pRemoteToLocalSyncManager,
         &RemoteToLocalSynchronizationManager::
@@ -1218,6 +1411,47 @@ void SynchronizationManagerPrivate::createConnections(
         &SynchronizationManagerPrivate::linkedNotebooksNotesDownloadProgress,
         Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
 
+    // Progress signals are also used as the opportunity to persist the sync
+    // state reached so far so that the interrupted sync could be resumed
+    QObject::connect(
+        m_pRemoteToLocalSyncManager,
+        &RemoteToLocalSynchronizationManager::syncChunksDataProcessingProgress,
+        this, &SynchronizationManagerPrivate::onRemoteToLocalSyncProgress,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        m_pRemoteToLocalSyncManager,
+        &RemoteToLocalSynchronizationManager::notesDownloadProgress, this,
+        &SynchronizationManagerPrivate::onRemoteToLocalSyncProgress,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        m_pRemoteToLocalSyncManager,
+        &RemoteToLocalSynchronizationManager::resourcesDownloadProgress, this,
+        &SynchronizationManagerPrivate::onRemoteToLocalSyncProgress,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        m_pRemoteToLocalSyncManager,
+        &RemoteToLocalSynchronizationManager::
+            linkedNotebookSyncChunksDataProcessingProgress,
+        this, &SynchronizationManagerPrivate::onRemoteToLocalSyncProgress,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        m_pRemoteToLocalSyncManager,
+        &RemoteToLocalSynchronizationManager::
+            linkedNotebooksNotesDownloadProgress,
+        this, &SynchronizationManagerPrivate::onRemoteToLocalSyncProgress,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        m_pRemoteToLocalSyncManager,
+        &RemoteToLocalSynchronizationManager::
+            linkedNotebooksResourcesDownloadProgress,
+        this, &SynchronizationManagerPrivate::onRemoteToLocalSyncProgress,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
     QObject::connect(
         this, &SynchronizationManagerPrivate::sendAuthenticationTokenAndShardId,
         m_pRemoteToLocalSyncManager,
@@ -1308,6 +1542,28 @@ void SynchronizationManagerPrivate::createConnections(
         &SendLocalChangesManager::
             onAuthenticationTokensForLinkedNotebooksReceived,
         Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    // Connections with local storage manager async used for updates check
+    auto & localStorageManagerAsync =
+        m_pRemoteToLocalSyncManagerController->localStorageManagerAsync();
+
+    QObject::connect(
+        this, &SynchronizationManagerPrivate::listAllLinkedNotebooks,
+        &localStorageManagerAsync,
+        &LocalStorageManagerAsync::onListAllLinkedNotebooksRequest,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &localStorageManagerAsync,
+        &LocalStorageManagerAsync::listAllLinkedNotebooksComplete, this,
+        &SynchronizationManagerPrivate::onListAllLinkedNotebooksComplete,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    QObject::connect(
+        &localStorageManagerAsync,
+        &LocalStorageManagerAsync::listAllLinkedNotebooksFailed, this,
+        &SynchronizationManagerPrivate::onListAllLinkedNotebooksFailed,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
 }
 
 void SynchronizationManagerPrivate::readLastSyncParameters()
@@ -1575,6 +1831,8 @@ void SynchronizationManagerPrivate::launchSync()
 
     Q_EMIT notifyStart();
 
+    m_pSyncMetrics->finishPhase(QStringLiteral("authentication"));
+
     m_pNoteStore->setNoteStoreUrl(m_OAuthResult.m_noteStoreUrl);
 
     m_pNoteStore->setAuthData(
@@ -1601,6 +1859,8 @@ void SynchronizationManagerPrivate::launchFullSync()
     QNDEBUG("synchronization", "SynchronizationManagerPrivate::launchFullSync");
 
     m_somethingDownloaded = false;
+    resetSyncProgressCheckpointing();
+    m_pSyncMetrics->startPhase(QStringLiteral("download"));
     m_pRemoteToLocalSyncManager->start();
 }
 
@@ -1612,6 +1872,8 @@ void SynchronizationManagerPrivate::launchIncrementalSync()
             << "m_lastUpdateCount = " << m_lastUpdateCount);
 
     m_somethingDownloaded = false;
+    resetSyncProgressCheckpointing();
+    m_pSyncMetrics->startPhase(QStringLiteral("download"));
     m_pRemoteToLocalSyncManager->start(m_lastUpdateCount);
 }
 
@@ -1619,10 +1881,405 @@ void SynchronizationManagerPrivate::sendChanges()
 {
     QNDEBUG("synchronization", "SynchronizationManagerPrivate::sendChanges");
 
+    m_pSyncMetrics->startPhase(QStringLiteral("send"));
+
     m_pSendLocalChangesManager->start(
         m_lastUpdateCount, m_cachedLinkedNotebookLastUpdateCountByGuid);
 }
 
+void SynchronizationManagerPrivate::checkUserAccountForUpdates()
+{
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::checkUserAccountForUpdates");
+
+    auto syncState = m_pSyncStateStorage->getSyncState(
+        m_pRemoteToLocalSyncManager->account());
+
+    if (syncState->userDataUpdateCount() <= 0) {
+        QNDEBUG(
+            "synchronization",
+            "The client has never synchronized with "
+                << "the remote service, updates are available");
+        finishUpdatesCheck(/* success = */ true, true, ErrorString());
+        return;
+    }
+
+    m_pNoteStore->setNoteStoreUrl(m_OAuthResult.m_noteStoreUrl);
+
+    m_pNoteStore->setAuthData(
+        m_OAuthResult.m_authToken, m_OAuthResult.m_cookies);
+
+    qevercloud::SyncState state;
+    ErrorString errorDescription;
+    qint32 rateLimitSeconds = 0;
+
+    qint32 errorCode =
+        m_pNoteStore->getSyncState(state, errorDescription, rateLimitSeconds);
+
+    if (!checkUpdatesCheckApiCallResult(
+            errorCode, rateLimitSeconds, errorDescription))
+    {
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization",
+        "Sync state: " << state << "\nLast sync time = "
+                       << printableDateTimeFromTimestamp(
+                              syncState->userDataLastSyncTime())
+                       << "; last update count = "
+                       << syncState->userDataUpdateCount());
+
+    if ((state.fullSyncBefore > syncState->userDataLastSyncTime()) ||
+        (state.updateCount != syncState->userDataUpdateCount()))
+    {
+        finishUpdatesCheck(/* success = */ true, true, ErrorString());
+        return;
+    }
+
+    if (syncState->linkedNotebookUpdateCounts().isEmpty()) {
+        QNDEBUG(
+            "synchronization",
+            "No updates for user's own account and "
+                << "no linked notebooks were synchronized before");
+        finishUpdatesCheck(/* success = */ true, false, ErrorString());
+        return;
+    }
+
+    // NOTE: new linked notebooks are reported as updates of user's own
+    // account so only the already known linked notebooks need to be checked
+    m_listLinkedNotebooksForUpdatesCheckRequestId = QUuid::createUuid();
+
+    QNTRACE(
+        "synchronization",
+        "Emitting the request to list linked notebooks "
+            << "for updates check: request id = "
+            << m_listLinkedNotebooksForUpdatesCheckRequestId);
+
+    Q_EMIT listAllLinkedNotebooks(
+        0, 0, LocalStorageManager::ListLinkedNotebooksOrder::NoOrder,
+        LocalStorageManager::OrderDirection::Ascending,
+        m_listLinkedNotebooksForUpdatesCheckRequestId);
+}
+
+void SynchronizationManagerPrivate::checkLinkedNotebooksForUpdates(
+    const QList<LinkedNotebook> & linkedNotebooks)
+{
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::checkLinkedNotebooksForUpdates: "
+            << linkedNotebooks.size() << " linked notebooks");
+
+    clearLinkedNotebooksUpdatesCheckState();
+
+    auto syncState = m_pSyncStateStorage->getSyncState(
+        m_pRemoteToLocalSyncManager->account());
+
+    m_linkedNotebookLastUpdateCountsForUpdatesCheck =
+        syncState->linkedNotebookUpdateCounts();
+
+    for (const auto & linkedNotebook: linkedNotebooks) {
+        if (Q_UNLIKELY(!linkedNotebook.hasGuid())) {
+            QNWARNING(
+                "synchronization",
+                "Skipping linked notebook without guid: " << linkedNotebook);
+            continue;
+        }
+
+        qint32 lastUpdateCount =
+            m_linkedNotebookLastUpdateCountsForUpdatesCheck.value(
+                linkedNotebook.guid());
+
+        if (lastUpdateCount <= 0) {
+            QNDEBUG(
+                "synchronization",
+                "Linked notebook with guid "
+                    << linkedNotebook.guid() << " was never synchronized");
+            finishUpdatesCheck(/* success = */ true, true, ErrorString());
+            return;
+        }
+
+        QString shardId =
+            (linkedNotebook.hasShardId() ? linkedNotebook.shardId()
+                                         : QString());
+
+        m_linkedNotebooksPendingUpdatesCheckByShardId[shardId].enqueue(
+            linkedNotebook);
+    }
+
+    if (m_linkedNotebooksPendingUpdatesCheckByShardId.isEmpty()) {
+        QNDEBUG("synchronization", "No linked notebooks to check for updates");
+        finishUpdatesCheck(/* success = */ true, false, ErrorString());
+        return;
+    }
+
+    // Sending the sync state requests asynchronously, the results are handled
+    // in onGetLinkedNotebookSyncStateForUpdatesCheckFinished
+    const auto shardIds = m_linkedNotebooksPendingUpdatesCheckByShardId.keys();
+    for (const auto & shardId: qAsConst(shardIds)) {
+        for (int i = 0; i < LINKED_NOTEBOOK_SYNC_STATE_REQUESTS_PER_SHARD_MAX;
+             ++i)
+        {
+            if (!sendNextLinkedNotebookSyncStateRequestForUpdatesCheck(shardId))
+            {
+                return;
+            }
+        }
+    }
+}
+
+bool SynchronizationManagerPrivate::
+    sendNextLinkedNotebookSyncStateRequestForUpdatesCheck(
+        const QString & shardId)
+{
+    auto it = m_linkedNotebooksPendingUpdatesCheckByShardId.find(shardId);
+    if (it == m_linkedNotebooksPendingUpdatesCheckByShardId.end()) {
+        return true;
+    }
+
+    if (it.value().isEmpty()) {
+        Q_UNUSED(m_linkedNotebooksPendingUpdatesCheckByShardId.erase(it))
+        return true;
+    }
+
+    LinkedNotebook linkedNotebook = it.value().dequeue();
+
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::"
+            << "sendNextLinkedNotebookSyncStateRequestForUpdatesCheck: "
+            << "shard id = " << shardId
+            << ", linked notebook guid = " << linkedNotebook.guid());
+
+    auto * pNoteStore = noteStoreForLinkedNotebook(linkedNotebook);
+    if (Q_UNLIKELY(!pNoteStore)) {
+        ErrorString error(
+            QT_TR_NOOP("Can't check for updates: can't find or create "
+                       "note store for the linked notebook"));
+        QNWARNING(
+            "synchronization",
+            error << ", linked notebook: " << linkedNotebook);
+        finishUpdatesCheck(/* success = */ false, false, error);
+        return false;
+    }
+
+    QObject::connect(
+        pNoteStore, &INoteStore::getLinkedNotebookSyncStateAsyncFinished, this,
+        &SynchronizationManagerPrivate::
+            onGetLinkedNotebookSyncStateForUpdatesCheckFinished,
+        Qt::ConnectionType(Qt::UniqueConnection | Qt::QueuedConnection));
+
+    ErrorString errorDescription;
+    if (!pNoteStore->getLinkedNotebookSyncStateAsync(
+            linkedNotebook.qevercloudLinkedNotebook(),
+            m_OAuthResult.m_authToken, errorDescription))
+    {
+        ErrorString error(QT_TR_NOOP("Can't check for updates"));
+        error.appendBase(errorDescription.base());
+        error.appendBase(errorDescription.additionalBases());
+        error.details() = errorDescription.details();
+        QNWARNING(
+            "synchronization",
+            error << ", linked notebook: " << linkedNotebook);
+        finishUpdatesCheck(/* success = */ false, false, error);
+        return false;
+    }
+
+    m_linkedNotebooksWithUpdatesCheckInFlight[linkedNotebook.guid()] =
+        linkedNotebook;
+
+    return true;
+}
+
+void SynchronizationManagerPrivate::
+    onGetLinkedNotebookSyncStateForUpdatesCheckFinished(
+        qint32 errorCode, QString linkedNotebookGuid,
+        qevercloud::SyncState syncState, qint32 rateLimitSeconds,
+        ErrorString errorDescription)
+{
+    auto it = m_linkedNotebooksWithUpdatesCheckInFlight.find(
+        linkedNotebookGuid);
+
+    if (it == m_linkedNotebooksWithUpdatesCheckInFlight.end()) {
+        // Not the request sent for the updates check
+        return;
+    }
+
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::"
+            << "onGetLinkedNotebookSyncStateForUpdatesCheckFinished: "
+            << "error code = " << errorCode
+            << ", linked notebook guid = " << linkedNotebookGuid
+            << ", rate limit seconds = " << rateLimitSeconds
+            << ", error description = " << errorDescription
+            << ", sync state: " << syncState);
+
+    LinkedNotebook linkedNotebook = it.value();
+    Q_UNUSED(m_linkedNotebooksWithUpdatesCheckInFlight.erase(it))
+
+    if (!checkUpdatesCheckApiCallResult(
+            errorCode, rateLimitSeconds, errorDescription))
+    {
+        return;
+    }
+
+    qint32 lastUpdateCount =
+        m_linkedNotebookLastUpdateCountsForUpdatesCheck.value(
+            linkedNotebookGuid);
+
+    if (syncState.updateCount != lastUpdateCount) {
+        QNDEBUG(
+            "synchronization",
+            "Linked notebook with guid "
+                << linkedNotebookGuid << " has updates: last update "
+                << "count = " << lastUpdateCount
+                << ", sync state's update count = " << syncState.updateCount);
+        finishUpdatesCheck(/* success = */ true, true, ErrorString());
+        return;
+    }
+
+    QString shardId =
+        (linkedNotebook.hasShardId() ? linkedNotebook.shardId() : QString());
+
+    if (!sendNextLinkedNotebookSyncStateRequestForUpdatesCheck(shardId)) {
+        return;
+    }
+
+    // Each shard keeps its requests in flight while it has pending linked
+    // notebooks so no requests in flight means no pending ones as well
+    if (!m_linkedNotebooksWithUpdatesCheckInFlight.isEmpty()) {
+        QNDEBUG(
+            "synchronization",
+            "Still pending "
+                << m_linkedNotebooksWithUpdatesCheckInFlight.size()
+                << " linked notebook sync state requests");
+        return;
+    }
+
+    QNDEBUG("synchronization", "No updates for any of linked notebooks");
+    finishUpdatesCheck(/* success = */ true, false, ErrorString());
+}
+
+void SynchronizationManagerPrivate::clearLinkedNotebooksUpdatesCheckState()
+{
+    m_linkedNotebooksPendingUpdatesCheckByShardId.clear();
+    m_linkedNotebooksWithUpdatesCheckInFlight.clear();
+    m_linkedNotebookLastUpdateCountsForUpdatesCheck.clear();
+}
+
+bool SynchronizationManagerPrivate::checkUpdatesCheckApiCallResult(
+    const qint32 errorCode, const qint32 rateLimitSeconds,
+    const ErrorString & errorDescription)
+{
+    if (errorCode == 0) {
+        return true;
+    }
+
+    if (errorCode ==
+        static_cast<qint32>(qevercloud::EDAMErrorCode::RATE_LIMIT_REACHED))
+    {
+        Q_EMIT rateLimitExceeded(rateLimitSeconds);
+    }
+
+    ErrorString error(QT_TR_NOOP("Can't check for updates"));
+    error.appendBase(errorDescription.base());
+    error.appendBase(errorDescription.additionalBases());
+    error.details() = errorDescription.details();
+    QNWARNING("synchronization", error << ", error code = " << errorCode);
+
+    finishUpdatesCheck(/* success = */ false, false, error);
+    return false;
+}
+
+void SynchronizationManagerPrivate::finishUpdatesCheck(
+    const bool success, const bool updatesAvailable,
+    const ErrorString & errorDescription)
+{
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::finishUpdatesCheck: success = "
+            << (success ? "true" : "false") << ", updates available = "
+            << (updatesAvailable ? "true" : "false")
+            << ", error description = " << errorDescription);
+
+    clearLinkedNotebooksUpdatesCheckState();
+
+    Q_EMIT updatesCheckFinished(success, updatesAvailable, errorDescription);
+
+    if (!m_pollingUpdatesCheckInProgress) {
+        return;
+    }
+
+    m_pollingUpdatesCheckInProgress = false;
+
+    if (m_pollingIntervalMsec <= 0) {
+        // Polling was stopped while the check was in progress
+        return;
+    }
+
+    if (success && updatesAvailable) {
+        m_pollingIntervalMsec = m_minPollingIntervalMsec;
+        restartPollingTimer();
+
+        // Launching the sync asynchronously to avoid re-entering
+        // the authentication or local storage callbacks we might be called from
+        QMetaObject::invokeMethod(this, "synchronize", Qt::QueuedConnection);
+        return;
+    }
+
+    // Backing off both when there are no updates and when the check failed
+    int maxIntervalMsecToDouble = m_maxPollingIntervalMsec / 2;
+    if (m_pollingIntervalMsec <= maxIntervalMsecToDouble) {
+        m_pollingIntervalMsec *= 2;
+    }
+    else {
+        m_pollingIntervalMsec = m_maxPollingIntervalMsec;
+    }
+
+    QNDEBUG(
+        "synchronization",
+        "Polling interval is now " << m_pollingIntervalMsec << " msec");
+    restartPollingTimer();
+}
+
+void SynchronizationManagerPrivate::restartPollingTimer()
+{
+    if (m_pollingTimerId > 0) {
+        killTimer(m_pollingTimerId);
+        m_pollingTimerId = -1;
+    }
+
+    if (m_pollingIntervalMsec <= 0) {
+        return;
+    }
+
+    m_pollingTimerId = startTimer(m_pollingIntervalMsec);
+    if (Q_UNLIKELY(m_pollingTimerId == 0)) {
+        QNWARNING(
+            "synchronization",
+            "Failed to start the timer for adaptive polling");
+        m_pollingTimerId = -1;
+    }
+}
+
+void SynchronizationManagerPrivate::finishSyncMetrics()
+{
+    if (!m_pSyncMetrics->isPhaseRunning(QStringLiteral("total"))) {
+        return;
+    }
+
+    m_pSyncMetrics->finishAllPhases();
+
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::finishSyncMetrics: "
+            << *m_pSyncMetrics);
+
+    Q_EMIT syncMetricsReady(std::make_shared<SyncMetrics>(*m_pSyncMetrics));
+}
+
 void SynchronizationManagerPrivate::launchStoreOAuthResult(
     const AuthData & result)
 {
@@ -1776,6 +2433,10 @@ void SynchronizationManagerPrivate::finalizeAuthentication()
     case AuthContext::AuthToLinkedNotebooks:
         authenticateToLinkedNotebooks();
         break;
+    case AuthContext::UpdatesCheck:
+        m_authContext = AuthContext::Blank;
+        checkUserAccountForUpdates();
+        break;
     default:
     {
         ErrorString error(
@@ -1927,6 +2588,7 @@ void SynchronizationManagerPrivate::timerEvent(QTimerEvent * pTimerEvent)
 
     if (timerId == m_authenticateToLinkedNotebooksPostponeTimerId) {
         m_authenticateToLinkedNotebooksPostponeTimerId = -1;
+        m_pSyncMetrics->finishPhaseInstance(QStringLiteral("rate_limit_wait"));
         QNDEBUG(
             "synchronization",
             "Re-attempting to authenticate to "
@@ -1935,12 +2597,61 @@ void SynchronizationManagerPrivate::timerEvent(QTimerEvent * pTimerEvent)
             m_linkedNotebookAuthDataPendingAuthentication);
         return;
     }
+
+    if (timerId == m_pollingTimerId) {
+        m_pollingTimerId = -1;
+        restartPollingTimer();
+
+        if (active() || m_authenticationInProgress) {
+            QNDEBUG(
+                "synchronization",
+                "Polling: the synchronization or "
+                    << "authentication is in progress, skipping this poll");
+            return;
+        }
+
+        if (m_localChangesPendingSync) {
+            QNDEBUG(
+                "synchronization",
+                "Polling: there are local changes "
+                    << "pending sync, launching the synchronization");
+            synchronize();
+            return;
+        }
+
+        if (m_pollingUpdatesCheckInProgress) {
+            QNDEBUG(
+                "synchronization",
+                "Polling: the previous check for updates "
+                    << "has not finished within the polling interval, "
+                    << "launching the synchronization");
+            m_pollingUpdatesCheckInProgress = false;
+            synchronize();
+            return;
+        }
+
+        QNDEBUG("synchronization", "Polling: checking for updates");
+        m_pollingUpdatesCheckInProgress = true;
+        checkForUpdates();
+        return;
+    }
 }
 
 void SynchronizationManagerPrivate::clear()
 {
     QNDEBUG("synchronization", "SynchronizationManagerPrivate::clear");
 
+    if (!m_listLinkedNotebooksForUpdatesCheckRequestId.isNull() ||
+        !m_linkedNotebooksWithUpdatesCheckInFlight.isEmpty() ||
+        (m_authContext == AuthContext::UpdatesCheck))
+    {
+        m_listLinkedNotebooksForUpdatesCheckRequestId = QUuid();
+        m_authContext = AuthContext::Blank;
+
+        ErrorString error(QT_TR_NOOP("The check for updates was interrupted"));
+        finishUpdatesCheck(/* success = */ false, false, error);
+    }
+
     m_lastUpdateCount = -1;
     m_previousUpdateCount = -1;
     m_lastSyncTime = -1;
@@ -1952,7 +2663,7 @@ void SynchronizationManagerPrivate::clear()
 
     m_launchSyncPostponeTimerId = -1;
 
-    m_pNoteStore->stop();
+    m_pMeteredNoteStore->stop();
 
     for (auto it: qevercloud::toRange(m_noteStoresByLinkedNotebookGuids)) {
         INoteStore * pNoteStore = it.value();
@@ -1972,6 +2683,9 @@ void SynchronizationManagerPrivate::clear()
     m_cachedLinkedNotebookAuthTokensAndShardIdsByGuid.clear();
     m_cachedLinkedNotebookAuthTokenExpirationTimeByGuid.clear();
 
+    if (m_authenticateToLinkedNotebooksPostponeTimerId >= 0) {
+        m_pSyncMetrics->finishPhaseInstance(QStringLiteral("rate_limit_wait"));
+    }
     m_authenticateToLinkedNotebooksPostponeTimerId = -1;
 
     m_readLinkedNotebookAuthTokenJobIdsWithLinkedNotebookGuids.clear();
@@ -2286,6 +3000,9 @@ void SynchronizationManagerPrivate::authenticateToLinkedNotebooks()
             m_authenticateToLinkedNotebooksPostponeTimerId =
                 startTimer(secondsToMilliseconds(rateLimitSeconds));
 
+            m_pSyncMetrics->startPhaseInstance(
+                QStringLiteral("rate_limit_wait"));
+
             Q_EMIT rateLimitExceeded(rateLimitSeconds);
 
             ++it;
@@ -2813,6 +3530,56 @@ void SynchronizationManagerPrivate::tryUpdateLastSyncStatus()
     }
 }
 
+void SynchronizationManagerPrivate::resetSyncProgressCheckpointing()
+{
+    m_lastSyncProgressCheckpointTimestamp = QDateTime::currentMSecsSinceEpoch();
+    m_syncProgressCheckpointIntervalMsec =
+        SYNC_PROGRESS_CHECKPOINT_INTERVAL_MSEC;
+
+    ApplicationSettings appSettings(
+        m_pRemoteToLocalSyncManager->account(),
+        SYNCHRONIZATION_PERSISTENCE_NAME);
+
+    appSettings.beginGroup(SYNC_SETTINGS_KEY_GROUP);
+
+    if (appSettings.contains(SYNC_PROGRESS_CHECKPOINT_INTERVAL_KEY)) {
+        bool conversionResult = false;
+        qint64 interval =
+            appSettings.value(SYNC_PROGRESS_CHECKPOINT_INTERVAL_KEY)
+                .toLongLong(&conversionResult);
+
+        if (conversionResult && (interval >= 0)) {
+            m_syncProgressCheckpointIntervalMsec = interval;
+        }
+    }
+
+    appSettings.endGroup();
+}
+
+void SynchronizationManagerPrivate::checkpointSyncProgress()
+{
+    QNDEBUG(
+        "synchronization",
+        "SynchronizationManagerPrivate::checkpointSyncProgress");
+
+    if (!m_pRemoteToLocalSyncManager->active()) {
+        QNDEBUG("synchronization", "Remote to local sync is not active");
+        return;
+    }
+
+    if (!m_pRemoteToLocalSyncManager->canCheckpointSyncProgress()) {
+        QNDEBUG(
+            "synchronization",
+            "The sync progress can't be persisted at this stage of the sync");
+        return;
+    }
+
+    // The same update counts as persisted when the sync is stopped or
+    // the rate limit is exceeded: the smallest USNs of items which haven't
+    // been merged into the local storage yet
+    tryUpdateLastSyncStatus();
+}
+
 void SynchronizationManagerPrivate::updatePersistentSyncSettings()
 {
     QNDEBUG(
@@ -2905,7 +3672,7 @@ INoteStore * SynchronizationManagerPrivate::noteStoreForLinkedNotebookGuid(
         return nullptr;
     }
 
-    auto * pNoteStore = m_pNoteStore->create();
+    auto * pNoteStore = m_pMeteredNoteStore->create();
     pNoteStore->setParent(this);
 
     pNoteStore->setAuthData(m_OAuthResult.m_authToken, m_OAuthResult.m_cookies);
@@ -2931,7 +3698,7 @@ LocalStorageManagerAsync & SynchronizationManagerPrivate::
 INoteStore & SynchronizationManagerPrivate::
     RemoteToLocalSynchronizationManagerController::noteStore()
 {
-    return *m_syncManager.m_pNoteStore;
+    return *m_syncManager.m_pMeteredNoteStore;
 }
 
 IUserStore & SynchronizationManagerPrivate::
@@ -2947,6 +3714,12 @@ INoteStore * SynchronizationManagerPrivate::
     return m_syncManager.noteStoreForLinkedNotebook(linkedNotebook);
 }
 
+SyncMetrics & SynchronizationManagerPrivate::
+    RemoteToLocalSynchronizationManagerController::syncMetrics()
+{
+    return *m_syncManager.m_pSyncMetrics;
+}
+
 SynchronizationManagerPrivate::SendLocalChangesManagerController::
     SendLocalChangesManagerController(
         LocalStorageManagerAsync & localStorageManagerAsync,
@@ -2964,7 +3737,7 @@ LocalStorageManagerAsync & SynchronizationManagerPrivate::
 INoteStore &
 SynchronizationManagerPrivate::SendLocalChangesManagerController::noteStore()
 {
-    return *m_syncManager.m_pNoteStore;
+    return *m_syncManager.m_pMeteredNoteStore;
 }
 
 INoteStore * SynchronizationManagerPrivate::SendLocalChangesManagerController::
@@ -2973,6 +3746,12 @@ INoteStore * SynchronizationManagerPrivate::SendLocalChangesManagerController::
     return m_syncManager.noteStoreForLinkedNotebook(linkedNotebook);
 }
 
+SyncMetrics &
+SynchronizationManagerPrivate::SendLocalChangesManagerController::syncMetrics()
+{
+    return *m_syncManager.m_pSyncMetrics;
+}
+
 QTextStream & SynchronizationManagerPrivate::AuthData::print(
     QTextStream & strm) const
 {
@@ -3011,6 +3790,9 @@ void printAuthContext(
     case AuthContext::AuthToLinkedNotebooks:
         t << "Auth to linked notebooks";
         break;
+    case AuthContext::UpdatesCheck:
+        t << "Updates check";
+        break;
     default:
         t << "Unknown (" << static_cast<qint64>(ctx) << ")";
         break;
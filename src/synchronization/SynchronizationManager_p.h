@@ -21,6 +21,7 @@
 
 #include "RemoteToLocalSynchronizationManager.h"
 #include "SendLocalChangesManager.h"
+#include "SyncMetrics.h"
 
 #include <quentier/synchronization/ForwardDeclarations.h>
 #include <quentier/types/Account.h>
@@ -68,6 +69,7 @@ public:
         NewUserRequest,
         CurrentUserRequest,
         AuthToLinkedNotebooks,
+        UpdatesCheck,
     };
 
     friend QDebug & operator<<(QDebug & dbg, const AuthContext ctx);
@@ -97,6 +99,10 @@ Q_SIGNALS:
 
     void linkedNotebooksSyncChunksDownloaded();
 
+    void linkedNotebookSyncStatesCheckProgress(
+        quint32 linkedNotebooksChecked, quint32 totalLinkedNotebooksToCheck,
+        LinkedNotebook linkedNotebook, bool hasUpdates);
+
     void linkedNotebookSyncChunksDataProcessingProgress(
         ISyncChunksDataCountersPtr counters);
 
@@ -130,6 +136,11 @@ Q_SIGNALS:
     void detectedConflictDuringLocalChangesSending();
     void rateLimitExceeded(qint32 secondsToWait);
 
+    void updatesCheckFinished(
+        bool success, bool updatesAvailable, ErrorString errorDescription);
+
+    void syncMetricsReady(ISyncMetricsPtr metrics);
+
 public Q_SLOTS:
     void setAccount(const Account & account);
     void synchronize();
@@ -143,6 +154,12 @@ public Q_SLOTS:
     void setDownloadInkNoteImages(const bool flag);
     void setInkNoteImagesStoragePath(const QString & path);
 
+    void checkForUpdates();
+
+    void startAdaptivePolling(int minIntervalMsec, int maxIntervalMsec);
+    void stopAdaptivePolling();
+    void notifyLocalChanges();
+
 Q_SIGNALS:
     // private signals
     void requestAuthentication();
@@ -162,6 +179,11 @@ Q_SIGNALS:
         QHash<QString, qint32> lastUpdateCountByLinkedNotebookGuid,
         QHash<QString, qevercloud::Timestamp> lastSyncTimeByLinkedNotebookGuid);
 
+    void listAllLinkedNotebooks(
+        size_t limit, size_t offset,
+        LocalStorageManager::ListLinkedNotebooksOrder order,
+        LocalStorageManager::OrderDirection orderDirection, QUuid requestId);
+
 private Q_SLOTS:
     void onOAuthResult(
         bool success, qevercloud::UserID userId, QString authToken,
@@ -198,6 +220,8 @@ private Q_SLOTS:
     void onRemoteToLocalSynchronizedContentFromUsersOwnAccount(
         qint32 lastUpdateCount, qevercloud::Timestamp lastSyncTime);
 
+    void onRemoteToLocalSyncProgress();
+
     void onShouldRepeatIncrementalSync();
     void onConflictDetectedDuringLocalChangesSending();
 
@@ -210,6 +234,23 @@ private Q_SLOTS:
 
     void onRateLimitExceeded(qint32 secondsToWait);
 
+    void onListAllLinkedNotebooksComplete(
+        size_t limit, size_t offset,
+        LocalStorageManager::ListLinkedNotebooksOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        QList<LinkedNotebook> foundLinkedNotebooks, QUuid requestId);
+
+    void onListAllLinkedNotebooksFailed(
+        size_t limit, size_t offset,
+        LocalStorageManager::ListLinkedNotebooksOrder order,
+        LocalStorageManager::OrderDirection orderDirection,
+        ErrorString errorDescription, QUuid requestId);
+
+    void onGetLinkedNotebookSyncStateForUpdatesCheckFinished(
+        qint32 errorCode, QString linkedNotebookGuid,
+        qevercloud::SyncState syncState, qint32 rateLimitSeconds,
+        ErrorString errorDescription);
+
 private:
     void createConnections(IAuthenticationManager & authenticationManager);
 
@@ -245,6 +286,32 @@ private:
     void launchIncrementalSync();
     void sendChanges();
 
+    void checkUserAccountForUpdates();
+
+    void checkLinkedNotebooksForUpdates(
+        const QList<LinkedNotebook> & linkedNotebooks);
+
+    /**
+     * @return          False if the updates check was finished due to error,
+     *                  true otherwise
+     */
+    bool sendNextLinkedNotebookSyncStateRequestForUpdatesCheck(
+        const QString & shardId);
+
+    void clearLinkedNotebooksUpdatesCheckState();
+
+    bool checkUpdatesCheckApiCallResult(
+        const qint32 errorCode, const qint32 rateLimitSeconds,
+        const ErrorString & errorDescription);
+
+    void finishUpdatesCheck(
+        const bool success, const bool updatesAvailable,
+        const ErrorString & errorDescription);
+
+    void restartPollingTimer();
+
+    void finishSyncMetrics();
+
     virtual void timerEvent(QTimerEvent * pTimerEvent);
 
     void clear();
@@ -290,6 +357,8 @@ private:
     bool isDeletingShardId(const qevercloud::UserID userId) const;
 
     void tryUpdateLastSyncStatus();
+    void resetSyncProgressCheckpointing();
+    void checkpointSyncProgress();
     void updatePersistentSyncSettings();
 
     INoteStore * noteStoreForLinkedNotebook(
@@ -322,10 +391,18 @@ private:
     QHash<QString, qevercloud::Timestamp>
         m_cachedLinkedNotebookLastSyncTimeByGuid;
     bool m_onceReadLastSyncParams = false;
+    qint64 m_lastSyncProgressCheckpointTimestamp = 0;
+    qint64 m_syncProgressCheckpointIntervalMsec =
+        SYNC_PROGRESS_CHECKPOINT_INTERVAL_MSEC;
 
     INoteStorePtr m_pNoteStore;
     IUserStorePtr m_pUserStore;
 
+    // Collects the metrics of the current sync; note stores passed to remote
+    // to local and send local changes managers record their calls into it
+    std::shared_ptr<SyncMetrics> m_pSyncMetrics;
+    INoteStorePtr m_pMeteredNoteStore;
+
     AuthContext m_authContext = AuthContext::Blank;
 
     int m_launchSyncPostponeTimerId = -1;
@@ -385,6 +462,25 @@ private:
     QSet<QString> m_linkedNotebookGuidsWithoutLocalAuthData;
 
     bool m_shouldRepeatIncrementalSyncAfterSendingChanges = false;
+
+    QUuid m_listLinkedNotebooksForUpdatesCheckRequestId;
+
+    // Linked notebooks for which sync state requests were not sent yet within
+    // the ongoing updates check, by shard ids; the number of requests in
+    // flight per shard is limited
+    QHash<QString, QQueue<LinkedNotebook>>
+        m_linkedNotebooksPendingUpdatesCheckByShardId;
+
+    QHash<QString, LinkedNotebook> m_linkedNotebooksWithUpdatesCheckInFlight;
+    QHash<QString, qint32> m_linkedNotebookLastUpdateCountsForUpdatesCheck;
+
+    // Adaptive polling: the interval is 0 while polling is not started
+    int m_minPollingIntervalMsec = 0;
+    int m_maxPollingIntervalMsec = 0;
+    int m_pollingIntervalMsec = 0;
+    int m_pollingTimerId = -1;
+    bool m_pollingUpdatesCheckInProgress = false;
+    bool m_localChangesPendingSync = false;
 };
 
 } // namespace quentier
@@ -35,6 +35,22 @@
 
 #define HALF_AN_HOUR_IN_MSEC (1800000)
 
+#define SYNC_SETTINGS_KEY_GROUP QStringLiteral("SynchronizationSettings")
+
+// Minimal interval between persisting the progress of the ongoing sync
+#define SYNC_PROGRESS_CHECKPOINT_INTERVAL_MSEC (30000)
+
+// Overrides the interval above, mostly intended for tests
+#define SYNC_PROGRESS_CHECKPOINT_INTERVAL_KEY                                  \
+    QStringLiteral("SyncProgressCheckpointIntervalMsec")
+
+// Maximal number of linked notebook sync state requests in flight per shard
+#define LINKED_NOTEBOOK_SYNC_STATE_REQUESTS_PER_SHARD_MAX (4)
+
+// Maximal number of linked notebooks per shard which sync chunks are being
+// downloaded at the same time
+#define LINKED_NOTEBOOK_SYNC_CHUNKS_DOWNLOADS_PER_SHARD_MAX (4)
+
 #define AUTHENTICATION_TIMESTAMP_KEY QStringLiteral("AuthenticationTimestamp")
 
 #define EXPIRATION_TIMESTAMP_KEY QStringLiteral("ExpirationTimestamp")
@@ -19,6 +19,8 @@
 #include "enml/ENMLTester.h"
 #include "local_storage/LocalStorageManagerTester.h"
 #include "synchronization/FullSyncStaleDataItemsExpungerTester.h"
+#include "synchronization/SyncChunksBufferTester.h"
+#include "synchronization/SyncMetricsTester.h"
 #include "synchronization/SynchronizationTester.h"
 #include "types/TypesTester.h"
 #include "utility/UtilityTester.h"
@@ -31,6 +33,11 @@
 #include <quentier/utility/Initialize.h>
 #include <quentier/utility/QuentierApplication.h>
 #include <quentier/utility/StandardPaths.h>
+#include <quentier/utility/VersionInfo.h>
+
+#if LIB_QUENTIER_HAS_NOTE_EDITOR
+#include "note_editor/NoteEditorTester.h"
+#endif
 
 #include <QDebug>
 #include <QDir>
@@ -98,7 +105,12 @@ int main(int argc, char * argv[])
     RUN_TESTS(MigratingKeychainTester)
     RUN_TESTS(ObfuscatingKeychainTester)
     RUN_TESTS(LocalStorageManagerTester)
+#if LIB_QUENTIER_HAS_NOTE_EDITOR
+    RUN_TESTS(NoteEditorTester)
+#endif
     RUN_TESTS(FullSyncStaleDataItemsExpungerTester)
+    RUN_TESTS(SyncChunksBufferTester)
+    RUN_TESTS(SyncMetricsTester)
     RUN_TESTS(SynchronizationTester)
 
     return 0;
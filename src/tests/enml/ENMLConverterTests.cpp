@@ -17,12 +17,16 @@
  */
 
 #include "ENMLConverterTests.h"
+
+#include "../../enml/StaticStringSet.h"
+
 #include <QFile>
 #include <QXmlStreamReader>
 #include <quentier/enml/DecryptedTextManager.h>
 #include <quentier/enml/ENMLConverter.h>
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/types/ErrorString.h>
+#include <quentier/types/Note.h>
 
 void initENMLConversionTestResources();
 
@@ -982,6 +986,285 @@ bool convertHtmlWithTableAndHilitorHelperTagsToEnml(QString & error)
     return true;
 }
 
+QVector<Note> composeNotesForBatchConversion(const int numNotes)
+{
+    QVector<Note> notes;
+    notes.reserve(numNotes);
+
+    for (int i = 0; i < numNotes; ++i) {
+        QString content = QStringLiteral("<en-note>");
+        for (int j = 0; j <= (i % 20); ++j) {
+            content += QStringLiteral("<div>Paragraph ");
+            content += QString::number(j);
+            content += QStringLiteral(" of note ");
+            content += QString::number(i);
+            content += QStringLiteral(" with <b>some</b> text</div>");
+        }
+        content += QStringLiteral("</en-note>");
+
+        Note note;
+        note.setContent(content);
+        notes << note;
+    }
+
+    return notes;
+}
+
+bool convertNotesToPlainTextAndListsOfWordsInBatch(QString & error)
+{
+    QVector<Note> notes = composeNotesForBatchConversion(100);
+
+    // Note without content and note with malformed content
+    notes << Note();
+
+    Note malformedNote;
+    malformedNote.setContent(QStringLiteral("<en-note><div>Text</en-note>"));
+    notes << malformedNote;
+
+    QStringList plainTexts;
+    QVector<ErrorString> errorDescriptions;
+    bool res = ENMLConverter::noteContentToPlainText(
+        notes, plainTexts, errorDescriptions);
+
+    if (res) {
+        error = QStringLiteral(
+            "Batch conversion to plain text didn't report the error for "
+            "the note with malformed content");
+        return false;
+    }
+
+    if ((plainTexts.size() != notes.size()) ||
+        (errorDescriptions.size() != notes.size()))
+    {
+        error = QStringLiteral(
+            "Batch conversion to plain text returned unexpected number of "
+            "results");
+        return false;
+    }
+
+    QVector<QStringList> listsOfWords;
+    res = ENMLConverter::noteContentToListOfWords(
+        notes, listsOfWords, errorDescriptions);
+
+    if (res || (listsOfWords.size() != notes.size())) {
+        error = QStringLiteral(
+            "Batch conversion to lists of words returned unexpected result");
+        return false;
+    }
+
+    const int numNotes = notes.size();
+    for (int i = 0; i < numNotes - 1; ++i) {
+        if (!errorDescriptions.at(i).isEmpty()) {
+            error = QStringLiteral("Unexpected error for note #") +
+                QString::number(i) + QStringLiteral(": ") +
+                errorDescriptions.at(i).nonLocalizedString();
+            return false;
+        }
+
+        const auto & note = notes.at(i);
+        if (!note.hasContent()) {
+            if (!plainTexts.at(i).isEmpty() || !listsOfWords.at(i).isEmpty())
+            {
+                error = QStringLiteral(
+                    "Non-empty result for the note without content");
+                return false;
+            }
+
+            continue;
+        }
+
+        QString plainText;
+        QStringList listOfWords;
+        ErrorString errorDescription;
+        if (!ENMLConverter::noteContentToListOfWords(
+                note.content(), listOfWords, errorDescription, &plainText))
+        {
+            error = QStringLiteral("Failed to convert note #") +
+                QString::number(i) + QStringLiteral(": ") +
+                errorDescription.nonLocalizedString();
+            return false;
+        }
+
+        if (plainText != plainTexts.at(i)) {
+            error = QStringLiteral("Plain text of note #") +
+                QString::number(i) +
+                QStringLiteral(" differs from the one converted alone: ") +
+                plainTexts.at(i) + QStringLiteral(" vs ") + plainText;
+            return false;
+        }
+
+        if (listOfWords != listsOfWords.at(i)) {
+            error = QStringLiteral("List of words of note #") +
+                QString::number(i) +
+                QStringLiteral(" differs from the one converted alone");
+            return false;
+        }
+    }
+
+    if (errorDescriptions.last().isEmpty()) {
+        error = QStringLiteral(
+            "No error for the note with malformed content");
+        return false;
+    }
+
+    return true;
+}
+
+bool validateAndFixupNotesEnmlInBatch(QString & error)
+{
+    QVector<Note> notes = composeNotesForBatchConversion(50);
+
+    // The id attribute is not allowed by ENML DTD and should be removed
+    const int numNotesToFixup = 10;
+    for (int i = 0; i < numNotesToFixup; ++i) {
+        Note note;
+        note.setContent(
+            QStringLiteral("<en-note><div id=\"paragraph\">Note to fix up ") +
+            QString::number(i) + QStringLiteral("</div></en-note>"));
+        notes << note;
+    }
+
+    ENMLConverter converter;
+    QVector<ErrorString> errorDescriptions;
+    bool res = converter.validateAndFixupEnml(notes, errorDescriptions);
+    if (!res) {
+        error = QStringLiteral("Batch validation and fixup of ENML failed");
+        for (const auto & errorDescription: qAsConst(errorDescriptions)) {
+            if (!errorDescription.isEmpty()) {
+                error += QStringLiteral(": ");
+                error += errorDescription.nonLocalizedString();
+                break;
+            }
+        }
+
+        return false;
+    }
+
+    for (const auto & note: qAsConst(notes)) {
+        if (note.content().contains(QStringLiteral(" id="))) {
+            error = QStringLiteral("Forbidden attribute was not removed: ") +
+                note.content();
+            return false;
+        }
+
+        ErrorString errorDescription;
+        if (!converter.validateEnml(note.content(), errorDescription)) {
+            error = QStringLiteral("Fixed up ENML is not valid: ") +
+                errorDescription.nonLocalizedString();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#define WRAP(x) x,
+
+constexpr const char * staticStringSetTestKeys[] = {
+#include "../../enml/allowedXhtmlTags.inl"
+};
+
+#undef WRAP
+
+bool checkStaticStringSetLookups(QString & error)
+{
+    constexpr auto set = makeStaticStringSet<1024>(staticStringSetTestKeys);
+    if (set.m_seed == staticStringSetMaxSeed) {
+        error = QStringLiteral("Failed to find perfect seed for string set");
+        return false;
+    }
+
+    for (const char * key: staticStringSetTestKeys) {
+        const QString str = QString::fromLatin1(key);
+        if (!set.contains(str)) {
+            error = QStringLiteral("String set doesn't contain key ") + str;
+            return false;
+        }
+
+        // Lookups via QStringRef pointing inside a larger string
+        const QString prefixedStr = QStringLiteral("<") + str +
+            QStringLiteral(">");
+
+        if (!set.contains(QStringRef(&prefixedStr, 1, str.size()))) {
+            error = QStringLiteral("String set doesn't contain the key ") +
+                str + QStringLiteral(" referenced by QStringRef");
+            return false;
+        }
+
+        const QString upperStr = str.toUpper();
+        if ((upperStr != str) && set.contains(upperStr)) {
+            error =
+                QStringLiteral("String set lookup is not case sensitive: ") +
+                upperStr;
+            return false;
+        }
+
+        const QString extendedStr = str + QStringLiteral("x");
+        if (set.contains(extendedStr)) {
+            error = QStringLiteral("String set contains unexpected key ") +
+                extendedStr;
+            return false;
+        }
+    }
+
+    const QString nonKeys[] = {
+        QString(), QStringLiteral("script"), QStringLiteral("en-note"),
+        QStringLiteral("d\u00efv"), QStringLiteral("\u0434\u0438\u0432")};
+
+    for (const auto & nonKey: nonKeys) {
+        if (set.contains(nonKey)) {
+            error = QStringLiteral("String set contains unexpected key ") +
+                nonKey;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool composeComplexNotesHtml(QStringList & htmls, QString & error)
+{
+    initENMLConversionTestResources();
+
+    htmls.clear();
+
+    ENMLConverter converter;
+    DecryptedTextManager decryptedTextManager;
+
+    for (int i = 1; i <= 4; ++i) {
+        QFile file(
+            QStringLiteral(":/tests/complexNote") + QString::number(i) +
+            QStringLiteral(".txt"));
+
+        if (!file.open(QIODevice::ReadOnly)) {
+            error = QStringLiteral(
+                        "Can't open the resource with complex note #") +
+                QString::number(i) + QStringLiteral(" for reading");
+            return false;
+        }
+
+        const QString noteContent = QString::fromLocal8Bit(file.readAll());
+
+        QString html;
+        ENMLConverter::NoteContentToHtmlExtraData extraData;
+        ErrorString errorMessage;
+
+        bool res = converter.noteContentToHtml(
+            noteContent, html, errorMessage, decryptedTextManager, extraData);
+
+        if (!res) {
+            error = QStringLiteral(
+                "Unable to convert the note content to HTML: ");
+            error += errorMessage.nonLocalizedString();
+            return false;
+        }
+
+        htmls << html;
+    }
+
+    return true;
+}
+
 } // namespace test
 } // namespace quentier
 
@@ -19,7 +19,11 @@
 #ifndef LIB_QUENTIER_TESTS_ENML_CONVERTER_TESTS_H
 #define LIB_QUENTIER_TESTS_ENML_CONVERTER_TESTS_H
 
+#include <quentier/types/Note.h>
+
 #include <QString>
+#include <QStringList>
+#include <QVector>
 
 namespace quentier {
 namespace test {
@@ -36,6 +40,23 @@ bool convertHtmlWithModifiedDecryptedTextToEnml(QString & error);
 bool convertHtmlWithTableHelperTagsToEnml(QString & error);
 bool convertHtmlWithTableAndHilitorHelperTagsToEnml(QString & error);
 
+/**
+ * Composes numNotes notes with contents of various sizes for batch
+ * conversion tests and benchmarks
+ */
+QVector<Note> composeNotesForBatchConversion(const int numNotes);
+
+bool convertNotesToPlainTextAndListsOfWordsInBatch(QString & error);
+bool validateAndFixupNotesEnmlInBatch(QString & error);
+
+bool checkStaticStringSetLookups(QString & error);
+
+/**
+ * Converts the contents of complex test notes to HTML for benchmarks of
+ * the conversion from HTML back to ENML
+ */
+bool composeComplexNotesHtml(QStringList & htmls, QString & error);
+
 } // namespace test
 } // namespace quentier
 
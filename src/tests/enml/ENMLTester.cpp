@@ -21,6 +21,9 @@
 #include "ENMLConverterTests.h"
 #include "EnexExportImportTests.h"
 
+#include <quentier/enml/DecryptedTextManager.h>
+#include <quentier/enml/ENMLConverter.h>
+
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/types/RegisterMetatypes.h>
 #include <quentier/utility/SysInfo.h>
@@ -28,6 +31,9 @@
 #include <QTextStream>
 #include <QtTest/QTest>
 
+// Resembles the number of notes processed by note reindexing
+#define ENML_BENCHMARK_NUM_NOTES (2000)
+
 #define CATCH_EXCEPTION()                                                      \
     catch (const std::exception & exception) {                                 \
         SysInfo sysInfo;                                                       \
@@ -168,6 +174,104 @@ void ENMLTester::enmlConverterHtmlWithTableAndHilitorHelperTags()
     CATCH_EXCEPTION();
 }
 
+void ENMLTester::enmlConverterBatchConversionToPlainTextAndListsOfWords()
+{
+    try {
+        QString error;
+        bool res = convertNotesToPlainTextAndListsOfWordsInBatch(error);
+        QVERIFY2(res == true, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void ENMLTester::enmlConverterBatchValidationAndFixup()
+{
+    try {
+        QString error;
+        bool res = validateAndFixupNotesEnmlInBatch(error);
+        QVERIFY2(res == true, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void ENMLTester::enmlConverterStaticStringSetTest()
+{
+    try {
+        QString error;
+        bool res = checkStaticStringSetLookups(error);
+        QVERIFY2(res == true, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void ENMLTester::benchmarkNoteContentToListOfWordsOneByOne()
+{
+    try {
+        QVector<Note> notes =
+            composeNotesForBatchConversion(ENML_BENCHMARK_NUM_NOTES);
+
+        QBENCHMARK
+        {
+            for (const auto & note: qAsConst(notes)) {
+                QStringList listOfWords;
+                ErrorString errorDescription;
+                bool res = ENMLConverter::noteContentToListOfWords(
+                    note.content(), listOfWords, errorDescription);
+                QVERIFY2(
+                    res == true,
+                    qPrintable(errorDescription.nonLocalizedString()));
+            }
+        }
+    }
+    CATCH_EXCEPTION();
+}
+
+void ENMLTester::benchmarkNoteContentToListOfWordsInBatch()
+{
+    try {
+        QVector<Note> notes =
+            composeNotesForBatchConversion(ENML_BENCHMARK_NUM_NOTES);
+
+        QBENCHMARK
+        {
+            QVector<QStringList> listsOfWords;
+            QVector<ErrorString> errorDescriptions;
+            bool res = ENMLConverter::noteContentToListOfWords(
+                notes, listsOfWords, errorDescriptions);
+            QVERIFY2(res == true, "Batch conversion to lists of words failed");
+        }
+    }
+    CATCH_EXCEPTION();
+}
+
+void ENMLTester::benchmarkHtmlToNoteContentComplexNotes()
+{
+    try {
+        QStringList htmls;
+        QString error;
+        bool res = composeComplexNotesHtml(htmls, error);
+        QVERIFY2(res == true, qPrintable(error));
+
+        ENMLConverter converter;
+        DecryptedTextManager decryptedTextManager;
+
+        QBENCHMARK
+        {
+            for (const auto & html: qAsConst(htmls)) {
+                QString noteContent;
+                ErrorString errorDescription;
+                res = converter.htmlToNoteContent(
+                    html, noteContent, decryptedTextManager,
+                    errorDescription);
+                QVERIFY2(
+                    res == true,
+                    qPrintable(errorDescription.nonLocalizedString()));
+            }
+        }
+    }
+    CATCH_EXCEPTION();
+}
+
 void ENMLTester::enexExportImportSingleSimpleNoteTest()
 {
     try {
@@ -45,6 +45,13 @@ private Q_SLOTS:
     void enmlConverterComplexTest4();
     void enmlConverterHtmlWithTableHelperTags();
     void enmlConverterHtmlWithTableAndHilitorHelperTags();
+    void enmlConverterBatchConversionToPlainTextAndListsOfWords();
+    void enmlConverterBatchValidationAndFixup();
+    void enmlConverterStaticStringSetTest();
+
+    void benchmarkNoteContentToListOfWordsOneByOne();
+    void benchmarkNoteContentToListOfWordsInBatch();
+    void benchmarkHtmlToNoteContentComplexNotes();
 
     void enexExportImportSingleSimpleNoteTest();
     void enexExportImportSingleNoteWithTagsTest();
@@ -25,6 +25,7 @@
 #include "NoteLocalStorageManagerAsyncTester.h"
 #include "NoteNotebookAndTagListTrackingAsyncTester.h"
 #include "NotebookLocalStorageManagerAsyncTester.h"
+#include "RequestTracingLocalStorageManagerAsyncTester.h"
 #include "ResourceLocalStorageManagerAsyncTester.h"
 #include "SavedSearchLocalStorageManagerAsyncTester.h"
 #include "TagLocalStorageManagerAsyncTester.h"
@@ -471,5 +472,53 @@ void TestCacheAsync()
     }
 }
 
+void TestRequestTracingAsync()
+{
+    EventLoopWithExitStatus::ExitStatus status =
+        EventLoopWithExitStatus::ExitStatus::Failure;
+    {
+        QTimer timer;
+        timer.setInterval(MAX_ALLOWED_TEST_DURATION_MSEC);
+        timer.setSingleShot(true);
+
+        RequestTracingLocalStorageManagerAsyncTester requestTracingAsyncTester;
+        EventLoopWithExitStatus loop;
+
+        QObject::connect(
+            &timer, &QTimer::timeout, &loop,
+            &EventLoopWithExitStatus::exitAsTimeout);
+
+        QObject::connect(
+            &requestTracingAsyncTester,
+            &RequestTracingLocalStorageManagerAsyncTester::success, &loop,
+            &EventLoopWithExitStatus::exitAsSuccess);
+
+        QObject::connect(
+            &requestTracingAsyncTester,
+            &RequestTracingLocalStorageManagerAsyncTester::failure, &loop,
+            &EventLoopWithExitStatus::exitAsFailureWithError);
+
+        QTimer slotInvokingTimer;
+        slotInvokingTimer.setInterval(500);
+        slotInvokingTimer.setSingleShot(true);
+
+        timer.start();
+        slotInvokingTimer.singleShot(
+            0, &requestTracingAsyncTester, SLOT(onInitTestCase()));
+
+        Q_UNUSED(loop.exec())
+        status = loop.exitStatus();
+    }
+
+    if (status == EventLoopWithExitStatus::ExitStatus::Failure) {
+        QFAIL(
+            "Detected failure during the asynchronous loop processing in "
+            "request tracing async tester");
+    }
+    else if (status == EventLoopWithExitStatus::ExitStatus::Timeout) {
+        QFAIL("Request tracing async tester failed to finish in time");
+    }
+}
+
 } // namespace test
 } // namespace quentier
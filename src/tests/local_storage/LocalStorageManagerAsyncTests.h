@@ -40,6 +40,8 @@ void TestNoteNotebookAndTagListTrackingAsync();
 
 void TestCacheAsync();
 
+void TestRequestTracingAsync();
+
 } // namespace test
 } // namespace quentier
 
@@ -21,6 +21,7 @@
 #include "../TestMacros.h"
 
 #include <quentier/local_storage/LocalStorageManager.h>
+#include <quentier/local_storage/LocalStorageManagerAsync.h>
 #include <quentier/types/LinkedNotebook.h>
 #include <quentier/types/Note.h>
 #include <quentier/types/Notebook.h>
@@ -29,11 +30,15 @@
 #include <quentier/types/SharedNotebook.h>
 #include <quentier/types/Tag.h>
 #include <quentier/types/User.h>
+#include <quentier/utility/Compat.h>
 #include <quentier/utility/UidGenerator.h>
 
 #include <QCryptographicHash>
+#include <QRegularExpression>
+#include <QStringList>
 #include <QTest>
 
+#include <functional>
 #include <string>
 
 namespace quentier {
@@ -3624,5 +3629,809 @@ void TestNoteTagIdsComplementWhenAddingAndUpdatingNote()
             "LocalStorageManager::updateNote method returning")));
 }
 
+void TestSwitchingBetweenAccountsInLocalStorage()
+{
+    LocalStorageManager::StartupOptions startupOptions(
+        LocalStorageManager::StartupOption::ClearDatabase);
+
+    Account firstAccount(
+        QStringLiteral("LocalStorageManagerSwitchUserTestFirstFakeUser"),
+        Account::Type::Local);
+
+    Account secondAccount(
+        QStringLiteral("LocalStorageManagerSwitchUserTestSecondFakeUser"),
+        Account::Type::Local);
+
+    LocalStorageManager localStorageManager(firstAccount, startupOptions);
+
+    Notebook notebook;
+    notebook.setName(QStringLiteral("First account notebook"));
+
+    ErrorString errorMessage;
+    QVERIFY2(
+        localStorageManager.addNotebook(notebook, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    localStorageManager.switchUser(secondAccount, startupOptions);
+
+    errorMessage.clear();
+    int count = localStorageManager.notebookCount(errorMessage);
+    QVERIFY2(count == 0, qPrintable(errorMessage.nonLocalizedString()));
+
+    // Switching back to the first account goes through the fast path as
+    // the schema of its database has already been initialized
+    localStorageManager.switchUser(firstAccount);
+
+    errorMessage.clear();
+    count = localStorageManager.notebookCount(errorMessage);
+    QVERIFY2(count == 1, qPrintable(errorMessage.nonLocalizedString()));
+
+    Notebook foundNotebook;
+    foundNotebook.setLocalUid(notebook.localUid());
+
+    errorMessage.clear();
+    QVERIFY2(
+        localStorageManager.findNotebook(foundNotebook, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY2(
+        foundNotebook == notebook,
+        qPrintable(QStringLiteral(
+            "Notebook found in the local storage after switching accounts "
+            "back and forth doesn't match the original one")));
+}
+
+void TestIncrementalVacuumInLocalStorage()
+{
+    LocalStorageManager::StartupOptions startupOptions(
+        LocalStorageManager::StartupOption::ClearDatabase);
+
+    Account account(
+        QStringLiteral("LocalStorageManagerIncrementalVacuumTestFakeUser"),
+        Account::Type::Local);
+
+    LocalStorageManager localStorageManager(account, startupOptions);
+
+    Notebook notebook;
+    notebook.setName(QStringLiteral("Notebook"));
+
+    ErrorString errorMessage;
+    QVERIFY2(
+        localStorageManager.addNotebook(notebook, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QString content = QStringLiteral("<en-note>") +
+        QString(16384, QChar::fromLatin1('a')) + QStringLiteral("</en-note>");
+
+    QList<Note> notes;
+    for (int i = 0; i < 50; ++i) {
+        Note note;
+        note.setNotebookLocalUid(notebook.localUid());
+        note.setTitle(QStringLiteral("Note #") + QString::number(i));
+        note.setContent(content);
+
+        errorMessage.clear();
+        QVERIFY2(
+            localStorageManager.addNote(note, errorMessage),
+            qPrintable(errorMessage.nonLocalizedString()));
+
+        notes << note;
+    }
+
+    for (auto & note: notes) {
+        errorMessage.clear();
+        QVERIFY2(
+            localStorageManager.expungeNote(note, errorMessage),
+            qPrintable(errorMessage.nonLocalizedString()));
+    }
+
+    qint64 pageSize = 0;
+    qint64 pageCount = 0;
+    qint64 freePageCount = 0;
+
+    errorMessage.clear();
+    QVERIFY2(
+        localStorageManager.databaseFragmentationStatistics(
+            pageSize, pageCount, freePageCount, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY2(
+        freePageCount > 0,
+        qPrintable(QStringLiteral(
+            "Expected free pages in the database after expunging notes")));
+
+    errorMessage.clear();
+    int numReclaimedPages = localStorageManager.incrementalVacuum(
+        static_cast<int>(freePageCount), errorMessage);
+
+    QVERIFY2(
+        numReclaimedPages == static_cast<int>(freePageCount),
+        qPrintable(
+            QStringLiteral("Unexpected number of reclaimed pages: ") +
+            QString::number(numReclaimedPages) + QStringLiteral(", error: ") +
+            errorMessage.nonLocalizedString()));
+
+    qint64 updatedPageCount = 0;
+    qint64 updatedFreePageCount = 0;
+
+    errorMessage.clear();
+    QVERIFY2(
+        localStorageManager.databaseFragmentationStatistics(
+            pageSize, updatedPageCount, updatedFreePageCount, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY2(
+        updatedFreePageCount == 0,
+        qPrintable(QStringLiteral(
+            "Expected no free pages in the database after incremental "
+            "vacuum")));
+
+    QVERIFY2(
+        updatedPageCount == pageCount - numReclaimedPages,
+        qPrintable(QStringLiteral(
+            "Database page count was not reduced by incremental vacuum")));
+
+    errorMessage.clear();
+    QVERIFY2(
+        localStorageManager.checkpointWriteAheadLog(errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY2(
+        localStorageManager.writeAheadLogFileSize() == 0,
+        qPrintable(QStringLiteral(
+            "Write-ahead log file is not empty after checkpoint")));
+}
+
+void TestListingQueryPlansUseIndexesInLocalStorage()
+{
+    LocalStorageManager::StartupOptions startupOptions(
+        LocalStorageManager::StartupOption::ClearDatabase);
+
+    Account account(
+        QStringLiteral("LocalStorageManagerQueryPlansTestFakeUser"),
+        Account::Type::Local);
+
+    // The slots are called directly so the requests are processed right
+    // within this thread; with zero slow query threshold each SQL statement
+    // executed while processing a request is logged along with its query
+    // plan so the plans of the actual statements can be checked
+    LocalStorageManagerAsync localStorageManagerAsync(account, startupOptions);
+    localStorageManagerAsync.setRequestTracingEnabled(true);
+    localStorageManagerAsync.setSlowQueryThresholdMsec(0);
+    localStorageManagerAsync.init();
+
+    auto * pLocalStorageManagerAsync = &localStorageManagerAsync;
+
+    const LocalStorageManager::ListObjectsOptions dirtyFlag(
+        LocalStorageManager::ListObjectsOption::ListDirty |
+        LocalStorageManager::ListObjectsOption::ListNonLocal);
+
+    const LocalStorageManager::ListObjectsOptions listAllFlag(
+        LocalStorageManager::ListObjectsOption::ListAll);
+
+    const LocalStorageManager::GetNoteOptions getNoteOptions;
+
+    const LocalStorageManager::NoteCountOptions noteCountOptions(
+        LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes);
+
+    Notebook notebookWithGuid;
+    notebookWithGuid.setGuid(
+        QStringLiteral("00000000-0000-0000-c000-000000000047"));
+
+    Tag tagWithGuid;
+    tagWithGuid.setGuid(QStringLiteral("00000000-0000-0000-c000-000000000048"));
+
+    struct QueryPlanExpectation
+    {
+        QString m_table;
+        bool m_ordered;
+        std::function<void()> m_sendRequest;
+    };
+
+    const auto listNotesSender =
+        [=](const LocalStorageManager::ListObjectsOptions flag,
+            const LocalStorageManager::ListNotesOrder order,
+            const LocalStorageManager::OrderDirection orderDirection,
+            const size_t limit) {
+            return [=] {
+                pLocalStorageManagerAsync->onListNotesRequest(
+                    flag, getNoteOptions, limit, 0, order, orderDirection,
+                    QString(), QUuid::createUuid());
+            };
+        };
+
+    const QueryPlanExpectation expectations[] = {
+        {QStringLiteral("Notes"), true,
+         listNotesSender(
+             listAllFlag, LocalStorageManager::ListNotesOrder::ByTitle,
+             LocalStorageManager::OrderDirection::Ascending, 50)},
+        {QStringLiteral("Notes"), true,
+         listNotesSender(
+             listAllFlag,
+             LocalStorageManager::ListNotesOrder::ByCreationTimestamp,
+             LocalStorageManager::OrderDirection::Descending, 50)},
+        {QStringLiteral("Notes"), true,
+         listNotesSender(
+             listAllFlag,
+             LocalStorageManager::ListNotesOrder::ByModificationTimestamp,
+             LocalStorageManager::OrderDirection::Descending, 50)},
+        {QStringLiteral("Notes"), false,
+         listNotesSender(
+             dirtyFlag, LocalStorageManager::ListNotesOrder::NoOrder,
+             LocalStorageManager::OrderDirection::Ascending, 0)},
+        {QStringLiteral("Notebooks"), false,
+         [=] {
+             pLocalStorageManagerAsync->onListNotebooksRequest(
+                 dirtyFlag, 0, 0,
+                 LocalStorageManager::ListNotebooksOrder::NoOrder,
+                 LocalStorageManager::OrderDirection::Ascending, QString(),
+                 QUuid::createUuid());
+         }},
+        {QStringLiteral("Tags"), false,
+         [=] {
+             pLocalStorageManagerAsync->onListTagsRequest(
+                 dirtyFlag, 0, 0, LocalStorageManager::ListTagsOrder::NoOrder,
+                 LocalStorageManager::OrderDirection::Ascending, QString(),
+                 QUuid::createUuid());
+         }},
+        {QStringLiteral("SavedSearches"), false,
+         [=] {
+             pLocalStorageManagerAsync->onListSavedSearchesRequest(
+                 dirtyFlag, 0, 0,
+                 LocalStorageManager::ListSavedSearchesOrder::NoOrder,
+                 LocalStorageManager::OrderDirection::Ascending,
+                 QUuid::createUuid());
+         }},
+        {QStringLiteral("LinkedNotebooks"), false,
+         [=] {
+             pLocalStorageManagerAsync->onListLinkedNotebooksRequest(
+                 dirtyFlag, 0, 0,
+                 LocalStorageManager::ListLinkedNotebooksOrder::NoOrder,
+                 LocalStorageManager::OrderDirection::Ascending,
+                 QUuid::createUuid());
+         }},
+        // Note counts per notebook and per tag are read from counter tables
+        // by primary key, either directly or via the guid of the notebook or
+        // tag
+        {QStringLiteral("NotebookNoteCounts"), false,
+         [=] {
+             pLocalStorageManagerAsync->onGetNoteCountPerNotebookRequest(
+                 Notebook(), noteCountOptions, QUuid::createUuid());
+         }},
+        {QStringLiteral("NotebookNoteCounts"), false,
+         [=] {
+             pLocalStorageManagerAsync->onGetNoteCountPerNotebookRequest(
+                 notebookWithGuid, noteCountOptions, QUuid::createUuid());
+         }},
+        {QStringLiteral("TagNoteCounts"), false,
+         [=] {
+             pLocalStorageManagerAsync->onGetNoteCountPerTagRequest(
+                 Tag(), noteCountOptions, QUuid::createUuid());
+         }},
+        {QStringLiteral("TagNoteCounts"), false,
+         [=] {
+             pLocalStorageManagerAsync->onGetNoteCountPerTagRequest(
+                 tagWithGuid, noteCountOptions, QUuid::createUuid());
+         }}};
+
+    for (const auto & expectation: expectations) {
+        localStorageManagerAsync.clearRequestTrace();
+        expectation.m_sendRequest();
+
+        const auto snapshot = localStorageManagerAsync.requestTraceSnapshot();
+
+        // The table is accessed either as "SCAN Table" or "SEARCH Table",
+        // older SQLite versions also put "TABLE" word before table name
+        const QRegularExpression tableAccessRegex(
+            QStringLiteral("^(SCAN|SEARCH)( TABLE)? ") + expectation.m_table +
+            QStringLiteral("( |$)"));
+
+        bool foundTableAccess = false;
+        QStringList statements;
+        for (const auto & slowQuery: qAsConst(snapshot.m_slowQueries)) {
+            statements << slowQuery.m_statement;
+
+            const QStringList planDetails =
+                slowQuery.m_queryPlan.split(QStringLiteral("\n"));
+
+            for (const auto & detail: planDetails) {
+                if (expectation.m_ordered &&
+                    slowQuery.m_statement.contains(
+                        QStringLiteral(" ORDER BY ")) &&
+                    detail.contains(QStringLiteral("TEMP B-TREE")))
+                {
+                    QFAIL(qPrintable(
+                        QStringLiteral("Query sorts the results without "
+                                       "an index: ") +
+                        slowQuery.m_statement));
+                }
+
+                if (!tableAccessRegex.match(detail).hasMatch()) {
+                    continue;
+                }
+
+                foundTableAccess = true;
+
+                if (!detail.contains(QStringLiteral(" INDEX ")) &&
+                    !detail.contains(QStringLiteral("PRIMARY KEY")))
+                {
+                    QFAIL(qPrintable(
+                        QStringLiteral("Query scans the whole table ") +
+                        expectation.m_table + QStringLiteral(": ") +
+                        slowQuery.m_statement + QStringLiteral("\nPlan: ") +
+                        planDetails.join(QStringLiteral("; "))));
+                }
+
+                if (detail.contains(QStringLiteral("AUTOMATIC"))) {
+                    QFAIL(qPrintable(
+                        QStringLiteral("Query relies on automatic index: ") +
+                        slowQuery.m_statement));
+                }
+            }
+        }
+
+        QVERIFY2(
+            foundTableAccess,
+            qPrintable(
+                QStringLiteral("No access to table ") + expectation.m_table +
+                QStringLiteral(" found within the query plans of "
+                               "statements: ") +
+                statements.join(QStringLiteral("; "))));
+    }
+}
+
+void TestNoteCountersInLocalStorage()
+{
+    LocalStorageManager::StartupOptions startupOptions(
+        LocalStorageManager::StartupOption::ClearDatabase);
+
+    Account account(
+        QStringLiteral("LocalStorageManagerNoteCountersTestFakeUser"),
+        Account::Type::Evernote, 0);
+
+    LocalStorageManager localStorageManager(account, startupOptions);
+
+    ErrorString errorMessage;
+
+    Notebook firstNotebook;
+    firstNotebook.setGuid(UidGenerator::Generate());
+    firstNotebook.setName(QStringLiteral("First notebook"));
+
+    QVERIFY2(
+        localStorageManager.addNotebook(firstNotebook, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    Notebook secondNotebook;
+    secondNotebook.setName(QStringLiteral("Second notebook"));
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.addNotebook(secondNotebook, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    Tag firstTag;
+    firstTag.setGuid(UidGenerator::Generate());
+    firstTag.setName(QStringLiteral("First"));
+
+    Tag secondTag;
+    secondTag.setName(QStringLiteral("Second"));
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.addTag(firstTag, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.addTag(secondTag, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    // Counts read from note counters are compared with the ones computed
+    // from notes by noteCountPerNotebooksAndTags
+    const LocalStorageManager::NoteCountOptions optionsList[] = {
+        LocalStorageManager::NoteCountOptions(
+            LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes),
+        LocalStorageManager::NoteCountOptions(
+            LocalStorageManager::NoteCountOption::IncludeDeletedNotes),
+        LocalStorageManager::NoteCountOptions(
+            LocalStorageManager::NoteCountOption::IncludeNonDeletedNotes) |
+            LocalStorageManager::NoteCountOption::IncludeDeletedNotes};
+
+    auto countsMatch = [&](QString & mismatch) -> bool {
+        for (const auto options: optionsList) {
+            for (const auto * pNotebook: {&firstNotebook, &secondNotebook}) {
+                ErrorString error;
+                int count = localStorageManager.noteCountPerNotebook(
+                    *pNotebook, error, options);
+
+                int expectedCount =
+                    localStorageManager.noteCountPerNotebooksAndTags(
+                        QStringList() << pNotebook->localUid(), QStringList(),
+                        error, options);
+
+                if (count != expectedCount) {
+                    mismatch = QString::fromUtf8(
+                                   "note count for notebook %1 with options "
+                                   "%2: expected %3, got %4")
+                                   .arg(pNotebook->name())
+                                   .arg(static_cast<int>(options))
+                                   .arg(expectedCount)
+                                   .arg(count);
+                    return false;
+                }
+            }
+
+            QHash<QString, int> noteCountsPerTagLocalUid;
+            ErrorString error;
+            if (!localStorageManager.noteCountsPerAllTags(
+                    noteCountsPerTagLocalUid, error, options))
+            {
+                mismatch = error.nonLocalizedString();
+                return false;
+            }
+
+            for (const auto * pTag: {&firstTag, &secondTag}) {
+                int count =
+                    localStorageManager.noteCountPerTag(*pTag, error, options);
+
+                int expectedCount =
+                    localStorageManager.noteCountPerNotebooksAndTags(
+                        QStringList(), QStringList() << pTag->localUid(),
+                        error, options);
+
+                int countFromAllTags =
+                    noteCountsPerTagLocalUid.value(pTag->localUid(), 0);
+
+                if ((count != expectedCount) ||
+                    (countFromAllTags != expectedCount))
+                {
+                    mismatch = QString::fromUtf8(
+                                   "note count for tag %1 with options %2: "
+                                   "expected %3, got %4 and %5 from counts "
+                                   "per all tags")
+                                   .arg(pTag->name())
+                                   .arg(static_cast<int>(options))
+                                   .arg(expectedCount)
+                                   .arg(count)
+                                   .arg(countFromAllTags);
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    };
+
+    QString mismatch;
+
+    Note firstNote;
+    firstNote.setNotebookGuid(firstNotebook.guid());
+    firstNote.setNotebookLocalUid(firstNotebook.localUid());
+    firstNote.setTitle(QStringLiteral("First note"));
+    firstNote.addTagLocalUid(firstTag.localUid());
+    firstNote.addTagLocalUid(secondTag.localUid());
+
+    Note secondNote;
+    secondNote.setNotebookGuid(firstNotebook.guid());
+    secondNote.setNotebookLocalUid(firstNotebook.localUid());
+    secondNote.setTitle(QStringLiteral("Second note"));
+    secondNote.addTagLocalUid(firstTag.localUid());
+
+    Note thirdNote;
+    thirdNote.setNotebookLocalUid(secondNotebook.localUid());
+    thirdNote.setTitle(QStringLiteral("Third note"));
+    thirdNote.setDeletionTimestamp(1);
+    thirdNote.addTagLocalUid(secondTag.localUid());
+
+    for (auto * pNote: {&firstNote, &secondNote, &thirdNote}) {
+        errorMessage.clear();
+
+        QVERIFY2(
+            localStorageManager.addNote(*pNote, errorMessage),
+            qPrintable(errorMessage.nonLocalizedString()));
+    }
+
+    QVERIFY2(countsMatch(mismatch), qPrintable(mismatch));
+
+    // Move the note to another notebook and mark it as deleted
+    secondNote.setNotebookGuid(QString());
+    secondNote.setNotebookLocalUid(secondNotebook.localUid());
+    secondNote.setDeletionTimestamp(2);
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.updateNote(
+            secondNote, LocalStorageManager::UpdateNoteOptions(),
+            errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY2(countsMatch(mismatch), qPrintable(mismatch));
+
+    // Change the tags of the note
+    firstNote.setTagGuids(QStringList());
+    firstNote.setTagLocalUids(QStringList() << secondTag.localUid());
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.updateNote(
+            firstNote,
+            LocalStorageManager::UpdateNoteOptions(
+                LocalStorageManager::UpdateNoteOption::UpdateTags),
+            errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY2(countsMatch(mismatch), qPrintable(mismatch));
+
+    // Expunge the note and the tag
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.expungeNote(thirdNote, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY2(countsMatch(mismatch), qPrintable(mismatch));
+
+    QStringList expungedChildTagLocalUids;
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.expungeTag(
+            secondTag, expungedChildTagLocalUids, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY2(
+        localStorageManager.noteCountPerTag(secondTag, errorMessage) == 0,
+        qPrintable(QStringLiteral("Non-zero note count for expunged tag")));
+}
+
+void TestGuidIndexInLocalStorage()
+{
+    LocalStorageManager::StartupOptions startupOptions(
+        LocalStorageManager::StartupOption::ClearDatabase);
+
+    Account account(
+        QStringLiteral("LocalStorageManagerGuidIndexTestFakeUser"),
+        Account::Type::Evernote, 0);
+
+    LocalStorageManager localStorageManager(account, startupOptions);
+
+    ErrorString errorMessage;
+
+    using GuidIndexEntries =
+        QHash<QString, LocalStorageManager::GuidIndexEntry>;
+
+    auto checkEntry = [](const GuidIndexEntries & entries,
+                         const INoteStoreDataElement & item,
+                         QString & mismatch) -> bool {
+        auto it = entries.constFind(item.guid());
+        if (it == entries.constEnd()) {
+            mismatch = QStringLiteral("No guid index entry for guid ") +
+                item.guid();
+            return false;
+        }
+
+        const auto & entry = it.value();
+        if (entry.m_localUid != item.localUid()) {
+            mismatch = QStringLiteral("Wrong local uid in guid index entry: ") +
+                entry.m_localUid + QStringLiteral(", expected ") +
+                item.localUid();
+            return false;
+        }
+
+        if (entry.m_updateSequenceNumber != item.updateSequenceNumber()) {
+            mismatch = QStringLiteral("Wrong USN in guid index entry: ") +
+                QString::number(entry.m_updateSequenceNumber) +
+                QStringLiteral(", expected ") +
+                QString::number(item.updateSequenceNumber());
+            return false;
+        }
+
+        if (entry.m_isDirty != item.isDirty()) {
+            mismatch = QStringLiteral("Wrong dirty flag in guid index entry");
+            return false;
+        }
+
+        return true;
+    };
+
+    // 1) Add items with guids and some items without guids
+
+    Notebook notebook;
+    notebook.setGuid(UidGenerator::Generate());
+    notebook.setUpdateSequenceNumber(1);
+    notebook.setName(QStringLiteral("Notebook"));
+    notebook.setDirty(false);
+
+    QVERIFY2(
+        localStorageManager.addNotebook(notebook, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    Notebook localNotebook;
+    localNotebook.setName(QStringLiteral("Local notebook"));
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.addNotebook(localNotebook, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    Tag tag;
+    tag.setGuid(UidGenerator::Generate());
+    tag.setUpdateSequenceNumber(2);
+    tag.setName(QStringLiteral("Tag"));
+    tag.setDirty(true);
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.addTag(tag, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    SavedSearch search;
+    search.setGuid(UidGenerator::Generate());
+    search.setUpdateSequenceNumber(3);
+    search.setName(QStringLiteral("Saved search"));
+    search.setQuery(QStringLiteral("Saved search query"));
+    search.setDirty(false);
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.addSavedSearch(search, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    Note note;
+    note.setGuid(UidGenerator::Generate());
+    note.setUpdateSequenceNumber(4);
+    note.setTitle(QStringLiteral("Note"));
+    note.setNotebookGuid(notebook.guid());
+    note.setNotebookLocalUid(notebook.localUid());
+    note.setDirty(false);
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.addNote(note, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    Note localNote;
+    localNote.setTitle(QStringLiteral("Local note"));
+    localNote.setNotebookLocalUid(localNotebook.localUid());
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.addNote(localNote, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    LocalStorageManager::GuidIndex index;
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.guidIndex(index, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    // Items without guids are not included into the index
+    QCOMPARE(index.m_notebooks.size(), 1);
+    QCOMPARE(index.m_tags.size(), 1);
+    QCOMPARE(index.m_savedSearches.size(), 1);
+    QCOMPARE(index.m_notes.size(), 1);
+
+    QString mismatch;
+
+    QVERIFY2(
+        checkEntry(index.m_notebooks, notebook, mismatch),
+        qPrintable(mismatch));
+
+    QVERIFY2(checkEntry(index.m_tags, tag, mismatch), qPrintable(mismatch));
+
+    QVERIFY2(
+        checkEntry(index.m_savedSearches, search, mismatch),
+        qPrintable(mismatch));
+
+    QVERIFY2(checkEntry(index.m_notes, note, mismatch), qPrintable(mismatch));
+
+    // 2) Update items: change their USNs and dirty flags
+
+    notebook.setUpdateSequenceNumber(5);
+    notebook.setDirty(true);
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.updateNotebook(notebook, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    tag.setUpdateSequenceNumber(6);
+    tag.setDirty(false);
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.updateTag(tag, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    search.setUpdateSequenceNumber(7);
+    search.setDirty(true);
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.updateSavedSearch(search, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    note.setUpdateSequenceNumber(8);
+    note.setDirty(true);
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.updateNote(
+            note, LocalStorageManager::UpdateNoteOptions(), errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.guidIndex(index, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY2(
+        checkEntry(index.m_notebooks, notebook, mismatch),
+        qPrintable(mismatch));
+
+    QVERIFY2(checkEntry(index.m_tags, tag, mismatch), qPrintable(mismatch));
+
+    QVERIFY2(
+        checkEntry(index.m_savedSearches, search, mismatch),
+        qPrintable(mismatch));
+
+    QVERIFY2(checkEntry(index.m_notes, note, mismatch), qPrintable(mismatch));
+
+    // 3) Expunge items, the index should no longer contain them
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.expungeNote(note, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.expungeSavedSearch(search, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QStringList expungedChildTagLocalUids;
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.expungeTag(
+            tag, expungedChildTagLocalUids, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.expungeNotebook(notebook, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    errorMessage.clear();
+
+    QVERIFY2(
+        localStorageManager.guidIndex(index, errorMessage),
+        qPrintable(errorMessage.nonLocalizedString()));
+
+    QVERIFY(index.m_notebooks.isEmpty());
+    QVERIFY(index.m_tags.isEmpty());
+    QVERIFY(index.m_savedSearches.isEmpty());
+    QVERIFY(index.m_notes.isEmpty());
+}
+
 } // namespace test
 } // namespace quentier
@@ -50,6 +50,16 @@ void TestAddingNoteWithoutLocalUid();
 
 void TestNoteTagIdsComplementWhenAddingAndUpdatingNote();
 
+void TestSwitchingBetweenAccountsInLocalStorage();
+
+void TestIncrementalVacuumInLocalStorage();
+
+void TestListingQueryPlansUseIndexesInLocalStorage();
+
+void TestNoteCountersInLocalStorage();
+
+void TestGuidIndexInLocalStorage();
+
 } // namespace test
 } // namespace quentier
 
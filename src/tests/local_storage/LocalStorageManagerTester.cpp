@@ -22,8 +22,11 @@
 #include "LocalStorageManagerBasicTests.h"
 #include "LocalStorageManagerListTests.h"
 #include "LocalStorageManagerNoteSearchQueryTest.h"
+#include "LocalStoragePatchesTests.h"
 #include "NoteSearchQueryParsingTest.h"
 
+#include <quentier/local_storage/LocalStorageManager.h>
+#include <quentier/types/Account.h>
 #include <quentier/types/RegisterMetatypes.h>
 #include <quentier/utility/SysInfo.h>
 
@@ -203,6 +206,108 @@ void LocalStorageManagerTester::localStorageManagerNoteTagIdsComplementTest()
     CATCH_EXCEPTION();
 }
 
+void LocalStorageManagerTester::localStorageManagerSwitchUserTest()
+{
+    try {
+        TestSwitchingBetweenAccountsInLocalStorage();
+    }
+    CATCH_EXCEPTION();
+}
+
+void LocalStorageManagerTester::benchmarkLocalStorageManagerSwitchUser()
+{
+    try {
+        LocalStorageManager::StartupOptions startupOptions(
+            LocalStorageManager::StartupOption::ClearDatabase);
+
+        Account firstAccount(
+            QStringLiteral("LocalStorageManagerSwitchUserBenchmarkFirstUser"),
+            Account::Type::Local);
+
+        Account secondAccount(
+            QStringLiteral("LocalStorageManagerSwitchUserBenchmarkSecondUser"),
+            Account::Type::Local);
+
+        // Initialize databases for both accounts before the measurements
+        LocalStorageManager localStorageManager(firstAccount, startupOptions);
+        localStorageManager.switchUser(secondAccount, startupOptions);
+
+        QBENCHMARK
+        {
+            localStorageManager.switchUser(firstAccount);
+            localStorageManager.switchUser(secondAccount);
+        }
+    }
+    CATCH_EXCEPTION();
+}
+
+void LocalStorageManagerTester::localStorageManagerIncrementalVacuumTest()
+{
+    try {
+        TestIncrementalVacuumInLocalStorage();
+    }
+    CATCH_EXCEPTION();
+}
+
+void LocalStorageManagerTester::localStorageManagerListingQueryPlansTest()
+{
+    try {
+        TestListingQueryPlansUseIndexesInLocalStorage();
+    }
+    CATCH_EXCEPTION();
+}
+
+void LocalStorageManagerTester::localStorageManagerNoteCountersTest()
+{
+    try {
+        TestNoteCountersInLocalStorage();
+    }
+    CATCH_EXCEPTION();
+}
+
+void LocalStorageManagerTester::localStorageManagerGuidIndexTest()
+{
+    try {
+        TestGuidIndexInLocalStorage();
+    }
+    CATCH_EXCEPTION();
+}
+
+void LocalStorageManagerTester::localStoragePatch1To2PreservesResourceDataTest()
+{
+    try {
+        TestLocalStoragePatch1To2PreservesResourceData();
+    }
+    CATCH_EXCEPTION();
+}
+
+void LocalStorageManagerTester::
+    localStoragePatch1To2ResumesAfterInterruptedBatchTest()
+{
+    try {
+        TestLocalStoragePatch1To2ResumesAfterInterruptedBatch();
+    }
+    CATCH_EXCEPTION();
+}
+
+void LocalStorageManagerTester::
+    localStoragePatch1To2HonoursLegacyUpgradeStateTest()
+{
+    try {
+        TestLocalStoragePatch1To2HonoursLegacyUpgradeState();
+    }
+    CATCH_EXCEPTION();
+}
+
+void LocalStorageManagerTester::
+    localStoragePatch1To2ResumesAfterFailedFinalizeTest()
+{
+    try {
+        TestLocalStoragePatch1To2ResumesAfterFailedFinalize();
+    }
+    CATCH_EXCEPTION();
+}
+
 void LocalStorageManagerTester::localStorageManagerListSavedSearchesTest()
 {
     try {
@@ -342,6 +447,14 @@ void LocalStorageManagerTester::
     CATCH_EXCEPTION();
 }
 
+void LocalStorageManagerTester::localStorageManagerAsyncRequestTracingTest()
+{
+    try {
+        TestRequestTracingAsync();
+    }
+    CATCH_EXCEPTION();
+}
+
 void LocalStorageManagerTester::localStorageCacheManagerTest()
 {
     try {
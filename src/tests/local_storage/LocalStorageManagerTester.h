@@ -52,6 +52,17 @@ private Q_SLOTS:
     void localStorageManagerAccountHighUsnTest();
     void localStorageManagerAddNoteWithoutLocalUidTest();
     void localStorageManagerNoteTagIdsComplementTest();
+    void localStorageManagerSwitchUserTest();
+    void benchmarkLocalStorageManagerSwitchUser();
+    void localStorageManagerIncrementalVacuumTest();
+    void localStorageManagerListingQueryPlansTest();
+    void localStorageManagerNoteCountersTest();
+    void localStorageManagerGuidIndexTest();
+
+    void localStoragePatch1To2PreservesResourceDataTest();
+    void localStoragePatch1To2ResumesAfterInterruptedBatchTest();
+    void localStoragePatch1To2HonoursLegacyUpgradeStateTest();
+    void localStoragePatch1To2ResumesAfterFailedFinalizeTest();
 
     void localStorageManagerListSavedSearchesTest();
     void localStorageManagerListLinkedNotebooksTest();
@@ -72,6 +83,7 @@ private Q_SLOTS:
     void localStorageManagerAsyncNotesTest();
     void localStorageManagerAsyncResourceTest();
     void localStorageManagerAsyncNoteNotebookAndTagListTrackingTest();
+    void localStorageManagerAsyncRequestTracingTest();
 
     void localStorageCacheManagerTest();
 };
@@ -0,0 +1,906 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LocalStoragePatchesTests.h"
+
+#include <quentier/local_storage/ILocalStoragePatch.h>
+#include <quentier/local_storage/LocalStorageManager.h>
+#include <quentier/types/Account.h>
+#include <quentier/types/ErrorString.h>
+#include <quentier/types/Note.h>
+#include <quentier/types/Notebook.h>
+#include <quentier/types/Resource.h>
+#include <quentier/utility/ApplicationSettings.h>
+#include <quentier/utility/StandardPaths.h>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QTest>
+#include <QUuid>
+
+#include <algorithm>
+#include <memory>
+
+#define PATCHES_TEST_NUM_NOTES (10)
+#define PATCHES_TEST_NUM_RESOURCES_PER_NOTE (25)
+
+// Must match the number of items LocalStoragePatch1To2 processes within
+// a single batch
+#define PATCHES_TEST_BATCH_SIZE (100)
+
+#define UPGRADE_1_TO_2_PERSISTENCE                                             \
+    QStringLiteral("LocalStorageDatabaseUpgradeFromVersion1ToVersion2")
+
+namespace quentier {
+namespace test {
+
+namespace {
+
+struct ResourceData
+{
+    QString m_noteLocalUid;
+    QByteArray m_dataBody;
+    QByteArray m_alternateDataBody;
+};
+
+using ResourceDataByLocalUid = QHash<QString, ResourceData>;
+
+/**
+ * Connection to the local storage database separate from the one used by
+ * LocalStorageManager; it is used to bring the database into the state
+ * it had before the upgrade and to inspect the results of the upgrade
+ */
+class TestDatabaseConnection
+{
+public:
+    explicit TestDatabaseConnection(const Account & account) :
+        m_connectionName(
+            QStringLiteral("LocalStoragePatchesTest_") +
+            QUuid::createUuid().toString())
+    {
+        m_database = QSqlDatabase::addDatabase(
+            QStringLiteral("QSQLITE"), m_connectionName);
+
+        m_database.setDatabaseName(
+            accountPersistentStoragePath(account) +
+            QStringLiteral("/qn.storage.sqlite"));
+
+        Q_UNUSED(m_database.open())
+    }
+
+    ~TestDatabaseConnection()
+    {
+        m_database.close();
+        m_database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+
+    bool exec(const QString & queryString, QString & error)
+    {
+        QSqlQuery query(m_database);
+        if (!query.exec(queryString)) {
+            error = QStringLiteral("Failed to execute query ") + queryString +
+                QStringLiteral(": ") + query.lastError().text();
+            return false;
+        }
+
+        return true;
+    }
+
+    qint64 count(const QString & queryString, QString & error)
+    {
+        QSqlQuery query(m_database);
+        if (!query.exec(queryString) || !query.next()) {
+            error = QStringLiteral("Failed to execute query ") + queryString +
+                QStringLiteral(": ") + query.lastError().text();
+            return -1;
+        }
+
+        return query.value(0).toLongLong();
+    }
+
+    QSqlDatabase & database()
+    {
+        return m_database;
+    }
+
+private:
+    QString m_connectionName;
+    QSqlDatabase m_database;
+};
+
+Account patchesTestAccount()
+{
+    return Account(
+        QStringLiteral("LocalStoragePatchesTestFakeUser"),
+        Account::Type::Local);
+}
+
+void clearLegacyUpgradeState(const Account & account)
+{
+    ApplicationSettings databaseUpgradeInfo(
+        account, UPGRADE_1_TO_2_PERSISTENCE);
+
+    databaseUpgradeInfo.remove(QString());
+}
+
+QByteArray composeResourceData(const int index, const int salt)
+{
+    // Not really random but includes all byte values, zeros included
+    const int size = 1000 + index * 13;
+    QByteArray data;
+    data.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        data.append(static_cast<char>((index * 31 + i * 7 + salt) & 0xff));
+    }
+
+    return data;
+}
+
+/**
+ * Creates the local storage with notes with resources in its current
+ * version; notes' local uids are returned in the order in which resources
+ * were added to the database
+ */
+bool populateLocalStorage(
+    const Account & account, QStringList & noteLocalUids,
+    ResourceDataByLocalUid & resources, QString & error)
+{
+    LocalStorageManager::StartupOptions startupOptions(
+        LocalStorageManager::StartupOption::ClearDatabase);
+
+    LocalStorageManager localStorageManager(account, startupOptions);
+
+    Notebook notebook;
+    notebook.setName(QStringLiteral("Notebook"));
+
+    ErrorString errorMessage;
+    if (!localStorageManager.addNotebook(notebook, errorMessage)) {
+        error = errorMessage.nonLocalizedString();
+        return false;
+    }
+
+    int resourceIndex = 0;
+    for (int i = 0; i < PATCHES_TEST_NUM_NOTES; ++i) {
+        Note note;
+        note.setNotebookLocalUid(notebook.localUid());
+        note.setTitle(QStringLiteral("Note #") + QString::number(i));
+        note.setContent(QStringLiteral("<en-note><div>Note</div></en-note>"));
+
+        for (int j = 0; j < PATCHES_TEST_NUM_RESOURCES_PER_NOTE; ++j) {
+            Resource resource;
+            resource.setNoteLocalUid(note.localUid());
+            resource.setMime(QStringLiteral("application/octet-stream"));
+
+            ResourceData resourceData;
+            resourceData.m_noteLocalUid = note.localUid();
+            resourceData.m_dataBody = composeResourceData(resourceIndex, 0);
+
+            resource.setDataBody(resourceData.m_dataBody);
+            resource.setDataSize(resourceData.m_dataBody.size());
+            resource.setDataHash(QCryptographicHash::hash(
+                resourceData.m_dataBody, QCryptographicHash::Md5));
+
+            if (resourceIndex % 3 == 0) {
+                resourceData.m_alternateDataBody =
+                    composeResourceData(resourceIndex, 101);
+
+                resource.setAlternateDataBody(
+                    resourceData.m_alternateDataBody);
+
+                resource.setAlternateDataSize(
+                    resourceData.m_alternateDataBody.size());
+
+                resource.setAlternateDataHash(QCryptographicHash::hash(
+                    resourceData.m_alternateDataBody,
+                    QCryptographicHash::Md5));
+            }
+
+            resources[resource.localUid()] = resourceData;
+            note.addResource(resource);
+            ++resourceIndex;
+        }
+
+        errorMessage.clear();
+        if (!localStorageManager.addNote(note, errorMessage)) {
+            error = errorMessage.nonLocalizedString();
+            return false;
+        }
+
+        noteLocalUids << note.localUid();
+    }
+
+    return true;
+}
+
+/**
+ * Brings the local storage database into the shape of version 1 in which
+ * resource data bodies were stored within the Resources table
+ *
+ * @param tableDataPrefix       Prefix prepended to data bodies put into
+ *                              the table, allows to tell whether the data
+ *                              files were rewritten from the table
+ * @param removeDataFiles       Whether the data files written by the current
+ *                              version of local storage should be removed
+ */
+bool downgradeLocalStorageToVersion1(
+    const Account & account, const ResourceDataByLocalUid & resources,
+    const QByteArray & tableDataPrefix, const bool removeDataFiles,
+    QString & error)
+{
+    TestDatabaseConnection connection(account);
+
+    if (!connection.exec(
+            QStringLiteral("ALTER TABLE Resources ADD COLUMN dataBody "
+                           "BLOB DEFAULT NULL"),
+            error) ||
+        !connection.exec(
+            QStringLiteral("ALTER TABLE Resources ADD COLUMN "
+                           "alternateDataBody BLOB DEFAULT NULL"),
+            error))
+    {
+        return false;
+    }
+
+    if (!connection.database().transaction()) {
+        error = QStringLiteral("Failed to begin transaction");
+        return false;
+    }
+
+    for (auto it = resources.constBegin(), end = resources.constEnd();
+         it != end; ++it)
+    {
+        const ResourceData & resourceData = it.value();
+
+        QSqlQuery query(connection.database());
+        bool res = query.prepare(QStringLiteral(
+            "UPDATE Resources SET dataBody = :dataBody, "
+            "alternateDataBody = :alternateDataBody "
+            "WHERE resourceLocalUid = :resourceLocalUid"));
+
+        if (res) {
+            query.bindValue(
+                QStringLiteral(":dataBody"),
+                tableDataPrefix + resourceData.m_dataBody);
+
+            query.bindValue(
+                QStringLiteral(":alternateDataBody"),
+                resourceData.m_alternateDataBody.isEmpty()
+                    ? QVariant()
+                    : QVariant(
+                          tableDataPrefix + resourceData.m_alternateDataBody));
+
+            query.bindValue(QStringLiteral(":resourceLocalUid"), it.key());
+            res = query.exec() && (query.numRowsAffected() == 1);
+        }
+
+        if (!res) {
+            error = QStringLiteral("Failed to put data body into the table: ") +
+                query.lastError().text();
+            return false;
+        }
+    }
+
+    if (!connection.database().commit()) {
+        error = QStringLiteral("Failed to commit transaction");
+        return false;
+    }
+
+    if (!connection.exec(
+            QStringLiteral("UPDATE Auxiliary SET version = 1"), error))
+    {
+        return false;
+    }
+
+    if (removeDataFiles) {
+        const QString storagePath = accountPersistentStoragePath(account);
+
+        if (!QDir(storagePath + QStringLiteral("/Resources/data"))
+                 .removeRecursively() ||
+            !QDir(storagePath + QStringLiteral("/Resources/alternateData"))
+                 .removeRecursively())
+        {
+            error = QStringLiteral("Failed to remove resource data files");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool checkResourceDataFiles(
+    const Account & account, const ResourceDataByLocalUid & resources,
+    const QStringList & noteLocalUids, QString & error)
+{
+    const QString storagePath = accountPersistentStoragePath(account);
+
+    for (auto it = resources.constBegin(), end = resources.constEnd();
+         it != end; ++it)
+    {
+        const ResourceData & resourceData = it.value();
+        if (!noteLocalUids.contains(resourceData.m_noteLocalUid)) {
+            continue;
+        }
+
+        const QString fileName = QStringLiteral("/") +
+            resourceData.m_noteLocalUid + QStringLiteral("/") + it.key() +
+            QStringLiteral(".dat");
+
+        QFile dataFile(storagePath + QStringLiteral("/Resources/data") +
+                       fileName);
+
+        if (!dataFile.open(QIODevice::ReadOnly) ||
+            (dataFile.readAll() != resourceData.m_dataBody))
+        {
+            error = QStringLiteral("Resource data body file doesn't match "
+                                   "the original data body: ") +
+                dataFile.fileName();
+            return false;
+        }
+
+        if (resourceData.m_alternateDataBody.isEmpty()) {
+            continue;
+        }
+
+        QFile alternateDataFile(
+            storagePath + QStringLiteral("/Resources/alternateData") +
+            fileName);
+
+        if (!alternateDataFile.open(QIODevice::ReadOnly) ||
+            (alternateDataFile.readAll() != resourceData.m_alternateDataBody))
+        {
+            error = QStringLiteral("Resource alternate data body file doesn't "
+                                   "match the original alternate data body: ") +
+                alternateDataFile.fileName();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+qint64 numResourcesWithDataInTable(const Account & account, QString & error)
+{
+    TestDatabaseConnection connection(account);
+    return connection.count(
+        QStringLiteral("SELECT COUNT(*) FROM Resources "
+                       "WHERE dataBody IS NOT NULL OR "
+                       "alternateDataBody IS NOT NULL"),
+        error);
+}
+
+/**
+ * @return      The number of processed items recorded in the checkpoint
+ *              of 1-to-2 patch, 0 if there's no checkpoint or -1 in case of
+ *              error
+ */
+qint64 patch1To2CheckpointProcessedItems(
+    const Account & account, QString & error)
+{
+    TestDatabaseConnection connection(account);
+
+    qint64 numTables = connection.count(
+        QStringLiteral("SELECT COUNT(*) FROM sqlite_master WHERE "
+                       "type = 'table' AND name = 'AuxiliaryPatchCheckpoints'"),
+        error);
+
+    if (numTables <= 0) {
+        return numTables;
+    }
+
+    QSqlQuery query(connection.database());
+    bool res = query.exec(QStringLiteral(
+        "SELECT processedItems FROM AuxiliaryPatchCheckpoints "
+        "WHERE fromVersion = 1 AND toVersion = 2"));
+
+    if (!res) {
+        error = QStringLiteral("Failed to read patch checkpoint: ") +
+            query.lastError().text();
+        return -1;
+    }
+
+    if (!query.next()) {
+        return 0;
+    }
+
+    return query.value(0).toLongLong();
+}
+
+std::shared_ptr<ILocalStoragePatch> patch1To2(
+    LocalStorageManager & localStorageManager)
+{
+    auto patches = localStorageManager.requiredLocalStoragePatches();
+    if (patches.isEmpty() || (patches[0]->fromVersion() != 1) ||
+        (patches[0]->toVersion() != 2))
+    {
+        return {};
+    }
+
+    return patches[0];
+}
+
+/**
+ * Applies the patch and collects the numbers of processed items reported
+ * after the processing of each batch
+ */
+bool applyPatch(
+    ILocalStoragePatch & patch, QList<qint64> & processedItemsReports,
+    QString & error)
+{
+    auto connection = QObject::connect(
+        &patch, &ILocalStoragePatch::processedItemsProgress,
+        [&processedItemsReports](qint64 processedItems, qint64 totalItems) {
+            Q_UNUSED(totalItems)
+            processedItemsReports << processedItems;
+        });
+
+    ErrorString errorDescription;
+    bool res = patch.apply(errorDescription);
+    QObject::disconnect(connection);
+
+    if (!res) {
+        error = errorDescription.nonLocalizedString();
+    }
+
+    return res;
+}
+
+} // namespace
+
+void TestLocalStoragePatch1To2PreservesResourceData()
+{
+    Account account = patchesTestAccount();
+    clearLegacyUpgradeState(account);
+
+    QStringList noteLocalUids;
+    ResourceDataByLocalUid resources;
+    QString error;
+
+    QVERIFY2(
+        populateLocalStorage(account, noteLocalUids, resources, error),
+        qPrintable(error));
+
+    QVERIFY2(
+        downgradeLocalStorageToVersion1(
+            account, resources, QByteArray(), /* remove data files = */ true,
+            error),
+        qPrintable(error));
+
+    LocalStorageManager localStorageManager(account);
+
+    ErrorString errorMessage;
+    QVERIFY2(
+        localStorageManager.localStorageVersion(errorMessage) == 1,
+        qPrintable(QStringLiteral("Failed to downgrade the local storage")));
+
+    auto patches = localStorageManager.requiredLocalStoragePatches();
+    QVERIFY2(
+        patches.size() == 4,
+        qPrintable(
+            QStringLiteral("Unexpected number of required patches: ") +
+            QString::number(patches.size())));
+
+    auto pPatch = patches[0];
+    QVERIFY2(
+        pPatch->fromVersion() == 1 && pPatch->toVersion() == 2,
+        qPrintable(QStringLiteral("The first patch is not 1-to-2 one")));
+
+    QList<qint64> processedItemsReports;
+    QVERIFY2(
+        applyPatch(*pPatch, processedItemsReports, error), qPrintable(error));
+
+    const qint64 numResources = resources.size();
+    const qint64 numBatches =
+        (numResources + PATCHES_TEST_BATCH_SIZE - 1) / PATCHES_TEST_BATCH_SIZE;
+
+    QVERIFY2(
+        processedItemsReports.size() == numBatches &&
+            processedItemsReports.last() == numResources,
+        qPrintable(QStringLiteral(
+            "Resources were not processed in the expected number of "
+            "batches")));
+
+    QVERIFY2(
+        checkResourceDataFiles(account, resources, noteLocalUids, error),
+        qPrintable(error));
+
+    QVERIFY2(
+        numResourcesWithDataInTable(account, error) == 0,
+        qPrintable(
+            QStringLiteral("Data bodies were not removed from the table: ") +
+            error));
+
+    QVERIFY2(
+        patch1To2CheckpointProcessedItems(account, error) == 0,
+        qPrintable(
+            QStringLiteral("Checkpoint was not removed after the upgrade: ") +
+            error));
+
+    errorMessage.clear();
+    QVERIFY2(
+        localStorageManager.localStorageVersion(errorMessage) == 2,
+        qPrintable(QStringLiteral("Local storage version is not 2")));
+
+    // The rest of patches must leave resources data intact as well
+    for (int i = 1, size = patches.size(); i < size; ++i) {
+        QVERIFY2(
+            applyPatch(*patches[i], processedItemsReports, error),
+            qPrintable(error));
+    }
+
+    errorMessage.clear();
+    QVERIFY2(
+        localStorageManager.localStorageVersion(errorMessage) ==
+            localStorageManager.highestSupportedLocalStorageVersion(),
+        qPrintable(QStringLiteral(
+            "Local storage version is not the highest supported one")));
+
+    QVERIFY2(
+        localStorageManager.requiredLocalStoragePatches().isEmpty(),
+        qPrintable(QStringLiteral("Patches are required after the upgrade")));
+
+    for (auto it = resources.constBegin(), end = resources.constEnd();
+         it != end; ++it)
+    {
+        Resource resource;
+        resource.setLocalUid(it.key());
+
+        errorMessage.clear();
+        QVERIFY2(
+            localStorageManager.findEnResource(
+                resource,
+                LocalStorageManager::GetResourceOption::WithBinaryData,
+                errorMessage),
+            qPrintable(errorMessage.nonLocalizedString()));
+
+        QVERIFY2(
+            resource.dataBody() == it.value().m_dataBody &&
+                (it.value().m_alternateDataBody.isEmpty() ||
+                 resource.alternateDataBody() ==
+                     it.value().m_alternateDataBody),
+            qPrintable(
+                QStringLiteral("Resource data doesn't match the original "
+                               "after the upgrade: ") +
+                it.key()));
+    }
+}
+
+void TestLocalStoragePatch1To2ResumesAfterInterruptedBatch()
+{
+    Account account = patchesTestAccount();
+    clearLegacyUpgradeState(account);
+
+    QStringList noteLocalUids;
+    ResourceDataByLocalUid resources;
+    QString error;
+
+    QVERIFY2(
+        populateLocalStorage(account, noteLocalUids, resources, error),
+        qPrintable(error));
+
+    QVERIFY2(
+        downgradeLocalStorageToVersion1(
+            account, resources, QByteArray(), /* remove data files = */ true,
+            error),
+        qPrintable(error));
+
+    // The resources of the first notes fill up the first batch exactly
+    const int numNotesInFirstBatch =
+        PATCHES_TEST_BATCH_SIZE / PATCHES_TEST_NUM_RESOURCES_PER_NOTE;
+
+    const QString blockedNoteLocalUid = noteLocalUids[numNotesInFirstBatch];
+
+    // A file in place of the data dir of the first note in the second batch
+    // makes the processing of that batch fail
+    const QString blockingFilePath = accountPersistentStoragePath(account) +
+        QStringLiteral("/Resources/data/") + blockedNoteLocalUid;
+
+    LocalStorageManager localStorageManager(account);
+
+    auto pPatch = patch1To2(localStorageManager);
+    QVERIFY2(pPatch, qPrintable(QStringLiteral("No 1-to-2 patch")));
+
+    bool createdBlockingFile = false;
+    QObject::connect(
+        pPatch.get(), &ILocalStoragePatch::processedItemsProgress,
+        [&](qint64 processedItems, qint64 totalItems) {
+            Q_UNUSED(totalItems)
+            if (processedItems != PATCHES_TEST_BATCH_SIZE) {
+                return;
+            }
+
+            QFile blockingFile(blockingFilePath);
+            createdBlockingFile = blockingFile.open(QIODevice::WriteOnly);
+        });
+
+    QList<qint64> processedItemsReports;
+    QVERIFY2(
+        !applyPatch(*pPatch, processedItemsReports, error),
+        qPrintable(QStringLiteral(
+            "Patch application was expected to fail on the second batch")));
+
+    QVERIFY2(
+        createdBlockingFile,
+        qPrintable(QStringLiteral("Failed to create blocking file")));
+
+    QVERIFY2(
+        processedItemsReports == QList<qint64>() << PATCHES_TEST_BATCH_SIZE,
+        qPrintable(QStringLiteral(
+            "Expected exactly one batch to be processed before "
+            "the interruption")));
+
+    error.clear();
+    QVERIFY2(
+        patch1To2CheckpointProcessedItems(account, error) ==
+            PATCHES_TEST_BATCH_SIZE,
+        qPrintable(
+            QStringLiteral("Checkpoint doesn't correspond to the last "
+                           "committed batch: ") +
+            error));
+
+    // Data bodies of the failed batch must stay in the table
+    error.clear();
+    QVERIFY2(
+        numResourcesWithDataInTable(account, error) ==
+            resources.size() - PATCHES_TEST_BATCH_SIZE,
+        qPrintable(
+            QStringLiteral("Unexpected number of resources with data in "
+                           "the table after the interruption: ") +
+            error));
+
+    QVERIFY2(
+        checkResourceDataFiles(
+            account, resources, noteLocalUids.mid(0, numNotesInFirstBatch),
+            error),
+        qPrintable(error));
+
+    QVERIFY2(
+        QFile::remove(blockingFilePath),
+        qPrintable(QStringLiteral("Failed to remove blocking file")));
+
+    // The new patch object is not aware of the previous attempt other than
+    // through the checkpoint within the database
+    pPatch = patch1To2(localStorageManager);
+    QVERIFY2(pPatch, qPrintable(QStringLiteral("No 1-to-2 patch")));
+
+    processedItemsReports.clear();
+    QVERIFY2(
+        applyPatch(*pPatch, processedItemsReports, error), qPrintable(error));
+
+    // Resumed application must neither redo the first batch nor skip any
+    // of the rest
+    QList<qint64> expectedReports;
+    for (qint64 processedItems = 2 * PATCHES_TEST_BATCH_SIZE;
+         processedItems < resources.size() + PATCHES_TEST_BATCH_SIZE;
+         processedItems += PATCHES_TEST_BATCH_SIZE)
+    {
+        expectedReports << std::min<qint64>(processedItems, resources.size());
+    }
+
+    QVERIFY2(
+        processedItemsReports == expectedReports,
+        qPrintable(QStringLiteral(
+            "Resumed patch application didn't continue from the "
+            "checkpoint")));
+
+    // If the first batch were redone, its files would be overwritten with
+    // empty data bodies already removed from the table
+    QVERIFY2(
+        checkResourceDataFiles(account, resources, noteLocalUids, error),
+        qPrintable(error));
+
+    QVERIFY2(
+        numResourcesWithDataInTable(account, error) == 0,
+        qPrintable(
+            QStringLiteral("Data bodies were not removed from the table: ") +
+            error));
+
+    QVERIFY2(
+        patch1To2CheckpointProcessedItems(account, error) == 0,
+        qPrintable(
+            QStringLiteral("Checkpoint was not removed after the upgrade: ") +
+            error));
+
+    ErrorString errorMessage;
+    QVERIFY2(
+        localStorageManager.localStorageVersion(errorMessage) == 2,
+        qPrintable(QStringLiteral("Local storage version is not 2")));
+}
+
+void TestLocalStoragePatch1To2HonoursLegacyUpgradeState()
+{
+    Account account = patchesTestAccount();
+    clearLegacyUpgradeState(account);
+
+    QStringList noteLocalUids;
+    ResourceDataByLocalUid resources;
+    QString error;
+
+    QVERIFY2(
+        populateLocalStorage(account, noteLocalUids, resources, error),
+        qPrintable(error));
+
+    // The previous implementation of the patch has already copied all data
+    // bodies to files but hasn't removed them from the table; the data in
+    // the table differs from the one in files to ensure the files are not
+    // written once again
+    QVERIFY2(
+        downgradeLocalStorageToVersion1(
+            account, resources, QByteArray("stale"),
+            /* remove data files = */ false, error),
+        qPrintable(error));
+
+    {
+        ApplicationSettings databaseUpgradeInfo(
+            account, UPGRADE_1_TO_2_PERSISTENCE);
+
+        databaseUpgradeInfo.setValue(
+            QStringLiteral("AllResourceDataCopiedFromTableToFiles"), true);
+
+        databaseUpgradeInfo.setValue(
+            QStringLiteral("AllResourceDataRemovedFromResourceTable"), false);
+    }
+
+    LocalStorageManager localStorageManager(account);
+
+    auto pPatch = patch1To2(localStorageManager);
+    QVERIFY2(pPatch, qPrintable(QStringLiteral("No 1-to-2 patch")));
+
+    QList<qint64> processedItemsReports;
+    bool res = applyPatch(*pPatch, processedItemsReports, error);
+    clearLegacyUpgradeState(account);
+    QVERIFY2(res, qPrintable(error));
+
+    QVERIFY2(
+        processedItemsReports.isEmpty(),
+        qPrintable(QStringLiteral(
+            "Resources were processed again despite the legacy upgrade "
+            "state")));
+
+    QVERIFY2(
+        checkResourceDataFiles(account, resources, noteLocalUids, error),
+        qPrintable(error));
+
+    QVERIFY2(
+        numResourcesWithDataInTable(account, error) == 0,
+        qPrintable(
+            QStringLiteral("Data bodies were not removed from the table: ") +
+            error));
+
+    ErrorString errorMessage;
+    QVERIFY2(
+        localStorageManager.localStorageVersion(errorMessage) == 2,
+        qPrintable(QStringLiteral("Local storage version is not 2")));
+}
+
+void TestLocalStoragePatch1To2ResumesAfterFailedFinalize()
+{
+    Account account = patchesTestAccount();
+    clearLegacyUpgradeState(account);
+
+    QStringList noteLocalUids;
+    ResourceDataByLocalUid resources;
+    QString error;
+
+    QVERIFY2(
+        populateLocalStorage(account, noteLocalUids, resources, error),
+        qPrintable(error));
+
+    QVERIFY2(
+        downgradeLocalStorageToVersion1(
+            account, resources, QByteArray(), /* remove data files = */ true,
+            error),
+        qPrintable(error));
+
+    // Updating the version is the last step of finalization
+    const QString triggerName =
+        QStringLiteral("LocalStoragePatchesTestFailVersionUpdate");
+
+    {
+        TestDatabaseConnection connection(account);
+        QVERIFY2(
+            connection.exec(
+                QStringLiteral("CREATE TRIGGER ") + triggerName +
+                    QStringLiteral(" BEFORE INSERT ON Auxiliary BEGIN "
+                                   "SELECT RAISE(ABORT, 'Injected failure'); "
+                                   "END"),
+                error),
+            qPrintable(error));
+    }
+
+    LocalStorageManager localStorageManager(account);
+
+    auto pPatch = patch1To2(localStorageManager);
+    QVERIFY2(pPatch, qPrintable(QStringLiteral("No 1-to-2 patch")));
+
+    QList<qint64> processedItemsReports;
+    QVERIFY2(
+        !applyPatch(*pPatch, processedItemsReports, error),
+        qPrintable(QStringLiteral(
+            "Patch application was expected to fail on finalization")));
+
+    QVERIFY2(
+        !processedItemsReports.isEmpty() &&
+            processedItemsReports.last() == resources.size(),
+        qPrintable(QStringLiteral(
+            "Not all resources were processed before finalization")));
+
+    error.clear();
+    QVERIFY2(
+        patch1To2CheckpointProcessedItems(account, error) == resources.size(),
+        qPrintable(
+            QStringLiteral("Checkpoint was not left after failed "
+                           "finalization: ") +
+            error));
+
+    ErrorString errorMessage;
+    QVERIFY2(
+        localStorageManager.localStorageVersion(errorMessage) == 1,
+        qPrintable(QStringLiteral(
+            "Local storage version changed despite failed finalization")));
+
+    {
+        TestDatabaseConnection connection(account);
+        QVERIFY2(
+            connection.exec(
+                QStringLiteral("DROP TRIGGER ") + triggerName, error),
+            qPrintable(error));
+    }
+
+    pPatch = patch1To2(localStorageManager);
+    QVERIFY2(pPatch, qPrintable(QStringLiteral("No 1-to-2 patch")));
+
+    processedItemsReports.clear();
+    QVERIFY2(
+        applyPatch(*pPatch, processedItemsReports, error), qPrintable(error));
+
+    QVERIFY2(
+        processedItemsReports.isEmpty(),
+        qPrintable(QStringLiteral(
+            "Resources were processed again after failed finalization")));
+
+    QVERIFY2(
+        checkResourceDataFiles(account, resources, noteLocalUids, error),
+        qPrintable(error));
+
+    QVERIFY2(
+        numResourcesWithDataInTable(account, error) == 0,
+        qPrintable(
+            QStringLiteral("Data bodies were not removed from the table: ") +
+            error));
+
+    QVERIFY2(
+        patch1To2CheckpointProcessedItems(account, error) == 0,
+        qPrintable(
+            QStringLiteral("Checkpoint was not removed after the upgrade: ") +
+            error));
+
+    errorMessage.clear();
+    QVERIFY2(
+        localStorageManager.localStorageVersion(errorMessage) == 2,
+        qPrintable(QStringLiteral("Local storage version is not 2")));
+}
+
+} // namespace test
+} // namespace quentier
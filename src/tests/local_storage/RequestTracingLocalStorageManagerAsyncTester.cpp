@@ -0,0 +1,259 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RequestTracingLocalStorageManagerAsyncTester.h"
+
+#include <quentier/local_storage/LocalStorageManagerAsync.h>
+#include <quentier/logging/QuentierLogger.h>
+#include <quentier/utility/Compat.h>
+
+#include <QJsonDocument>
+#include <QThread>
+
+#define NUM_REQUESTS (3)
+
+namespace quentier {
+namespace test {
+
+RequestTracingLocalStorageManagerAsyncTester::
+    RequestTracingLocalStorageManagerAsyncTester(QObject * parent) :
+    QObject(parent)
+{}
+
+RequestTracingLocalStorageManagerAsyncTester::
+    ~RequestTracingLocalStorageManagerAsyncTester()
+{
+    clear();
+}
+
+void RequestTracingLocalStorageManagerAsyncTester::onInitTestCase()
+{
+    QString username =
+        QStringLiteral("RequestTracingLocalStorageManagerAsyncTester");
+
+    qint32 userId = 5;
+
+    clear();
+
+    m_pLocalStorageManagerThread = new QThread(this);
+    Account account(username, Account::Type::Evernote, userId);
+
+    LocalStorageManager::StartupOptions startupOptions(
+        LocalStorageManager::StartupOption::ClearDatabase);
+
+    m_pLocalStorageManagerAsync =
+        new LocalStorageManagerAsync(account, startupOptions);
+
+    // Every SQL statement is slow with zero threshold
+    m_pLocalStorageManagerAsync->setRequestTracingEnabled(true);
+    m_pLocalStorageManagerAsync->setSlowQueryThresholdMsec(0);
+
+    createConnections();
+
+    m_pLocalStorageManagerAsync->init();
+    m_pLocalStorageManagerAsync->moveToThread(m_pLocalStorageManagerThread);
+
+    m_pLocalStorageManagerThread->setObjectName(QStringLiteral(
+        "RequestTracingLocalStorageManagerAsyncTester-local-storage-thread"));
+
+    m_pLocalStorageManagerThread->start();
+}
+
+void RequestTracingLocalStorageManagerAsyncTester::initialize()
+{
+    sendGetSavedSearchCountRequest();
+}
+
+void RequestTracingLocalStorageManagerAsyncTester::
+    onGetSavedSearchCountCompleted(int count, QUuid requestId)
+{
+    if (requestId != m_getSavedSearchCountRequestId) {
+        return;
+    }
+
+    if (count != 0) {
+        Q_EMIT failure(
+            QStringLiteral("Unexpected non-zero saved search count: ") +
+            QString::number(count));
+        return;
+    }
+
+    // The requests are sent one after another so that the first one would
+    // let the tracer hook the signal and the subsequent ones would be stamped
+    if (m_numSentRequests < NUM_REQUESTS) {
+        sendGetSavedSearchCountRequest();
+        return;
+    }
+
+    checkRequestTrace();
+}
+
+void RequestTracingLocalStorageManagerAsyncTester::onGetSavedSearchCountFailed(
+    ErrorString errorDescription, QUuid requestId)
+{
+    if (requestId != m_getSavedSearchCountRequestId) {
+        return;
+    }
+
+    QNWARNING(
+        "tests:local_storage",
+        errorDescription << ", requestId = " << requestId);
+
+    Q_EMIT failure(errorDescription.nonLocalizedString());
+}
+
+void RequestTracingLocalStorageManagerAsyncTester::createConnections()
+{
+    QObject::connect(
+        m_pLocalStorageManagerThread, &QThread::finished,
+        m_pLocalStorageManagerThread, &QThread::deleteLater);
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync, &LocalStorageManagerAsync::initialized,
+        this, &RequestTracingLocalStorageManagerAsyncTester::initialize);
+
+    // Request --> slot connections
+    QObject::connect(
+        this,
+        &RequestTracingLocalStorageManagerAsyncTester::
+            getSavedSearchCountRequest,
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::onGetSavedSearchCountRequest);
+
+    // Slot <-- result connections
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::getSavedSearchCountComplete, this,
+        &RequestTracingLocalStorageManagerAsyncTester::
+            onGetSavedSearchCountCompleted);
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::getSavedSearchCountFailed, this,
+        &RequestTracingLocalStorageManagerAsyncTester::
+            onGetSavedSearchCountFailed);
+}
+
+void RequestTracingLocalStorageManagerAsyncTester::clear()
+{
+    if (m_pLocalStorageManagerThread) {
+        m_pLocalStorageManagerThread->quit();
+        m_pLocalStorageManagerThread->wait();
+        m_pLocalStorageManagerThread->deleteLater();
+        m_pLocalStorageManagerThread = nullptr;
+    }
+
+    if (m_pLocalStorageManagerAsync) {
+        m_pLocalStorageManagerAsync->deleteLater();
+        m_pLocalStorageManagerAsync = nullptr;
+    }
+
+    m_getSavedSearchCountRequestId = QUuid();
+    m_numSentRequests = 0;
+}
+
+void RequestTracingLocalStorageManagerAsyncTester::
+    sendGetSavedSearchCountRequest()
+{
+    m_getSavedSearchCountRequestId = QUuid::createUuid();
+    ++m_numSentRequests;
+    Q_EMIT getSavedSearchCountRequest(m_getSavedSearchCountRequestId);
+}
+
+void RequestTracingLocalStorageManagerAsyncTester::checkRequestTrace()
+{
+    const auto snapshot = m_pLocalStorageManagerAsync->requestTraceSnapshot();
+
+    const auto statsIt = snapshot.m_requestStats.constFind(
+        QStringLiteral("getSavedSearchCount"));
+
+    if (statsIt == snapshot.m_requestStats.constEnd()) {
+        Q_EMIT failure(
+            QStringLiteral("No stats for getSavedSearchCount requests"));
+        return;
+    }
+
+    const auto & stats = statsIt.value();
+    if (stats.m_execution.m_count != static_cast<quint64>(NUM_REQUESTS)) {
+        Q_EMIT failure(
+            QStringLiteral("Unexpected number of traced request executions: ") +
+            QString::number(stats.m_execution.m_count));
+        return;
+    }
+
+    // The queue wait of the first request which let the tracer hook the signal
+    // cannot be measured
+    if ((stats.m_unmeasuredQueueWaits != 1) ||
+        (stats.m_queueWait.m_count != static_cast<quint64>(NUM_REQUESTS - 1)))
+    {
+        Q_EMIT failure(
+            QStringLiteral("Unexpected number of measured queue waits: ") +
+            QString::number(stats.m_queueWait.m_count) +
+            QStringLiteral(", unmeasured: ") +
+            QString::number(stats.m_unmeasuredQueueWaits));
+        return;
+    }
+
+    quint64 histogramCount = 0;
+    for (const auto count: qAsConst(stats.m_execution.m_buckets)) {
+        histogramCount += count;
+    }
+
+    if ((histogramCount != stats.m_execution.m_count) ||
+        (stats.m_execution.m_buckets.size() !=
+         snapshot.m_histogramBucketBoundsUsec.size() + 1))
+    {
+        Q_EMIT failure(
+            QStringLiteral("Execution histogram doesn't match the count"));
+        return;
+    }
+
+    bool foundSlowQuery = false;
+    for (const auto & slowQuery: qAsConst(snapshot.m_slowQueries)) {
+        if ((slowQuery.m_requestType ==
+             QStringLiteral("getSavedSearchCount")) &&
+            slowQuery.m_statement.contains(QStringLiteral("SavedSearches")))
+        {
+            if (slowQuery.m_queryPlan.isEmpty()) {
+                Q_EMIT failure(
+                    QStringLiteral("Slow query has no query plan: ") +
+                    slowQuery.m_statement);
+                return;
+            }
+
+            foundSlowQuery = true;
+            break;
+        }
+    }
+
+    if (!foundSlowQuery) {
+        Q_EMIT failure(QStringLiteral(
+            "Saved search count query is missing from the slow query log"));
+        return;
+    }
+
+    if (QJsonDocument::fromJson(snapshot.toJson()).isNull()) {
+        Q_EMIT failure(QStringLiteral("Failed to parse request trace JSON"));
+        return;
+    }
+
+    Q_EMIT success();
+}
+
+} // namespace test
+} // namespace quentier
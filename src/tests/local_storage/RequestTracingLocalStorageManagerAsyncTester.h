@@ -0,0 +1,79 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_TESTS_REQUEST_TRACING_LOCAL_STORAGE_MANAGER_ASYNC_TESTER_H
+#define LIB_QUENTIER_TESTS_REQUEST_TRACING_LOCAL_STORAGE_MANAGER_ASYNC_TESTER_H
+
+#include <quentier/types/ErrorString.h>
+
+#include <QObject>
+#include <QUuid>
+
+QT_FORWARD_DECLARE_CLASS(QThread)
+
+namespace quentier {
+
+QT_FORWARD_DECLARE_CLASS(LocalStorageManagerAsync)
+
+namespace test {
+
+class RequestTracingLocalStorageManagerAsyncTester final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RequestTracingLocalStorageManagerAsyncTester(
+        QObject * parent = nullptr);
+
+    ~RequestTracingLocalStorageManagerAsyncTester();
+
+public Q_SLOTS:
+    void onInitTestCase();
+
+Q_SIGNALS:
+    void success();
+    void failure(QString errorDescription);
+
+    // private signals:
+    void getSavedSearchCountRequest(QUuid requestId);
+
+private Q_SLOTS:
+    void initialize();
+    void onGetSavedSearchCountCompleted(int count, QUuid requestId);
+
+    void onGetSavedSearchCountFailed(
+        ErrorString errorDescription, QUuid requestId);
+
+private:
+    void createConnections();
+    void clear();
+
+    void sendGetSavedSearchCountRequest();
+    void checkRequestTrace();
+
+private:
+    LocalStorageManagerAsync * m_pLocalStorageManagerAsync = nullptr;
+    QThread * m_pLocalStorageManagerThread = nullptr;
+
+    QUuid m_getSavedSearchCountRequestId;
+    int m_numSentRequests = 0;
+};
+
+} // namespace test
+} // namespace quentier
+
+#endif // LIB_QUENTIER_TESTS_REQUEST_TRACING_LOCAL_STORAGE_MANAGER_ASYNC_TESTER_H
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HtmlToNoteContentConverterTests.h"
+
+#include "NoteHtmlRendererTests.h"
+
+#include "../../note_editor/HtmlToNoteContentConverter.h"
+
+#include <quentier/enml/ENMLConverter.h>
+
+#include <QUuid>
+
+namespace quentier {
+namespace test {
+
+namespace {
+
+struct ConversionResult
+{
+    bool m_finished = false;
+    bool m_cancelled = false;
+    QString m_noteContent;
+    ErrorString m_errorDescription;
+};
+
+ConversionResult convertHtmlToNoteContent(
+    const QString & html, std::shared_ptr<QAtomicInt> pStopFlag)
+{
+    ConversionResult result;
+
+    HtmlToNoteContentConverter converter(
+        QUuid::createUuid().toString(), html, {}, std::move(pStopFlag),
+        QUuid::createUuid());
+
+    QObject::connect(
+        &converter, &HtmlToNoteContentConverter::finished,
+        [&result](
+            QUuid requestId, QString noteLocalUid, bool cancelled,
+            QString noteContent, ErrorString errorDescription) {
+            Q_UNUSED(requestId)
+            Q_UNUSED(noteLocalUid)
+
+            result.m_finished = true;
+            result.m_cancelled = cancelled;
+            result.m_noteContent = noteContent;
+            result.m_errorDescription = errorDescription;
+        });
+
+    converter.run();
+    return result;
+}
+
+} // namespace
+
+bool testHtmlToNoteContentConverter(QString & error)
+{
+    const QString originalNoteContent = composeNoteContentForRendering(10);
+
+    QString html = renderNoteHtml(
+        QUuid::createUuid().toString(), originalNoteContent, QString());
+
+    if (html.isEmpty()) {
+        error = QStringLiteral("Failed to render note content to HTML");
+        return false;
+    }
+
+    auto result =
+        convertHtmlToNoteContent(html, std::make_shared<QAtomicInt>(0));
+
+    if (!result.m_finished) {
+        error = QStringLiteral("Converter didn't report the result");
+        return false;
+    }
+
+    if (result.m_cancelled) {
+        error = QStringLiteral("Not cancelled conversion was reported as "
+                               "cancelled one");
+        return false;
+    }
+
+    if (!result.m_errorDescription.isEmpty()) {
+        error = QStringLiteral("Failed to convert HTML to note content: ") +
+            result.m_errorDescription.nonLocalizedString();
+        return false;
+    }
+
+    ENMLConverter converter;
+    ErrorString errorDescription;
+    if (!converter.validateEnml(result.m_noteContent, errorDescription)) {
+        error = QStringLiteral("Converted note content is not valid ENML: ") +
+            errorDescription.nonLocalizedString() +
+            QStringLiteral("; note content: ") + result.m_noteContent;
+        return false;
+    }
+
+    if (result.m_noteContent.count(QStringLiteral("<en-todo")) != 10) {
+        error = QStringLiteral("Converted note content lost checkboxes: ") +
+            result.m_noteContent;
+        return false;
+    }
+
+    return true;
+}
+
+bool testHtmlToNoteContentConverterCancellation(QString & error)
+{
+    const QString noteContent = composeNoteContentForRendering(10);
+
+    QString html = renderNoteHtml(
+        QUuid::createUuid().toString(), noteContent, QString());
+
+    if (html.isEmpty()) {
+        error = QStringLiteral("Failed to render note content to HTML");
+        return false;
+    }
+
+    auto result =
+        convertHtmlToNoteContent(html, std::make_shared<QAtomicInt>(1));
+
+    if (!result.m_finished) {
+        error = QStringLiteral("Cancelled converter didn't report the result");
+        return false;
+    }
+
+    if (!result.m_cancelled) {
+        error = QStringLiteral("Cancelled conversion was not reported as "
+                               "cancelled one");
+        return false;
+    }
+
+    if (!result.m_noteContent.isEmpty()) {
+        error = QStringLiteral("Cancelled conversion produced note content");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace test
+} // namespace quentier
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ImageResourceRotatorTests.h"
+
+#include "../../note_editor/ImageResourceRotator.h"
+
+#include <quentier/note_editor/ResourceThumbnailCache.h>
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QImage>
+#include <QUuid>
+
+namespace quentier {
+namespace test {
+
+namespace {
+
+struct RotationResult
+{
+    bool m_finished = false;
+    bool m_cancelled = false;
+    QByteArray m_rotatedImageData;
+    QByteArray m_rotatedImageDataHash;
+    QSize m_imageSizeBefore;
+    QSize m_imageSizeAfter;
+    ErrorString m_errorDescription;
+};
+
+QByteArray composeImageData(const int width, const int height)
+{
+    // The top left pixel is red, the rest of the image is white so that
+    // the direction of rotation can be verified
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(Qt::white);
+    image.setPixel(0, 0, qRgb(255, 0, 0));
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    Q_UNUSED(buffer.open(QIODevice::WriteOnly))
+    Q_UNUSED(image.save(&buffer, "PNG"))
+    return data;
+}
+
+RotationResult rotateImage(
+    const QByteArray & imageData,
+    const INoteEditorBackend::Rotation rotationDirection,
+    std::shared_ptr<QAtomicInt> pStopFlag)
+{
+    RotationResult result;
+
+    ImageResourceRotator rotator(
+        imageData, QCryptographicHash::hash(imageData, QCryptographicHash::Md5),
+        rotationDirection, std::move(pStopFlag), QUuid::createUuid());
+
+    QObject::connect(
+        &rotator, &ImageResourceRotator::finished,
+        [&result](
+            QUuid requestId, bool cancelled, QByteArray rotatedImageData,
+            QByteArray rotatedImageDataHash, QSize imageSizeBefore,
+            QSize imageSizeAfter, ErrorString errorDescription) {
+            Q_UNUSED(requestId)
+
+            result.m_finished = true;
+            result.m_cancelled = cancelled;
+            result.m_rotatedImageData = rotatedImageData;
+            result.m_rotatedImageDataHash = rotatedImageDataHash;
+            result.m_imageSizeBefore = imageSizeBefore;
+            result.m_imageSizeAfter = imageSizeAfter;
+            result.m_errorDescription = errorDescription;
+        });
+
+    rotator.run();
+    return result;
+}
+
+} // namespace
+
+bool testImageResourceRotator(QString & error)
+{
+    const QByteArray imageData = composeImageData(40, 20);
+
+    RotationResult result = rotateImage(
+        imageData, INoteEditorBackend::Rotation::Clockwise,
+        std::make_shared<QAtomicInt>(0));
+
+    if (!result.m_finished || result.m_cancelled) {
+        error = QStringLiteral("Image rotation didn't finish");
+        return false;
+    }
+
+    if (!result.m_errorDescription.isEmpty()) {
+        error = result.m_errorDescription.nonLocalizedString();
+        return false;
+    }
+
+    if ((result.m_imageSizeBefore != QSize(40, 20)) ||
+        (result.m_imageSizeAfter != QSize(20, 40)))
+    {
+        error = QStringLiteral("Unexpected image sizes after rotation");
+        return false;
+    }
+
+    if (result.m_rotatedImageDataHash !=
+        QCryptographicHash::hash(
+            result.m_rotatedImageData, QCryptographicHash::Md5))
+    {
+        error = QStringLiteral("Wrong hash of rotated image data");
+        return false;
+    }
+
+    QImage rotatedImage;
+    if (!rotatedImage.loadFromData(result.m_rotatedImageData, "PNG")) {
+        error = QStringLiteral("Rotated image data is not a valid PNG");
+        return false;
+    }
+
+    // After the clockwise rotation the top left pixel becomes the top right
+    if (qRed(rotatedImage.pixel(19, 0)) < 200 ||
+        qGreen(rotatedImage.pixel(19, 0)) > 50)
+    {
+        error = QStringLiteral("The image was rotated in wrong direction");
+        return false;
+    }
+
+    result = rotateImage(
+        QByteArray("not an image"), INoteEditorBackend::Rotation::Clockwise,
+        std::make_shared<QAtomicInt>(0));
+
+    if (!result.m_finished || result.m_errorDescription.isEmpty()) {
+        error = QStringLiteral("No error for the data which is not an image");
+        return false;
+    }
+
+    return true;
+}
+
+bool testImageResourceRotatorCancellation(QString & error)
+{
+    auto pStopFlag = std::make_shared<QAtomicInt>(1);
+
+    RotationResult result = rotateImage(
+        composeImageData(40, 20),
+        INoteEditorBackend::Rotation::Counterclockwise, pStopFlag);
+
+    if (!result.m_finished || !result.m_cancelled) {
+        error = QStringLiteral("Cancelled rotation wasn't reported as such");
+        return false;
+    }
+
+    if (!result.m_rotatedImageData.isEmpty() ||
+        !result.m_errorDescription.isEmpty())
+    {
+        error = QStringLiteral("Cancelled rotation produced some result");
+        return false;
+    }
+
+    return true;
+}
+
+bool testResourceThumbnailCache(QString & error)
+{
+    ResourceThumbnailCache::clear();
+
+    const QByteArray imageData = composeImageData(400, 200);
+    const QByteArray dataHash =
+        QCryptographicHash::hash(imageData, QCryptographicHash::Md5);
+
+    const QSize size(100, 100);
+
+    if (!ResourceThumbnailCache::cachedThumbnail(dataHash, size).isNull()) {
+        error = QStringLiteral("Found thumbnail in the empty cache");
+        return false;
+    }
+
+    QImage thumbnail =
+        ResourceThumbnailCache::thumbnail(dataHash, imageData, size);
+
+    if (thumbnail.size() != QSize(100, 50)) {
+        error = QStringLiteral(
+            "Thumbnail doesn't preserve the aspect ratio of the image");
+        return false;
+    }
+
+    // The cached thumbnail should be returned without decoding the data
+    thumbnail = ResourceThumbnailCache::thumbnail(dataHash, QByteArray(), size);
+    if (thumbnail.size() != QSize(100, 50)) {
+        error = QStringLiteral("Thumbnail was not found in the cache");
+        return false;
+    }
+
+    if (!ResourceThumbnailCache::cachedThumbnail(dataHash, QSize(50, 50))
+             .isNull())
+    {
+        error = QStringLiteral("Found thumbnail of different size");
+        return false;
+    }
+
+    const auto cachedSizes =
+        ResourceThumbnailCache::cachedThumbnailSizes(dataHash);
+
+    if ((cachedSizes.size() != 1) || (cachedSizes[0] != size)) {
+        error = QStringLiteral("Wrong sizes of cached thumbnails");
+        return false;
+    }
+
+    // The rotator should put thumbnails of the rotated image into the cache
+    // for the sizes cached for the original image
+    RotationResult result = rotateImage(
+        imageData, INoteEditorBackend::Rotation::Clockwise,
+        std::make_shared<QAtomicInt>(0));
+
+    if (!result.m_finished || !result.m_errorDescription.isEmpty()) {
+        error = QStringLiteral("Image rotation failed");
+        return false;
+    }
+
+    thumbnail = ResourceThumbnailCache::cachedThumbnail(
+        result.m_rotatedImageDataHash, size);
+
+    if (thumbnail.size() != QSize(50, 100)) {
+        error = QStringLiteral(
+            "No proper thumbnail of the rotated image in the cache");
+        return false;
+    }
+
+    ResourceThumbnailCache::removeThumbnails(dataHash);
+    if (!ResourceThumbnailCache::cachedThumbnail(dataHash, size).isNull()) {
+        error = QStringLiteral("Found removed thumbnail in the cache");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace test
+} // namespace quentier
@@ -0,0 +1,303 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NoteEditorTester.h"
+
+#include "HtmlToNoteContentConverterTests.h"
+#include "ImageResourceRotatorTests.h"
+#include "NoteHtmlRendererTests.h"
+#include "SpellCheckerBatchTests.h"
+#include "SpellCheckerDictionariesFinderTests.h"
+#include "UndoStackDataStorageTests.h"
+#include "../../note_editor/NoteHtmlRenderer.h"
+#include "../../note_editor/SpellCheckerDictionariesFinder.h"
+
+#include <quentier/types/RegisterMetatypes.h>
+#include <quentier/utility/SysInfo.h>
+
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QUuid>
+#include <QtTest/QTest>
+
+// Large enough to resemble a big set of mounted volumes which used to be
+// scanned in full by SpellCheckerDictionariesFinder
+#define SPELL_CHECKER_BENCHMARK_NUM_DIRS (50)
+#define SPELL_CHECKER_BENCHMARK_NUM_SUBDIRS (20)
+
+// Large enough for the conversion of note content to HTML to take noticeable
+// time
+#define NOTE_HTML_RENDERER_BENCHMARK_NUM_PARAGRAPHS (2000)
+
+namespace quentier {
+namespace test {
+
+NoteEditorTester::NoteEditorTester(QObject * parent) : QObject(parent) {}
+
+NoteEditorTester::~NoteEditorTester() {}
+
+inline void messageHandler(
+    QtMsgType type, const QMessageLogContext &, const QString & message)
+{
+    if (type != QtDebugMsg) {
+        QTextStream(stdout) << message << QStringLiteral("\n");
+    }
+}
+
+void NoteEditorTester::init()
+{
+    registerMetatypes();
+    qInstallMessageHandler(messageHandler);
+}
+
+#define CATCH_EXCEPTION()                                                      \
+    catch (const std::exception & exception) {                                 \
+        SysInfo sysInfo;                                                       \
+        QFAIL(qPrintable(                                                      \
+            QStringLiteral("Caught exception: ") +                             \
+            QString::fromUtf8(exception.what()) +                              \
+            QStringLiteral(", backtrace: ") + sysInfo.stackTrace()));          \
+    }
+
+void NoteEditorTester::spellCheckerDictionariesFinderTest()
+{
+    try {
+        QString error;
+        bool res = testSpellCheckerDictionariesFinder(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::spellCheckerBatchDeduplicationTest()
+{
+    try {
+        QString error;
+        bool res = testSpellCheckerBatchDeduplication(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::spellCheckerBatchMatchesSingleWordChecksTest()
+{
+    try {
+        QString error;
+        bool res = testSpellCheckerBatchMatchesSingleWordChecks(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::spellCheckerBatchCacheInvalidationTest()
+{
+    try {
+        QString error;
+        bool res = testSpellCheckerBatchCacheInvalidation(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::benchmarkSpellCheckerDictionariesFinderFullScan()
+{
+    try {
+        QTemporaryDir tmpDir;
+        QVERIFY2(tmpDir.isValid(), "Failed to create temporary dir");
+
+        QString error;
+        bool res = createSpellCheckerDictionariesTree(
+            tmpDir.path(), SPELL_CHECKER_BENCHMARK_NUM_DIRS,
+            SPELL_CHECKER_BENCHMARK_NUM_SUBDIRS, error);
+
+        QVERIFY2(res, qPrintable(error));
+
+        int numFound = 0;
+        QBENCHMARK
+        {
+            SpellCheckerDictionariesFinder::clearDictionariesIndex();
+            numFound = runSpellCheckerDictionariesFinder(tmpDir.path());
+        }
+
+        SpellCheckerDictionariesFinder::clearDictionariesIndex();
+        QVERIFY2(numFound == 1, "Expected to find exactly one dictionary");
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::benchmarkSpellCheckerDictionariesFinderIndexedScan()
+{
+    try {
+        QTemporaryDir tmpDir;
+        QVERIFY2(tmpDir.isValid(), "Failed to create temporary dir");
+
+        QString error;
+        bool res = createSpellCheckerDictionariesTree(
+            tmpDir.path(), SPELL_CHECKER_BENCHMARK_NUM_DIRS,
+            SPELL_CHECKER_BENCHMARK_NUM_SUBDIRS, error);
+
+        QVERIFY2(res, qPrintable(error));
+
+        // Populate the index before the measurements
+        SpellCheckerDictionariesFinder::clearDictionariesIndex();
+        Q_UNUSED(runSpellCheckerDictionariesFinder(tmpDir.path()))
+
+        int numFound = 0;
+        QBENCHMARK
+        {
+            numFound = runSpellCheckerDictionariesFinder(tmpDir.path());
+        }
+
+        SpellCheckerDictionariesFinder::clearDictionariesIndex();
+        QVERIFY2(numFound == 1, "Expected to find exactly one dictionary");
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::noteHtmlRendererTest()
+{
+    try {
+        QString error;
+        bool res = testNoteHtmlRenderer(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::noteHtmlRendererDiskCachePruningTest()
+{
+    try {
+        QString error;
+        bool res = testNoteHtmlRendererDiskCachePruning(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::benchmarkNoteHtmlRendererConversion()
+{
+    try {
+        const QString noteLocalUid = QUuid::createUuid().toString();
+        const QString noteContent = composeNoteContentForRendering(
+            NOTE_HTML_RENDERER_BENCHMARK_NUM_PARAGRAPHS);
+
+        QString html;
+        QBENCHMARK
+        {
+            html = renderNoteHtml(noteLocalUid, noteContent, QString());
+        }
+
+        QVERIFY2(!html.isEmpty(), "Failed to render note content to HTML");
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::benchmarkNoteHtmlRendererDiskCache()
+{
+    try {
+        QTemporaryDir tmpDir;
+        QVERIFY2(tmpDir.isValid(), "Failed to create temporary dir");
+
+        const QString noteLocalUid = QUuid::createUuid().toString();
+        const QString noteContent = composeNoteContentForRendering(
+            NOTE_HTML_RENDERER_BENCHMARK_NUM_PARAGRAPHS);
+
+        // Populate the disk cache before the measurements
+        QString html =
+            renderNoteHtml(noteLocalUid, noteContent, tmpDir.path());
+
+        QVERIFY2(!html.isEmpty(), "Failed to render note content to HTML");
+
+        QString cachedHtml;
+        QBENCHMARK
+        {
+            cachedHtml =
+                renderNoteHtml(noteLocalUid, noteContent, tmpDir.path());
+        }
+
+        QVERIFY2(
+            cachedHtml == html,
+            "HTML from the disk cache doesn't match the rendered one");
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::htmlToNoteContentConverterTest()
+{
+    try {
+        QString error;
+        bool res = testHtmlToNoteContentConverter(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::htmlToNoteContentConverterCancellationTest()
+{
+    try {
+        QString error;
+        bool res = testHtmlToNoteContentConverterCancellation(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::undoStackDataStorageTest()
+{
+    try {
+        QString error;
+        bool res = testUndoStackDataStorage(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::imageResourceRotatorTest()
+{
+    try {
+        QString error;
+        bool res = testImageResourceRotator(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::imageResourceRotatorCancellationTest()
+{
+    try {
+        QString error;
+        bool res = testImageResourceRotatorCancellation(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void NoteEditorTester::resourceThumbnailCacheTest()
+{
+    try {
+        QString error;
+        bool res = testResourceThumbnailCache(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+#undef CATCH_EXCEPTION
+
+} // namespace test
+} // namespace quentier
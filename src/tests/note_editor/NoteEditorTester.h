@@ -0,0 +1,68 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_TESTS_NOTE_EDITOR_NOTE_EDITOR_TESTER_H
+#define LIB_QUENTIER_TESTS_NOTE_EDITOR_NOTE_EDITOR_TESTER_H
+
+#include <QObject>
+
+namespace quentier {
+namespace test {
+
+class NoteEditorTester final : public QObject
+{
+    Q_OBJECT
+public:
+    explicit NoteEditorTester(QObject * parent = nullptr);
+    virtual ~NoteEditorTester() override;
+
+private Q_SLOTS:
+    void init();
+
+    void spellCheckerDictionariesFinderTest();
+
+    void spellCheckerBatchDeduplicationTest();
+    void spellCheckerBatchMatchesSingleWordChecksTest();
+    void spellCheckerBatchCacheInvalidationTest();
+
+    void benchmarkSpellCheckerDictionariesFinderFullScan();
+    void benchmarkSpellCheckerDictionariesFinderIndexedScan();
+
+    void noteHtmlRendererTest();
+    void noteHtmlRendererDiskCachePruningTest();
+
+    void benchmarkNoteHtmlRendererConversion();
+    void benchmarkNoteHtmlRendererDiskCache();
+
+    void htmlToNoteContentConverterTest();
+    void htmlToNoteContentConverterCancellationTest();
+
+    void undoStackDataStorageTest();
+
+    void imageResourceRotatorTest();
+    void imageResourceRotatorCancellationTest();
+    void resourceThumbnailCacheTest();
+
+private:
+    Q_DISABLE_COPY(NoteEditorTester)
+};
+
+} // namespace test
+} // namespace quentier
+
+#endif // LIB_QUENTIER_TESTS_NOTE_EDITOR_NOTE_EDITOR_TESTER_H
@@ -0,0 +1,271 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "NoteHtmlRendererTests.h"
+
+#include "../../note_editor/NoteHtmlRenderer.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUuid>
+
+namespace quentier {
+namespace test {
+
+QString composeNoteContentForRendering(const int numParagraphs)
+{
+    QString content = QStringLiteral("<en-note>");
+
+    for (int i = 0; i < numParagraphs; ++i) {
+        content += QStringLiteral("<div><en-todo checked=\"");
+        content += ((i % 2) ? QStringLiteral("true") : QStringLiteral("false"));
+        content += QStringLiteral("\"/>Paragraph #");
+        content += QString::number(i);
+        content += QStringLiteral(" with <b>some</b> <i>formatted</i> text "
+                                  "and <a href=\"https://www.example.com/");
+        content += QString::number(i);
+        content += QStringLiteral("\">a link</a></div>");
+    }
+
+    content += QStringLiteral("</en-note>");
+    return content;
+}
+
+QString renderNoteHtml(
+    const QString & noteLocalUid, const QString & noteContent,
+    const QString & diskCacheDirPath)
+{
+    QString html;
+
+    NoteHtmlRenderer renderer(
+        noteLocalUid, noteContent,
+        NoteHtmlRenderer::cacheKey(noteLocalUid, noteContent),
+        diskCacheDirPath, QUuid::createUuid());
+
+    QObject::connect(
+        &renderer, &NoteHtmlRenderer::finished,
+        [&html](
+            QUuid requestId, QString noteLocalUid, QString cacheKey,
+            QString renderedHtml, quint64 numEnToDoNodes,
+            quint64 numHyperlinkNodes, quint64 numEnCryptNodes,
+            quint64 numEnDecryptedNodes, ErrorString errorDescription) {
+            Q_UNUSED(requestId)
+            Q_UNUSED(noteLocalUid)
+            Q_UNUSED(cacheKey)
+            Q_UNUSED(numEnToDoNodes)
+            Q_UNUSED(numHyperlinkNodes)
+            Q_UNUSED(numEnCryptNodes)
+            Q_UNUSED(numEnDecryptedNodes)
+
+            if (errorDescription.isEmpty()) {
+                html = renderedHtml;
+            }
+        });
+
+    renderer.run();
+    return html;
+}
+
+bool testNoteHtmlRenderer(QString & error)
+{
+    QTemporaryDir tmpDir;
+    if (!tmpDir.isValid()) {
+        error = QStringLiteral("Failed to create temporary dir");
+        return false;
+    }
+
+    const QString noteLocalUid = QUuid::createUuid().toString();
+    const QString noteContent = composeNoteContentForRendering(10);
+
+    QString html = renderNoteHtml(noteLocalUid, noteContent, tmpDir.path());
+    if (html.isEmpty()) {
+        error = QStringLiteral("Failed to render note content to HTML");
+        return false;
+    }
+
+    QString cacheKey = NoteHtmlRenderer::cacheKey(noteLocalUid, noteContent);
+
+    RenderedNoteHtml cachedHtml;
+    if (!NoteHtmlRenderer::readFromDiskCache(
+            tmpDir.path(), noteLocalUid, cacheKey, cachedHtml))
+    {
+        error = QStringLiteral("Rendered HTML was not found in disk cache");
+        return false;
+    }
+
+    if (cachedHtml.m_html != html) {
+        error = QStringLiteral(
+            "HTML read from the disk cache doesn't match the rendered one");
+        return false;
+    }
+
+    if ((cachedHtml.m_extraData.m_numEnToDoNodes != 10) ||
+        (cachedHtml.m_extraData.m_numHyperlinkNodes != 10))
+    {
+        error = QStringLiteral(
+            "Unexpected number of checkboxes or hyperlinks in the extra data "
+            "read from the disk cache: ") +
+            QString::number(cachedHtml.m_extraData.m_numEnToDoNodes) +
+            QStringLiteral(", ") +
+            QString::number(cachedHtml.m_extraData.m_numHyperlinkNodes);
+        return false;
+    }
+
+    // Rendering of the same content must yield the same HTML
+    QString htmlFromCache =
+        renderNoteHtml(noteLocalUid, noteContent, tmpDir.path());
+
+    if (htmlFromCache != html) {
+        error = QStringLiteral(
+            "HTML rendered from the disk cache doesn't match the original one");
+        return false;
+    }
+
+    // Modified content must not be served from the cache
+    const QString modifiedNoteContent = composeNoteContentForRendering(11);
+
+    QString modifiedCacheKey =
+        NoteHtmlRenderer::cacheKey(noteLocalUid, modifiedNoteContent);
+
+    if (modifiedCacheKey == cacheKey) {
+        error = QStringLiteral(
+            "Cache keys of different note contents are the same");
+        return false;
+    }
+
+    if (NoteHtmlRenderer::readFromDiskCache(
+            tmpDir.path(), noteLocalUid, modifiedCacheKey, cachedHtml))
+    {
+        error = QStringLiteral(
+            "Disk cache returned HTML for not yet rendered note content");
+        return false;
+    }
+
+    QString modifiedHtml =
+        renderNoteHtml(noteLocalUid, modifiedNoteContent, tmpDir.path());
+
+    if (modifiedHtml.isEmpty() || (modifiedHtml == html)) {
+        error = QStringLiteral("Modified note content was not re-rendered");
+        return false;
+    }
+
+    // Corrupted cache file must be ignored
+    QFile file(
+        tmpDir.path() + QStringLiteral("/") + noteLocalUid +
+        QStringLiteral(".html"));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        error = QStringLiteral("Failed to open disk cache file for writing");
+        return false;
+    }
+
+    file.write("<!-- garbage -->\n<html></html>");
+    file.close();
+
+    if (NoteHtmlRenderer::readFromDiskCache(
+            tmpDir.path(), noteLocalUid, modifiedCacheKey, cachedHtml))
+    {
+        error = QStringLiteral("Corrupted disk cache file was not ignored");
+        return false;
+    }
+
+    // The stale file must have been removed by the failed read
+    if (QFile::exists(file.fileName())) {
+        error = QStringLiteral(
+            "Disk cache file not matching the note content was not removed");
+        return false;
+    }
+
+    return true;
+}
+
+bool testNoteHtmlRendererDiskCachePruning(QString & error)
+{
+    QTemporaryDir tmpDir;
+    if (!tmpDir.isValid()) {
+        error = QStringLiteral("Failed to create temporary dir");
+        return false;
+    }
+
+    const QString noteContent = composeNoteContentForRendering(10);
+
+    QStringList noteLocalUids;
+    QStringList filePaths;
+    for (int i = 0; i < 3; ++i) {
+        if (i != 0) {
+            // Some file systems store modification time with one second
+            // precision
+            QTest::qSleep(1100);
+        }
+
+        const QString noteLocalUid = QUuid::createUuid().toString();
+        if (renderNoteHtml(noteLocalUid, noteContent, tmpDir.path())
+                .isEmpty())
+        {
+            error = QStringLiteral("Failed to render note content to HTML");
+            return false;
+        }
+
+        noteLocalUids << noteLocalUid;
+        filePaths << tmpDir.path() + QStringLiteral("/") + noteLocalUid +
+                QStringLiteral(".html");
+    }
+
+    // Size limit fitting only the two most recently written files
+    const qint64 maxTotalSize =
+        QFileInfo(filePaths[1]).size() + QFileInfo(filePaths[2]).size();
+
+    int numRemovedFiles = NoteHtmlRenderer::pruneDiskCache(
+        tmpDir.path(), maxTotalSize, /* max age = */ 3600);
+
+    if ((numRemovedFiles != 1) || QFile::exists(filePaths[0]) ||
+        !QFile::exists(filePaths[1]) || !QFile::exists(filePaths[2]))
+    {
+        error = QStringLiteral(
+            "Pruning by size didn't remove exactly the least recently written "
+            "file");
+        return false;
+    }
+
+    // Removal of the single note's HTML, i.e. after the note is expunged
+    if (!NoteHtmlRenderer::removeFromDiskCache(
+            tmpDir.path(), noteLocalUids[1]) ||
+        QFile::exists(filePaths[1]) || !QFile::exists(filePaths[2]))
+    {
+        error = QStringLiteral(
+            "Failed to remove the rendered HTML of a single note from "
+            "the disk cache");
+        return false;
+    }
+
+    // The remaining file is older than zero seconds
+    numRemovedFiles = NoteHtmlRenderer::pruneDiskCache(
+        tmpDir.path(), maxTotalSize, /* max age = */ 0);
+
+    if ((numRemovedFiles != 1) || QFile::exists(filePaths[2])) {
+        error = QStringLiteral("Pruning by age didn't remove the old file");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace test
+} // namespace quentier
@@ -0,0 +1,50 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIB_QUENTIER_TESTS_NOTE_EDITOR_NOTE_HTML_RENDERER_TESTS_H
+#define LIB_QUENTIER_TESTS_NOTE_EDITOR_NOTE_HTML_RENDERER_TESTS_H
+
+#include <QString>
+
+namespace quentier {
+namespace test {
+
+bool testNoteHtmlRenderer(QString & error);
+
+bool testNoteHtmlRendererDiskCachePruning(QString & error);
+
+/**
+ * Composes note content of numParagraphs paragraphs, each containing
+ * a checkbox and a hyperlink
+ */
+QString composeNoteContentForRendering(const int numParagraphs);
+
+/**
+ * Renders the passed in note content with NoteHtmlRenderer in the current
+ * thread
+ *
+ * @return      Rendered HTML or empty string in case of error
+ */
+QString renderNoteHtml(
+    const QString & noteLocalUid, const QString & noteContent,
+    const QString & diskCacheDirPath);
+
+} // namespace test
+} // namespace quentier
+
+#endif // LIB_QUENTIER_TESTS_NOTE_EDITOR_NOTE_HTML_RENDERER_TESTS_H
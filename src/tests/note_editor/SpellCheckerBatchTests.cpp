@@ -0,0 +1,433 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpellCheckerBatchTests.h"
+
+#include <quentier/note_editor/SpellChecker.h>
+#include <quentier/types/Account.h>
+#include <quentier/utility/ApplicationSettings.h>
+#include <quentier/utility/FileIOProcessorAsync.h>
+
+#include <QEventLoop>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include <memory>
+
+#define SPELL_CHECKER_BATCH_TEST_LANGUAGE QStringLiteral("xx_SPELLTEST")
+
+#define SPELL_CHECKER_BATCH_TEST_TIMEOUT (10000)
+
+namespace quentier {
+namespace test {
+
+namespace {
+
+/**
+ * Sets up the spell checker with a single tiny dictionary known in advance
+ * so that the results of spell checking are deterministic; the previously
+ * cached set of found system dictionaries is restored on destruction
+ */
+class SpellCheckerTestEnvironment
+{
+public:
+    SpellCheckerTestEnvironment() = default;
+
+    ~SpellCheckerTestEnvironment()
+    {
+        m_pSpellChecker.reset();
+        m_pFileIOProcessorAsync.reset();
+
+        ApplicationSettings settings;
+        settings.beginGroup(QStringLiteral("SpellCheckerFoundDictionaries"));
+        settings.remove(QString());
+
+        if (!m_savedDictionaries.isEmpty()) {
+            settings.beginWriteArray(QStringLiteral("Dictionaries"));
+            for (int i = 0, size = m_savedDictionaries.size(); i < size; ++i)
+            {
+                settings.setArrayIndex(i);
+                const auto & entry = m_savedDictionaries[i];
+                for (auto it = entry.constBegin(), end = entry.constEnd();
+                     it != end; ++it)
+                {
+                    settings.setValue(it.key(), it.value());
+                }
+            }
+            settings.endArray();
+        }
+
+        settings.endGroup();
+    }
+
+    bool initialize(QString & error)
+    {
+        if (!m_tmpDir.isValid()) {
+            error = QStringLiteral("Failed to create temporary dir");
+            return false;
+        }
+
+        const QString dicFilePath =
+            m_tmpDir.path() + QStringLiteral("/spelltest.dic");
+
+        const QString affFilePath =
+            m_tmpDir.path() + QStringLiteral("/spelltest.aff");
+
+        if (!writeFile(dicFilePath, "3\nhello\nworld\nquentier\n", error) ||
+            !writeFile(affFilePath, "SET UTF-8\n", error))
+        {
+            return false;
+        }
+
+        saveAndReplaceFoundDictionaries(dicFilePath, affFilePath);
+
+        m_pFileIOProcessorAsync.reset(new FileIOProcessorAsync);
+
+        Account account(
+            QStringLiteral("SpellCheckerBatchTesterFakeUser"),
+            Account::Type::Local);
+
+        m_pSpellChecker.reset(new SpellChecker(
+            m_pFileIOProcessorAsync.get(), account, nullptr,
+            m_tmpDir.path() + QStringLiteral("/user_dictionary.txt")));
+
+        if (!m_pSpellChecker->isReady()) {
+            QEventLoop loop;
+
+            QObject::connect(
+                m_pSpellChecker.get(), &SpellChecker::ready, &loop,
+                &QEventLoop::quit);
+
+            QTimer::singleShot(
+                SPELL_CHECKER_BATCH_TEST_TIMEOUT, &loop, &QEventLoop::quit);
+
+            Q_UNUSED(loop.exec())
+
+            if (!m_pSpellChecker->isReady()) {
+                error = QStringLiteral("Spell checker didn't become ready");
+                return false;
+            }
+        }
+
+        m_pSpellChecker->enableDictionary(SPELL_CHECKER_BATCH_TEST_LANGUAGE);
+
+        if (!m_pSpellChecker->checkSpell(QStringLiteral("hello"))) {
+            error = QStringLiteral(
+                "Spell checker doesn't use the test dictionary: word "
+                "\"hello\" is considered misspelled");
+            return false;
+        }
+
+        return true;
+    }
+
+    SpellChecker & spellChecker()
+    {
+        return *m_pSpellChecker;
+    }
+
+    bool checkSpellBatch(
+        const QStringList & words, QStringList & misSpelledWords,
+        QString & error)
+    {
+        bool finished = false;
+        QUuid requestId;
+        QEventLoop loop;
+
+        QObject::connect(
+            m_pSpellChecker.get(), &SpellChecker::checkSpellBatchFinished,
+            &loop, [&](QUuid id, QStringList batchMisSpelledWords) {
+                if (id != requestId) {
+                    return;
+                }
+
+                misSpelledWords = batchMisSpelledWords;
+                finished = true;
+                loop.quit();
+            });
+
+        QTimer::singleShot(
+            SPELL_CHECKER_BATCH_TEST_TIMEOUT, &loop, &QEventLoop::quit);
+
+        requestId = m_pSpellChecker->checkSpellBatch(words);
+        Q_UNUSED(loop.exec())
+
+        if (!finished) {
+            error =
+                QStringLiteral("Spell check batch was not finished in time");
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    bool writeFile(
+        const QString & filePath, const QByteArray & data, QString & error)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly) || (file.write(data) < 0)) {
+            error = QStringLiteral("Failed to write file ") + filePath;
+            return false;
+        }
+
+        file.close();
+        return true;
+    }
+
+    void saveAndReplaceFoundDictionaries(
+        const QString & dicFilePath, const QString & affFilePath)
+    {
+        ApplicationSettings settings;
+        settings.beginGroup(QStringLiteral("SpellCheckerFoundDictionaries"));
+
+        int size = settings.beginReadArray(QStringLiteral("Dictionaries"));
+        for (int i = 0; i < size; ++i) {
+            settings.setArrayIndex(i);
+            QHash<QString, QVariant> entry;
+            const auto keys = settings.childKeys();
+            for (const auto & key: keys) {
+                entry[key] = settings.value(key);
+            }
+            m_savedDictionaries << entry;
+        }
+        settings.endArray();
+
+        settings.remove(QString());
+
+        settings.beginWriteArray(QStringLiteral("Dictionaries"));
+        settings.setArrayIndex(0);
+
+        settings.setValue(
+            QStringLiteral("LanguageKey"), SPELL_CHECKER_BATCH_TEST_LANGUAGE);
+
+        settings.setValue(QStringLiteral("DicFile"), dicFilePath);
+        settings.setValue(QStringLiteral("AffFile"), affFilePath);
+        settings.endArray();
+
+        settings.endGroup();
+    }
+
+private:
+    QTemporaryDir m_tmpDir;
+    QList<QHash<QString, QVariant>> m_savedDictionaries;
+    std::unique_ptr<FileIOProcessorAsync> m_pFileIOProcessorAsync;
+    std::unique_ptr<SpellChecker> m_pSpellChecker;
+};
+
+} // namespace
+
+bool testSpellCheckerBatchDeduplication(QString & error)
+{
+    SpellCheckerTestEnvironment environment;
+    if (!environment.initialize(error)) {
+        return false;
+    }
+
+    const QStringList words = QStringList()
+        << QStringLiteral("hello") << QStringLiteral("qzxw")
+        << QStringLiteral("qzxw") << QString() << QStringLiteral("world")
+        << QStringLiteral("vbnm") << QStringLiteral("qzxw")
+        << QStringLiteral("vbnm");
+
+    QStringList misSpelledWords;
+    if (!environment.checkSpellBatch(words, misSpelledWords, error)) {
+        return false;
+    }
+
+    if (misSpelledWords.size() != 2 ||
+        !misSpelledWords.contains(QStringLiteral("qzxw")) ||
+        !misSpelledWords.contains(QStringLiteral("vbnm")))
+    {
+        error = QStringLiteral(
+                    "Expected each misspelled word to be reported exactly "
+                    "once, got: ") +
+            misSpelledWords.join(QStringLiteral(", "));
+        return false;
+    }
+
+    // The second run of the same batch is served from the cache and must
+    // yield the same result
+    QStringList cachedMisSpelledWords;
+    if (!environment.checkSpellBatch(words, cachedMisSpelledWords, error)) {
+        return false;
+    }
+
+    misSpelledWords.sort();
+    cachedMisSpelledWords.sort();
+    if (cachedMisSpelledWords != misSpelledWords) {
+        error = QStringLiteral(
+                    "Cached batch result differs from the original one: ") +
+            cachedMisSpelledWords.join(QStringLiteral(", "));
+        return false;
+    }
+
+    return true;
+}
+
+bool testSpellCheckerBatchMatchesSingleWordChecks(QString & error)
+{
+    SpellCheckerTestEnvironment environment;
+    if (!environment.initialize(error)) {
+        return false;
+    }
+
+    const QStringList words = QStringList()
+        << QStringLiteral("hello") << QStringLiteral("Hello")
+        << QStringLiteral("HELLO") << QStringLiteral("world")
+        << QStringLiteral("quentier") << QStringLiteral("helo")
+        << QStringLiteral("wrold") << QStringLiteral("qzxw")
+        << QStringLiteral("Quentier") << QStringLiteral("worlds");
+
+    // Run the batch first so that its results are not taken from the cache
+    // populated by per-word checks
+    QStringList misSpelledWords;
+    if (!environment.checkSpellBatch(words, misSpelledWords, error)) {
+        return false;
+    }
+
+    // Per-word checks against a fresh spell checker which cache was not
+    // populated by the batch
+    SpellCheckerTestEnvironment referenceEnvironment;
+    if (!referenceEnvironment.initialize(error)) {
+        return false;
+    }
+
+    for (const auto & word: qAsConst(words)) {
+        const bool batchCorrect = !misSpelledWords.contains(word);
+        const bool singleCorrect =
+            referenceEnvironment.spellChecker().checkSpell(word);
+
+        if (batchCorrect != singleCorrect) {
+            error = QStringLiteral("Batch spell check result for word \"") +
+                word + QStringLiteral("\" doesn't match checkSpell: ") +
+                (batchCorrect ? QStringLiteral("correct in batch")
+                              : QStringLiteral("misspelled in batch"));
+            return false;
+        }
+
+        // Now the result is cached by the batch, checkSpell must agree
+        if (environment.spellChecker().checkSpell(word) != batchCorrect) {
+            error = QStringLiteral("Cached result for word \"") + word +
+                QStringLiteral("\" doesn't match the batch result");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool testSpellCheckerBatchCacheInvalidation(QString & error)
+{
+    SpellCheckerTestEnvironment environment;
+    if (!environment.initialize(error)) {
+        return false;
+    }
+
+    SpellChecker & spellChecker = environment.spellChecker();
+
+    const QString userWord = QStringLiteral("qzxw");
+    const QString ignoredWord = QStringLiteral("vbnm");
+    const QString dictionaryWord = QStringLiteral("hello");
+
+    const QStringList words = QStringList()
+        << userWord << ignoredWord << dictionaryWord;
+
+    QStringList misSpelledWords;
+    if (!environment.checkSpellBatch(words, misSpelledWords, error)) {
+        return false;
+    }
+
+    if (misSpelledWords.size() != 2 || !misSpelledWords.contains(userWord) ||
+        !misSpelledWords.contains(ignoredWord))
+    {
+        error = QStringLiteral("Unexpected initial batch result: ") +
+            misSpelledWords.join(QStringLiteral(", "));
+        return false;
+    }
+
+    // Both words are cached as misspelled at this point
+    spellChecker.addToUserWordlist(userWord);
+
+    if (!environment.checkSpellBatch(words, misSpelledWords, error)) {
+        return false;
+    }
+
+    if (misSpelledWords != QStringList(ignoredWord)) {
+        error = QStringLiteral(
+                    "Cache was not invalidated on adding the word to user "
+                    "wordlist: ") +
+            misSpelledWords.join(QStringLiteral(", "));
+        return false;
+    }
+
+    spellChecker.ignoreWord(ignoredWord);
+
+    if (!environment.checkSpellBatch(words, misSpelledWords, error)) {
+        return false;
+    }
+
+    if (!misSpelledWords.isEmpty()) {
+        error = QStringLiteral(
+                    "Cache was not invalidated on ignoring the word: ") +
+            misSpelledWords.join(QStringLiteral(", "));
+        return false;
+    }
+
+    // The dictionary word is cached as correct at this point
+    spellChecker.disableDictionary(SPELL_CHECKER_BATCH_TEST_LANGUAGE);
+
+    if (!environment.checkSpellBatch(
+            QStringList(dictionaryWord), misSpelledWords, error))
+    {
+        return false;
+    }
+
+    if (misSpelledWords != QStringList(dictionaryWord)) {
+        error = QStringLiteral(
+            "Cache was not invalidated on disabling the dictionary");
+        return false;
+    }
+
+    if (spellChecker.checkSpell(dictionaryWord)) {
+        error = QStringLiteral(
+            "checkSpell considers the word correct after disabling "
+            "the dictionary");
+        return false;
+    }
+
+    spellChecker.enableDictionary(SPELL_CHECKER_BATCH_TEST_LANGUAGE);
+
+    if (!environment.checkSpellBatch(
+            QStringList(dictionaryWord), misSpelledWords, error))
+    {
+        return false;
+    }
+
+    if (!misSpelledWords.isEmpty()) {
+        error = QStringLiteral(
+            "Cache was not invalidated on enabling the dictionary");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace test
+} // namespace quentier
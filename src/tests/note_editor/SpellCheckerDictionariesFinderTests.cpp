@@ -0,0 +1,185 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SpellCheckerDictionariesFinderTests.h"
+
+#include "../../note_editor/SpellCheckerDictionariesFinder.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThread>
+
+namespace quentier {
+namespace test {
+
+namespace {
+
+bool createFile(const QString & filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    file.write("1\nword\n");
+    file.close();
+    return true;
+}
+
+SpellCheckerDictionariesFinder::DicAndAffFilesByDictionaryName
+findDictionaries(const QString & rootPath)
+{
+    SpellCheckerDictionariesFinder::DicAndAffFilesByDictionaryName result;
+
+    SpellCheckerDictionariesFinder finder(
+        std::make_shared<QAtomicInt>(), QStringList() << rootPath);
+
+    QObject::connect(
+        &finder, &SpellCheckerDictionariesFinder::foundDictionaries,
+        [&result](
+            SpellCheckerDictionariesFinder::DicAndAffFilesByDictionaryName
+                files) { result = files; });
+
+    // Running synchronously on purpose, the signal is delivered via direct
+    // connection
+    finder.run();
+    return result;
+}
+
+} // namespace
+
+bool testSpellCheckerDictionariesFinder(QString & error)
+{
+    QTemporaryDir tmpDir;
+    if (!tmpDir.isValid()) {
+        error = QStringLiteral("Failed to create temporary dir");
+        return false;
+    }
+
+    QString rootPath = tmpDir.path() + QStringLiteral("/hunspell");
+    if (!QDir().mkpath(rootPath)) {
+        error = QStringLiteral("Failed to create dir ") + rootPath;
+        return false;
+    }
+
+    if (!createFile(rootPath + QStringLiteral("/en_US.dic")) ||
+        !createFile(rootPath + QStringLiteral("/en_US.aff")) ||
+        !createFile(rootPath + QStringLiteral("/ru_RU.dic")) ||
+        !createFile(rootPath + QStringLiteral("/not_a_locale.dic")) ||
+        !createFile(rootPath + QStringLiteral("/not_a_locale.aff")))
+    {
+        error = QStringLiteral("Failed to create dictionary files");
+        return false;
+    }
+
+    SpellCheckerDictionariesFinder::clearDictionariesIndex();
+
+    auto files = findDictionaries(rootPath);
+    if (files.size() != 1 || !files.contains(QStringLiteral("en_US"))) {
+        error = QStringLiteral(
+                    "Unexpected dictionaries found on the first scan: ") +
+            QStringList(files.keys()).join(QStringLiteral(", "));
+        return false;
+    }
+
+    const auto & pair = files[QStringLiteral("en_US")];
+    if (pair.first != rootPath + QStringLiteral("/en_US.dic") ||
+        pair.second != rootPath + QStringLiteral("/en_US.aff"))
+    {
+        error = QStringLiteral("Unexpected dic/aff files: ") + pair.first +
+            QStringLiteral(", ") + pair.second;
+        return false;
+    }
+
+    // Second scan should yield the same result from the index
+    auto indexedFiles = findDictionaries(rootPath);
+    if (indexedFiles != files) {
+        error = QStringLiteral(
+            "Dictionaries found via the index differ from those found "
+            "on the first scan");
+        return false;
+    }
+
+    // Directory modification times might have a coarse resolution on some
+    // filesystems so need to wait a bit before changing the dir contents
+    QThread::msleep(1100);
+
+    QString subdirPath = rootPath + QStringLiteral("/dicts");
+    if (!QDir().mkpath(subdirPath) ||
+        !createFile(subdirPath + QStringLiteral("/de_DE.dic")) ||
+        !createFile(subdirPath + QStringLiteral("/de_DE.aff")) ||
+        !createFile(rootPath + QStringLiteral("/ru_RU.aff")))
+    {
+        error = QStringLiteral("Failed to create more dictionary files");
+        return false;
+    }
+
+    files = findDictionaries(rootPath);
+    if (files.size() != 3 || !files.contains(QStringLiteral("en_US")) ||
+        !files.contains(QStringLiteral("ru_RU")) ||
+        !files.contains(QStringLiteral("de_DE")))
+    {
+        error = QStringLiteral(
+                    "Unexpected dictionaries found after changing the dir: ") +
+            QStringList(files.keys()).join(QStringLiteral(", "));
+        return false;
+    }
+
+    SpellCheckerDictionariesFinder::clearDictionariesIndex();
+    return true;
+}
+
+bool createSpellCheckerDictionariesTree(
+    const QString & rootPath, const int numDirs, const int numSubdirs,
+    QString & error)
+{
+    QDir rootDir(rootPath);
+    for (int i = 0; i < numDirs; ++i) {
+        for (int j = 0; j < numSubdirs; ++j) {
+            QString subdirPath = rootPath + QStringLiteral("/dir") +
+                QString::number(i) + QStringLiteral("/subdir") +
+                QString::number(j);
+
+            if (!rootDir.mkpath(subdirPath)) {
+                error = QStringLiteral("Failed to create dir ") + subdirPath;
+                return false;
+            }
+
+            if (!createFile(subdirPath + QStringLiteral("/en_US.dic")) ||
+                !createFile(subdirPath + QStringLiteral("/en_US.aff")) ||
+                !createFile(subdirPath + QStringLiteral("/ru_RU.dic")) ||
+                !createFile(subdirPath + QStringLiteral("/readme.txt")))
+            {
+                error = QStringLiteral("Failed to create files within ") +
+                    subdirPath;
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int runSpellCheckerDictionariesFinder(const QString & rootPath)
+{
+    return findDictionaries(rootPath).size();
+}
+
+} // namespace test
+} // namespace quentier
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "UndoStackDataStorageTests.h"
+
+#include "../../note_editor/undo_stack/UndoStackDataStorage.h"
+
+#include <quentier/types/Resource.h>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QTemporaryDir>
+
+namespace quentier {
+namespace test {
+
+namespace {
+
+QByteArray dataHash(const QByteArray & data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Md5);
+}
+
+} // namespace
+
+bool testUndoStackDataStorage(QString & error)
+{
+    QTemporaryDir tmpDir;
+    if (!tmpDir.isValid()) {
+        error = QStringLiteral("Failed to create temporary dir");
+        return false;
+    }
+
+    const QString storageDirPath =
+        tmpDir.path() + QStringLiteral("/undo_stack_data");
+
+    const QByteArray first(600, 'a');
+    const QByteArray second(600, 'b');
+
+    {
+        UndoStackDataStorage storage(storageDirPath, 1000);
+
+        Resource resource;
+        resource.setDataBody(first);
+        resource.setDataHash(dataHash(first));
+
+        QList<QByteArray> dataHashes;
+        storage.stripResourceData(resource, dataHashes);
+
+        if (resource.hasDataBody() || dataHashes.size() != 1) {
+            error = QStringLiteral(
+                "Resource data body was not moved into the storage");
+            return false;
+        }
+
+        // The same data referenced twice should be stored only once
+        storage.addData(dataHash(first), first);
+        if (storage.memoryUsage() != first.size()) {
+            error = QStringLiteral("Duplicate data was stored twice");
+            return false;
+        }
+
+        // Exceeding the limit should move the earliest data into a file
+        storage.addData(dataHash(second), second);
+        if (storage.memoryUsage() != second.size()) {
+            error = QStringLiteral(
+                "The earliest data was not moved out of memory");
+            return false;
+        }
+
+        if (storage.fileUsage() != first.size()) {
+            error = QStringLiteral(
+                "The size of data moved to files was not accounted");
+            return false;
+        }
+
+        ErrorString errorDescription;
+        if (!storage.restoreResourceData(resource, errorDescription)) {
+            error = errorDescription.nonLocalizedString();
+            return false;
+        }
+
+        if (!resource.hasDataBody() || resource.dataBody() != first) {
+            error = QStringLiteral(
+                "Resource data body restored from file doesn't match "
+                "the original one");
+            return false;
+        }
+
+        storage.releaseData(dataHash(first));
+        if (!storage.hasData(dataHash(first))) {
+            error = QStringLiteral("Data was released while still referenced");
+            return false;
+        }
+
+        storage.releaseData(dataHash(first));
+        storage.releaseData(dataHash(second));
+        if (storage.hasData(dataHash(first)) ||
+            storage.hasData(dataHash(second)) || storage.memoryUsage() != 0 ||
+            storage.fileUsage() != 0)
+        {
+            error = QStringLiteral("Released data is still in the storage");
+            return false;
+        }
+    }
+
+    if (QDir(storageDirPath).exists()) {
+        error = QStringLiteral("Storage dir was not removed on destruction");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace test
+} // namespace quentier
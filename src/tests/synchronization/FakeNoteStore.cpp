@@ -1707,6 +1707,49 @@ qint32 FakeNoteStore::maxUsnBeforeAPIRateLimitsExceeding(
     return it.value();
 }
 
+const QVector<qint32> & FakeNoteStore::userOwnSyncChunkRequestsAfterUsns()
+    const
+{
+    return m_data->m_userOwnSyncChunkRequestsAfterUsns;
+}
+
+void FakeNoteStore::clearUserOwnSyncChunkRequestsAfterUsns()
+{
+    m_data->m_userOwnSyncChunkRequestsAfterUsns.clear();
+}
+
+const QHash<QString, QVector<qint32>> &
+FakeNoteStore::linkedNotebookSyncChunkRequestsAfterUsns() const
+{
+    return m_data->m_linkedNotebookSyncChunkRequestsAfterUsns;
+}
+
+int FakeNoteStore::maxLinkedNotebookSyncStateAsyncRequestsPerShard() const
+{
+    return m_data->m_maxLinkedNotebookSyncStateAsyncRequestsPerShard;
+}
+
+int FakeNoteStore::maxLinkedNotebookSyncChunkAsyncRequestsPerShard() const
+{
+    return m_data->m_maxLinkedNotebookSyncChunkAsyncRequestsPerShard;
+}
+
+void FakeNoteStore::discardPendingAsyncRequests()
+{
+    m_data->m_getNoteAsyncRequests.clear();
+    m_data->m_getResourceAsyncRequests.clear();
+    m_data->m_getLinkedNotebookSyncStateAsyncRequests.clear();
+    m_data->m_getLinkedNotebookSyncChunkAsyncRequests.clear();
+
+    m_data->m_getNoteAsyncDelayTimerIds.clear();
+    m_data->m_getResourceAsyncDelayTimerIds.clear();
+    m_data->m_getLinkedNotebookSyncStateAsyncDelayTimerIds.clear();
+    m_data->m_getLinkedNotebookSyncChunkAsyncDelayTimerIds.clear();
+
+    m_data->m_linkedNotebookSyncStateAsyncRequestsByShardId.clear();
+    m_data->m_linkedNotebookSyncChunkAsyncRequestsByShardId.clear();
+}
+
 INoteStore * FakeNoteStore::create() const
 {
     return new FakeNoteStore(m_data);
@@ -1740,6 +1783,20 @@ void FakeNoteStore::stop()
         killTimer(timerId);
     }
     m_data->m_getResourceAsyncDelayTimerIds.clear();
+
+    for (auto timerId:
+         qAsConst(m_data->m_getLinkedNotebookSyncStateAsyncDelayTimerIds))
+    {
+        killTimer(timerId);
+    }
+    m_data->m_getLinkedNotebookSyncStateAsyncDelayTimerIds.clear();
+
+    for (auto timerId:
+         qAsConst(m_data->m_getLinkedNotebookSyncChunkAsyncDelayTimerIds))
+    {
+        killTimer(timerId);
+    }
+    m_data->m_getLinkedNotebookSyncChunkAsyncDelayTimerIds.clear();
 }
 
 qint32 FakeNoteStore::createNotebook(
@@ -2457,6 +2514,8 @@ qint32 FakeNoteStore::getSyncChunk(
             << afterUSN << ", max entries = " << maxEntries
             << ", filter = " << filter);
 
+    m_data->m_userOwnSyncChunkRequestsAfterUsns << afterUSN;
+
     if (m_data->m_APIRateLimitsTrigger ==
         APIRateLimitsTrigger::OnGetUserOwnSyncChunkAttempt)
     {
@@ -2526,6 +2585,43 @@ qint32 FakeNoteStore::getLinkedNotebookSyncState(
     return 0;
 }
 
+bool FakeNoteStore::getLinkedNotebookSyncStateAsync(
+    const qevercloud::LinkedNotebook & linkedNotebook,
+    const QString & authToken, ErrorString & errorDescription)
+{
+    if (Q_UNLIKELY(!linkedNotebook.guid.isSet())) {
+        errorDescription.setBase("Linked notebook guid is not set");
+        return false;
+    }
+
+    GetLinkedNotebookSyncStateAsyncRequest request;
+    request.m_linkedNotebook = linkedNotebook;
+    request.m_authToken = authToken;
+
+    m_data->m_getLinkedNotebookSyncStateAsyncRequests.enqueue(request);
+
+    int & numRequests =
+        m_data->m_linkedNotebookSyncStateAsyncRequestsByShardId
+            [linkedNotebook.shardId.isSet() ? linkedNotebook.shardId.ref()
+                                            : QString()];
+    ++numRequests;
+
+    m_data->m_maxLinkedNotebookSyncStateAsyncRequestsPerShard = std::max(
+        m_data->m_maxLinkedNotebookSyncStateAsyncRequestsPerShard,
+        numRequests);
+
+    int timerId = startTimer(0);
+
+    QNDEBUG(
+        "tests:synchronization",
+        "Started timer to postpone the get linked notebook sync state "
+            << "result, timer id = " << timerId);
+
+    Q_UNUSED(
+        m_data->m_getLinkedNotebookSyncStateAsyncDelayTimerIds.insert(timerId))
+    return true;
+}
+
 qint32 FakeNoteStore::getLinkedNotebookSyncChunk(
     const qevercloud::LinkedNotebook & linkedNotebook, const qint32 afterUSN,
     const qint32 maxEntries, const QString & linkedNotebookAuthToken,
@@ -2540,6 +2636,11 @@ qint32 FakeNoteStore::getLinkedNotebookSyncChunk(
             << ", linked notebook auth token = " << linkedNotebookAuthToken
             << ", full sync only = " << (fullSyncOnly ? "true" : "false"));
 
+    m_data->m_linkedNotebookSyncChunkRequestsAfterUsns
+            [linkedNotebook.guid.isSet() ? linkedNotebook.guid.ref()
+                                         : QString()]
+        << afterUSN;
+
     if (m_data->m_APIRateLimitsTrigger ==
         APIRateLimitsTrigger::OnGetLinkedNotebookSyncChunkAttempt)
     {
@@ -2599,6 +2700,47 @@ qint32 FakeNoteStore::getLinkedNotebookSyncChunk(
         syncChunk, errorDescription);
 }
 
+bool FakeNoteStore::getLinkedNotebookSyncChunkAsync(
+    const qevercloud::LinkedNotebook & linkedNotebook, const qint32 afterUSN,
+    const qint32 maxEntries, const QString & linkedNotebookAuthToken,
+    const bool fullSyncOnly, ErrorString & errorDescription)
+{
+    if (Q_UNLIKELY(!linkedNotebook.guid.isSet())) {
+        errorDescription.setBase("Linked notebook guid is not set");
+        return false;
+    }
+
+    GetLinkedNotebookSyncChunkAsyncRequest request;
+    request.m_linkedNotebook = linkedNotebook;
+    request.m_afterUsn = afterUSN;
+    request.m_maxEntries = maxEntries;
+    request.m_authToken = linkedNotebookAuthToken;
+    request.m_fullSyncOnly = fullSyncOnly;
+
+    m_data->m_getLinkedNotebookSyncChunkAsyncRequests.enqueue(request);
+
+    int & numRequests =
+        m_data->m_linkedNotebookSyncChunkAsyncRequestsByShardId
+            [linkedNotebook.shardId.isSet() ? linkedNotebook.shardId.ref()
+                                            : QString()];
+    ++numRequests;
+
+    m_data->m_maxLinkedNotebookSyncChunkAsyncRequestsPerShard = std::max(
+        m_data->m_maxLinkedNotebookSyncChunkAsyncRequestsPerShard,
+        numRequests);
+
+    int timerId = startTimer(0);
+
+    QNDEBUG(
+        "tests:synchronization",
+        "Started timer to postpone the get linked notebook sync chunk "
+            << "result, timer id = " << timerId);
+
+    Q_UNUSED(
+        m_data->m_getLinkedNotebookSyncChunkAsyncDelayTimerIds.insert(timerId))
+    return true;
+}
+
 qint32 FakeNoteStore::getNote(
     const bool withContent, const bool withResourcesData,
     const bool withResourcesRecognition, const bool withResourcesAlternateData,
@@ -3066,6 +3208,104 @@ void FakeNoteStore::timerEvent(QTimerEvent * pEvent)
         return;
     }
 
+    auto syncStateIt =
+        m_data->m_getLinkedNotebookSyncStateAsyncDelayTimerIds.find(
+            pEvent->timerId());
+
+    if (syncStateIt !=
+        m_data->m_getLinkedNotebookSyncStateAsyncDelayTimerIds.end())
+    {
+        QNDEBUG(
+            "tests:synchronization",
+            "getLinkedNotebookSyncStateAsync delay timer event, "
+                << "timer id = " << pEvent->timerId());
+
+        Q_UNUSED(
+            m_data->m_getLinkedNotebookSyncStateAsyncDelayTimerIds.erase(
+                syncStateIt))
+        killTimer(pEvent->timerId());
+
+        if (!m_data->m_getLinkedNotebookSyncStateAsyncRequests.isEmpty()) {
+            auto request =
+                m_data->m_getLinkedNotebookSyncStateAsyncRequests.dequeue();
+
+            --m_data->m_linkedNotebookSyncStateAsyncRequestsByShardId
+                  [request.m_linkedNotebook.shardId.isSet()
+                       ? request.m_linkedNotebook.shardId.ref()
+                       : QString()];
+
+            qint32 rateLimitSeconds = 0;
+            ErrorString errorDescription;
+            qevercloud::SyncState syncState;
+
+            qint32 res = getLinkedNotebookSyncState(
+                request.m_linkedNotebook, request.m_authToken, syncState,
+                errorDescription, rateLimitSeconds);
+
+            Q_EMIT getLinkedNotebookSyncStateAsyncFinished(
+                res, request.m_linkedNotebook.guid.ref(), syncState,
+                rateLimitSeconds, errorDescription);
+        }
+        else {
+            QNWARNING(
+                "tests:synchronization",
+                "Get linked notebook sync state async requests "
+                    << "queue is empty");
+        }
+
+        return;
+    }
+
+    auto syncChunkIt =
+        m_data->m_getLinkedNotebookSyncChunkAsyncDelayTimerIds.find(
+            pEvent->timerId());
+
+    if (syncChunkIt !=
+        m_data->m_getLinkedNotebookSyncChunkAsyncDelayTimerIds.end())
+    {
+        QNDEBUG(
+            "tests:synchronization",
+            "getLinkedNotebookSyncChunkAsync delay timer event, "
+                << "timer id = " << pEvent->timerId());
+
+        Q_UNUSED(
+            m_data->m_getLinkedNotebookSyncChunkAsyncDelayTimerIds.erase(
+                syncChunkIt))
+        killTimer(pEvent->timerId());
+
+        if (!m_data->m_getLinkedNotebookSyncChunkAsyncRequests.isEmpty()) {
+            auto request =
+                m_data->m_getLinkedNotebookSyncChunkAsyncRequests.dequeue();
+
+            --m_data->m_linkedNotebookSyncChunkAsyncRequestsByShardId
+                  [request.m_linkedNotebook.shardId.isSet()
+                       ? request.m_linkedNotebook.shardId.ref()
+                       : QString()];
+
+            qint32 rateLimitSeconds = 0;
+            ErrorString errorDescription;
+            qevercloud::SyncChunk syncChunk;
+
+            qint32 res = getLinkedNotebookSyncChunk(
+                request.m_linkedNotebook, request.m_afterUsn,
+                request.m_maxEntries, request.m_authToken,
+                request.m_fullSyncOnly, syncChunk, errorDescription,
+                rateLimitSeconds);
+
+            Q_EMIT getLinkedNotebookSyncChunkAsyncFinished(
+                res, request.m_linkedNotebook.guid.ref(), request.m_afterUsn,
+                syncChunk, rateLimitSeconds, errorDescription);
+        }
+        else {
+            QNWARNING(
+                "tests:synchronization",
+                "Get linked notebook sync chunk async requests "
+                    << "queue is empty");
+        }
+
+        return;
+    }
+
     INoteStore::timerEvent(pEvent);
 }
 
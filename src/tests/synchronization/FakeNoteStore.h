@@ -40,6 +40,7 @@
 #include <QHash>
 #include <QQueue>
 #include <QSet>
+#include <QVector>
 
 #include <memory>
 
@@ -211,6 +212,41 @@ public:
     qint32 maxUsnBeforeAPIRateLimitsExceeding(
         const QString & linkedNotebookGuid = {}) const;
 
+    /**
+     * @return      After USN values of requests for user's own sync chunks in
+     *              the order in which the requests were received
+     */
+    const QVector<qint32> & userOwnSyncChunkRequestsAfterUsns() const;
+    void clearUserOwnSyncChunkRequestsAfterUsns();
+
+    /**
+     * @return      After USN values of requests for linked notebooks' sync
+     *              chunks per linked notebook guid, in the order in which
+     *              the requests were received
+     */
+    const QHash<QString, QVector<qint32>> &
+    linkedNotebookSyncChunkRequestsAfterUsns() const;
+
+    /**
+     * @return      The maximal number of async linked notebook sync state
+     *              requests to the same shard which were waiting for
+     *              the reply at the same time
+     */
+    int maxLinkedNotebookSyncStateAsyncRequestsPerShard() const;
+
+    /**
+     * @return      The maximal number of async linked notebook sync chunk
+     *              requests to the same shard which were waiting for
+     *              the reply at the same time
+     */
+    int maxLinkedNotebookSyncChunkAsyncRequestsPerShard() const;
+
+    /**
+     * Drops the async requests which haven't been replied to yet, i.e. when
+     * the synchronizing agent which has sent them is gone
+     */
+    void discardPendingAsyncRequests();
+
 public:
     // INoteStore interface
     virtual INoteStore * create() const override;
@@ -273,6 +309,10 @@ public:
         const QString & authToken, qevercloud::SyncState & syncState,
         ErrorString & errorDescription, qint32 & rateLimitSeconds) override;
 
+    virtual bool getLinkedNotebookSyncStateAsync(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const QString & authToken, ErrorString & errorDescription) override;
+
     virtual qint32 getLinkedNotebookSyncChunk(
         const qevercloud::LinkedNotebook & linkedNotebook,
         const qint32 afterUSN, const qint32 maxEntries,
@@ -280,6 +320,12 @@ public:
         qevercloud::SyncChunk & syncChunk, ErrorString & errorDescription,
         qint32 & rateLimitSeconds) override;
 
+    virtual bool getLinkedNotebookSyncChunkAsync(
+        const qevercloud::LinkedNotebook & linkedNotebook,
+        const qint32 afterUSN, const qint32 maxEntries,
+        const QString & linkedNotebookAuthToken, const bool fullSyncOnly,
+        ErrorString & errorDescription) override;
+
     virtual qint32 getNote(
         const bool withContent, const bool withResourcesData,
         const bool withResourcesRecognition,
@@ -802,6 +848,25 @@ private:
         QString m_authToken;
     };
 
+    // Struct encapsulating parameters required for a single async
+    // getLinkedNotebookSyncState request
+    struct GetLinkedNotebookSyncStateAsyncRequest
+    {
+        qevercloud::LinkedNotebook m_linkedNotebook;
+        QString m_authToken;
+    };
+
+    // Struct encapsulating parameters required for a single async
+    // getLinkedNotebookSyncChunk request
+    struct GetLinkedNotebookSyncChunkAsyncRequest
+    {
+        qevercloud::LinkedNotebook m_linkedNotebook;
+        qint32 m_afterUsn = 0;
+        qint32 m_maxEntries = 0;
+        QString m_authToken;
+        bool m_fullSyncOnly = false;
+    };
+
     // Struct serving as a collection of guids of items
     // which were sent to the agent synchronizing with FakeNoteStore
     // in their entirety i.e. while saved searches, tags, notebooks, linked
@@ -855,6 +920,8 @@ private:
 
         QSet<int> m_getNoteAsyncDelayTimerIds;
         QSet<int> m_getResourceAsyncDelayTimerIds;
+        QSet<int> m_getLinkedNotebookSyncStateAsyncDelayTimerIds;
+        QSet<int> m_getLinkedNotebookSyncChunkAsyncDelayTimerIds;
 
         quint32 m_maxNumSavedSearches =
             static_cast<quint32>(qevercloud::EDAM_USER_SAVED_SEARCHES_MAX);
@@ -891,6 +958,15 @@ private:
         QHash<QString, qint32>
             m_maxUsnsForLinkedNotebooksDataBeforeRateLimitBreach;
 
+        QVector<qint32> m_userOwnSyncChunkRequestsAfterUsns;
+        QHash<QString, QVector<qint32>>
+            m_linkedNotebookSyncChunkRequestsAfterUsns;
+
+        QHash<QString, int> m_linkedNotebookSyncStateAsyncRequestsByShardId;
+        QHash<QString, int> m_linkedNotebookSyncChunkAsyncRequestsByShardId;
+        int m_maxLinkedNotebookSyncStateAsyncRequestsPerShard = 0;
+        int m_maxLinkedNotebookSyncChunkAsyncRequestsPerShard = 0;
+
         QString m_noteStoreUrl;
 
         QString m_authenticationToken;
@@ -898,6 +974,12 @@ private:
 
         QQueue<GetNoteAsyncRequest> m_getNoteAsyncRequests;
         QQueue<GetResourceAsyncRequest> m_getResourceAsyncRequests;
+
+        QQueue<GetLinkedNotebookSyncStateAsyncRequest>
+            m_getLinkedNotebookSyncStateAsyncRequests;
+
+        QQueue<GetLinkedNotebookSyncChunkAsyncRequest>
+            m_getLinkedNotebookSyncChunkAsyncRequests;
     };
 
     FakeNoteStore(std::shared_ptr<Data> data);
@@ -0,0 +1,321 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyncChunksBufferTester.h"
+
+#include "../../synchronization/SyncChunksBuffer.h"
+
+#include <quentier/utility/UidGenerator.h>
+
+#include <QDateTime>
+#include <QtTest/QTest>
+
+namespace quentier {
+namespace test {
+
+namespace {
+
+qevercloud::SyncChunk createSyncChunk(const qint32 lowUsn)
+{
+    qint32 usn = lowUsn;
+
+    qevercloud::SyncChunk syncChunk;
+    syncChunk.currentTime = QDateTime::currentMSecsSinceEpoch();
+    syncChunk.updateCount = lowUsn + 100;
+
+    qevercloud::Notebook notebook;
+    notebook.guid = UidGenerator::Generate();
+    notebook.name = QStringLiteral("Notebook #") + QString::number(lowUsn);
+    notebook.updateSequenceNum = usn++;
+    notebook.defaultNotebook = false;
+    notebook.serviceCreated = QDateTime::currentMSecsSinceEpoch();
+
+    qevercloud::NotebookRestrictions notebookRestrictions;
+    notebookRestrictions.noCreateTags = true;
+    notebookRestrictions.updateWhichSharedNotebookRestrictions =
+        qevercloud::SharedNotebookInstanceRestrictions::NO_SHARED_NOTEBOOKS;
+    notebook.restrictions = notebookRestrictions;
+
+    syncChunk.notebooks = QList<qevercloud::Notebook>() << notebook;
+
+    qevercloud::Tag tag;
+    tag.guid = UidGenerator::Generate();
+    tag.name = QStringLiteral("Tag #") + QString::number(lowUsn);
+    tag.updateSequenceNum = usn++;
+    syncChunk.tags = QList<qevercloud::Tag>() << tag;
+
+    qevercloud::SavedSearch search;
+    search.guid = UidGenerator::Generate();
+    search.name = QStringLiteral("Saved search #") + QString::number(lowUsn);
+    search.query = QStringLiteral("tag:\"") + tag.name.ref() +
+        QStringLiteral("\"");
+    search.format = qevercloud::QueryFormat::USER;
+    search.updateSequenceNum = usn++;
+    syncChunk.searches = QList<qevercloud::SavedSearch>() << search;
+
+    qevercloud::Note note;
+    note.guid = UidGenerator::Generate();
+    note.title = QStringLiteral("Note #") + QString::number(lowUsn);
+    note.content = QStringLiteral("<en-note><h1>Hello, world</h1></en-note>");
+    note.updateSequenceNum = usn++;
+    note.notebookGuid = notebook.guid;
+    note.tagGuids = QList<qevercloud::Guid>() << tag.guid.ref();
+    note.active = true;
+
+    qevercloud::NoteAttributes noteAttributes;
+    noteAttributes.latitude = 53.0;
+    noteAttributes.author = QStringLiteral("Author");
+
+    qevercloud::LazyMap applicationData;
+    applicationData.fullMap = QMap<QString, QString>();
+    applicationData.fullMap.ref()[QStringLiteral("key")] =
+        QStringLiteral("value");
+    noteAttributes.applicationData = applicationData;
+    note.attributes = noteAttributes;
+
+    syncChunk.notes = QList<qevercloud::Note>() << note;
+
+    qevercloud::Resource resource;
+    resource.guid = UidGenerator::Generate();
+    resource.noteGuid = note.guid;
+    resource.mime = QStringLiteral("application/octet-stream");
+    resource.updateSequenceNum = usn++;
+
+    qevercloud::Data data;
+    data.body = QByteArray("Fake resource data body");
+    data.size = data.body->size();
+    resource.data = data;
+
+    syncChunk.resources = QList<qevercloud::Resource>() << resource;
+
+    syncChunk.expungedNotes =
+        QList<qevercloud::Guid>() << UidGenerator::Generate();
+
+    syncChunk.chunkHighUSN = usn;
+    return syncChunk;
+}
+
+} // namespace
+
+SyncChunksBufferTester::SyncChunksBufferTester(QObject * parent) :
+    QObject(parent)
+{}
+
+void SyncChunksBufferTester::testEmptyBuffer()
+{
+    SyncChunksBuffer buffer(2);
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.size(), 0);
+    QCOMPARE(buffer.bufferedBytes(), quint64(0));
+    QCOMPARE(buffer.peakBufferedBytes(), quint64(0));
+
+    qevercloud::SyncChunk syncChunk;
+    ErrorString errorDescription;
+    QVERIFY(!buffer.syncChunk(0, syncChunk, errorDescription));
+    QVERIFY(!errorDescription.isEmpty());
+}
+
+void SyncChunksBufferTester::testKeepSyncChunksInMemoryUpToLimit()
+{
+    SyncChunksBuffer buffer(2);
+
+    buffer.append(createSyncChunk(1));
+    const quint64 bytesAfterFirst = buffer.bufferedBytes();
+    QVERIFY(bytesAfterFirst > 0);
+
+    buffer.append(createSyncChunk(100));
+    const quint64 bytesAfterSecond = buffer.bufferedBytes();
+    QVERIFY(bytesAfterSecond > bytesAfterFirst);
+
+    // The following sync chunks should go to disk
+    for (qint32 i = 2; i < 10; ++i) {
+        buffer.append(createSyncChunk(i * 100));
+    }
+
+    QCOMPARE(buffer.size(), 10);
+    QCOMPARE(buffer.bufferedBytes(), bytesAfterSecond);
+    QCOMPARE(buffer.peakBufferedBytes(), bytesAfterSecond);
+}
+
+void SyncChunksBufferTester::testReadBackSyncChunksBufferedOnDisk()
+{
+    SyncChunksBuffer buffer(1);
+
+    QVector<qevercloud::SyncChunk> syncChunks;
+    for (qint32 i = 0; i < 5; ++i) {
+        syncChunks << createSyncChunk(i * 100 + 1);
+        buffer.append(syncChunks.back());
+    }
+
+    QCOMPARE(buffer.size(), syncChunks.size());
+
+    // Read in reverse order to ensure the offsets within the file are used
+    for (int i = syncChunks.size() - 1; i >= 0; --i) {
+        qevercloud::SyncChunk syncChunk;
+        ErrorString errorDescription;
+        QVERIFY2(
+            buffer.syncChunk(i, syncChunk, errorDescription),
+            qPrintable(errorDescription.nonLocalizedString()));
+
+        QVERIFY2(
+            syncChunk == syncChunks[i],
+            qPrintable(
+                QStringLiteral("Sync chunk #") + QString::number(i) +
+                QStringLiteral(" read back from the buffer differs from "
+                               "the original one")));
+    }
+}
+
+void SyncChunksBufferTester::testRemoveResourceFromSyncChunks()
+{
+    SyncChunksBuffer buffer(1);
+
+    auto firstSyncChunk = createSyncChunk(1);
+    auto secondSyncChunk = createSyncChunk(100);
+    buffer.append(firstSyncChunk);
+    buffer.append(secondSyncChunk);
+
+    buffer.removeResource(firstSyncChunk.resources->at(0).guid.ref());
+    buffer.removeResource(secondSyncChunk.resources->at(0).guid.ref());
+
+    firstSyncChunk.resources->clear();
+    secondSyncChunk.resources->clear();
+
+    qevercloud::SyncChunk syncChunk;
+    ErrorString errorDescription;
+    QVERIFY2(
+        buffer.syncChunk(0, syncChunk, errorDescription),
+        qPrintable(errorDescription.nonLocalizedString()));
+    QVERIFY(syncChunk == firstSyncChunk);
+
+    QVERIFY2(
+        buffer.syncChunk(1, syncChunk, errorDescription),
+        qPrintable(errorDescription.nonLocalizedString()));
+    QVERIFY(syncChunk == secondSyncChunk);
+}
+
+void SyncChunksBufferTester::testReleaseDataElementsFromSyncChunks()
+{
+    SyncChunksBuffer buffer(1);
+
+    auto firstSyncChunk = createSyncChunk(1);
+    auto secondSyncChunk = createSyncChunk(100);
+    buffer.append(firstSyncChunk);
+    buffer.append(secondSyncChunk);
+
+    const quint64 bytesBeforeRelease = buffer.bufferedBytes();
+    QCOMPARE(buffer.peakBufferedBytes(), bytesBeforeRelease);
+
+    buffer.releaseDataElements(SyncChunksBuffer::DataElement::Notes);
+    const quint64 bytesAfterNotesRelease = buffer.bufferedBytes();
+    QVERIFY(bytesAfterNotesRelease < bytesBeforeRelease);
+
+    buffer.removeResource(firstSyncChunk.resources->at(0).guid.ref());
+    QVERIFY(buffer.bufferedBytes() < bytesAfterNotesRelease);
+    QCOMPARE(buffer.peakBufferedBytes(), bytesBeforeRelease);
+
+    firstSyncChunk.notes.clear();
+    firstSyncChunk.resources->clear();
+    secondSyncChunk.notes.clear();
+
+    qevercloud::SyncChunk syncChunk;
+    ErrorString errorDescription;
+    QVERIFY2(
+        buffer.syncChunk(0, syncChunk, errorDescription),
+        qPrintable(errorDescription.nonLocalizedString()));
+    QVERIFY(syncChunk == firstSyncChunk);
+
+    QVERIFY2(
+        buffer.syncChunk(1, syncChunk, errorDescription),
+        qPrintable(errorDescription.nonLocalizedString()));
+    QVERIFY(syncChunk == secondSyncChunk);
+
+    // Guids of expunged notes are not released along with the notes
+    QVERIFY(syncChunk.expungedNotes.isSet());
+    QCOMPARE(syncChunk.expungedNotes->size(), 1);
+}
+
+void SyncChunksBufferTester::testCachedSyncChunksMetadata()
+{
+    SyncChunksBuffer buffer(1);
+
+    auto firstSyncChunk = createSyncChunk(100);
+    firstSyncChunk.expungedNotes.clear();
+    buffer.append(firstSyncChunk);
+
+    // The following sync chunks are written to the temporary file
+    auto secondSyncChunk = createSyncChunk(10);
+    secondSyncChunk.expungedNotes.clear();
+    buffer.append(secondSyncChunk);
+
+    const QString linkedNotebookGuid = UidGenerator::Generate();
+    auto linkedNotebookSyncChunk = createSyncChunk(1);
+    linkedNotebookSyncChunk.expungedNotes.clear();
+    buffer.append(linkedNotebookSyncChunk, linkedNotebookGuid);
+
+    QVERIFY(!buffer.containsExpungedItems());
+
+    // Note and resource USNs are 3 and 4 USNs above the low USN of the sync
+    // chunk, respectively
+    QCOMPARE(buffer.smallestNoteUsn(QString()), 13);
+    QCOMPARE(buffer.smallestResourceUsn(QString()), 14);
+    QCOMPARE(buffer.smallestNoteUsn(linkedNotebookGuid), 4);
+    QCOMPARE(buffer.smallestResourceUsn(linkedNotebookGuid), 5);
+    QCOMPARE(buffer.smallestNoteUsn(UidGenerator::Generate()), -1);
+
+    buffer.removeResource(secondSyncChunk.resources->at(0).guid.ref());
+    QCOMPARE(buffer.smallestResourceUsn(QString()), 104);
+
+    buffer.releaseDataElements(SyncChunksBuffer::DataElement::Notes);
+    QCOMPARE(buffer.smallestNoteUsn(QString()), -1);
+    QCOMPARE(buffer.smallestNoteUsn(linkedNotebookGuid), -1);
+
+    buffer.releaseDataElements(SyncChunksBuffer::DataElement::Resources);
+    QCOMPARE(buffer.smallestResourceUsn(QString()), -1);
+    QCOMPARE(buffer.smallestResourceUsn(linkedNotebookGuid), -1);
+
+    buffer.append(createSyncChunk(1000));
+    QVERIFY(buffer.containsExpungedItems());
+}
+
+void SyncChunksBufferTester::testClearBuffer()
+{
+    SyncChunksBuffer buffer(1);
+    for (qint32 i = 0; i < 3; ++i) {
+        buffer.append(createSyncChunk(i * 100 + 1));
+    }
+
+    buffer.clear();
+    QVERIFY(buffer.isEmpty());
+    QCOMPARE(buffer.bufferedBytes(), quint64(0));
+    QCOMPARE(buffer.peakBufferedBytes(), quint64(0));
+
+    auto syncChunk = createSyncChunk(1000);
+    buffer.append(syncChunk);
+    buffer.append(createSyncChunk(2000));
+
+    qevercloud::SyncChunk readSyncChunk;
+    ErrorString errorDescription;
+    QVERIFY2(
+        buffer.syncChunk(0, readSyncChunk, errorDescription),
+        qPrintable(errorDescription.nonLocalizedString()));
+    QVERIFY(readSyncChunk == syncChunk);
+}
+
+} // namespace test
+} // namespace quentier
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyncMetricsTester.h"
+
+#include "../../synchronization/SyncMetrics.h"
+
+#include <qt5qevercloud/QEverCloud.h>
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest/QTest>
+
+#include <algorithm>
+
+namespace quentier {
+namespace test {
+
+SyncMetricsTester::SyncMetricsTester(QObject * parent) : QObject(parent) {}
+
+void SyncMetricsTester::testNoteStoreCallLatencyHistogram()
+{
+    SyncMetrics metrics;
+
+    const auto rateLimitReached =
+        static_cast<qint32>(qevercloud::EDAMErrorCode::RATE_LIMIT_REACHED);
+
+    metrics.addNoteStoreCall(QStringLiteral("getSyncChunk"), 5, 0);
+    metrics.addNoteStoreCall(QStringLiteral("getSyncChunk"), 30, 0);
+
+    metrics.addNoteStoreCall(
+        QStringLiteral("getSyncChunk"), 20000, rateLimitReached);
+
+    metrics.addNoteStoreCall(QStringLiteral("getNote"), 10, 0);
+
+    const auto bounds = metrics.latencyHistogramBucketBoundsMsec();
+    QVERIFY(!bounds.isEmpty());
+    QVERIFY(std::is_sorted(bounds.constBegin(), bounds.constEnd()));
+
+    const auto stats = metrics.noteStoreCallStats();
+    QCOMPARE(stats.size(), 2);
+
+    const auto getSyncChunkStats = stats.value(QStringLiteral("getSyncChunk"));
+    QCOMPARE(getSyncChunkStats.m_count, quint64(3));
+    QCOMPARE(getSyncChunkStats.m_failures, quint64(1));
+    QCOMPARE(getSyncChunkStats.m_rateLimitBreaches, quint64(1));
+    QCOMPARE(getSyncChunkStats.m_totalMsec, qint64(20035));
+    QCOMPARE(getSyncChunkStats.m_maxMsec, qint64(20000));
+
+    const auto & histogram = getSyncChunkStats.m_latencyHistogram;
+    QCOMPARE(histogram.size(), bounds.size() + 1);
+    QCOMPARE(histogram.first(), quint64(1));
+    QCOMPARE(histogram.last(), quint64(1));
+
+    // The call which took 30 msec belongs to the bucket with the least upper
+    // bound greater than 30
+    int bucket = 0;
+    while (bucket < bounds.size() && bounds[bucket] <= 30) {
+        ++bucket;
+    }
+
+    QVERIFY(bucket > 0 && bucket < bounds.size());
+    QCOMPARE(histogram[bucket], quint64(1));
+
+    quint64 totalCount = 0;
+    for (const auto count: histogram) {
+        totalCount += count;
+    }
+
+    QCOMPARE(totalCount, quint64(3));
+
+    // The call which took exactly the bucket bound msec belongs to
+    // the next bucket
+    const auto getNoteStats = stats.value(QStringLiteral("getNote"));
+    QCOMPARE(getNoteStats.m_failures, quint64(0));
+
+    int getNoteBucket = getNoteStats.m_latencyHistogram.indexOf(1);
+    QVERIFY(getNoteBucket > 0);
+    QCOMPARE(bounds[getNoteBucket - 1], qint64(10));
+}
+
+void SyncMetricsTester::testLocalStorageRequestLatencies()
+{
+    SyncMetrics metrics;
+
+    const QUuid firstRequestId = QUuid::createUuid();
+    const QUuid secondRequestId = QUuid::createUuid();
+
+    metrics.startLocalStorageRequest(firstRequestId, QStringLiteral("addNote"));
+
+    metrics.startLocalStorageRequest(
+        secondRequestId, QStringLiteral("addNote"));
+
+    metrics.finishLocalStorageRequest(firstRequestId);
+
+    metrics.finishLocalStorageRequest(
+        secondRequestId, /* success = */ false);
+
+    // Requests which were not started or were already finished are ignored
+    metrics.finishLocalStorageRequest(firstRequestId);
+    metrics.finishLocalStorageRequest(QUuid::createUuid());
+
+    const auto stats = metrics.localStorageRequestStats();
+    QCOMPARE(stats.size(), 1);
+
+    const auto addNoteStats = stats.value(QStringLiteral("addNote"));
+    QCOMPARE(addNoteStats.m_count, quint64(2));
+    QCOMPARE(addNoteStats.m_failures, quint64(1));
+    QCOMPARE(addNoteStats.m_rateLimitBreaches, quint64(0));
+
+    QCOMPARE(
+        metrics.peakQueueDepths().value(QStringLiteral("localStorageRequests")),
+        quint64(2));
+}
+
+void SyncMetricsTester::testPhaseDurations()
+{
+    SyncMetrics metrics;
+
+    metrics.startPhase(QStringLiteral("total"));
+    metrics.startPhase(QStringLiteral("download"));
+    QVERIFY(metrics.isPhaseRunning(QStringLiteral("download")));
+
+    metrics.finishPhase(QStringLiteral("download"));
+    QVERIFY(!metrics.isPhaseRunning(QStringLiteral("download")));
+
+    // Finishing the phase which is not running changes nothing
+    metrics.finishPhase(QStringLiteral("send"));
+
+    auto phaseDurations = metrics.phaseDurationsMsec();
+    QCOMPARE(phaseDurations.size(), 1);
+    QVERIFY(phaseDurations.contains(QStringLiteral("download")));
+
+    metrics.finishAllPhases();
+    QVERIFY(!metrics.isPhaseRunning(QStringLiteral("total")));
+
+    phaseDurations = metrics.phaseDurationsMsec();
+    QCOMPARE(phaseDurations.size(), 2);
+
+    QVERIFY(
+        phaseDurations.value(QStringLiteral("total")) >=
+        phaseDurations.value(QStringLiteral("download")));
+}
+
+void SyncMetricsTester::testOverlappingPhaseInstances()
+{
+    SyncMetrics metrics;
+
+    metrics.startPhaseInstance(QStringLiteral("rate_limit_wait"));
+    metrics.startPhaseInstance(QStringLiteral("rate_limit_wait"));
+    QVERIFY(metrics.isPhaseRunning(QStringLiteral("rate_limit_wait")));
+
+    // The phase keeps running until the last of its instances finishes
+    metrics.finishPhaseInstance(QStringLiteral("rate_limit_wait"));
+    QVERIFY(metrics.isPhaseRunning(QStringLiteral("rate_limit_wait")));
+    QVERIFY(metrics.phaseDurationsMsec().isEmpty());
+
+    metrics.finishPhaseInstance(QStringLiteral("rate_limit_wait"));
+    QVERIFY(!metrics.isPhaseRunning(QStringLiteral("rate_limit_wait")));
+
+    auto phaseDurations = metrics.phaseDurationsMsec();
+    QVERIFY(phaseDurations.contains(QStringLiteral("rate_limit_wait")));
+
+    // Finishing more instances than were started changes nothing
+    metrics.finishPhaseInstance(QStringLiteral("rate_limit_wait"));
+    QVERIFY(!metrics.isPhaseRunning(QStringLiteral("rate_limit_wait")));
+
+    // Instances left running are finished along with all other phases
+    metrics.startPhaseInstance(QStringLiteral("conflict_resolution"));
+    metrics.finishAllPhases();
+    QVERIFY(!metrics.isPhaseRunning(QStringLiteral("conflict_resolution")));
+
+    metrics.startPhaseInstance(QStringLiteral("conflict_resolution"));
+    QVERIFY(metrics.isPhaseRunning(QStringLiteral("conflict_resolution")));
+    metrics.finishPhaseInstance(QStringLiteral("conflict_resolution"));
+    QVERIFY(!metrics.isPhaseRunning(QStringLiteral("conflict_resolution")));
+}
+
+void SyncMetricsTester::testJsonDump()
+{
+    SyncMetrics metrics;
+
+    metrics.startPhase(QStringLiteral("download"));
+    metrics.finishPhase(QStringLiteral("download"));
+    metrics.addNoteStoreCall(QStringLiteral("getNote"), 42, 0);
+    metrics.setQueueDepth(QStringLiteral("noteStoreAsyncCalls"), 3);
+    metrics.setQueueDepth(QStringLiteral("noteStoreAsyncCalls"), 1);
+    metrics.addDownloadedBytes(100);
+    metrics.addDownloadedBytes(20);
+    metrics.addUploadedBytes(7);
+
+    QJsonParseError error;
+    const auto document = QJsonDocument::fromJson(metrics.toJson(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QVERIFY(document.isObject());
+
+    const auto object = document.object();
+
+    QCOMPARE(
+        object.value(QStringLiteral("latencyHistogramBucketBoundsMsec"))
+            .toArray()
+            .size(),
+        metrics.latencyHistogramBucketBoundsMsec().size());
+
+    QVERIFY(object.value(QStringLiteral("phaseDurationsMsec"))
+                .toObject()
+                .contains(QStringLiteral("download")));
+
+    const auto getNoteObject =
+        object.value(QStringLiteral("noteStoreCalls"))
+            .toObject()
+            .value(QStringLiteral("getNote"))
+            .toObject();
+
+    QCOMPARE(getNoteObject.value(QStringLiteral("count")).toInt(), 1);
+    QCOMPARE(getNoteObject.value(QStringLiteral("totalMsec")).toInt(), 42);
+
+    QCOMPARE(
+        getNoteObject.value(QStringLiteral("latencyHistogram"))
+            .toArray()
+            .size(),
+        metrics.latencyHistogramBucketBoundsMsec().size() + 1);
+
+    QVERIFY(object.value(QStringLiteral("localStorageRequests"))
+                .toObject()
+                .isEmpty());
+
+    QCOMPARE(
+        object.value(QStringLiteral("peakQueueDepths"))
+            .toObject()
+            .value(QStringLiteral("noteStoreAsyncCalls"))
+            .toInt(),
+        3);
+
+    QCOMPARE(object.value(QStringLiteral("downloadedBytes")).toInt(), 120);
+    QCOMPARE(object.value(QStringLiteral("uploadedBytes")).toInt(), 7);
+
+    metrics.clear();
+    QVERIFY(metrics.phaseDurationsMsec().isEmpty());
+    QVERIFY(metrics.noteStoreCallStats().isEmpty());
+    QVERIFY(metrics.peakQueueDepths().isEmpty());
+    QCOMPARE(metrics.downloadedBytes(), quint64(0));
+    QCOMPARE(metrics.uploadedBytes(), quint64(0));
+}
+
+} // namespace test
+} // namespace quentier
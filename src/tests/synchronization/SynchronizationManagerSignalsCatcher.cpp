@@ -271,6 +271,29 @@ void SynchronizationManagerSignalsCatcher::
         << progress;
 }
 
+void SynchronizationManagerSignalsCatcher::
+    onLinkedNotebookSyncStatesCheckProgress(
+        quint32 linkedNotebooksChecked, quint32 totalLinkedNotebooksToCheck,
+        LinkedNotebook linkedNotebook, bool hasUpdates)
+{
+    QNDEBUG(
+        "tests:synchronization",
+        "SynchronizationManagerSignalsCatcher"
+            << "::onLinkedNotebookSyncStatesCheckProgress: "
+            << "checked = " << linkedNotebooksChecked
+            << ", total = " << totalLinkedNotebooksToCheck
+            << ", has updates = " << (hasUpdates ? "true" : "false")
+            << ", linked notebook: " << linkedNotebook);
+
+    LinkedNotebookSyncStatesCheckProgress progress;
+    progress.m_linkedNotebooksChecked = linkedNotebooksChecked;
+    progress.m_totalLinkedNotebooksToCheck = totalLinkedNotebooksToCheck;
+    progress.m_linkedNotebookGuid = linkedNotebook.guid();
+    progress.m_hasUpdates = hasUpdates;
+
+    m_linkedNotebookSyncStatesCheckProgress << progress;
+}
+
 void SynchronizationManagerSignalsCatcher::onSyncChunksDataCounters(
     ISyncChunksDataCountersPtr counters)
 {
@@ -460,6 +483,12 @@ void SynchronizationManagerSignalsCatcher::createConnections(
         &SynchronizationManagerSignalsCatcher::
             onLinkedNotebookSyncChunkDownloadProgress);
 
+    QObject::connect(
+        &synchronizationManager,
+        &SynchronizationManager::linkedNotebookSyncStatesCheckProgress, this,
+        &SynchronizationManagerSignalsCatcher::
+            onLinkedNotebookSyncStatesCheckProgress);
+
     QObject::connect(
         &synchronizationManager,
         &SynchronizationManager::syncChunksDataProcessingProgress, this,
@@ -191,6 +191,20 @@ public:
         return m_linkedNotebookSyncChunkDownloadProgress;
     }
 
+    struct LinkedNotebookSyncStatesCheckProgress
+    {
+        quint32 m_linkedNotebooksChecked = 0;
+        quint32 m_totalLinkedNotebooksToCheck = 0;
+        QString m_linkedNotebookGuid;
+        bool m_hasUpdates = false;
+    };
+
+    const QVector<LinkedNotebookSyncStatesCheckProgress> &
+    linkedNotebookSyncStatesCheckProgress() const
+    {
+        return m_linkedNotebookSyncStatesCheckProgress;
+    }
+
     const QVector<ISyncChunksDataCountersPtr> & syncChunksDataCounters() const
     {
         return m_syncChunksDataCounters;
@@ -322,6 +336,10 @@ private Q_SLOTS:
         qint32 highestDownloadedUsn, qint32 highestServerUsn,
         qint32 lastPreviousUsn, LinkedNotebook linkedNotebook);
 
+    void onLinkedNotebookSyncStatesCheckProgress(
+        quint32 linkedNotebooksChecked, quint32 totalLinkedNotebooksToCheck,
+        LinkedNotebook linkedNotebook, bool hasUpdates);
+
     void onSyncChunksDataCounters(ISyncChunksDataCountersPtr counters);
 
     void onLinkedNotebookSyncChunksDataCounters(
@@ -432,6 +450,9 @@ private:
     QHash<QString, QVector<SyncChunkDownloadProgress>>
         m_linkedNotebookSyncChunkDownloadProgress;
 
+    QVector<LinkedNotebookSyncStatesCheckProgress>
+        m_linkedNotebookSyncStatesCheckProgress;
+
     QVector<ISyncChunksDataCountersPtr> m_syncChunksDataCounters;
     QVector<ISyncChunksDataCountersPtr> m_linkedNotebookSyncChunksDataCounters;
 
@@ -32,11 +32,13 @@
 #include <QCryptographicHash>
 #include <QDateTime>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QStringBuilder>
 #include <QTest>
 #include <QTextStream>
 #include <QTimer>
 
+#include <functional>
 #include <iostream>
 
 // 10 minutes should be enough
@@ -254,6 +256,313 @@ void SynchronizationTester::testRemoteToLocalFullSyncWithLinkedNotebooks()
     checkPersistentSyncState();
 }
 
+void SynchronizationTester::testRemoteToLocalFullSyncResumesFromCheckpoint()
+{
+    setUserOwnItemsToRemoteStorage();
+
+    // Checkpoint on every progress notification
+    setSyncProgressCheckpointInterval(0);
+
+    const qint32 maxUsn = m_pFakeNoteStore->currentMaxUsn();
+    qint32 checkpointUsn = -1;
+
+    auto status = EventLoopWithExitStatus::ExitStatus::Failure;
+    {
+        QTimer timer;
+        timer.setInterval(MAX_ALLOWED_TEST_DURATION_MSEC);
+        timer.setSingleShot(true);
+
+        EventLoopWithExitStatus loop;
+
+        QObject::connect(
+            &timer, &QTimer::timeout, &loop,
+            &EventLoopWithExitStatus::exitAsTimeout);
+
+        // The sync state persisted before all the items are synchronized
+        // can only come from the checkpoint
+        QObject::connect(
+            m_pSyncStateStorage.get(),
+            &ISyncStateStorage::notifySyncStateUpdated, &loop,
+            [&](Account account, ISyncStateStorage::ISyncStatePtr syncState) {
+                Q_UNUSED(account)
+
+                const qint32 usn = syncState->userDataUpdateCount();
+                if ((checkpointUsn < 0) && (usn > 0) && (usn < maxUsn)) {
+                    checkpointUsn = usn;
+                    loop.exitAsSuccess();
+                }
+            });
+
+        QObject::connect(
+            m_pSynchronizationManager, &SynchronizationManager::finished,
+            &loop, &EventLoopWithExitStatus::exitAsFailure);
+
+        QObject::connect(
+            m_pSynchronizationManager, &SynchronizationManager::failed, &loop,
+            &EventLoopWithExitStatus::exitAsFailure);
+
+        timer.start();
+        QTimer::singleShot(
+            0, m_pSynchronizationManager, &SynchronizationManager::synchronize);
+
+        Q_UNUSED(loop.exec())
+        status = loop.exitStatus();
+    }
+
+    QVERIFY2(
+        status == EventLoopWithExitStatus::ExitStatus::Success,
+        "No sync progress checkpoint was persisted during the full sync");
+
+    // Simulate the abrupt shutdown in the middle of the sync: the sync
+    // manager is gone without a chance to persist anything else
+    recreateSynchronizationManager();
+
+    auto pSyncState = m_pSyncStateStorage->getSyncState(m_testAccount);
+    QVERIFY(pSyncState);
+    QVERIFY2(
+        pSyncState->userDataUpdateCount() == checkpointUsn,
+        "Persisted sync state doesn't match the checkpoint");
+
+    m_pFakeNoteStore->clearUserOwnSyncChunkRequestsAfterUsns();
+
+    SynchronizationManagerSignalsCatcher catcher(
+        *m_pLocalStorageManagerAsync, *m_pSynchronizationManager,
+        *m_pSyncStateStorage);
+
+    runTest(catcher);
+
+    CHECK_EXPECTED(receivedStartedSignal)
+    CHECK_EXPECTED(receivedFinishedSignal)
+    CHECK_EXPECTED(receivedRemoteToLocalSyncDone)
+    CHECK_EXPECTED(receivedSyncChunksDownloaded)
+
+    CHECK_UNEXPECTED(receivedStoppedSignal)
+    CHECK_UNEXPECTED(receivedRemoteToLocalSyncStopped)
+    CHECK_UNEXPECTED(receivedRateLimitExceeded)
+
+    // The resumed sync should neither start over nor skip anything
+    const auto & afterUsns =
+        m_pFakeNoteStore->userOwnSyncChunkRequestsAfterUsns();
+
+    QVERIFY2(
+        !afterUsns.isEmpty(), "No sync chunks were requested on resuming");
+
+    if (Q_UNLIKELY(afterUsns.front() != checkpointUsn)) {
+        QFAIL(qPrintable(
+            QStringLiteral("The resumed sync requested sync chunks after "
+                           "USN ") +
+            QString::number(afterUsns.front()) +
+            QStringLiteral(" instead of the checkpoint USN ") +
+            QString::number(checkpointUsn)));
+    }
+
+    checkIdentityOfLocalAndRemoteItems();
+    checkPersistentSyncState();
+}
+
+void SynchronizationTester::
+    testRemoteToLocalFullSyncSkipsFindRequestsForUpToDateLocalItems()
+{
+    setUserOwnItemsToRemoteStorage();
+    copyRemoteItemsToLocalStorage();
+
+    // No sync state is persisted so the full sync downloads all the items
+    // again; only the locally modified ones are not up to date
+    setModifiedUserOwnItemsToLocalStorage();
+
+    QSet<QString> foundSavedSearchGuids;
+    QSet<QString> foundTagGuids;
+    QSet<QString> foundNotebookGuids;
+    QSet<QString> foundNoteGuids;
+
+    QObject context;
+
+    const auto collectGuid = [](const INoteStoreDataElement & item,
+                                QSet<QString> & guids) {
+        if (item.hasGuid()) {
+            guids.insert(item.guid());
+        }
+    };
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::findSavedSearchComplete, &context,
+        [&](SavedSearch search, QUuid) {
+            collectGuid(search, foundSavedSearchGuids);
+        });
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::findSavedSearchFailed, &context,
+        [&](SavedSearch search, ErrorString, QUuid) {
+            collectGuid(search, foundSavedSearchGuids);
+        });
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::findOrAddTagsComplete, &context,
+        [&](QList<Tag> addedTags, QHash<QString, Tag> localConflictsByGuid,
+            QUuid) {
+            for (const auto & tag: ::qAsConst(addedTags)) {
+                collectGuid(tag, foundTagGuids);
+            }
+
+            for (const auto & tag: ::qAsConst(localConflictsByGuid)) {
+                collectGuid(tag, foundTagGuids);
+            }
+        });
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::findOrAddTagsFailed, &context,
+        [&](QList<Tag> tags, ErrorString, QUuid) {
+            for (const auto & tag: ::qAsConst(tags)) {
+                collectGuid(tag, foundTagGuids);
+            }
+        });
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::findNotebookComplete, &context,
+        [&](Notebook notebook, QUuid) {
+            collectGuid(notebook, foundNotebookGuids);
+        });
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::findNotebookFailed, &context,
+        [&](Notebook notebook, ErrorString, QUuid) {
+            collectGuid(notebook, foundNotebookGuids);
+        });
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::findNoteComplete, &context,
+        [&](Note note, LocalStorageManager::GetNoteOptions, QUuid) {
+            collectGuid(note, foundNoteGuids);
+        });
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync, &LocalStorageManagerAsync::findNoteFailed,
+        &context,
+        [&](Note note, LocalStorageManager::GetNoteOptions, ErrorString,
+            QUuid) { collectGuid(note, foundNoteGuids); });
+
+    SynchronizationManagerSignalsCatcher catcher(
+        *m_pLocalStorageManagerAsync, *m_pSynchronizationManager,
+        *m_pSyncStateStorage);
+
+    runTest(catcher);
+
+    CHECK_EXPECTED(receivedStartedSignal)
+    CHECK_EXPECTED(receivedFinishedSignal)
+    CHECK_EXPECTED(receivedRemoteToLocalSyncDone)
+    CHECK_EXPECTED(receivedSyncChunksDownloaded)
+
+    CHECK_UNEXPECTED(receivedStoppedSignal)
+    CHECK_UNEXPECTED(receivedRemoteToLocalSyncStopped)
+    CHECK_UNEXPECTED(receivedRateLimitExceeded)
+    CHECK_UNEXPECTED(receivedLinkedNotebookSyncChunksDownloaded)
+
+    const auto & modifiedGuids = m_guidsOfUserOwnLocalItemsToModify;
+
+    checkFindRequestsSkippedForUpToDateItems(
+        m_pFakeNoteStore->savedSearches().keys(),
+        modifiedGuids.m_savedSearchGuids, foundSavedSearchGuids);
+
+    checkFindRequestsSkippedForUpToDateItems(
+        m_pFakeNoteStore->tags().keys(), modifiedGuids.m_tagGuids,
+        foundTagGuids);
+
+    checkFindRequestsSkippedForUpToDateItems(
+        m_pFakeNoteStore->notebooks().keys(), modifiedGuids.m_notebookGuids,
+        foundNotebookGuids);
+
+    checkFindRequestsSkippedForUpToDateItems(
+        m_pFakeNoteStore->notes().keys(), modifiedGuids.m_noteGuids,
+        foundNoteGuids);
+
+    // Skipped items are neither added nor updated so they must not show up
+    // in the sync chunks data counters
+    const auto & syncChunksDataCounters = catcher.syncChunksDataCounters();
+    QVERIFY(!syncChunksDataCounters.isEmpty());
+
+    const auto numModified = [](const QStringList & guids) {
+        return static_cast<quint64>(guids.size());
+    };
+
+    for (const auto & counters: ::qAsConst(syncChunksDataCounters)) {
+        QVERIFY2(
+            counters->addedSavedSearches() + counters->updatedSavedSearches() <=
+                numModified(modifiedGuids.m_savedSearchGuids),
+            "Up to date saved searches were counted in sync chunks data "
+            "counters");
+
+        QVERIFY2(
+            counters->addedTags() + counters->updatedTags() <=
+                numModified(modifiedGuids.m_tagGuids),
+            "Up to date tags were counted in sync chunks data counters");
+
+        QVERIFY2(
+            counters->addedNotebooks() + counters->updatedNotebooks() <=
+                numModified(modifiedGuids.m_notebookGuids),
+            "Up to date notebooks were counted in sync chunks data counters");
+    }
+}
+
+void SynchronizationTester::
+    testIncrementalSyncDoesNotCheckpointWithPendingExpungedItems()
+{
+    setUserOwnItemsToRemoteStorage();
+    copyRemoteItemsToLocalStorage();
+    setRemoteStorageSyncStateToPersistentSyncSettings();
+
+    setNewUserOwnItemsToRemoteStorage();
+    setExpungedUserOwnItemsToRemoteStorage();
+
+    // Checkpoint on every progress notification
+    setSyncProgressCheckpointInterval(0);
+
+    const qint32 maxUsn = m_pFakeNoteStore->currentMaxUsn();
+
+    SynchronizationManagerSignalsCatcher catcher(
+        *m_pLocalStorageManagerAsync, *m_pSynchronizationManager,
+        *m_pSyncStateStorage);
+
+    runTest(catcher);
+
+    CHECK_EXPECTED(receivedStartedSignal)
+    CHECK_EXPECTED(receivedFinishedSignal)
+    CHECK_EXPECTED(receivedRemoteToLocalSyncDone)
+    CHECK_EXPECTED(receivedSyncChunksDownloaded)
+
+    CHECK_UNEXPECTED(receivedStoppedSignal)
+    CHECK_UNEXPECTED(receivedRemoteToLocalSyncStopped)
+    CHECK_UNEXPECTED(receivedRateLimitExceeded)
+
+    // Resuming the sync from a checkpoint taken before the expunged items
+    // are processed would lose them so no intermediate sync state should be
+    // persisted
+    const auto & syncStateUpdateCounts =
+        catcher.persistedSyncStateUpdateCounts();
+
+    QVERIFY(!syncStateUpdateCounts.isEmpty());
+
+    for (const auto & updateCounts: syncStateUpdateCounts) {
+        if (Q_UNLIKELY(updateCounts.m_userOwnUpdateCount < maxUsn)) {
+            QFAIL(qPrintable(
+                QStringLiteral("Sync state with update count ") +
+                QString::number(updateCounts.m_userOwnUpdateCount) +
+                QStringLiteral(" was persisted while expunged items were "
+                               "pending, max USN = ") +
+                QString::number(maxUsn)));
+        }
+    }
+
+    checkIdentityOfLocalAndRemoteItems();
+    checkPersistentSyncState();
+}
+
 void SynchronizationTester::
     testIncrementalSyncWithNewRemoteItemsFromUserOwnDataOnly()
 {
@@ -342,6 +651,102 @@ void SynchronizationTester::
     checkPersistentSyncState();
 }
 
+void SynchronizationTester::
+    testIncrementalSyncWithNewRemoteItemsFromLinkedNotebooksInSeveralShards()
+{
+    setUserOwnItemsToRemoteStorage();
+    setLinkedNotebookItemsToRemoteStorage();
+
+    QHash<QString, QStringList> linkedNotebookGuidsByShardId;
+    setLinkedNotebooksFromSeveralShardsToRemoteStorage(
+        2, 8, linkedNotebookGuidsByShardId);
+
+    copyRemoteItemsToLocalStorage();
+    setRemoteStorageSyncStateToPersistentSyncSettings();
+
+    QSet<QString> updatedLinkedNotebookGuids;
+    for (const auto it:
+         qevercloud::toRange(::qAsConst(linkedNotebookGuidsByShardId)))
+    {
+        for (const auto & linkedNotebookGuid: it.value().mid(0, 6)) {
+            updatedLinkedNotebookGuids.insert(linkedNotebookGuid);
+        }
+    }
+
+    setNewTagsToLinkedNotebooksInRemoteStorage(updatedLinkedNotebookGuids);
+
+    SynchronizationManagerSignalsCatcher catcher(
+        *m_pLocalStorageManagerAsync, *m_pSynchronizationManager,
+        *m_pSyncStateStorage);
+
+    runTest(catcher);
+
+    CHECK_EXPECTED(receivedStartedSignal)
+    CHECK_EXPECTED(receivedFinishedSignal)
+    CHECK_EXPECTED(finishedSomethingDownloaded)
+    CHECK_EXPECTED(receivedRemoteToLocalSyncDone)
+    CHECK_EXPECTED(remoteToLocalSyncDoneSomethingDownloaded)
+    CHECK_EXPECTED(receivedSyncChunksDownloaded)
+    CHECK_EXPECTED(receivedLinkedNotebookSyncChunksDownloaded)
+
+    CHECK_UNEXPECTED(receivedAuthenticationFinishedSignal)
+    CHECK_UNEXPECTED(receivedStoppedSignal)
+    CHECK_UNEXPECTED(finishedSomethingSent)
+    CHECK_UNEXPECTED(receivedAuthenticationRevokedSignal)
+    CHECK_UNEXPECTED(receivedRemoteToLocalSyncStopped)
+    CHECK_UNEXPECTED(receivedSendLocalChangedStopped)
+    CHECK_UNEXPECTED(receivedWillRepeatRemoteToLocalSyncAfterSendingChanges)
+    CHECK_UNEXPECTED(receivedDetectedConflictDuringLocalChangesSending)
+    CHECK_UNEXPECTED(receivedRateLimitExceeded)
+    CHECK_UNEXPECTED(receivedPreparedDirtyObjectsForSending)
+    CHECK_UNEXPECTED(receivedPreparedLinkedNotebookDirtyObjectsForSending)
+
+    checkLinkedNotebookSyncStatesCheckProgress(
+        catcher, updatedLinkedNotebookGuids);
+
+    // Both sync states and sync chunks should have been requested
+    // concurrently but with no more than the allowed number of requests
+    // in flight per shard
+    QVERIFY2(
+        m_pFakeNoteStore->maxLinkedNotebookSyncStateAsyncRequestsPerShard() ==
+            LINKED_NOTEBOOK_SYNC_STATE_REQUESTS_PER_SHARD_MAX,
+        "Unexpected max number of linked notebook sync state requests "
+        "in flight per shard");
+
+    QVERIFY2(
+        m_pFakeNoteStore->maxLinkedNotebookSyncChunkAsyncRequestsPerShard() ==
+            LINKED_NOTEBOOK_SYNC_CHUNKS_DOWNLOADS_PER_SHARD_MAX,
+        "Unexpected max number of linked notebook sync chunk requests "
+        "in flight per shard");
+
+    // Sync chunks should have been requested only for linked notebooks which
+    // sync states have changed
+    const auto & syncChunkRequestsAfterUsns =
+        m_pFakeNoteStore->linkedNotebookSyncChunkRequestsAfterUsns();
+
+    QVERIFY2(
+        syncChunkRequestsAfterUsns.size() == updatedLinkedNotebookGuids.size(),
+        "Unexpected number of linked notebooks for which sync chunks "
+        "were requested");
+
+    for (const auto it: qevercloud::toRange(syncChunkRequestsAfterUsns)) {
+        QVERIFY2(
+            updatedLinkedNotebookGuids.contains(it.key()),
+            "Sync chunks were requested for linked notebook without updates");
+
+        QVERIFY2(
+            it.value().size() == 1,
+            "Unexpected number of sync chunk requests for linked notebook");
+    }
+
+    checkProgressNotificationsOrder(catcher);
+    checkSyncChunksDataProcessingProgressOrder(catcher);
+    checkLinkedNotebookSyncChunksDataProcessingProgressOrder(catcher);
+
+    checkIdentityOfLocalAndRemoteItems();
+    checkPersistentSyncState();
+}
+
 void SynchronizationTester::
     testIncrementalSyncWithNewRemoteItemsFromUserOwnDataAndLinkedNotebooks()
 {
@@ -2191,6 +2596,85 @@ void SynchronizationTester::
     checkExpectedNamesOfConflictingItemsAfterSync();
 }
 
+void SynchronizationTester::
+    testIncrementalSyncWithMultiLevelTagsTreeAndConflictsWithinOneLevel()
+{
+    setUserOwnItemsToRemoteStorage();
+
+    QStringList rootTagGuids;
+    QStringList childTagGuids;
+    setTagsTreeToRemoteStorage(rootTagGuids, childTagGuids);
+
+    copyRemoteItemsToLocalStorage();
+    setRemoteStorageSyncStateToPersistentSyncSettings();
+
+    // Child tags of the existing tree are modified both locally and remotely
+    // so that several conflicts appear within the same level of the tree
+    setConflictingTagsToLocalAndRemoteStoragesImpl(
+        childTagGuids, ConflictingItemsUsnOption::SameUsn,
+        /* should have linked notebook guid = */ false);
+
+    setNewTagsTreeLevelsToRemoteStorage(rootTagGuids, childTagGuids);
+
+    QStringList storedTagGuids;
+
+    // Limits the lifetime of connections to lambdas capturing local variables
+    QObject context;
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync, &LocalStorageManagerAsync::addTagComplete,
+        &context, [&](Tag tag, QUuid) {
+            if (tag.hasGuid()) {
+                storedTagGuids << tag.guid();
+            }
+        });
+
+    QObject::connect(
+        m_pLocalStorageManagerAsync,
+        &LocalStorageManagerAsync::updateTagComplete, &context,
+        [&](Tag tag, QUuid) {
+            if (tag.hasGuid()) {
+                storedTagGuids << tag.guid();
+            }
+        });
+
+    SynchronizationManagerSignalsCatcher catcher(
+        *m_pLocalStorageManagerAsync, *m_pSynchronizationManager,
+        *m_pSyncStateStorage);
+
+    runTest(catcher);
+
+    CHECK_EXPECTED(receivedStartedSignal)
+    CHECK_EXPECTED(receivedFinishedSignal)
+    CHECK_EXPECTED(finishedSomethingDownloaded)
+    CHECK_EXPECTED(receivedRemoteToLocalSyncDone)
+    CHECK_EXPECTED(remoteToLocalSyncDoneSomethingDownloaded)
+    CHECK_EXPECTED(receivedSyncChunksDownloaded)
+
+    CHECK_UNEXPECTED(receivedAuthenticationFinishedSignal)
+    CHECK_UNEXPECTED(receivedStoppedSignal)
+    CHECK_UNEXPECTED(finishedSomethingSent)
+    CHECK_UNEXPECTED(receivedAuthenticationRevokedSignal)
+    CHECK_UNEXPECTED(receivedRemoteToLocalSyncStopped)
+    CHECK_UNEXPECTED(receivedSendLocalChangedStopped)
+    CHECK_UNEXPECTED(receivedWillRepeatRemoteToLocalSyncAfterSendingChanges)
+    CHECK_UNEXPECTED(receivedDetectedConflictDuringLocalChangesSending)
+    CHECK_UNEXPECTED(receivedRateLimitExceeded)
+    CHECK_UNEXPECTED(receivedLinkedNotebookSyncChunksDownloaded)
+    CHECK_UNEXPECTED(receivedPreparedDirtyObjectsForSending)
+    CHECK_UNEXPECTED(receivedPreparedLinkedNotebookDirtyObjectsForSending)
+
+    checkProgressNotificationsOrder(catcher);
+    checkSyncChunksDataProcessingProgressOrder(catcher);
+    checkLinkedNotebookSyncChunksDataProcessingProgressEmpty(catcher);
+
+    checkParentTagsStoredBeforeChildTags(storedTagGuids);
+
+    checkIdentityOfLocalAndRemoteItems();
+    checkPersistentSyncState();
+    checkExpectedNamesOfConflictingItemsAfterSync();
+}
+
 void SynchronizationTester::
     testIncrementalSyncWithConflictingNotebooksFromUserOwnDataOnlyWithSameUsn()
 {
@@ -3111,6 +3595,175 @@ void SynchronizationTester::
     checkPersistentSyncState();
 }
 
+void SynchronizationTester::
+    testIncrementalSyncWithRateLimitsBreachOnGetLinkedNotebookSyncStateInSeveralShardsAttempt()
+{
+    setUserOwnItemsToRemoteStorage();
+    setLinkedNotebookItemsToRemoteStorage();
+
+    QHash<QString, QStringList> linkedNotebookGuidsByShardId;
+    setLinkedNotebooksFromSeveralShardsToRemoteStorage(
+        2, 8, linkedNotebookGuidsByShardId);
+
+    copyRemoteItemsToLocalStorage();
+    setRemoteStorageSyncStateToPersistentSyncSettings();
+
+    QSet<QString> updatedLinkedNotebookGuids;
+    for (const auto it:
+         qevercloud::toRange(::qAsConst(linkedNotebookGuidsByShardId)))
+    {
+        for (const auto & linkedNotebookGuid: it.value().mid(0, 6)) {
+            updatedLinkedNotebookGuids.insert(linkedNotebookGuid);
+        }
+    }
+
+    setNewTagsToLinkedNotebooksInRemoteStorage(updatedLinkedNotebookGuids);
+
+    m_pFakeNoteStore->setAPIRateLimitsExceedingTrigger(
+        FakeNoteStore::APIRateLimitsTrigger::
+            OnGetLinkedNotebookSyncStateAttempt);
+
+    SynchronizationManagerSignalsCatcher catcher(
+        *m_pLocalStorageManagerAsync, *m_pSynchronizationManager,
+        *m_pSyncStateStorage);
+
+    runTest(catcher);
+
+    CHECK_EXPECTED(receivedStartedSignal)
+    CHECK_EXPECTED(receivedFinishedSignal)
+    CHECK_EXPECTED(finishedSomethingDownloaded)
+    CHECK_EXPECTED(receivedRemoteToLocalSyncDone)
+    CHECK_EXPECTED(remoteToLocalSyncDoneSomethingDownloaded)
+    CHECK_EXPECTED(receivedSyncChunksDownloaded)
+    CHECK_EXPECTED(receivedLinkedNotebookSyncChunksDownloaded)
+    CHECK_EXPECTED(receivedRateLimitExceeded)
+
+    CHECK_UNEXPECTED(receivedAuthenticationFinishedSignal)
+    CHECK_UNEXPECTED(receivedStoppedSignal)
+    CHECK_UNEXPECTED(finishedSomethingSent)
+    CHECK_UNEXPECTED(receivedAuthenticationRevokedSignal)
+    CHECK_UNEXPECTED(receivedRemoteToLocalSyncStopped)
+    CHECK_UNEXPECTED(receivedSendLocalChangedStopped)
+    CHECK_UNEXPECTED(receivedWillRepeatRemoteToLocalSyncAfterSendingChanges)
+    CHECK_UNEXPECTED(receivedDetectedConflictDuringLocalChangesSending)
+    CHECK_UNEXPECTED(receivedPreparedDirtyObjectsForSending)
+    CHECK_UNEXPECTED(receivedPreparedLinkedNotebookDirtyObjectsForSending)
+
+    // Sync states received before the rate limit breach should not be
+    // requested and counted once again after it
+    checkLinkedNotebookSyncStatesCheckProgress(
+        catcher, updatedLinkedNotebookGuids);
+
+    checkProgressNotificationsOrder(catcher);
+    checkSyncChunksDataProcessingProgressOrder(catcher);
+    checkLinkedNotebookSyncChunksDataProcessingProgressOrder(catcher);
+
+    checkIdentityOfLocalAndRemoteItems();
+    checkPersistentSyncState();
+}
+
+void SynchronizationTester::
+    testIncrementalSyncWithRateLimitsBreachOnGetLinkedNotebookSyncChunkInSeveralShardsAttempt()
+{
+    setUserOwnItemsToRemoteStorage();
+    setLinkedNotebookItemsToRemoteStorage();
+
+    QHash<QString, QStringList> linkedNotebookGuidsByShardId;
+    setLinkedNotebooksFromSeveralShardsToRemoteStorage(
+        2, 8, linkedNotebookGuidsByShardId);
+
+    copyRemoteItemsToLocalStorage();
+    setRemoteStorageSyncStateToPersistentSyncSettings();
+
+    QSet<QString> updatedLinkedNotebookGuids;
+    for (const auto it:
+         qevercloud::toRange(::qAsConst(linkedNotebookGuidsByShardId)))
+    {
+        for (const auto & linkedNotebookGuid: it.value().mid(0, 6)) {
+            updatedLinkedNotebookGuids.insert(linkedNotebookGuid);
+        }
+    }
+
+    setNewTagsToLinkedNotebooksInRemoteStorage(updatedLinkedNotebookGuids);
+
+    m_pFakeNoteStore->setAPIRateLimitsExceedingTrigger(
+        FakeNoteStore::APIRateLimitsTrigger::
+            OnGetLinkedNotebookSyncChunkAttempt);
+
+    SynchronizationManagerSignalsCatcher catcher(
+        *m_pLocalStorageManagerAsync, *m_pSynchronizationManager,
+        *m_pSyncStateStorage);
+
+    runTest(catcher);
+
+    CHECK_EXPECTED(receivedStartedSignal)
+    CHECK_EXPECTED(receivedFinishedSignal)
+    CHECK_EXPECTED(finishedSomethingDownloaded)
+    CHECK_EXPECTED(receivedRemoteToLocalSyncDone)
+    CHECK_EXPECTED(remoteToLocalSyncDoneSomethingDownloaded)
+    CHECK_EXPECTED(receivedSyncChunksDownloaded)
+    CHECK_EXPECTED(receivedLinkedNotebookSyncChunksDownloaded)
+    CHECK_EXPECTED(receivedRateLimitExceeded)
+
+    CHECK_UNEXPECTED(receivedAuthenticationFinishedSignal)
+    CHECK_UNEXPECTED(receivedStoppedSignal)
+    CHECK_UNEXPECTED(finishedSomethingSent)
+    CHECK_UNEXPECTED(receivedAuthenticationRevokedSignal)
+    CHECK_UNEXPECTED(receivedRemoteToLocalSyncStopped)
+    CHECK_UNEXPECTED(receivedSendLocalChangedStopped)
+    CHECK_UNEXPECTED(receivedWillRepeatRemoteToLocalSyncAfterSendingChanges)
+    CHECK_UNEXPECTED(receivedDetectedConflictDuringLocalChangesSending)
+    CHECK_UNEXPECTED(receivedPreparedDirtyObjectsForSending)
+    CHECK_UNEXPECTED(receivedPreparedLinkedNotebookDirtyObjectsForSending)
+
+    checkLinkedNotebookSyncStatesCheckProgress(
+        catcher, updatedLinkedNotebookGuids);
+
+    // Only the sync chunk request which hit the rate limit should have been
+    // repeated, the sync chunks downloaded by other requests in flight
+    // should have been accepted
+    const auto & syncChunkRequestsAfterUsns =
+        m_pFakeNoteStore->linkedNotebookSyncChunkRequestsAfterUsns();
+
+    QVERIFY2(
+        syncChunkRequestsAfterUsns.size() == updatedLinkedNotebookGuids.size(),
+        "Unexpected number of linked notebooks for which sync chunks "
+        "were requested");
+
+    int repeatedSyncChunkRequestsCount = 0;
+    for (const auto it: qevercloud::toRange(syncChunkRequestsAfterUsns)) {
+        QVERIFY2(
+            updatedLinkedNotebookGuids.contains(it.key()),
+            "Sync chunks were requested for linked notebook without updates");
+
+        const auto & afterUsns = it.value();
+        if (afterUsns.size() == 1) {
+            continue;
+        }
+
+        QVERIFY2(
+            afterUsns.size() == 2,
+            "Unexpected number of sync chunk requests for linked notebook");
+
+        QVERIFY2(
+            afterUsns[0] == afterUsns[1],
+            "Repeated sync chunk request has unexpected after USN");
+
+        ++repeatedSyncChunkRequestsCount;
+    }
+
+    QVERIFY2(
+        repeatedSyncChunkRequestsCount == 1,
+        "Unexpected number of repeated linked notebook sync chunk requests");
+
+    checkProgressNotificationsOrder(catcher);
+    checkSyncChunksDataProcessingProgressOrder(catcher);
+    checkLinkedNotebookSyncChunksDataProcessingProgressOrder(catcher);
+
+    checkIdentityOfLocalAndRemoteItems();
+    checkPersistentSyncState();
+}
+
 void SynchronizationTester::
     testIncrementalSyncWithRateLimitsBreachOnGetNewNoteAfterDownloadingUserOwnSyncChunksAttempt()
 {
@@ -4329,32 +4982,257 @@ void SynchronizationTester::
     CHECK_EXPECTED(receivedLinkedNotebookSyncChunksDownloaded)
     CHECK_EXPECTED(receivedRateLimitExceeded)
 
-    CHECK_UNEXPECTED(receivedAuthenticationFinishedSignal)
-    CHECK_UNEXPECTED(receivedStoppedSignal)
-    CHECK_UNEXPECTED(finishedSomethingSent)
-    CHECK_UNEXPECTED(receivedAuthenticationRevokedSignal)
-    CHECK_UNEXPECTED(receivedRemoteToLocalSyncStopped)
-    CHECK_UNEXPECTED(receivedSendLocalChangedStopped)
-    CHECK_UNEXPECTED(receivedWillRepeatRemoteToLocalSyncAfterSendingChanges)
-    CHECK_UNEXPECTED(receivedDetectedConflictDuringLocalChangesSending)
-    CHECK_UNEXPECTED(receivedPreparedDirtyObjectsForSending)
-    CHECK_UNEXPECTED(receivedPreparedLinkedNotebookDirtyObjectsForSending)
+    CHECK_UNEXPECTED(receivedAuthenticationFinishedSignal)
+    CHECK_UNEXPECTED(receivedStoppedSignal)
+    CHECK_UNEXPECTED(finishedSomethingSent)
+    CHECK_UNEXPECTED(receivedAuthenticationRevokedSignal)
+    CHECK_UNEXPECTED(receivedRemoteToLocalSyncStopped)
+    CHECK_UNEXPECTED(receivedSendLocalChangedStopped)
+    CHECK_UNEXPECTED(receivedWillRepeatRemoteToLocalSyncAfterSendingChanges)
+    CHECK_UNEXPECTED(receivedDetectedConflictDuringLocalChangesSending)
+    CHECK_UNEXPECTED(receivedPreparedDirtyObjectsForSending)
+    CHECK_UNEXPECTED(receivedPreparedLinkedNotebookDirtyObjectsForSending)
+
+    checkProgressNotificationsOrder(catcher);
+    checkSyncChunksDataProcessingProgressOrder(catcher);
+    checkLinkedNotebookSyncChunksDataProcessingProgressOrder(catcher);
+
+    checkIdentityOfLocalAndRemoteItems();
+    checkPersistentSyncState();
+
+    // synced user own content + synced linked notebooks content + after local
+    // changes sending, no sync state persistence event shoudl fire on API rate
+    // limit breach since all the USNs would be the same as those persisted
+    // before the event
+    int numExpectedSyncStateEntries = 3;
+
+    checkSyncStatePersistedRightAfterAPIRateLimitBreach(
+        catcher, numExpectedSyncStateEntries, -1);
+}
+
+void SynchronizationTester::testUpdatesCheckWithoutRemoteChanges()
+{
+    setUserOwnItemsToRemoteStorage();
+    setLinkedNotebookItemsToRemoteStorage();
+    copyRemoteItemsToLocalStorage();
+    setRemoteStorageSyncStateToPersistentSyncSettings();
+    setCurrentSyncStatesToRemoteStorage();
+
+    bool success = false;
+    bool updatesAvailable = true;
+    ErrorString errorDescription;
+    runUpdatesCheck(success, updatesAvailable, errorDescription);
+
+    QVERIFY2(success, qPrintable(errorDescription.nonLocalizedString()));
+    QVERIFY(!updatesAvailable);
+    QVERIFY(!m_pSynchronizationManager->active());
+}
+
+void SynchronizationTester::
+    testUpdatesCheckWithNewRemoteItemsFromUserOwnDataOnly()
+{
+    setUserOwnItemsToRemoteStorage();
+    setLinkedNotebookItemsToRemoteStorage();
+    copyRemoteItemsToLocalStorage();
+    setRemoteStorageSyncStateToPersistentSyncSettings();
+
+    setNewUserOwnItemsToRemoteStorage();
+    setCurrentSyncStatesToRemoteStorage();
+
+    bool success = false;
+    bool updatesAvailable = false;
+    ErrorString errorDescription;
+    runUpdatesCheck(success, updatesAvailable, errorDescription);
+
+    QVERIFY2(success, qPrintable(errorDescription.nonLocalizedString()));
+    QVERIFY(updatesAvailable);
+}
+
+void SynchronizationTester::
+    testUpdatesCheckWithNewRemoteItemsFromLinkedNotebooksOnly()
+{
+    setUserOwnItemsToRemoteStorage();
+    setLinkedNotebookItemsToRemoteStorage();
+    copyRemoteItemsToLocalStorage();
+    setRemoteStorageSyncStateToPersistentSyncSettings();
+
+    setNewLinkedNotebookItemsToRemoteStorage();
+    setCurrentSyncStatesToRemoteStorage();
+
+    bool success = false;
+    bool updatesAvailable = false;
+    ErrorString errorDescription;
+    runUpdatesCheck(success, updatesAvailable, errorDescription);
+
+    QVERIFY2(success, qPrintable(errorDescription.nonLocalizedString()));
+    QVERIFY(updatesAvailable);
+}
+
+void SynchronizationTester::testAdaptivePolling()
+{
+    setUserOwnItemsToRemoteStorage();
+    setLinkedNotebookItemsToRemoteStorage();
+    copyRemoteItemsToLocalStorage();
+    setRemoteStorageSyncStateToPersistentSyncSettings();
+    setCurrentSyncStatesToRemoteStorage();
+
+    const qint64 minIntervalMsec = 100;
+    const qint64 maxIntervalMsec = 400;
+
+    // Coarse timers are allowed to fire up to 5% earlier than requested
+    auto lowerBound = [](const qint64 intervalMsec) {
+        return intervalMsec * 9 / 10;
+    };
+
+    struct UpdatesCheckResult
+    {
+        qint64 m_timestamp = 0;
+        bool m_success = false;
+        bool m_updatesAvailable = false;
+    };
+
+    QElapsedTimer elapsedTimer;
+    QVector<UpdatesCheckResult> updatesChecks;
+    QVector<qint64> syncStartTimestamps;
+    QVector<qint64> syncFinishTimestamps;
+
+    // Limits the lifetime of connections to lambdas capturing local variables
+    QObject context;
+
+    QObject::connect(
+        m_pSynchronizationManager,
+        &SynchronizationManager::updatesCheckFinished, &context,
+        [&](bool success, bool updatesAvailable, ErrorString) {
+            UpdatesCheckResult result;
+            result.m_timestamp = elapsedTimer.elapsed();
+            result.m_success = success;
+            result.m_updatesAvailable = updatesAvailable;
+            updatesChecks << result;
+        });
+
+    QObject::connect(
+        m_pSynchronizationManager, &SynchronizationManager::started, &context,
+        [&] { syncStartTimestamps << elapsedTimer.elapsed(); });
+
+    QObject::connect(
+        m_pSynchronizationManager, &SynchronizationManager::finished, &context,
+        [&](Account, bool, bool) {
+            syncFinishTimestamps << elapsedTimer.elapsed();
+        });
+
+    auto waitUntil = [this](const std::function<bool()> & condition) {
+        QTimer timer;
+        timer.setInterval(MAX_ALLOWED_TEST_DURATION_MSEC);
+        timer.setSingleShot(true);
+
+        QTimer conditionCheckTimer;
+        conditionCheckTimer.setInterval(10);
+
+        EventLoopWithExitStatus loop;
+
+        QObject::connect(
+            &timer, &QTimer::timeout, &loop,
+            &EventLoopWithExitStatus::exitAsTimeout);
+
+        QObject::connect(
+            m_pSynchronizationManager, &SynchronizationManager::failed, &loop,
+            &EventLoopWithExitStatus::exitAsFailureWithErrorString);
+
+        QObject::connect(&conditionCheckTimer, &QTimer::timeout, &loop, [&] {
+            if (condition()) {
+                loop.exitAsSuccess();
+            }
+        });
+
+        timer.start();
+        conditionCheckTimer.start();
+
+        Q_UNUSED(loop.exec())
+        return loop.exitStatus() ==
+            EventLoopWithExitStatus::ExitStatus::Success;
+    };
+
+    elapsedTimer.start();
+    m_pSynchronizationManager->startAdaptivePolling(
+        static_cast<int>(minIntervalMsec), static_cast<int>(maxIntervalMsec));
+
+    // 1. Without any changes the polling interval doubles up to the maximal one
+    QVERIFY(waitUntil([&] { return updatesChecks.size() >= 4; }));
+    QVERIFY(syncStartTimestamps.isEmpty());
+
+    for (const auto & updatesCheck: qAsConst(updatesChecks)) {
+        QVERIFY(updatesCheck.m_success);
+        QVERIFY(!updatesCheck.m_updatesAvailable);
+    }
+
+    qint64 firstGap = updatesChecks[1].m_timestamp -
+        updatesChecks[0].m_timestamp;
+
+    qint64 secondGap = updatesChecks[2].m_timestamp -
+        updatesChecks[1].m_timestamp;
+
+    qint64 thirdGap = updatesChecks[3].m_timestamp -
+        updatesChecks[2].m_timestamp;
+
+    QVERIFY2(
+        firstGap >= lowerBound(2 * minIntervalMsec),
+        qPrintable(QString::number(firstGap)));
+
+    QVERIFY2(
+        secondGap >= lowerBound(maxIntervalMsec),
+        qPrintable(QString::number(secondGap)));
+
+    QVERIFY2(
+        thirdGap >= lowerBound(maxIntervalMsec) &&
+            thirdGap < lowerBound(2 * maxIntervalMsec),
+        qPrintable(QString::number(thirdGap)));
+
+    // 2. Local changes reset the polling interval to the minimal one and
+    // the next poll launches the sync
+    qint64 localChangesTimestamp = elapsedTimer.elapsed();
+    m_pSynchronizationManager->notifyLocalChanges();
+
+    QVERIFY(waitUntil([&] { return !syncFinishTimestamps.isEmpty(); }));
+    QVERIFY(!syncStartTimestamps.isEmpty());
+
+    qint64 syncStartDelay = syncStartTimestamps[0] - localChangesTimestamp;
+    QVERIFY2(
+        syncStartDelay < lowerBound(maxIntervalMsec),
+        qPrintable(QString::number(syncStartDelay)));
 
-    checkProgressNotificationsOrder(catcher);
-    checkSyncChunksDataProcessingProgressOrder(catcher);
-    checkLinkedNotebookSyncChunksDataProcessingProgressOrder(catcher);
+    // 3. Remote changes found by the polling reset the polling interval to
+    // the minimal one and launch the sync
+    int updatesCheckCount = updatesChecks.size();
+    QVERIFY(
+        waitUntil([&] { return updatesChecks.size() > updatesCheckCount; }));
+    QVERIFY(!updatesChecks.last().m_updatesAvailable);
 
-    checkIdentityOfLocalAndRemoteItems();
-    checkPersistentSyncState();
+    setModifiedUserOwnItemsToRemoteStorage();
+    setCurrentSyncStatesToRemoteStorage();
 
-    // synced user own content + synced linked notebooks content + after local
-    // changes sending, no sync state persistence event shoudl fire on API rate
-    // limit breach since all the USNs would be the same as those persisted
-    // before the event
-    int numExpectedSyncStateEntries = 3;
+    updatesCheckCount = updatesChecks.size();
+    int syncCount = syncFinishTimestamps.size();
+    QVERIFY(waitUntil([&] { return syncFinishTimestamps.size() > syncCount; }));
 
-    checkSyncStatePersistedRightAfterAPIRateLimitBreach(
-        catcher, numExpectedSyncStateEntries, -1);
+    QVERIFY(updatesChecks.size() > updatesCheckCount);
+    const auto remoteChangesCheck = updatesChecks[updatesCheckCount];
+    QVERIFY(remoteChangesCheck.m_success);
+    QVERIFY(remoteChangesCheck.m_updatesAvailable);
+    QVERIFY(syncStartTimestamps.last() >= remoteChangesCheck.m_timestamp);
+
+    qint64 syncFinishTimestamp = syncFinishTimestamps.last();
+    updatesCheckCount = updatesChecks.size();
+    QVERIFY(
+        waitUntil([&] { return updatesChecks.size() > updatesCheckCount; }));
+
+    qint64 nextPollDelay =
+        updatesChecks.last().m_timestamp - syncFinishTimestamp;
+
+    QVERIFY2(
+        nextPollDelay < lowerBound(maxIntervalMsec),
+        qPrintable(QString::number(nextPollDelay)));
+
+    m_pSynchronizationManager->stopAdaptivePolling();
 }
 
 void SynchronizationTester::setUserOwnItemsToRemoteStorage()
@@ -6619,6 +7497,203 @@ void SynchronizationTester::setNewLinkedNotebookItemsToRemoteStorage()
         fourthLinkedNotebook.username(), syncState);
 }
 
+void SynchronizationTester::setTagsTreeToRemoteStorage(
+    QStringList & rootTagGuids, QStringList & childTagGuids)
+{
+    ErrorString errorDescription;
+    bool res = false;
+
+    rootTagGuids.clear();
+    childTagGuids.clear();
+
+    for (int i = 0; i < 2; ++i) {
+        const QString number = QString::number(i + 1);
+
+        Tag rootTag;
+        rootTag.setGuid(UidGenerator::Generate());
+        rootTag.setName(QStringLiteral("Tags tree root tag #") + number);
+        res = m_pFakeNoteStore->setTag(rootTag, errorDescription);
+        QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+
+        Tag childTag;
+        childTag.setGuid(UidGenerator::Generate());
+        childTag.setParentGuid(rootTag.guid());
+        childTag.setParentLocalUid(rootTag.localUid());
+        childTag.setName(QStringLiteral("Tags tree child tag #") + number);
+        res = m_pFakeNoteStore->setTag(childTag, errorDescription);
+        QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+
+        rootTagGuids << rootTag.guid();
+        childTagGuids << childTag.guid();
+    }
+}
+
+void SynchronizationTester::setNewTagsTreeLevelsToRemoteStorage(
+    const QStringList & rootTagGuids, const QStringList & childTagGuids)
+{
+    ErrorString errorDescription;
+    bool res = false;
+
+    // Modified root tags make the existing child tags belong to the second
+    // level of tags pending processing
+    for (const auto & tagGuid: qAsConst(rootTagGuids)) {
+        const auto * pTag = m_pFakeNoteStore->findTag(tagGuid);
+
+        QVERIFY2(
+            pTag != nullptr,
+            "Detected unexpectedly missing tag in fake note store");
+
+        Tag modifiedTag(*pTag);
+        modifiedTag.setName(modifiedTag.name() + MODIFIED_REMOTELY_SUFFIX);
+        modifiedTag.setDirty(true);
+        modifiedTag.setLocal(false);
+        modifiedTag.setUpdateSequenceNumber(-1);
+
+        res = m_pFakeNoteStore->setTag(modifiedTag, errorDescription);
+        QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+    }
+
+    QString parentTagGuid;
+    for (int i = 0; i < 3; ++i) {
+        Tag newTag;
+        newTag.setGuid(UidGenerator::Generate());
+
+        newTag.setName(
+            QStringLiteral("New tags tree tag at level #") +
+            QString::number(i + 1));
+
+        if (!parentTagGuid.isEmpty()) {
+            newTag.setParentGuid(parentTagGuid);
+        }
+
+        res = m_pFakeNoteStore->setTag(newTag, errorDescription);
+        QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+
+        parentTagGuid = newTag.guid();
+    }
+
+    for (const auto & tagGuid: qAsConst(childTagGuids)) {
+        Tag grandChildTag;
+        grandChildTag.setGuid(UidGenerator::Generate());
+        grandChildTag.setParentGuid(tagGuid);
+
+        grandChildTag.setName(
+            QStringLiteral("New grand child tag of tag with guid ") + tagGuid);
+
+        res = m_pFakeNoteStore->setTag(grandChildTag, errorDescription);
+        QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+
+        Tag greatGrandChildTag;
+        greatGrandChildTag.setGuid(UidGenerator::Generate());
+        greatGrandChildTag.setParentGuid(grandChildTag.guid());
+
+        greatGrandChildTag.setName(
+            QStringLiteral("New great grand child tag of tag with guid ") +
+            tagGuid);
+
+        res = m_pFakeNoteStore->setTag(greatGrandChildTag, errorDescription);
+        QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+    }
+}
+
+void SynchronizationTester::setLinkedNotebooksFromSeveralShardsToRemoteStorage(
+    const int numShards, const int numLinkedNotebooksPerShard,
+    QHash<QString, QStringList> & linkedNotebookGuidsByShardId)
+{
+    ErrorString errorDescription;
+    bool res = false;
+
+    for (int i = 0; i < numShards; ++i) {
+        const QString shardId = UidGenerator::Generate();
+        auto & linkedNotebookGuids = linkedNotebookGuidsByShardId[shardId];
+
+        for (int j = 0; j < numLinkedNotebooksPerShard; ++j) {
+            const QString name = QStringLiteral("Shard ") +
+                QString::number(i + 1) + QStringLiteral(" linked notebook ") +
+                QString::number(j + 1);
+
+            LinkedNotebook linkedNotebook;
+            linkedNotebook.setGuid(UidGenerator::Generate());
+            linkedNotebook.setUsername(name + QStringLiteral(" owner"));
+            linkedNotebook.setShareName(name + QStringLiteral(" share name"));
+            linkedNotebook.setShardId(shardId);
+            linkedNotebook.setSharedNotebookGlobalId(UidGenerator::Generate());
+
+            linkedNotebook.setNoteStoreUrl(
+                name + QStringLiteral(" fake note store URL"));
+
+            linkedNotebook.setWebApiUrlPrefix(
+                name + QStringLiteral(" fake web API URL prefix"));
+
+            res = m_pFakeNoteStore->setLinkedNotebook(
+                linkedNotebook, errorDescription);
+
+            QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+
+            m_pFakeNoteStore->setLinkedNotebookAuthToken(
+                linkedNotebook.username(), UidGenerator::Generate());
+
+            Notebook notebook;
+            notebook.setGuid(UidGenerator::Generate());
+            notebook.setName(name);
+            notebook.setDefaultNotebook(false);
+            notebook.setLinkedNotebookGuid(linkedNotebook.guid());
+            res = m_pFakeNoteStore->setNotebook(notebook, errorDescription);
+            QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+
+            Tag tag;
+            tag.setGuid(UidGenerator::Generate());
+            tag.setName(name + QStringLiteral(" tag"));
+            tag.setLinkedNotebookGuid(linkedNotebook.guid());
+            res = m_pFakeNoteStore->setTag(tag, errorDescription);
+            QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+
+            linkedNotebookGuids << linkedNotebook.guid();
+        }
+    }
+}
+
+void SynchronizationTester::setNewTagsToLinkedNotebooksInRemoteStorage(
+    const QSet<QString> & linkedNotebookGuids)
+{
+    ErrorString errorDescription;
+    bool res = false;
+
+    auto linkedNotebooks = m_pFakeNoteStore->linkedNotebooks();
+
+    for (const auto & linkedNotebookGuid: ::qAsConst(linkedNotebookGuids)) {
+        auto it = linkedNotebooks.find(linkedNotebookGuid);
+        QVERIFY2(
+            it != linkedNotebooks.end(),
+            "Detected unexpectedly missing linked notebook in remote storage");
+
+        Tag newTag;
+        newTag.setGuid(UidGenerator::Generate());
+
+        newTag.setName(
+            QStringLiteral("New tag for linked notebook with guid ") +
+            linkedNotebookGuid);
+
+        newTag.setLinkedNotebookGuid(linkedNotebookGuid);
+        res = m_pFakeNoteStore->setTag(newTag, errorDescription);
+        QVERIFY2(res, qPrintable(errorDescription.nonLocalizedString()));
+
+        qevercloud::SyncState syncState;
+        syncState.currentTime = QDateTime::currentMSecsSinceEpoch();
+
+        syncState.fullSyncBefore =
+            QDateTime::currentDateTime().addMonths(-1).toMSecsSinceEpoch();
+
+        syncState.uploaded = 42;
+
+        syncState.updateCount =
+            m_pFakeNoteStore->currentMaxUsn(linkedNotebookGuid);
+
+        m_pFakeNoteStore->setLinkedNotebookSyncState(
+            it.value().username.ref(), syncState);
+    }
+}
+
 void SynchronizationTester::setModifiedUserOwnItemsToLocalStorage()
 {
     ErrorString errorDescription;
@@ -7298,6 +8373,34 @@ void SynchronizationTester::copyRemoteItemsToLocalStorage()
     }
 }
 
+void SynchronizationTester::setSyncProgressCheckpointInterval(
+    const qint64 intervalMsec)
+{
+    ApplicationSettings appSettings(
+        m_testAccount, SYNCHRONIZATION_PERSISTENCE_NAME);
+
+    appSettings.beginGroup(SYNC_SETTINGS_KEY_GROUP);
+    appSettings.setValue(SYNC_PROGRESS_CHECKPOINT_INTERVAL_KEY, intervalMsec);
+    appSettings.endGroup();
+}
+
+void SynchronizationTester::recreateSynchronizationManager()
+{
+    m_pSynchronizationManager->disconnect();
+    delete m_pSynchronizationManager;
+
+    // Replies to the requests of the deleted sync manager must not reach
+    // the new one
+    m_pFakeNoteStore->discardPendingAsyncRequests();
+
+    m_pSynchronizationManager = new SynchronizationManager(
+        QStringLiteral("www.evernote.com"), *m_pLocalStorageManagerAsync,
+        *m_pFakeAuthenticationManager, this, m_pFakeNoteStore, m_pFakeUserStore,
+        m_pFakeKeychainService, m_pSyncStateStorage);
+
+    m_pSynchronizationManager->setAccount(m_testAccount);
+}
+
 void SynchronizationTester::setRemoteStorageSyncStateToPersistentSyncSettings()
 {
     qint32 usersOwnMaxUsn = m_pFakeNoteStore->currentMaxUsn();
@@ -7350,6 +8453,33 @@ void SynchronizationTester::setRemoteStorageSyncStateToPersistentSyncSettings()
     appSettings.endArray();
 }
 
+void SynchronizationTester::setCurrentSyncStatesToRemoteStorage()
+{
+    qevercloud::Timestamp timestamp = QDateTime::currentMSecsSinceEpoch();
+
+    qevercloud::SyncState syncState;
+    syncState.currentTime = timestamp;
+
+    syncState.fullSyncBefore = QDateTime::fromMSecsSinceEpoch(timestamp)
+                                   .addMonths(-1)
+                                   .toMSecsSinceEpoch();
+
+    syncState.uploaded = 42;
+    syncState.updateCount = m_pFakeNoteStore->currentMaxUsn();
+    m_pFakeNoteStore->setSyncState(syncState);
+
+    auto linkedNotebooks = m_pFakeNoteStore->linkedNotebooks();
+    for (auto it = linkedNotebooks.constBegin(),
+              end = linkedNotebooks.constEnd();
+         it != end; ++it)
+    {
+        syncState.updateCount = m_pFakeNoteStore->currentMaxUsn(it.key());
+
+        m_pFakeNoteStore->setLinkedNotebookSyncState(
+            it.value().username.ref(), syncState);
+    }
+}
+
 void SynchronizationTester::checkProgressNotificationsOrder(
     const SynchronizationManagerSignalsCatcher & catcher)
 {
@@ -7445,6 +8575,111 @@ void SynchronizationTester::
     }
 }
 
+void SynchronizationTester::checkParentTagsStoredBeforeChildTags(
+    const QStringList & storedTagGuids)
+{
+    QVERIFY2(
+        !storedTagGuids.isEmpty(),
+        "No tags were stored in the local storage during sync");
+
+    for (int i = 0, size = storedTagGuids.size(); i < size; ++i) {
+        const auto * pTag = m_pFakeNoteStore->findTag(storedTagGuids[i]);
+
+        QVERIFY2(
+            pTag != nullptr,
+            "Detected unexpectedly missing tag in fake note store");
+
+        if (!pTag->hasParentGuid()) {
+            continue;
+        }
+
+        // Parent tags which were not changed during sync are already
+        // in the local storage
+        int parentTagIndex = storedTagGuids.indexOf(pTag->parentGuid());
+        if (parentTagIndex < 0) {
+            continue;
+        }
+
+        QVERIFY2(
+            parentTagIndex < i,
+            "Child tag was stored in the local storage before its parent");
+    }
+}
+
+void SynchronizationTester::checkLinkedNotebookSyncStatesCheckProgress(
+    const SynchronizationManagerSignalsCatcher & catcher,
+    const QSet<QString> & updatedLinkedNotebookGuids)
+{
+    const auto linkedNotebooks = m_pFakeNoteStore->linkedNotebooks();
+
+    const auto totalLinkedNotebooksToCheck =
+        static_cast<quint32>(linkedNotebooks.size());
+
+    const auto & checkProgress =
+        catcher.linkedNotebookSyncStatesCheckProgress();
+
+    QVERIFY2(
+        static_cast<quint32>(checkProgress.size()) ==
+            totalLinkedNotebooksToCheck,
+        "Unexpected number of linked notebook sync states check progress "
+        "notifications");
+
+    QSet<QString> checkedLinkedNotebookGuids;
+    quint32 expectedLinkedNotebooksChecked = 0;
+
+    for (const auto & progress: ::qAsConst(checkProgress)) {
+        ++expectedLinkedNotebooksChecked;
+
+        QVERIFY2(
+            progress.m_linkedNotebooksChecked ==
+                expectedLinkedNotebooksChecked,
+            "Unexpected number of checked linked notebook sync states");
+
+        QVERIFY2(
+            progress.m_totalLinkedNotebooksToCheck ==
+                totalLinkedNotebooksToCheck,
+            "Unexpected total number of linked notebook sync states to check");
+
+        QVERIFY2(
+            linkedNotebooks.contains(progress.m_linkedNotebookGuid),
+            "Sync state was checked for unknown linked notebook");
+
+        QVERIFY2(
+            !checkedLinkedNotebookGuids.contains(
+                progress.m_linkedNotebookGuid),
+            "Linked notebook sync state was checked more than once");
+
+        checkedLinkedNotebookGuids.insert(progress.m_linkedNotebookGuid);
+
+        QVERIFY2(
+            progress.m_hasUpdates ==
+                updatedLinkedNotebookGuids.contains(
+                    progress.m_linkedNotebookGuid),
+            "Unexpected has updates flag for checked linked notebook sync "
+            "state");
+    }
+}
+
+void SynchronizationTester::checkFindRequestsSkippedForUpToDateItems(
+    const QStringList & remoteGuids, const QStringList & modifiedLocalGuids,
+    const QSet<QString> & foundGuids)
+{
+    for (const auto & guid: ::qAsConst(remoteGuids)) {
+        if (modifiedLocalGuids.contains(guid)) {
+            QVERIFY2(
+                foundGuids.contains(guid),
+                "Locally modified item was not looked up in the local storage "
+                "during sync");
+        }
+        else {
+            QVERIFY2(
+                !foundGuids.contains(guid),
+                "Up to date item was looked up in the local storage during "
+                "sync");
+        }
+    }
+}
+
 void SynchronizationTester::checkIdentityOfLocalAndRemoteItems()
 {
     // List stuff from local storage
@@ -8820,5 +10055,52 @@ void SynchronizationTester::runTest(
     }
 }
 
+void SynchronizationTester::runUpdatesCheck(
+    bool & success, bool & updatesAvailable, ErrorString & errorDescription)
+{
+    auto status = EventLoopWithExitStatus::ExitStatus::Failure;
+    {
+        QTimer timer;
+        timer.setInterval(MAX_ALLOWED_TEST_DURATION_MSEC);
+        timer.setSingleShot(true);
+
+        EventLoopWithExitStatus loop;
+
+        QObject::connect(
+            &timer, &QTimer::timeout, &loop,
+            &EventLoopWithExitStatus::exitAsTimeout);
+
+        QObject::connect(
+            m_pSynchronizationManager,
+            &SynchronizationManager::updatesCheckFinished, &loop,
+            [&](bool checkSuccess, bool checkUpdatesAvailable,
+                ErrorString checkErrorDescription) {
+                success = checkSuccess;
+                updatesAvailable = checkUpdatesAvailable;
+                errorDescription = checkErrorDescription;
+                loop.exitAsSuccess();
+            });
+
+        QTimer slotInvokingTimer;
+        slotInvokingTimer.setInterval(500);
+        slotInvokingTimer.setSingleShot(true);
+
+        timer.start();
+        slotInvokingTimer.singleShot(
+            0, m_pSynchronizationManager,
+            &SynchronizationManager::checkForUpdates);
+
+        Q_UNUSED(loop.exec())
+        status = loop.exitStatus();
+    }
+
+    if (status == EventLoopWithExitStatus::ExitStatus::Timeout) {
+        QFAIL("Updates check failed to finish in time");
+    }
+    else if (status != EventLoopWithExitStatus::ExitStatus::Success) {
+        QFAIL("Internal error: incorrect return status from updates check");
+    }
+}
+
 } // namespace test
 } // namespace quentier
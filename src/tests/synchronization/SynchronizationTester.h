@@ -55,10 +55,15 @@ private Q_SLOTS:
 
     void testRemoteToLocalFullSyncWithUserOwnDataOnly();
     void testRemoteToLocalFullSyncWithLinkedNotebooks();
+    void testRemoteToLocalFullSyncResumesFromCheckpoint();
+    void testRemoteToLocalFullSyncSkipsFindRequestsForUpToDateLocalItems();
+    void testIncrementalSyncDoesNotCheckpointWithPendingExpungedItems();
 
     void testIncrementalSyncWithNewRemoteItemsFromUserOwnDataOnly();
     void testIncrementalSyncWithNewRemoteItemsFromLinkedNotebooksOnly();
     void
+    testIncrementalSyncWithNewRemoteItemsFromLinkedNotebooksInSeveralShards();
+    void
     testIncrementalSyncWithNewRemoteItemsFromUserOwnDataAndLinkedNotebooks();
     void testIncrementalSyncWithModifiedRemoteItemsFromUserOwnDataOnly();
     void testIncrementalSyncWithModifiedRemoteItemsFromLinkedNotebooksOnly();
@@ -135,6 +140,9 @@ private Q_SLOTS:
     void
     testIncrementalSyncWithConflictingSavedSearchesFromUserOwnDataOnlyWithSameUsn();
     void testIncrementalSyncWithConflictingTagsFromUserOwnDataOnlyWithSameUsn();
+
+    void
+    testIncrementalSyncWithMultiLevelTagsTreeAndConflictsWithinOneLevel();
     void
     testIncrementalSyncWithConflictingNotebooksFromUserOwnDataOnlyWithSameUsn();
     void
@@ -178,6 +186,12 @@ private Q_SLOTS:
     void
     testIncrementalSyncWithRateLimitsBreachOnGetLinkedNotebookSyncChunkAttempt();
 
+    void
+    testIncrementalSyncWithRateLimitsBreachOnGetLinkedNotebookSyncStateInSeveralShardsAttempt();
+
+    void
+    testIncrementalSyncWithRateLimitsBreachOnGetLinkedNotebookSyncChunkInSeveralShardsAttempt();
+
     void
     testIncrementalSyncWithRateLimitsBreachOnGetNewNoteAfterDownloadingUserOwnSyncChunksAttempt();
     void
@@ -218,11 +232,31 @@ private Q_SLOTS:
     void
     testIncrementalSyncWithRateLimitsBreachOnAuthenticateToLinkedNotebookAttempt();
 
+    void testUpdatesCheckWithoutRemoteChanges();
+    void testUpdatesCheckWithNewRemoteItemsFromUserOwnDataOnly();
+    void testUpdatesCheckWithNewRemoteItemsFromLinkedNotebooksOnly();
+
+    void testAdaptivePolling();
+
 private:
     void setUserOwnItemsToRemoteStorage();
     void setLinkedNotebookItemsToRemoteStorage();
     void setNewUserOwnItemsToRemoteStorage();
     void setNewLinkedNotebookItemsToRemoteStorage();
+
+    void setLinkedNotebooksFromSeveralShardsToRemoteStorage(
+        const int numShards, const int numLinkedNotebooksPerShard,
+        QHash<QString, QStringList> & linkedNotebookGuidsByShardId);
+
+    void setNewTagsToLinkedNotebooksInRemoteStorage(
+        const QSet<QString> & linkedNotebookGuids);
+
+    void setTagsTreeToRemoteStorage(
+        QStringList & rootTagGuids, QStringList & childTagGuids);
+
+    void setNewTagsTreeLevelsToRemoteStorage(
+        const QStringList & rootTagGuids, const QStringList & childTagGuids);
+
     void setNewUserOwnResourcesInExistingNotesToRemoteStorage();
     void setNewResourcesInExistingNotesFromLinkedNotebooksToRemoteStorage();
     void setModifiedUserOwnItemsToRemoteStorage();
@@ -286,7 +320,11 @@ private:
 
     void copyRemoteItemsToLocalStorage();
 
+    void setSyncProgressCheckpointInterval(const qint64 intervalMsec);
+    void recreateSynchronizationManager();
+
     void setRemoteStorageSyncStateToPersistentSyncSettings();
+    void setCurrentSyncStatesToRemoteStorage();
 
     void checkProgressNotificationsOrder(
         const SynchronizationManagerSignalsCatcher & catcher);
@@ -303,6 +341,17 @@ private:
     void checkLinkedNotebookSyncChunksDataProcessingProgressOrder(
         const SynchronizationManagerSignalsCatcher & catcher);
 
+    void checkParentTagsStoredBeforeChildTags(
+        const QStringList & storedTagGuids);
+
+    void checkLinkedNotebookSyncStatesCheckProgress(
+        const SynchronizationManagerSignalsCatcher & catcher,
+        const QSet<QString> & updatedLinkedNotebookGuids);
+
+    void checkFindRequestsSkippedForUpToDateItems(
+        const QStringList & remoteGuids, const QStringList & modifiedLocalGuids,
+        const QSet<QString> & foundGuids);
+
     void checkIdentityOfLocalAndRemoteItems();
     void checkPersistentSyncState();
     void checkExpectedNamesOfConflictingItemsAfterSync();
@@ -371,6 +420,10 @@ private:
 
     void runTest(SynchronizationManagerSignalsCatcher & catcher);
 
+    void runUpdatesCheck(
+        bool & success, bool & updatesAvailable,
+        ErrorString & errorDescription);
+
 private:
     Account m_testAccount;
     LocalStorageManagerAsync * m_pLocalStorageManagerAsync = nullptr;
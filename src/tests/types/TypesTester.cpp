@@ -25,8 +25,10 @@
 #include <quentier/types/RegisterMetatypes.h>
 #include <quentier/types/Resource.h>
 #include <quentier/utility/SysInfo.h>
+#include <quentier/utility/UidGenerator.h>
 
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QTextStream>
 #include <QtTest/QTest>
 
@@ -161,6 +163,119 @@ void TypesTester::noteContainsEncryptionTest()
     CATCH_EXCEPTION();
 }
 
+void TypesTester::noteResourcesLookupTest()
+{
+    try {
+        Note note;
+
+        QList<Resource> resources;
+        for (int i = 0; i < 5; ++i) {
+            Resource resource;
+            resource.setGuid(UidGenerator::Generate());
+            resource.setDataBody(QByteArray::number(i));
+            resource.setDataHash(QCryptographicHash::hash(
+                resource.dataBody(), QCryptographicHash::Md5));
+            resource.setMime(QStringLiteral("application/octet-stream"));
+            resources << resource;
+        }
+
+        note.setResources(resources);
+
+        for (int i = 0, size = resources.size(); i < size; ++i) {
+            const Resource & resource = qAsConst(resources)[i];
+
+            QVERIFY2(
+                note.resourceIndexByLocalUid(resource.localUid()) == i,
+                "Wrong resource index found by local uid");
+
+            QVERIFY2(
+                note.resourceIndexByGuid(resource.guid()) == i,
+                "Wrong resource index found by guid");
+
+            QVERIFY2(
+                note.resourceIndexByDataHash(resource.dataHash()) == i,
+                "Wrong resource index found by data hash");
+
+            QVERIFY2(
+                note.resourceLocalUidAt(i) == resource.localUid(),
+                "Wrong resource local uid at index");
+
+            Resource resourceAtIndex = note.resourceAt(i);
+            QVERIFY2(
+                resourceAtIndex.noteLocalUid() == note.localUid(),
+                "Wrong note local uid of resource at index");
+
+            QVERIFY2(
+                resourceAtIndex.indexInNote() == i,
+                "Wrong index in note of resource at index");
+
+            resourceAtIndex.setNoteLocalUid(resource.noteLocalUid());
+            resourceAtIndex.setIndexInNote(resource.indexInNote());
+            QVERIFY2(
+                resourceAtIndex == resource, "Wrong resource at index");
+        }
+
+        QVERIFY2(
+            note.resourceIndexByLocalUid(UidGenerator::Generate()) < 0,
+            "Found the index of resource not belonging to the note");
+
+        // Removal shifts indices of subsequent resources
+        QVERIFY2(
+            note.removeResource(resources[1]), "Failed to remove resource");
+
+        QVERIFY2(
+            note.resourceIndexByLocalUid(resources[1].localUid()) < 0,
+            "Found the index of removed resource");
+
+        QVERIFY2(
+            note.resourceIndexByGuid(resources[1].guid()) < 0,
+            "Found the index of removed resource by guid");
+
+        QVERIFY2(
+            note.resourceIndexByLocalUid(resources[4].localUid()) == 3,
+            "Wrong resource index after the removal of another resource");
+
+        QVERIFY2(
+            note.resourceIndexByGuid(resources[4].guid()) == 3,
+            "Wrong resource index by guid after the removal of another "
+            "resource");
+
+        // Update changing the guid
+        Resource updatedResource = resources[2];
+        updatedResource.setGuid(UidGenerator::Generate());
+        QVERIFY2(
+            note.updateResource(updatedResource), "Failed to update resource");
+
+        QVERIFY2(
+            note.resourceIndexByGuid(resources[2].guid()) < 0,
+            "Found the index of resource by its previous guid");
+
+        QVERIFY2(
+            note.resourceIndexByGuid(updatedResource.guid()) == 1,
+            "Wrong resource index by updated guid");
+
+        // Guid changed through the mutable qevercloud::Note
+        const QString newGuid = UidGenerator::Generate();
+        note.qevercloudNote().resources.ref()[0].guid = newGuid;
+        QVERIFY2(
+            note.resourceIndexByGuid(newGuid) == 0,
+            "Wrong resource index by guid changed through qevercloud::Note");
+
+        Resource newResource;
+        newResource.setGuid(UidGenerator::Generate());
+        note.addResource(newResource);
+
+        QVERIFY2(
+            note.resourceIndexByLocalUid(newResource.localUid()) == 4,
+            "Wrong index of added resource");
+
+        QVERIFY2(
+            note.resourceIndexByGuid(newResource.guid()) == 4,
+            "Wrong index of added resource by guid");
+    }
+    CATCH_EXCEPTION();
+}
+
 void TypesTester::resourceRecognitionIndicesParsingTest()
 {
     try {
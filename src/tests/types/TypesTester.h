@@ -36,6 +36,7 @@ private Q_SLOTS:
 
     void noteContainsToDoTest();
     void noteContainsEncryptionTest();
+    void noteResourcesLookupTest();
     void resourceRecognitionIndicesParsingTest();
 };
 
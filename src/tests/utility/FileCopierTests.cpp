@@ -0,0 +1,198 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FileCopierTests.h"
+
+#include "../../utility/FileCopier_p.h"
+
+#include <quentier/types/ErrorString.h>
+#include <quentier/utility/FileCopier.h>
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <algorithm>
+
+namespace quentier {
+namespace test {
+
+bool testFileCopier(QString & error)
+{
+    QTemporaryDir tmpDir;
+    if (!tmpDir.isValid()) {
+        error = QStringLiteral("Failed to create temporary dir");
+        return false;
+    }
+
+    // Larger than a single chunk copied at once and not a multiple of its size
+    const int size = 20 * 1024 * 1024 + 17;
+
+    QByteArray data;
+    data.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        data.append(static_cast<char>(i % 251));
+    }
+
+    const QString sourcePath = tmpDir.path() + QStringLiteral("/source.dat");
+    const QString destPath = tmpDir.path() + QStringLiteral("/dest.dat");
+
+    {
+        QFile sourceFile(sourcePath);
+        if (!sourceFile.open(QIODevice::WriteOnly) ||
+            (sourceFile.write(data) != data.size()))
+        {
+            error = QStringLiteral("Failed to write the source file");
+            return false;
+        }
+    }
+
+    FileCopier copier;
+
+    bool finished = false;
+    double lastProgress = 0.0;
+    bool progressDecreased = false;
+
+    QObject::connect(
+        &copier, &FileCopier::progressUpdate, &copier,
+        [&](double progress) {
+            if (progress < lastProgress) {
+                progressDecreased = true;
+            }
+            lastProgress = progress;
+        });
+
+    QObject::connect(
+        &copier, &FileCopier::finished, &copier,
+        [&](QString, QString) { finished = true; });
+
+    QObject::connect(
+        &copier, &FileCopier::notifyError, &copier,
+        [&](ErrorString errorDescription) {
+            error = errorDescription.nonLocalizedString();
+        });
+
+    copier.copyFile(sourcePath, destPath);
+
+    if (!error.isEmpty()) {
+        return false;
+    }
+
+    if (!finished) {
+        error = QStringLiteral("File copier has not finished");
+        return false;
+    }
+
+    if (progressDecreased || (lastProgress < 1.0)) {
+        error = QStringLiteral("Unexpected progress of file copying");
+        return false;
+    }
+
+    QFile destFile(destPath);
+    if (!destFile.open(QIODevice::ReadOnly)) {
+        error = QStringLiteral("Failed to open the copied file");
+        return false;
+    }
+
+    if (destFile.readAll() != data) {
+        error = QStringLiteral("Copied file's contents differ from source");
+        return false;
+    }
+
+    return true;
+}
+
+bool createDataFile(const QString & path, const qint64 size, QString & error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = QStringLiteral("Failed to open the data file for writing");
+        return false;
+    }
+
+    // Filling the whole file with pseudo-random data so that it has no holes
+    // and neither the filesystem nor the copying can take shortcuts on it
+    QByteArray chunk(1024 * 1024, '\0');
+    quint32 state = 2463534242U;
+
+    qint64 bytesLeft = size;
+    while (bytesLeft > 0) {
+        auto * pData = reinterpret_cast<quint32 *>(chunk.data());
+        const int wordCount = chunk.size() / static_cast<int>(sizeof(quint32));
+        for (int i = 0; i < wordCount; ++i) {
+            // xorshift32
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            pData[i] = state;
+        }
+
+        const qint64 bytesToWrite =
+            std::min(bytesLeft, static_cast<qint64>(chunk.size()));
+
+        if (file.write(chunk.constData(), bytesToWrite) != bytesToWrite) {
+            error = QStringLiteral("Failed to write the data file");
+            return false;
+        }
+
+        bytesLeft -= bytesToWrite;
+    }
+
+    return true;
+}
+
+bool copyFileWithFileCopierPrivate(
+    const QString & sourcePath, const QString & destPath,
+    const bool kernelCopyEnabled, QString & error)
+{
+    FileCopierPrivate copier;
+    copier.setKernelCopyEnabled(kernelCopyEnabled);
+
+    bool finished = false;
+
+    QObject::connect(
+        &copier, &FileCopierPrivate::finished, &copier,
+        [&](QString, QString) { finished = true; });
+
+    QObject::connect(
+        &copier, &FileCopierPrivate::notifyError, &copier,
+        [&](ErrorString errorDescription) {
+            error = errorDescription.nonLocalizedString();
+        });
+
+    copier.copyFile(sourcePath, destPath);
+
+    if (!error.isEmpty()) {
+        return false;
+    }
+
+    if (!finished) {
+        error = QStringLiteral("File copier has not finished");
+        return false;
+    }
+
+    if (QFileInfo(destPath).size() != QFileInfo(sourcePath).size()) {
+        error = QStringLiteral("Copied file's size differs from source");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace test
+} // namespace quentier
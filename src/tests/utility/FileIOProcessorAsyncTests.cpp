@@ -0,0 +1,155 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FileIOProcessorAsyncTests.h"
+
+#include <quentier/types/ErrorString.h>
+#include <quentier/utility/FileIOProcessorAsync.h>
+
+#include <QEventLoop>
+#include <QHash>
+#include <QTemporaryDir>
+#include <QTimer>
+
+namespace quentier {
+namespace test {
+
+bool testFileIOProcessorAsyncWriteCoalescing(QString & error)
+{
+    QTemporaryDir tmpDir;
+    if (!tmpDir.isValid()) {
+        error = QStringLiteral("Failed to create temporary dir");
+        return false;
+    }
+
+    const QString filePath = tmpDir.path() + QStringLiteral("/data.txt");
+
+    FileIOProcessorAsync processor;
+    processor.setMaxWorkerCount(1);
+
+    QHash<QUuid, bool> writeResults;
+    QUuid readRequestId = QUuid::createUuid();
+    QByteArray readData;
+    bool readFinished = false;
+
+    QEventLoop loop;
+
+    QObject::connect(
+        &processor, &FileIOProcessorAsync::writeFileRequestProcessed, &loop,
+        [&](bool success, ErrorString errorDescription, QUuid requestId) {
+            if (!success) {
+                error = errorDescription.nonLocalizedString();
+            }
+            writeResults[requestId] = success;
+        });
+
+    QObject::connect(
+        &processor, &FileIOProcessorAsync::readFileRequestProcessed, &loop,
+        [&](bool success, ErrorString errorDescription, QByteArray data,
+            QUuid requestId) {
+            if (requestId != readRequestId) {
+                return;
+            }
+
+            if (!success) {
+                error = errorDescription.nonLocalizedString();
+            }
+
+            readData = data;
+            readFinished = true;
+            loop.quit();
+        });
+
+    QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+
+    // The first write is started right away, the rest of writes are pending
+    // while it is in progress and thus should be coalesced into a single one
+    const QUuid firstWriteRequestId = QUuid::createUuid();
+    processor.onWriteFileRequest(
+        filePath, QByteArray("first"), firstWriteRequestId,
+        /* append = */ false);
+
+    const QUuid secondWriteRequestId = QUuid::createUuid();
+    processor.onPrioritizedWriteFileRequest(
+        filePath, QByteArray("second"), secondWriteRequestId,
+        /* append = */ false, FileIOProcessorAsync::Priority::Background);
+
+    const QUuid thirdWriteRequestId = QUuid::createUuid();
+    processor.onPrioritizedWriteFileRequest(
+        filePath, QByteArray("+third"), thirdWriteRequestId,
+        /* append = */ true, FileIOProcessorAsync::Priority::Interactive);
+
+    // The read must not overtake the writes to the same file
+    processor.onPrioritizedReadFileRequest(
+        filePath, readRequestId, FileIOProcessorAsync::Priority::Interactive);
+
+    Q_UNUSED(loop.exec())
+
+    if (!error.isEmpty()) {
+        return false;
+    }
+
+    if (!readFinished) {
+        error = QStringLiteral("Read request was not processed in time");
+        return false;
+    }
+
+    if ((writeResults.size() != 3) ||
+        !writeResults.value(firstWriteRequestId, false) ||
+        !writeResults.value(secondWriteRequestId, false) ||
+        !writeResults.value(thirdWriteRequestId, false))
+    {
+        error = QStringLiteral(
+            "Not all write requests were successfully processed before "
+            "the read request");
+        return false;
+    }
+
+    if (readData != QByteArray("second+third")) {
+        error = QStringLiteral("Unexpected file contents: ") +
+            QString::fromUtf8(readData);
+        return false;
+    }
+
+    const auto metrics = processor.metrics();
+    if (metrics.m_numCoalescedWriteRequests != 1) {
+        error = QStringLiteral("Unexpected number of coalesced writes: ") +
+            QString::number(metrics.m_numCoalescedWriteRequests);
+        return false;
+    }
+
+    if (metrics.m_numProcessedRequests != 4) {
+        error = QStringLiteral("Unexpected number of processed requests: ") +
+            QString::number(metrics.m_numProcessedRequests);
+        return false;
+    }
+
+    if ((metrics.m_numPendingBackgroundRequests != 0) ||
+        (metrics.m_numPendingNormalRequests != 0) ||
+        (metrics.m_numPendingInteractiveRequests != 0) ||
+        (metrics.m_numRequestsInProgress != 0))
+    {
+        error = QStringLiteral("Unexpected non-zero pending requests count");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace test
+} // namespace quentier
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2020 Dmitry Ivanov
+ *
+ * This file is part of libquentier
+ *
+ * libquentier is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, version 3 of the License.
+ *
+ * libquentier is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libquentier. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FileSystemTests.h"
+
+#include <quentier/types/ErrorString.h>
+#include <quentier/utility/FileSystem.h>
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QTemporaryDir>
+
+namespace quentier {
+namespace test {
+
+namespace {
+
+// Larger than a single I/O chunk and not a multiple of its size
+QByteArray composeTestData()
+{
+    const int size = 3 * 1024 * 1024 + 17;
+
+    QByteArray data;
+    data.reserve(size);
+    for (int i = 0; i < size; ++i) {
+        data.append(static_cast<char>(i % 251));
+    }
+
+    return data;
+}
+
+} // namespace
+
+bool testFileContentsReadAndWriteWithHash(QString & error)
+{
+    QTemporaryDir tmpDir;
+    if (!tmpDir.isValid()) {
+        error = QStringLiteral("Failed to create temporary dir");
+        return false;
+    }
+
+    const QByteArray data = composeTestData();
+    const QByteArray expectedHash =
+        QCryptographicHash::hash(data, QCryptographicHash::Md5);
+
+    const QString filePath = tmpDir.path() + QStringLiteral("/data.dat");
+
+    QByteArray writtenDataHash;
+    double lastProgress = 0.0;
+    ErrorString errorDescription;
+
+    bool res = writeFileContentsWithHash(
+        filePath, data, writtenDataHash, errorDescription,
+        [&lastProgress](double progress) { lastProgress = progress; });
+
+    if (!res) {
+        error = errorDescription.nonLocalizedString();
+        return false;
+    }
+
+    if (writtenDataHash != expectedHash) {
+        error = QStringLiteral("Wrong hash of the written data");
+        return false;
+    }
+
+    if (lastProgress != 1.0) {
+        error = QStringLiteral("The final write progress is not 1");
+        return false;
+    }
+
+    // The passed in non-empty hash is kept intact
+    QByteArray knownDataHash = QByteArrayLiteral("known");
+    res = writeFileContentsWithHash(
+        filePath, data, knownDataHash, errorDescription);
+
+    if (!res || (knownDataHash != QByteArrayLiteral("known"))) {
+        error = QStringLiteral("Passed in data hash was modified");
+        return false;
+    }
+
+    QByteArray readDataHash;
+    QByteArray readData =
+        readFileContentsWithHash(filePath, readDataHash, errorDescription);
+
+    if (!errorDescription.isEmpty()) {
+        error = errorDescription.nonLocalizedString();
+        return false;
+    }
+
+    if (readData != data) {
+        error = QStringLiteral("Read data doesn't match the written one");
+        return false;
+    }
+
+    if (readDataHash != expectedHash) {
+        error = QStringLiteral("Wrong hash of the read data");
+        return false;
+    }
+
+    QByteArray fileHash;
+    if (!calculateFileHash(filePath, fileHash, errorDescription)) {
+        error = errorDescription.nonLocalizedString();
+        return false;
+    }
+
+    if (fileHash != expectedHash) {
+        error = QStringLiteral("Wrong hash of the file");
+        return false;
+    }
+
+    return true;
+}
+
+bool testDataCopyWithHash(QString & error)
+{
+    QByteArray sourceData = composeTestData();
+    QBuffer source(&sourceData);
+    if (!source.open(QIODevice::ReadOnly)) {
+        error = QStringLiteral("Failed to open the source buffer");
+        return false;
+    }
+
+    QByteArray destinationData;
+    QBuffer destination(&destinationData);
+    if (!destination.open(QIODevice::WriteOnly)) {
+        error = QStringLiteral("Failed to open the destination buffer");
+        return false;
+    }
+
+    QByteArray dataHash;
+    ErrorString errorDescription;
+    if (!copyDataWithHash(source, destination, dataHash, errorDescription)) {
+        error = errorDescription.nonLocalizedString();
+        return false;
+    }
+
+    if (destinationData != sourceData) {
+        error = QStringLiteral("Copied data doesn't match the source one");
+        return false;
+    }
+
+    if (dataHash !=
+        QCryptographicHash::hash(sourceData, QCryptographicHash::Md5))
+    {
+        error = QStringLiteral("Wrong hash of the copied data");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace test
+} // namespace quentier
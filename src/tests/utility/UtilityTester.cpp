@@ -19,6 +19,9 @@
 #include "UtilityTester.h"
 
 #include "EncryptionManagerTests.h"
+#include "FileCopierTests.h"
+#include "FileIOProcessorAsyncTests.h"
+#include "FileSystemTests.h"
 #include "LRUCacheTests.h"
 #include "TagSortByParentChildRelationsTest.h"
 
@@ -38,6 +41,7 @@
 #include <quentier/utility/SysInfo.h>
 
 #include <QApplication>
+#include <QTemporaryDir>
 #include <QTextStream>
 #include <QTimer>
 #include <QtTest/QTest>
@@ -63,6 +67,16 @@ void UtilityTester::init()
     qInstallMessageHandler(messageHandler);
 }
 
+// File copier benchmarks need several GB of disk space so they only run if
+// this environment variable is set
+#define FILE_COPIER_BENCHMARK_ENV_VAR "LIBQUENTIER_FILE_COPIER_BENCHMARK"
+
+// Overrides the size of the file copied in benchmarks, in megabytes
+#define FILE_COPIER_BENCHMARK_FILE_SIZE_MB_ENV_VAR                             \
+    "LIBQUENTIER_FILE_COPIER_BENCHMARK_FILE_SIZE_MB"
+
+#define FILE_COPIER_BENCHMARK_DEFAULT_FILE_SIZE_MB (2048)
+
 #define CATCH_EXCEPTION()                                                      \
     catch (const std::exception & exception) {                                 \
         SysInfo sysInfo;                                                       \
@@ -142,6 +156,104 @@ void UtilityTester::lruCacheTests()
     CATCH_EXCEPTION();
 }
 
+void UtilityTester::fileContentsReadAndWriteWithHashTest()
+{
+    try {
+        QString error;
+        bool res = testFileContentsReadAndWriteWithHash(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void UtilityTester::dataCopyWithHashTest()
+{
+    try {
+        QString error;
+        bool res = testDataCopyWithHash(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void UtilityTester::fileIOProcessorAsyncWriteCoalescingTest()
+{
+    try {
+        QString error;
+        bool res = testFileIOProcessorAsyncWriteCoalescing(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void UtilityTester::fileCopierTest()
+{
+    try {
+        QString error;
+        bool res = testFileCopier(error);
+        QVERIFY2(res, qPrintable(error));
+    }
+    CATCH_EXCEPTION();
+}
+
+void UtilityTester::benchmarkFileCopierKernelCopy()
+{
+    try {
+        benchmarkFileCopier(/* kernel copy enabled = */ true);
+    }
+    CATCH_EXCEPTION();
+}
+
+void UtilityTester::benchmarkFileCopierUserSpaceCopy()
+{
+    try {
+        benchmarkFileCopier(/* kernel copy enabled = */ false);
+    }
+    CATCH_EXCEPTION();
+}
+
+void UtilityTester::benchmarkFileCopier(const bool kernelCopyEnabled)
+{
+    if (!qEnvironmentVariableIsSet(FILE_COPIER_BENCHMARK_ENV_VAR)) {
+        QSKIP(
+            "Set " FILE_COPIER_BENCHMARK_ENV_VAR
+            " environment variable to run file copier benchmarks");
+    }
+
+    qint64 fileSizeMb = FILE_COPIER_BENCHMARK_DEFAULT_FILE_SIZE_MB;
+    if (qEnvironmentVariableIsSet(FILE_COPIER_BENCHMARK_FILE_SIZE_MB_ENV_VAR)) {
+        bool conversionResult = false;
+        int value = qEnvironmentVariableIntValue(
+            FILE_COPIER_BENCHMARK_FILE_SIZE_MB_ENV_VAR, &conversionResult);
+
+        QVERIFY2(
+            conversionResult && (value > 0),
+            "Invalid value of " FILE_COPIER_BENCHMARK_FILE_SIZE_MB_ENV_VAR
+            " environment variable");
+
+        fileSizeMb = value;
+    }
+
+    QTemporaryDir tmpDir;
+    QVERIFY2(tmpDir.isValid(), "Failed to create temporary dir");
+
+    const QString sourcePath = tmpDir.path() + QStringLiteral("/source.dat");
+    const QString destPath = tmpDir.path() + QStringLiteral("/dest.dat");
+
+    QString error;
+    bool res = createDataFile(sourcePath, fileSizeMb * 1024 * 1024, error);
+
+    QVERIFY2(res, qPrintable(error));
+
+    QBENCHMARK
+    {
+        res = copyFileWithFileCopierPrivate(
+            sourcePath, destPath, kernelCopyEnabled, error);
+    }
+
+    QVERIFY2(res, qPrintable(error));
+}
+
 #undef CATCH_EXCEPTION
 
 } // namespace test
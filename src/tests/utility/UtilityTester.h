@@ -42,6 +42,18 @@ private Q_SLOTS:
 
     void lruCacheTests();
 
+    void fileContentsReadAndWriteWithHashTest();
+    void dataCopyWithHashTest();
+
+    void fileIOProcessorAsyncWriteCoalescingTest();
+
+    void fileCopierTest();
+    void benchmarkFileCopierKernelCopy();
+    void benchmarkFileCopierUserSpaceCopy();
+
+private:
+    void benchmarkFileCopier(const bool kernelCopyEnabled);
+
 private:
     Q_DISABLE_COPY(UtilityTester)
 };
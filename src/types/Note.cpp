@@ -100,6 +100,8 @@ const qevercloud::Note & Note::qevercloudNote() const
 
 qevercloud::Note & Note::qevercloudNote()
 {
+    // Resources might be modified through the returned reference
+    d->m_resourceGuidIndexValid = false;
     return d->m_qecNote;
 }
 
@@ -547,32 +549,12 @@ QList<Resource> Note::resources() const
 {
     QList<Resource> resources;
 
-    if (!d->m_qecNote.resources.isSet()) {
-        return resources;
-    }
-
-    QString noteLocalUid = localUid();
-
-    const auto & noteResources = d->m_qecNote.resources.ref();
-    int numResources = noteResources.size();
-    int numResourceAdditionalInfoEntries = d->m_resourcesAdditionalInfo.size();
-
-    resources.reserve(qMax(numResources, 0));
+    const int numResources = this->numResources();
+    resources.reserve(numResources);
     for (int i = 0; i < numResources; ++i) {
-        resources << Resource(noteResources[i]);
-        Resource & resource = resources.back();
-
-        if (i < numResourceAdditionalInfoEntries) {
-            const NoteData::ResourceAdditionalInfo & info =
-                d->m_resourcesAdditionalInfo[i];
-
-            resource.setLocalUid(info.localUid);
-            resource.setNoteLocalUid(noteLocalUid);
-            resource.setDirty(info.isDirty);
-        }
-
-        resource.setIndexInNote(i);
+        resources << resourceAt(i);
     }
+
     return resources;
 }
 
@@ -582,6 +564,7 @@ void Note::setResources(const QList<Resource> & resources)
     d->m_resourcesAdditionalInfo.clear();
 
     if (resources.isEmpty()) {
+        d->rebuildResourceIndices();
         return;
     }
 
@@ -596,6 +579,8 @@ void Note::setResources(const QList<Resource> & resources)
         info.isDirty = resource.isDirty();
         d->m_resourcesAdditionalInfo.push_back(info);
     }
+
+    d->rebuildResourceIndices();
 }
 
 void Note::addResource(const Resource & resource)
@@ -613,12 +598,25 @@ void Note::addResource(const Resource & resource)
         return;
     }
 
+    const int index = d->m_qecNote.resources->size();
     d->m_qecNote.resources.ref() << resource.qevercloudResource();
     NoteData::ResourceAdditionalInfo info;
     info.localUid = resource.localUid();
     info.isDirty = resource.isDirty();
     d->m_resourcesAdditionalInfo.push_back(info);
 
+    if (d->m_resourceGuidIndexValid &&
+        (d->m_resourcesAdditionalInfo.size() == (index + 1)))
+    {
+        d->m_resourceIndexByLocalUid[info.localUid] = index;
+        if (resource.hasGuid()) {
+            d->m_resourceIndexByGuid[resource.guid()] = index;
+        }
+    }
+    else {
+        d->rebuildResourceIndices();
+    }
+
     QNDEBUG(
         "types:note",
         "Added resource " << resource.localUid() << " to note "
@@ -636,14 +634,8 @@ bool Note::updateResource(const Resource & resource)
         return false;
     }
 
-    int targetResourceIndex = -1;
-    const int numResources = d->m_resourcesAdditionalInfo.size();
-    for (int i = 0; i < numResources; ++i) {
-        if (d->m_resourcesAdditionalInfo[i].localUid == resource.localUid()) {
-            targetResourceIndex = i;
-            break;
-        }
-    }
+    const int targetResourceIndex =
+        d->resourceIndexByLocalUid(resource.localUid());
 
     if (targetResourceIndex < 0) {
         QNDEBUG(
@@ -654,8 +646,24 @@ bool Note::updateResource(const Resource & resource)
         return false;
     }
 
-    d->m_qecNote.resources.ref()[targetResourceIndex] =
-        resource.qevercloudResource();
+    auto & targetResource = d->m_qecNote.resources.ref()[targetResourceIndex];
+    if (d->m_resourceGuidIndexValid && targetResource.guid.isSet()) {
+        auto it = d->m_resourceIndexByGuid.find(targetResource.guid.ref());
+        if ((it != d->m_resourceIndexByGuid.end()) &&
+            (it.value() == targetResourceIndex))
+        {
+            Q_UNUSED(d->m_resourceIndexByGuid.erase(it))
+        }
+    }
+
+    targetResource = resource.qevercloudResource();
+
+    if (!d->m_resourceGuidIndexValid) {
+        d->rebuildResourceIndices();
+    }
+    else if (resource.hasGuid()) {
+        d->m_resourceIndexByGuid[resource.guid()] = targetResourceIndex;
+    }
 
     d->m_resourcesAdditionalInfo[targetResourceIndex].isDirty =
         resource.isDirty();
@@ -674,16 +682,8 @@ bool Note::removeResource(const Resource & resource)
         return false;
     }
 
-    auto & resources = d->m_qecNote.resources.ref();
-    const int numResources = resources.size();
-
-    int targetResourceIndex = -1;
-    for (int i = 0; i < numResources; ++i) {
-        if (d->m_resourcesAdditionalInfo[i].localUid == resource.localUid()) {
-            targetResourceIndex = i;
-            break;
-        }
-    }
+    const int targetResourceIndex =
+        d->resourceIndexByLocalUid(resource.localUid());
 
     if (targetResourceIndex < 0) {
         QNDEBUG(
@@ -694,13 +694,78 @@ bool Note::removeResource(const Resource & resource)
         return false;
     }
 
-    resources.removeAt(targetResourceIndex);
+    d->m_qecNote.resources.ref().removeAt(targetResourceIndex);
     d->m_resourcesAdditionalInfo.removeAt(targetResourceIndex);
 
+    // Indices of all subsequent resources have shifted
+    d->rebuildResourceIndices();
+
     QNDEBUG("types:note", "Removed resource from note: " << resource);
     return true;
 }
 
+int Note::resourceIndexByLocalUid(const QString & resourceLocalUid) const
+{
+    return d->resourceIndexByLocalUid(resourceLocalUid);
+}
+
+int Note::resourceIndexByGuid(const QString & resourceGuid) const
+{
+    return d->resourceIndexByGuid(resourceGuid);
+}
+
+int Note::resourceIndexByDataHash(const QByteArray & dataHash) const
+{
+    if (!d->m_qecNote.resources.isSet()) {
+        return -1;
+    }
+
+    const auto & resources = d->m_qecNote.resources.ref();
+    const int numResources = resources.size();
+    for (int i = 0; i < numResources; ++i) {
+        const auto & resource = resources[i];
+        if (resource.data.isSet() && resource.data->bodyHash.isSet() &&
+            (resource.data->bodyHash.ref() == dataHash))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+Resource Note::resourceAt(const int index) const
+{
+    Resource resource(qevercloudResourceAt(index));
+
+    if (index < d->m_resourcesAdditionalInfo.size()) {
+        const NoteData::ResourceAdditionalInfo & info =
+            d->m_resourcesAdditionalInfo[index];
+
+        resource.setLocalUid(info.localUid);
+        resource.setNoteLocalUid(localUid());
+        resource.setDirty(info.isDirty);
+    }
+
+    resource.setIndexInNote(index);
+    return resource;
+}
+
+const qevercloud::Resource & Note::qevercloudResourceAt(const int index) const
+{
+    Q_ASSERT(d->m_qecNote.resources.isSet());
+    return d->m_qecNote.resources->at(index);
+}
+
+QString Note::resourceLocalUidAt(const int index) const
+{
+    if ((index < 0) || (index >= d->m_resourcesAdditionalInfo.size())) {
+        return {};
+    }
+
+    return d->m_resourcesAdditionalInfo[index].localUid;
+}
+
 bool Note::hasNoteAttributes() const
 {
     return d->m_qecNote.attributes.isSet();
@@ -22,6 +22,7 @@
 #include <quentier/local_storage/NoteSearchQuery.h>
 #include <quentier/synchronization/ForwardDeclarations.h>
 #include <quentier/synchronization/ISyncChunksDataCounters.h>
+#include <quentier/synchronization/ISyncMetrics.h>
 #include <quentier/synchronization/ISyncStateStorage.h>
 #include <quentier/types/Account.h>
 #include <quentier/types/ErrorString.h>
@@ -34,6 +35,7 @@
 #include <quentier/types/SharedNotebook.h>
 #include <quentier/types/Tag.h>
 #include <quentier/types/User.h>
+#include <quentier/utility/FileIOProcessorAsync.h>
 #include <quentier/utility/IKeychainService.h>
 
 #include <QList>
@@ -62,6 +64,8 @@ void registerMetatypes()
     qRegisterMetaType<qevercloud::Tag>("qevercloud::Tag");
     qRegisterMetaType<qevercloud::Notebook>("qevercloud::Notebook");
     qRegisterMetaType<qevercloud::Resource>("qevercloud::Resource");
+    qRegisterMetaType<qevercloud::SyncState>("qevercloud::SyncState");
+    qRegisterMetaType<qevercloud::SyncChunk>("qevercloud::SyncChunk");
 
     qRegisterMetaType<QVector<LinkedNotebookAuthData>>(
         "QVector<LinkedNotebookAuthData>");
@@ -112,6 +116,9 @@ void registerMetatypes()
     qRegisterMetaType<LocalStorageManager::NoteCountOptions>(
         "LocalStorageManager::NoteCountOptions");
 
+    qRegisterMetaType<LocalStorageManager::GuidIndex>(
+        "LocalStorageManager::GuidIndex");
+
     qRegisterMetaType<size_t>("size_t");
     qRegisterMetaType<QUuid>("QUuid");
 
@@ -128,6 +135,7 @@ void registerMetatypes()
 
     qRegisterMetaType<QHash<QString, qint32>>("QHash<QString,qint32>");
     qRegisterMetaType<QHash<QString, int>>("QHash<QString,int>");
+    qRegisterMetaType<QHash<QString, Tag>>("QHash<QString,Tag>");
 
     qRegisterMetaType<NoteSearchQuery>("NoteSearchQuery");
 
@@ -146,12 +154,16 @@ void registerMetatypes()
     qRegisterMetaType<IKeychainService::ErrorCode>(
         "IKeychainService::ErrorCode");
 
+    qRegisterMetaType<FileIOProcessorAsync::Priority>(
+        "FileIOProcessorAsync::Priority");
+
     qRegisterMetaType<QList<QNetworkCookie>>("QList<QNeworkCookie>");
 
     using ISyncStatePtr = ISyncStateStorage::ISyncStatePtr;
     qRegisterMetaType<ISyncStatePtr>("ISyncStatePtr");
 
     qRegisterMetaType<ISyncChunksDataCountersPtr>("ISyncChunksDataCountersPtr");
+    qRegisterMetaType<ISyncMetricsPtr>("ISyncMetricsPtr");
 }
 
 } // namespace quentier
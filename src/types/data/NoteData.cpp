@@ -71,6 +71,8 @@ NoteData::NoteData(const qevercloud::Note & other) :
         }
     }
 
+    rebuildResourceIndices();
+
     if (!m_qecNote.sharedNotes.isSet()) {
         m_qecNote.sharedNotes = QList<qevercloud::SharedNote>();
     }
@@ -145,12 +147,81 @@ void NoteData::setContent(const QString & content)
     }
 }
 
+void NoteData::rebuildResourceIndices()
+{
+    m_resourceIndexByLocalUid.clear();
+    m_resourceIndexByGuid.clear();
+    m_resourceGuidIndexValid = true;
+
+    const int numResourceAdditionalInfoEntries =
+        m_resourcesAdditionalInfo.size();
+
+    m_resourceIndexByLocalUid.reserve(numResourceAdditionalInfoEntries);
+    for (int i = 0; i < numResourceAdditionalInfoEntries; ++i) {
+        m_resourceIndexByLocalUid[m_resourcesAdditionalInfo[i].localUid] = i;
+    }
+
+    if (!m_qecNote.resources.isSet()) {
+        return;
+    }
+
+    const auto & resources = m_qecNote.resources.ref();
+    const int numResources = resources.size();
+    m_resourceIndexByGuid.reserve(numResources);
+    for (int i = 0; i < numResources; ++i) {
+        const auto & resource = resources[i];
+        if (resource.guid.isSet()) {
+            m_resourceIndexByGuid[resource.guid.ref()] = i;
+        }
+    }
+}
+
+int NoteData::resourceIndexByLocalUid(const QString & localUid) const
+{
+    auto it = m_resourceIndexByLocalUid.constFind(localUid);
+    if (it == m_resourceIndexByLocalUid.constEnd()) {
+        return -1;
+    }
+
+    return it.value();
+}
+
+int NoteData::resourceIndexByGuid(const QString & guid) const
+{
+    if (!m_qecNote.resources.isSet()) {
+        return -1;
+    }
+
+    if (m_resourceGuidIndexValid) {
+        auto it = m_resourceIndexByGuid.constFind(guid);
+        if (it == m_resourceIndexByGuid.constEnd()) {
+            return -1;
+        }
+
+        return it.value();
+    }
+
+    const auto & resources = m_qecNote.resources.ref();
+    const int numResources = resources.size();
+    for (int i = 0; i < numResources; ++i) {
+        const auto & resource = resources[i];
+        if (resource.guid.isSet() && (resource.guid.ref() == guid)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
 void NoteData::clear()
 {
     m_qecNote = qevercloud::Note();
     initListFields(m_qecNote);
 
     m_resourcesAdditionalInfo.clear();
+    m_resourceIndexByLocalUid.clear();
+    m_resourceIndexByGuid.clear();
+    m_resourceGuidIndexValid = true;
     m_notebookLocalUid.clear();
     m_tagLocalUids.clear();
     m_thumbnailData.clear();
@@ -26,6 +26,7 @@
 #include <qt5qevercloud/QEverCloud.h>
 
 #include <QByteArray>
+#include <QHash>
 
 namespace quentier {
 
@@ -58,6 +59,14 @@ public:
 
     void setContent(const QString & content);
 
+    // Resource indices are rebuilt by methods of Note modifying the list
+    // of resources; resource guids can also be changed through the mutable
+    // qevercloud::Note so the index by guid is only trusted while
+    // m_resourceGuidIndexValid is true, otherwise guids are scanned linearly
+    void rebuildResourceIndices();
+    int resourceIndexByLocalUid(const QString & localUid) const;
+    int resourceIndexByGuid(const QString & guid) const;
+
 public:
     struct Q_DECL_HIDDEN ResourceAdditionalInfo
     {
@@ -73,6 +82,10 @@ public:
     qevercloud::Optional<QString> m_notebookLocalUid;
     QStringList m_tagLocalUids;
     QByteArray m_thumbnailData;
+
+    QHash<QString, int> m_resourceIndexByLocalUid;
+    QHash<QString, int> m_resourceIndexByGuid;
+    bool m_resourceGuidIndexValid = true;
 };
 
 } // namespace quentier
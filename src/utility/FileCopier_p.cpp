@@ -27,6 +27,19 @@
 
 #include <algorithm>
 
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+// Max number of bytes copied within the kernel at once: the copying is
+// interrupted after each chunk to report progress and to check for cancellation
+#define FILE_COPIER_KERNEL_COPY_CHUNK_SIZE (16 * 1024 * 1024) // 16 Mb in bytes
+
 namespace quentier {
 
 FileCopierPrivate::FileCopierPrivate(QObject * parent) : QObject(parent) {}
@@ -88,13 +101,53 @@ void FileCopierPrivate::copyFile(
         return;
     }
 
+    qint64 totalBytesWritten = 0;
+
+    auto status = KernelCopyStatus::Unsupported;
+    if (m_kernelCopyEnabled) {
+        status = copyFileWithinKernel(fromFile, toFile, totalBytesWritten);
+    }
+
+    if (status == KernelCopyStatus::Finished) {
+        QNDEBUG(
+            "utility:file_copier",
+            "File copying within the kernel is complete: source path = "
+                << sourcePath << ", dest path = " << destPath);
+
+        clear();
+        Q_EMIT finished(sourcePath, destPath);
+        return;
+    }
+
+    if (status == KernelCopyStatus::Cancelled) {
+        clear();
+        Q_EMIT cancelled(sourcePath, destPath);
+        return;
+    }
+
+    if (totalBytesWritten > 0) {
+        // Continue copying from where the kernel copy has stopped
+        if (Q_UNLIKELY(
+                !fromFile.seek(totalBytesWritten) ||
+                !toFile.seek(totalBytesWritten)))
+        {
+            ErrorString error(
+                QT_TR_NOOP("Can't copy file, failed to seek "
+                           "within the source or destination file"));
+
+            error.details() = QDir::toNativeSeparators(sourcePath);
+            clear();
+
+            Q_EMIT notifyError(error);
+            return;
+        }
+    }
+
     int bufLen = 4194304; // 4 Mb in bytes
     QByteArray buf;
     buf.reserve(bufLen);
 
-    qint64 totalBytesWritten = 0;
-
-    while (true) {
+    while (totalBytesWritten < fromFileSize) {
         // Allow potential pending cancellation to get in
         QCoreApplication::processEvents();
 
@@ -147,10 +200,6 @@ void FileCopierPrivate::copyFile(
                 << sourcePath << ", dest path = " << destPath);
 
         Q_EMIT progressUpdate(m_currentProgress);
-
-        if (totalBytesWritten >= fromFileSize) {
-            break;
-        }
     }
 
     QNDEBUG(
@@ -174,6 +223,99 @@ void FileCopierPrivate::cancel()
     m_cancelled = true;
 }
 
+FileCopierPrivate::KernelCopyStatus FileCopierPrivate::copyFileWithinKernel(
+    QFile & fromFile, QFile & toFile, qint64 & totalBytesWritten)
+{
+#if defined(__linux__)
+    const int fromFd = fromFile.handle();
+    const int toFd = toFile.handle();
+    if (Q_UNLIKELY((fromFd < 0) || (toFd < 0))) {
+        return KernelCopyStatus::Unsupported;
+    }
+
+    const qint64 fromFileSize = fromFile.size();
+
+#if defined(FICLONE)
+    // On filesystems supporting reflinks (btrfs, xfs) the destination file can
+    // share the data extents of the source file, then nothing needs to be
+    // copied at all
+    if (::ioctl(toFd, FICLONE, fromFd) == 0) {
+        QNDEBUG(
+            "utility:file_copier",
+            "Cloned the source file: " << m_sourcePath);
+
+        totalBytesWritten = fromFileSize;
+        m_currentProgress = 1.0;
+        Q_EMIT progressUpdate(m_currentProgress);
+        return KernelCopyStatus::Finished;
+    }
+
+    QNTRACE(
+        "utility:file_copier",
+        "Can't clone the source file, errno = " << errno);
+#endif // FICLONE
+
+#if defined(SYS_copy_file_range)
+    // copy_file_range avoids copying the data into the user space and back;
+    // some filesystems (e.g. NFS, CIFS) can even copy the data server side
+    while (totalBytesWritten < fromFileSize) {
+        // Allow potential pending cancellation to get in
+        QCoreApplication::processEvents();
+
+        if (m_cancelled) {
+            return KernelCopyStatus::Cancelled;
+        }
+
+        const qint64 bytesToCopy = std::min<qint64>(
+            fromFileSize - totalBytesWritten,
+            FILE_COPIER_KERNEL_COPY_CHUNK_SIZE);
+
+        const auto bytesCopied = ::syscall(
+            SYS_copy_file_range, fromFd, nullptr, toFd, nullptr,
+            static_cast<size_t>(bytesToCopy), 0U);
+
+        if (bytesCopied <= 0) {
+            // Not supported by the kernel or by the filesystems (including
+            // the case of copying across filesystems on older kernels) or
+            // the file has been truncated; the regular copying would sort it
+            // out starting from the current offset
+            QNDEBUG(
+                "utility:file_copier",
+                "Copying within the kernel has stopped, falling back to "
+                    << "the regular copying: errno = "
+                    << (bytesCopied < 0 ? errno : 0)
+                    << ", total bytes written = " << totalBytesWritten);
+            return KernelCopyStatus::Unsupported;
+        }
+
+        totalBytesWritten += static_cast<qint64>(bytesCopied);
+
+        m_currentProgress = static_cast<double>(totalBytesWritten) /
+            static_cast<double>(fromFileSize);
+
+        QNTRACE(
+            "utility:file_copier",
+            "File copying within the kernel progress update: progress = "
+                << m_currentProgress << ", total bytes written = "
+                << totalBytesWritten << ", source file size = "
+                << fromFileSize);
+
+        Q_EMIT progressUpdate(m_currentProgress);
+    }
+
+    return KernelCopyStatus::Finished;
+#else
+    return KernelCopyStatus::Unsupported;
+#endif // SYS_copy_file_range
+
+#else
+    Q_UNUSED(fromFile)
+    Q_UNUSED(toFile)
+    Q_UNUSED(totalBytesWritten)
+    return KernelCopyStatus::Unsupported;
+#endif // __linux__
+}
+
 void FileCopierPrivate::clear()
 {
     QNDEBUG("utility:file_copier", "FileCopierPrivate::clear");
@@ -21,6 +21,7 @@
 
 #include <quentier/types/ErrorString.h>
 
+#include <QFile>
 #include <QObject>
 #include <QString>
 
@@ -57,6 +58,16 @@ public:
         return m_currentProgress;
     }
 
+    /**
+     * Enables or disables copying the file within the kernel, it is enabled
+     * by default; when disabled, the data is always copied through the user
+     * space buffer
+     */
+    void setKernelCopyEnabled(const bool enabled)
+    {
+        m_kernelCopyEnabled = enabled;
+    }
+
     void copyFile(const QString & sourcePath, const QString & destPath);
     void cancel();
 
@@ -67,6 +78,23 @@ Q_SIGNALS:
     void notifyError(ErrorString error);
 
 private:
+    enum class KernelCopyStatus
+    {
+        Finished = 0,
+        Cancelled,
+        Unsupported
+    };
+
+    /**
+     * Copies the file without passing its data through the user space if
+     * the platform allows that: clones the file on filesystems supporting
+     * reflinks or copies it using copy_file_range on Linux. If the copying
+     * cannot be completed this way, Unsupported is returned and
+     * totalBytesWritten contains the number of bytes already copied.
+     */
+    KernelCopyStatus copyFileWithinKernel(
+        QFile & fromFile, QFile & toFile, qint64 & totalBytesWritten);
+
     void clear();
 
 private:
@@ -78,6 +106,7 @@ private:
 
     bool m_idle = true;
     bool m_cancelled = false;
+    bool m_kernelCopyEnabled = true;
     double m_currentProgress = 0.0;
 };
 
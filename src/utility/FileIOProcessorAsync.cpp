@@ -36,6 +36,22 @@ FileIOProcessorAsync::FileIOProcessorAsync(QObject * parent) :
     QObject::connect(
         d_ptr, &FileIOProcessorAsyncPrivate::readFileRequestProcessed, this,
         &FileIOProcessorAsync::readFileRequestProcessed);
+
+    QObject::connect(
+        d_ptr, &FileIOProcessorAsyncPrivate::readFileWithHashRequestProcessed,
+        this, &FileIOProcessorAsync::readFileWithHashRequestProcessed);
+}
+
+FileIOProcessorAsync::Metrics FileIOProcessorAsync::metrics() const
+{
+    Q_D(const FileIOProcessorAsync);
+    return d->metrics();
+}
+
+void FileIOProcessorAsync::setMaxWorkerCount(const int maxWorkerCount)
+{
+    Q_D(FileIOProcessorAsync);
+    d->setMaxWorkerCount(maxWorkerCount);
 }
 
 void FileIOProcessorAsync::setIdleTimePeriod(qint32 seconds)
@@ -48,14 +64,92 @@ void FileIOProcessorAsync::onWriteFileRequest(
     QString absoluteFilePath, QByteArray data, QUuid requestId, bool append)
 {
     Q_D(FileIOProcessorAsync);
-    d->onWriteFileRequest(absoluteFilePath, data, requestId, append);
+    d->onWriteFileRequest(
+        absoluteFilePath, data, requestId, append, Priority::Normal);
 }
 
 void FileIOProcessorAsync::onReadFileRequest(
     QString absoluteFilePath, QUuid requestId)
 {
     Q_D(FileIOProcessorAsync);
-    d->onReadFileRequest(absoluteFilePath, requestId);
+    d->onReadFileRequest(
+        absoluteFilePath, requestId, /* with hash = */ false,
+        Priority::Normal);
+}
+
+void FileIOProcessorAsync::onReadFileWithHashRequest(
+    QString absoluteFilePath, QUuid requestId)
+{
+    Q_D(FileIOProcessorAsync);
+    d->onReadFileRequest(
+        absoluteFilePath, requestId, /* with hash = */ true,
+        Priority::Normal);
+}
+
+void FileIOProcessorAsync::onPrioritizedWriteFileRequest(
+    QString absoluteFilePath, QByteArray data, QUuid requestId, bool append,
+    FileIOProcessorAsync::Priority priority)
+{
+    Q_D(FileIOProcessorAsync);
+    d->onWriteFileRequest(absoluteFilePath, data, requestId, append, priority);
+}
+
+void FileIOProcessorAsync::onPrioritizedReadFileRequest(
+    QString absoluteFilePath, QUuid requestId,
+    FileIOProcessorAsync::Priority priority)
+{
+    Q_D(FileIOProcessorAsync);
+    d->onReadFileRequest(
+        absoluteFilePath, requestId, /* with hash = */ false, priority);
+}
+
+void FileIOProcessorAsync::onPrioritizedReadFileWithHashRequest(
+    QString absoluteFilePath, QUuid requestId,
+    FileIOProcessorAsync::Priority priority)
+{
+    Q_D(FileIOProcessorAsync);
+    d->onReadFileRequest(
+        absoluteFilePath, requestId, /* with hash = */ true, priority);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+template <typename T>
+T & printPriority(T & t, const FileIOProcessorAsync::Priority priority)
+{
+    using Priority = FileIOProcessorAsync::Priority;
+
+    switch (priority) {
+    case Priority::Background:
+        t << "Background";
+        break;
+    case Priority::Normal:
+        t << "Normal";
+        break;
+    case Priority::Interactive:
+        t << "Interactive";
+        break;
+    default:
+        t << "Unknown (" << static_cast<qint64>(priority) << ")";
+        break;
+    }
+
+    return t;
+}
+
+} // namespace
+
+QTextStream & operator<<(
+    QTextStream & strm, const FileIOProcessorAsync::Priority priority)
+{
+    return printPriority(strm, priority);
+}
+
+QDebug & operator<<(QDebug & dbg, const FileIOProcessorAsync::Priority priority)
+{
+    return printPriority(dbg, priority);
 }
 
 } // namespace quentier
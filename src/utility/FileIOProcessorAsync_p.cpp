@@ -20,17 +20,34 @@
 
 #include <quentier/logging/QuentierLogger.h>
 #include <quentier/utility/DateTime.h>
+#include <quentier/utility/FileSystem.h>
 
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QMutexLocker>
 #include <QTimerEvent>
 
+#include <algorithm>
+
+#define FILE_IO_PROCESSOR_ASYNC_DEFAULT_MAX_WORKER_COUNT (4)
+
 namespace quentier {
 
 FileIOProcessorAsyncPrivate::FileIOProcessorAsyncPrivate(QObject * parent) :
     QObject(parent)
-{}
+{
+    m_threadPool.setMaxThreadCount(
+        FILE_IO_PROCESSOR_ASYNC_DEFAULT_MAX_WORKER_COUNT);
+
+    m_clock.start();
+}
+
+FileIOProcessorAsyncPrivate::~FileIOProcessorAsyncPrivate()
+{
+    // Let the writes which have already been started complete
+    m_threadPool.waitForDone();
+}
 
 void FileIOProcessorAsyncPrivate::setIdleTimePeriod(const qint32 seconds)
 {
@@ -42,116 +59,283 @@ void FileIOProcessorAsyncPrivate::setIdleTimePeriod(const qint32 seconds)
     m_idleTimePeriodSeconds = seconds;
 }
 
-#define RESTART_TIMER()                                                        \
-    if (m_postOperationTimerId != 0) {                                         \
-        killTimer(m_postOperationTimerId);                                     \
-    }                                                                          \
-    m_postOperationTimerId =                                                   \
-        startTimer(secondsToMilliseconds(m_idleTimePeriodSeconds));            \
-    QNTRACE(                                                                   \
-        "utility:file_async",                                                  \
-        "FileIOProcessorAsyncPrivate: started post "                           \
-            << "operation timer with id " << m_postOperationTimerId)
+void FileIOProcessorAsyncPrivate::setMaxWorkerCount(const int maxWorkerCount)
+{
+    QNDEBUG(
+        "utility:file_async",
+        "FileIOProcessorAsyncPrivate::setMaxWorkerCount: "
+            << maxWorkerCount);
+
+    m_threadPool.setMaxThreadCount(std::max(maxWorkerCount, 1));
+    startPendingTasks();
+}
+
+FileIOProcessorAsync::Metrics FileIOProcessorAsyncPrivate::metrics() const
+{
+    QMutexLocker locker(&m_metricsMutex);
+    return m_metrics;
+}
 
 void FileIOProcessorAsyncPrivate::onWriteFileRequest(
-    QString absoluteFilePath, QByteArray data, QUuid requestId, bool append)
+    QString absoluteFilePath, QByteArray data, QUuid requestId, bool append,
+    Priority priority)
 {
     QNDEBUG(
         "utility:file_async",
         "FileIOProcessorAsyncPrivate::onWriteFileRequest: file path = "
             << absoluteFilePath << ", request id = " << requestId
-            << ", append = " << (append ? "true" : "false"));
+            << ", append = " << (append ? "true" : "false")
+            << ", priority = " << priority);
 
-    QFileInfo fileInfo(absoluteFilePath);
-    QDir folder = fileInfo.absoluteDir();
-    if (!folder.exists()) {
-        bool madeFolder = folder.mkpath(folder.absolutePath());
-        if (!madeFolder) {
-            ErrorString error(
-                QT_TR_NOOP("can't create folder to write file into"));
+    Task task;
+    task.m_type = TaskType::Write;
+    task.m_priority = priority;
+    task.m_absoluteFilePath = std::move(absoluteFilePath);
+    task.m_data = std::move(data);
+    task.m_append = append;
+    task.m_requests << std::make_pair(requestId, m_clock.elapsed());
 
-            error.details() = absoluteFilePath;
-            QNWARNING("utility:file_async", error);
-            Q_EMIT writeFileRequestProcessed(false, error, requestId);
-            RESTART_TIMER();
-            return;
-        }
-    }
+    enqueueTask(std::move(task));
+}
 
-    QFile file(absoluteFilePath);
+void FileIOProcessorAsyncPrivate::onReadFileRequest(
+    QString absoluteFilePath, QUuid requestId, bool withHash,
+    Priority priority)
+{
+    QNDEBUG(
+        "utility:file_async",
+        "FileIOProcessorAsyncPrivate::onReadFileRequest: file path = "
+            << absoluteFilePath << ", request id = " << requestId
+            << ", with hash = " << (withHash ? "true" : "false")
+            << ", priority = " << priority);
 
-    QIODevice::OpenMode mode;
-    if (append) {
-        mode = QIODevice::Append;
-    }
-    else {
-        mode = QIODevice::WriteOnly;
-    }
+    Task task;
+    task.m_type = (withHash ? TaskType::ReadWithHash : TaskType::Read);
+    task.m_priority = priority;
+    task.m_absoluteFilePath = std::move(absoluteFilePath);
+    task.m_requests << std::make_pair(requestId, m_clock.elapsed());
 
-    bool open = file.open(mode);
-    if (Q_UNLIKELY(!open)) {
-        ErrorString error(QT_TR_NOOP("can't open file for writing/appending"));
-        error.details() = absoluteFilePath;
-        QNWARNING("utility:file_async", error);
-        Q_EMIT writeFileRequestProcessed(false, error, requestId);
-        RESTART_TIMER();
-        return;
-    }
+    enqueueTask(std::move(task));
+}
 
-    qint64 writtenBytes = file.write(data);
-    if (Q_UNLIKELY(writtenBytes < data.size())) {
-        ErrorString error(QT_TR_NOOP("can't write the whole data to file"));
-        error.details() = absoluteFilePath;
-        QNWARNING("utility:file_async", error);
-        Q_EMIT writeFileRequestProcessed(false, error, requestId);
-        RESTART_TIMER();
+void FileIOProcessorAsyncPrivate::onTaskFinished(
+    quint64 taskId, bool success, ErrorString errorDescription,
+    QByteArray data, QByteArray dataHash)
+{
+    auto it = m_tasksInProgress.find(taskId);
+    if (Q_UNLIKELY(it == m_tasksInProgress.end())) {
+        QNWARNING(
+            "utility:file_async",
+            "Received finished signal for unknown task: " << taskId);
         return;
     }
 
-    file.close();
+    Task task = std::move(it.value());
+    Q_UNUSED(m_tasksInProgress.erase(it))
+    Q_UNUSED(m_filePathsInProgress.remove(task.m_absoluteFilePath))
 
     QNDEBUG(
-        "utility:file_async", "Successfully wrote file " << absoluteFilePath);
+        "utility:file_async",
+        "FileIOProcessorAsyncPrivate::onTaskFinished: file path = "
+            << task.m_absoluteFilePath << ", success = "
+            << (success ? "true" : "false") << ", number of requests = "
+            << task.m_requests.size());
+
+    if (!success) {
+        QNWARNING(
+            "utility:file_async",
+            errorDescription << ", file path = " << task.m_absoluteFilePath);
+    }
+
+    updateMetricsOnTaskFinished(task);
+
+    // Start the next tasks before sending replies as the receivers may issue
+    // new requests right away
+    startPendingTasks();
+
+    for (const auto & request: qAsConst(task.m_requests)) {
+        const QUuid & requestId = request.first;
+        switch (task.m_type) {
+        case TaskType::Write:
+            Q_EMIT writeFileRequestProcessed(
+                success, errorDescription, requestId);
+            break;
+        case TaskType::Read:
+            Q_EMIT readFileRequestProcessed(
+                success, errorDescription, data, requestId);
+            break;
+        case TaskType::ReadWithHash:
+            Q_EMIT readFileWithHashRequestProcessed(
+                success, errorDescription, data, dataHash, requestId);
+            break;
+        }
+    }
 
-    Q_EMIT writeFileRequestProcessed(true, ErrorString(), requestId);
-    RESTART_TIMER();
+    restartTimer();
 }
 
-void FileIOProcessorAsyncPrivate::onReadFileRequest(
-    QString absoluteFilePath, QUuid requestId)
+void FileIOProcessorAsyncPrivate::enqueueTask(Task && task)
 {
-    QNDEBUG(
-        "utility:file_async",
-        "FileIOProcessorAsyncPrivate::onReadFileRequest: file path = "
-            << absoluteFilePath << ", request id = " << requestId);
+    auto & tasks = m_pendingTasksByFilePath[task.m_absoluteFilePath];
+
+    // Coalesce the write with the previous pending write to the same file:
+    // nothing can observe the file's contents between these two writes
+    if ((task.m_type == TaskType::Write) && !tasks.empty() &&
+        (tasks.back().m_type == TaskType::Write))
+    {
+        Task & lastTask = tasks.back();
+
+        QMutexLocker locker(&m_metricsMutex);
+        pendingRequestsCounter(lastTask.m_priority) -=
+            lastTask.m_requests.size();
+
+        if (task.m_append) {
+            lastTask.m_data.append(task.m_data);
+        }
+        else {
+            lastTask.m_data = std::move(task.m_data);
+            lastTask.m_append = false;
+        }
+
+        lastTask.m_priority = std::max(lastTask.m_priority, task.m_priority);
+        lastTask.m_requests << task.m_requests;
+
+        pendingRequestsCounter(lastTask.m_priority) +=
+            lastTask.m_requests.size();
+
+        ++m_metrics.m_numCoalescedWriteRequests;
 
-    QFile file(absoluteFilePath);
-    if (!file.exists()) {
         QNTRACE(
             "utility:file_async",
-            "The file to read does not exist, "
-                << "sending empty data in return");
+            "Coalesced write request with the pending one: file path = "
+                << lastTask.m_absoluteFilePath);
+    }
+    else {
+        task.m_id = ++m_lastTaskId;
 
-        Q_EMIT readFileRequestProcessed(
-            true, ErrorString(), QByteArray(), requestId);
+        {
+            QMutexLocker locker(&m_metricsMutex);
+            pendingRequestsCounter(task.m_priority) += 1;
+        }
 
-        RESTART_TIMER();
-        return;
+        tasks.push_back(std::move(task));
     }
 
-    bool open = file.open(QIODevice::ReadOnly);
-    if (!open) {
-        ErrorString error(QT_TR_NOOP("can't open file for reading"));
-        error.details() = absoluteFilePath;
-        QNDEBUG("utility:file_async", error);
-        Q_EMIT readFileRequestProcessed(false, error, QByteArray(), requestId);
-        RESTART_TIMER();
-        return;
+    startPendingTasks();
+}
+
+void FileIOProcessorAsyncPrivate::startPendingTasks()
+{
+    while (m_tasksInProgress.size() < m_threadPool.maxThreadCount()) {
+        // Pick the highest priority task, the earliest one among tasks
+        // with equal priorities, from files which are not being processed
+        auto bestIt = m_pendingTasksByFilePath.end();
+        for (auto it = m_pendingTasksByFilePath.begin(),
+                  end = m_pendingTasksByFilePath.end();
+             it != end; ++it)
+        {
+            if (m_filePathsInProgress.contains(it.key())) {
+                continue;
+            }
+
+            const Task & task = it.value().front();
+            if (bestIt == end) {
+                bestIt = it;
+                continue;
+            }
+
+            const Task & bestTask = bestIt.value().front();
+            if ((task.m_priority > bestTask.m_priority) ||
+                ((task.m_priority == bestTask.m_priority) &&
+                 (task.m_id < bestTask.m_id)))
+            {
+                bestIt = it;
+            }
+        }
+
+        if (bestIt == m_pendingTasksByFilePath.end()) {
+            return;
+        }
+
+        Task task = std::move(bestIt.value().front());
+        bestIt.value().pop_front();
+        if (bestIt.value().empty()) {
+            Q_UNUSED(m_pendingTasksByFilePath.erase(bestIt))
+        }
+
+        {
+            QMutexLocker locker(&m_metricsMutex);
+            pendingRequestsCounter(task.m_priority) -= task.m_requests.size();
+            m_metrics.m_numRequestsInProgress += task.m_requests.size();
+        }
+
+        Q_UNUSED(m_filePathsInProgress.insert(task.m_absoluteFilePath))
+
+        auto * pWorker = new FileIOProcessorAsyncWorker(task);
+        pWorker->setAutoDelete(false);
+
+        QObject::connect(
+            pWorker, &FileIOProcessorAsyncWorker::finished, this,
+            &FileIOProcessorAsyncPrivate::onTaskFinished,
+            Qt::QueuedConnection);
+
+        QObject::connect(
+            pWorker, &FileIOProcessorAsyncWorker::finished, pWorker,
+            &FileIOProcessorAsyncWorker::deleteLater, Qt::QueuedConnection);
+
+        const quint64 taskId = task.m_id;
+        m_tasksInProgress[taskId] = std::move(task);
+        m_threadPool.start(pWorker);
     }
+}
+
+void FileIOProcessorAsyncPrivate::updateMetricsOnTaskFinished(
+    const Task & task)
+{
+    const qint64 now = m_clock.elapsed();
+
+    QMutexLocker locker(&m_metricsMutex);
+
+    m_metrics.m_numRequestsInProgress -= task.m_requests.size();
 
-    QByteArray data = file.readAll();
-    Q_EMIT readFileRequestProcessed(true, ErrorString(), data, requestId);
-    RESTART_TIMER();
+    for (const auto & request: qAsConst(task.m_requests)) {
+        const qint64 latency = now - request.second;
+        m_totalLatencyMsec += latency;
+        m_metrics.m_maxLatencyMsec =
+            std::max(m_metrics.m_maxLatencyMsec, latency);
+        ++m_metrics.m_numProcessedRequests;
+    }
+
+    m_metrics.m_averageLatencyMsec = m_totalLatencyMsec /
+        static_cast<qint64>(m_metrics.m_numProcessedRequests);
+}
+
+void FileIOProcessorAsyncPrivate::restartTimer()
+{
+    if (m_postOperationTimerId != 0) {
+        killTimer(m_postOperationTimerId);
+    }
+
+    m_postOperationTimerId =
+        startTimer(secondsToMilliseconds(m_idleTimePeriodSeconds));
+
+    QNTRACE(
+        "utility:file_async",
+        "FileIOProcessorAsyncPrivate: started post "
+            << "operation timer with id " << m_postOperationTimerId);
+}
+
+int & FileIOProcessorAsyncPrivate::pendingRequestsCounter(
+    const Priority priority)
+{
+    switch (priority) {
+    case Priority::Background:
+        return m_metrics.m_numPendingBackgroundRequests;
+    case Priority::Interactive:
+        return m_metrics.m_numPendingInteractiveRequests;
+    default:
+        return m_metrics.m_numPendingNormalRequests;
+    }
 }
 
 void FileIOProcessorAsyncPrivate::timerEvent(QTimerEvent * pEvent)
@@ -177,7 +361,130 @@ void FileIOProcessorAsyncPrivate::timerEvent(QTimerEvent * pEvent)
     killTimer(timerId);
     m_postOperationTimerId = 0;
 
+    if (!m_pendingTasksByFilePath.isEmpty() || !m_tasksInProgress.isEmpty()) {
+        // Not idle: the timer would be restarted once the IO is finished
+        return;
+    }
+
     Q_EMIT readyForIO();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+FileIOProcessorAsyncWorker::FileIOProcessorAsyncWorker(
+    FileIOProcessorAsyncPrivate::Task task, QObject * parent) :
+    QObject(parent),
+    m_task(std::move(task))
+{}
+
+void FileIOProcessorAsyncWorker::run()
+{
+    using TaskType = FileIOProcessorAsyncPrivate::TaskType;
+
+    ErrorString errorDescription;
+    QByteArray data;
+    QByteArray dataHash;
+    bool res = false;
+
+    if (m_task.m_type == TaskType::Write) {
+        res = write(errorDescription);
+    }
+    else {
+        res = read(data, dataHash, errorDescription);
+    }
+
+    // The data to write is not needed anymore
+    m_task.m_data.clear();
+
+    Q_EMIT finished(m_task.m_id, res, errorDescription, data, dataHash);
+}
+
+bool FileIOProcessorAsyncWorker::write(ErrorString & errorDescription)
+{
+    QFileInfo fileInfo(m_task.m_absoluteFilePath);
+    QDir folder = fileInfo.absoluteDir();
+    if (!folder.exists()) {
+        bool madeFolder = folder.mkpath(folder.absolutePath());
+        if (!madeFolder) {
+            errorDescription.setBase(
+                QT_TR_NOOP("can't create folder to write file into"));
+            errorDescription.details() = m_task.m_absoluteFilePath;
+            return false;
+        }
+    }
+
+    QFile file(m_task.m_absoluteFilePath);
+
+    QIODevice::OpenMode mode;
+    if (m_task.m_append) {
+        mode = QIODevice::Append;
+    }
+    else {
+        mode = QIODevice::WriteOnly;
+    }
+
+    bool open = file.open(mode);
+    if (Q_UNLIKELY(!open)) {
+        errorDescription.setBase(
+            QT_TR_NOOP("can't open file for writing/appending"));
+        errorDescription.details() = m_task.m_absoluteFilePath;
+        return false;
+    }
+
+    qint64 writtenBytes = file.write(m_task.m_data);
+    if (Q_UNLIKELY(writtenBytes < m_task.m_data.size())) {
+        errorDescription.setBase(
+            QT_TR_NOOP("can't write the whole data to file"));
+        errorDescription.details() = m_task.m_absoluteFilePath;
+        return false;
+    }
+
+    file.close();
+
+    QNDEBUG(
+        "utility:file_async",
+        "Successfully wrote file " << m_task.m_absoluteFilePath);
+
+    return true;
+}
+
+bool FileIOProcessorAsyncWorker::read(
+    QByteArray & data, QByteArray & dataHash, ErrorString & errorDescription)
+{
+    if (!QFile::exists(m_task.m_absoluteFilePath)) {
+        QNTRACE(
+            "utility:file_async",
+            "The file to read does not exist, "
+                << "sending empty data in return");
+        return true;
+    }
+
+    if (m_task.m_type == FileIOProcessorAsyncPrivate::TaskType::ReadWithHash)
+    {
+        ErrorString error;
+        data = readFileContentsWithHash(
+            m_task.m_absoluteFilePath, dataHash, error);
+
+        if (!error.isEmpty()) {
+            errorDescription.setBase(QT_TR_NOOP("can't read file"));
+            errorDescription.appendBase(error.base());
+            errorDescription.details() = m_task.m_absoluteFilePath;
+            return false;
+        }
+
+        return true;
+    }
+
+    QFile file(m_task.m_absoluteFilePath);
+    bool open = file.open(QIODevice::ReadOnly);
+    if (!open) {
+        errorDescription.setBase(QT_TR_NOOP("can't open file for reading"));
+        errorDescription.details() = m_task.m_absoluteFilePath;
+        return false;
+    }
+
+    data = file.readAll();
+    return true;
+}
+
 } // namespace quentier
@@ -20,11 +20,21 @@
 #define LIB_QUENTIER_UTILITY_FILE_IO_THREAD_WORKER_P_H
 
 #include <quentier/types/ErrorString.h>
+#include <quentier/utility/FileIOProcessorAsync.h>
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QIODevice>
+#include <QMutex>
 #include <QObject>
+#include <QRunnable>
+#include <QSet>
 #include <QString>
+#include <QThreadPool>
 #include <QUuid>
+#include <QVector>
+
+#include <deque>
 
 namespace quentier {
 
@@ -32,9 +42,16 @@ class Q_DECL_HIDDEN FileIOProcessorAsyncPrivate final : public QObject
 {
     Q_OBJECT
 public:
+    using Priority = FileIOProcessorAsync::Priority;
+    using Metrics = FileIOProcessorAsync::Metrics;
+
     explicit FileIOProcessorAsyncPrivate(QObject * parent = nullptr);
+    virtual ~FileIOProcessorAsyncPrivate() override;
 
     void setIdleTimePeriod(const qint32 seconds);
+    void setMaxWorkerCount(const int maxWorkerCount);
+
+    Metrics metrics() const;
 
 Q_SIGNALS:
     void readyForIO();
@@ -46,19 +63,111 @@ Q_SIGNALS:
         bool success, ErrorString errorDescription, QByteArray data,
         QUuid requestId);
 
+    void readFileWithHashRequestProcessed(
+        bool success, ErrorString errorDescription, QByteArray data,
+        QByteArray dataHash, QUuid requestId);
+
 public Q_SLOTS:
     void onWriteFileRequest(
         QString absoluteFilePath, QByteArray data, QUuid requestId,
-        bool append);
+        bool append, Priority priority);
+
+    void onReadFileRequest(
+        QString absoluteFilePath, QUuid requestId, bool withHash,
+        Priority priority);
 
-    void onReadFileRequest(QString absoluteFilePath, QUuid requestId);
+private Q_SLOTS:
+    void onTaskFinished(
+        quint64 taskId, bool success, ErrorString errorDescription,
+        QByteArray data, QByteArray dataHash);
 
 private:
     virtual void timerEvent(QTimerEvent * pEvent) override;
 
+public:
+    enum class TaskType
+    {
+        Write = 0,
+        Read,
+        ReadWithHash
+    };
+
+    /**
+     * Task is a unit of work for a worker: either a single read request or
+     * one or more coalesced write requests to the same file
+     */
+    struct Task
+    {
+        quint64 m_id = 0;
+        TaskType m_type = TaskType::Write;
+        Priority m_priority = Priority::Normal;
+        QString m_absoluteFilePath;
+        QByteArray m_data;
+        bool m_append = false;
+
+        // Ids of requests served by this task along with the timestamps of
+        // their arrival
+        QVector<std::pair<QUuid, qint64>> m_requests;
+    };
+
+private:
+    void enqueueTask(Task && task);
+    void startPendingTasks();
+    void updateMetricsOnTaskFinished(const Task & task);
+    void restartTimer();
+
+    int & pendingRequestsCounter(const Priority priority);
+
 private:
     qint32 m_idleTimePeriodSeconds = 30;
     qint32 m_postOperationTimerId = 0;
+
+    QThreadPool m_threadPool;
+    QElapsedTimer m_clock;
+
+    quint64 m_lastTaskId = 0;
+
+    // Pending tasks per file path, in the order of their arrival
+    QHash<QString, std::deque<Task>> m_pendingTasksByFilePath;
+
+    // Tasks which are being processed by workers
+    QHash<quint64, Task> m_tasksInProgress;
+    QSet<QString> m_filePathsInProgress;
+
+    mutable QMutex m_metricsMutex;
+    Metrics m_metrics;
+    qint64 m_totalLatencyMsec = 0;
+};
+
+/**
+ * @brief The FileIOProcessorAsyncWorker class performs the IO of a single
+ * FileIOProcessorAsyncPrivate::Task on a thread pool's thread
+ */
+class Q_DECL_HIDDEN FileIOProcessorAsyncWorker final :
+    public QObject,
+    public QRunnable
+{
+    Q_OBJECT
+public:
+    explicit FileIOProcessorAsyncWorker(
+        FileIOProcessorAsyncPrivate::Task task, QObject * parent = nullptr);
+
+    virtual void run() override;
+
+Q_SIGNALS:
+    void finished(
+        quint64 taskId, bool success, ErrorString errorDescription,
+        QByteArray data, QByteArray dataHash);
+
+private:
+    bool write(ErrorString & errorDescription);
+
+    bool read(
+        QByteArray & data, QByteArray & dataHash,
+        ErrorString & errorDescription);
+
+private:
+    FileIOProcessorAsyncPrivate::Task m_task;
 };
 
 } // namespace quentier
@@ -26,9 +26,11 @@
 #include <QFile>
 #include <QFileInfo>
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <limits>
 #include <string>
 
 #ifdef Q_OS_WIN
@@ -40,6 +42,10 @@
 #include <windows.h>
 #endif // defined Q_OS_WIN
 
+// Small enough for each chunk to remain in CPU cache between reading or
+// writing it and hashing it, large enough to keep the number of I/O calls low
+#define FILE_SYSTEM_IO_CHUNK_SIZE (1048576)
+
 namespace quentier {
 
 const QString relativePathFromAbsolutePath(
@@ -196,6 +202,237 @@ QByteArray readFileContents(
     return result;
 }
 
+QByteArray readFileContentsWithHash(
+    const QString & filePath, QByteArray & dataHash,
+    ErrorString & errorDescription,
+    const QCryptographicHash::Algorithm algorithm)
+{
+    QByteArray result;
+    errorDescription.clear();
+    dataHash.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorDescription.setBase(QT_TRANSLATE_NOOP(
+            "readFileContents",
+            "Failed to read file contents, could not open the file "
+            "for reading"));
+
+        errorDescription.details() = file.errorString();
+        return result;
+    }
+
+    const qint64 size = file.size();
+    if (size > std::numeric_limits<int>::max()) {
+        errorDescription.setBase(QT_TRANSLATE_NOOP(
+            "readFileContents",
+            "Failed to read file contents, file is too large"));
+
+        errorDescription.details() =
+            humanReadableSize(static_cast<quint64>(size));
+        return result;
+    }
+
+    QCryptographicHash hash(algorithm);
+    result.resize(static_cast<int>(size));
+
+    qint64 offset = 0;
+    while (offset < size) {
+        const qint64 chunkSize =
+            std::min<qint64>(FILE_SYSTEM_IO_CHUNK_SIZE, size - offset);
+
+        char * chunk = result.data() + offset;
+        const qint64 bytesRead = file.read(chunk, chunkSize);
+        if (Q_UNLIKELY(bytesRead < 0)) {
+            errorDescription.setBase(QT_TRANSLATE_NOOP(
+                "readFileContents",
+                "Failed to read file contents, I/O error"));
+
+            errorDescription.details() = file.errorString();
+            return QByteArray();
+        }
+
+        if (bytesRead == 0) {
+            // The file was truncated while it was being read
+            break;
+        }
+
+        hash.addData(chunk, static_cast<int>(bytesRead));
+        offset += bytesRead;
+    }
+
+    if (Q_UNLIKELY(offset < size)) {
+        result.truncate(static_cast<int>(offset));
+    }
+
+    dataHash = hash.result();
+    return result;
+}
+
+bool writeFileContentsWithHash(
+    const QString & filePath, const QByteArray & data, QByteArray & dataHash,
+    ErrorString & errorDescription,
+    const std::function<void(double)> & progressCallback,
+    const QCryptographicHash::Algorithm algorithm)
+{
+    errorDescription.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorDescription.setBase(QT_TRANSLATE_NOOP(
+            "writeFileContents",
+            "Failed to write file contents, could not open the file "
+            "for writing"));
+
+        errorDescription.details() = file.errorString();
+        return false;
+    }
+
+    const bool shouldCalculateHash = dataHash.isEmpty();
+    QCryptographicHash hash(algorithm);
+
+    const qint64 size = data.size();
+    const char * rawData = data.constData();
+
+    qint64 offset = 0;
+    while (offset < size) {
+        const qint64 chunkSize =
+            std::min<qint64>(FILE_SYSTEM_IO_CHUNK_SIZE, size - offset);
+
+        const char * chunk = rawData + offset;
+        const qint64 bytesWritten = file.write(chunk, chunkSize);
+        if (Q_UNLIKELY(bytesWritten <= 0)) {
+            errorDescription.setBase(QT_TRANSLATE_NOOP(
+                "writeFileContents",
+                "Failed to write file contents, I/O error"));
+
+            errorDescription.details() = file.errorString();
+            return false;
+        }
+
+        if (shouldCalculateHash) {
+            hash.addData(chunk, static_cast<int>(bytesWritten));
+        }
+
+        offset += bytesWritten;
+
+        if (progressCallback) {
+            progressCallback(static_cast<double>(offset) / size);
+        }
+    }
+
+    if (Q_UNLIKELY(!file.flush())) {
+        errorDescription.setBase(QT_TRANSLATE_NOOP(
+            "writeFileContents",
+            "Failed to write file contents, I/O error"));
+
+        errorDescription.details() = file.errorString();
+        return false;
+    }
+
+    if (shouldCalculateHash) {
+        dataHash = hash.result();
+    }
+
+    return true;
+}
+
+bool copyDataWithHash(
+    QIODevice & source, QIODevice & destination, QByteArray & dataHash,
+    ErrorString & errorDescription,
+    const QCryptographicHash::Algorithm algorithm)
+{
+    errorDescription.clear();
+    dataHash.clear();
+
+    QCryptographicHash hash(algorithm);
+    QByteArray buffer(FILE_SYSTEM_IO_CHUNK_SIZE, Qt::Uninitialized);
+
+    while (true) {
+        const qint64 bytesRead =
+            source.read(buffer.data(), FILE_SYSTEM_IO_CHUNK_SIZE);
+
+        if (Q_UNLIKELY(bytesRead < 0)) {
+            errorDescription.setBase(QT_TRANSLATE_NOOP(
+                "copyDataWithHash", "Failed to read the data to copy"));
+
+            errorDescription.details() = source.errorString();
+            return false;
+        }
+
+        if (bytesRead == 0) {
+            break;
+        }
+
+        qint64 offset = 0;
+        while (offset < bytesRead) {
+            const qint64 bytesWritten = destination.write(
+                buffer.constData() + offset, bytesRead - offset);
+
+            if (Q_UNLIKELY(bytesWritten <= 0)) {
+                errorDescription.setBase(QT_TRANSLATE_NOOP(
+                    "copyDataWithHash", "Failed to write the copied data"));
+
+                errorDescription.details() = destination.errorString();
+                return false;
+            }
+
+            offset += bytesWritten;
+        }
+
+        hash.addData(buffer.constData(), static_cast<int>(bytesRead));
+    }
+
+    dataHash = hash.result();
+    return true;
+}
+
+bool calculateFileHash(
+    const QString & filePath, QByteArray & dataHash,
+    ErrorString & errorDescription,
+    const QCryptographicHash::Algorithm algorithm)
+{
+    errorDescription.clear();
+    dataHash.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorDescription.setBase(QT_TRANSLATE_NOOP(
+            "calculateFileHash",
+            "Failed to calculate file hash, could not open the file "
+            "for reading"));
+
+        errorDescription.details() = file.errorString();
+        return false;
+    }
+
+    QCryptographicHash hash(algorithm);
+    QByteArray buffer(FILE_SYSTEM_IO_CHUNK_SIZE, Qt::Uninitialized);
+
+    while (true) {
+        const qint64 bytesRead =
+            file.read(buffer.data(), FILE_SYSTEM_IO_CHUNK_SIZE);
+
+        if (Q_UNLIKELY(bytesRead < 0)) {
+            errorDescription.setBase(QT_TRANSLATE_NOOP(
+                "calculateFileHash",
+                "Failed to calculate file hash, I/O error"));
+
+            errorDescription.details() = file.errorString();
+            return false;
+        }
+
+        if (bytesRead == 0) {
+            break;
+        }
+
+        hash.addData(buffer.constData(), static_cast<int>(bytesRead));
+    }
+
+    dataHash = hash.result();
+    return true;
+}
+
 bool renameFile(
     const QString & from, const QString & to, ErrorString & errorDescription)
 {